@@ -28,11 +28,14 @@
 #define KSPSTCG 'stcg'
 #define KSPGLTR 'gltr'
 #define KSPFCG 'fcg'
+#define KSPSCG 'scg'
 #define KSPGMRES 'gmres'
 #define KSPFGMRES 'fgmres'
 #define KSPLGMRES 'lgmres'
 #define KSPDGMRES 'dgmres'
 #define KSPPGMRES 'pgmres'
+#define KSPSGMRES 'sgmres'
+#define KSPPIPELGMRES 'pipelgmres'
 #define KSPTCQMR 'tcqmr'
 #define KSPBCGS 'bcgs'
 #define KSPIBCGS 'ibcgs'
@@ -47,6 +50,7 @@
 #define KSPQCG 'qcg'
 #define KSPBICG 'bicg'
 #define KSPMINRES 'minres'
+#define KSPPIPEMINRES 'pipeminres'
 #define KSPSYMMLQ 'symmlq'
 #define KSPLCD 'lcd'
 #define KSPPYTHON 'python'
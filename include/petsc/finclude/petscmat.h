@@ -94,6 +94,9 @@
 #define MATAIJSELL         'aijsell'
 #define MATSEQAIJSELL      'seqaijsell'
 #define MATMPIAIJSELL      'mpiaijsell'
+#define MATAIJSINGLE       'aijsingle'
+#define MATSEQAIJSINGLE    'seqaijsingle'
+#define MATMPIAIJSINGLE    'mpiaijsingle'
 #define MATAIJMKL          'aijmkl'
 #define MATSEQAIJMKL       'seqaijmkl'
 #define MATMPIAIJMKL       'mpiaijmkl'
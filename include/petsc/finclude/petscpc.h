@@ -12,6 +12,7 @@
 
 #define PCSide PetscEnum
 #define PCJacobiType PetscEnum
+#define PCPolyType PetscEnum
 #define PCASMType PetscEnum
 #define PCGASMType PetscEnum
 #define PCCompositeType PetscEnum
@@ -71,6 +72,7 @@
 #define PCGAMG 'gamg'
 #define PCBDDC 'bddc'
 #define PCPATCH 'patch'
+#define PCPOLY 'poly'
 
 #define PCMGType PetscEnum
 #define PCMGCycleType PetscEnum
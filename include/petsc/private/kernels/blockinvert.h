@@ -117,6 +117,12 @@ PETSC_EXTERN PetscErrorCode PetscKernel_A_gets_inverse_A_15(MatScalar*,PetscInt*
 */
 #define PetscKernel_A_gets_inverse_A(bs,A,pivots,W,allowzeropivot,zeropivotdetected) (PetscLINPACKgefa((A),(bs),(pivots),(allowzeropivot),(zeropivotdetected)) || PetscLINPACKgedi((A),(bs),(pivots),(W)))
 
+/*
+    A_i = inv(A_i) for the nb bs by bs blocks A_i starting at A + offsets[i] (A + i*bs*bs if offsets is NULL),
+  inverted together with the elimination vectorized across the blocks; optionally stores the transposes of the inverses
+*/
+PETSC_INTERN PetscErrorCode PetscKernel_A_gets_inverse_A_Batch(PetscInt,PetscInt,const PetscInt*,MatScalar*,PetscBool,PetscBool,PetscBool*);
+
 /* -----------------------------------------------------------------------*/
 
 #if !defined(PETSC_USE_REAL_MAT_SINGLE)
@@ -376,6 +376,9 @@ typedef struct { /* used by MatCreateRedundantMatrix() for reusing matredundant
   Mat          *matseq;
 } Mat_Redundant;
 
+/* Hash table used to assemble a matrix that was not preallocated, see MAT_USE_HASH_TABLE */
+typedef struct _n_Mat_Hash *Mat_Hash;
+
 struct _p_Mat {
   PETSCHEADER(struct _MatOps);
   PetscLayout            rmap,cmap;
@@ -411,6 +414,7 @@ struct _p_Mat {
   Mat                    schur;             /* Schur complement matrix */
   MatFactorSchurStatus   schur_status;      /* status of the Schur complement matrix */
   Mat_Redundant          *redundant;        /* used by MatCreateRedundantMatrix() */
+  Mat_Hash               hash;              /* used by MatAssemblyEnd() to build the storage from a hash table */
   PetscBool              erroriffailure;    /* Generate an error if detected (for example a zero pivot) instead of returning */
   MatFactorError         factorerrortype;               /* type of error in factorization */
   PetscReal              factorerror_zeropivot_value;   /* If numerical zero pivot was detected this is the computed value */
@@ -1714,6 +1718,8 @@ PETSC_EXTERN PetscLogEvent MATMFFD_Mult;
 PETSC_EXTERN PetscLogEvent MAT_GetMultiProcBlock;
 PETSC_EXTERN PetscLogEvent MAT_CUSPARSECopyToGPU;
 PETSC_EXTERN PetscLogEvent MAT_SetValuesBatch;
+PETSC_EXTERN PetscLogEvent MAT_PreallCOO;
+PETSC_EXTERN PetscLogEvent MAT_SetVCOO;
 PETSC_EXTERN PetscLogEvent MAT_ViennaCLCopyToGPU;
 PETSC_EXTERN PetscLogEvent MAT_Merge;
 PETSC_EXTERN PetscLogEvent MAT_Residual;
@@ -25,6 +25,8 @@ struct _PetscSFOps {
   PetscErrorCode (*Duplicate)(PetscSF,PetscSFDuplicateOption,PetscSF);
   PetscErrorCode (*BcastBegin)(PetscSF,MPI_Datatype,const void*,void*);
   PetscErrorCode (*BcastEnd)(PetscSF,MPI_Datatype,const void*,void*);
+  PetscErrorCode (*BcastManyBegin)(PetscSF,PetscInt,const MPI_Datatype*,const void**,void**);
+  PetscErrorCode (*BcastManyEnd)(PetscSF,PetscInt,const MPI_Datatype*,const void**,void**);
   PetscErrorCode (*BcastAndOpBegin)(PetscSF,MPI_Datatype,const void*,void*,MPI_Op);
   PetscErrorCode (*BcastAndOpEnd)(PetscSF,MPI_Datatype,const void*,void*,MPI_Op);
   PetscErrorCode (*ReduceBegin)(PetscSF,MPI_Datatype,const void*,void*,MPI_Op);
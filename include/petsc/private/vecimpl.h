@@ -14,6 +14,7 @@
 
 PETSC_EXTERN PetscBool VecRegisterAllCalled;
 PETSC_EXTERN PetscErrorCode VecRegisterAll(void);
+PETSC_INTERN PetscBool VecMDotUseGEMV,VecMAXPYUseGEMV;
 
 /* ----------------------------------------------------------------------------*/
 
@@ -109,6 +109,12 @@ typedef struct {
   MPI_Win                sharedwin;                 /* Window that owns sharedspace */
   PetscInt               notdone;                   /* used by VecScatterEndMPI3Node() */
 #endif
+#if defined(PETSC_HAVE_MPI_NEIGHBORHOOD_COLLECTIVES)  /* these replace the persistent requests with one neighborhood collective, see -vecscatter_neighbor */
+  PetscBool              use_neighbor;
+  MPI_Comm               ncomm;                     /* distributed graph communicator whose destinations are procs[] */
+  PetscMPIInt            *ncounts,*ndispls;         /* [n] number and offset of the values exchanged with each of procs[] */
+  MPI_Request            nrequest;
+#endif
 } VecScatter_MPI_General;
 
 /* Routines to create, copy, destroy or execute a memcpy plan */
@@ -349,6 +355,7 @@ PETSC_INTERN PetscErrorCode VecScatterView_SGToSS(VecScatter,PetscViewer);
 PETSC_INTERN PetscErrorCode VecScatterCopy_SSToSS(VecScatter,VecScatter);
 PETSC_INTERN PetscErrorCode VecScatterView_SSToSS(VecScatter,PetscViewer);
 PETSC_INTERN PetscErrorCode VecScatterMemcpyPlanCreate_SGToSG(PetscInt,VecScatter_Seq_General*,VecScatter_Seq_General*);
+PETSC_INTERN PetscErrorCode VecScatterLocalOptimize_Private(VecScatter,VecScatter_Seq_General*,VecScatter_Seq_General*);
 PETSC_INTERN PetscErrorCode GetInputISType_private(VecScatter,PetscInt,PetscInt,PetscInt*,IS*,PetscInt*,IS*);
 
 #define VEC_SEQ_ID 0
@@ -38,6 +38,7 @@ typedef const char* KSPType;
 #define KSPPIPECG     "pipecg"
 #define KSPPIPECGRR   "pipecgrr"
 #define KSPPIPELCG     "pipelcg"
+#define KSPSCG        "scg"
 #define   KSPCGNE       "cgne"
 #define   KSPCGNASH     "nash"
 #define   KSPCGSTCG     "stcg"
@@ -50,6 +51,8 @@ typedef const char* KSPType;
 #define   KSPLGMRES     "lgmres"
 #define   KSPDGMRES     "dgmres"
 #define   KSPPGMRES     "pgmres"
+#define   KSPSGMRES     "sgmres"
+#define   KSPPIPELGMRES "pipelgmres"
 #define KSPTCQMR      "tcqmr"
 #define KSPBCGS       "bcgs"
 #define   KSPIBCGS      "ibcgs"
@@ -66,6 +69,7 @@ typedef const char* KSPType;
 #define KSPQCG        "qcg"
 #define KSPBICG       "bicg"
 #define KSPMINRES     "minres"
+#define   KSPPIPEMINRES "pipeminres"
 #define KSPSYMMLQ     "symmlq"
 #define KSPLCD        "lcd"
 #define KSPPYTHON     "python"
@@ -158,6 +162,7 @@ PETSC_EXTERN PetscErrorCode KSPRichardsonSetSelfScale(KSP,PetscBool );
 PETSC_EXTERN PetscErrorCode KSPChebyshevSetEigenvalues(KSP,PetscReal,PetscReal);
 PETSC_EXTERN PetscErrorCode KSPChebyshevEstEigSet(KSP,PetscReal,PetscReal,PetscReal,PetscReal);
 PETSC_EXTERN PetscErrorCode KSPChebyshevEstEigSetUseNoisy(KSP,PetscBool);
+PETSC_EXTERN PetscErrorCode KSPChebyshevEstEigSetReuse(KSP,PetscInt,PetscReal);
 PETSC_EXTERN PetscErrorCode KSPChebyshevEstEigGetKSP(KSP,KSP*);
 PETSC_EXTERN PetscErrorCode KSPComputeExtremeSingularValues(KSP,PetscReal*,PetscReal*);
 PETSC_EXTERN PetscErrorCode KSPComputeEigenvalues(KSP,PetscInt,PetscReal[],PetscReal[],PetscInt*);
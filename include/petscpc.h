@@ -21,6 +21,7 @@ PETSC_EXTERN PetscClassId PC_CLASSID;
 /* Arrays of names for options in implementation PCs */
 PETSC_EXTERN const char *const *const PCSides;
 PETSC_EXTERN const char *const PCJacobiTypes[];
+PETSC_EXTERN const char *const PCPolyTypes[];
 PETSC_EXTERN const char *const PCASMTypes[];
 PETSC_EXTERN const char *const PCGASMTypes[];
 PETSC_EXTERN const char *const PCCompositeTypes[];
@@ -404,6 +405,11 @@ PETSC_EXTERN PetscErrorCode PCPatchSetComputeFunction(PC pc, PetscErrorCode (*fu
 PETSC_EXTERN PetscErrorCode PCPatchSetComputeOperatorInteriorFacets(PC, PetscErrorCode (*)(PC,PetscInt,Vec,Mat,IS,PetscInt,const PetscInt *,const PetscInt *, void *), void *);
 PETSC_EXTERN PetscErrorCode PCPatchSetComputeFunctionInteriorFacets(PC pc, PetscErrorCode (*func)(PC, PetscInt, Vec, Vec, IS, PetscInt, const PetscInt *, const PetscInt *, void *), void *ctx);
 
+PETSC_EXTERN PetscErrorCode PCPolySetType(PC,PCPolyType);
+PETSC_EXTERN PetscErrorCode PCPolyGetType(PC,PCPolyType*);
+PETSC_EXTERN PetscErrorCode PCPolySetDegree(PC,PetscInt);
+PETSC_EXTERN PetscErrorCode PCPolyGetDegree(PC,PetscInt*);
+
 PETSC_EXTERN PetscErrorCode PCLMVMSetMatLMVM(PC, Mat);
 PETSC_EXTERN PetscErrorCode PCLMVMGetMatLMVM(PC, Mat*);
 PETSC_EXTERN PetscErrorCode PCLMVMSetIS(PC, IS);
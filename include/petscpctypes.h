@@ -70,6 +70,7 @@ typedef const char* PCType;
 #define PCTELESCOPE       "telescope"
 #define PCPATCH           "patch"
 #define PCLMVM            "lmvm"
+#define PCPOLY            "poly"
 
 /*E
     PCSide - If the preconditioner is to be applied to the left, right
@@ -107,6 +108,19 @@ typedef enum {
 E*/
 typedef enum { PC_JACOBI_DIAGONAL,PC_JACOBI_ROWMAX,PC_JACOBI_ROWSUM} PCJacobiType;
 
+/*E
+    PCPolyType - The polynomial used by the PCPOLY preconditioner
+
+$  PC_POLY_GMRES     - the minimal residual polynomial of GMRES from a fixed starting vector
+$  PC_POLY_CHEBYSHEV - the Chebyshev polynomial for an estimate of the upper part of the spectrum
+$  PC_POLY_NEUMANN   - the truncated Neumann series of the damped matrix
+
+   Level: intermediate
+
+.seealso: PCPolySetType(), PCPOLY
+E*/
+typedef enum { PC_POLY_GMRES,PC_POLY_CHEBYSHEV,PC_POLY_NEUMANN} PCPolyType;
+
 /*E
     PCASMType - Type of additive Schwarz method to use
 
@@ -16,17 +16,24 @@ PETSC_EXTERN PetscClassId PETSCSF_CLASSID;
    Level: beginner
 
    Notes:
-    The two approaches provided are
-$     PETSCSFBASIC which uses MPI 1 message passing to perform the communication and
+    The approaches provided are
+$     PETSCSFBASIC which uses MPI 1 message passing to perform the communication,
 $     PETSCSFWINDOW which uses MPI 2 one-sided operations to perform the communication, this may be more efficient,
 $                   but may not be available for all MPI distributions. In particular OpenMPI has bugs in its one-sided
-$                   operations that prevent its use.
+$                   operations that prevent its use, and
+$     PETSCSFSHM which moves the data between the processes of a node through MPI 3 shared memory (MPI_Win_allocate_shared())
+$                   and uses the message passing of PETSCSFBASIC between nodes. All the processes of a node must call the
+$                   communication routines of the PetscSFs on a communicator in the same order, and
+$     PETSCSFNEIGHBOR which exchanges the messages of each operation with one MPI 3 neighborhood collective
+$                   (MPI_Ineighbor_alltoallv()) on distributed graph communicators created at PetscSFSetUp().
 
 .seealso: PetscSFSetType(), PetscSF
 J*/
 typedef const char *PetscSFType;
 #define PETSCSFBASIC  "basic"
 #define PETSCSFWINDOW "window"
+#define PETSCSFSHM    "shm"
+#define PETSCSFNEIGHBOR "neighbor"
 
 /*E
     PetscSFWindowSyncType - Type of synchronization for PETSCSFWINDOW
@@ -91,6 +98,9 @@ PETSC_EXTERN PetscErrorCode PetscSFBcastBegin(PetscSF,MPI_Datatype,const void*,v
   PetscAttrMPIPointerWithType(3,2) PetscAttrMPIPointerWithType(4,2);
 PETSC_EXTERN PetscErrorCode PetscSFBcastEnd(PetscSF,MPI_Datatype,const void*,void*)
   PetscAttrMPIPointerWithType(3,2) PetscAttrMPIPointerWithType(4,2);
+/* broadcasts several rootdata arrays, each with its own data type, to leafdata arrays in one message per rank */
+PETSC_EXTERN PetscErrorCode PetscSFBcastManyBegin(PetscSF,PetscInt,const MPI_Datatype[],const void*[],void*[]);
+PETSC_EXTERN PetscErrorCode PetscSFBcastManyEnd(PetscSF,PetscInt,const MPI_Datatype[],const void*[],void*[]);
 /* Reduce rootdata to leafdata using provided operation */
 PETSC_EXTERN PetscErrorCode PetscSFBcastAndOpBegin(PetscSF,MPI_Datatype,const void*,void*,MPI_Op)
   PetscAttrMPIPointerWithType(3,2) PetscAttrMPIPointerWithType(4,2);
@@ -770,6 +770,9 @@ PetscErrorCode DMPlexOrientInterface(DM dm)
   PetscSF           sf=NULL;
   PetscInt          (*roots)[2], (*leaves)[2];
   PetscMPIInt       (*rootsRanks)[2], (*leavesRanks)[2];
+  MPI_Datatype       units[2];
+  const void        *rootdata[2];
+  void              *leafdata[2];
   const PetscInt    *locals=NULL;
   const PetscSFNode *remotes=NULL;
   PetscInt           nroots, nleaves, p, c;
@@ -835,10 +838,11 @@ PetscErrorCode DMPlexOrientInterface(DM dm)
       leavesRanks[p][c] = -2;
     }
   }
-  ierr = PetscSFBcastBegin(sf, MPIU_2INT, roots, leaves);CHKERRQ(ierr);
-  ierr = PetscSFBcastBegin(sf, MPI_2INT, rootsRanks, leavesRanks);CHKERRQ(ierr);
-  ierr = PetscSFBcastEnd(sf, MPIU_2INT, roots, leaves);CHKERRQ(ierr);
-  ierr = PetscSFBcastEnd(sf, MPI_2INT, rootsRanks, leavesRanks);CHKERRQ(ierr);
+  units[0]    = MPIU_2INT;   units[1]    = MPI_2INT;
+  rootdata[0] = roots;       rootdata[1] = rootsRanks;
+  leafdata[0] = leaves;      leafdata[1] = leavesRanks;
+  ierr = PetscSFBcastManyBegin(sf, 2, units, rootdata, leafdata);CHKERRQ(ierr);
+  ierr = PetscSFBcastManyEnd(sf, 2, units, rootdata, leafdata);CHKERRQ(ierr);
   if (debug) {ierr = PetscSynchronizedFlush(comm, NULL);CHKERRQ(ierr);}
   if (debug && rank == 0) {ierr = PetscSynchronizedPrintf(comm, "Referred leaves\n");CHKERRQ(ierr);}
   for (p = 0; p < nroots; ++p) {
@@ -2424,6 +2424,9 @@ static PetscErrorCode DMPlexRewriteSF(DM dm, PetscInt n, PetscInt *pointsToRewri
   PetscInt      ierr, pStart, pEnd, i, j, counter, leafCounter, sumDegrees, nroots, nleafs;
   PetscInt     *cumSumDegrees, *newOwners, *newNumbers, *rankOnLeafs, *locationsOfLeafs, *remoteLocalPointOfLeafs, *points, *leafsNew;
   PetscSFNode  *leafLocationsNew;
+  MPI_Datatype  units[2];
+  const void   *rootdata[2];
+  void         *leafdata[2];
   const         PetscSFNode *iremote;
   const         PetscInt *ilocal;
   PetscBool    *isLeaf;
@@ -2507,10 +2510,11 @@ static PetscErrorCode DMPlexRewriteSF(DM dm, PetscInt n, PetscInt *pointsToRewri
   ierr = PetscFree(locationsOfLeafs);CHKERRQ(ierr);
   ierr = PetscFree(remoteLocalPointOfLeafs);CHKERRQ(ierr);
 
-  ierr = PetscSFBcastBegin(sf, MPIU_INT, newOwners, newOwners);CHKERRQ(ierr);
-  ierr = PetscSFBcastEnd(sf, MPIU_INT, newOwners, newOwners);CHKERRQ(ierr);
-  ierr = PetscSFBcastBegin(sf, MPIU_INT, newNumbers, newNumbers);CHKERRQ(ierr);
-  ierr = PetscSFBcastEnd(sf, MPIU_INT, newNumbers, newNumbers);CHKERRQ(ierr);
+  units[0]    = MPIU_INT;  units[1]    = MPIU_INT;
+  rootdata[0] = newOwners; rootdata[1] = newNumbers;
+  leafdata[0] = newOwners; leafdata[1] = newNumbers;
+  ierr = PetscSFBcastManyBegin(sf, 2, units, rootdata, leafdata);CHKERRQ(ierr);
+  ierr = PetscSFBcastManyEnd(sf, 2, units, rootdata, leafdata);CHKERRQ(ierr);
 
   /* Now count how many leafs we have on each processor. */
   leafCounter=0;
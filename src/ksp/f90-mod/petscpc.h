@@ -27,6 +27,15 @@
       parameter (PC_JACOBI_ROWMAX=1)
       parameter (PC_JACOBI_ROWSUM=2)
 !
+!     PCPolyType
+!
+      PetscEnum PC_POLY_GMRES
+      PetscEnum PC_POLY_CHEBYSHEV
+      PetscEnum PC_POLY_NEUMANN
+      parameter (PC_POLY_GMRES=0)
+      parameter (PC_POLY_CHEBYSHEV=1)
+      parameter (PC_POLY_NEUMANN=2)
+!
 ! PCASMType
 !
       PetscEnum PC_ASM_BASIC
@@ -132,4 +132,8 @@ int main(int argc,char **args)
       suffix: 2
       args: -bs {{8 9 10 11 12 13 14 15}} -pc_type ilu
 
+   test:
+      suffix: 3
+      args: -bs {{2 7 8 9 10}} -mat_type {{baij aij}} -pc_type pbjacobi
+
 TEST*/
@@ -224,6 +224,13 @@ int main(int argc,char **args)
       nsize: 2
       args: -ksp_monitor_short -m 5 -n 5 -ksp_gmres_cgs_refinement_type refine_always
 
+   test:
+      suffix: openmp
+      nsize: 2
+      requires: openmp
+      args: -ksp_monitor_short -m 5 -n 5 -ksp_gmres_cgs_refinement_type refine_always -mat_aij_openmp -mat_aij_openmp_threads 3
+      output_file: output/ex2_2.out
+
    test:
       suffix: 3
       args: -pc_type sor -pc_sor_symmetric -ksp_monitor_short -ksp_gmres_cgs_refinement_type refine_always
@@ -297,10 +304,65 @@ int main(int argc,char **args)
       args: -ksp_monitor_short -ksp_type pipelcg -m 9 -n 9 -pc_type none -ksp_pipelcg_pipel 2 -ksp_pipelcg_lmax 2
       filter: grep -v "sqrt breakdown in iteration"
 
+   test:
+      suffix: scg
+      nsize: 2
+      args: -ksp_monitor_short -ksp_type scg -m 9 -n 9 -ksp_scg_s {{2 4}separate output}
+
+   test:
+      suffix: sgmres
+      nsize: 2
+      args: -ksp_monitor_short -ksp_type sgmres -m 9 -n 9 -ksp_sgmres_basis {{newton chebyshev}separate output}
+
+   test:
+      suffix: pipelgmres
+      nsize: 2
+      args: -ksp_monitor_short -ksp_type pipelgmres -m 9 -n 9 -ksp_pipelgmres_pipel 3 -ksp_pipelgmres_lmax 2 -ksp_pipelgmres_replace
+
+   test:
+      suffix: pipeminres
+      nsize: 2
+      args: -ksp_monitor_short -ksp_type pipeminres -m 9 -n 9 -pc_type jacobi -ksp_pipeminres_replace 5
+
+   test:
+      suffix: chowpatel
+      args: -ksp_monitor_short -m 9 -n 9 -pc_type ilu -pc_factor_levels 1 -mat_aij_chowpatel_sweeps 3
+
+   test:
+      suffix: chowpatel_jacobi
+      args: -ksp_monitor_short -m 9 -n 9 -pc_type bjacobi -sub_pc_type ilu -sub_pc_factor_mat_ordering_type rcm -mat_aij_chowpatel_sweeps 3 -mat_aij_chowpatel_jacobi 3
+
+   test:
+      suffix: bjacobi_threads
+      requires: openmp threadsafety
+      args: -ksp_monitor_short -m 20 -n 20 -pc_type bjacobi -pc_bjacobi_blocks 7 -pc_bjacobi_threads 3
+
+   test:
+      suffix: asm_threads
+      nsize: 2
+      requires: openmp threadsafety
+      args: -ksp_monitor_short -m 20 -n 20 -pc_type asm -pc_asm_blocks 5 -pc_asm_threads 3
+
+   test:
+      suffix: poly
+      nsize: 2
+      args: -ksp_monitor_short -ksp_type cg -pc_type poly -pc_poly_type {{gmres chebyshev neumann}separate output}
+
    test:
       suffix: sell
       args: -ksp_monitor_short -ksp_gmres_cgs_refinement_type refine_always -m 9 -n 9 -mat_type sell
 
+   test:
+      suffix: aijsingle
+      nsize: 2
+      requires: double !complex
+      args: -m 40 -n 40 -mat_type aijsingle -ksp_type cg -pc_type gamg -ksp_rtol 1e-8 -ksp_converged_reason
+
+   test:
+      suffix: gamg_sym_graph
+      nsize: 4
+      args: -m 40 -n 40 -ksp_type cg -pc_type gamg -pc_gamg_sym_graph true -pc_gamg_threshold {{-1 0.01}separate output} -ksp_monitor_short
+
    test:
       requires: mumps
       suffix: sell_mumps
@@ -0,0 +1,431 @@
+
+#include <petsc/private/kspimpl.h>
+#include <petscblaslapack.h>
+
+#define SCG_DEFAULT_S 4
+
+typedef enum {KSP_SCG_BASIS_CHEBYSHEV,KSP_SCG_BASIS_MONOMIAL} KSPSCGBasisType;
+static const char *const KSPSCGBasisTypes[] = {"chebyshev","monomial"};
+
+typedef struct {
+  PetscInt        s;            /* number of search directions generated between global reductions */
+  KSPSCGBasisType basis;        /* polynomial basis used to generate them */
+  PetscBool       bounds_set;   /* has the spectral interval been estimated for this solve */
+  PetscReal       emin,emax;    /* interval containing the spectrum of the preconditioned operator */
+  Vec             *V,*AV;       /* V(0:s-1) the last s A-conjugate directions, V(s:2s-1) the new block, and their images under A */
+  PetscScalar     *G,*D,*Bk;    /* S^H A S, (A P)^H S and the coefficients making the new block S A-conjugate to P */
+  PetscScalar     *W,*F,*M;     /* S^H A S after conjugation, Cholesky factor work space and P^H A P */
+  PetscScalar     *g,*h,*a;     /* S^H r, P^H r and the step lengths */
+  PetscReal       *alpha,*beta; /* CG coefficients of the warm-up, define the Lanczos matrix */
+} KSP_SCG;
+
+static PetscErrorCode KSPSetUp_SCG(KSP ksp)
+{
+  KSP_SCG        *scg = (KSP_SCG*)ksp->data;
+  PetscInt       s    = scg->s;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (s < 1) SETERRQ1(PetscObjectComm((PetscObject)ksp),PETSC_ERR_ARG_OUTOFRANGE,"Block size s %D must be positive",s);
+  ierr = KSPSetWorkVecs(ksp,1);CHKERRQ(ierr);
+  ierr = VecDuplicateVecs(ksp->work[0],2*s,&scg->V);CHKERRQ(ierr);
+  ierr = VecDuplicateVecs(ksp->work[0],2*s,&scg->AV);CHKERRQ(ierr);
+  ierr = PetscLogObjectParents(ksp,2*s,scg->V);CHKERRQ(ierr);
+  ierr = PetscLogObjectParents(ksp,2*s,scg->AV);CHKERRQ(ierr);
+  ierr = PetscMalloc6(s*s,&scg->G,s*s,&scg->D,s*s,&scg->Bk,s*s,&scg->W,s*s,&scg->F,s*s,&scg->M);CHKERRQ(ierr);
+  ierr = PetscMalloc5(s,&scg->g,s,&scg->h,s,&scg->a,s,&scg->alpha,s,&scg->beta);CHKERRQ(ierr);
+  ierr = PetscLogObjectMemory((PetscObject)ksp,(6*s*s+3*s)*sizeof(PetscScalar)+2*s*sizeof(PetscReal));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPReset_SCG(KSP ksp)
+{
+  KSP_SCG        *scg = (KSP_SCG*)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (scg->V) {
+    ierr = VecDestroyVecs(2*scg->s,&scg->V);CHKERRQ(ierr);
+    ierr = VecDestroyVecs(2*scg->s,&scg->AV);CHKERRQ(ierr);
+  }
+  ierr = PetscFree6(scg->G,scg->D,scg->Bk,scg->W,scg->F,scg->M);CHKERRQ(ierr);
+  ierr = PetscFree5(scg->g,scg->h,scg->a,scg->alpha,scg->beta);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPDestroy_SCG(KSP ksp)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = KSPReset_SCG(ksp);CHKERRQ(ierr);
+  ierr = KSPDestroyDefault(ksp);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPSetFromOptions_SCG(PetscOptionItems *PetscOptionsObject,KSP ksp)
+{
+  KSP_SCG        *scg  = (KSP_SCG*)ksp->data;
+  PetscInt       basis = (PetscInt)scg->basis,s = scg->s;
+  PetscBool      flg;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscOptionsHead(PetscOptionsObject,"KSP s-step CG options");CHKERRQ(ierr);
+  ierr = PetscOptionsInt("-ksp_scg_s","Number of search directions generated between global reductions","None",s,&s,&flg);CHKERRQ(ierr);
+  if (flg && s < 1) SETERRQ1(PetscObjectComm((PetscObject)ksp),PETSC_ERR_ARG_OUTOFRANGE,"Block size s %D must be positive",s);
+  if (!ksp->setupstage) {
+    scg->s = s;
+  } else if (s != scg->s) {
+    /* free the data structures, then create them again */
+    ierr            = KSPReset_SCG(ksp);CHKERRQ(ierr);
+    scg->s          = s;
+    ksp->setupstage = KSP_SETUP_NEW;
+  }
+  ierr = PetscOptionsEList("-ksp_scg_basis","Polynomial basis used to generate the search directions","None",KSPSCGBasisTypes,2,KSPSCGBasisTypes[basis],&basis,NULL);CHKERRQ(ierr);
+  scg->basis = (KSPSCGBasisType)basis;
+  ierr = PetscOptionsTail();CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPView_SCG(KSP ksp,PetscViewer viewer)
+{
+  KSP_SCG        *scg = (KSP_SCG*)ksp->data;
+  PetscBool      iascii,isstring;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectTypeCompare((PetscObject)viewer,PETSCVIEWERASCII,&iascii);CHKERRQ(ierr);
+  ierr = PetscObjectTypeCompare((PetscObject)viewer,PETSCVIEWERSTRING,&isstring);CHKERRQ(ierr);
+  if (iascii) {
+    ierr = PetscViewerASCIIPrintf(viewer,"  s=%D, using %s basis\n",scg->s,KSPSCGBasisTypes[scg->basis]);CHKERRQ(ierr);
+  } else if (isstring) {
+    ierr = PetscViewerStringSPrintf(viewer,"s %D %s basis",scg->s,KSPSCGBasisTypes[scg->basis]);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+/*
+   KSPSCGCholesky - Cholesky factorization W = R^H R of the Hermitian n x n matrix W (leading dimension ld), stopping at
+   the first pivot not larger than tol times Wref(k,k). Returns the number of columns factored and the failing pivot.
+*/
+static PetscErrorCode KSPSCGCholesky(PetscInt n,PetscInt ld,const PetscScalar *W,const PetscScalar *Wref,PetscReal tol,PetscScalar *R,PetscInt *k,PetscReal *pivot)
+{
+  PetscInt    i,j,l;
+  PetscScalar t;
+
+  PetscFunctionBegin;
+  *pivot = 0.0;
+  for (j=0; j<n; j++) {
+    PetscReal d = PetscRealPart(W[j+j*ld]);
+
+    for (l=0; l<j; l++) d -= PetscRealPart(PetscConj(R[l+j*ld])*R[l+j*ld]);
+    *pivot = d;
+    if (d <= tol*PetscRealPart(Wref[j+j*ld])) break;
+    R[j+j*ld] = PetscSqrtReal(d);
+    for (i=j+1; i<n; i++) {
+      t = W[j+i*ld];
+      for (l=0; l<j; l++) t -= PetscConj(R[l+j*ld])*R[l+i*ld];
+      R[j+i*ld] = t/R[j+j*ld];
+    }
+  }
+  *k = j;
+  PetscFunctionReturn(0);
+}
+
+/* solves R^H R x = b in place with the k x k upper triangular Cholesky factor R */
+static PetscErrorCode KSPSCGCholeskySolve(PetscInt k,PetscInt ld,const PetscScalar *R,PetscScalar *x)
+{
+  PetscInt i,l;
+
+  PetscFunctionBegin;
+  for (i=0; i<k; i++) {
+    for (l=0; l<i; l++) x[i] -= PetscConj(R[l+i*ld])*x[l];
+    x[i] /= PetscConj(R[i+i*ld]);
+  }
+  for (i=k-1; i>=0; i--) {
+    for (l=i+1; l<k; l++) x[i] -= R[i+l*ld]*x[l];
+    x[i] /= R[i+i*ld];
+  }
+  PetscFunctionReturn(0);
+}
+
+/*
+   KSPSCGComputeBounds - Estimates the spectral interval of the preconditioned operator from the Lanczos matrix of the
+   CG warm-up, see KSPComputeEigenvalues_CG(); the upper end is enlarged since Lanczos underestimates it.
+*/
+static PetscErrorCode KSPSCGComputeBounds(KSP ksp,PetscInt n)
+{
+  KSP_SCG        *scg = (KSP_SCG*)ksp->data;
+  PetscReal      *d,*e,dummy;
+  PetscBLASInt   bn,ldz = 1,lierr;
+  PetscInt       i;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscMalloc2(n,&d,n,&e);CHKERRQ(ierr);
+  for (i=0; i<n; i++) {
+    d[i] = 1.0/scg->alpha[i];
+    if (i) {
+      d[i]  += scg->beta[i]/scg->alpha[i-1];
+      e[i-1] = PetscSqrtReal(PetscAbsReal(scg->beta[i]))/scg->alpha[i-1];
+    }
+  }
+  ierr = PetscBLASIntCast(n,&bn);CHKERRQ(ierr);
+  ierr = PetscFPTrapPush(PETSC_FP_TRAP_OFF);CHKERRQ(ierr);
+  PetscStackCallBLAS("LAPACKsteqr",LAPACKREALsteqr_("N",&bn,d,e,&dummy,&ldz,&dummy,&lierr));
+  ierr = PetscFPTrapPop();CHKERRQ(ierr);
+  if (lierr) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_LIB,"Error in LAPACK routine %d",(int)lierr);
+  scg->emin       = d[0];
+  scg->emax       = 1.1*d[n-1];
+  scg->bounds_set = PETSC_TRUE;
+  ierr = PetscFree2(d,e);CHKERRQ(ierr);
+  ierr = PetscInfo2(ksp,"Spectral interval estimate [%g, %g]\n",(double)scg->emin,(double)scg->emax);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*
+ KSPSolve_SCG - This routine actually applies the s-step conjugate gradient method
+
+ Input Parameter:
+ .     ksp - the Krylov space object that was set to use conjugate gradient, by, for
+             example, KSPCreate(MPI_Comm,KSP *ksp); KSPSetType(ksp,KSPSCG);
+*/
+static PetscErrorCode KSPSolve_SCG(KSP ksp)
+{
+  KSP_SCG        *scg = (KSP_SCG*)ksp->data;
+  PetscInt       s    = scg->s,ns,k,kk,kprev,keep,off,i,l,m,nwarm = 0;
+  PetscScalar    *G,*D,*Bk,*W,*F,*M,*g,*h,*a,dot;
+  PetscReal      dp = 0.0,pivot,c,d;
+  Vec            X,B,R,*P,*AP,*S,*AS,t;
+  Mat            Amat,Pmat;
+  PetscBool      diagonalscale;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PCGetDiagonalScale(ksp->pc,&diagonalscale);CHKERRQ(ierr);
+  if (diagonalscale) SETERRQ1(PetscObjectComm((PetscObject)ksp),PETSC_ERR_SUP,"Krylov method %s does not support diagonal scaling",((PetscObject)ksp)->type_name);
+
+  X  = ksp->vec_sol;
+  B  = ksp->vec_rhs;
+  R  = ksp->work[0];
+  G  = scg->G; D = scg->D; Bk = scg->Bk; W = scg->W; F = scg->F; M = scg->M;
+  g  = scg->g; h = scg->h; a = scg->a;
+  P  = scg->V; AP = scg->AV; S = scg->V+s; AS = scg->AV+s;
+
+  ierr = PCGetOperators(ksp->pc,&Amat,&Pmat);CHKERRQ(ierr);
+
+  ksp->its = 0;
+  if (!ksp->guess_zero) {
+    ierr = KSP_MatMult(ksp,Amat,X,R);CHKERRQ(ierr);            /*     r <- b - Ax     */
+    ierr = VecAYPX(R,-1.0,B);CHKERRQ(ierr);
+  } else {
+    ierr = VecCopy(B,R);CHKERRQ(ierr);                         /*     r <- b (x is 0) */
+  }
+
+  /* the first s iterations are CG iterations (blocks of size one) which provide the spectral interval */
+  scg->bounds_set = PETSC_FALSE;
+  kprev           = 0;
+  while (1) {
+    ns = scg->bounds_set ? s : 1;
+    ns = PetscMax(1,PetscMin(ns,ksp->max_it-ksp->its));
+
+    /* block of search directions S = [z, p_1(BA) z, ...] and its image under A, no reductions */
+    ierr = KSP_PCApply(ksp,R,S[0]);CHKERRQ(ierr);              /*     z <- Br         */
+    for (i=0; i<ns; i++) {
+      ierr = KSP_MatMult(ksp,Amat,S[i],AS[i]);CHKERRQ(ierr);
+      if (i == ns-1) break;
+      ierr = KSP_PCApply(ksp,AS[i],S[i+1]);CHKERRQ(ierr);
+      if (scg->basis == KSP_SCG_BASIS_CHEBYSHEV) {
+        c = 0.5*(scg->emax+scg->emin);
+        d = 0.5*(scg->emax-scg->emin);
+        if (!i) {
+          ierr = VecAXPBY(S[1],-c/d,1.0/d,S[0]);CHKERRQ(ierr);
+        } else {
+          ierr = VecAXPBYPCZ(S[i+1],-2.0*c/d,-1.0,2.0/d,S[i],S[i-1]);CHKERRQ(ierr);
+        }
+      } else {
+        ierr = VecScale(S[i+1],1.0/scg->emax);CHKERRQ(ierr);
+      }
+    }
+
+    /* a single reduction for all the inner products of the block and the residual norm */
+    for (i=0; i<ns; i++) {
+      ierr = VecMDotBegin(AS[i],ns,S,G+i*ns);CHKERRQ(ierr);
+      if (kprev) {ierr = VecMDotBegin(S[i],kprev,AP,D+i*kprev);CHKERRQ(ierr);}
+    }
+    ierr = VecMDotBegin(R,ns,S,g);CHKERRQ(ierr);
+    if (kprev) {ierr = VecMDotBegin(R,kprev,P,h);CHKERRQ(ierr);}
+    if (ksp->normtype == KSP_NORM_PRECONDITIONED) {
+      ierr = VecNormBegin(S[0],NORM_2,&dp);CHKERRQ(ierr);
+    } else if (ksp->normtype == KSP_NORM_UNPRECONDITIONED) {
+      ierr = VecNormBegin(R,NORM_2,&dp);CHKERRQ(ierr);
+    }
+    ierr = PetscCommSplitReductionBegin(PetscObjectComm((PetscObject)R));CHKERRQ(ierr);
+    for (i=0; i<ns; i++) {
+      ierr = VecMDotEnd(AS[i],ns,S,G+i*ns);CHKERRQ(ierr);
+      if (kprev) {ierr = VecMDotEnd(S[i],kprev,AP,D+i*kprev);CHKERRQ(ierr);}
+    }
+    ierr = VecMDotEnd(R,ns,S,g);CHKERRQ(ierr);
+    if (kprev) {ierr = VecMDotEnd(R,kprev,P,h);CHKERRQ(ierr);}
+    if (ksp->normtype == KSP_NORM_PRECONDITIONED) {
+      ierr = VecNormEnd(S[0],NORM_2,&dp);CHKERRQ(ierr);
+    } else if (ksp->normtype == KSP_NORM_UNPRECONDITIONED) {
+      ierr = VecNormEnd(R,NORM_2,&dp);CHKERRQ(ierr);
+    } else if (ksp->normtype == KSP_NORM_NATURAL) {
+      dp = PetscSqrtReal(PetscAbsScalar(g[0]));                 /*     dp <- r'*z = r'*B*r */
+    }
+    dot = g[0];                                                 /*     z'*r            */
+    KSPCheckDot(ksp,dot);
+    KSPCheckNorm(ksp,dp);
+
+    ksp->rnorm = dp;
+    ierr = KSPLogResidualHistory(ksp,dp);CHKERRQ(ierr);
+    ierr = KSPMonitor(ksp,ksp->its,dp);CHKERRQ(ierr);
+    ierr = (*ksp->converged)(ksp,ksp->its,dp,&ksp->reason,ksp->cnvP);CHKERRQ(ierr);
+    if (ksp->reason) break;
+    if (ksp->its >= ksp->max_it) {
+      ksp->reason = KSP_DIVERGED_ITS;
+      break;
+    }
+    if (PetscRealPart(dot) <= 0.0) {
+      if (dot == 0.0) {
+        ksp->reason = KSP_CONVERGED_ATOL;
+        ierr        = PetscInfo(ksp,"converged due to z'r = 0\n");CHKERRQ(ierr);
+        break;
+      }
+      if (ksp->errorifnotconverged) SETERRQ(PetscObjectComm((PetscObject)ksp),PETSC_ERR_NOT_CONVERGED,"Diverged due to indefinite preconditioner");
+      ksp->reason = KSP_DIVERGED_INDEFINITE_PC;
+      ierr        = PetscInfo(ksp,"diverging due to indefinite preconditioner\n");CHKERRQ(ierr);
+      break;
+    }
+
+    /* make the block A-conjugate to the last directions: Bk = (P^H A P)^{-1} (A P)^H S, S^H A S - D^H Bk and rhs g - Bk^H h */
+    ierr = KSPSCGCholesky(kprev,s,M,M,0.0,F,&kk,&pivot);CHKERRQ(ierr);
+    for (i=0; i<ns; i++) {
+      for (m=0; m<kprev; m++) Bk[m+i*s] = D[m+i*kprev];
+      ierr = KSPSCGCholeskySolve(kk,s,F,Bk+i*s);CHKERRQ(ierr);
+      for (l=0; l<ns; l++) {
+        PetscScalar t = G[l+i*ns];
+        for (m=0; m<kprev; m++) t -= PetscConj(D[m+l*kprev])*Bk[m+i*s];
+        W[l+i*s] = t;
+      }
+      a[i] = g[i];
+      for (m=0; m<kprev; m++) a[i] -= PetscConj(Bk[m+i*s])*h[m];
+    }
+    ierr = KSPSCGCholesky(ns,s,W,W,PETSC_SQRT_MACHINE_EPSILON,F,&k,&pivot);CHKERRQ(ierr);
+    if (!k) {
+      if (pivot <= 0.0) {
+        if (ksp->errorifnotconverged) SETERRQ(PetscObjectComm((PetscObject)ksp),PETSC_ERR_NOT_CONVERGED,"Diverged due to indefinite matrix");
+        ksp->reason = KSP_DIVERGED_INDEFINITE_MAT;
+        ierr        = PetscInfo(ksp,"diverging due to indefinite or negative definite matrix\n");CHKERRQ(ierr);
+        break;
+      }
+      F[0] = PetscSqrtReal(pivot);
+      k    = 1;
+    }
+    if (k < ns) {ierr = PetscInfo2(ksp,"Block of search directions truncated to %D of %D\n",k,ns);CHKERRQ(ierr);}
+    ierr = KSPSCGCholeskySolve(k,s,F,a);CHKERRQ(ierr);
+
+    /* S <- S - P Bk and AS <- AS - AP Bk, the new A-conjugate directions */
+    for (i=0; i<k && kprev; i++) {
+      for (m=0; m<kprev; m++) h[m] = -Bk[m+i*s];
+      ierr = VecMAXPY(S[i],kprev,h,P);CHKERRQ(ierr);
+      ierr = VecMAXPY(AS[i],kprev,h,AP);CHKERRQ(ierr);
+    }
+
+    ierr = VecMAXPY(X,k,a,S);CHKERRQ(ierr);                     /*     x <- x + S a    */
+    for (i=0; i<k; i++) a[i] = -a[i];
+    ierr = VecMAXPY(R,k,a,AS);CHKERRQ(ierr);                    /*     r <- r - AS a   */
+
+    if (!scg->bounds_set) {
+      scg->alpha[nwarm] = -PetscRealPart(a[0]);
+      scg->beta[nwarm]  = kprev ? -PetscRealPart(Bk[kprev-1]) : 0.0;
+      nwarm++;
+    }
+
+    /* keep the last s directions, their mutual A-inner products are zero except within a block */
+    keep = PetscMin(kprev,s-k);
+    off  = kprev-keep;
+    for (i=0; i<keep; i++) {
+      t = P[i];  P[i]  = P[i+off];  P[i+off]  = t;
+      t = AP[i]; AP[i] = AP[i+off]; AP[i+off] = t;
+      for (l=0; l<keep; l++) M[l+i*s] = M[l+off+(i+off)*s];
+    }
+    for (i=0; i<k; i++) {
+      t = P[keep+i];  P[keep+i]  = S[i];  S[i]  = t;
+      t = AP[keep+i]; AP[keep+i] = AS[i]; AS[i] = t;
+      for (l=0; l<keep; l++) M[l+(keep+i)*s] = M[keep+i+l*s] = 0.0;
+      for (l=0; l<k; l++) M[keep+l+(keep+i)*s] = W[l+i*s];
+    }
+    kprev = keep+k;
+
+    ksp->its += k;
+    if (!scg->bounds_set && nwarm == s) {
+      ierr = KSPSCGComputeBounds(ksp,nwarm);CHKERRQ(ierr);
+      if (!(scg->emax > 0.0) || scg->emin >= scg->emax) {
+        ierr      = PetscInfo(ksp,"Unusable spectral interval estimate, using [0, 1]\n");CHKERRQ(ierr);
+        scg->emin = 0.0;
+        scg->emax = 1.0;
+      }
+    }
+  }
+  PetscFunctionReturn(0);
+}
+
+/*MC
+   KSPSCG - Communication avoiding s-step (block) conjugate gradient method.
+
+   Options Database Keys:
++   -ksp_scg_s <s> - the number of search directions generated between global reductions (default 4)
+-   -ksp_scg_basis <chebyshev,monomial> - the polynomial basis used to generate them (default chebyshev)
+
+   Level: intermediate
+
+   Notes:
+   Each outer step generates s directions [z, p_1(BA) z, ..., p_{s-1}(BA) z] from the preconditioned residual z with s
+   matrix-vector products and s preconditioner applications, and then computes all the inner products it needs, together
+   with the residual norm, in a single global reduction. The block is made A-conjugate to the last s directions and the
+   iterate is updated with the s step lengths that minimize the A-norm of the error over the block, so in exact arithmetic
+   one outer step equals s iterations of KSPCG, and the number of global reductions is reduced by a factor of 2s. The
+   iteration count reported is the number of search directions used.
+
+   The first s iterations of each solve are plain CG iterations whose Lanczos matrix gives an estimate of the spectral
+   interval of the preconditioned operator, used to define the Chebyshev basis (or to scale the monomial basis). If the
+   directions of a block are numerically dependent the block is truncated, so large s only costs iterations.
+
+   The residual norm is computed at the beginning of each outer step, so convergence is detected at most one block late.
+
+   Only left preconditioning is supported; the preconditioner and operator must be symmetric (Hermitian) positive definite.
+
+   References:
++  1. - A. T. Chronopoulos and C. W. Gear, s-step iterative methods for symmetric linear systems, J. Comput. Appl. Math., 1989.
+-  2. - E. Carson, Communication-avoiding Krylov subspace methods in theory and practice, PhD thesis, UC Berkeley, 2015.
+
+.seealso: KSPCreate(), KSPSetType(), KSPCG, KSPPIPECG, KSPPIPELCG, KSPSGMRES
+M*/
+PETSC_EXTERN PetscErrorCode KSPCreate_SCG(KSP ksp)
+{
+  KSP_SCG        *scg;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscNewLog(ksp,&scg);CHKERRQ(ierr);
+  ksp->data  = (void*)scg;
+  scg->s     = SCG_DEFAULT_S;
+  scg->basis = KSP_SCG_BASIS_CHEBYSHEV;
+
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_PRECONDITIONED,PC_LEFT,3);CHKERRQ(ierr);
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_UNPRECONDITIONED,PC_LEFT,2);CHKERRQ(ierr);
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_NATURAL,PC_LEFT,2);CHKERRQ(ierr);
+
+  ksp->ops->setup          = KSPSetUp_SCG;
+  ksp->ops->solve          = KSPSolve_SCG;
+  ksp->ops->reset          = KSPReset_SCG;
+  ksp->ops->destroy        = KSPDestroy_SCG;
+  ksp->ops->view           = KSPView_SCG;
+  ksp->ops->setfromoptions = KSPSetFromOptions_SCG;
+  ksp->ops->buildsolution  = KSPBuildSolutionDefault;
+  ksp->ops->buildresidual  = KSPBuildResidualDefault;
+  PetscFunctionReturn(0);
+}
@@ -8,6 +8,7 @@ static PetscErrorCode KSPReset_Chebyshev(KSP ksp)
 
   PetscFunctionBegin;
   ierr = KSPReset(cheb->kspest);CHKERRQ(ierr);
+  ierr = VecDestroy(&cheb->evec);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
@@ -84,6 +85,24 @@ static PetscErrorCode KSPChebyshevEstEigSetUseNoisy_Chebyshev(KSP ksp,PetscBool
   PetscFunctionReturn(0);
 }
 
+static PetscErrorCode KSPChebyshevEstEigSetReuse_Chebyshev(KSP ksp,PetscInt steps,PetscReal rtol)
+{
+  KSP_Chebyshev  *cheb = (KSP_Chebyshev*)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (steps != PETSC_DEFAULT) {
+    if (steps < 0) SETERRQ1(PetscObjectComm((PetscObject)ksp),PETSC_ERR_ARG_OUTOFRANGE,"Number of power iterations %D must be nonnegative",steps);
+    cheb->reusesteps = steps;
+  }
+  if (rtol != PETSC_DEFAULT) {
+    if (rtol < 0.0) SETERRQ1(PetscObjectComm((PetscObject)ksp),PETSC_ERR_ARG_OUTOFRANGE,"Relative tolerance %g must be nonnegative",(double)rtol);
+    cheb->reusertol = rtol;
+  }
+  if (!cheb->reusesteps) {ierr = VecDestroy(&cheb->evec);CHKERRQ(ierr);}
+  PetscFunctionReturn(0);
+}
+
 /*@
    KSPChebyshevSetEigenvalues - Sets estimates for the extreme eigenvalues
    of the preconditioned problem.
@@ -193,6 +212,47 @@ PetscErrorCode KSPChebyshevEstEigSetUseNoisy(KSP ksp,PetscBool use)
   PetscFunctionReturn(0);
 }
 
+/*@
+   KSPChebyshevEstEigSetReuse - reuse the eigenvalue estimates when only the values of the operators change,
+   for example between Newton steps or time steps
+
+   Logically Collective on KSP
+
+   Input Arguments:
++  ksp - linear solver context
+.  steps - number of power iterations used to check the estimates, 0 to compute new estimates whenever the operators change (or PETSC_DEFAULT)
+-  rtol - relative change of the largest eigenvalue that triggers new estimates (or PETSC_DEFAULT)
+
+   Options Database:
++  -ksp_chebyshev_esteig_reuse_steps <steps>
+-  -ksp_chebyshev_esteig_reuse_rtol <rtol>
+
+  Notes:
+    When the operators are the same objects as at the last estimate but their values have changed, a few steps of the
+    power iteration on the preconditioned operator estimate how much the largest eigenvalue has changed. If it has
+    changed by at most rtol the Krylov estimates are scaled by this change instead of being recomputed by
+    KSPChebyshevEstEigGetKSP(). The power iterations start from the right hand side used by the first estimation, and
+    their estimate at the last estimation is the reference, so the change measured does not depend on the number of checks.
+
+    This costs steps applications of the preconditioned operator instead of the steps of the eigenvalue estimator,
+    which matters for the level smoothers of PCMG and PCGAMG that are set up at every Newton step.
+
+  Level: intermediate
+
+.seealso: KSPChebyshevEstEigSet(), KSPChebyshevEstEigSetUseNoisy()
+@*/
+PetscErrorCode KSPChebyshevEstEigSetReuse(KSP ksp,PetscInt steps,PetscReal rtol)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(ksp,KSP_CLASSID,1);
+  PetscValidLogicalCollectiveInt(ksp,steps,2);
+  PetscValidLogicalCollectiveReal(ksp,rtol,3);
+  ierr = PetscTryMethod(ksp,"KSPChebyshevEstEigSetReuse_C",(KSP,PetscInt,PetscReal),(ksp,steps,rtol));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 /*@
   KSPChebyshevEstEigGetKSP - Get the Krylov method context used to estimate eigenvalues for the Chebyshev method.  If
   a Krylov method is not being used for this purpose, NULL is returned.  The reference count of the returned KSP is
@@ -236,6 +296,8 @@ static PetscErrorCode KSPSetFromOptions_Chebyshev(PetscOptionItems *PetscOptions
   PetscReal      eminmax[2] = {0., 0.};
   PetscReal      tform[4] = {PETSC_DECIDE,PETSC_DECIDE,PETSC_DECIDE,PETSC_DECIDE};
   PetscBool      flgeig, flgest;
+  PetscInt       steps = cheb->reusesteps;
+  PetscReal      rtol = cheb->reusertol;
 
   PetscFunctionBegin;
   ierr = PetscOptionsHead(PetscOptionsObject,"KSP Chebyshev Options");CHKERRQ(ierr);
@@ -268,6 +330,9 @@ static PetscErrorCode KSPSetFromOptions_Chebyshev(PetscOptionItems *PetscOptions
 
   if (cheb->kspest) {
     ierr = PetscOptionsBool("-ksp_chebyshev_esteig_noisy","Use noisy right hand side for estimate","KSPChebyshevEstEigSetUseNoisy",cheb->usenoisy,&cheb->usenoisy,NULL);CHKERRQ(ierr);
+    ierr = PetscOptionsInt("-ksp_chebyshev_esteig_reuse_steps","Number of power iterations used to check the estimates when the operators change","KSPChebyshevEstEigSetReuse",cheb->reusesteps,&steps,NULL);CHKERRQ(ierr);
+    ierr = PetscOptionsReal("-ksp_chebyshev_esteig_reuse_rtol","Relative change of the largest eigenvalue that triggers new estimates","KSPChebyshevEstEigSetReuse",cheb->reusertol,&rtol,NULL);CHKERRQ(ierr);
+    ierr = KSPChebyshevEstEigSetReuse(ksp,steps,rtol);CHKERRQ(ierr);
     ierr = KSPSetFromOptions(cheb->kspest);CHKERRQ(ierr);
   }
   ierr = PetscOptionsTail();CHKERRQ(ierr);
@@ -308,6 +373,34 @@ PETSC_STATIC_INLINE PetscScalar chebyhash(PetscInt xx)
   return (PetscScalar)((PetscInt64)x-2147483648)*5.e-10; /* center around zero, scaled about -1. to 1.*/
 }
 
+/*
+   Power iteration on the preconditioned operator starting from cheb->evec, which is not changed, so that all the
+   estimates made between two full estimations start from the same vector; returns the estimate of the largest eigenvalue.
+   Uses ksp->work[0], ksp->work[1] and ksp->work[2]
+*/
+static PetscErrorCode KSPChebyshevPowerIteration_Private(KSP ksp,PetscReal *emax)
+{
+  KSP_Chebyshev  *cheb = (KSP_Chebyshev*)ksp->data;
+  Vec            v = ksp->work[1];
+  PetscErrorCode ierr;
+  PetscInt       i;
+  PetscReal      norm;
+
+  PetscFunctionBegin;
+  *emax = 0.0;
+  ierr  = VecCopy(cheb->evec,v);CHKERRQ(ierr);
+  ierr  = VecNormalize(v,&norm);CHKERRQ(ierr);
+  if (norm == 0.0) PetscFunctionReturn(0);
+  for (i=0; i<cheb->reusesteps; i++) {
+    ierr = KSP_PCApplyBAorAB(ksp,v,ksp->work[0],ksp->work[2]);CHKERRQ(ierr);
+    ierr = VecNorm(ksp->work[0],NORM_2,&norm);CHKERRQ(ierr);
+    if (norm == 0.0) break;
+    ierr = VecAXPBY(v,1.0/norm,0.0,ksp->work[0]);CHKERRQ(ierr);
+  }
+  *emax = norm;
+  PetscFunctionReturn(0);
+}
+
 static PetscErrorCode KSPSolve_Chebyshev(KSP ksp)
 {
   KSP_Chebyshev  *cheb = (KSP_Chebyshev*)ksp->data;
@@ -338,58 +431,88 @@ static PetscErrorCode KSPSolve_Chebyshev(KSP ksp)
       PetscReal          max=0.0,min=0.0;
       Vec                B;
       KSPConvergedReason reason;
-
-      if (cheb->usenoisy) {
-        B  = ksp->work[1];
-        {
-          PetscErrorCode ierr;
-          PetscInt       n,i,istart;
-          PetscScalar    *xx;
-          ierr = VecGetOwnershipRange(B,&istart,NULL);CHKERRQ(ierr);
-          ierr = VecGetLocalSize(B,&n);CHKERRQ(ierr);
-          ierr = VecGetArray(B,&xx);CHKERRQ(ierr);
-          for (i=0; i<n; i++) {
-            PetscScalar v = chebyhash(i+istart);
-            xx[i] = v;
+      PetscBool          reuse = PETSC_FALSE;
+
+      if (cheb->reusesteps && cheb->evec && amatid == cheb->amatid && pmatid == cheb->pmatid) {
+        PetscReal epow;
+
+        ierr = KSPChebyshevPowerIteration_Private(ksp,&epow);CHKERRQ(ierr);
+        if (PetscAbsReal(epow - cheb->epowref) <= cheb->reusertol*cheb->epowref) {
+          reuse = PETSC_TRUE;
+          min   = cheb->eminref*epow/cheb->epowref;
+          max   = cheb->emaxref*epow/cheb->epowref;
+          cheb->nreuse++;
+          ierr = PetscInfo2(ksp,"Reusing eigenvalue estimates scaled by %g, power iteration estimate %g\n",(double)(epow/cheb->epowref),(double)epow);CHKERRQ(ierr);
+        } else {
+          ierr = PetscInfo2(ksp,"Power iteration estimate changed from %g to %g, estimating eigenvalues again\n",(double)cheb->epowref,(double)epow);CHKERRQ(ierr);
+        }
+      }
+      if (!reuse) {
+        if (cheb->usenoisy) {
+          B  = ksp->work[1];
+          {
+            PetscErrorCode ierr;
+            PetscInt       n,i,istart;
+            PetscScalar    *xx;
+            ierr = VecGetOwnershipRange(B,&istart,NULL);CHKERRQ(ierr);
+            ierr = VecGetLocalSize(B,&n);CHKERRQ(ierr);
+            ierr = VecGetArray(B,&xx);CHKERRQ(ierr);
+            for (i=0; i<n; i++) {
+              PetscScalar v = chebyhash(i+istart);
+              xx[i] = v;
+            }
+            ierr = VecRestoreArray(B,&xx);CHKERRQ(ierr);
+          }
+        } else {
+          PC        pc;
+          PetscBool change;
+
+          ierr = KSPGetPC(cheb->kspest,&pc);CHKERRQ(ierr);
+          ierr = PCPreSolveChangeRHS(pc,&change);CHKERRQ(ierr);
+          if (change) {
+            B = ksp->work[1];
+            ierr = VecCopy(ksp->vec_rhs,B);CHKERRQ(ierr);
+          } else {
+            B = ksp->vec_rhs;
           }
-          ierr = VecRestoreArray(B,&xx);CHKERRQ(ierr);
         }
-      } else {
-        PC        pc;
-        PetscBool change;
-
+        ierr = KSPSolve(cheb->kspest,B,ksp->work[0]);CHKERRQ(ierr);
+        ierr = KSPGetConvergedReason(cheb->kspest,&reason);CHKERRQ(ierr);
         ierr = KSPGetPC(cheb->kspest,&pc);CHKERRQ(ierr);
-        ierr = PCPreSolveChangeRHS(pc,&change);CHKERRQ(ierr);
-        if (change) {
-          B = ksp->work[1];
-          ierr = VecCopy(ksp->vec_rhs,B);CHKERRQ(ierr);
+        ierr = PCGetFailedReason(pc,&pcreason);CHKERRQ(ierr);
+        if (reason < 0 || pcreason) {
+          if (reason == KSP_DIVERGED_ITS) {
+            ierr = PetscInfo(ksp,"Eigen estimator ran for prescribed number of iterations\n");CHKERRQ(ierr);
+          } else {
+            PetscInt its;
+            ierr = KSPGetIterationNumber(cheb->kspest,&its);CHKERRQ(ierr);
+            ksp->reason = KSP_DIVERGED_PC_FAILED;
+            ierr = VecSetInf(ksp->vec_sol);CHKERRQ(ierr);
+            ierr = PetscInfo3(ksp,"Eigen estimator failed: %s %s at iteration %D",KSPConvergedReasons[reason],PCFailedReasons[pcreason],its);CHKERRQ(ierr);
+            PetscFunctionReturn(0);
+          }
+        } else if (reason==KSP_CONVERGED_RTOL ||reason==KSP_CONVERGED_ATOL) {
+          ierr = PetscInfo(ksp,"Eigen estimator converged prematurely. Should not happen except for small or low rank problem\n");CHKERRQ(ierr);
         } else {
-          B = ksp->vec_rhs;
+          ierr = PetscInfo1(ksp,"Eigen estimator did not converge by iteration: %s\n",KSPConvergedReasons[reason]);CHKERRQ(ierr);
         }
-      }
-      ierr = KSPSolve(cheb->kspest,B,ksp->work[0]);CHKERRQ(ierr);
-      ierr = KSPGetConvergedReason(cheb->kspest,&reason);CHKERRQ(ierr);
-      ierr = KSPGetPC(cheb->kspest,&pc);CHKERRQ(ierr);
-      ierr = PCGetFailedReason(pc,&pcreason);CHKERRQ(ierr);
-      if (reason < 0 || pcreason) {
-        if (reason == KSP_DIVERGED_ITS) {
-          ierr = PetscInfo(ksp,"Eigen estimator ran for prescribed number of iterations\n");CHKERRQ(ierr);
-        } else {
-          PetscInt its;
-          ierr = KSPGetIterationNumber(cheb->kspest,&its);CHKERRQ(ierr);
-          ksp->reason = KSP_DIVERGED_PC_FAILED;
-          ierr = VecSetInf(ksp->vec_sol);CHKERRQ(ierr);
-          ierr = PetscInfo3(ksp,"Eigen estimator failed: %s %s at iteration %D",KSPConvergedReasons[reason],PCFailedReasons[pcreason],its);CHKERRQ(ierr);
-          PetscFunctionReturn(0);
+
+        ierr = KSPChebyshevComputeExtremeEigenvalues_Private(cheb->kspest,&min,&max);CHKERRQ(ierr);
+        cheb->nestimate++;
+        if (cheb->reusesteps) {
+          /* keep the starting vector of the power iteration if only the values of the operators changed */
+          if (amatid != cheb->amatid || pmatid != cheb->pmatid) {ierr = VecDestroy(&cheb->evec);CHKERRQ(ierr);}
+          if (!cheb->evec) {
+            ierr = VecDuplicate(B,&cheb->evec);CHKERRQ(ierr);
+            ierr = VecCopy(B,cheb->evec);CHKERRQ(ierr);
+          }
+          ierr = KSPChebyshevPowerIteration_Private(ksp,&cheb->epowref);CHKERRQ(ierr);
+          if (cheb->epowref == 0.0) {ierr = VecDestroy(&cheb->evec);CHKERRQ(ierr);}
+          cheb->eminref = min;
+          cheb->emaxref = max;
         }
-      } else if (reason==KSP_CONVERGED_RTOL ||reason==KSP_CONVERGED_ATOL) {
-        ierr = PetscInfo(ksp,"Eigen estimator converged prematurely. Should not happen except for small or low rank problem\n");CHKERRQ(ierr);
-      } else {
-        ierr = PetscInfo1(ksp,"Eigen estimator did not converge by iteration: %s\n",KSPConvergedReasons[reason]);CHKERRQ(ierr);
       }
 
-      ierr = KSPChebyshevComputeExtremeEigenvalues_Private(cheb->kspest,&min,&max);CHKERRQ(ierr);
-
       cheb->emin_computed = min;
       cheb->emax_computed = max;
       cheb->emin = cheb->tform[0]*min + cheb->tform[1]*max;
@@ -577,6 +700,10 @@ static  PetscErrorCode KSPView_Chebyshev(KSP ksp,PetscViewer viewer)
       if (cheb->usenoisy) {
         ierr = PetscViewerASCIIPrintf(viewer,"  estimating eigenvalues using noisy right hand side\n");CHKERRQ(ierr);
       }
+      if (cheb->reusesteps) {
+        ierr = PetscViewerASCIIPrintf(viewer,"  reusing the estimates when the operators change by less than %g as measured by %D power iterations\n",(double)cheb->reusertol,cheb->reusesteps);CHKERRQ(ierr);
+        ierr = PetscViewerASCIIPrintf(viewer,"  eigenvalues estimated %D times, estimates reused %D times\n",cheb->nestimate,cheb->nreuse);CHKERRQ(ierr);
+      }
     }
   }
   PetscFunctionReturn(0);
@@ -589,9 +716,11 @@ static PetscErrorCode KSPDestroy_Chebyshev(KSP ksp)
 
   PetscFunctionBegin;
   ierr = KSPDestroy(&cheb->kspest);CHKERRQ(ierr);
+  ierr = VecDestroy(&cheb->evec);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPChebyshevSetEigenvalues_C",NULL);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPChebyshevEstEigSet_C",NULL);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPChebyshevEstEigSetUseNoisy_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPChebyshevEstEigSetReuse_C",NULL);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPChebyshevEstEigGetKSP_C",NULL);CHKERRQ(ierr);
   ierr = KSPDestroyDefault(ksp);CHKERRQ(ierr);
   PetscFunctionReturn(0);
@@ -606,7 +735,9 @@ static PetscErrorCode KSPDestroy_Chebyshev(KSP ksp)
 .   -ksp_chebyshev_esteig <a,b,c,d> - estimate eigenvalues using a Krylov method, then use this
                          transform for Chebyshev eigenvalue bounds (KSPChebyshevEstEigSet())
 .   -ksp_chebyshev_esteig_steps - number of estimation steps
--   -ksp_chebyshev_esteig_noisy - use noisy number generator to create right hand side for eigenvalue estimator
+.   -ksp_chebyshev_esteig_noisy - use noisy number generator to create right hand side for eigenvalue estimator
+.   -ksp_chebyshev_esteig_reuse_steps - number of power iterations used to decide whether the estimates can be reused when the values of the operators change (KSPChebyshevEstEigSetReuse())
+-   -ksp_chebyshev_esteig_reuse_rtol - relative change of the largest eigenvalue that triggers new estimates
 
    Level: beginner
 
@@ -619,7 +750,7 @@ static PetscErrorCode KSPDestroy_Chebyshev(KSP ksp)
           The user should call KSPChebyshevSetEigenvalues() if they have eigenvalue estimates.
 
 .seealso:  KSPCreate(), KSPSetType(), KSPType (for list of available types), KSP,
-           KSPChebyshevSetEigenvalues(), KSPChebyshevEstEigSet(), KSPChebyshevEstEigSetUseNoisy()
+           KSPChebyshevSetEigenvalues(), KSPChebyshevEstEigSet(), KSPChebyshevEstEigSetUseNoisy(), KSPChebyshevEstEigSetReuse()
            KSPRICHARDSON, KSPCG, PCMG
 
 M*/
@@ -647,6 +778,8 @@ PETSC_EXTERN PetscErrorCode KSPCreate_Chebyshev(KSP ksp)
   chebyshevP->tform[3] = 1.1;
   chebyshevP->eststeps = 10;
   chebyshevP->usenoisy = PETSC_TRUE;
+  chebyshevP->reusesteps = 0;
+  chebyshevP->reusertol  = 0.1;
 
   ksp->ops->setup          = KSPSetUp_Chebyshev;
   ksp->ops->solve          = KSPSolve_Chebyshev;
@@ -660,6 +793,7 @@ PETSC_EXTERN PetscErrorCode KSPCreate_Chebyshev(KSP ksp)
   ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPChebyshevSetEigenvalues_C",KSPChebyshevSetEigenvalues_Chebyshev);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPChebyshevEstEigSet_C",KSPChebyshevEstEigSet_Chebyshev);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPChebyshevEstEigSetUseNoisy_C",KSPChebyshevEstEigSetUseNoisy_Chebyshev);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPChebyshevEstEigSetReuse_C",KSPChebyshevEstEigSetReuse_Chebyshev);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPChebyshevEstEigGetKSP_C",KSPChebyshevEstEigGetKSP_Chebyshev);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
@@ -14,6 +14,12 @@ typedef struct {
   PetscReal        tform[4];     /* transform from Krylov estimates to Chebyshev bounds */
   PetscInt         eststeps;     /* number of kspest steps in KSP used to estimate eigenvalues */
   PetscBool        usenoisy;    /* use noisy right hand side vector to estimate eigenvalues */
+  /* For reusing the estimates when only the values of the operators change */
+  PetscInt         reusesteps;   /* number of power iterations used to check and update the estimates, 0 to always re-estimate */
+  PetscReal        reusertol;    /* re-estimate when the power iteration estimate changes by more than this relative amount */
+  Vec              evec;         /* starting vector of the power iterations, the same for the check and for the reference */
+  PetscReal        epowref,eminref,emaxref; /* power iteration and kspest estimates at the last full estimation */
+  PetscInt         nestimate,nreuse; /* number of times the estimates have been computed with kspest and reused */
   /* For tracking when to update the eigenvalue estimates */
   PetscObjectId    amatid,    pmatid;
   PetscObjectState amatstate, pmatstate;
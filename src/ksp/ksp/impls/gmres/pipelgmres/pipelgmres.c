@@ -0,0 +1,615 @@
+/*
+    This file implements p(l)-GMRES (a Generalized Minimal Residual method with a pipeline of depth l)
+*/
+
+#include <../src/ksp/ksp/impls/gmres/pipelgmres/pipelgmresimpl.h>       /*I  "petscksp.h"  I*/
+#include <petsc/private/vecimpl.h>
+#define PIPELGMRES_DELTA_DIRECTIONS 10
+#define PIPELGMRES_DEFAULT_MAXK     30
+
+static PetscErrorCode KSPPIPELGMRESUpdateHessenberg(KSP,PetscInt,PetscBool*,PetscReal*);
+static PetscErrorCode KSPPIPELGMRESBuildSoln(PetscScalar*,Vec,Vec,KSP,PetscInt);
+
+static PetscErrorCode MPIPetsc_Iallreduce(void *sendbuf,void *recvbuf,PetscMPIInt count,MPI_Datatype datatype,MPI_Op op,MPI_Comm comm,MPI_Request *request)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+#if defined(PETSC_HAVE_MPI_IALLREDUCE)
+  ierr = MPI_Iallreduce(sendbuf,recvbuf,count,datatype,op,comm,request);CHKERRQ(ierr);
+#else
+  ierr = MPIU_Allreduce(sendbuf,recvbuf,count,datatype,op,comm);CHKERRQ(ierr);
+  *request = MPI_REQUEST_NULL;
+#endif
+  PetscFunctionReturn(0);
+}
+
+/*
+
+    KSPSetUp_PIPELGMRES - Sets up the workspace needed by pipelgmres.
+
+    This is called once, usually automatically by KSPSolve() or KSPSetUp(),
+    but can be called directly by KSPSetUp().
+
+*/
+static PetscErrorCode KSPSetUp_PIPELGMRES(KSP ksp)
+{
+  KSP_PIPELGMRES *plgmres = (KSP_PIPELGMRES*)ksp->data;
+  PetscInt       l,max_k;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (plgmres->l < 1) SETERRQ1(PetscObjectComm((PetscObject)ksp),PETSC_ERR_ARG_OUTOFRANGE,"Pipeline depth %D must be positive",plgmres->l);
+  ierr = KSPSetUp_GMRES(ksp);CHKERRQ(ierr);
+  /* KSPGMRESSetRestart() resets only the GMRES part of the data structure */
+  ierr = VecDestroyVecs(plgmres->nz,&plgmres->Z);CHKERRQ(ierr);
+  ierr = PetscFree3(plgmres->sigma,plgmres->G,plgmres->req);CHKERRQ(ierr);
+  l           = plgmres->l;
+  max_k       = plgmres->max_k;
+  plgmres->nz = max_k+1;
+  ierr = KSPCreateVecs(ksp,plgmres->nz,&plgmres->Z,0,NULL);CHKERRQ(ierr);
+  ierr = PetscLogObjectParents(ksp,plgmres->nz,plgmres->Z);CHKERRQ(ierr);
+  ierr = PetscMalloc3(l,&plgmres->sigma,(max_k+1)*(max_k+1),&plgmres->G,max_k+1,&plgmres->req);CHKERRQ(ierr);
+  ierr = PetscLogObjectMemory((PetscObject)ksp,l*sizeof(PetscReal)+(max_k+1)*(max_k+1)*sizeof(PetscScalar)+(max_k+1)*sizeof(MPI_Request));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*
+
+    KSPPIPELGMRESCycle - Run pipelgmres, possibly with restart.  Return residual
+                  history if requested.
+
+    input parameters:
+.        plgmres - structure containing parameters and work areas
+
+    output parameters:
+.        itcount - number of iterations used.  If null, ignored.
+.        converged - 0 if not converged
+
+    Notes:
+    On entry, the value in vector VEC_VV(0) should be the initial residual.
+
+    The basis Z is generated with z_{i+1} = (A - sigma_i) z_i for i < l and with the Arnoldi recurrence applied to
+    z_{i+1-l} = P_l(A) v_{i+1-l}, P_l(t) = prod (t - sigma_i), for i >= l; the dot products of z_{i+1} are reduced while
+    the next l operator applications are computed. When they arrive, z_{i+1} = V G(:,i+1) gives the column of G and
+    the next orthonormal vector v_{i+1-l}, while A V G = V G B, where B holds the shifts and the earlier columns of the
+    Hessenberg matrix, gives the column i-l of the Hessenberg matrix.
+
+ */
+static PetscErrorCode KSPPIPELGMRESCycle(PetscInt *itcount,KSP ksp)
+{
+  KSP_PIPELGMRES *plgmres = (KSP_PIPELGMRES*)(ksp->data);
+  Vec            *Z       = plgmres->Z;
+  PetscScalar    *work,*hh,gb;
+  PetscReal      res,gg;
+  PetscInt       l = plgmres->l,ncol,i,a,j,k,m,nv,last = -1;
+  PetscBool      hapend = PETSC_FALSE;
+  MPI_Comm       comm;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  comm = PetscObjectComm((PetscObject)ksp);
+  if (itcount) *itcount = 0;
+  if (!VEC_VV(0)->ops->mdot_local) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_SUP,"Vector does not suppport local mdots");
+  if (!plgmres->orthogwork) {ierr = PetscMalloc1(plgmres->max_k + 2,&plgmres->orthogwork);CHKERRQ(ierr);}
+  work = plgmres->orthogwork;
+
+  ierr   = VecNormalize(VEC_VV(0),&res);CHKERRQ(ierr);
+  KSPCheckNorm(ksp,res);
+  *RS(0) = res;
+
+  /* check for the convergence */
+  ierr        = PetscObjectSAWsTakeAccess((PetscObject)ksp);CHKERRQ(ierr);
+  ksp->rnorm  = res;
+  ierr        = PetscObjectSAWsGrantAccess((PetscObject)ksp);CHKERRQ(ierr);
+  plgmres->it = -1;
+  ierr = KSPLogResidualHistory(ksp,res);CHKERRQ(ierr);
+  ierr = KSPMonitor(ksp,ksp->its,res);CHKERRQ(ierr);
+  if (!res) {
+    ksp->reason = KSP_CONVERGED_ATOL;
+    ierr        = PetscInfo(ksp,"Converged due to zero residual norm on entry\n");CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  ierr = (*ksp->converged)(ksp,ksp->its,res,&ksp->reason,ksp->cnvP);CHKERRQ(ierr);
+  if (ksp->reason) PetscFunctionReturn(0);
+
+  /* number of columns of the Hessenberg matrix computed in this cycle */
+  ncol = PetscMin(plgmres->max_k,ksp->max_it-ksp->its);
+  for (i=0; i<ncol; i++) plgmres->req[i] = MPI_REQUEST_NULL;
+  *G(0,0) = 1.0;
+  ierr    = VecCopy(VEC_VV(0),Z[0]);CHKERRQ(ierr);
+
+  for (i=0; i<ncol+l; i++) {
+    a = i-l;                    /* the column of the Hessenberg matrix completed in this iteration */
+    if (i < ncol) {
+      ierr = KSP_PCApplyBAorAB(ksp,Z[i],Z[i+1],VEC_TEMP_MATOP);CHKERRQ(ierr);
+    }
+
+    if (a >= 0) {
+      /* Complete the reduction started l iterations ago; its first nv entries are the dot products of z_{a+1} with V,
+         the others are recovered from the dot products with Z since z_j = V G(:,j) */
+      ierr = MPI_Wait(&plgmres->req[a],MPI_STATUS_IGNORE);CHKERRQ(ierr);
+      nv   = PetscMax(1,a-l+2);
+      for (j=nv; j<=a; j++) {
+        for (k=0; k<j; k++) *G(j,a+1) -= PetscConj(*G(k,j)) * *G(k,a+1);
+        *G(j,a+1) /= *G(j,j);
+      }
+      gg = PetscRealPart(*G(a+1,a+1));
+      for (k=0; k<=a; k++) gg -= PetscSqr(PetscAbsScalar(*G(k,a+1)));
+      if (gg <= 0.0 && a > 0) {
+        /* the basis has lost orthogonality, restart from the columns completed so far */
+        ierr = PetscInfo2(ksp,"Square root breakdown at iteration %D, %g, restarting\n",ksp->its,(double)gg);CHKERRQ(ierr);
+        break;
+      }
+      *G(a+1,a+1) = gg > 0.0 ? PetscSqrtReal(gg) : 0.0;
+
+      /* Column a of the Hessenberg matrix from H G(0:a,0:a) = G B(:,0:a) */
+      hh = HH(0,a);
+      for (j=0; j<=a+1; j++) {
+        if (a < l) {
+          gb = *G(j,a+1);
+          if (j <= a) gb += plgmres->sigma[a] * *G(j,a);
+        } else {
+          gb = 0.0;
+          for (m=PetscMax(0,j-l); m<=a-l+1; m++) gb += *HES(m,a-l) * *G(j,m+l);
+        }
+        for (k=PetscMax(0,j-1); k<a; k++) gb -= *G(k,a) * *HES(j,k);
+        hh[j] = gb / *G(a,a);
+      }
+
+      ierr        = KSPPIPELGMRESUpdateHessenberg(ksp,a,&hapend,&res);CHKERRQ(ierr);
+      last        = a;
+      plgmres->it = a;
+      ierr        = PetscObjectSAWsTakeAccess((PetscObject)ksp);CHKERRQ(ierr);
+      ksp->its++;
+      ksp->rnorm  = res;
+      ierr        = PetscObjectSAWsGrantAccess((PetscObject)ksp);CHKERRQ(ierr);
+
+      ierr = (*ksp->converged)(ksp,ksp->its,res,&ksp->reason,ksp->cnvP);CHKERRQ(ierr);
+      if (a < plgmres->max_k-1 || ksp->reason || ksp->its == ksp->max_it) {  /* Monitor if we are done or still iterating, but not before a restart. */
+        ierr = KSPLogResidualHistory(ksp,res);CHKERRQ(ierr);
+        ierr = KSPMonitor(ksp,ksp->its,res);CHKERRQ(ierr);
+      }
+      if (ksp->reason) break;
+      /* Catch error in happy breakdown and signal convergence and break from loop */
+      if (hapend) {
+        if (ksp->errorifnotconverged) SETERRQ1(PetscObjectComm((PetscObject)ksp),PETSC_ERR_NOT_CONVERGED,"You reached the happy break down, but convergence was not indicated. Residual norm = %g",(double)res);
+        else {
+          ksp->reason = KSP_DIVERGED_BREAKDOWN;
+          break;
+        }
+      }
+      if (a == ncol-1) break;
+
+      /* v_{a+1} = (z_{a+1} - V(:,0:a) G(0:a,a+1)) / G(a+1,a+1) */
+      if (plgmres->vv_allocated <= a + 1 + VEC_OFFSET) {
+        ierr = KSPGMRESGetNewVectors(ksp,a+1);CHKERRQ(ierr);
+      }
+      for (k=0; k<=a; k++) work[k] = -*G(k,a+1);
+      ierr = VecCopy(Z[a+1],VEC_VV(a+1));CHKERRQ(ierr);
+      ierr = VecMAXPY(VEC_VV(a+1),a+1,work,&VEC_VV(0));CHKERRQ(ierr);
+      ierr = VecScale(VEC_VV(a+1),1.0 / *G(a+1,a+1));CHKERRQ(ierr);
+    }
+
+    if (i < ncol) {
+      if (a < 0) {
+        ierr = VecAXPY(Z[i+1],-plgmres->sigma[i],Z[i]);CHKERRQ(ierr);
+      } else {
+        /* z_{i+1} = P_l(A) v_{a+1} = (A z_i - Z(:,l:l+a) H(0:a,a)) / H(a+1,a) */
+        for (j=0; j<=a; j++) work[j] = -*HES(j,a);
+        ierr = VecMAXPY(Z[i+1],a+1,work,&Z[l]);CHKERRQ(ierr);
+        ierr = VecScale(Z[i+1],1.0 / *HES(a+1,a));CHKERRQ(ierr);
+      }
+      /* Start the reduction of the dot products of z_{i+1} with v_0,...,v_{nv-1} and z_nv,...,z_{i+1} */
+      nv   = PetscMax(1,i-l+2);
+      ierr = (*Z[i+1]->ops->mdot_local)(Z[i+1],nv,&VEC_VV(0),G(0,i+1));CHKERRQ(ierr);
+      ierr = (*Z[i+1]->ops->mdot_local)(Z[i+1],i+2-nv,&Z[nv],G(nv,i+1));CHKERRQ(ierr);
+      ierr = MPIPetsc_Iallreduce(MPI_IN_PLACE,G(0,i+1),i+2,MPIU_SCALAR,MPIU_SUM,comm,&plgmres->req[i]);CHKERRQ(ierr);
+    }
+  }
+  /* Complete the reductions still in flight */
+  ierr = MPI_Waitall(ncol,plgmres->req,MPI_STATUSES_IGNORE);CHKERRQ(ierr);
+
+  if (itcount) *itcount = last+1; /* Number of iterations actually completed. */
+
+  /*
+    Down here we have to solve for the "best" coefficients of the Krylov
+    columns, add the solution values together, and possibly unwind the
+    preconditioning from the solution
+   */
+  /* Form the solution (or the solution so far) */
+  ierr = KSPPIPELGMRESBuildSoln(RS(0),ksp->vec_sol,ksp->vec_sol,ksp,last);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*
+    KSPSolve_PIPELGMRES - This routine applies the PIPELGMRES method.
+
+
+   Input Parameter:
+.     ksp - the Krylov space object that was set to use pipelgmres
+
+   Output Parameter:
+.     outits - number of iterations used
+
+*/
+static PetscErrorCode KSPSolve_PIPELGMRES(KSP ksp)
+{
+  KSP_PIPELGMRES *plgmres    = (KSP_PIPELGMRES*)ksp->data;
+  PetscBool      guess_zero  = ksp->guess_zero,have_residual = PETSC_FALSE;
+  PetscReal      lmin        = plgmres->lmin,lmax = plgmres->lmax,rnorm;
+  PetscInt       i,l         = plgmres->l;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (ksp->calc_sings && !plgmres->Rsvd) SETERRQ(PetscObjectComm((PetscObject)ksp),PETSC_ERR_ORDER,"Must call KSPSetComputeSingularValues() before KSPSetUp() is called");
+  for (i=0; i<l; i++) plgmres->sigma[i] = 0.5*(lmin+lmax) + 0.5*(lmax-lmin)*PetscCosReal(PETSC_PI*(2.0*i+1.0)/(2.0*l));
+
+  ierr     = PetscObjectSAWsTakeAccess((PetscObject)ksp);CHKERRQ(ierr);
+  ksp->its = 0;
+  ierr     = PetscObjectSAWsGrantAccess((PetscObject)ksp);CHKERRQ(ierr);
+
+  ksp->reason = KSP_CONVERGED_ITERATING;
+  while (!ksp->reason) {
+    if (!have_residual) {
+      ierr = KSPInitialResidual(ksp,ksp->vec_sol,VEC_TEMP,VEC_TEMP_MATOP,VEC_VV(0),ksp->vec_rhs);CHKERRQ(ierr);
+    }
+    have_residual   = PETSC_FALSE;
+    ierr            = KSPPIPELGMRESCycle(NULL,ksp);CHKERRQ(ierr);
+    ksp->guess_zero = PETSC_FALSE; /* every future call to KSPInitialResidual() will have nonzero guess */
+    if (ksp->reason > 0 && plgmres->replace) {
+      /* Replace the residual computed by the recurrences with the true one, and keep iterating if that has not converged */
+      ierr = KSPInitialResidual(ksp,ksp->vec_sol,VEC_TEMP,VEC_TEMP_MATOP,VEC_VV(0),ksp->vec_rhs);CHKERRQ(ierr);
+      ierr = VecNorm(VEC_VV(0),NORM_2,&rnorm);CHKERRQ(ierr);
+      KSPCheckNorm(ksp,rnorm);
+      ierr = PetscObjectSAWsTakeAccess((PetscObject)ksp);CHKERRQ(ierr);
+      ksp->rnorm = rnorm;
+      ierr = PetscObjectSAWsGrantAccess((PetscObject)ksp);CHKERRQ(ierr);
+      ierr = (*ksp->converged)(ksp,ksp->its,rnorm,&ksp->reason,ksp->cnvP);CHKERRQ(ierr);
+      if (!ksp->reason) {
+        ierr          = PetscInfo1(ksp,"True residual norm %g has not converged, restarting from it\n",(double)rnorm);CHKERRQ(ierr);
+        have_residual = PETSC_TRUE;
+      }
+    }
+    if (!ksp->reason && ksp->its >= ksp->max_it) ksp->reason = KSP_DIVERGED_ITS;
+  }
+  ksp->guess_zero = guess_zero; /* restore if user provided nonzero initial guess */
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPReset_PIPELGMRES(KSP ksp)
+{
+  KSP_PIPELGMRES *plgmres = (KSP_PIPELGMRES*)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = VecDestroyVecs(plgmres->nz,&plgmres->Z);CHKERRQ(ierr);
+  ierr = PetscFree3(plgmres->sigma,plgmres->G,plgmres->req);CHKERRQ(ierr);
+  plgmres->nz = 0;
+  ierr = KSPReset_GMRES(ksp);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPDestroy_PIPELGMRES(KSP ksp)
+{
+  KSP_PIPELGMRES *plgmres = (KSP_PIPELGMRES*)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = VecDestroyVecs(plgmres->nz,&plgmres->Z);CHKERRQ(ierr);
+  ierr = PetscFree3(plgmres->sigma,plgmres->G,plgmres->req);CHKERRQ(ierr);
+  ierr = KSPDestroy_GMRES(ksp);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*
+    KSPPIPELGMRESBuildSoln - create the solution from the starting vector and the
+                      current iterates.
+
+    Input parameters:
+        nrs - work area of size it + 1.
+        vguess  - index of initial guess
+        vdest - index of result.  Note that vguess may == vdest (replace
+                guess with the solution).
+        it - HH upper triangular part is a block of size (it+1) x (it+1)
+
+     This is an internal routine that knows about the PIPELGMRES internals.
+ */
+static PetscErrorCode KSPPIPELGMRESBuildSoln(PetscScalar *nrs,Vec vguess,Vec vdest,KSP ksp,PetscInt it)
+{
+  PetscScalar    tt;
+  PetscErrorCode ierr;
+  PetscInt       k,j;
+  KSP_PIPELGMRES *plgmres = (KSP_PIPELGMRES*)(ksp->data);
+
+  PetscFunctionBegin;
+  /* Solve for solution vector that minimizes the residual */
+
+  if (it < 0) {                                 /* no pipelgmres steps have been performed */
+    ierr = VecCopy(vguess,vdest);CHKERRQ(ierr); /* VecCopy() is smart, exits immediately if vguess == vdest */
+    PetscFunctionReturn(0);
+  }
+
+  /* solve the upper triangular system - RS is the right side and HH is
+     the upper triangular matrix  - put soln in nrs */
+  if (*HH(it,it) != 0.0) nrs[it] = *RS(it) / *HH(it,it);
+  else nrs[it] = 0.0;
+
+  for (k=it-1; k>=0; k--) {
+    tt = *RS(k);
+    for (j=k+1; j<=it; j++) tt -= *HH(k,j) * nrs[j];
+    nrs[k] = tt / *HH(k,k);
+  }
+
+  /* Accumulate the correction to the solution of the preconditioned problem in TEMP */
+  ierr = VecZeroEntries(VEC_TEMP);CHKERRQ(ierr);
+  ierr = VecMAXPY(VEC_TEMP,it+1,nrs,&VEC_VV(0));CHKERRQ(ierr);
+  ierr = KSPUnwindPreconditioner(ksp,VEC_TEMP,VEC_TEMP_MATOP);CHKERRQ(ierr);
+  /* add solution to previous solution */
+  if (vdest == vguess) {
+    ierr = VecAXPY(vdest,1.0,VEC_TEMP);CHKERRQ(ierr);
+  } else {
+    ierr = VecWAXPY(vdest,1.0,VEC_TEMP,vguess);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+/*
+
+    KSPPIPELGMRESUpdateHessenberg - Do the scalar work for the orthogonalization.
+                            Return new residual.
+
+    input parameters:
+
+.        ksp -    Krylov space object
+.        it  -    plane rotations are applied to the (it+1)th column of the
+                  modified hessenberg (i.e. HH(:,it))
+.        hapend - PETSC_FALSE not happy breakdown ending.
+
+    output parameters:
+.        res - the new residual
+
+ */
+static PetscErrorCode KSPPIPELGMRESUpdateHessenberg(KSP ksp,PetscInt it,PetscBool *hapend,PetscReal *res)
+{
+  PetscScalar    *hh,*cc,*ss,*rs;
+  PetscInt       j;
+  PetscReal      hapbnd;
+  KSP_PIPELGMRES *plgmres = (KSP_PIPELGMRES*)(ksp->data);
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  hh = HH(0,it);   /* pointer to beginning of column to update */
+  cc = CC(0);      /* beginning of cosine rotations */
+  ss = SS(0);      /* beginning of sine rotations */
+  rs = RS(0);      /* right hand side of least squares system */
+
+  /* The Hessenberg matrix is now correct through column it, save that form for the next columns and for spectral analysis */
+  for (j=0; j<=it+1; j++) *HES(j,it) = hh[j];
+
+  /* check for the happy breakdown */
+  hapbnd = PetscMin(PetscAbsScalar(hh[it+1] / rs[it]),plgmres->haptol);
+  if (PetscAbsScalar(hh[it+1]) < hapbnd) {
+    ierr    = PetscInfo4(ksp,"Detected happy breakdown, current hapbnd = %14.12e H(%D,%D) = %14.12e\n",(double)hapbnd,it+1,it,(double)PetscAbsScalar(*HH(it+1,it)));CHKERRQ(ierr);
+    *hapend = PETSC_TRUE;
+  }
+
+  /* Apply all the previously computed plane rotations to the new column
+     of the Hessenberg matrix */
+  /* Note: this uses the rotation [conj(c)  s ; -s   c], c= cos(theta), s= sin(theta),
+     and some refs have [c   s ; -conj(s)  c] (don't be confused!) */
+
+  for (j=0; j<it; j++) {
+    PetscScalar hhj = hh[j];
+    hh[j]   = PetscConj(cc[j])*hhj + ss[j]*hh[j+1];
+    hh[j+1] =          -ss[j] *hhj + cc[j]*hh[j+1];
+  }
+
+  /*
+    compute the new plane rotation, and apply it to:
+     1) the right-hand-side of the Hessenberg system (RS)
+        note: it affects RS(it) and RS(it+1)
+     2) the new column of the Hessenberg matrix
+        note: it affects HH(it,it) which is currently pointed to
+        by hh and HH(it+1, it) (*(hh+1))
+    thus obtaining the updated value of the residual...
+  */
+
+  /* compute new plane rotation */
+
+  if (!*hapend) {
+    PetscReal delta = PetscSqrtReal(PetscSqr(PetscAbsScalar(hh[it])) + PetscSqr(PetscAbsScalar(hh[it+1])));
+    if (delta == 0.0) {
+      ksp->reason = KSP_DIVERGED_NULL;
+      PetscFunctionReturn(0);
+    }
+
+    cc[it] = hh[it] / delta;    /* new cosine value */
+    ss[it] = hh[it+1] / delta;  /* new sine value */
+
+    hh[it]   = PetscConj(cc[it])*hh[it] + ss[it]*hh[it+1];
+    rs[it+1] = -ss[it]*rs[it];
+    rs[it]   = PetscConj(cc[it])*rs[it];
+    *res     = PetscAbsScalar(rs[it+1]);
+  } else { /* happy breakdown: HH(it+1, it) = 0, therefore we don't need to apply
+            another rotation matrix (so RH doesn't change).  The new residual is
+            always the new sine term times the residual from last time (RS(it)),
+            but now the new sine rotation would be zero...so the residual should
+            be zero...so we will multiply "zero" by the last residual.  This might
+            not be exactly what we want to do here -could just return "zero". */
+
+    *res = 0.0;
+  }
+  PetscFunctionReturn(0);
+}
+
+/*
+   KSPBuildSolution_PIPELGMRES
+
+     Input Parameter:
+.     ksp - the Krylov space object
+.     ptr-
+
+   Output Parameter:
+.     result - the solution
+
+   Note: this calls KSPPIPELGMRESBuildSoln - the same function that KSPPIPELGMRESCycle
+   calls directly.
+
+*/
+static PetscErrorCode KSPBuildSolution_PIPELGMRES(KSP ksp,Vec ptr,Vec *result)
+{
+  KSP_PIPELGMRES *plgmres = (KSP_PIPELGMRES*)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (!ptr) {
+    if (!plgmres->sol_temp) {
+      ierr = VecDuplicate(ksp->vec_sol,&plgmres->sol_temp);CHKERRQ(ierr);
+      ierr = PetscLogObjectParent((PetscObject)ksp,(PetscObject)plgmres->sol_temp);CHKERRQ(ierr);
+    }
+    ptr = plgmres->sol_temp;
+  }
+  if (!plgmres->nrs) {
+    /* allocate the work area */
+    ierr = PetscMalloc1(plgmres->max_k,&plgmres->nrs);CHKERRQ(ierr);
+    ierr = PetscLogObjectMemory((PetscObject)ksp,plgmres->max_k*sizeof(PetscScalar));CHKERRQ(ierr);
+  }
+
+  ierr = KSPPIPELGMRESBuildSoln(plgmres->nrs,ksp->vec_sol,ptr,ksp,plgmres->it);CHKERRQ(ierr);
+  if (result) *result = ptr;
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPView_PIPELGMRES(KSP ksp,PetscViewer viewer)
+{
+  KSP_PIPELGMRES *plgmres = (KSP_PIPELGMRES*)ksp->data;
+  PetscErrorCode ierr;
+  PetscBool      iascii,isstring;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectTypeCompare((PetscObject)viewer,PETSCVIEWERASCII,&iascii);CHKERRQ(ierr);
+  ierr = PetscObjectTypeCompare((PetscObject)viewer,PETSCVIEWERSTRING,&isstring);CHKERRQ(ierr);
+  if (iascii) {
+    ierr = PetscViewerASCIIPrintf(viewer,"  restart=%D, pipeline depth l=%D\n",plgmres->max_k,plgmres->l);CHKERRQ(ierr);
+    ierr = PetscViewerASCIIPrintf(viewer,"  shifts from the interval [%g, %g]\n",(double)plgmres->lmin,(double)plgmres->lmax);CHKERRQ(ierr);
+    if (plgmres->replace) {ierr = PetscViewerASCIIPrintf(viewer,"  convergence checked with the true residual\n");CHKERRQ(ierr);}
+    ierr = PetscViewerASCIIPrintf(viewer,"  happy breakdown tolerance %g\n",(double)plgmres->haptol);CHKERRQ(ierr);
+  } else if (isstring) {
+    ierr = PetscViewerStringSPrintf(viewer,"restart %D l %D",plgmres->max_k,plgmres->l);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPSetFromOptions_PIPELGMRES(PetscOptionItems *PetscOptionsObject,KSP ksp)
+{
+  KSP_PIPELGMRES *plgmres = (KSP_PIPELGMRES*)ksp->data;
+  PetscInt       l        = plgmres->l;
+  PetscBool      flg;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = KSPSetFromOptions_GMRES(PetscOptionsObject,ksp);CHKERRQ(ierr);
+  ierr = PetscOptionsHead(PetscOptionsObject,"KSP deep pipelined GMRES Options");CHKERRQ(ierr);
+  ierr = PetscOptionsInt("-ksp_pipelgmres_pipel","Pipeline depth, number of reductions in flight","None",l,&l,&flg);CHKERRQ(ierr);
+  if (flg && l < 1) SETERRQ1(PetscObjectComm((PetscObject)ksp),PETSC_ERR_ARG_OUTOFRANGE,"Pipeline depth %D must be positive",l);
+  if (!ksp->setupstage) {
+    plgmres->l = l;
+  } else if (l != plgmres->l) {
+    /* free the data structures, then create them again */
+    ierr            = KSPReset_PIPELGMRES(ksp);CHKERRQ(ierr);
+    plgmres->l      = l;
+    ksp->setupstage = KSP_SETUP_NEW;
+  }
+  ierr = PetscOptionsReal("-ksp_pipelgmres_lmin","Estimate of the smallest eigenvalue (real part) of the preconditioned operator","None",plgmres->lmin,&plgmres->lmin,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsReal("-ksp_pipelgmres_lmax","Estimate of the largest eigenvalue (real part) of the preconditioned operator","None",plgmres->lmax,&plgmres->lmax,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsBool("-ksp_pipelgmres_replace","Check convergence with the true residual and restart from it if needed","None",plgmres->replace,&plgmres->replace,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsTail();CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*MC
+     KSPPIPELGMRES - Implements the p(l)-GMRES method, a Generalized Minimal Residual method with a pipeline of depth l.
+
+   Options Database Keys:
++   -ksp_gmres_restart <restart> - the number of Krylov directions to orthogonalize against
+.   -ksp_gmres_haptol <tol> - sets the tolerance for "happy ending" (exact convergence)
+.   -ksp_gmres_preallocate - preallocate all the Krylov search directions initially (otherwise groups of
+                             vectors are allocated as needed)
+.   -ksp_pipelgmres_pipel <l> - the pipeline depth, number of global reductions in flight (default 1)
+.   -ksp_pipelgmres_lmin <lmin> - estimate of the smallest eigenvalue of the preconditioned operator (default 0.0)
+.   -ksp_pipelgmres_lmax <lmax> - estimate of the largest eigenvalue of the preconditioned operator (default 0.0)
+-   -ksp_pipelgmres_replace - when the recursively computed residual norm converges, compute the true residual and
+                              restart from it if it has not converged
+
+   Level: advanced
+
+   Notes:
+   Each iteration has a single non-blocking global reduction, which is overlapped with the operator and preconditioner
+   applications of the next l iterations, compared to one reduction hidden behind one application for KSPPGMRES and
+   KSPPIPEFGMRES. The auxiliary basis is generated with the Newton polynomial whose roots (shifts) are the Chebyshev
+   nodes of [lmin,lmax]; with the default interval the basis is monomial, which is only well conditioned for small l.
+   The orthonormal basis and the Hessenberg matrix are recovered from the dot products of the auxiliary basis, so the
+   restart, least squares solution, eigenvalue and singular value estimates are those of KSPGMRES.
+
+   If the Gram-Schmidt coefficients show that the basis has lost orthogonality (square root breakdown), the method
+   restarts from the true residual with the iterations completed so far. Since the residual norm is computed by
+   recurrences, -ksp_pipelgmres_replace can be used to bound the difference with the true residual at convergence.
+
+   MPI configuration may be necessary for reductions to make asynchronous progress, which is important for performance of pipelined methods.
+   See the FAQ on the PETSc website for details.
+
+   Reference:
+   Ghysels, Ashby, Meerbergen, Vanroose, Hiding global communication latencies in the GMRES algorithm on massively parallel machines, 2012.
+
+   Developer Notes:
+    This object is subclassed off of KSPGMRES
+
+.seealso:  KSPCreate(), KSPSetType(), KSPType (for list of available types), KSP, KSPGMRES, KSPPGMRES, KSPPIPEFGMRES, KSPPIPELCG,
+           KSPGMRESSetRestart(), KSPGMRESSetHapTol(), KSPGMRESSetPreAllocateVectors()
+M*/
+
+PETSC_EXTERN PetscErrorCode KSPCreate_PIPELGMRES(KSP ksp)
+{
+  KSP_PIPELGMRES *plgmres;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscNewLog(ksp,&plgmres);CHKERRQ(ierr);
+
+  ksp->data                              = (void*)plgmres;
+  ksp->ops->buildsolution                = KSPBuildSolution_PIPELGMRES;
+  ksp->ops->setup                        = KSPSetUp_PIPELGMRES;
+  ksp->ops->solve                        = KSPSolve_PIPELGMRES;
+  ksp->ops->reset                        = KSPReset_PIPELGMRES;
+  ksp->ops->destroy                      = KSPDestroy_PIPELGMRES;
+  ksp->ops->view                         = KSPView_PIPELGMRES;
+  ksp->ops->setfromoptions               = KSPSetFromOptions_PIPELGMRES;
+  ksp->ops->computeextremesingularvalues = KSPComputeExtremeSingularValues_GMRES;
+  ksp->ops->computeeigenvalues           = KSPComputeEigenvalues_GMRES;
+
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_PRECONDITIONED,PC_LEFT,3);CHKERRQ(ierr);
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_UNPRECONDITIONED,PC_RIGHT,2);CHKERRQ(ierr);
+
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPGMRESSetPreAllocateVectors_C",KSPGMRESSetPreAllocateVectors_GMRES);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPGMRESSetRestart_C",KSPGMRESSetRestart_GMRES);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPGMRESGetRestart_C",KSPGMRESGetRestart_GMRES);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPGMRESSetHapTol_C",KSPGMRESSetHapTol_GMRES);CHKERRQ(ierr);
+
+  plgmres->nextra_vecs    = 1;
+  plgmres->haptol         = 1.0e-30;
+  plgmres->q_preallocate  = 0;
+  plgmres->delta_allocate = PIPELGMRES_DELTA_DIRECTIONS;
+  plgmres->orthog         = KSPGMRESClassicalGramSchmidtOrthogonalization;
+  plgmres->nrs            = 0;
+  plgmres->sol_temp       = 0;
+  plgmres->max_k          = PIPELGMRES_DEFAULT_MAXK;
+  plgmres->Rsvd           = 0;
+  plgmres->orthogwork     = 0;
+  plgmres->cgstype        = KSP_GMRES_CGS_REFINE_NEVER;
+  plgmres->l              = 1;
+  plgmres->lmin           = 0.0;
+  plgmres->lmax           = 0.0;
+  plgmres->replace        = PETSC_FALSE;
+  PetscFunctionReturn(0);
+}
@@ -0,0 +1,37 @@
+#if !defined(__PIPELGMRES)
+#define __PIPELGMRES
+
+#define KSPGMRES_NO_MACROS
+#include <../src/ksp/ksp/impls/gmres/gmresimpl.h>
+
+typedef struct {
+  KSPGMRESHEADER
+
+  PetscInt    l;                  /* pipeline depth, number of reductions in flight */
+  PetscReal   lmin,lmax;          /* interval whose Chebyshev nodes are used as shifts of the basis */
+  PetscReal   *sigma;             /* shifts of the first l basis vectors */
+  PetscBool   replace;            /* check convergence with the true residual and restart from it if needed */
+  PetscInt    nz;                 /* number of allocated Z vectors */
+  Vec         *Z;                 /* shifted basis Z = V G computed without waiting for the reductions */
+  PetscScalar *G;                 /* (max_k+1) x (max_k+1) upper triangular change of basis */
+  MPI_Request *req;               /* requests of the reductions in flight, one per basis vector */
+} KSP_PIPELGMRES;
+
+#define HH(a,b)  (plgmres->hh_origin + (b)*(plgmres->max_k+2)+(a))
+/* HH will be size (max_k+2)*(max_k+1)  -  think of HH as
+   being stored columnwise for access purposes. */
+#define HES(a,b) (plgmres->hes_origin + (b)*(plgmres->max_k+1)+(a))
+/* HES will be size (max_k + 1) * (max_k + 1) -
+   again, think of HES as being stored columnwise */
+#define CC(a)    (plgmres->cc_origin + (a)) /* CC will be length (max_k+1) - cosines */
+#define SS(a)    (plgmres->ss_origin + (a)) /* SS will be length (max_k+1) - sines */
+#define RS(a)    (plgmres->rs_origin + (a)) /* RS will be length (max_k+2) - rt side */
+#define G(a,b)   (plgmres->G + (b)*(plgmres->max_k+1)+(a)) /* G will be size (max_k+1)*(max_k+1), stored columnwise */
+
+/* vector names */
+#define VEC_OFFSET     2
+#define VEC_TEMP       plgmres->vecs[0]               /* work space */
+#define VEC_TEMP_MATOP plgmres->vecs[1]               /* work space */
+#define VEC_VV(i)      plgmres->vecs[VEC_OFFSET+i]    /* use to access
+                                                        othog basis vectors */
+#endif
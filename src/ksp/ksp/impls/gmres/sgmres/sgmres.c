@@ -0,0 +1,844 @@
+
+/*
+    This file implements SGMRES (a communication avoiding s-step Generalized Minimal Residual method)
+*/
+
+#include <../src/ksp/ksp/impls/gmres/sgmres/sgmresimpl.h>       /*I  "petscksp.h"  I*/
+#include <petscblaslapack.h>
+#define SGMRES_DELTA_DIRECTIONS 10
+#define SGMRES_DEFAULT_MAXK     30
+#define SGMRES_DEFAULT_S        4
+
+static const char *const KSPSGMRESBasisTypes[] = {"newton","chebyshev","monomial"};
+
+static PetscErrorCode KSPSGMRESUpdateHessenberg(KSP,PetscInt,PetscBool*,PetscReal*);
+static PetscErrorCode KSPSGMRESBuildSoln(PetscScalar*,Vec,Vec,KSP,PetscInt);
+
+/*
+
+    KSPSetUp_SGMRES - Sets up the workspace needed by sgmres.
+
+    This is called once, usually automatically by KSPSolve() or KSPSetUp(),
+    but can be called directly by KSPSetUp().
+
+*/
+static PetscErrorCode KSPSetUp_SGMRES(KSP ksp)
+{
+  KSP_SGMRES     *sgmres = (KSP_SGMRES*)ksp->data;
+  PetscInt       s,max_k;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (sgmres->s < 1) SETERRQ1(PetscObjectComm((PetscObject)ksp),PETSC_ERR_ARG_OUTOFRANGE,"Block size s %D must be positive",sgmres->s);
+  ierr = KSPSetUp_GMRES(ksp);CHKERRQ(ierr);
+  /* KSPGMRESSetRestart() resets only the GMRES part of the data structure */
+  ierr = PetscFree2(sgmres->shift_re,sgmres->shift_im);CHKERRQ(ierr);
+  ierr = PetscFree7(sgmres->B,sgmres->C,sgmres->C2,sgmres->N,sgmres->N2,sgmres->R,sgmres->Hn);CHKERRQ(ierr);
+  sgmres->s = PetscMin(sgmres->s,sgmres->max_k);
+  s         = sgmres->s;
+  max_k     = sgmres->max_k;
+  ierr = PetscMalloc2(s,&sgmres->shift_re,s,&sgmres->shift_im);CHKERRQ(ierr);
+  ierr = PetscMalloc7((s+1)*s,&sgmres->B,(max_k+1)*s,&sgmres->C,(max_k+1)*s,&sgmres->C2,s*s,&sgmres->N,s*s,&sgmres->N2,s*s,&sgmres->R,(max_k+s+1)*s,&sgmres->Hn);CHKERRQ(ierr);
+  ierr = PetscLogObjectMemory((PetscObject)ksp,2*s*sizeof(PetscReal)+((s+1)*s+2*(max_k+1)*s+3*s*s+(max_k+s+1)*s)*sizeof(PetscScalar));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*
+    KSPSGMRESComputeShifts - Computes the Ritz values from the leading s x s block of the Hessenberg matrix built
+    during the warm-up, orders them in the Leja ordering and derives the scaling and Chebyshev interval of the basis.
+*/
+static PetscErrorCode KSPSGMRESComputeShifts(KSP ksp)
+{
+  KSP_SGMRES     *sgmres = (KSP_SGMRES*)ksp->data;
+  PetscInt       s = sgmres->s,i,j,k,n,*used;
+  PetscReal      *wr,*wi,rho = 0.0,lmin = PETSC_MAX_REAL,lmax = PETSC_MIN_REAL;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+#if defined(PETSC_MISSING_LAPACK_GEEV) || defined(PETSC_HAVE_ESSL)
+  ierr = PetscInfo(ksp,"Eigenvalue routine unavailable, using the scaled monomial basis\n");CHKERRQ(ierr);
+  for (i=0; i<s; i++) {
+    sgmres->shift_re[i] = 0.0;
+    sgmres->shift_im[i] = 0.0;
+    rho = PetscMax(rho,PetscAbsScalar(*HES(i+1,i)));
+  }
+  sgmres->sigma  = rho > 0.0 ? 1.0/rho : 1.0;
+  sgmres->cheb_c = 0.0;
+  sgmres->cheb_d = rho > 0.0 ? rho : 1.0;
+#else
+  {
+    PetscScalar  *H,*work,sdummy;
+    PetscBLASInt bn,lwork,idummy = 1,lierr;
+#if defined(PETSC_USE_COMPLEX)
+    PetscScalar  *eigs;
+    PetscReal    *rwork;
+#endif
+
+    ierr = PetscBLASIntCast(s,&bn);CHKERRQ(ierr);
+    ierr = PetscBLASIntCast(5*s,&lwork);CHKERRQ(ierr);
+    ierr = PetscMalloc2(s,&wr,s,&wi);CHKERRQ(ierr);
+    ierr = PetscMalloc2(s*s,&H,5*s,&work);CHKERRQ(ierr);
+    for (j=0; j<s; j++) for (i=0; i<s; i++) H[i+j*s] = *HES(i,j);
+    ierr = PetscFPTrapPush(PETSC_FP_TRAP_OFF);CHKERRQ(ierr);
+#if !defined(PETSC_USE_COMPLEX)
+    PetscStackCallBLAS("LAPACKgeev",LAPACKgeev_("N","N",&bn,H,&bn,wr,wi,&sdummy,&idummy,&sdummy,&idummy,work,&lwork,&lierr));
+#else
+    ierr = PetscMalloc2(s,&eigs,2*s,&rwork);CHKERRQ(ierr);
+    PetscStackCallBLAS("LAPACKgeev",LAPACKgeev_("N","N",&bn,H,&bn,eigs,&sdummy,&idummy,&sdummy,&idummy,work,&lwork,rwork,&lierr));
+    for (i=0; i<s; i++) {
+      wr[i] = PetscRealPart(eigs[i]);
+      wi[i] = PetscImaginaryPart(eigs[i]);
+    }
+    ierr = PetscFree2(eigs,rwork);CHKERRQ(ierr);
+#endif
+    if (lierr) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_LIB,"Error in LAPACK routine %d",(int)lierr);
+    ierr = PetscFPTrapPop();CHKERRQ(ierr);
+    ierr = PetscFree2(H,work);CHKERRQ(ierr);
+  }
+
+  /* Leja ordering: start with the largest Ritz value, then repeatedly take the one maximizing the product of the
+     distances to the values already taken. In real arithmetic a complex conjugate pair is always taken together,
+     the one with positive imaginary part first. */
+  ierr = PetscCalloc1(s,&used);CHKERRQ(ierr);
+  for (n=0; n<s; ) {
+    PetscReal best = PETSC_MIN_REAL,dist;
+    PetscInt  ibest = -1;
+
+    for (i=0; i<s; i++) {
+      if (used[i]) continue;
+#if !defined(PETSC_USE_COMPLEX)
+      if (wi[i] < 0.0) continue;
+#endif
+      if (!n) dist = PetscSqrtReal(wr[i]*wr[i]+wi[i]*wi[i]);
+      else {
+        dist = 0.0;
+        for (k=0; k<n; k++) {
+          PetscReal dr = wr[i]-sgmres->shift_re[k],di = wi[i]-sgmres->shift_im[k];
+          dist += PetscLogReal(PetscMax(PetscSqrtReal(dr*dr+di*di),PETSC_SMALL));
+        }
+      }
+      if (dist > best) {best = dist; ibest = i;}
+    }
+    used[ibest]         = 1;
+    sgmres->shift_re[n] = wr[ibest];
+    sgmres->shift_im[n] = wi[ibest];
+    n++;
+#if !defined(PETSC_USE_COMPLEX)
+    if (wi[ibest] > 0.0) {
+      for (i=0; i<s; i++) if (!used[i] && wi[i] < 0.0 && wr[i] == wr[ibest] && wi[i] == -wi[ibest]) break;
+      if (i < s) used[i] = 1;
+      sgmres->shift_re[n] = wr[ibest];
+      sgmres->shift_im[n] = -wi[ibest];
+      n++;
+    }
+#endif
+  }
+  ierr = PetscFree(used);CHKERRQ(ierr);
+
+  for (i=0; i<s; i++) {
+    rho  = PetscMax(rho,PetscSqrtReal(wr[i]*wr[i]+wi[i]*wi[i]));
+    lmin = PetscMin(lmin,wr[i]);
+    lmax = PetscMax(lmax,wr[i]);
+  }
+  sgmres->sigma  = rho > 0.0 ? 1.0/rho : 1.0;
+  sgmres->cheb_c = 0.5*(lmax+lmin);
+  sgmres->cheb_d = 0.5*(lmax-lmin);
+  if (sgmres->cheb_d <= PETSC_SMALL*PetscAbsReal(sgmres->cheb_c)) sgmres->cheb_d = PetscAbsReal(sgmres->cheb_c) > 0.0 ? PetscAbsReal(sgmres->cheb_c) : 1.0;
+  ierr = PetscFree2(wr,wi);CHKERRQ(ierr);
+#endif
+  ierr = PetscInfo4(ksp,"Basis from %D Ritz values, spectral radius estimate %g, real parts in [%g, %g]\n",s,(double)(1.0/sgmres->sigma),(double)(sgmres->cheb_c-sgmres->cheb_d),(double)(sgmres->cheb_c+sgmres->cheb_d));CHKERRQ(ierr);
+  sgmres->shifts_set = PETSC_TRUE;
+  PetscFunctionReturn(0);
+}
+
+/*
+    KSPSGMRESBasisMatrix - Fills the (ns+1) x ns change of basis matrix B, A Z(:,0:ns-1) = Z B, for the polynomial basis
+    Z(:,i+1) = (A Z(:,i) - sum_{r<=i} B(r,i) Z(:,r)) / B(i+1,i). During the warm-up the unscaled monomial basis is used.
+*/
+static PetscErrorCode KSPSGMRESBasisMatrix(KSP ksp,PetscInt ns)
+{
+  KSP_SGMRES     *sgmres = (KSP_SGMRES*)ksp->data;
+  PetscInt       ld = sgmres->s+1,i;
+  PetscScalar    *B = sgmres->B;
+  PetscReal      sigma = sgmres->shifts_set ? sgmres->sigma : 1.0,c = sgmres->cheb_c,d = sgmres->cheb_d;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscMemzero(B,ld*ns*sizeof(PetscScalar));CHKERRQ(ierr);
+  if (!sgmres->shifts_set || sgmres->basis == KSP_SGMRES_BASIS_MONOMIAL) {
+    for (i=0; i<ns; i++) B[i+1+i*ld] = 1.0/sigma;
+  } else if (sgmres->basis == KSP_SGMRES_BASIS_NEWTON) {
+    for (i=0; i<ns; i++) {
+#if !defined(PETSC_USE_COMPLEX)
+      /* a conjugate pair a +- ib is applied as (A - a)^2 + b^2 to stay in real arithmetic */
+      if (sgmres->shift_im[i] > 0.0 && i+1 < ns) {
+        PetscReal a = sgmres->shift_re[i],b = sgmres->shift_im[i];
+
+        B[i+i*ld]         = a;
+        B[i+1+i*ld]       = 1.0/sigma;
+        B[i+(i+1)*ld]     = -sigma*b*b;
+        B[i+1+(i+1)*ld]   = a;
+        B[i+2+(i+1)*ld]   = 1.0/sigma;
+        i++;
+        continue;
+      }
+      B[i+i*ld]   = sgmres->shift_re[i];
+#else
+      B[i+i*ld]   = sgmres->shift_re[i] + PETSC_i*sgmres->shift_im[i];
+#endif
+      B[i+1+i*ld] = 1.0/sigma;
+    }
+  } else {
+    B[0] = c;
+    B[1] = d;
+    for (i=1; i<ns; i++) {
+      B[i-1+i*ld] = 0.5*d;
+      B[i+i*ld]   = c;
+      B[i+1+i*ld] = 0.5*d;
+    }
+  }
+  PetscFunctionReturn(0);
+}
+
+/*
+    KSPSGMRESCholesky - Cholesky factorization G = R^H R of the ns x ns Gram matrix of the projected block. Stops at the
+    first pivot that is not larger than tol times the squared norm Nref(k,k) of the corresponding unprojected vector,
+    returning the number k of columns that were factored.
+*/
+static PetscErrorCode KSPSGMRESCholesky(PetscInt ns,const PetscScalar *G,const PetscScalar *Nref,PetscReal tol,PetscScalar *R,PetscInt *k,PetscReal *pivot)
+{
+  PetscInt       i,j,l;
+  PetscScalar    t;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  *k     = 0;
+  *pivot = 0.0;
+  ierr   = PetscMemzero(R,ns*ns*sizeof(PetscScalar));CHKERRQ(ierr);
+  for (j=0; j<ns; j++) {
+    PetscReal d = PetscRealPart(G[j+j*ns]);
+
+    for (l=0; l<j; l++) d -= PetscRealPart(PetscConj(R[l+j*ns])*R[l+j*ns]);
+    *pivot = d;
+    if (d <= tol*PetscRealPart(Nref[j+j*ns])) break;
+    R[j+j*ns] = PetscSqrtReal(d);
+    for (i=j+1; i<ns; i++) {
+      t = G[j+i*ns];
+      for (l=0; l<j; l++) t -= PetscConj(R[l+j*ns])*R[l+i*ns];
+      R[j+i*ns] = t/R[j+j*ns];
+    }
+  }
+  *k = j;
+  PetscFunctionReturn(0);
+}
+
+/*
+    KSPSGMRESProject - Projects the ns new vectors VV(j+1:j+ns) against VV(0:j), computing C = V^H W and N = W^H W with
+    a single reduction, and forms the Gram matrix of the projected vectors N - C^H C.
+*/
+static PetscErrorCode KSPSGMRESProject(KSP ksp,PetscInt j,PetscInt ns,PetscScalar *C,PetscScalar *N)
+{
+  KSP_SGMRES     *sgmres = (KSP_SGMRES*)ksp->data;
+  PetscScalar    *work;
+  PetscInt       c,r,l;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  for (c=0; c<ns; c++) {
+    ierr = VecMDotBegin(VEC_VV(j+1+c),j+1,&VEC_VV(0),C+c*(j+1));CHKERRQ(ierr);
+    ierr = VecMDotBegin(VEC_VV(j+1+c),ns,&VEC_VV(j+1),N+c*ns);CHKERRQ(ierr);
+  }
+  ierr = PetscCommSplitReductionBegin(PetscObjectComm((PetscObject)VEC_VV(0)));CHKERRQ(ierr);
+  for (c=0; c<ns; c++) {
+    ierr = VecMDotEnd(VEC_VV(j+1+c),j+1,&VEC_VV(0),C+c*(j+1));CHKERRQ(ierr);
+    ierr = VecMDotEnd(VEC_VV(j+1+c),ns,&VEC_VV(j+1),N+c*ns);CHKERRQ(ierr);
+  }
+
+  if (!sgmres->orthogwork) {ierr = PetscMalloc1(sgmres->max_k + 2,&sgmres->orthogwork);CHKERRQ(ierr);}
+  work = sgmres->orthogwork;
+  for (c=0; c<ns; c++) {
+    for (l=0; l<j+1; l++) work[l] = -C[l+c*(j+1)];
+    ierr = VecMAXPY(VEC_VV(j+1+c),j+1,work,&VEC_VV(0));CHKERRQ(ierr);
+    for (r=0; r<ns; r++) {
+      for (l=0; l<j+1; l++) N[r+c*ns] -= PetscConj(C[l+r*(j+1)])*C[l+c*(j+1)];
+    }
+  }
+  PetscFunctionReturn(0);
+}
+
+/*
+    KSPSGMRESBlockArnoldi - Extends the orthonormal basis VV(0:j) by up to ns vectors with one global reduction and
+    computes the corresponding columns j:j+ncol-1 of the Hessenberg matrix in HH.
+
+    The block Z = [v_j, z_1, ..., z_ns] is generated with the polynomial basis B, projected against VV(0:j) and
+    orthonormalized with a Cholesky QR of its Gram matrix, Z(:,1:ns) = V C + Q R. Writing Z(:,0:ns-1) = [V(:,0:j-1)
+    [v_j Q(:,0:ns-2)]] [Ctop; T] with T upper triangular, A Z(:,0:ns-1) = Z B gives the new Hessenberg columns
+    H_new = ([e_j C; 0 R] B - [H_old Ctop; 0]) T^{-1}. If the Gram matrix is too ill conditioned the block is instead
+    orthonormalized with reorthogonalized Gram-Schmidt and truncated to the columns that are still linearly independent.
+*/
+static PetscErrorCode KSPSGMRESBlockArnoldi(KSP ksp,PetscInt j,PetscInt ns,PetscInt *ncol)
+{
+  KSP_SGMRES     *sgmres = (KSP_SGMRES*)ksp->data;
+  PetscInt       s = sgmres->s,ldb = s+1,ldc = j+1,ldh = sgmres->max_k+s+1,nrows,i,c,r,m,lo,nk;
+  PetscScalar    *B = sgmres->B,*C = sgmres->C,*N = sgmres->N,*R = sgmres->R,*Hn = sgmres->Hn,*work,coef[2],t;
+  PetscReal      pivot;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = KSPSGMRESBasisMatrix(ksp,ns);CHKERRQ(ierr);
+
+  /* generate the block with the matrix powers kernel, VV(j) is the starting vector */
+  for (i=0; i<ns; i++) {
+    ierr = KSP_PCApplyBAorAB(ksp,VEC_VV(j+i),VEC_VV(j+i+1),VEC_TEMP_MATOP);CHKERRQ(ierr);
+    lo = PetscMax(0,i-1);
+    for (r=lo; r<=i; r++) coef[r-lo] = -B[r+i*ldb];
+    ierr = VecMAXPY(VEC_VV(j+i+1),i+1-lo,coef,&VEC_VV(j+lo));CHKERRQ(ierr);
+    ierr = VecScale(VEC_VV(j+i+1),1.0/B[i+1+i*ldb]);CHKERRQ(ierr);
+  }
+
+  /* one reduction for the projection and the Gram matrix, then Cholesky QR */
+  ierr = KSPSGMRESProject(ksp,j,ns,C,N);CHKERRQ(ierr);
+  ierr = PetscMemcpy(sgmres->N2,N,ns*ns*sizeof(PetscScalar));CHKERRQ(ierr);
+  for (c=0; c<ns; c++) {
+    for (m=0; m<j+1; m++) N[c+c*ns] += PetscConj(C[m+c*ldc])*C[m+c*ldc];
+  }
+  /* N now holds the Gram matrix of the unprojected block on its diagonal, N2 the Gram matrix of the projected block */
+  ierr = KSPSGMRESCholesky(ns,sgmres->N2,N,PETSC_SQRT_MACHINE_EPSILON,R,&nk,&pivot);CHKERRQ(ierr);
+  if (nk < ns) {
+    PetscScalar *C2 = sgmres->C2;
+    PetscReal   nrm;
+
+    /* the Gram matrix is too ill conditioned for Cholesky QR, orthonormalize the block column by column with
+       classical Gram-Schmidt and one reorthogonalization instead, this costs two reductions per column */
+    ierr = PetscInfo3(ksp,"Loss of orthogonality in block column %D of %D (pivot %g), using Gram-Schmidt\n",nk,ns,(double)pivot);CHKERRQ(ierr);
+    ierr = PetscMemzero(R,ns*ns*sizeof(PetscScalar));CHKERRQ(ierr);
+    work = sgmres->orthogwork;
+    for (c=0; c<ns; c++) {
+      for (i=0; i<2; i++) {
+        ierr = VecMDot(VEC_VV(j+1+c),j+1+c,&VEC_VV(0),C2);CHKERRQ(ierr);
+        for (m=0; m<j+1+c; m++) work[m] = -C2[m];
+        ierr = VecMAXPY(VEC_VV(j+1+c),j+1+c,work,&VEC_VV(0));CHKERRQ(ierr);
+        for (m=0; m<j+1; m++) C[m+c*ldc] += C2[m];
+        for (m=0; m<c; m++) R[m+c*ns] += C2[j+1+m];
+      }
+      ierr = VecNorm(VEC_VV(j+1+c),NORM_2,&nrm);CHKERRQ(ierr);
+      if (nrm <= PETSC_MACHINE_EPSILON*PetscSqrtReal(PetscRealPart(N[c+c*ns]))) break;
+      R[c+c*ns] = nrm;
+      ierr = VecScale(VEC_VV(j+1+c),1.0/nrm);CHKERRQ(ierr);
+    }
+    nk = c;
+    if (nk < ns) {ierr = PetscInfo2(ksp,"Block truncated to %D of %D columns\n",nk,ns);CHKERRQ(ierr);}
+  } else {
+    /* Q = W R^{-1}, stored in place */
+    work = sgmres->orthogwork;
+    for (c=0; c<nk; c++) {
+      for (r=0; r<c; r++) work[r] = -R[r+c*ns];
+      if (c) {ierr = VecMAXPY(VEC_VV(j+1+c),c,work,&VEC_VV(j+1));CHKERRQ(ierr);}
+      ierr = VecScale(VEC_VV(j+1+c),1.0/R[c+c*ns]);CHKERRQ(ierr);
+    }
+  }
+
+  /* new Hessenberg columns; with nk = 0 the single column has a zero subdiagonal entry, the happy breakdown */
+  *ncol = PetscMax(nk,1);
+  nrows = j+1+*ncol;
+  for (c=0; c<*ncol; c++) {
+    PetscScalar *h = Hn+c*ldh;
+
+    for (i=0; i<nrows; i++) h[i] = 0.0;
+    for (r=0; r<=c+1; r++) {
+      PetscScalar b = B[r+c*ldb];
+
+      if (b == 0.0) continue;
+      if (!r) h[j] += b;
+      else {
+        for (i=0; i<j+1; i++) h[i] += C[i+(r-1)*ldc]*b;
+        if (r <= nk) for (i=0; i<r; i++) h[j+1+i] += R[i+(r-1)*ns]*b;
+      }
+    }
+    if (c) {
+      for (m=0; m<j; m++) {
+        PetscScalar cm = C[m+(c-1)*ldc];
+        for (i=0; i<=m+1; i++) h[i] -= *HES(i,m)*cm;
+      }
+    }
+    /* apply T^{-1} from the right */
+    for (m=0; m<c; m++) {
+      t = m ? R[m-1+(c-1)*ns] : C[j+(c-1)*ldc];
+      for (i=0; i<nrows; i++) h[i] -= Hn[i+m*ldh]*t;
+    }
+    if (c) {
+      t = R[c-1+(c-1)*ns];
+      for (i=0; i<nrows; i++) h[i] /= t;
+    }
+    for (i=0; i<=j+c+1; i++) *HH(i,j+c) = h[i];
+  }
+  PetscFunctionReturn(0);
+}
+
+/*
+
+    KSPSGMRESCycle - Run sgmres, possibly with restart.  Return residual
+                  history if requested.
+
+    input parameters:
+.        sgmres  - structure containing parameters and work areas
+
+    output parameters:
+.        itcount - number of iterations used.  If null, ignored.
+.        converged - 0 if not converged
+
+    Notes:
+    On entry, the value in vector VEC_VV(0) should be
+    the initial residual.
+
+
+ */
+static PetscErrorCode KSPSGMRESCycle(PetscInt *itcount,KSP ksp)
+{
+  KSP_SGMRES     *sgmres = (KSP_SGMRES*)(ksp->data);
+  PetscReal      res_norm,res;
+  PetscErrorCode ierr;
+  PetscInt       it     = 0,max_k = sgmres->max_k,ns,ncol = 0,c;
+  PetscBool      hapend = PETSC_FALSE;
+
+  PetscFunctionBegin;
+  if (itcount) *itcount = 0;
+  ierr   = VecNormalize(VEC_VV(0),&res_norm);CHKERRQ(ierr);
+  KSPCheckNorm(ksp,res_norm);
+  res    = res_norm;
+  *RS(0) = res_norm;
+
+  /* check for the convergence */
+  ierr       = PetscObjectSAWsTakeAccess((PetscObject)ksp);CHKERRQ(ierr);
+  ksp->rnorm = res;
+  ierr       = PetscObjectSAWsGrantAccess((PetscObject)ksp);CHKERRQ(ierr);
+  sgmres->it = it-1;
+  ierr = KSPLogResidualHistory(ksp,res);CHKERRQ(ierr);
+  ierr = KSPMonitor(ksp,ksp->its,res);CHKERRQ(ierr);
+  if (!res) {
+    ksp->reason = KSP_CONVERGED_ATOL;
+    ierr        = PetscInfo(ksp,"Converged due to zero residual norm on entry\n");CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+
+  ierr = (*ksp->converged)(ksp,ksp->its,res,&ksp->reason,ksp->cnvP);CHKERRQ(ierr);
+  while (!ksp->reason && it < max_k && ksp->its < ksp->max_it) {
+    /* the first s steps of a solve are plain Arnoldi steps whose Hessenberg matrix provides the Ritz values */
+    ns = sgmres->shifts_set ? sgmres->s : 1;
+    ns = PetscMin(ns,PetscMin(max_k-it,ksp->max_it-ksp->its));
+    while (sgmres->vv_allocated <= it + ns + VEC_OFFSET) {
+      PetscInt nalloc = sgmres->vv_allocated;
+      ierr = KSPGMRESGetNewVectors(ksp,sgmres->vv_allocated-VEC_OFFSET);CHKERRQ(ierr);
+      if (sgmres->vv_allocated == nalloc) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_PLIB,"Unable to allocate Krylov vectors");
+    }
+    ierr = KSPSGMRESBlockArnoldi(ksp,it,ns,&ncol);CHKERRQ(ierr);
+
+    for (c=0; c<ncol; c++) {
+      ierr = KSPSGMRESUpdateHessenberg(ksp,it,&hapend,&res);CHKERRQ(ierr);
+      it++;
+      sgmres->it = it-1;
+      ksp->its++;
+      ksp->rnorm = res;
+      if (ksp->reason) break;
+
+      ierr = (*ksp->converged)(ksp,ksp->its,res,&ksp->reason,ksp->cnvP);CHKERRQ(ierr);
+      /* Catch error in happy breakdown and signal convergence and break from loop */
+      if (hapend && !ksp->reason) {
+        if (ksp->errorifnotconverged) SETERRQ1(PetscObjectComm((PetscObject)ksp),PETSC_ERR_NOT_CONVERGED,"You reached the happy break down, but convergence was not indicated. Residual norm = %g",(double)res);
+        else ksp->reason = KSP_DIVERGED_BREAKDOWN;
+      }
+      if (it < max_k || ksp->reason || ksp->its >= ksp->max_it) {  /* Monitor if we are done or still iterating, but not before a restart. */
+        ierr = KSPLogResidualHistory(ksp,res);CHKERRQ(ierr);
+        ierr = KSPMonitor(ksp,ksp->its,res);CHKERRQ(ierr);
+      }
+      if (ksp->reason) break;
+    }
+    if (!sgmres->shifts_set && it == sgmres->s && !ksp->reason) {
+      ierr = KSPSGMRESComputeShifts(ksp);CHKERRQ(ierr);
+    }
+  }
+
+  if (itcount) *itcount = it;
+
+  /*
+    Down here we have to solve for the "best" coefficients of the Krylov
+    columns, add the solution values together, and possibly unwind the
+    preconditioning from the solution
+   */
+  /* Form the solution (or the solution so far) */
+  ierr = KSPSGMRESBuildSoln(RS(0),ksp->vec_sol,ksp->vec_sol,ksp,it-1);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*
+    KSPSolve_SGMRES - This routine applies the SGMRES method.
+
+
+   Input Parameter:
+.     ksp - the Krylov space object that was set to use sgmres
+
+   Output Parameter:
+.     outits - number of iterations used
+
+*/
+static PetscErrorCode KSPSolve_SGMRES(KSP ksp)
+{
+  PetscErrorCode ierr;
+  PetscInt       its,itcount;
+  KSP_SGMRES     *sgmres    = (KSP_SGMRES*)ksp->data;
+  PetscBool      guess_zero = ksp->guess_zero;
+
+  PetscFunctionBegin;
+  if (ksp->calc_sings && !sgmres->Rsvd) SETERRQ(PetscObjectComm((PetscObject)ksp),PETSC_ERR_ORDER,"Must call KSPSetComputeSingularValues() before KSPSetUp() is called");
+  ierr     = PetscObjectSAWsTakeAccess((PetscObject)ksp);CHKERRQ(ierr);
+  ksp->its = 0;
+  ierr     = PetscObjectSAWsGrantAccess((PetscObject)ksp);CHKERRQ(ierr);
+
+  itcount            = 0;
+  sgmres->shifts_set = PETSC_FALSE;
+  ksp->reason        = KSP_CONVERGED_ITERATING;
+  while (!ksp->reason) {
+    ierr     = KSPInitialResidual(ksp,ksp->vec_sol,VEC_TEMP,VEC_TEMP_MATOP,VEC_VV(0),ksp->vec_rhs);CHKERRQ(ierr);
+    ierr     = KSPSGMRESCycle(&its,ksp);CHKERRQ(ierr);
+    itcount += its;
+    if (itcount >= ksp->max_it) {
+      if (!ksp->reason) ksp->reason = KSP_DIVERGED_ITS;
+      break;
+    }
+    ksp->guess_zero = PETSC_FALSE; /* every future call to KSPInitialResidual() will have nonzero guess */
+  }
+  ksp->guess_zero = guess_zero; /* restore if user provided nonzero initial guess */
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPReset_SGMRES(KSP ksp)
+{
+  KSP_SGMRES     *sgmres = (KSP_SGMRES*)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscFree2(sgmres->shift_re,sgmres->shift_im);CHKERRQ(ierr);
+  ierr = PetscFree7(sgmres->B,sgmres->C,sgmres->C2,sgmres->N,sgmres->N2,sgmres->R,sgmres->Hn);CHKERRQ(ierr);
+  ierr = KSPReset_GMRES(ksp);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPDestroy_SGMRES(KSP ksp)
+{
+  KSP_SGMRES     *sgmres = (KSP_SGMRES*)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscFree2(sgmres->shift_re,sgmres->shift_im);CHKERRQ(ierr);
+  ierr = PetscFree7(sgmres->B,sgmres->C,sgmres->C2,sgmres->N,sgmres->N2,sgmres->R,sgmres->Hn);CHKERRQ(ierr);
+  ierr = KSPDestroy_GMRES(ksp);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*
+    KSPSGMRESBuildSoln - create the solution from the starting vector and the
+                      current iterates.
+
+    Input parameters:
+        nrs - work area of size it + 1.
+        vguess  - index of initial guess
+        vdest - index of result.  Note that vguess may == vdest (replace
+                guess with the solution).
+        it - HH upper triangular part is a block of size (it+1) x (it+1)
+
+     This is an internal routine that knows about the SGMRES internals.
+ */
+static PetscErrorCode KSPSGMRESBuildSoln(PetscScalar *nrs,Vec vguess,Vec vdest,KSP ksp,PetscInt it)
+{
+  PetscScalar    tt;
+  PetscErrorCode ierr;
+  PetscInt       k,j;
+  KSP_SGMRES     *sgmres = (KSP_SGMRES*)(ksp->data);
+
+  PetscFunctionBegin;
+  /* Solve for solution vector that minimizes the residual */
+
+  if (it < 0) {                                 /* no sgmres steps have been performed */
+    ierr = VecCopy(vguess,vdest);CHKERRQ(ierr); /* VecCopy() is smart, exits immediately if vguess == vdest */
+    PetscFunctionReturn(0);
+  }
+
+  /* solve the upper triangular system - RS is the right side and HH is
+     the upper triangular matrix  - put soln in nrs */
+  if (*HH(it,it) != 0.0) nrs[it] = *RS(it) / *HH(it,it);
+  else nrs[it] = 0.0;
+
+  for (k=it-1; k>=0; k--) {
+    tt = *RS(k);
+    for (j=k+1; j<=it; j++) tt -= *HH(k,j) * nrs[j];
+    nrs[k] = tt / *HH(k,k);
+  }
+
+  /* Accumulate the correction to the solution of the preconditioned problem in TEMP */
+  ierr = VecZeroEntries(VEC_TEMP);CHKERRQ(ierr);
+  ierr = VecMAXPY(VEC_TEMP,it+1,nrs,&VEC_VV(0));CHKERRQ(ierr);
+  ierr = KSPUnwindPreconditioner(ksp,VEC_TEMP,VEC_TEMP_MATOP);CHKERRQ(ierr);
+  /* add solution to previous solution */
+  if (vdest == vguess) {
+    ierr = VecAXPY(vdest,1.0,VEC_TEMP);CHKERRQ(ierr);
+  } else {
+    ierr = VecWAXPY(vdest,1.0,VEC_TEMP,vguess);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+/*
+
+    KSPSGMRESUpdateHessenberg - Do the scalar work for the orthogonalization.
+                            Return new residual.
+
+    input parameters:
+
+.        ksp -    Krylov space object
+.        it  -    plane rotations are applied to the (it+1)th column of the
+                  modified hessenberg (i.e. HH(:,it))
+.        hapend - PETSC_FALSE not happy breakdown ending.
+
+    output parameters:
+.        res - the new residual
+
+ */
+static PetscErrorCode KSPSGMRESUpdateHessenberg(KSP ksp,PetscInt it,PetscBool *hapend,PetscReal *res)
+{
+  PetscScalar    *hh,*cc,*ss,*rs;
+  PetscInt       j;
+  PetscReal      hapbnd;
+  KSP_SGMRES     *sgmres = (KSP_SGMRES*)(ksp->data);
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  hh = HH(0,it);   /* pointer to beginning of column to update */
+  cc = CC(0);      /* beginning of cosine rotations */
+  ss = SS(0);      /* beginning of sine rotations */
+  rs = RS(0);      /* right hand side of least squares system */
+
+  /* The Hessenberg matrix is now correct through column it, save that form for the next block and for possible spectral analysis */
+  for (j=0; j<=it+1; j++) *HES(j,it) = hh[j];
+
+  /* check for the happy breakdown */
+  hapbnd = PetscMin(PetscAbsScalar(hh[it+1] / rs[it]),sgmres->haptol);
+  if (PetscAbsScalar(hh[it+1]) < hapbnd) {
+    ierr    = PetscInfo4(ksp,"Detected happy breakdown, current hapbnd = %14.12e H(%D,%D) = %14.12e\n",(double)hapbnd,it+1,it,(double)PetscAbsScalar(*HH(it+1,it)));CHKERRQ(ierr);
+    *hapend = PETSC_TRUE;
+  }
+
+  /* Apply all the previously computed plane rotations to the new column
+     of the Hessenberg matrix */
+  /* Note: this uses the rotation [conj(c)  s ; -s   c], c= cos(theta), s= sin(theta),
+     and some refs have [c   s ; -conj(s)  c] (don't be confused!) */
+
+  for (j=0; j<it; j++) {
+    PetscScalar hhj = hh[j];
+    hh[j]   = PetscConj(cc[j])*hhj + ss[j]*hh[j+1];
+    hh[j+1] =          -ss[j] *hhj + cc[j]*hh[j+1];
+  }
+
+  /*
+    compute the new plane rotation, and apply it to:
+     1) the right-hand-side of the Hessenberg system (RS)
+        note: it affects RS(it) and RS(it+1)
+     2) the new column of the Hessenberg matrix
+        note: it affects HH(it,it) which is currently pointed to
+        by hh and HH(it+1, it) (*(hh+1))
+    thus obtaining the updated value of the residual...
+  */
+
+  /* compute new plane rotation */
+
+  if (!*hapend) {
+    PetscReal delta = PetscSqrtReal(PetscSqr(PetscAbsScalar(hh[it])) + PetscSqr(PetscAbsScalar(hh[it+1])));
+    if (delta == 0.0) {
+      ksp->reason = KSP_DIVERGED_NULL;
+      PetscFunctionReturn(0);
+    }
+
+    cc[it] = hh[it] / delta;    /* new cosine value */
+    ss[it] = hh[it+1] / delta;  /* new sine value */
+
+    hh[it]   = PetscConj(cc[it])*hh[it] + ss[it]*hh[it+1];
+    rs[it+1] = -ss[it]*rs[it];
+    rs[it]   = PetscConj(cc[it])*rs[it];
+    *res     = PetscAbsScalar(rs[it+1]);
+  } else { /* happy breakdown: HH(it+1, it) = 0, therefore we don't need to apply
+            another rotation matrix (so RH doesn't change).  The new residual is
+            always the new sine term times the residual from last time (RS(it)),
+            but now the new sine rotation would be zero...so the residual should
+            be zero...so we will multiply "zero" by the last residual.  This might
+            not be exactly what we want to do here -could just return "zero". */
+
+    *res = 0.0;
+  }
+  PetscFunctionReturn(0);
+}
+
+/*
+   KSPBuildSolution_SGMRES
+
+     Input Parameter:
+.     ksp - the Krylov space object
+.     ptr-
+
+   Output Parameter:
+.     result - the solution
+
+   Note: this calls KSPSGMRESBuildSoln - the same function that KSPSGMRESCycle
+   calls directly.
+
+*/
+static PetscErrorCode KSPBuildSolution_SGMRES(KSP ksp,Vec ptr,Vec *result)
+{
+  KSP_SGMRES     *sgmres = (KSP_SGMRES*)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (!ptr) {
+    if (!sgmres->sol_temp) {
+      ierr = VecDuplicate(ksp->vec_sol,&sgmres->sol_temp);CHKERRQ(ierr);
+      ierr = PetscLogObjectParent((PetscObject)ksp,(PetscObject)sgmres->sol_temp);CHKERRQ(ierr);
+    }
+    ptr = sgmres->sol_temp;
+  }
+  if (!sgmres->nrs) {
+    /* allocate the work area */
+    ierr = PetscMalloc1(sgmres->max_k,&sgmres->nrs);CHKERRQ(ierr);
+    ierr = PetscLogObjectMemory((PetscObject)ksp,sgmres->max_k*sizeof(PetscScalar));CHKERRQ(ierr);
+  }
+
+  ierr = KSPSGMRESBuildSoln(sgmres->nrs,ksp->vec_sol,ptr,ksp,sgmres->it);CHKERRQ(ierr);
+  if (result) *result = ptr;
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPView_SGMRES(KSP ksp,PetscViewer viewer)
+{
+  KSP_SGMRES     *sgmres = (KSP_SGMRES*)ksp->data;
+  PetscErrorCode ierr;
+  PetscBool      iascii,isstring;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectTypeCompare((PetscObject)viewer,PETSCVIEWERASCII,&iascii);CHKERRQ(ierr);
+  ierr = PetscObjectTypeCompare((PetscObject)viewer,PETSCVIEWERSTRING,&isstring);CHKERRQ(ierr);
+  if (iascii) {
+    ierr = PetscViewerASCIIPrintf(viewer,"  restart=%D, s=%D, using %s basis with Cholesky QR orthogonalization\n",sgmres->max_k,sgmres->s,KSPSGMRESBasisTypes[sgmres->basis]);CHKERRQ(ierr);
+    ierr = PetscViewerASCIIPrintf(viewer,"  happy breakdown tolerance %g\n",(double)sgmres->haptol);CHKERRQ(ierr);
+  } else if (isstring) {
+    ierr = PetscViewerStringSPrintf(viewer,"restart %D s %D %s basis",sgmres->max_k,sgmres->s,KSPSGMRESBasisTypes[sgmres->basis]);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPSetFromOptions_SGMRES(PetscOptionItems *PetscOptionsObject,KSP ksp)
+{
+  KSP_SGMRES     *sgmres = (KSP_SGMRES*)ksp->data;
+  PetscInt       basis   = (PetscInt)sgmres->basis,s = sgmres->s;
+  PetscBool      flg;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = KSPSetFromOptions_GMRES(PetscOptionsObject,ksp);CHKERRQ(ierr);
+  ierr = PetscOptionsHead(PetscOptionsObject,"KSP s-step GMRES Options");CHKERRQ(ierr);
+  ierr = PetscOptionsInt("-ksp_sgmres_s","Number of Krylov vectors generated between global reductions","None",s,&s,&flg);CHKERRQ(ierr);
+  if (flg && s < 1) SETERRQ1(PetscObjectComm((PetscObject)ksp),PETSC_ERR_ARG_OUTOFRANGE,"Block size s %D must be positive",s);
+  if (!ksp->setupstage) {
+    sgmres->s = s;
+  } else if (s != sgmres->s) {
+    /* free the data structures, then create them again */
+    ierr            = KSPReset_SGMRES(ksp);CHKERRQ(ierr);
+    sgmres->s       = s;
+    ksp->setupstage = KSP_SETUP_NEW;
+  }
+  ierr = PetscOptionsEList("-ksp_sgmres_basis","Polynomial basis used to generate the Krylov vectors","None",KSPSGMRESBasisTypes,3,KSPSGMRESBasisTypes[basis],&basis,NULL);CHKERRQ(ierr);
+  sgmres->basis = (KSPSGMRESBasisType)basis;
+  ierr = PetscOptionsTail();CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*MC
+     KSPSGMRES - Implements the communication avoiding s-step Generalized Minimal Residual method.
+
+   Options Database Keys:
++   -ksp_gmres_restart <restart> - the number of Krylov directions to orthogonalize against
+.   -ksp_gmres_haptol <tol> - sets the tolerance for "happy ending" (exact convergence)
+.   -ksp_gmres_preallocate - preallocate all the Krylov search directions initially (otherwise groups of
+                             vectors are allocated as needed)
+.   -ksp_sgmres_s <s> - the number of Krylov vectors generated between global reductions (default 4)
+-   -ksp_sgmres_basis <newton,chebyshev,monomial> - the polynomial basis used to generate the Krylov vectors (default newton)
+
+   Level: intermediate
+
+   Notes:
+   Each block of s Krylov vectors is generated from the last basis vector with s applications of the (preconditioned)
+   operator, without any inner products, and is then orthonormalized against the existing basis and internally with a
+   block classical Gram-Schmidt step followed by a Cholesky QR, which need a single global reduction together. Standard
+   GMRES with classical Gram-Schmidt needs one reduction per iteration, so the number of global reductions is reduced by a
+   factor of s. The Hessenberg matrix is recovered from the change of basis matrix, so the restart, least squares
+   solution, eigenvalue and singular value estimates are those of KSPGMRES.
+
+   The first s iterations of each solve are Arnoldi steps whose Hessenberg matrix provides Ritz values; these are used as
+   the Leja ordered shifts of the Newton basis, to scale the monomial basis, and to define the interval of the Chebyshev
+   basis from their real parts. The monomial basis becomes ill-conditioned quickly so s should be kept small with it.
+
+   If the Gram matrix of a block is numerically singular the block is projected a second time (one more reduction) and
+   truncated to the columns that are linearly independent, so large s only costs iterations, never accuracy.
+
+   Only classical Gram-Schmidt style orthogonalization is used, -ksp_gmres_modifiedgramschmidt and
+   -ksp_gmres_cgs_refinement_type are ignored.
+
+   References:
++  1. - M. Hoemmen, Communication-avoiding Krylov subspace methods, PhD thesis, UC Berkeley, 2010.
+-  2. - Z. Bai, D. Hu and L. Reichel, A Newton basis GMRES implementation, IMA J. Numer. Anal., 1994.
+
+   Developer Notes:
+    This object is subclassed off of KSPGMRES
+
+.seealso:  KSPCreate(), KSPSetType(), KSPType (for list of available types), KSP, KSPGMRES, KSPPGMRES, KSPSCG,
+           KSPGMRESSetRestart(), KSPGMRESSetHapTol(), KSPGMRESSetPreAllocateVectors()
+M*/
+
+PETSC_EXTERN PetscErrorCode KSPCreate_SGMRES(KSP ksp)
+{
+  KSP_SGMRES     *sgmres;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscNewLog(ksp,&sgmres);CHKERRQ(ierr);
+
+  ksp->data                              = (void*)sgmres;
+  ksp->ops->buildsolution                = KSPBuildSolution_SGMRES;
+  ksp->ops->setup                        = KSPSetUp_SGMRES;
+  ksp->ops->solve                        = KSPSolve_SGMRES;
+  ksp->ops->reset                        = KSPReset_SGMRES;
+  ksp->ops->destroy                      = KSPDestroy_SGMRES;
+  ksp->ops->view                         = KSPView_SGMRES;
+  ksp->ops->setfromoptions               = KSPSetFromOptions_SGMRES;
+  ksp->ops->computeextremesingularvalues = KSPComputeExtremeSingularValues_GMRES;
+  ksp->ops->computeeigenvalues           = KSPComputeEigenvalues_GMRES;
+
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_PRECONDITIONED,PC_LEFT,3);CHKERRQ(ierr);
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_UNPRECONDITIONED,PC_RIGHT,2);CHKERRQ(ierr);
+
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPGMRESSetPreAllocateVectors_C",KSPGMRESSetPreAllocateVectors_GMRES);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPGMRESSetRestart_C",KSPGMRESSetRestart_GMRES);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPGMRESGetRestart_C",KSPGMRESGetRestart_GMRES);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPGMRESSetHapTol_C",KSPGMRESSetHapTol_GMRES);CHKERRQ(ierr);
+
+  sgmres->nextra_vecs    = 1;
+  sgmres->haptol         = 1.0e-30;
+  sgmres->q_preallocate  = 0;
+  sgmres->delta_allocate = SGMRES_DELTA_DIRECTIONS;
+  sgmres->orthog         = KSPGMRESClassicalGramSchmidtOrthogonalization;
+  sgmres->nrs            = 0;
+  sgmres->sol_temp       = 0;
+  sgmres->max_k          = SGMRES_DEFAULT_MAXK;
+  sgmres->Rsvd           = 0;
+  sgmres->orthogwork     = 0;
+  sgmres->cgstype        = KSP_GMRES_CGS_REFINE_NEVER;
+  sgmres->s              = SGMRES_DEFAULT_S;
+  sgmres->basis          = KSP_SGMRES_BASIS_NEWTON;
+  PetscFunctionReturn(0);
+}
@@ -0,0 +1,43 @@
+#if !defined(__SGMRES)
+#define __SGMRES
+
+#define KSPGMRES_NO_MACROS
+#include <../src/ksp/ksp/impls/gmres/gmresimpl.h>
+
+typedef enum {KSP_SGMRES_BASIS_NEWTON,KSP_SGMRES_BASIS_CHEBYSHEV,KSP_SGMRES_BASIS_MONOMIAL} KSPSGMRESBasisType;
+
+typedef struct {
+  KSPGMRESHEADER
+
+  PetscInt           s;                  /* number of Krylov vectors generated per block (one reduction per block) */
+  KSPSGMRESBasisType basis;              /* polynomial basis used to generate the block */
+  PetscBool          shifts_set;         /* have the Ritz values from the warm-up been computed for this solve */
+  PetscReal          *shift_re,*shift_im; /* Leja ordered Ritz values, conjugate pairs are stored consecutively */
+  PetscReal          sigma;              /* scaling of the basis vectors (inverse of the spectral radius estimate) */
+  PetscReal          cheb_c,cheb_d;      /* center and half width of the Chebyshev interval */
+
+  /* small dense work arrays for one block step */
+  PetscScalar        *B;                 /* (s+1) x s change of basis matrix, A Z(:,0:s-1) = Z B */
+  PetscScalar        *C,*C2;             /* (max_k+1) x s projection coefficients of the block onto the existing basis */
+  PetscScalar        *N,*N2;             /* s x s Gram matrices of the block */
+  PetscScalar        *R;                 /* s x s Cholesky factor of the projected block */
+  PetscScalar        *Hn;                /* (max_k+s+1) x s new columns of the Hessenberg matrix */
+} KSP_SGMRES;
+
+#define HH(a,b)  (sgmres->hh_origin + (b)*(sgmres->max_k+2)+(a))
+/* HH will be size (max_k+2)*(max_k+1)  -  think of HH as
+   being stored columnwise for access purposes. */
+#define HES(a,b) (sgmres->hes_origin + (b)*(sgmres->max_k+1)+(a))
+/* HES will be size (max_k + 1) * (max_k + 1) -
+   again, think of HES as being stored columnwise */
+#define CC(a)    (sgmres->cc_origin + (a)) /* CC will be length (max_k+1) - cosines */
+#define SS(a)    (sgmres->ss_origin + (a)) /* SS will be length (max_k+1) - sines */
+#define RS(a)    (sgmres->rs_origin + (a)) /* RS will be length (max_k+2) - rt side */
+
+/* vector names */
+#define VEC_OFFSET     2
+#define VEC_TEMP       sgmres->vecs[0]               /* work space */
+#define VEC_TEMP_MATOP sgmres->vecs[1]               /* work space */
+#define VEC_VV(i)      sgmres->vecs[VEC_OFFSET+i]    /* use to access
+                                                        othog basis vectors */
+#endif
@@ -0,0 +1,300 @@
+#include <petsc/private/kspimpl.h>
+
+typedef struct {
+  PetscReal haptol;
+  PetscInt  replace;   /* recompute the auxiliary vectors from their definition every replace iterations, 0 for never */
+} KSP_PIPEMINRES;
+
+static PetscErrorCode KSPSetUp_PIPEMINRES(KSP ksp)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (ksp->pc_side == PC_RIGHT) SETERRQ(PetscObjectComm((PetscObject)ksp),PETSC_ERR_SUP,"No right preconditioning for KSPPIPEMINRES");
+  else if (ksp->pc_side == PC_SYMMETRIC) SETERRQ(PetscObjectComm((PetscObject)ksp),PETSC_ERR_SUP,"No symmetric preconditioning for KSPPIPEMINRES");
+  ierr = KSPSetWorkVecs(ksp,11);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*
+ KSPSolve_PIPEMINRES - This routine applies the pipelined MINRES method
+
+   The preconditioned Lanczos vectors u_k are generated together with q_k = A u_k and m_k = B q_k by three term
+   recurrences, so that alpha_k = (u_k,q_k) and beta_{k+1}^2 = (m_k,q_k) - alpha_k^2 - beta_k^2 can be reduced together
+   while n_k = A m_k and p_k = B n_k, which the recurrences for q_{k+1} and m_{k+1} need, are computed.
+*/
+static PetscErrorCode  KSPSolve_PIPEMINRES(KSP ksp)
+{
+  PetscErrorCode    ierr;
+  PetscInt          i;
+  PetscScalar       alpha,beta,ibeta,betaold,delta,eta,c,ceta,cold,coold,s,sold,soold;
+  PetscScalar       rho0,rho1,irho1,rho2,rho3,dp = 0.0;
+  const PetscScalar none = -1.0;
+  PetscReal         np;
+  Vec               X,B,R,U,UOLD,Q,QOLD,M,MOLD,N,P,W,WOLD,T;
+  Mat               Amat,Pmat;
+  KSP_PIPEMINRES    *pminres = (KSP_PIPEMINRES*)ksp->data;
+  PetscBool         diagonalscale;
+
+  PetscFunctionBegin;
+  ierr = PCGetDiagonalScale(ksp->pc,&diagonalscale);CHKERRQ(ierr);
+  if (diagonalscale) SETERRQ1(PetscObjectComm((PetscObject)ksp),PETSC_ERR_SUP,"Krylov method %s does not support diagonal scaling",((PetscObject)ksp)->type_name);
+
+  X    = ksp->vec_sol;
+  B    = ksp->vec_rhs;
+  R    = ksp->work[0];
+  U    = ksp->work[1];
+  UOLD = ksp->work[2];
+  Q    = ksp->work[3];
+  QOLD = ksp->work[4];
+  M    = ksp->work[5];
+  MOLD = ksp->work[6];
+  N    = ksp->work[7];
+  P    = ksp->work[8];
+  W    = ksp->work[9];
+  WOLD = ksp->work[10];
+
+  ierr = PCGetOperators(ksp->pc,&Amat,&Pmat);CHKERRQ(ierr);
+
+  ksp->its    = 0;
+  ksp->reason = KSP_CONVERGED_ITERATING;
+  while (!ksp->reason) { /* restarted from the true residual after a breakdown */
+    if (!ksp->guess_zero || ksp->its) {
+      ierr = KSP_MatMult(ksp,Amat,X,R);CHKERRQ(ierr); /*     r <- b - A*x    */
+      ierr = VecAYPX(R,-1.0,B);CHKERRQ(ierr);
+    } else {
+      ierr = VecCopy(B,R);CHKERRQ(ierr);              /*     r <- b (x is 0) */
+    }
+    ierr = KSP_PCApply(ksp,R,U);CHKERRQ(ierr);       /*     u  <- B*r       */
+    ierr = VecNormBegin(U,NORM_2,&np);CHKERRQ(ierr);
+    ierr = VecDotBegin(R,U,&dp);CHKERRQ(ierr);
+    ierr = PetscCommSplitReductionBegin(PetscObjectComm((PetscObject)U));CHKERRQ(ierr);
+    ierr = KSP_MatMult(ksp,Amat,U,Q);CHKERRQ(ierr);  /*     q  <- A*u       */
+    ierr = KSP_PCApply(ksp,Q,M);CHKERRQ(ierr);       /*     m  <- B*q       */
+    ierr = VecNormEnd(U,NORM_2,&np);CHKERRQ(ierr);   /*   np <- ||u||        */
+    ierr = VecDotEnd(R,U,&dp);CHKERRQ(ierr);
+    KSPCheckNorm(ksp,np);
+    KSPCheckDot(ksp,dp);
+
+    if (PetscRealPart(dp) < pminres->haptol && np > pminres->haptol) {
+      if (ksp->errorifnotconverged) SETERRQ2(PetscObjectComm((PetscObject)ksp),PETSC_ERR_CONV_FAILED,"Detected indefinite operator %g tolerance %g",(double)PetscRealPart(dp),(double)pminres->haptol);
+      ierr = PetscInfo2(ksp,"Detected indefinite operator %g tolerance %g\n",(double)PetscRealPart(dp),(double)pminres->haptol);CHKERRQ(ierr);
+      ksp->reason = KSP_DIVERGED_INDEFINITE_MAT;
+      PetscFunctionReturn(0);
+    }
+
+    ksp->rnorm = np;
+    if (!ksp->its) {
+      ierr = KSPLogResidualHistory(ksp,np);CHKERRQ(ierr);
+      ierr = KSPMonitor(ksp,0,np);CHKERRQ(ierr);
+    }
+    ierr = (*ksp->converged)(ksp,ksp->its,np,&ksp->reason,ksp->cnvP);CHKERRQ(ierr); /* test for convergence */
+    if (ksp->reason) PetscFunctionReturn(0);
+
+    dp    = PetscAbsScalar(dp);
+    dp    = PetscSqrtScalar(dp);
+    beta  = dp;                                      /*  beta <- sqrt(r'*z  */
+    eta   = beta;
+    ibeta = 1.0 / beta;
+    ierr  = VecScale(U,ibeta);CHKERRQ(ierr);         /*    u <- u / beta     */
+    ierr  = VecScale(Q,ibeta);CHKERRQ(ierr);         /*    q <- q / beta     */
+    ierr  = VecScale(M,ibeta);CHKERRQ(ierr);         /*    m <- m / beta     */
+    ierr  = VecSet(UOLD,0.0);CHKERRQ(ierr);          /*     u_old  <-   0   */
+    ierr  = VecSet(QOLD,0.0);CHKERRQ(ierr);          /*     q_old  <-   0   */
+    ierr  = VecSet(MOLD,0.0);CHKERRQ(ierr);          /*     m_old  <-   0   */
+    ierr  = VecSet(W,0.0);CHKERRQ(ierr);             /*     w      <-   0   */
+    ierr  = VecSet(WOLD,0.0);CHKERRQ(ierr);          /*     w_old  <-   0   */
+    c     = 1.0; cold = 1.0; s = 0.0; sold = 0.0;
+
+    for (i=0; ksp->its<ksp->max_it; i++) {
+      /*   Lanczos, the reduction is overlapped with the matrix-vector product and the preconditioner  */
+
+      ierr = VecDotBegin(U,Q,&alpha);CHKERRQ(ierr);
+      ierr = VecDotBegin(M,Q,&delta);CHKERRQ(ierr);
+      ierr = PetscCommSplitReductionBegin(PetscObjectComm((PetscObject)U));CHKERRQ(ierr);
+      ierr = KSP_MatMult(ksp,Amat,M,N);CHKERRQ(ierr); /*      n <- A*m   */
+      ierr = KSP_PCApply(ksp,N,P);CHKERRQ(ierr);      /*      p <- B*n   */
+      ierr = VecDotEnd(U,Q,&alpha);CHKERRQ(ierr);     /*  alpha <- q'*u  */
+      ierr = VecDotEnd(M,Q,&delta);CHKERRQ(ierr);     /*  delta <- q'*m  */
+      ksp->its++;
+
+      betaold = beta;
+      dp      = delta - alpha*alpha;
+      if (i) dp -= betaold*betaold;                   /*  (r,z) of the next Lanczos vector */
+      KSPCheckDot(ksp,dp);
+      if (PetscRealPart(dp) < pminres->haptol) beta = 0.0;
+      else beta = PetscSqrtScalar(dp);                /*  beta <- sqrt(r'*z)   */
+
+      /*    QR factorisation    */
+
+      coold = cold; cold = c; soold = sold; sold = s;
+
+      rho0 = cold * alpha - coold * sold * betaold;
+      rho1 = PetscSqrtScalar(rho0*rho0 + beta*beta);
+      rho2 = sold * alpha + coold * cold * betaold;
+      rho3 = soold * betaold;
+
+      if (rho1 == 0.0) {
+        ierr = PetscInfo(ksp,"Breakdown of the QR factorization, restarting\n");CHKERRQ(ierr);
+        if (!i) ksp->reason = KSP_DIVERGED_BREAKDOWN;
+        break;
+      }
+
+      /*     Givens rotation    */
+
+      c = rho0 / rho1;
+      s = beta / rho1;
+
+      /*    Update    */
+
+      irho1 = 1.0 / rho1;
+      ierr  = VecAXPBYPCZ(WOLD,irho1,-rho2*irho1,-rho3*irho1,U,W);CHKERRQ(ierr); /*  w <- (u - rho2 w - rho3 w_old) / rho1 */
+      T = WOLD; WOLD = W; W = T;
+
+      ceta = c * eta;
+      ierr = VecAXPY(X,ceta,W);CHKERRQ(ierr);      /*  x <- x + c eta w     */
+
+      /*
+          when dp is really small we have either convergence, an indefinite operator or a loss of accuracy
+          in the recurrences, so compute true residual norm to check for convergence
+      */
+      if (PetscRealPart(dp) < pminres->haptol) {
+        ierr = PetscInfo2(ksp,"Possible indefinite operator %g tolerance %g\n",(double)PetscRealPart(dp),(double)pminres->haptol);CHKERRQ(ierr);
+        ierr = KSP_MatMult(ksp,Amat,X,R);CHKERRQ(ierr);
+        ierr = VecAXPY(R,none,B);CHKERRQ(ierr);
+        ierr = VecNorm(R,NORM_2,&np);CHKERRQ(ierr);
+        KSPCheckNorm(ksp,np);
+      } else {
+        /* otherwise compute new residual norm via recurrence relation */
+        np = ksp->rnorm * PetscAbsScalar(s);
+      }
+
+      ksp->rnorm = np;
+      ierr = KSPLogResidualHistory(ksp,np);CHKERRQ(ierr);
+      ierr = KSPMonitor(ksp,ksp->its,np);CHKERRQ(ierr);
+      ierr = (*ksp->converged)(ksp,ksp->its,np,&ksp->reason,ksp->cnvP);CHKERRQ(ierr); /* test for convergence */
+      if (ksp->reason) break;
+
+      if (PetscRealPart(dp) < pminres->haptol) {
+        if (i && PetscRealPart(dp) < 0.0) {
+          /* the recurrences have lost accuracy, restart from the true residual */
+          ierr = PetscInfo2(ksp,"Square root breakdown %g at iteration %D, restarting\n",(double)PetscRealPart(dp),ksp->its);CHKERRQ(ierr);
+          break;
+        }
+        if (ksp->errorifnotconverged) SETERRQ2(PetscObjectComm((PetscObject)ksp),PETSC_ERR_CONV_FAILED,"Detected indefinite operator %g tolerance %g",(double)PetscRealPart(dp),(double)pminres->haptol);
+        ierr = PetscInfo2(ksp,"Detected indefinite operator %g tolerance %g\n",(double)PetscRealPart(dp),(double)pminres->haptol);CHKERRQ(ierr);
+        ksp->reason = KSP_DIVERGED_INDEFINITE_MAT;
+        break;
+      }
+
+      eta   = -s * eta;
+      ibeta = 1.0 / beta;
+      ierr  = VecAXPBYPCZ(UOLD,ibeta,-alpha*ibeta,-betaold*ibeta,M,U);CHKERRQ(ierr); /*  u <- (m - alpha u - beta u_old) / beta */
+      ierr  = VecAXPBYPCZ(QOLD,ibeta,-alpha*ibeta,-betaold*ibeta,N,Q);CHKERRQ(ierr); /*  q <- (n - alpha q - beta q_old) / beta */
+      ierr  = VecAXPBYPCZ(MOLD,ibeta,-alpha*ibeta,-betaold*ibeta,P,M);CHKERRQ(ierr); /*  m <- (p - alpha m - beta m_old) / beta */
+      T = UOLD; UOLD = U; U = T;
+      T = QOLD; QOLD = Q; Q = T;
+      T = MOLD; MOLD = M; M = T;
+
+      if (pminres->replace && !(ksp->its % pminres->replace)) {
+        /* replace the auxiliary vectors computed by the recurrences by their definition to bound the drift */
+        ierr = KSP_MatMult(ksp,Amat,U,Q);CHKERRQ(ierr);
+        ierr = KSP_PCApply(ksp,Q,M);CHKERRQ(ierr);
+        ierr = KSP_MatMult(ksp,Amat,UOLD,QOLD);CHKERRQ(ierr);
+        ierr = KSP_PCApply(ksp,QOLD,MOLD);CHKERRQ(ierr);
+      }
+    }
+    if (!ksp->reason && ksp->its >= ksp->max_it) ksp->reason = KSP_DIVERGED_ITS;
+  }
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPView_PIPEMINRES(KSP ksp,PetscViewer viewer)
+{
+  KSP_PIPEMINRES *pminres = (KSP_PIPEMINRES*)ksp->data;
+  PetscErrorCode ierr;
+  PetscBool      iascii;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectTypeCompare((PetscObject)viewer,PETSCVIEWERASCII,&iascii);CHKERRQ(ierr);
+  if (iascii) {
+    if (pminres->replace) {
+      ierr = PetscViewerASCIIPrintf(viewer,"  auxiliary vectors replaced every %D iterations\n",pminres->replace);CHKERRQ(ierr);
+    } else {
+      ierr = PetscViewerASCIIPrintf(viewer,"  no replacement of the auxiliary vectors\n");CHKERRQ(ierr);
+    }
+  }
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPSetFromOptions_PIPEMINRES(PetscOptionItems *PetscOptionsObject,KSP ksp)
+{
+  KSP_PIPEMINRES *pminres = (KSP_PIPEMINRES*)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscOptionsHead(PetscOptionsObject,"KSP pipelined MINRES options");CHKERRQ(ierr);
+  ierr = PetscOptionsInt("-ksp_pipeminres_replace","Recompute the auxiliary vectors from their definition every n iterations (0 for never)","None",pminres->replace,&pminres->replace,NULL);CHKERRQ(ierr);
+  if (pminres->replace < 0) SETERRQ1(PetscObjectComm((PetscObject)ksp),PETSC_ERR_ARG_OUTOFRANGE,"Replacement period %D cannot be negative",pminres->replace);
+  ierr = PetscOptionsTail();CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*MC
+     KSPPIPEMINRES - Pipelined MINRES (Minimum Residual) method, with a single non-blocking global reduction per
+     iteration that is overlapped with the matrix-vector product and the preconditioner application.
+
+   Options Database Keys:
++   -ksp_pipeminres_replace <n> - recompute the auxiliary vectors A u and B A u from their definition every n iterations
+                                  (two extra matrix-vector products and preconditioner applications), 0 for never (default)
+-   see KSPSolve()
+
+   Level: intermediate
+
+   Notes:
+   The operator and the preconditioner must be symmetric and the preconditioner must
+   be positive definite for this method; the operator may be indefinite. Supports only left preconditioning.
+
+   KSPMINRES needs two blocking global reductions per iteration, this method needs one that can be overlapped
+   with the matrix-vector product and preconditioner application at the cost of three more vector recurrences.
+   The auxiliary vectors are computed by recurrences, so the computed Lanczos vectors slowly drift away from the
+   ones of KSPMINRES; -ksp_pipeminres_replace bounds that drift. If the recurrences give a negative square of the
+   next Lanczos coefficient the method restarts from the true residual.
+
+   MPI configuration may be necessary for reductions to make asynchronous progress, which is important for
+   performance of pipelined methods. See the FAQ on the PETSc website for details.
+
+   Reference:
+   Ghysels and Vanroose, Hiding global synchronization latency in the preconditioned Conjugate Gradient algorithm, 2014.
+
+.seealso: KSPCreate(), KSPSetType(), KSPType (for list of available types), KSP, KSPMINRES, KSPPIPECG, KSPPIPECR, KSPPIPELGMRES
+M*/
+PETSC_EXTERN PetscErrorCode KSPCreate_PIPEMINRES(KSP ksp)
+{
+  KSP_PIPEMINRES *pminres;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr           = KSPSetSupportedNorm(ksp,KSP_NORM_PRECONDITIONED,PC_LEFT,3);CHKERRQ(ierr);
+  ierr           = PetscNewLog(ksp,&pminres);CHKERRQ(ierr);
+
+  /* this parameter is arbitrary; but e-50 didn't work for __float128 in one example */
+#if defined(PETSC_USE_REAL___FLOAT128)
+  pminres->haptol = 1.e-100;
+#elif defined(PETSC_USE_REAL_SINGLE)
+  pminres->haptol = 1.e-25;
+#else
+  pminres->haptol = 1.e-50;
+#endif
+  pminres->replace = 0;
+  ksp->data        = (void*)pminres;
+
+  ksp->ops->setup          = KSPSetUp_PIPEMINRES;
+  ksp->ops->solve          = KSPSolve_PIPEMINRES;
+  ksp->ops->destroy        = KSPDestroyDefault;
+  ksp->ops->view           = KSPView_PIPEMINRES;
+  ksp->ops->setfromoptions = KSPSetFromOptions_PIPEMINRES;
+  ksp->ops->buildsolution  = KSPBuildSolutionDefault;
+  ksp->ops->buildresidual  = KSPBuildResidualDefault;
+  PetscFunctionReturn(0);
+}
@@ -32,6 +32,8 @@ typedef struct {
   PetscBool  dm_subdomains;       /* whether DM is allowed to define subdomains */
   PCCompositeType loctype;        /* the type of composition for local solves */
   MatType    sub_mat_type;        /* the type of Mat used for subdomain solves (can be MATSAME or NULL) */
+  PetscInt   nthreads;            /* number of threads that solve on the local subdomains concurrently */
+  PetscInt   *order;              /* subdomains by increasing size, the concurrent solves take the largest first */
   /* For multiplicative solve */
   Mat       *lmats;               /* submatrices for overlapping multiplicative (process) subdomain */
 } PC_ASM;
@@ -56,6 +58,7 @@ static PetscErrorCode PCView_ASM(PC pc,PetscViewer viewer)
     ierr = PetscViewerASCIIPrintf(viewer,"  restriction/interpolation type - %s\n",PCASMTypes[osm->type]);CHKERRQ(ierr);
     if (osm->dm_subdomains) {ierr = PetscViewerASCIIPrintf(viewer,"  Additive Schwarz: using DM to define subdomains\n");CHKERRQ(ierr);}
     if (osm->loctype != PC_COMPOSITE_ADDITIVE) {ierr = PetscViewerASCIIPrintf(viewer,"  Additive Schwarz: local solve composition type - %s\n",PCCompositeTypes[osm->loctype]);CHKERRQ(ierr);}
+    if (osm->nthreads > 1 && osm->loctype == PC_COMPOSITE_ADDITIVE) {ierr = PetscViewerASCIIPrintf(viewer,"  Additive Schwarz: local blocks solved concurrently by %D threads\n",osm->nthreads);CHKERRQ(ierr);}
     ierr = MPI_Comm_rank(PetscObjectComm((PetscObject)pc),&rank);CHKERRQ(ierr);
     if (osm->same_local_solves) {
       if (osm->ksp) {
@@ -348,6 +351,7 @@ static PetscErrorCode PCSetUp_ASM(PC pc)
     ierr = PetscMalloc1(osm->n_local_true,&osm->lrestriction);CHKERRQ(ierr);
     ierr = PetscMalloc1(osm->n_local_true,&osm->x);CHKERRQ(ierr);
     ierr = PetscMalloc1(osm->n_local_true,&osm->y);CHKERRQ(ierr);
+    ierr = PetscMalloc1(osm->n_local_true,&osm->order);CHKERRQ(ierr);
 
     ierr = ISGetLocalSize(osm->lis,&m);CHKERRQ(ierr);
     ierr = ISCreateStride(PETSC_COMM_SELF,m,0,1,&isl);CHKERRQ(ierr);
@@ -410,6 +414,18 @@ static PetscErrorCode PCSetUp_ASM(PC pc)
       }
     }
     ierr = VecDestroy(&vec);CHKERRQ(ierr);
+
+    {
+      PetscInt *sizes;
+
+      ierr = PetscMalloc1(osm->n_local_true,&sizes);CHKERRQ(ierr);
+      for (i=0; i<osm->n_local_true; ++i) {
+        ierr = ISGetLocalSize(osm->is[i],&sizes[i]);CHKERRQ(ierr);
+        osm->order[i] = i;
+      }
+      ierr = PetscSortIntWithPermutation(osm->n_local_true,sizes,osm->order);CHKERRQ(ierr);
+      ierr = PetscFree(sizes);CHKERRQ(ierr);
+    }
   }
 
   if (osm->loctype == PC_COMPOSITE_MULTIPLICATIVE) {
@@ -456,6 +472,49 @@ static PetscErrorCode PCSetUpOnBlocks_ASM(PC pc)
   PetscFunctionReturn(0);
 }
 
+#if defined(PETSC_HAVE_OPENMP) && defined(PETSC_HAVE_THREADSAFETY)
+/*
+   Additive local solves with the subdomains solved concurrently, see -pc_asm_threads. The restrictions to the
+   subdomains and the sums of the subdomain solutions into ly are done before and after the threaded loop, in
+   which the threads take the subdomains one at a time, largest first.
+*/
+static PetscErrorCode PCASMApplyOnBlocks_Threads(PC pc,ScatterMode forward,ScatterMode reverse,PetscBool transpose)
+{
+  PC_ASM         *osm = (PC_ASM*)pc->data;
+  PetscErrorCode ierr = 0;
+  PetscInt       i,k,n_local_true = osm->n_local_true;
+
+  PetscFunctionBegin;
+  for (i = 0; i < n_local_true; ++i) {
+    ierr = VecScatterBegin(osm->lrestriction[i], osm->lx, osm->x[i], INSERT_VALUES, forward);CHKERRQ(ierr);
+    ierr = VecScatterEnd(osm->lrestriction[i], osm->lx, osm->x[i], INSERT_VALUES, forward);CHKERRQ(ierr);
+  }
+#pragma omp parallel for schedule(dynamic,1) num_threads(osm->nthreads)
+  for (k = 0; k < n_local_true; ++k) {
+    PetscInt       j = osm->order[n_local_true-1-k];
+    PetscErrorCode ierrb;
+
+    ierrb = transpose ? KSPSolveTranspose(osm->ksp[j], osm->x[j], osm->y[j]) : KSPSolve(osm->ksp[j], osm->x[j], osm->y[j]);
+    if (!ierrb) ierrb = KSPCheckSolve(osm->ksp[j],pc,osm->y[j]);
+    if (ierrb) {
+#pragma omp critical
+      ierr = ierrb;
+    }
+  }
+  CHKERRQ(ierr);
+  for (i = 0; i < n_local_true; ++i) {
+    if (osm->lprolongation) {
+      ierr = VecScatterBegin(osm->lprolongation[i], osm->y[i], osm->ly, ADD_VALUES, forward);CHKERRQ(ierr);
+      ierr = VecScatterEnd(osm->lprolongation[i], osm->y[i], osm->ly, ADD_VALUES, forward);CHKERRQ(ierr);
+    } else {
+      ierr = VecScatterBegin(osm->lrestriction[i], osm->y[i], osm->ly, ADD_VALUES, reverse);CHKERRQ(ierr);
+      ierr = VecScatterEnd(osm->lrestriction[i], osm->y[i], osm->ly, ADD_VALUES, reverse);CHKERRQ(ierr);
+    }
+  }
+  PetscFunctionReturn(0);
+}
+#endif
+
 static PetscErrorCode PCApply_ASM(PC pc,Vec x,Vec y)
 {
   PC_ASM         *osm = (PC_ASM*)pc->data;
@@ -486,6 +545,15 @@ static PetscErrorCode PCApply_ASM(PC pc,Vec x,Vec y)
     ierr = VecScatterBegin(osm->restriction, x, osm->lx, INSERT_VALUES, forward);CHKERRQ(ierr);
     ierr = VecScatterEnd(osm->restriction, x, osm->lx, INSERT_VALUES, forward);CHKERRQ(ierr);
 
+#if defined(PETSC_HAVE_OPENMP) && defined(PETSC_HAVE_THREADSAFETY)
+    if (osm->nthreads > 1 && osm->loctype == PC_COMPOSITE_ADDITIVE) {
+      ierr = PCASMApplyOnBlocks_Threads(pc,forward,reverse,PETSC_FALSE);CHKERRQ(ierr);
+      ierr = VecScatterBegin(osm->restriction, osm->ly, y, ADD_VALUES, reverse);CHKERRQ(ierr);
+      ierr = VecScatterEnd(osm->restriction, osm->ly, y, ADD_VALUES, reverse);CHKERRQ(ierr);
+      PetscFunctionReturn(0);
+    }
+#endif
+
     /* Restrict local RHS to the overlapping 0-block RHS */
     ierr = VecScatterBegin(osm->lrestriction[0], osm->lx, osm->x[0], INSERT_VALUES, forward);CHKERRQ(ierr);
     ierr = VecScatterEnd(osm->lrestriction[0], osm->lx, osm->x[0],  INSERT_VALUES, forward);CHKERRQ(ierr);
@@ -560,6 +628,15 @@ static PetscErrorCode PCApplyTranspose_ASM(PC pc,Vec x,Vec y)
   ierr = VecScatterBegin(osm->restriction, x, osm->lx, INSERT_VALUES, forward);CHKERRQ(ierr);
   ierr = VecScatterEnd(osm->restriction, x, osm->lx, INSERT_VALUES, forward);CHKERRQ(ierr);
 
+#if defined(PETSC_HAVE_OPENMP) && defined(PETSC_HAVE_THREADSAFETY)
+  if (osm->nthreads > 1) {
+    ierr = PCASMApplyOnBlocks_Threads(pc,forward,reverse,PETSC_TRUE);CHKERRQ(ierr);
+    ierr = VecScatterBegin(osm->restriction, osm->ly, y, ADD_VALUES, reverse);CHKERRQ(ierr);
+    ierr = VecScatterEnd(osm->restriction, osm->ly, y, ADD_VALUES, reverse);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+#endif
+
   /* Restrict local RHS to the overlapping 0-block RHS */
   ierr = VecScatterBegin(osm->lrestriction[0], osm->lx, osm->x[0], INSERT_VALUES, forward);CHKERRQ(ierr);
   ierr = VecScatterEnd(osm->lrestriction[0], osm->lx, osm->x[0],  INSERT_VALUES, forward);CHKERRQ(ierr);
@@ -625,6 +702,7 @@ static PetscErrorCode PCReset_ASM(PC pc)
     if (osm->lprolongation) {ierr = PetscFree(osm->lprolongation);CHKERRQ(ierr);}
     ierr = PetscFree(osm->x);CHKERRQ(ierr);
     ierr = PetscFree(osm->y);CHKERRQ(ierr);
+    ierr = PetscFree(osm->order);CHKERRQ(ierr);
 
   }
   ierr = PCASMDestroySubdomains(osm->n_local_true,osm->is,osm->is_local);CHKERRQ(ierr);
@@ -699,6 +777,13 @@ static PetscErrorCode PCSetFromOptions_ASM(PetscOptionItems *PetscOptionsObject,
   flg  = PETSC_FALSE;
   ierr = PetscOptionsEnum("-pc_asm_local_type","Type of local solver composition","PCASMSetLocalType",PCCompositeTypes,(PetscEnum)osm->loctype,(PetscEnum*)&loctype,&flg);CHKERRQ(ierr);
   if (flg) {ierr = PCASMSetLocalType(pc,loctype);CHKERRQ(ierr); }
+#if defined(PETSC_HAVE_OPENMP)
+  ierr = PetscOptionsInt("-pc_asm_threads","Number of threads that solve on the local subdomains concurrently","None",osm->nthreads,&osm->nthreads,NULL);CHKERRQ(ierr);
+  if (osm->nthreads < 1) SETERRQ1(PetscObjectComm((PetscObject)pc),PETSC_ERR_ARG_OUTOFRANGE,"Number of threads %D must be positive",osm->nthreads);
+#if !defined(PETSC_HAVE_THREADSAFETY)
+  if (osm->nthreads > 1) SETERRQ(PetscObjectComm((PetscObject)pc),PETSC_ERR_SUP,"Concurrent solves on the subdomains require PETSc configured with --with-threadsafety");
+#endif
+#endif
   ierr = PetscOptionsFList("-pc_asm_sub_mat_type","Subsolve Matrix Type","PCASMSetSubMatType",MatList,NULL,sub_mat_type,256,&flg);CHKERRQ(ierr);
   if(flg){
     ierr = PCASMSetSubMatType(pc,sub_mat_type);CHKERRQ(ierr);
@@ -1259,7 +1344,8 @@ PetscErrorCode  PCASMGetSubKSP(PC pc,PetscInt *n_local,PetscInt *first_local,KSP
 +  -pc_asm_blocks <blks> - Sets total blocks
 .  -pc_asm_overlap <ovl> - Sets overlap
 .  -pc_asm_type [basic,restrict,interpolate,none] - Sets ASM type, default is restrict
--  -pc_asm_local_type [additive, multiplicative] - Sets ASM type, default is additive
+.  -pc_asm_local_type [additive, multiplicative] - Sets ASM type, default is additive
+-  -pc_asm_threads <n> - solve on the subdomains of each process concurrently with n OpenMP threads, additive local type only
 
      IMPORTANT: If you run with, for example, 3 blocks on 1 processor or 3 blocks on 3 processors you
       will get a different convergence rate due to the default option of -pc_asm_type restrict. Use
@@ -1276,6 +1362,9 @@ PetscErrorCode  PCASMGetSubKSP(PC pc,PetscInt *n_local,PetscInt *first_local,KSP
          and set the options directly on the resulting KSP object (you can access its PC
          with KSPGetPC())
 
+     With several subdomains per process -pc_asm_threads dispatches the subdomain solves to OpenMP threads, largest
+         subdomain first. This requires PETSc configured with --with-openmp --with-threadsafety.
+
    Level: beginner
 
    Concepts: additive Schwarz method
@@ -1320,6 +1409,8 @@ PETSC_EXTERN PetscErrorCode PCCreate_ASM(PC pc)
   osm->sort_indices      = PETSC_TRUE;
   osm->dm_subdomains     = PETSC_FALSE;
   osm->sub_mat_type      = NULL;
+  osm->nthreads          = 1;
+  osm->order             = NULL;
 
   pc->data                 = (void*)osm;
   pc->ops->apply           = PCApply_ASM;
@@ -167,6 +167,13 @@ static PetscErrorCode PCSetFromOptions_BJacobi(PetscOptionItems *PetscOptionsObj
   if (flg) {ierr = PCBJacobiSetTotalBlocks(pc,blocks,NULL);CHKERRQ(ierr);}
   ierr = PetscOptionsInt("-pc_bjacobi_local_blocks","Local number of blocks","PCBJacobiSetLocalBlocks",jac->n_local,&blocks,&flg);CHKERRQ(ierr);
   if (flg) {ierr = PCBJacobiSetLocalBlocks(pc,blocks,NULL);CHKERRQ(ierr);}
+#if defined(PETSC_HAVE_OPENMP)
+  ierr = PetscOptionsInt("-pc_bjacobi_threads","Number of threads that solve on the local blocks concurrently","None",jac->nthreads,&jac->nthreads,NULL);CHKERRQ(ierr);
+  if (jac->nthreads < 1) SETERRQ1(PetscObjectComm((PetscObject)pc),PETSC_ERR_ARG_OUTOFRANGE,"Number of threads %D must be positive",jac->nthreads);
+#if !defined(PETSC_HAVE_THREADSAFETY)
+  if (jac->nthreads > 1) SETERRQ(PetscObjectComm((PetscObject)pc),PETSC_ERR_SUP,"Concurrent solves on the blocks require PETSc configured with --with-threadsafety");
+#endif
+#endif
   if (jac->ksp) {
     /* The sub-KSP has already been set up (e.g., PCSetUp_BJacobi_Singleblock), but KSPSetFromOptions was not called
      * unless we had already been called. */
@@ -198,6 +205,9 @@ static PetscErrorCode PCView_BJacobi(PC pc,PetscViewer viewer)
       ierr = PetscViewerASCIIPrintf(viewer,"  using Amat local matrix, number of blocks = %D\n",jac->n);CHKERRQ(ierr);
     }
     ierr = PetscViewerASCIIPrintf(viewer,"  number of blocks = %D\n",jac->n);CHKERRQ(ierr);
+    if (jac->nthreads > 1) {
+      ierr = PetscViewerASCIIPrintf(viewer,"  local blocks solved concurrently by %D threads\n",jac->nthreads);CHKERRQ(ierr);
+    }
     ierr = MPI_Comm_rank(PetscObjectComm((PetscObject)pc),&rank);CHKERRQ(ierr);
     if (jac->same_local_solves) {
       ierr = PetscViewerASCIIPrintf(viewer,"  Local solve is same for all blocks, in the following KSP and PC objects:\n");CHKERRQ(ierr);
@@ -515,7 +525,8 @@ PetscErrorCode  PCBJacobiGetLocalBlocks(PC pc, PetscInt *blocks, const PetscInt
 
    Options Database Keys:
 +  -pc_use_amat - use Amat to apply block of operator in inner Krylov method
--  -pc_bjacobi_blocks <n> - use n total blocks
+.  -pc_bjacobi_blocks <n> - use n total blocks
+-  -pc_bjacobi_threads <n> - solve on the blocks of each process concurrently with n OpenMP threads
 
    Notes:
     Each processor can have one or more blocks, or a single block can be shared by several processes. Defaults to one block per processor.
@@ -535,6 +546,9 @@ PetscErrorCode  PCBJacobiGetLocalBlocks(PC pc, PetscInt *blocks, const PetscInt
 
      When multiple processes share a single block, each block encompasses exactly all the unknowns owned its set of processes.
 
+     With several blocks per process -pc_bjacobi_threads dispatches the solves on the blocks to OpenMP threads, largest block
+         first. This requires PETSc configured with --with-openmp --with-threadsafety.
+
    Level: beginner
 
    Concepts: block Jacobi
@@ -571,6 +585,7 @@ PETSC_EXTERN PetscErrorCode PCCreate_BJacobi(PC pc)
   jac->g_lens            = 0;
   jac->l_lens            = 0;
   jac->psubcomm          = 0;
+  jac->nthreads          = 1;
 
   ierr = PetscObjectComposeFunction((PetscObject)pc,"PCBJacobiGetSubKSP_C",PCBJacobiGetSubKSP_BJacobi);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)pc,"PCBJacobiSetTotalBlocks_C",PCBJacobiSetTotalBlocks_BJacobi);CHKERRQ(ierr);
@@ -871,6 +886,7 @@ static PetscErrorCode PCDestroy_BJacobi_Multiblock(PC pc)
     ierr = PetscFree2(bjac->x,bjac->y);CHKERRQ(ierr);
     ierr = PetscFree(bjac->starts);CHKERRQ(ierr);
     ierr = PetscFree(bjac->is);CHKERRQ(ierr);
+    ierr = PetscFree(bjac->order);CHKERRQ(ierr);
   }
   ierr = PetscFree(jac->data);CHKERRQ(ierr);
   for (i=0; i<jac->n_local; i++) {
@@ -899,6 +915,40 @@ static PetscErrorCode PCSetUpOnBlocks_BJacobi_Multiblock(PC pc)
   PetscFunctionReturn(0);
 }
 
+#if defined(PETSC_HAVE_OPENMP) && defined(PETSC_HAVE_THREADSAFETY)
+/*
+      Solves on all the local blocks concurrently, see -pc_bjacobi_threads. The threads take the blocks
+   one at a time, largest first, so that a few large blocks do not keep the other threads waiting.
+*/
+static PetscErrorCode PCApplyOnBlocks_BJacobi_Multiblock_Threads(PC pc,const PetscScalar *xin,PetscScalar *yin,PetscBool transpose)
+{
+  PC_BJacobi            *jac = (PC_BJacobi*)pc->data;
+  PC_BJacobi_Multiblock *bjac = (PC_BJacobi_Multiblock*)jac->data;
+  PetscErrorCode        ierr = 0;
+  PetscInt              k,n_local = jac->n_local;
+
+  PetscFunctionBegin;
+#pragma omp parallel for schedule(dynamic,1) num_threads(jac->nthreads)
+  for (k=0; k<n_local; k++) {
+    PetscInt       i = bjac->order[n_local-1-k];
+    PetscErrorCode ierrb;
+
+    ierrb = VecPlaceArray(bjac->x[i],xin+bjac->starts[i]);
+    if (!ierrb) ierrb = VecPlaceArray(bjac->y[i],yin+bjac->starts[i]);
+    if (!ierrb) ierrb = transpose ? KSPSolveTranspose(jac->ksp[i],bjac->x[i],bjac->y[i]) : KSPSolve(jac->ksp[i],bjac->x[i],bjac->y[i]);
+    if (!ierrb) ierrb = KSPCheckSolve(jac->ksp[i],pc,bjac->y[i]);
+    if (!ierrb) ierrb = VecResetArray(bjac->x[i]);
+    if (!ierrb) ierrb = VecResetArray(bjac->y[i]);
+    if (ierrb) {
+#pragma omp critical
+      ierr = ierrb;
+    }
+  }
+  CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+#endif
+
 /*
       Preconditioner for block Jacobi
 */
@@ -914,6 +964,14 @@ static PetscErrorCode PCApply_BJacobi_Multiblock(PC pc,Vec x,Vec y)
   PetscFunctionBegin;
   ierr = VecGetArrayRead(x,&xin);CHKERRQ(ierr);
   ierr = VecGetArray(y,&yin);CHKERRQ(ierr);
+#if defined(PETSC_HAVE_OPENMP) && defined(PETSC_HAVE_THREADSAFETY)
+  if (jac->nthreads > 1) {
+    ierr = PCApplyOnBlocks_BJacobi_Multiblock_Threads(pc,xin,yin,PETSC_FALSE);CHKERRQ(ierr);
+    ierr = VecRestoreArrayRead(x,&xin);CHKERRQ(ierr);
+    ierr = VecRestoreArray(y,&yin);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+#endif
   for (i=0; i<n_local; i++) {
     /*
        To avoid copying the subvector from x into a workspace we instead
@@ -951,6 +1009,14 @@ static PetscErrorCode PCApplyTranspose_BJacobi_Multiblock(PC pc,Vec x,Vec y)
   PetscFunctionBegin;
   ierr = VecGetArrayRead(x,&xin);CHKERRQ(ierr);
   ierr = VecGetArray(y,&yin);CHKERRQ(ierr);
+#if defined(PETSC_HAVE_OPENMP) && defined(PETSC_HAVE_THREADSAFETY)
+  if (jac->nthreads > 1) {
+    ierr = PCApplyOnBlocks_BJacobi_Multiblock_Threads(pc,xin,yin,PETSC_TRUE);CHKERRQ(ierr);
+    ierr = VecRestoreArrayRead(x,&xin);CHKERRQ(ierr);
+    ierr = VecRestoreArray(y,&yin);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+#endif
   for (i=0; i<n_local; i++) {
     /*
        To avoid copying the subvector from x into a workspace we instead
@@ -1015,6 +1081,7 @@ static PetscErrorCode PCSetUp_BJacobi_Multiblock(PC pc,Mat mat,Mat pmat)
       ierr = PetscLogObjectMemory((PetscObject)pc,sizeof(n_local*sizeof(KSP)));CHKERRQ(ierr);
       ierr = PetscMalloc2(n_local,&bjac->x,n_local,&bjac->y);CHKERRQ(ierr);
       ierr = PetscMalloc1(n_local,&bjac->starts);CHKERRQ(ierr);
+      ierr = PetscMalloc1(n_local,&bjac->order);CHKERRQ(ierr);
       ierr = PetscLogObjectMemory((PetscObject)pc,sizeof(n_local*sizeof(PetscScalar)));CHKERRQ(ierr);
 
       jac->data = (void*)bjac;
@@ -1078,6 +1145,8 @@ static PetscErrorCode PCSetUp_BJacobi_Multiblock(PC pc,Mat mat,Mat pmat)
 
       start += m;
     }
+    for (i=0; i<n_local; i++) bjac->order[i] = i;
+    ierr = PetscSortIntWithPermutation(n_local,jac->l_lens,bjac->order);CHKERRQ(ierr);
   } else {
     bjac = (PC_BJacobi_Multiblock*)jac->data;
     /*
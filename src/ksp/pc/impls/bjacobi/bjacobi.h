@@ -21,6 +21,7 @@ typedef struct {
   PetscInt     *l_lens;           /* lens of each block */
   PetscInt     *g_lens;
   PetscSubcomm psubcomm;          /* for multiple processors per block */
+  PetscInt     nthreads;          /* number of threads that solve on the local blocks concurrently */
 } PC_BJacobi;
 
 /*
@@ -33,6 +34,7 @@ typedef struct {
   PetscInt *starts;                   /* starting point of each block */
   Mat      *mat,*pmat;                /* submatrices for each block */
   IS       *is;                       /* for gathering the submatrices */
+  PetscInt *order;                    /* blocks by increasing size, the concurrent solves take the largest first */
 } PC_BJacobi_Multiblock;
 
 /*  This is for a single block per processor */
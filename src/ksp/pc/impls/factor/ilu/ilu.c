@@ -274,14 +274,19 @@ static PetscErrorCode PCApplySymmetricRight_ILU(PC pc,Vec x,Vec y)
           If you are using MATSEQAIJCUSPARSE matrices (or MATMPIAIJCUSPARESE matrices with block Jacobi), factorization 
           is never done on the GPU).
 
+          For SeqAIJ matrices -mat_aij_chowpatel_sweeps <n> computes the values of the ILU(k) factor with n fine-grained
+          fixed point sweeps [4] that run in parallel with OpenMP, and -mat_aij_chowpatel_jacobi <m> replaces the
+          triangular solves with m Jacobi iterations each.
+
    References:
 +  1. - T. Dupont, R. Kendall, and H. Rachford. An approximate factorization procedure for solving
    self adjoint elliptic difference equations. SIAM J. Numer. Anal., 5, 1968.
 .  2. -  T.A. Oliphant. An implicit numerical method for solving two dimensional timedependent diffusion problems. Quart. Appl. Math., 19, 1961.
--  3. -  TONY F. CHAN AND HENK A. VAN DER VORST, APPROXIMATE AND INCOMPLETE FACTORIZATIONS, 
+.  3. -  TONY F. CHAN AND HENK A. VAN DER VORST, APPROXIMATE AND INCOMPLETE FACTORIZATIONS, 
       Chapter in Parallel Numerical
       Algorithms, edited by D. Keyes, A. Semah, V. Venkatakrishnan, ICASE/LaRC Interdisciplinary Series in
       Science and Engineering, Kluwer.
+-  4. -  E. Chow and A. Patel, Fine-grained parallel incomplete LU factorization, SIAM J. Sci. Comput., 37, 2015.
 
 
 .seealso:  PCCreate(), PCSetType(), PCType (for list of available types), PC, PCSOR, MatOrderingType,
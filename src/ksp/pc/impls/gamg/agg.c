@@ -879,7 +879,13 @@ static PetscErrorCode PCGAMGCoarsen_AGG(PC a_pc,Mat *a_Gmat1,PetscCoarsenData **
 
   if (pc_gamg->current_level < pc_gamg_agg->square_graph) {
     ierr = PetscInfo2(a_pc,"Square Graph on level %D of %D to square\n",pc_gamg->current_level+1,pc_gamg_agg->square_graph);CHKERRQ(ierr);
+#if defined PETSC_GAMG_USE_LOG
+    ierr = PetscLogEventBegin(petsc_gamg_setup_events[GRAPH_SQR],0,0,0,0);CHKERRQ(ierr);
+#endif
     ierr = MatTransposeMatMult(Gmat1, Gmat1, MAT_INITIAL_MATRIX, PETSC_DEFAULT, &Gmat2);CHKERRQ(ierr);
+#if defined PETSC_GAMG_USE_LOG
+    ierr = PetscLogEventEnd(petsc_gamg_setup_events[GRAPH_SQR],0,0,0,0);CHKERRQ(ierr);
+#endif
   } else Gmat2 = Gmat1;
 
   /* get MIS aggs - randomize */
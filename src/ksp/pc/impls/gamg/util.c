@@ -3,6 +3,7 @@
  */
 #include <petsc/private/matimpl.h>
 #include <../src/ksp/pc/impls/gamg/gamg.h>           /*I "petscpc.h" I*/
+#include <petscsf.h>
 
 /*
    Produces a set of block column indices of the matrix row, one for each block represented in the original row
@@ -61,7 +62,7 @@ PETSC_STATIC_INLINE PetscErrorCode MatCollapseRows(Mat Amat,PetscInt start,Petsc
  Input Parameter:
  . Amat - matrix
  Output Parameter:
- . a_Gmaat - eoutput scalar graph (symmetric?)
+ . a_Gmaat - eoutput scalar graph (symmetric?), Amat itself (with a new reference) when the block size is 1
  */
 PetscErrorCode PCGAMGCreateGraph(Mat Amat, Mat *a_Gmat)
 {
@@ -80,6 +81,7 @@ PetscErrorCode PCGAMGCreateGraph(Mat Amat, Mat *a_Gmat)
 
 #if defined PETSC_GAMG_USE_LOG
   ierr = PetscLogEventBegin(petsc_gamg_setup_events[GRAPH],0,0,0,0);CHKERRQ(ierr);
+  ierr = PetscLogEventBegin(petsc_gamg_setup_events[GRAPH_MAT],0,0,0,0);CHKERRQ(ierr);
 #endif
 
   if (bs > 1) {
@@ -166,11 +168,13 @@ PetscErrorCode PCGAMGCreateGraph(Mat Amat, Mat *a_Gmat)
     ierr = MatAssemblyBegin(Gmat,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
     ierr = MatAssemblyEnd(Gmat,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
   } else {
-    /* just copy scalar matrix - abs() not taken here but scaled later */
-    ierr = MatDuplicate(Amat, MAT_COPY_VALUES, &Gmat);CHKERRQ(ierr);
+    /* just reference the scalar matrix - abs() not taken here but scaled later, PCGAMGFilterGraph() does not change it */
+    ierr = PetscObjectReference((PetscObject)Amat);CHKERRQ(ierr);
+    Gmat = Amat;
   }
 
 #if defined PETSC_GAMG_USE_LOG
+  ierr = PetscLogEventEnd(petsc_gamg_setup_events[GRAPH_MAT],0,0,0,0);CHKERRQ(ierr);
   ierr = PetscLogEventEnd(petsc_gamg_setup_events[GRAPH],0,0,0,0);CHKERRQ(ierr);
 #endif
 
@@ -194,88 +198,123 @@ PetscErrorCode PCGAMGCreateGraph(Mat Amat, Mat *a_Gmat)
    Notes:
     This is called before graph coarsers are called.
 
+    The scaling, the filtering and the symmetrization are done in a single pass over the local rows of the graph.
+    The transposes of the entries in the off-diagonal block are gathered to their owning processes with a PetscSF
+    so no transpose of the graph is formed and all the values of the new graph are set on the process that owns them.
+    The input graph is not changed, it is only dereferenced.
+
 .seealso: PCGAMGSetThreshold()
 @*/
 PetscErrorCode PCGAMGFilterGraph(Mat *a_Gmat,PetscReal vfilter,PetscBool symm)
 {
   PetscErrorCode    ierr;
-  PetscInt          Istart,Iend,Ii,jj,ncols,nnz0,nnz1, NN, MM, nloc;
-  PetscMPIInt       rank;
-  Mat               Gmat  = *a_Gmat, tGmat, matTrans;
+  PetscInt          Istart,Iend,Ii,jj,kk,nnz0,nnz1,NN,MM,nloc,nghost = 0,nleaves = 0,nrecv = 0,col;
+  Mat               Gmat = *a_Gmat,tGmat,Daij,Oaij = NULL;
+  Mat_SeqAIJ        *aij,*bij = NULL;
   MPI_Comm          comm;
-  const PetscScalar *vals;
-  const PetscInt    *idx;
-  PetscInt          *d_nnz, *o_nnz;
+  const PetscInt    *garray = NULL,*degree = NULL;
+  const PetscScalar *dl;
+  PetscScalar       *dg = NULL,*tval = NULL,*rval = NULL,sv;
+  PetscInt          *d_nnz,*o_nnz,*tcol = NULL,*rcol = NULL;
+  PetscSFNode       *tremote = NULL;
+  const PetscSFNode *gremote;
+  PetscSF           sf = NULL,tsf = NULL;
+  PetscBool         isseqaij,ismpiaij;
   Vec               diag;
   MatType           mtype;
 
   PetscFunctionBegin;
 #if defined PETSC_GAMG_USE_LOG
   ierr = PetscLogEventBegin(petsc_gamg_setup_events[GRAPH],0,0,0,0);CHKERRQ(ierr);
+  ierr = PetscLogEventBegin(petsc_gamg_setup_events[GRAPH_FILTER],0,0,0,0);CHKERRQ(ierr);
 #endif
-  /* scale Gmat for all values between -1 and 1 */
-  ierr = MatCreateVecs(Gmat, &diag, 0);CHKERRQ(ierr);
-  ierr = MatGetDiagonal(Gmat, diag);CHKERRQ(ierr);
-  ierr = VecReciprocal(diag);CHKERRQ(ierr);
-  ierr = VecSqrtAbs(diag);CHKERRQ(ierr);
-  ierr = MatDiagonalScale(Gmat, diag, diag);CHKERRQ(ierr);
-  ierr = VecDestroy(&diag);CHKERRQ(ierr);
-
-  if (vfilter < 0.0 && !symm) {
-    /* Just use the provided matrix as the graph but make all values positive */
-    MatInfo     info;
-    PetscScalar *avals;
-    PetscBool isaij,ismpiaij;
-    ierr = PetscObjectBaseTypeCompare((PetscObject)Gmat,MATSEQAIJ,&isaij);CHKERRQ(ierr);
+  ierr = PetscObjectGetComm((PetscObject)Gmat,&comm);CHKERRQ(ierr);
+  ierr = PetscObjectBaseTypeCompare((PetscObject)Gmat,MATSEQAIJ,&isseqaij);CHKERRQ(ierr);
+  ierr = PetscObjectBaseTypeCompare((PetscObject)Gmat,MATMPIAIJ,&ismpiaij);CHKERRQ(ierr);
+  if (!isseqaij && !ismpiaij) {
+    Mat B;
+    ierr = MatConvert(Gmat,MATAIJ,MAT_INITIAL_MATRIX,&B);CHKERRQ(ierr);
+    ierr = MatDestroy(&Gmat);CHKERRQ(ierr);
+    Gmat = B;
     ierr = PetscObjectBaseTypeCompare((PetscObject)Gmat,MATMPIAIJ,&ismpiaij);CHKERRQ(ierr);
-    if (!isaij && !ismpiaij) SETERRQ(PETSC_COMM_WORLD,PETSC_ERR_USER,"Require (MPI)AIJ matrix type");
-    if (isaij) {
-      ierr = MatGetInfo(Gmat,MAT_LOCAL,&info);CHKERRQ(ierr);
-      ierr = MatSeqAIJGetArray(Gmat,&avals);CHKERRQ(ierr);
-      for (jj = 0; jj<info.nz_used; jj++) avals[jj] = PetscAbsScalar(avals[jj]);
-      ierr = MatSeqAIJRestoreArray(Gmat,&avals);CHKERRQ(ierr);
-    } else {
-      Mat_MPIAIJ  *aij = (Mat_MPIAIJ*)Gmat->data;
-      ierr = MatGetInfo(aij->A,MAT_LOCAL,&info);CHKERRQ(ierr);
-      ierr = MatSeqAIJGetArray(aij->A,&avals);CHKERRQ(ierr);
-      for (jj = 0; jj<info.nz_used; jj++) avals[jj] = PetscAbsScalar(avals[jj]);
-      ierr = MatSeqAIJRestoreArray(aij->A,&avals);CHKERRQ(ierr);
-      ierr = MatGetInfo(aij->B,MAT_LOCAL,&info);CHKERRQ(ierr);
-      ierr = MatSeqAIJGetArray(aij->B,&avals);CHKERRQ(ierr);
-      for (jj = 0; jj<info.nz_used; jj++) avals[jj] = PetscAbsScalar(avals[jj]);
-      ierr = MatSeqAIJRestoreArray(aij->B,&avals);CHKERRQ(ierr);
-    }
-#if defined PETSC_GAMG_USE_LOG
-    ierr = PetscLogEventEnd(petsc_gamg_setup_events[GRAPH],0,0,0,0);CHKERRQ(ierr);
-#endif
-    PetscFunctionReturn(0);
   }
-
-  ierr = PetscObjectGetComm((PetscObject)Gmat,&comm);CHKERRQ(ierr);
-  ierr = MPI_Comm_rank(comm,&rank);CHKERRQ(ierr);
   ierr = MatGetOwnershipRange(Gmat, &Istart, &Iend);CHKERRQ(ierr);
   nloc = Iend - Istart;
   ierr = MatGetSize(Gmat, &MM, &NN);CHKERRQ(ierr);
-
-  if (symm) {
-    ierr = MatTranspose(Gmat, MAT_INITIAL_MATRIX, &matTrans);CHKERRQ(ierr);
+  if (ismpiaij) {
+    ierr = MatMPIAIJGetSeqAIJ(Gmat,&Daij,&Oaij,&garray);CHKERRQ(ierr);
+    bij  = (Mat_SeqAIJ*)Oaij->data;
+    ierr = MatGetLocalSize(Oaij,NULL,&nghost);CHKERRQ(ierr);
+  } else Daij = Gmat;
+  aij = (Mat_SeqAIJ*)Daij->data;
+
+  /* D^{-1/2} to scale Gmat for all values between -1 and 1, on the local rows and on the ghost columns */
+  ierr = MatCreateVecs(Gmat, &diag, 0);CHKERRQ(ierr);
+  ierr = MatGetDiagonal(Gmat, diag);CHKERRQ(ierr);
+  ierr = VecReciprocal(diag);CHKERRQ(ierr);
+  ierr = VecSqrtAbs(diag);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(diag,&dl);CHKERRQ(ierr);
+  if (Oaij) {
+    ierr = PetscSFCreate(comm,&sf);CHKERRQ(ierr);
+    ierr = PetscSFSetGraphLayout(sf,Gmat->cmap,nghost,NULL,PETSC_COPY_VALUES,garray);CHKERRQ(ierr);
+    ierr = PetscMalloc1(nghost,&dg);CHKERRQ(ierr);
+    ierr = PetscSFBcastBegin(sf,MPIU_SCALAR,dl,dg);CHKERRQ(ierr);
   }
 
-  /* Determine upper bound on nonzeros needed in new filtered matrix */
-  ierr = PetscMalloc2(nloc, &d_nnz,nloc, &o_nnz);CHKERRQ(ierr);
-  for (Ii = Istart, jj = 0; Ii < Iend; Ii++, jj++) {
-    ierr      = MatGetRow(Gmat,Ii,&ncols,NULL,NULL);CHKERRQ(ierr);
-    d_nnz[jj] = ncols;
-    o_nnz[jj] = ncols;
-    ierr      = MatRestoreRow(Gmat,Ii,&ncols,NULL,NULL);CHKERRQ(ierr);
+  /* count the entries that pass the filter, the ones of the transpose of the diagonal block are local */
+  ierr = PetscCalloc2(nloc, &d_nnz,nloc, &o_nnz);CHKERRQ(ierr);
+  for (Ii = 0, nnz0 = nnz1 = 0; Ii < nloc; Ii++) {
+    for (kk = aij->i[Ii]; kk < aij->i[Ii+1]; kk++, nnz0++) {
+      col = aij->j[kk];
+      sv  = PetscAbs(PetscRealPart(aij->a[kk]*dl[Ii]*dl[col]));
+      if (PetscRealPart(sv) > vfilter) {
+        nnz1++;
+        d_nnz[Ii]++;
+        if (symm) d_nnz[col]++;
+      }
+    }
+  }
+  if (Oaij) {
+    ierr = PetscSFBcastEnd(sf,MPIU_SCALAR,dl,dg);CHKERRQ(ierr);
+    ierr = PetscSFGetGraph(sf,NULL,NULL,NULL,&gremote);CHKERRQ(ierr);
     if (symm) {
-      ierr       = MatGetRow(matTrans,Ii,&ncols,NULL,NULL);CHKERRQ(ierr);
-      d_nnz[jj] += ncols;
-      o_nnz[jj] += ncols;
-      ierr       = MatRestoreRow(matTrans,Ii,&ncols,NULL,NULL);CHKERRQ(ierr);
+      ierr = PetscMalloc3(bij->i[nloc],&tremote,bij->i[nloc],&tcol,bij->i[nloc],&tval);CHKERRQ(ierr);
+    }
+    for (Ii = 0; Ii < nloc; Ii++) {
+      for (kk = bij->i[Ii]; kk < bij->i[Ii+1]; kk++, nnz0++) {
+        col = bij->j[kk];
+        sv  = PetscAbs(PetscRealPart(bij->a[kk]*dl[Ii]*dg[col]));
+        if (PetscRealPart(sv) > vfilter) {
+          nnz1++;
+          o_nnz[Ii]++;
+          if (symm) {
+            /* entry (Istart+Ii,garray[col]) of the transpose lives in a ghost row, send it to its owner */
+            tremote[nleaves] = gremote[col];
+            tcol[nleaves]    = Istart + Ii;
+            tval[nleaves]    = 0.5*sv;
+            nleaves++;
+          }
+        }
+      }
     }
-    if (d_nnz[jj] > nloc) d_nnz[jj] = nloc;
-    if (o_nnz[jj] > (MM-nloc)) o_nnz[jj] = MM - nloc;
+  }
+  if (symm && Oaij) {
+    ierr = PetscSFCreate(comm,&tsf);CHKERRQ(ierr);
+    ierr = PetscSFSetGraph(tsf,nloc,nleaves,NULL,PETSC_COPY_VALUES,tremote,PETSC_COPY_VALUES);CHKERRQ(ierr);
+    ierr = PetscSFComputeDegreeBegin(tsf,&degree);CHKERRQ(ierr);
+    ierr = PetscSFComputeDegreeEnd(tsf,&degree);CHKERRQ(ierr);
+    for (Ii = 0; Ii < nloc; Ii++) {
+      o_nnz[Ii] += degree[Ii];
+      nrecv     += degree[Ii];
+    }
+    ierr = PetscMalloc2(nrecv,&rcol,nrecv,&rval);CHKERRQ(ierr);
+    ierr = PetscSFGatherBegin(tsf,MPIU_INT,tcol,rcol);CHKERRQ(ierr);
+    ierr = PetscSFGatherBegin(tsf,MPIU_SCALAR,tval,rval);CHKERRQ(ierr);
+  }
+
+  for (Ii = 0; Ii < nloc; Ii++) {
+    if (d_nnz[Ii] > nloc) d_nnz[Ii] = nloc;
+    if (o_nnz[Ii] > (MM-nloc)) o_nnz[Ii] = MM - nloc;
   }
   ierr = MatGetType(Gmat,&mtype);CHKERRQ(ierr);
   ierr = MatCreate(comm, &tGmat);CHKERRQ(ierr);
@@ -285,41 +324,66 @@ PetscErrorCode PCGAMGFilterGraph(Mat *a_Gmat,PetscReal vfilter,PetscBool symm)
   ierr = MatSeqAIJSetPreallocation(tGmat,0,d_nnz);CHKERRQ(ierr);
   ierr = MatMPIAIJSetPreallocation(tGmat,0,d_nnz,0,o_nnz);CHKERRQ(ierr);
   ierr = PetscFree2(d_nnz,o_nnz);CHKERRQ(ierr);
-  if (symm) {
-    ierr = MatDestroy(&matTrans);CHKERRQ(ierr);
-  } else {
-    /* all entries are generated locally so MatAssembly will be slightly faster for large process counts */
-    ierr = MatSetOption(tGmat,MAT_NO_OFF_PROC_ENTRIES,PETSC_TRUE);CHKERRQ(ierr);
-  }
-
-  for (Ii = Istart, nnz0 = nnz1 = 0; Ii < Iend; Ii++) {
-    ierr = MatGetRow(Gmat,Ii,&ncols,&idx,&vals);CHKERRQ(ierr);
-    for (jj=0; jj<ncols; jj++,nnz0++) {
-      PetscScalar sv = PetscAbs(PetscRealPart(vals[jj]));
+  /* all entries are generated locally so MatAssembly will be faster for large process counts */
+  ierr = MatSetOption(tGmat,MAT_NO_OFF_PROC_ENTRIES,PETSC_TRUE);CHKERRQ(ierr);
+
+  for (Ii = 0; Ii < nloc; Ii++) {
+    PetscInt row = Istart + Ii;
+    for (kk = aij->i[Ii]; kk < aij->i[Ii+1]; kk++) {
+      col = aij->j[kk];
+      sv  = PetscAbs(PetscRealPart(aij->a[kk]*dl[Ii]*dl[col]));
       if (PetscRealPart(sv) > vfilter) {
-        nnz1++;
+        col += Istart;
         if (symm) {
           sv  *= 0.5;
-          ierr = MatSetValues(tGmat,1,&Ii,1,&idx[jj],&sv,ADD_VALUES);CHKERRQ(ierr);
-          ierr = MatSetValues(tGmat,1,&idx[jj],1,&Ii,&sv,ADD_VALUES);CHKERRQ(ierr);
+          ierr = MatSetValues(tGmat,1,&row,1,&col,&sv,ADD_VALUES);CHKERRQ(ierr);
+          ierr = MatSetValues(tGmat,1,&col,1,&row,&sv,ADD_VALUES);CHKERRQ(ierr);
         } else {
-          ierr = MatSetValues(tGmat,1,&Ii,1,&idx[jj],&sv,ADD_VALUES);CHKERRQ(ierr);
+          ierr = MatSetValues(tGmat,1,&row,1,&col,&sv,ADD_VALUES);CHKERRQ(ierr);
+        }
+      }
+    }
+    if (Oaij) {
+      for (kk = bij->i[Ii]; kk < bij->i[Ii+1]; kk++) {
+        sv = PetscAbs(PetscRealPart(bij->a[kk]*dl[Ii]*dg[bij->j[kk]]));
+        if (PetscRealPart(sv) > vfilter) {
+          col = garray[bij->j[kk]];
+          if (symm) sv *= 0.5;
+          ierr = MatSetValues(tGmat,1,&row,1,&col,&sv,ADD_VALUES);CHKERRQ(ierr);
         }
       }
     }
-    ierr = MatRestoreRow(Gmat,Ii,&ncols,&idx,&vals);CHKERRQ(ierr);
   }
+  if (tsf) {
+    ierr = PetscSFGatherEnd(tsf,MPIU_INT,tcol,rcol);CHKERRQ(ierr);
+    ierr = PetscSFGatherEnd(tsf,MPIU_SCALAR,tval,rval);CHKERRQ(ierr);
+    for (Ii = 0, jj = 0; Ii < nloc; Ii++) {
+      PetscInt row = Istart + Ii;
+      for (kk = 0; kk < degree[Ii]; kk++, jj++) {
+        ierr = MatSetValues(tGmat,1,&row,1,&rcol[jj],&rval[jj],ADD_VALUES);CHKERRQ(ierr);
+      }
+    }
+    ierr = PetscFree2(rcol,rval);CHKERRQ(ierr);
+    ierr = PetscSFDestroy(&tsf);CHKERRQ(ierr);
+  }
+  ierr = PetscFree3(tremote,tcol,tval);CHKERRQ(ierr);
+  ierr = PetscFree(dg);CHKERRQ(ierr);
+  ierr = PetscSFDestroy(&sf);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(diag,&dl);CHKERRQ(ierr);
+  ierr = VecDestroy(&diag);CHKERRQ(ierr);
   ierr = MatAssemblyBegin(tGmat,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
   ierr = MatAssemblyEnd(tGmat,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
 
 #if defined PETSC_GAMG_USE_LOG
+  ierr = PetscLogEventEnd(petsc_gamg_setup_events[GRAPH_FILTER],0,0,0,0);CHKERRQ(ierr);
   ierr = PetscLogEventEnd(petsc_gamg_setup_events[GRAPH],0,0,0,0);CHKERRQ(ierr);
 #endif
 
 #if defined(PETSC_USE_INFO)
   {
     double t1 = (!nnz0) ? 1. : 100.*(double)nnz1/(double)nnz0, t2 = (!nloc) ? 1. : (double)nnz0/(double)nloc;
-    ierr = PetscInfo4(*a_Gmat,"\t %g%% nnz after filtering, with threshold %g, %g nnz ave. (N=%D)\n",t1,vfilter,t2,MM);CHKERRQ(ierr);
+    ierr = PetscInfo4(Gmat,"\t %g%% nnz after filtering, with threshold %g, %g nnz ave. (N=%D)\n",t1,vfilter,t2,MM);CHKERRQ(ierr);
+    if (symm) {ierr = PetscInfo2(Gmat,"\t %D entries of the transpose sent, %D received\n",nleaves,nrecv);CHKERRQ(ierr);}
   }
 #endif
   ierr    = MatDestroy(&Gmat);CHKERRQ(ierr);
@@ -12,8 +12,12 @@
 typedef struct {
   const MatScalar *diag;
   PetscInt        bs,mbs;
+  MatScalar       *bdiag;     /* for bs > 7 the inverses of PCPBJACOBI_BATCH consecutive blocks interleaved entry by entry */
+  PetscScalar     *work;
 } PC_PBJacobi;
 
+#define PCPBJACOBI_BATCH 8
+
 
 static PetscErrorCode PCApply_PBJacobi_1(PC pc,Vec x,Vec y)
 {
@@ -192,21 +196,41 @@ static PetscErrorCode PCApply_PBJacobi_7(PC pc,Vec x,Vec y)
   ierr = PetscLogFlops(91.0*m);CHKERRQ(ierr); /* 2*bs2 - bs */
   PetscFunctionReturn(0);
 }
+/*
+   The blocks are processed PCPBJACOBI_BATCH at a time using the interleaved copy of their inverses, so that the
+   innermost loop runs over the blocks of a batch with unit stride; the remaining blocks use the usual layout.
+*/
 static PetscErrorCode PCApply_PBJacobi_N(PC pc,Vec x,Vec y)
 {
   PC_PBJacobi       *jac = (PC_PBJacobi*)pc->data;
   PetscErrorCode    ierr;
-  PetscInt          i,ib,jb;
+  PetscInt          i,ib,jb,w,nbatch;
+  const PetscInt    W = PCPBJACOBI_BATCH;
   const PetscInt    m = jac->mbs;
-  const PetscInt    bs = jac->bs;
-  const MatScalar   *diag = jac->diag;
-  PetscScalar       *yy;
+  const PetscInt    bs = jac->bs,bs2 = bs*bs;
+  const MatScalar   *diag,*bdiag;
+  PetscScalar       *yy,*xw = jac->work,sum[PCPBJACOBI_BATCH];
   const PetscScalar *xx;
 
   PetscFunctionBegin;
   ierr = VecGetArrayRead(x,&xx);CHKERRQ(ierr);
   ierr = VecGetArray(y,&yy);CHKERRQ(ierr);
-  for (i=0; i<m; i++) {
+  nbatch = m/W;
+  for (i=0; i<nbatch; i++) {
+    bdiag = jac->bdiag + i*W*bs2;
+    for (jb=0; jb<bs; jb++) {
+      for (w=0; w<W; w++) xw[jb*W+w] = xx[(i*W+w)*bs+jb];
+    }
+    for (ib=0; ib<bs; ib++) {
+      for (w=0; w<W; w++) sum[w] = 0.0;
+      for (jb=0; jb<bs; jb++) {
+        for (w=0; w<W; w++) sum[w] += bdiag[(ib+jb*bs)*W+w]*xw[jb*W+w];
+      }
+      for (w=0; w<W; w++) yy[(i*W+w)*bs+ib] = sum[w];
+    }
+  }
+  diag = jac->diag + nbatch*W*bs2;
+  for (i=nbatch*W; i<m; i++) {
     for (ib=0; ib<bs; ib++){
       PetscScalar rowsum = 0;
       for (jb=0; jb<bs; jb++){
@@ -214,7 +238,7 @@ static PetscErrorCode PCApply_PBJacobi_N(PC pc,Vec x,Vec y)
       }
       yy[bs*i+ib] = rowsum;
     }
-    diag += bs*bs;
+    diag += bs2;
   }
   ierr = VecRestoreArrayRead(x,&xx);CHKERRQ(ierr);
   ierr = VecRestoreArray(y,&yy);CHKERRQ(ierr);
@@ -264,17 +288,30 @@ static PetscErrorCode PCSetUp_PBJacobi(PC pc)
     pc->ops->apply = PCApply_PBJacobi_N;
     break;
   }
+  ierr = PetscFree2(jac->bdiag,jac->work);CHKERRQ(ierr);
+  if (jac->bs > 7) {
+    PetscInt i,k,w,W = PCPBJACOBI_BATCH,bs2 = jac->bs*jac->bs,nbatch = jac->mbs/W;
+
+    ierr = PetscMalloc2(nbatch*W*bs2,&jac->bdiag,jac->bs*W,&jac->work);CHKERRQ(ierr);
+    for (i=0; i<nbatch; i++) {
+      for (k=0; k<bs2; k++) {
+        for (w=0; w<W; w++) jac->bdiag[(i*bs2+k)*W+w] = jac->diag[(i*W+w)*bs2+k];
+      }
+    }
+  }
   PetscFunctionReturn(0);
 }
 /* -------------------------------------------------------------------------- */
 static PetscErrorCode PCDestroy_PBJacobi(PC pc)
 {
+  PC_PBJacobi    *jac = (PC_PBJacobi*)pc->data;
   PetscErrorCode ierr;
 
   PetscFunctionBegin;
   /*
       Free the private data structure that was hanging off the PC
   */
+  ierr = PetscFree2(jac->bdiag,jac->work);CHKERRQ(ierr);
   ierr = PetscFree(pc->data);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
@@ -0,0 +1,659 @@
+/*
+   Polynomial preconditioners: p(A) with a polynomial p of fixed degree computed once in PCSetUp(), so that
+   PCApply() only needs products with the matrix and vector updates, no inner products or norms.
+*/
+
+#include <petsc/private/pcimpl.h>   /*I "petscpc.h" I*/
+
+const char *const PCPolyTypes[] = {"GMRES","CHEBYSHEV","NEUMANN","PCPolyType","PC_POLY_",0};
+
+typedef struct {
+  PCPolyType  type;
+  PetscInt    degree;          /* degree of the polynomial, that is the number of products with the matrix per application */
+  PetscBool   jacobi;          /* the polynomial is in D^{-1} A instead of A */
+  PetscInt    eststeps;        /* number of power iterations used to estimate the largest eigenvalue (Chebyshev and Neumann) */
+  PetscReal   ratio;           /* emax/emin for the Chebyshev polynomial */
+  PetscReal   emin,emax;       /* bounds of the spectrum targeted by the Chebyshev polynomial; 1/emax is the Neumann damping */
+  Vec         dinv;            /* inverse of the diagonal of the matrix if jacobi */
+  Vec         *work;           /* for GMRES the degree+1 vectors of the basis and one work vector, else three work vectors */
+  PetscInt    nwork;
+  PetscInt    m;               /* for GMRES the number of Arnoldi steps actually taken, at most degree+1 */
+  PetscReal   beta;            /* for GMRES the norm of the starting vector of the Arnoldi process */
+  PetscScalar *H,*y;           /* for GMRES the Hessenberg matrix (column major with leading dimension degree+2) and the coefficients of the minimal residual polynomial in the Arnoldi basis */
+  PetscScalar *h;              /* for GMRES work space of PCApply() for one column of H */
+} PC_Poly;
+
+/* same hash as used by KSPCHEBYSHEV for its noisy right hand side, so the polynomial does not depend on the number of processes */
+PETSC_STATIC_INLINE PetscScalar polyhash(PetscInt xx)
+{
+  unsigned int x = xx;
+  x = ((x >> 16) ^ x) * 0x45d9f3b;
+  x = ((x >> 16) ^ x) * 0x45d9f3b;
+  x = ((x >> 16) ^ x);
+  return (PetscScalar)((PetscInt64)x-2147483648)*5.e-10;
+}
+
+static PetscErrorCode PCPolySetNoisy_Private(Vec v)
+{
+  PetscErrorCode ierr;
+  PetscInt       i,n,rstart;
+  PetscScalar    *a;
+
+  PetscFunctionBegin;
+  ierr = VecGetOwnershipRange(v,&rstart,NULL);CHKERRQ(ierr);
+  ierr = VecGetLocalSize(v,&n);CHKERRQ(ierr);
+  ierr = VecGetArray(v,&a);CHKERRQ(ierr);
+  for (i=0; i<n; i++) a[i] = polyhash(rstart+i);
+  ierr = VecRestoreArray(v,&a);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* y = D^{-1} A x, or y = A x without Jacobi scaling */
+static PetscErrorCode PCPolyMult_Private(PC pc,Vec x,Vec y)
+{
+  PC_Poly        *poly = (PC_Poly*)pc->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatMult(pc->pmat,x,y);CHKERRQ(ierr);
+  if (poly->dinv) {ierr = VecPointwiseMult(y,y,poly->dinv);CHKERRQ(ierr);}
+  PetscFunctionReturn(0);
+}
+
+/*
+   Runs the Arnoldi process from a fixed vector and stores the Hessenberg matrix and the solution of the GMRES least
+   squares problem; the vectors of the Arnoldi basis are the q_j(A) v_1 for polynomials q_j defined by the Hessenberg
+   matrix, so the GMRES polynomial can be applied to any vector by repeating the recurrence without the inner products.
+*/
+static PetscErrorCode PCSetUp_Poly_GMRES(PC pc)
+{
+  PC_Poly        *poly = (PC_Poly*)pc->data;
+  PetscErrorCode ierr;
+  PetscInt       i,j,k,m = poly->degree+1,ldh = poly->degree+2;
+  PetscScalar    *R,*g,*cs,*sn,tmp;
+  PetscReal      hnorm,nrm,a;
+  Vec            *v = poly->work,t = poly->work[poly->degree+1];
+
+  PetscFunctionBegin;
+  ierr = PetscMemzero(poly->H,ldh*m*sizeof(PetscScalar));CHKERRQ(ierr);
+  ierr = PCPolySetNoisy_Private(v[0]);CHKERRQ(ierr);
+  ierr = VecNormalize(v[0],&poly->beta);CHKERRQ(ierr);
+  for (j=0; j<m; j++) {
+    ierr = PCPolyMult_Private(pc,v[j],t);CHKERRQ(ierr);
+    /* classical Gram-Schmidt with one reorthogonalization */
+    for (k=0; k<2; k++) {
+      ierr = VecMDot(t,j+1,v,poly->y);CHKERRQ(ierr);
+      for (i=0; i<=j; i++) {
+        poly->H[i+j*ldh] += poly->y[i];
+        poly->y[i]        = -poly->y[i];
+      }
+      ierr = VecMAXPY(t,j+1,poly->y,v);CHKERRQ(ierr);
+    }
+    ierr = VecNorm(t,NORM_2,&hnorm);CHKERRQ(ierr);
+    poly->H[j+1+j*ldh] = hnorm;
+    if (hnorm == 0.0) { /* happy breakdown, the polynomial of degree j is exact */
+      m = j+1;
+      break;
+    }
+    if (j < m-1) {ierr = VecAXPBY(v[j+1],1.0/hnorm,0.0,t);CHKERRQ(ierr);}
+  }
+  poly->m = m;
+
+  /* min || beta e_1 - H y || with Givens rotations on a copy of H */
+  ierr = PetscMalloc4(ldh*m,&R,m+1,&g,m,&cs,m,&sn);CHKERRQ(ierr);
+  ierr = PetscMemcpy(R,poly->H,ldh*m*sizeof(PetscScalar));CHKERRQ(ierr);
+  ierr = PetscMemzero(g,(m+1)*sizeof(PetscScalar));CHKERRQ(ierr);
+  g[0] = poly->beta;
+  for (j=0; j<m; j++) {
+    for (i=0; i<j; i++) {
+      tmp             = cs[i]*R[i+j*ldh] + sn[i]*R[i+1+j*ldh];
+      R[i+1+j*ldh]    = -PetscConj(sn[i])*R[i+j*ldh] + cs[i]*R[i+1+j*ldh];
+      R[i+j*ldh]      = tmp;
+    }
+    a   = PetscAbsScalar(R[j+j*ldh]);
+    nrm = PetscSqrtReal(a*a + PetscRealPart(PetscConj(R[j+1+j*ldh])*R[j+1+j*ldh]));
+    if (a == 0.0) {
+      cs[j] = 0.0;
+      sn[j] = 1.0;
+    } else {
+      cs[j] = a/nrm;
+      sn[j] = (R[j+j*ldh]/a)*PetscConj(R[j+1+j*ldh])/nrm;
+    }
+    R[j+j*ldh]   = cs[j]*R[j+j*ldh] + sn[j]*R[j+1+j*ldh];
+    R[j+1+j*ldh] = 0.0;
+    tmp          = cs[j]*g[j];
+    g[j+1]       = -PetscConj(sn[j])*g[j];
+    g[j]         = tmp;
+  }
+  for (j=m-1; j>=0; j--) {
+    if (R[j+j*ldh] == 0.0) SETERRQ1(PetscObjectComm((PetscObject)pc),PETSC_ERR_CONV_FAILED,"Singular Hessenberg matrix in column %D while computing the GMRES polynomial",j);
+    tmp = g[j];
+    for (k=j+1; k<m; k++) tmp -= R[j+k*ldh]*poly->y[k];
+    poly->y[j] = tmp/R[j+j*ldh];
+  }
+  ierr = PetscInfo3(pc,"GMRES polynomial of degree %D, residual norm of the starting vector reduced from %g to %g\n",m-1,(double)poly->beta,(double)PetscAbsScalar(g[m]));CHKERRQ(ierr);
+  ierr = PetscFree4(R,g,cs,sn);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* estimates the largest eigenvalue with a few steps of the power iteration */
+static PetscErrorCode PCSetUp_Poly_EstEig(PC pc)
+{
+  PC_Poly        *poly = (PC_Poly*)pc->data;
+  PetscErrorCode ierr;
+  PetscInt       i;
+  PetscReal      norm = 0.0;
+  Vec            v = poly->work[0],w = poly->work[1];
+
+  PetscFunctionBegin;
+  ierr = PCPolySetNoisy_Private(v);CHKERRQ(ierr);
+  ierr = VecNormalize(v,NULL);CHKERRQ(ierr);
+  for (i=0; i<poly->eststeps; i++) {
+    ierr = PCPolyMult_Private(pc,v,w);CHKERRQ(ierr);
+    ierr = VecNorm(w,NORM_2,&norm);CHKERRQ(ierr);
+    if (norm == 0.0) SETERRQ(PetscObjectComm((PetscObject)pc),PETSC_ERR_CONV_FAILED,"Power iteration found a zero product with the matrix, cannot estimate the largest eigenvalue");
+    ierr = VecAXPBY(v,1.0/norm,0.0,w);CHKERRQ(ierr);
+  }
+  /* the power iteration underestimates the largest eigenvalue */
+  poly->emax = 1.1*norm;
+  poly->emin = poly->emax/poly->ratio;
+  ierr = PetscInfo4(pc,"Largest eigenvalue estimate %g after %D power iterations, using [%g, %g]\n",(double)norm,poly->eststeps,(double)poly->emin,(double)poly->emax);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PCSetUp_Poly(PC pc)
+{
+  PC_Poly        *poly = (PC_Poly*)pc->data;
+  PetscErrorCode ierr;
+  PetscInt       nwork;
+
+  PetscFunctionBegin;
+  nwork = poly->type == PC_POLY_GMRES ? poly->degree+2 : 3;
+  if (poly->nwork != nwork) {
+    if (poly->nwork) {ierr = VecDestroyVecs(poly->nwork,&poly->work);CHKERRQ(ierr);}
+    poly->nwork = 0;
+  }
+  if (!poly->nwork) {
+    Vec v;
+
+    ierr = MatCreateVecs(pc->pmat,&v,NULL);CHKERRQ(ierr);
+    ierr = VecDuplicateVecs(v,nwork,&poly->work);CHKERRQ(ierr);
+    ierr = PetscLogObjectParents(pc,nwork,poly->work);CHKERRQ(ierr);
+    ierr = VecDestroy(&v);CHKERRQ(ierr);
+    poly->nwork = nwork;
+  }
+  if (poly->type == PC_POLY_GMRES && !poly->H) {
+    ierr = PetscMalloc3((poly->degree+2)*(poly->degree+1),&poly->H,poly->degree+1,&poly->y,poly->degree+1,&poly->h);CHKERRQ(ierr);
+  }
+  if (poly->jacobi) {
+    PetscInt    i,n;
+    PetscScalar *d;
+    PetscBool   zeroflag = PETSC_FALSE;
+
+    if (!poly->dinv) {
+      ierr = MatCreateVecs(pc->pmat,&poly->dinv,NULL);CHKERRQ(ierr);
+      ierr = PetscLogObjectParent((PetscObject)pc,(PetscObject)poly->dinv);CHKERRQ(ierr);
+    }
+    ierr = MatGetDiagonal(pc->pmat,poly->dinv);CHKERRQ(ierr);
+    ierr = VecGetLocalSize(poly->dinv,&n);CHKERRQ(ierr);
+    ierr = VecGetArray(poly->dinv,&d);CHKERRQ(ierr);
+    for (i=0; i<n; i++) {
+      if (d[i] == 0.0) {
+        d[i]     = 1.0;
+        zeroflag = PETSC_TRUE;
+      } else d[i] = 1.0/d[i];
+    }
+    ierr = VecRestoreArray(poly->dinv,&d);CHKERRQ(ierr);
+    if (zeroflag) {
+      ierr = PetscInfo(pc,"Zero detected in diagonal of matrix, using 1 at those locations\n");CHKERRQ(ierr);
+    }
+  } else {
+    ierr = VecDestroy(&poly->dinv);CHKERRQ(ierr);
+  }
+  if (poly->type == PC_POLY_GMRES) {
+    ierr = PCSetUp_Poly_GMRES(pc);CHKERRQ(ierr);
+  } else {
+    ierr = PCSetUp_Poly_EstEig(pc);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+/*
+   x = p(A) b with p the GMRES polynomial: w_1 = b/beta, w_{j+1} = (A w_j - sum_{i<=j} h_ij w_i)/h_{j+1,j} and x = sum_j y_j w_j
+*/
+static PetscErrorCode PCApply_Poly_GMRES(PC pc,Vec b,Vec x)
+{
+  PC_Poly        *poly = (PC_Poly*)pc->data;
+  PetscErrorCode ierr;
+  PetscInt       i,j,m = poly->m,ldh = poly->degree+2;
+  PetscScalar    *h = poly->h;
+  Vec            *w = poly->work,t = poly->work[poly->degree+1];
+
+  PetscFunctionBegin;
+  if (poly->dinv) {
+    ierr = VecPointwiseMult(w[0],b,poly->dinv);CHKERRQ(ierr);
+    ierr = VecScale(w[0],1.0/poly->beta);CHKERRQ(ierr);
+  } else {
+    ierr = VecAXPBY(w[0],1.0/poly->beta,0.0,b);CHKERRQ(ierr);
+  }
+  for (j=0; j<m-1; j++) {
+    ierr = PCPolyMult_Private(pc,w[j],t);CHKERRQ(ierr);
+    for (i=0; i<=j; i++) h[i] = -poly->H[i+j*ldh];
+    ierr = VecMAXPY(t,j+1,h,w);CHKERRQ(ierr);
+    ierr = VecAXPBY(w[j+1],1.0/poly->H[j+1+j*ldh],0.0,t);CHKERRQ(ierr);
+  }
+  ierr = VecSet(x,0.0);CHKERRQ(ierr);
+  ierr = VecMAXPY(x,m,poly->y,w);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*
+   x = p(A) b with p the Chebyshev polynomial for [emin,emax], the three term recurrence of the Chebyshev iteration
+   for A x = b started from zero, with the residual, direction and solution updates fused in one loop after each MatMult()
+*/
+static PetscErrorCode PCApply_Poly_Chebyshev(PC pc,Vec b,Vec x)
+{
+  PC_Poly           *poly = (PC_Poly*)pc->data;
+  PetscErrorCode    ierr;
+  PetscInt          i,k,n;
+  PetscReal         theta = 0.5*(poly->emax+poly->emin),delta = 0.5*(poly->emax-poly->emin),sigma = theta/delta,rho = 1.0/sigma,rhonew;
+  PetscScalar       *r,*d,*xx,alpha,beta;
+  const PetscScalar *t,*dinv = NULL;
+  Vec               R = poly->work[0],D = poly->work[1],T = poly->work[2];
+
+  PetscFunctionBegin;
+  if (poly->dinv) {
+    ierr = VecPointwiseMult(R,b,poly->dinv);CHKERRQ(ierr);
+  } else {
+    ierr = VecCopy(b,R);CHKERRQ(ierr);
+  }
+  ierr = VecAXPBY(D,1.0/theta,0.0,R);CHKERRQ(ierr);
+  ierr = VecCopy(D,x);CHKERRQ(ierr);
+  ierr = VecGetLocalSize(x,&n);CHKERRQ(ierr);
+  for (k=0; k<poly->degree; k++) {
+    ierr   = MatMult(pc->pmat,D,T);CHKERRQ(ierr);
+    rhonew = 1.0/(2.0*sigma - rho);
+    alpha  = rhonew*rho;
+    beta   = 2.0*rhonew/delta;
+    rho    = rhonew;
+    ierr = VecGetArray(R,&r);CHKERRQ(ierr);
+    ierr = VecGetArray(D,&d);CHKERRQ(ierr);
+    ierr = VecGetArray(x,&xx);CHKERRQ(ierr);
+    ierr = VecGetArrayRead(T,&t);CHKERRQ(ierr);
+    if (poly->dinv) {
+      ierr = VecGetArrayRead(poly->dinv,&dinv);CHKERRQ(ierr);
+      for (i=0; i<n; i++) {
+        r[i] -= dinv[i]*t[i];
+        d[i]  = alpha*d[i] + beta*r[i];
+        xx[i] += d[i];
+      }
+      ierr = VecRestoreArrayRead(poly->dinv,&dinv);CHKERRQ(ierr);
+    } else {
+      for (i=0; i<n; i++) {
+        r[i] -= t[i];
+        d[i]  = alpha*d[i] + beta*r[i];
+        xx[i] += d[i];
+      }
+    }
+    ierr = VecRestoreArrayRead(T,&t);CHKERRQ(ierr);
+    ierr = VecRestoreArray(x,&xx);CHKERRQ(ierr);
+    ierr = VecRestoreArray(D,&d);CHKERRQ(ierr);
+    ierr = VecRestoreArray(R,&r);CHKERRQ(ierr);
+    ierr = PetscLogFlops((poly->dinv ? 6.0 : 5.0)*n);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+/*
+   x = omega sum_{k=0}^{degree} (I - omega A)^k b with omega = 1/emax, that is degree+1 steps of damped Richardson
+   started from zero, with the residual and solution updates fused in one loop after each MatMult()
+*/
+static PetscErrorCode PCApply_Poly_Neumann(PC pc,Vec b,Vec x)
+{
+  PC_Poly           *poly = (PC_Poly*)pc->data;
+  PetscErrorCode    ierr;
+  PetscInt          i,k,n;
+  PetscReal         omega = 1.0/poly->emax;
+  PetscScalar       *r,*xx;
+  const PetscScalar *t,*dinv = NULL;
+  Vec               R = poly->work[0],T = poly->work[2];
+
+  PetscFunctionBegin;
+  if (poly->dinv) {
+    ierr = VecPointwiseMult(R,b,poly->dinv);CHKERRQ(ierr);
+  } else {
+    ierr = VecCopy(b,R);CHKERRQ(ierr);
+  }
+  ierr = VecAXPBY(x,omega,0.0,R);CHKERRQ(ierr);
+  ierr = VecGetLocalSize(x,&n);CHKERRQ(ierr);
+  for (k=0; k<poly->degree; k++) {
+    ierr = MatMult(pc->pmat,R,T);CHKERRQ(ierr);
+    ierr = VecGetArray(R,&r);CHKERRQ(ierr);
+    ierr = VecGetArray(x,&xx);CHKERRQ(ierr);
+    ierr = VecGetArrayRead(T,&t);CHKERRQ(ierr);
+    if (poly->dinv) {
+      ierr = VecGetArrayRead(poly->dinv,&dinv);CHKERRQ(ierr);
+      for (i=0; i<n; i++) {
+        r[i]  -= omega*dinv[i]*t[i];
+        xx[i] += omega*r[i];
+      }
+      ierr = VecRestoreArrayRead(poly->dinv,&dinv);CHKERRQ(ierr);
+    } else {
+      for (i=0; i<n; i++) {
+        r[i]  -= omega*t[i];
+        xx[i] += omega*r[i];
+      }
+    }
+    ierr = VecRestoreArrayRead(T,&t);CHKERRQ(ierr);
+    ierr = VecRestoreArray(x,&xx);CHKERRQ(ierr);
+    ierr = VecRestoreArray(R,&r);CHKERRQ(ierr);
+    ierr = PetscLogFlops((poly->dinv ? 5.0 : 4.0)*n);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PCApply_Poly(PC pc,Vec b,Vec x)
+{
+  PC_Poly        *poly = (PC_Poly*)pc->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  switch (poly->type) {
+  case PC_POLY_GMRES:
+    ierr = PCApply_Poly_GMRES(pc,b,x);CHKERRQ(ierr);
+    break;
+  case PC_POLY_CHEBYSHEV:
+    ierr = PCApply_Poly_Chebyshev(pc,b,x);CHKERRQ(ierr);
+    break;
+  case PC_POLY_NEUMANN:
+    ierr = PCApply_Poly_Neumann(pc,b,x);CHKERRQ(ierr);
+    break;
+  }
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PCReset_Poly(PC pc)
+{
+  PC_Poly        *poly = (PC_Poly*)pc->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (poly->nwork) {ierr = VecDestroyVecs(poly->nwork,&poly->work);CHKERRQ(ierr);}
+  poly->nwork = 0;
+  ierr = VecDestroy(&poly->dinv);CHKERRQ(ierr);
+  ierr = PetscFree3(poly->H,poly->y,poly->h);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PCDestroy_Poly(PC pc)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PCReset_Poly(pc);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)pc,"PCPolySetType_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)pc,"PCPolyGetType_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)pc,"PCPolySetDegree_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)pc,"PCPolyGetDegree_C",NULL);CHKERRQ(ierr);
+  ierr = PetscFree(pc->data);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PCSetFromOptions_Poly(PetscOptionItems *PetscOptionsObject,PC pc)
+{
+  PC_Poly        *poly = (PC_Poly*)pc->data;
+  PetscErrorCode ierr;
+  PetscBool      flg;
+  PCPolyType     type;
+  PetscInt       degree;
+
+  PetscFunctionBegin;
+  ierr = PetscOptionsHead(PetscOptionsObject,"Polynomial preconditioner options");CHKERRQ(ierr);
+  ierr = PetscOptionsEnum("-pc_poly_type","Polynomial","PCPolySetType",PCPolyTypes,(PetscEnum)poly->type,(PetscEnum*)&type,&flg);CHKERRQ(ierr);
+  if (flg) {ierr = PCPolySetType(pc,type);CHKERRQ(ierr);}
+  ierr = PetscOptionsInt("-pc_poly_degree","Degree of the polynomial","PCPolySetDegree",poly->degree,&degree,&flg);CHKERRQ(ierr);
+  if (flg) {ierr = PCPolySetDegree(pc,degree);CHKERRQ(ierr);}
+  ierr = PetscOptionsBool("-pc_poly_jacobi","Use a polynomial in the Jacobi preconditioned matrix","None",poly->jacobi,&poly->jacobi,NULL);CHKERRQ(ierr);
+  if (poly->type != PC_POLY_GMRES) {
+    ierr = PetscOptionsInt("-pc_poly_esteig_steps","Number of power iterations used to estimate the largest eigenvalue","None",poly->eststeps,&poly->eststeps,NULL);CHKERRQ(ierr);
+    if (poly->eststeps < 1) SETERRQ1(PetscObjectComm((PetscObject)pc),PETSC_ERR_ARG_OUTOFRANGE,"Number of power iterations %D must be positive",poly->eststeps);
+  }
+  if (poly->type == PC_POLY_CHEBYSHEV) {
+    ierr = PetscOptionsReal("-pc_poly_chebyshev_ratio","Ratio of the largest and smallest eigenvalues targeted by the Chebyshev polynomial","None",poly->ratio,&poly->ratio,NULL);CHKERRQ(ierr);
+    if (poly->ratio <= 1.0) SETERRQ1(PetscObjectComm((PetscObject)pc),PETSC_ERR_ARG_OUTOFRANGE,"Eigenvalue ratio %g must be larger than 1",(double)poly->ratio);
+  }
+  ierr = PetscOptionsTail();CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PCView_Poly(PC pc,PetscViewer viewer)
+{
+  PC_Poly        *poly = (PC_Poly*)pc->data;
+  PetscErrorCode ierr;
+  PetscBool      iascii;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectTypeCompare((PetscObject)viewer,PETSCVIEWERASCII,&iascii);CHKERRQ(ierr);
+  if (iascii) {
+    ierr = PetscViewerASCIIPrintf(viewer,"  %s polynomial of degree %D in %s\n",PCPolyTypes[poly->type],poly->type == PC_POLY_GMRES && pc->setupcalled ? poly->m-1 : poly->degree,poly->jacobi ? "the Jacobi preconditioned matrix" : "the matrix");CHKERRQ(ierr);
+    if (poly->type == PC_POLY_CHEBYSHEV) {
+      ierr = PetscViewerASCIIPrintf(viewer,"  eigenvalue bounds [%g, %g] from %D power iterations\n",(double)poly->emin,(double)poly->emax,poly->eststeps);CHKERRQ(ierr);
+    } else if (poly->type == PC_POLY_NEUMANN) {
+      ierr = PetscViewerASCIIPrintf(viewer,"  damping %g from %D power iterations\n",(double)(poly->emax > 0.0 ? 1.0/poly->emax : 0.0),poly->eststeps);CHKERRQ(ierr);
+    }
+  }
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PCPolySetType_Poly(PC pc,PCPolyType type)
+{
+  PC_Poly *poly = (PC_Poly*)pc->data;
+
+  PetscFunctionBegin;
+  if (type != poly->type) pc->setupcalled = 0;
+  poly->type = type;
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PCPolyGetType_Poly(PC pc,PCPolyType *type)
+{
+  PC_Poly *poly = (PC_Poly*)pc->data;
+
+  PetscFunctionBegin;
+  *type = poly->type;
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PCPolySetDegree_Poly(PC pc,PetscInt degree)
+{
+  PC_Poly        *poly = (PC_Poly*)pc->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (degree < 0) SETERRQ1(PetscObjectComm((PetscObject)pc),PETSC_ERR_ARG_OUTOFRANGE,"Degree %D must be nonnegative",degree);
+  if (degree != poly->degree) {
+    ierr = PCReset_Poly(pc);CHKERRQ(ierr);
+    pc->setupcalled = 0;
+  }
+  poly->degree = degree;
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PCPolyGetDegree_Poly(PC pc,PetscInt *degree)
+{
+  PC_Poly *poly = (PC_Poly*)pc->data;
+
+  PetscFunctionBegin;
+  *degree = poly->degree;
+  PetscFunctionReturn(0);
+}
+
+/*@
+   PCPolySetType - Sets the kind of polynomial used by the PCPOLY preconditioner
+
+   Logically Collective on PC
+
+   Input Parameters:
++  pc - the preconditioner context
+-  type - PC_POLY_GMRES, PC_POLY_CHEBYSHEV or PC_POLY_NEUMANN
+
+   Options Database Key:
+.  -pc_poly_type <gmres,chebyshev,neumann>
+
+   Level: intermediate
+
+.seealso: PCPOLY, PCPolyGetType(), PCPolySetDegree()
+@*/
+PetscErrorCode PCPolySetType(PC pc,PCPolyType type)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(pc,PC_CLASSID,1);
+  PetscValidLogicalCollectiveEnum(pc,type,2);
+  ierr = PetscTryMethod(pc,"PCPolySetType_C",(PC,PCPolyType),(pc,type));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*@
+   PCPolyGetType - Gets the kind of polynomial used by the PCPOLY preconditioner
+
+   Not Collective
+
+   Input Parameter:
+.  pc - the preconditioner context
+
+   Output Parameter:
+.  type - PC_POLY_GMRES, PC_POLY_CHEBYSHEV or PC_POLY_NEUMANN
+
+   Level: intermediate
+
+.seealso: PCPOLY, PCPolySetType()
+@*/
+PetscErrorCode PCPolyGetType(PC pc,PCPolyType *type)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(pc,PC_CLASSID,1);
+  PetscValidPointer(type,2);
+  ierr = PetscUseMethod(pc,"PCPolyGetType_C",(PC,PCPolyType*),(pc,type));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*@
+   PCPolySetDegree - Sets the degree of the polynomial used by the PCPOLY preconditioner
+
+   Logically Collective on PC
+
+   Input Parameters:
++  pc - the preconditioner context
+-  degree - the degree, that is the number of products with the matrix in each application of the preconditioner
+
+   Options Database Key:
+.  -pc_poly_degree <degree>
+
+   Level: intermediate
+
+.seealso: PCPOLY, PCPolyGetDegree(), PCPolySetType()
+@*/
+PetscErrorCode PCPolySetDegree(PC pc,PetscInt degree)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(pc,PC_CLASSID,1);
+  PetscValidLogicalCollectiveInt(pc,degree,2);
+  ierr = PetscTryMethod(pc,"PCPolySetDegree_C",(PC,PetscInt),(pc,degree));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*@
+   PCPolyGetDegree - Gets the degree of the polynomial used by the PCPOLY preconditioner
+
+   Not Collective
+
+   Input Parameter:
+.  pc - the preconditioner context
+
+   Output Parameter:
+.  degree - the degree
+
+   Level: intermediate
+
+.seealso: PCPOLY, PCPolySetDegree()
+@*/
+PetscErrorCode PCPolyGetDegree(PC pc,PetscInt *degree)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(pc,PC_CLASSID,1);
+  PetscValidIntPointer(degree,2);
+  ierr = PetscUseMethod(pc,"PCPolyGetDegree_C",(PC,PetscInt*),(pc,degree));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*MC
+     PCPOLY - Polynomial preconditioner p(A) with a polynomial p of fixed degree computed when the preconditioner is set up
+
+   Options Database Keys:
++    -pc_poly_type <gmres,chebyshev,neumann> - the polynomial, see below
+.    -pc_poly_degree <degree> - degree of the polynomial, that is the number of products with the matrix per application (default 5)
+.    -pc_poly_jacobi <true,false> - use a polynomial in D^{-1} A instead of A, where D is the diagonal of A (default true)
+.    -pc_poly_esteig_steps <steps> - number of power iterations used to estimate the largest eigenvalue for the Chebyshev and Neumann polynomials (default 10)
+-    -pc_poly_chebyshev_ratio <ratio> - ratio of the largest and smallest eigenvalues targeted by the Chebyshev polynomial (default 30)
+
+   Level: intermediate
+
+   Notes:
+    The application of the preconditioner only needs MatMult() and vector updates, without any inner product or norm,
+    so it needs no global reductions. The setup needs a few.
+
+    The polynomials are
++     gmres - the minimal residual polynomial of GMRES with degree+1 steps from a fixed vector, computed with the Arnoldi
+              process and applied in the Arnoldi basis
+.     chebyshev - the Chebyshev polynomial for the eigenvalue interval [emax/ratio, emax], where emax is a 10% enlargement of a
+              power iteration estimate of the largest eigenvalue, applied with the three term recurrence of the Chebyshev iteration
+-     neumann - the truncated Neumann series omega sum_{k=0}^{degree} (I - omega A)^k with omega = 1/emax
+
+    The Chebyshev and Neumann polynomials assume a spectrum in the right half plane, for example a symmetric positive
+    definite matrix. All three are polynomials in A (in D^{-1} A with -pc_poly_jacobi, applied as p(D^{-1} A) D^{-1}), so
+    for a symmetric matrix the preconditioner is symmetric and can be used with KSPCG. The GMRES polynomial may however
+    be negative on part of the spectrum when its degree is too low to approximate the inverse well, then use a Krylov
+    method that does not need a positive definite preconditioner, such as KSPGMRES.
+
+    The preconditioner can be used as a multigrid smoother with -mg_levels_ksp_type richardson -mg_levels_pc_type poly.
+
+.seealso:  PCCreate(), PCSetType(), PCType (for list of available types), PC, PCPolySetType(), PCPolySetDegree(),
+           PCJACOBI, KSPCHEBYSHEV
+M*/
+
+PETSC_EXTERN PetscErrorCode PCCreate_Poly(PC pc)
+{
+  PC_Poly        *poly;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr     = PetscNewLog(pc,&poly);CHKERRQ(ierr);
+  pc->data = (void*)poly;
+
+  poly->type     = PC_POLY_GMRES;
+  poly->degree   = 5;
+  poly->jacobi   = PETSC_TRUE;
+  poly->eststeps = 10;
+  poly->ratio    = 30.0;
+
+  pc->ops->apply           = PCApply_Poly;
+  pc->ops->setup           = PCSetUp_Poly;
+  pc->ops->reset           = PCReset_Poly;
+  pc->ops->destroy         = PCDestroy_Poly;
+  pc->ops->setfromoptions  = PCSetFromOptions_Poly;
+  pc->ops->view            = PCView_Poly;
+
+  ierr = PetscObjectComposeFunction((PetscObject)pc,"PCPolySetType_C",PCPolySetType_Poly);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)pc,"PCPolyGetType_C",PCPolyGetType_Poly);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)pc,"PCPolySetDegree_C",PCPolySetDegree_Poly);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)pc,"PCPolyGetDegree_C",PCPolyGetDegree_Poly);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
@@ -32,6 +32,7 @@ PETSC_EXTERN PetscErrorCode PCCreate_Kaczmarz(PC);
 PETSC_EXTERN PetscErrorCode PCCreate_Telescope(PC);
 PETSC_EXTERN PetscErrorCode PCCreate_Patch(PC);
 PETSC_EXTERN PetscErrorCode PCCreate_LMVM(PC);
+PETSC_EXTERN PetscErrorCode PCCreate_Poly(PC);
 
 #if defined(PETSC_HAVE_ML)
 PETSC_EXTERN PetscErrorCode PCCreate_ML(PC);
@@ -135,5 +136,6 @@ PetscErrorCode  PCRegisterAll(void)
 #endif
   ierr = PCRegister(PCBDDC         ,PCCreate_BDDC);CHKERRQ(ierr);
   ierr = PCRegister(PCLMVM         ,PCCreate_LMVM);CHKERRQ(ierr);
+  ierr = PCRegister(PCPOLY         ,PCCreate_Poly);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
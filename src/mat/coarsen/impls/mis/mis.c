@@ -28,7 +28,7 @@ PetscErrorCode maxIndSetAgg(IS perm,Mat Gmat,PetscBool strict_aggs,PetscCoarsenD
   Mat_MPIAIJ       *mpimat=NULL;
   MPI_Comm         comm;
   PetscInt         num_fine_ghosts,kk,n,ix,j,*idx,*ii,iter,Iend,my0,nremoved,gid,lid,cpid,lidj,sgid,t1,t2,slid,nDone,nselected=0,state,statej;
-  PetscInt         *cpcol_gid,*cpcol_state,*lid_cprowID,*lid_gid,*cpcol_sel_gid,*icpcol_gid,*lid_state,*lid_parent_gid=NULL;
+  PetscInt         *cpcol_gid,*cpcol_state,*lid_cprowID,*cpcol_sel_gid,*icpcol_gid,*lid_state,*lid_parent_gid=NULL;
   PetscBool        *lid_removed;
   PetscBool        isMPI,isAIJ,isOK;
   const PetscInt   *perm_ix;
@@ -54,21 +54,17 @@ PetscErrorCode maxIndSetAgg(IS perm,Mat Gmat,PetscBool strict_aggs,PetscCoarsenD
     matA = (Mat_SeqAIJ*)Gmat->data;
   }
   ierr = MatGetOwnershipRange(Gmat,&my0,&Iend);CHKERRQ(ierr);
-  ierr = PetscMalloc1(nloc,&lid_gid);CHKERRQ(ierr); /* explicit array needed */
   if (mpimat) {
-    for (kk=0,gid=my0; kk<nloc; kk++,gid++) {
-      lid_gid[kk] = gid;
-    }
     ierr = VecGetLocalSize(mpimat->lvec, &num_fine_ghosts);CHKERRQ(ierr);
     ierr = PetscMalloc1(num_fine_ghosts,&cpcol_gid);CHKERRQ(ierr);
     ierr = PetscMalloc1(num_fine_ghosts,&cpcol_state);CHKERRQ(ierr);
     ierr = PetscSFCreate(PetscObjectComm((PetscObject)Gmat),&sf);CHKERRQ(ierr);
     ierr = MatGetLayouts(Gmat,&layout,NULL);CHKERRQ(ierr);
     ierr = PetscSFSetGraphLayout(sf,layout,num_fine_ghosts,NULL,PETSC_COPY_VALUES,mpimat->garray);CHKERRQ(ierr);
-    ierr = PetscSFBcastBegin(sf,MPIU_INT,lid_gid,cpcol_gid);CHKERRQ(ierr);
-    ierr = PetscSFBcastEnd(sf,MPIU_INT,lid_gid,cpcol_gid);CHKERRQ(ierr);
+    /* the global indices of the ghosts are the roots of the leaves, no need to communicate them */
     for (kk=0;kk<num_fine_ghosts;kk++) {
-      cpcol_state[kk]=MIS_NOT_DONE;
+      cpcol_gid[kk]   = mpimat->garray[kk];
+      cpcol_state[kk] = MIS_NOT_DONE;
     }
   } else num_fine_ghosts = 0;
 
@@ -246,7 +242,6 @@ PetscErrorCode maxIndSetAgg(IS perm,Mat Gmat,PetscBool strict_aggs,PetscCoarsenD
     ierr = PetscFree(cpcol_state);CHKERRQ(ierr);
   }
   ierr = PetscFree(lid_cprowID);CHKERRQ(ierr);
-  ierr = PetscFree(lid_gid);CHKERRQ(ierr);
   ierr = PetscFree(lid_removed);CHKERRQ(ierr);
   if (strict_aggs) {
     ierr = PetscFree(lid_parent_gid);CHKERRQ(ierr);
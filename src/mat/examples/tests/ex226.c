@@ -1,18 +1,55 @@
-static char help[] = "Benchmark for MatMatMult() of AIJ matrices using different 2d finite-difference stencils.\n\n";
+static char help[] = "Benchmark for MatMatMult() of AIJ matrices using different 2d finite-difference stencils.\n\
+With -compare_via <via1,via2,...> it times the symbolic and numeric MatMatMult() of each -matmatmult_via variant on the\n\
+same matrices (default sorted,scalable,heap,btheap,hash) and checks that the products are equal.\n\n";
  
 #include <petscmat.h>
+#include <petsctime.h>
 
 /* Converts 3d grid coordinates (i,j,k) for a grid of size m \times n to global indexing. Pass k = 0 for a 2d grid. */
 int global_index(PetscInt i,PetscInt j,PetscInt k, PetscInt m, PetscInt n) { return i + j * m + k * m * n; }
 
+/* Times MatMatMultSymbolic() and MatMatMultNumeric() of A*B with each -matmatmult_via variant, comparing the products with the first one */
+static PetscErrorCode CompareMatMatMultVia(Mat A,Mat B,PetscInt nvia,char **via)
+{
+  Mat            C,Cref = NULL;
+  PetscInt       i;
+  PetscLogDouble t0,t1,t2;
+  PetscBool      equal;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"MatMatMult via   symbolic (s)   numeric (s)\n");CHKERRQ(ierr);
+  for (i=0; i<nvia; i++) {
+    ierr = PetscOptionsSetValue(NULL,"-matmatmult_via",via[i]);CHKERRQ(ierr);
+    ierr = MPI_Barrier(PETSC_COMM_WORLD);CHKERRQ(ierr);
+    ierr = PetscTime(&t0);CHKERRQ(ierr);
+    ierr = MatMatMultSymbolic(A,B,PETSC_DEFAULT,&C);CHKERRQ(ierr);
+    ierr = PetscTime(&t1);CHKERRQ(ierr);
+    ierr = MatMatMultNumeric(A,B,C);CHKERRQ(ierr);
+    ierr = PetscTime(&t2);CHKERRQ(ierr);
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"%-16s %-14.4e %.4e\n",via[i],t1-t0,t2-t1);CHKERRQ(ierr);
+    if (!Cref) {
+      Cref = C;
+    } else {
+      ierr = MatEqual(Cref,C,&equal);CHKERRQ(ierr);
+      if (!equal) {ierr = PetscPrintf(PETSC_COMM_WORLD,"  the product differs from the one computed via %s\n",via[0]);CHKERRQ(ierr);}
+      ierr = MatDestroy(&C);CHKERRQ(ierr);
+    }
+  }
+  ierr = PetscOptionsClearValue(NULL,"-matmatmult_via");CHKERRQ(ierr);
+  ierr = MatDestroy(&Cref);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 int main(int argc,char **argv)
 {
   Mat            A,B,C,PtAP,PtAP_copy,PtAP_squared;
   PetscInt       i,M,N,Istart,Iend,n=7,j,J,Ii,m=8,k,o=1;
   PetscScalar    v;
   PetscErrorCode ierr;
-  PetscBool      equal=PETSC_FALSE,mat_view=PETSC_FALSE;
-  char           stencil[PETSC_MAX_PATH_LEN];
+  PetscBool      equal=PETSC_FALSE,mat_view=PETSC_FALSE,compare=PETSC_FALSE;
+  char           stencil[PETSC_MAX_PATH_LEN],*via[16];
+  PetscInt       nvia=16;
 #if defined(PETSC_USE_LOG)
   PetscLogStage  fullMatMatMultStage;
 #endif
@@ -23,6 +60,13 @@ int main(int argc,char **argv)
   ierr = PetscOptionsGetInt(NULL,NULL,"-o",&o,NULL);CHKERRQ(ierr);
   ierr = PetscOptionsHasName(NULL,NULL,"-result_view",&mat_view);CHKERRQ(ierr);
   ierr = PetscOptionsGetString(NULL,NULL,"-stencil",stencil,PETSC_MAX_PATH_LEN,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsHasName(NULL,NULL,"-compare_via",&compare);CHKERRQ(ierr);
+  ierr = PetscOptionsGetStringArray(NULL,NULL,"-compare_via",via,&nvia,NULL);CHKERRQ(ierr);
+  if (compare && !nvia) {
+    const char *defvia[] = {"sorted","scalable","heap","btheap","hash"};
+
+    for (nvia=0; nvia<5; nvia++) {ierr = PetscStrallocpy(defvia[nvia],&via[nvia]);CHKERRQ(ierr);}
+  }
 
   /* Create a aij matrix A */
   M    = N = m*n*o;
@@ -243,6 +287,15 @@ int main(int argc,char **argv)
   /* Copy A into B in order to have a more representative benchmark (A*A has more cache hits than A*B) */
   ierr = MatDuplicate(A,MAT_COPY_VALUES,&B);CHKERRQ(ierr);
 
+  if (compare) {
+    ierr = CompareMatMatMultVia(A,B,nvia,via);CHKERRQ(ierr);
+    for (i=0; i<nvia; i++) {ierr = PetscFree(via[i]);CHKERRQ(ierr);}
+    ierr = MatDestroy(&B);CHKERRQ(ierr);
+    ierr = MatDestroy(&A);CHKERRQ(ierr);
+    ierr = PetscFinalize();
+    return ierr;
+  }
+
   ierr = PetscLogStageRegister("Full MatMatMult",&fullMatMatMultStage);CHKERRQ(ierr);
 
   /* Test C = A*B */
@@ -286,6 +339,24 @@ int main(int argc,char **argv)
       nsize: 4
       args: -m 6 -n 6 -stencil 2d5point -matmatmult_via seqmpi
 
+ test:
+      suffix: hash
+      nsize: 1
+      args: -m 8 -n 8 -stencil 2d5point -matmatmult_via hash
+      output_file: output/ex226_1.out
+
+ test:
+      suffix: hash_3d
+      nsize: 1
+      args: -m 5 -n 5 -o 5 -stencil 3d27point -matmatmult_via hash
+      output_file: output/ex226_2.out
+
+ test:
+      suffix: compare_via
+      nsize: 1
+      args: -m 5 -n 5 -o 5 -stencil 3d27point -compare_via
+      filter: sed -e "s~[0-9]\.[0-9]*e[-+][0-9]*~TIME~g"
+
 
 
 TEST*/
@@ -0,0 +1,86 @@
+static char help[] = "Tests assembly of AIJ matrices without preallocation through a hash table.\n\n";
+
+#include <petscmat.h>
+
+/*
+   Adds the 2x2 "element" matrices of a 1d grid of n cells twice, so that rows on process
+   boundaries receive off-process contributions, and compares with a preallocated matrix.
+*/
+static PetscErrorCode AssembleLaplacian(Mat A,PetscInt n)
+{
+  PetscInt       i,e,rstart,rend,idx[2];
+  PetscScalar    v[4] = {1.0,-1.0,-1.0,1.0};
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatGetOwnershipRange(A,&rstart,&rend);CHKERRQ(ierr);
+  for (e=rstart; e<PetscMin(rend,n-1); e++) {
+    idx[0] = e; idx[1] = e+1;
+    for (i=0; i<2; i++) {
+      ierr = MatSetValues(A,2,idx,2,idx,v,ADD_VALUES);CHKERRQ(ierr);
+    }
+  }
+  ierr = MatAssemblyBegin(A,MAT_FLUSH_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FLUSH_ASSEMBLY);CHKERRQ(ierr);
+  /* a long range coupling to exercise the off-diagonal block */
+  if (!rstart && n > 2) {
+    idx[0] = 0; idx[1] = n-1;
+    ierr = MatSetValues(A,1,&idx[0],1,&idx[1],v,ADD_VALUES);CHKERRQ(ierr);
+    ierr = MatSetValues(A,1,&idx[1],1,&idx[0],v,ADD_VALUES);CHKERRQ(ierr);
+  }
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+int main(int argc,char **args)
+{
+  Mat            A,B;
+  MatInfo        info;
+  PetscInt       n = 10;
+  PetscBool      equal;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&args,(char*)0,help);if (ierr) return ierr;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+
+  /* matrix assembled through the hash table */
+  ierr = MatCreate(PETSC_COMM_WORLD,&A);CHKERRQ(ierr);
+  ierr = MatSetSizes(A,PETSC_DECIDE,PETSC_DECIDE,n,n);CHKERRQ(ierr);
+  ierr = MatSetType(A,MATAIJ);CHKERRQ(ierr);
+  ierr = MatSetOption(A,MAT_USE_HASH_TABLE,PETSC_TRUE);CHKERRQ(ierr);
+  ierr = MatSetFromOptions(A);CHKERRQ(ierr);
+  ierr = MatSetUp(A);CHKERRQ(ierr);
+  ierr = MatSetOption(A,MAT_NEW_NONZERO_ALLOCATION_ERR,PETSC_TRUE);CHKERRQ(ierr);
+  ierr = AssembleLaplacian(A,n);CHKERRQ(ierr);
+  ierr = MatGetInfo(A,MAT_GLOBAL_SUM,&info);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"Nonzeros used %g allocated %g mallocs %g\n",info.nz_used,info.nz_allocated,info.mallocs);CHKERRQ(ierr);
+
+  /* the same matrix assembled with exact preallocation */
+  ierr = MatCreateAIJ(PETSC_COMM_WORLD,PETSC_DECIDE,PETSC_DECIDE,n,n,3,NULL,2,NULL,&B);CHKERRQ(ierr);
+  ierr = AssembleLaplacian(B,n);CHKERRQ(ierr);
+  ierr = MatEqual(A,B,&equal);CHKERRQ(ierr);
+  if (!equal) SETERRQ(PETSC_COMM_WORLD,PETSC_ERR_PLIB,"Matrices assembled with and without hash table differ");
+
+  /* a second assembly reuses the storage built from the hash table */
+  ierr = MatZeroEntries(A);CHKERRQ(ierr);
+  ierr = AssembleLaplacian(A,n);CHKERRQ(ierr);
+  ierr = MatEqual(A,B,&equal);CHKERRQ(ierr);
+  if (!equal) SETERRQ(PETSC_COMM_WORLD,PETSC_ERR_PLIB,"Matrices differ after reassembly");
+  ierr = MatView(A,PETSC_VIEWER_STDOUT_WORLD);CHKERRQ(ierr);
+
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = MatDestroy(&B);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
+
+/*TEST
+
+   test:
+
+   test:
+      suffix: 2
+      nsize: 3
+
+TEST*/
@@ -0,0 +1,100 @@
+static char help[] = "Tests MatSetPreallocationCOO() and MatSetValuesCOO().\n\n";
+
+#include <petscmat.h>
+
+/*
+   Each process adds the 2x2 "element" matrices of a strided subset of the cells of a 1d grid, so that most
+   entries belong to rows of other processes and many are repeated; an entry with a negative row is ignored.
+*/
+static PetscErrorCode CreateCOO(MPI_Comm comm,PetscInt n,PetscInt *ncoo,PetscInt **coo_i,PetscInt **coo_j,PetscScalar **coo_v)
+{
+  PetscMPIInt    size,rank;
+  PetscInt       e,k = 0;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MPI_Comm_size(comm,&size);CHKERRQ(ierr);
+  ierr = MPI_Comm_rank(comm,&rank);CHKERRQ(ierr);
+  ierr = PetscMalloc2(4*n+3,coo_i,4*n+3,coo_j);CHKERRQ(ierr);
+  ierr = PetscMalloc1(4*n+3,coo_v);CHKERRQ(ierr);
+  (*coo_i)[k] = -1; (*coo_j)[k] = 0; (*coo_v)[k++] = 100.0;
+  for (e=rank; e<n-1; e+=size) {
+    (*coo_i)[k] = e;   (*coo_j)[k] = e;   (*coo_v)[k++] = 1.0+e;
+    (*coo_i)[k] = e;   (*coo_j)[k] = e+1; (*coo_v)[k++] = -1.0;
+    (*coo_i)[k] = e+1; (*coo_j)[k] = e;   (*coo_v)[k++] = -1.0;
+    (*coo_i)[k] = e+1; (*coo_j)[k] = e+1; (*coo_v)[k++] = 1.0+e;
+  }
+  /* a long range coupling to exercise the off-diagonal block */
+  if (rank == size-1 && n > 2) {
+    (*coo_i)[k] = n-1; (*coo_j)[k] = 0; (*coo_v)[k++] = 2.0;
+    (*coo_i)[k] = 0; (*coo_j)[k] = n-1; (*coo_v)[k++] = 2.0;
+  }
+  *ncoo = k;
+  PetscFunctionReturn(0);
+}
+
+int main(int argc,char **args)
+{
+  Mat            A,B;
+  PetscInt       n = 10,ncoo,k,*coo_i,*coo_j;
+  PetscScalar    *coo_v;
+  PetscBool      equal;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&args,(char*)0,help);if (ierr) return ierr;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+  ierr = CreateCOO(PETSC_COMM_WORLD,n,&ncoo,&coo_i,&coo_j,&coo_v);CHKERRQ(ierr);
+
+  /* the reference matrix assembled with MatSetValues() */
+  ierr = MatCreate(PETSC_COMM_WORLD,&B);CHKERRQ(ierr);
+  ierr = MatSetSizes(B,PETSC_DECIDE,PETSC_DECIDE,n,n);CHKERRQ(ierr);
+  ierr = MatSetType(B,MATAIJ);CHKERRQ(ierr);
+  ierr = MatSetFromOptions(B);CHKERRQ(ierr);
+  ierr = MatSetUp(B);CHKERRQ(ierr);
+  ierr = MatSetOption(B,MAT_NEW_NONZERO_ALLOCATION_ERR,PETSC_FALSE);CHKERRQ(ierr);
+  for (k=0; k<ncoo; k++) {
+    ierr = MatSetValue(B,coo_i[k],coo_j[k],coo_v[k],ADD_VALUES);CHKERRQ(ierr);
+  }
+  ierr = MatAssemblyBegin(B,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(B,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+
+  ierr = MatCreate(PETSC_COMM_WORLD,&A);CHKERRQ(ierr);
+  ierr = MatSetSizes(A,PETSC_DECIDE,PETSC_DECIDE,n,n);CHKERRQ(ierr);
+  ierr = MatSetType(A,MATAIJ);CHKERRQ(ierr);
+  ierr = MatSetFromOptions(A);CHKERRQ(ierr);
+  ierr = MatSetPreallocationCOO(A,ncoo,coo_i,coo_j);CHKERRQ(ierr);
+  ierr = PetscFree2(coo_i,coo_j);CHKERRQ(ierr);
+
+  /* repeated entries are summed, INSERT_VALUES replaces the previous values */
+  ierr = MatSetValuesCOO(A,coo_v,INSERT_VALUES);CHKERRQ(ierr);
+  ierr = MatSetValuesCOO(A,coo_v,INSERT_VALUES);CHKERRQ(ierr);
+  ierr = MatEqual(A,B,&equal);CHKERRQ(ierr);
+  if (!equal) SETERRQ(PETSC_COMM_WORLD,PETSC_ERR_PLIB,"Matrices assembled with MatSetValuesCOO() and MatSetValues() differ");
+
+  ierr = MatSetValuesCOO(A,coo_v,ADD_VALUES);CHKERRQ(ierr);
+  ierr = MatScale(B,2.0);CHKERRQ(ierr);
+  ierr = MatEqual(A,B,&equal);CHKERRQ(ierr);
+  if (!equal) SETERRQ(PETSC_COMM_WORLD,PETSC_ERR_PLIB,"Matrices differ after MatSetValuesCOO() with ADD_VALUES");
+  ierr = MatView(A,PETSC_VIEWER_STDOUT_WORLD);CHKERRQ(ierr);
+
+  ierr = PetscFree(coo_v);CHKERRQ(ierr);
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = MatDestroy(&B);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
+
+/*TEST
+
+   test:
+
+   test:
+      suffix: 2
+      nsize: 3
+
+   test:
+      suffix: baij
+      nsize: 2
+      args: -mat_type baij
+
+TEST*/
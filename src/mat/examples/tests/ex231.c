@@ -0,0 +1,120 @@
+static char help[] = "Tests the MatMult() kernels of SELL matrices against AIJ.\n\n";
+
+#include <petscmat.h>
+
+/* compares two vectors that should agree up to roundoff */
+static PetscErrorCode CheckVec(Vec u,Vec v,const char *op)
+{
+  PetscReal      nrm,err;
+  Vec            w;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = VecDuplicate(u,&w);CHKERRQ(ierr);
+  ierr = VecWAXPY(w,-1.0,u,v);CHKERRQ(ierr);
+  ierr = VecNorm(w,NORM_INFINITY,&err);CHKERRQ(ierr);
+  ierr = VecNorm(u,NORM_INFINITY,&nrm);CHKERRQ(ierr);
+  if (err > 1.e-12*nrm) {ierr = PetscPrintf(PETSC_COMM_WORLD,"%s of SELL and AIJ differ by %g\n",op,(double)err);CHKERRQ(ierr);}
+  ierr = VecDestroy(&w);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+int main(int argc,char **args)
+{
+  Mat            A,S;
+  Vec            x,y,z,xt,yt,zt;
+  PetscInt       m = 37,n = 41,i,k,len,rstart,rend,col;
+  PetscScalar    v;
+  PetscReal      ratio;
+  PetscMPIInt    size;
+  PetscRandom    rnd;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&args,(char*)0,help);if (ierr) return ierr;
+  ierr = MPI_Comm_size(PETSC_COMM_WORLD,&size);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-m",&m,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+
+  /* rows of very different lengths, including empty ones, so that the slices are padded */
+  ierr = MatCreate(PETSC_COMM_WORLD,&A);CHKERRQ(ierr);
+  ierr = MatSetSizes(A,PETSC_DECIDE,PETSC_DECIDE,m,n);CHKERRQ(ierr);
+  ierr = MatSetType(A,MATAIJ);CHKERRQ(ierr);
+  ierr = MatSeqAIJSetPreallocation(A,8,NULL);CHKERRQ(ierr);
+  ierr = MatMPIAIJSetPreallocation(A,8,NULL,8,NULL);CHKERRQ(ierr);
+  ierr = MatGetOwnershipRange(A,&rstart,&rend);CHKERRQ(ierr);
+  for (i=rstart; i<rend; i++) {
+    len = (i*7)%9;
+    for (k=0; k<len; k++) {
+      col  = (3*i+5*k)%n;
+      v    = 1.0/(i+k+1.0)+k;
+      ierr = MatSetValues(A,1,&i,1,&col,&v,INSERT_VALUES);CHKERRQ(ierr);
+    }
+  }
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatConvert(A,MATSELL,MAT_INITIAL_MATRIX,&S);CHKERRQ(ierr);
+  if (size == 1) {
+    ierr = MatSeqSELLGetFillRatio(S,&ratio);CHKERRQ(ierr);
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Fill ratio %g\n",(double)ratio);CHKERRQ(ierr);
+  }
+
+  ierr = PetscRandomCreate(PETSC_COMM_WORLD,&rnd);CHKERRQ(ierr);
+  ierr = PetscRandomSetFromOptions(rnd);CHKERRQ(ierr);
+  ierr = MatCreateVecs(A,&x,&y);CHKERRQ(ierr);
+  ierr = VecDuplicate(y,&z);CHKERRQ(ierr);
+  ierr = VecDuplicate(x,&xt);CHKERRQ(ierr);
+  ierr = VecDuplicate(y,&yt);CHKERRQ(ierr);
+  ierr = VecDuplicate(x,&zt);CHKERRQ(ierr);
+  ierr = VecSetRandom(x,rnd);CHKERRQ(ierr);
+  ierr = VecSetRandom(yt,rnd);CHKERRQ(ierr);
+
+  ierr = MatMult(A,x,y);CHKERRQ(ierr);
+  ierr = MatMult(S,x,z);CHKERRQ(ierr);
+  ierr = CheckVec(y,z,"MatMult()");CHKERRQ(ierr);
+  ierr = MatMultAdd(A,x,y,y);CHKERRQ(ierr);
+  ierr = MatMultAdd(S,x,z,z);CHKERRQ(ierr);
+  ierr = CheckVec(y,z,"MatMultAdd()");CHKERRQ(ierr);
+
+  ierr = MatMultTranspose(A,yt,xt);CHKERRQ(ierr);
+  ierr = MatMultTranspose(S,yt,zt);CHKERRQ(ierr);
+  ierr = CheckVec(xt,zt,"MatMultTranspose()");CHKERRQ(ierr);
+  ierr = MatMultTransposeAdd(A,yt,x,xt);CHKERRQ(ierr);
+  ierr = MatMultTransposeAdd(S,yt,x,zt);CHKERRQ(ierr);
+  ierr = CheckVec(xt,zt,"MatMultTransposeAdd()");CHKERRQ(ierr);
+
+  ierr = PetscRandomDestroy(&rnd);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&y);CHKERRQ(ierr);
+  ierr = VecDestroy(&z);CHKERRQ(ierr);
+  ierr = VecDestroy(&xt);CHKERRQ(ierr);
+  ierr = VecDestroy(&yt);CHKERRQ(ierr);
+  ierr = VecDestroy(&zt);CHKERRQ(ierr);
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = MatDestroy(&S);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
+
+/*TEST
+
+   test:
+      suffix: default
+      args: -mat_sell_kernel default
+      output_file: output/ex231_1.out
+
+   test:
+      suffix: avx2
+      args: -mat_sell_kernel avx2
+      output_file: output/ex231_1.out
+
+   test:
+      suffix: avx512
+      args: -mat_sell_kernel avx512
+      output_file: output/ex231_1.out
+
+   test:
+      suffix: 2
+      nsize: 3
+      args: -m 83 -n 61
+
+TEST*/
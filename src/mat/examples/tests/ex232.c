@@ -0,0 +1,166 @@
+static char help[] = "Tests the AIJSINGLE matrices, whose products use values rounded to single precision, against AIJ.\n\n";
+
+#include <petscmat.h>
+
+/* compares two vectors that should agree up to the rounding of the matrix values to single precision */
+static PetscErrorCode CheckVec(Vec u,Vec v,const char *op)
+{
+  PetscReal      nrm,err;
+  Vec            w;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = VecDuplicate(u,&w);CHKERRQ(ierr);
+  ierr = VecWAXPY(w,-1.0,u,v);CHKERRQ(ierr);
+  ierr = VecNorm(w,NORM_INFINITY,&err);CHKERRQ(ierr);
+  ierr = VecNorm(u,NORM_INFINITY,&nrm);CHKERRQ(ierr);
+  if (err > 1.e-5*nrm) {ierr = PetscPrintf(PETSC_COMM_WORLD,"%s of AIJSINGLE and AIJ differ by %g\n",op,(double)err);CHKERRQ(ierr);}
+  ierr = VecDestroy(&w);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+int main(int argc,char **args)
+{
+  Mat            A,S,P,C,CS;
+  Vec            x,y,z,xt,yt,zt,xc,yc,zc;
+  PetscInt       m = 10,n,N,i,j,k,rstart,rend,col[5];
+  PetscScalar    v[5];
+  PetscReal      err;
+  PetscBool      issingle;
+  PetscRandom    rnd;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&args,(char*)0,help);if (ierr) return ierr;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-m",&m,NULL);CHKERRQ(ierr);
+  N    = m*m;
+
+  /* a nonsymmetric five point stencil whose values are not representable in single precision */
+  ierr = MatCreate(PETSC_COMM_WORLD,&A);CHKERRQ(ierr);
+  ierr = MatSetSizes(A,PETSC_DECIDE,PETSC_DECIDE,N,N);CHKERRQ(ierr);
+  ierr = MatSetType(A,MATAIJ);CHKERRQ(ierr);
+  ierr = MatSeqAIJSetPreallocation(A,5,NULL);CHKERRQ(ierr);
+  ierr = MatMPIAIJSetPreallocation(A,5,NULL,2,NULL);CHKERRQ(ierr);
+  ierr = MatGetOwnershipRange(A,&rstart,&rend);CHKERRQ(ierr);
+  for (i=rstart; i<rend; i++) {
+    k = 0;
+    if (i >= m)      {col[k] = i-m; v[k++] = -1.0/3.0;}
+    if (i%m)         {col[k] = i-1; v[k++] = -1.0/7.0;}
+    col[k] = i; v[k++] = 4.1/3.0;
+    if ((i+1)%m)     {col[k] = i+1; v[k++] = -2.0/7.0;}
+    if (i < N-m)     {col[k] = i+m; v[k++] = -1.0/11.0;}
+    ierr = MatSetValues(A,1,&i,k,col,v,INSERT_VALUES);CHKERRQ(ierr);
+  }
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatConvert(A,MATAIJSINGLE,MAT_INITIAL_MATRIX,&S);CHKERRQ(ierr);
+
+  ierr = PetscRandomCreate(PETSC_COMM_WORLD,&rnd);CHKERRQ(ierr);
+  ierr = PetscRandomSetFromOptions(rnd);CHKERRQ(ierr);
+  ierr = MatCreateVecs(A,&x,&y);CHKERRQ(ierr);
+  ierr = VecDuplicate(y,&z);CHKERRQ(ierr);
+  ierr = VecDuplicate(x,&xt);CHKERRQ(ierr);
+  ierr = VecDuplicate(y,&yt);CHKERRQ(ierr);
+  ierr = VecDuplicate(x,&zt);CHKERRQ(ierr);
+  ierr = VecSetRandom(x,rnd);CHKERRQ(ierr);
+  ierr = VecSetRandom(yt,rnd);CHKERRQ(ierr);
+
+  ierr = MatMult(A,x,y);CHKERRQ(ierr);
+  ierr = MatMult(S,x,z);CHKERRQ(ierr);
+  ierr = CheckVec(y,z,"MatMult()");CHKERRQ(ierr);
+  /* the products must really use the rounded values */
+  ierr = VecAXPY(z,-1.0,y);CHKERRQ(ierr);
+  ierr = VecNorm(z,NORM_INFINITY,&err);CHKERRQ(ierr);
+  if (err == 0.0) {ierr = PetscPrintf(PETSC_COMM_WORLD,"MatMult() of AIJSINGLE does not use single precision values\n");CHKERRQ(ierr);}
+  ierr = MatMult(S,x,z);CHKERRQ(ierr);
+  ierr = MatMultAdd(A,x,y,y);CHKERRQ(ierr);
+  ierr = MatMultAdd(S,x,z,z);CHKERRQ(ierr);
+  ierr = CheckVec(y,z,"MatMultAdd()");CHKERRQ(ierr);
+
+  ierr = MatMultTranspose(A,yt,xt);CHKERRQ(ierr);
+  ierr = MatMultTranspose(S,yt,zt);CHKERRQ(ierr);
+  ierr = CheckVec(xt,zt,"MatMultTranspose()");CHKERRQ(ierr);
+  ierr = MatMultTransposeAdd(A,yt,x,xt);CHKERRQ(ierr);
+  ierr = MatMultTransposeAdd(S,yt,x,zt);CHKERRQ(ierr);
+  ierr = CheckVec(xt,zt,"MatMultTransposeAdd()");CHKERRQ(ierr);
+
+  for (j=0; j<2; j++) {
+    ierr = MatSOR(A,x,1.1,(MatSORType)(SOR_LOCAL_SYMMETRIC_SWEEP | SOR_ZERO_INITIAL_GUESS),0.0,2,1,y);CHKERRQ(ierr);
+    ierr = MatSOR(S,x,1.1,(MatSORType)(SOR_LOCAL_SYMMETRIC_SWEEP | SOR_ZERO_INITIAL_GUESS),0.0,2,1,z);CHKERRQ(ierr);
+    ierr = CheckVec(y,z,"MatSOR()");CHKERRQ(ierr);
+    ierr = MatSOR(A,x,1.0,SOR_LOCAL_FORWARD_SWEEP,0.0,1,2,y);CHKERRQ(ierr);
+    ierr = MatSOR(S,x,1.0,SOR_LOCAL_FORWARD_SWEEP,0.0,1,2,z);CHKERRQ(ierr);
+    ierr = CheckVec(y,z,"MatSOR()");CHKERRQ(ierr);
+
+    /* the rounded values must follow changes of the matrix */
+    ierr = MatDiagonalScale(A,x,yt);CHKERRQ(ierr);
+    ierr = MatDiagonalScale(S,x,yt);CHKERRQ(ierr);
+    ierr = MatScale(A,3.0);CHKERRQ(ierr);
+    ierr = MatScale(S,3.0);CHKERRQ(ierr);
+    ierr = MatMult(A,x,y);CHKERRQ(ierr);
+    ierr = MatMult(S,x,z);CHKERRQ(ierr);
+    ierr = CheckVec(y,z,"MatMult() after a change of the values");CHKERRQ(ierr);
+  }
+
+  /* Galerkin product with a piecewise constant interpolation; the product is again of type AIJSINGLE */
+  n    = (N+1)/2;
+  ierr = MatCreateAIJ(PETSC_COMM_WORLD,rend-rstart,PETSC_DECIDE,N,n,1,NULL,1,NULL,&P);CHKERRQ(ierr);
+  for (i=rstart; i<rend; i++) {
+    j    = i/2;
+    ierr = MatSetValue(P,i,j,1.0,INSERT_VALUES);CHKERRQ(ierr);
+  }
+  ierr = MatAssemblyBegin(P,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(P,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatPtAP(A,P,MAT_INITIAL_MATRIX,2.0,&C);CHKERRQ(ierr);
+  ierr = MatPtAP(S,P,MAT_INITIAL_MATRIX,2.0,&CS);CHKERRQ(ierr);
+  ierr = PetscObjectTypeCompareAny((PetscObject)CS,&issingle,MATSEQAIJSINGLE,MATMPIAIJSINGLE,"");CHKERRQ(ierr);
+  if (!issingle) {
+    MatType type;
+
+    ierr = MatGetType(CS,&type);CHKERRQ(ierr);
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"MatPtAP() of AIJSINGLE returned a %s matrix\n",type);CHKERRQ(ierr);
+  }
+  ierr = MatScale(S,2.0);CHKERRQ(ierr);
+  ierr = MatScale(A,2.0);CHKERRQ(ierr);
+  ierr = MatPtAP(A,P,MAT_REUSE_MATRIX,2.0,&C);CHKERRQ(ierr);
+  ierr = MatPtAP(S,P,MAT_REUSE_MATRIX,2.0,&CS);CHKERRQ(ierr);
+  ierr = MatCreateVecs(C,&xc,&yc);CHKERRQ(ierr);
+  ierr = VecDuplicate(yc,&zc);CHKERRQ(ierr);
+  ierr = VecSetRandom(xc,rnd);CHKERRQ(ierr);
+  ierr = MatMult(C,xc,yc);CHKERRQ(ierr);
+  ierr = MatMult(CS,xc,zc);CHKERRQ(ierr);
+  ierr = CheckVec(yc,zc,"MatMult() of MatPtAP()");CHKERRQ(ierr);
+
+  ierr = PetscRandomDestroy(&rnd);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&y);CHKERRQ(ierr);
+  ierr = VecDestroy(&z);CHKERRQ(ierr);
+  ierr = VecDestroy(&xt);CHKERRQ(ierr);
+  ierr = VecDestroy(&yt);CHKERRQ(ierr);
+  ierr = VecDestroy(&zt);CHKERRQ(ierr);
+  ierr = VecDestroy(&xc);CHKERRQ(ierr);
+  ierr = VecDestroy(&yc);CHKERRQ(ierr);
+  ierr = VecDestroy(&zc);CHKERRQ(ierr);
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = MatDestroy(&S);CHKERRQ(ierr);
+  ierr = MatDestroy(&P);CHKERRQ(ierr);
+  ierr = MatDestroy(&C);CHKERRQ(ierr);
+  ierr = MatDestroy(&CS);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
+
+/*TEST
+
+   build:
+      requires: double !complex
+
+   test:
+      output_file: output/ex232_1.out
+
+   test:
+      suffix: 2
+      nsize: 3
+      args: -m 13
+      output_file: output/ex232_1.out
+
+TEST*/
@@ -0,0 +1,149 @@
+static char help[] = "Tests the MatMult() and MatSOR() kernels of AIJ matrices with 16 bit column indices against AIJ.\n\
+  -wide : add an entry far from the diagonal so that the indices cannot be compressed\n\n";
+
+#include <petscmat.h>
+
+/* compares two vectors that should agree up to roundoff */
+static PetscErrorCode CheckVec(Vec u,Vec v,const char *op)
+{
+  PetscReal      nrm,err;
+  Vec            w;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = VecDuplicate(u,&w);CHKERRQ(ierr);
+  ierr = VecWAXPY(w,-1.0,u,v);CHKERRQ(ierr);
+  ierr = VecNorm(w,NORM_INFINITY,&err);CHKERRQ(ierr);
+  ierr = VecNorm(u,NORM_INFINITY,&nrm);CHKERRQ(ierr);
+  if (err > 1.e-12*nrm) {ierr = PetscPrintf(PETSC_COMM_WORLD,"%s with 16 bit indices and AIJ differ by %g\n",op,(double)err);CHKERRQ(ierr);}
+  ierr = VecDestroy(&w);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode AssembleMatrix(PetscInt n,PetscBool wide,Mat *A)
+{
+  PetscInt       i,k,rstart,rend,col;
+  PetscScalar    v;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatCreate(PETSC_COMM_WORLD,A);CHKERRQ(ierr);
+  ierr = MatSetSizes(*A,PETSC_DECIDE,PETSC_DECIDE,n,n);CHKERRQ(ierr);
+  ierr = MatSetType(*A,MATAIJ);CHKERRQ(ierr);
+  ierr = MatSeqAIJSetPreallocation(*A,8,NULL);CHKERRQ(ierr);
+  ierr = MatMPIAIJSetPreallocation(*A,8,NULL,8,NULL);CHKERRQ(ierr);
+  ierr = MatGetOwnershipRange(*A,&rstart,&rend);CHKERRQ(ierr);
+  /* a band of varying width with a dominant diagonal */
+  for (i=rstart; i<rend; i++) {
+    v    = 10.0;
+    ierr = MatSetValues(*A,1,&i,1,&i,&v,INSERT_VALUES);CHKERRQ(ierr);
+    for (k=1; k<=(i*5)%7; k++) {
+      col  = (i+k*k*3)%n;
+      v    = 1.0/(i+k+1.0);
+      ierr = MatSetValues(*A,1,&i,1,&col,&v,INSERT_VALUES);CHKERRQ(ierr);
+    }
+  }
+  if (wide && rstart == 0) {
+    i    = 0;
+    col  = n-1;
+    v    = 1.0;
+    ierr = MatSetValues(*A,1,&i,1,&col,&v,INSERT_VALUES);CHKERRQ(ierr);
+  }
+  ierr = MatAssemblyBegin(*A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(*A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+int main(int argc,char **args)
+{
+  Mat            A,C,D;
+  Vec            x,y,z,xt,yt,zt;
+  PetscInt       n = 1000;
+  PetscBool      wide = PETSC_FALSE;
+  PetscMPIInt    size;
+  PetscRandom    rnd;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&args,(char*)0,help);if (ierr) return ierr;
+  ierr = MPI_Comm_size(PETSC_COMM_WORLD,&size);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(NULL,NULL,"-wide",&wide,NULL);CHKERRQ(ierr);
+
+  ierr = AssembleMatrix(n,wide,&A);CHKERRQ(ierr);
+  ierr = PetscOptionsSetValue(NULL,"-mat_aij_compress_indices",NULL);CHKERRQ(ierr);
+  ierr = AssembleMatrix(n,wide,&C);CHKERRQ(ierr);
+  if (size == 1) {
+    ierr = PetscViewerPushFormat(PETSC_VIEWER_STDOUT_WORLD,PETSC_VIEWER_ASCII_INFO);CHKERRQ(ierr);
+    ierr = MatView(C,PETSC_VIEWER_STDOUT_WORLD);CHKERRQ(ierr);
+    ierr = PetscViewerPopFormat(PETSC_VIEWER_STDOUT_WORLD);CHKERRQ(ierr);
+  }
+  ierr = PetscOptionsClearValue(NULL,"-mat_aij_compress_indices");CHKERRQ(ierr);
+
+  ierr = PetscRandomCreate(PETSC_COMM_WORLD,&rnd);CHKERRQ(ierr);
+  ierr = PetscRandomSetFromOptions(rnd);CHKERRQ(ierr);
+  ierr = MatCreateVecs(A,&x,&y);CHKERRQ(ierr);
+  ierr = VecDuplicate(y,&z);CHKERRQ(ierr);
+  ierr = VecDuplicate(x,&xt);CHKERRQ(ierr);
+  ierr = VecDuplicate(y,&yt);CHKERRQ(ierr);
+  ierr = VecDuplicate(x,&zt);CHKERRQ(ierr);
+  ierr = VecSetRandom(x,rnd);CHKERRQ(ierr);
+  ierr = VecSetRandom(yt,rnd);CHKERRQ(ierr);
+
+  ierr = MatMult(A,x,y);CHKERRQ(ierr);
+  ierr = MatMult(C,x,z);CHKERRQ(ierr);
+  ierr = CheckVec(y,z,"MatMult()");CHKERRQ(ierr);
+  ierr = MatMultAdd(A,x,y,y);CHKERRQ(ierr);
+  ierr = MatMultAdd(C,x,z,z);CHKERRQ(ierr);
+  ierr = CheckVec(y,z,"MatMultAdd()");CHKERRQ(ierr);
+  ierr = MatMultTranspose(A,yt,xt);CHKERRQ(ierr);
+  ierr = MatMultTranspose(C,yt,zt);CHKERRQ(ierr);
+  ierr = CheckVec(xt,zt,"MatMultTranspose()");CHKERRQ(ierr);
+  ierr = MatMultTransposeAdd(A,yt,x,xt);CHKERRQ(ierr);
+  ierr = MatMultTransposeAdd(C,yt,x,zt);CHKERRQ(ierr);
+  ierr = CheckVec(xt,zt,"MatMultTransposeAdd()");CHKERRQ(ierr);
+
+  ierr = MatSOR(A,x,1.1,(MatSORType)(SOR_LOCAL_SYMMETRIC_SWEEP | SOR_ZERO_INITIAL_GUESS),0.0,2,1,y);CHKERRQ(ierr);
+  ierr = MatSOR(C,x,1.1,(MatSORType)(SOR_LOCAL_SYMMETRIC_SWEEP | SOR_ZERO_INITIAL_GUESS),0.0,2,1,z);CHKERRQ(ierr);
+  ierr = CheckVec(y,z,"MatSOR()");CHKERRQ(ierr);
+  ierr = MatSOR(A,x,0.9,SOR_LOCAL_FORWARD_SWEEP,0.0,1,2,y);CHKERRQ(ierr);
+  ierr = MatSOR(C,x,0.9,SOR_LOCAL_FORWARD_SWEEP,0.0,1,2,z);CHKERRQ(ierr);
+  ierr = CheckVec(y,z,"MatSOR()");CHKERRQ(ierr);
+  ierr = MatSOR(A,x,1.0,SOR_LOCAL_BACKWARD_SWEEP,0.0,1,2,y);CHKERRQ(ierr);
+  ierr = MatSOR(C,x,1.0,SOR_LOCAL_BACKWARD_SWEEP,0.0,1,2,z);CHKERRQ(ierr);
+  ierr = CheckVec(y,z,"MatSOR()");CHKERRQ(ierr);
+
+  /* the duplicate compresses its own indices */
+  ierr = MatDuplicate(C,MAT_COPY_VALUES,&D);CHKERRQ(ierr);
+  ierr = MatMult(A,x,y);CHKERRQ(ierr);
+  ierr = MatMult(D,x,z);CHKERRQ(ierr);
+  ierr = CheckVec(y,z,"MatMult() of MatDuplicate()");CHKERRQ(ierr);
+
+  ierr = PetscRandomDestroy(&rnd);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&y);CHKERRQ(ierr);
+  ierr = VecDestroy(&z);CHKERRQ(ierr);
+  ierr = VecDestroy(&xt);CHKERRQ(ierr);
+  ierr = VecDestroy(&yt);CHKERRQ(ierr);
+  ierr = VecDestroy(&zt);CHKERRQ(ierr);
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = MatDestroy(&C);CHKERRQ(ierr);
+  ierr = MatDestroy(&D);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
+
+/*TEST
+
+   test:
+
+   test:
+      suffix: wide
+      args: -wide -n 70000
+
+   test:
+      suffix: 2
+      nsize: 3
+      args: -mat_no_inode
+      output_file: output/ex233_2.out
+
+TEST*/
@@ -0,0 +1,153 @@
+static char help[] = "Tests and benchmarks the level scheduled MatSolve() of SeqAIJ factors against the usual MatSolve().\n\
+  -m <m>         : the matrix is the 5 point Laplacian on an m x m grid\n\
+  -lu            : use a complete factorization instead of an incomplete one\n\
+  -cholesky      : use Cholesky or ICC instead of LU or ILU\n\
+  -fill <k>      : number of levels of fill of the incomplete factorization\n\
+  -ordering <o>  : ordering used by the factorization\n\
+  -nsolves <n>   : number of solves timed by -benchmark\n\
+  -benchmark     : print the time of the solves and the speedup of the level scheduled MatSolve()\n\n";
+
+#include <petscmat.h>
+#include <petsctime.h>
+
+static PetscErrorCode Factor(Mat A,PetscBool lu,PetscBool cholesky,PetscInt fill,MatOrderingType otype,Mat *F)
+{
+  IS             row,col;
+  MatFactorInfo  info;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatGetOrdering(A,otype,&row,&col);CHKERRQ(ierr);
+  ierr = MatFactorInfoInitialize(&info);CHKERRQ(ierr);
+  info.levels = fill;
+  info.fill   = lu ? 5.0 : 1.0;
+  if (cholesky) {
+    ierr = MatGetFactor(A,MATSOLVERPETSC,lu ? MAT_FACTOR_CHOLESKY : MAT_FACTOR_ICC,F);CHKERRQ(ierr);
+    if (lu) {ierr = MatCholeskyFactorSymbolic(*F,A,row,&info);CHKERRQ(ierr);}
+    else {ierr = MatICCFactorSymbolic(*F,A,row,&info);CHKERRQ(ierr);}
+    ierr = MatCholeskyFactorNumeric(*F,A,&info);CHKERRQ(ierr);
+  } else {
+    ierr = MatGetFactor(A,MATSOLVERPETSC,lu ? MAT_FACTOR_LU : MAT_FACTOR_ILU,F);CHKERRQ(ierr);
+    if (lu) {ierr = MatLUFactorSymbolic(*F,A,row,col,&info);CHKERRQ(ierr);}
+    else {ierr = MatILUFactorSymbolic(*F,A,row,col,&info);CHKERRQ(ierr);}
+    ierr = MatLUFactorNumeric(*F,A,&info);CHKERRQ(ierr);
+  }
+  ierr = ISDestroy(&row);CHKERRQ(ierr);
+  ierr = ISDestroy(&col);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode TimeSolves(Mat F,Vec b,Vec x,PetscInt nsolves,PetscLogDouble *time)
+{
+  PetscInt       i;
+  PetscLogDouble t0,t1;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSolve(F,b,x);CHKERRQ(ierr);
+  ierr = PetscTime(&t0);CHKERRQ(ierr);
+  for (i=0; i<nsolves; i++) {ierr = MatSolve(F,b,x);CHKERRQ(ierr);}
+  ierr = PetscTime(&t1);CHKERRQ(ierr);
+  *time = (t1-t0)/nsolves;
+  PetscFunctionReturn(0);
+}
+
+int main(int argc,char **args)
+{
+  Mat            A,F,G;
+  Vec            b,x,y;
+  PetscInt       m = 32,fill = 0,nsolves = 100,i,j,row,col;
+  PetscReal      err,nrm;
+  PetscScalar    v;
+  PetscBool      lu = PETSC_FALSE,cholesky = PETSC_FALSE,benchmark = PETSC_FALSE;
+  char           otype[256] = MATORDERINGNATURAL;
+  PetscLogDouble tserial,tlevels;
+  PetscRandom    rnd;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&args,(char*)0,help);if (ierr) return ierr;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-m",&m,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(NULL,NULL,"-lu",&lu,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(NULL,NULL,"-cholesky",&cholesky,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-fill",&fill,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetString(NULL,NULL,"-ordering",otype,sizeof(otype),NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-nsolves",&nsolves,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(NULL,NULL,"-benchmark",&benchmark,NULL);CHKERRQ(ierr);
+
+  ierr = MatCreateSeqAIJ(PETSC_COMM_SELF,m*m,m*m,5,NULL,&A);CHKERRQ(ierr);
+  for (i=0; i<m; i++) {
+    for (j=0; j<m; j++) {
+      row = i*m+j;
+      v   = -1.0;
+      if (i>0)   {col = row-m; ierr = MatSetValues(A,1,&row,1,&col,&v,INSERT_VALUES);CHKERRQ(ierr);}
+      if (i<m-1) {col = row+m; ierr = MatSetValues(A,1,&row,1,&col,&v,INSERT_VALUES);CHKERRQ(ierr);}
+      if (j>0)   {col = row-1; ierr = MatSetValues(A,1,&row,1,&col,&v,INSERT_VALUES);CHKERRQ(ierr);}
+      if (j<m-1) {col = row+1; ierr = MatSetValues(A,1,&row,1,&col,&v,INSERT_VALUES);CHKERRQ(ierr);}
+      v    = 4.0;
+      ierr = MatSetValues(A,1,&row,1,&row,&v,INSERT_VALUES);CHKERRQ(ierr);
+    }
+  }
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+
+  ierr = Factor(A,lu,cholesky,fill,otype,&F);CHKERRQ(ierr);
+  ierr = PetscOptionsSetValue(NULL,"-mat_aij_solve_levels",NULL);CHKERRQ(ierr);
+  ierr = Factor(A,lu,cholesky,fill,otype,&G);CHKERRQ(ierr);
+  ierr = PetscOptionsClearValue(NULL,"-mat_aij_solve_levels");CHKERRQ(ierr);
+
+  ierr = PetscRandomCreate(PETSC_COMM_SELF,&rnd);CHKERRQ(ierr);
+  ierr = PetscRandomSetFromOptions(rnd);CHKERRQ(ierr);
+  ierr = MatCreateVecs(A,&x,&b);CHKERRQ(ierr);
+  ierr = VecDuplicate(x,&y);CHKERRQ(ierr);
+  ierr = VecSetRandom(b,rnd);CHKERRQ(ierr);
+  ierr = MatSolve(F,b,x);CHKERRQ(ierr);
+  ierr = MatSolve(G,b,y);CHKERRQ(ierr);
+  ierr = VecNorm(x,NORM_INFINITY,&nrm);CHKERRQ(ierr);
+  ierr = VecAXPY(y,-1.0,x);CHKERRQ(ierr);
+  ierr = VecNorm(y,NORM_INFINITY,&err);CHKERRQ(ierr);
+  if (err > 1.e-12*nrm) {ierr = PetscPrintf(PETSC_COMM_SELF,"Level scheduled and usual MatSolve() differ by %g\n",(double)err);CHKERRQ(ierr);}
+
+  /* the view reports the number of levels, which bounds the parallelism of each solve */
+  ierr = PetscViewerPushFormat(PETSC_VIEWER_STDOUT_SELF,PETSC_VIEWER_ASCII_INFO);CHKERRQ(ierr);
+  ierr = MatView(G,PETSC_VIEWER_STDOUT_SELF);CHKERRQ(ierr);
+  ierr = PetscViewerPopFormat(PETSC_VIEWER_STDOUT_SELF);CHKERRQ(ierr);
+
+  if (benchmark) {
+    ierr = TimeSolves(F,b,x,nsolves,&tserial);CHKERRQ(ierr);
+    ierr = TimeSolves(G,b,y,nsolves,&tlevels);CHKERRQ(ierr);
+    ierr = PetscPrintf(PETSC_COMM_SELF,"MatSolve() on %D rows: usual %g s, level scheduled %g s, speedup %g\n",m*m,tserial,tlevels,tlevels > 0.0 ? tserial/tlevels : 0.0);CHKERRQ(ierr);
+  }
+
+  ierr = PetscRandomDestroy(&rnd);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&y);CHKERRQ(ierr);
+  ierr = VecDestroy(&b);CHKERRQ(ierr);
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = MatDestroy(&F);CHKERRQ(ierr);
+  ierr = MatDestroy(&G);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
+
+/*TEST
+
+   test:
+      args: -fill 1
+
+   test:
+      suffix: lu
+      args: -lu -ordering nd -m 20
+
+   test:
+      suffix: rcm
+      args: -fill 2 -ordering rcm -m 20
+
+   test:
+      suffix: icc
+      args: -cholesky -fill 1
+
+   test:
+      suffix: cholesky
+      args: -cholesky -lu -ordering nd -m 20
+
+TEST*/
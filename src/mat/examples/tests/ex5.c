@@ -189,6 +189,14 @@ int main(int argc,char **args)
       nsize: 3
       args: -mat_type mpidense
 
+   test:
+      suffix: 23_neighbor
+      nsize: 3
+      args: -mat_type mpiaij -vecscatter_neighbor
+      filter: grep -v type
+      output_file: output/ex5_23.out
+      requires: define(PETSC_HAVE_MPI_NEIGHBORHOOD_COLLECTIVES)
+
    test:
       suffix: 2_aijcusparse_1
       args: -mat_type mpiaijcusparse -vec_type cuda
@@ -234,6 +242,14 @@ int main(int argc,char **args)
       args: -mat_type mpibaij -test_diagonalscale
       filter: grep -v Mat_
 
+   test:
+      suffix: 33_neighbor
+      nsize: 3
+      args: -mat_type mpiaij -test_diagonalscale -vecscatter_neighbor
+      filter: grep -v type
+      output_file: output/ex5_33.out
+      requires: define(PETSC_HAVE_MPI_NEIGHBORHOOD_COLLECTIVES)
+
    test:
       suffix: 3_aijcusparse_1
       args: -mat_type mpiaijcusparse -vec_type cuda -test_diagonalscale
@@ -309,6 +309,12 @@ int main(int argc,char **argv)
      args: -Mx 10 -My 5 -Mz 10 -matmatmult_via scalable -matptap_via scalable -inner_diag_matmatmult_via sorted -inner_offdiag_matmatmult_via sorted
      output_file: output/ex96_1.out
 
+   test:
+     suffix: seq_hash
+     nsize: 3
+     args: -Mx 10 -My 5 -Mz 10 -matmatmult_via scalable -matptap_via scalable -inner_diag_matmatmult_via hash -inner_offdiag_matmatmult_via hash
+     output_file: output/ex96_1.out
+
    test:
      suffix: seq_scalable_fast
      nsize: 3
@@ -351,4 +357,10 @@ int main(int argc,char **argv)
      args: -Mx 10 -My 5 -Mz 10 -matmatmult_via scalable -matptap_via allatonce_merged
      output_file: output/ex96_1.out
 
+   test:
+     suffix: allatonce_merged_numeric
+     nsize: 3
+     args: -Mx 10 -My 5 -Mz 10 -matmatmult_via scalable -matptap_via allatonce -matptap_allatonce_via merged
+     output_file: output/ex96_1.out
+
 TEST*/
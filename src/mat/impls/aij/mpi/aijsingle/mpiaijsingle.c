@@ -0,0 +1,103 @@
+#include <../src/mat/impls/aij/mpi/mpiaij.h>
+
+PETSC_INTERN PetscErrorCode MatConvert_SeqAIJ_SeqAIJSingle(Mat,MatType,MatReuse,Mat*);
+PETSC_INTERN PetscErrorCode MatConvert_MPIAIJ_MPIAIJSingle(Mat,MatType,MatReuse,Mat*);
+
+PetscErrorCode MatMPIAIJSetPreallocation_MPIAIJSingle(Mat B,PetscInt d_nz,const PetscInt d_nnz[],PetscInt o_nz,const PetscInt o_nnz[])
+{
+  Mat_MPIAIJ     *b = (Mat_MPIAIJ*)B->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatMPIAIJSetPreallocation_MPIAIJ(B,d_nz,d_nnz,o_nz,o_nnz);CHKERRQ(ierr);
+  ierr = MatConvert_SeqAIJ_SeqAIJSingle(b->A,MATSEQAIJSINGLE,MAT_INPLACE_MATRIX,&b->A);CHKERRQ(ierr);
+  ierr = MatConvert_SeqAIJ_SeqAIJSingle(b->B,MATSEQAIJSINGLE,MAT_INPLACE_MATRIX,&b->B);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* The Galerkin coarse operators of PCGAMG and PCMG keep the class of the fine grid operator */
+PetscErrorCode MatPtAP_MPIAIJSingle_MPIAIJ(Mat A,Mat P,MatReuse scall,PetscReal fill,Mat *C)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatPtAP_MPIAIJ_MPIAIJ(A,P,scall,fill,C);CHKERRQ(ierr);
+  if (scall == MAT_INITIAL_MATRIX) {
+    ierr = MatConvert_MPIAIJ_MPIAIJSingle(*C,MATMPIAIJSINGLE,MAT_INPLACE_MATRIX,C);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+PETSC_INTERN PetscErrorCode MatConvert_MPIAIJ_MPIAIJSingle(Mat A,MatType type,MatReuse reuse,Mat *newmat)
+{
+  PetscErrorCode ierr;
+  Mat            B = *newmat;
+  Mat_MPIAIJ     *b;
+
+  PetscFunctionBegin;
+  if (reuse == MAT_INITIAL_MATRIX) {
+    ierr = MatDuplicate(A,MAT_COPY_VALUES,&B);CHKERRQ(ierr);
+  }
+  b = (Mat_MPIAIJ*)B->data;
+
+  /* the blocks of an already preallocated matrix are converted here, later ones by the preallocation */
+  if (b->A) {ierr = MatConvert_SeqAIJ_SeqAIJSingle(b->A,MATSEQAIJSINGLE,MAT_INPLACE_MATRIX,&b->A);CHKERRQ(ierr);}
+  if (b->B) {ierr = MatConvert_SeqAIJ_SeqAIJSingle(b->B,MATSEQAIJSINGLE,MAT_INPLACE_MATRIX,&b->B);CHKERRQ(ierr);}
+  B->ops->ptap = MatPtAP_MPIAIJSingle_MPIAIJ;
+
+  ierr = PetscObjectChangeTypeName((PetscObject)B,MATMPIAIJSINGLE);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatMPIAIJSetPreallocation_C",MatMPIAIJSetPreallocation_MPIAIJSingle);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatPtAP_mpiaij_mpiaijsingle_C",MatPtAP_MPIAIJ_MPIAIJ);CHKERRQ(ierr);
+  *newmat = B;
+  PetscFunctionReturn(0);
+}
+
+PETSC_EXTERN PetscErrorCode MatCreate_MPIAIJSingle(Mat A)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSetType(A,MATMPIAIJ);CHKERRQ(ierr);
+  ierr = MatConvert_MPIAIJ_MPIAIJSingle(A,MATMPIAIJSINGLE,MAT_INPLACE_MATRIX,&A);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*MC
+   MATMPIAIJSINGLE - MATMPIAIJSINGLE = "mpiaijsingle" - A parallel AIJ matrix whose local blocks are of type
+   MATSEQAIJSINGLE, so that MatMult() and the local MatSOR() sweeps read the nonzero values in single precision
+   while the vectors and the sums stay in the precision of PetscScalar.
+
+   Options Database Keys:
+. -mat_type mpiaijsingle - sets the matrix type to "mpiaijsingle" during a call to MatSetFromOptions()
+
+   Level: intermediate
+
+.seealso: MatCreate(), MATMPIAIJ, MATAIJSINGLE, MATSEQAIJSINGLE
+M*/
+
+/*MC
+   MATAIJSINGLE - MATAIJSINGLE = "aijsingle" - A matrix type to be used for sparse matrices whose products and
+   relaxation sweeps may use values rounded to single precision, typically the operators of a preconditioner.
+
+   This matrix type is identical to MATSEQAIJSINGLE when constructed with a single process communicator,
+   and MATMPIAIJSINGLE otherwise.  As a result, for single process communicators,
+   MatSeqAIJSetPreallocation() is supported, and similarly MatMPIAIJSetPreallocation() is supported
+   for communicators controlling multiple processes.  It is recommended that you call both of
+   the above preallocation routines for simplicity.
+
+   Options Database Keys:
+. -mat_type aijsingle - sets the matrix type to "aijsingle" during a call to MatSetFromOptions()
+
+   Notes:
+   Only the copy of the values used by MatMult(), MatMultAdd(), MatMultTranspose(), MatMultTransposeAdd() and MatSOR()
+   is rounded; it is rebuilt whenever the matrix changes. It is stored in addition to the double precision values, so the
+   matrix needs more memory than MATAIJ, see MATSEQAIJSINGLE. The coarse grid operators computed by PCGAMG (and by PCMG with
+   -pc_mg_galerkin) from a matrix of this type are again of this type, so that the whole hierarchy of smoothers uses it.
+
+   Use it for the matrix defining the preconditioner, for example with KSPSetOperators(ksp,A,Apc) or -dm_mat_type
+   aijsingle for a Jacobian only used by the preconditioner; the accuracy of the Krylov method is then unaffected.
+
+  Level: intermediate
+
+.seealso: MATSEQAIJSINGLE, MATMPIAIJSINGLE, MATAIJ
+M*/
@@ -20,7 +20,7 @@
 . -mat_type aij - sets the matrix type to "aij" during a call to MatSetFromOptions()
 
   Developer Notes:
-    Subclasses include MATAIJCUSP, MATAIJCUSPARSE, MATAIJPERM, MATAIJSELL, MATAIJMKL, MATAIJCRL, and also automatically switches over to use inodes when
+    Subclasses include MATAIJCUSP, MATAIJCUSPARSE, MATAIJPERM, MATAIJSELL, MATAIJSINGLE, MATAIJMKL, MATAIJCRL, and also automatically switches over to use inodes when
    enough exist.
 
   Level: beginner
@@ -1205,6 +1205,23 @@ PetscErrorCode MatScale_MPIAIJ(Mat A,PetscScalar aa)
   PetscFunctionReturn(0);
 }
 
+static PetscErrorCode MatResetCOO_MPIAIJ_Private(Mat mat)
+{
+  Mat_MPIAIJ     *aij = (Mat_MPIAIJ*)mat->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscSFDestroy(&aij->coo_sf);CHKERRQ(ierr);
+  ierr = PetscFree2(aij->coo_locperm,aij->coo_locdest);CHKERRQ(ierr);
+  ierr = PetscFree(aij->coo_sendperm);CHKERRQ(ierr);
+  ierr = PetscFree(aij->coo_recvdest);CHKERRQ(ierr);
+  ierr = PetscFree2(aij->coo_sendbuf,aij->coo_recvbuf);CHKERRQ(ierr);
+  aij->coo_nloc  = 0;
+  aij->coo_nsend = 0;
+  aij->coo_nrecv = 0;
+  PetscFunctionReturn(0);
+}
+
 PetscErrorCode MatDestroy_MPIAIJ(Mat mat)
 {
   Mat_MPIAIJ     *aij = (Mat_MPIAIJ*)mat->data;
@@ -1229,6 +1246,7 @@ PetscErrorCode MatDestroy_MPIAIJ(Mat mat)
   if (aij->Mvctx_mpi1) {ierr = VecScatterDestroy(&aij->Mvctx_mpi1);CHKERRQ(ierr);}
   ierr = PetscFree2(aij->rowvalues,aij->rowindices);CHKERRQ(ierr);
   ierr = PetscFree(aij->ld);CHKERRQ(ierr);
+  ierr = MatResetCOO_MPIAIJ_Private(mat);CHKERRQ(ierr);
   ierr = PetscFree(mat->data);CHKERRQ(ierr);
 
   ierr = PetscObjectChangeTypeName((PetscObject)mat,0);CHKERRQ(ierr);
@@ -1249,6 +1267,9 @@ PetscErrorCode MatDestroy_MPIAIJ(Mat mat)
 #endif
   ierr = PetscObjectComposeFunction((PetscObject)mat,"MatConvert_mpiaij_is_C",NULL);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)mat,"MatPtAP_is_mpiaij_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)mat,"MatPtAP_mpiaijsingle_mpiaij_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)mat,"MatSetPreallocationCOO_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)mat,"MatSetValuesCOO_C",NULL);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
@@ -1823,6 +1844,9 @@ PetscErrorCode MatSetOption_MPIAIJ(Mat A,MatOption op,PetscBool flg)
   case MAT_IGNORE_OFF_PROC_ENTRIES:
     a->donotstash = flg;
     break;
+  case MAT_USE_HASH_TABLE:
+    a->usehash = flg;
+    break;
   /* Symmetry flags are handled directly by MatSetOption() and they don't affect preallocation */
   case MAT_SPD:
   case MAT_SYMMETRIC:
@@ -2168,12 +2192,268 @@ PetscErrorCode MatCopy_MPIAIJ(Mat A,Mat B,MatStructure str)
   PetscFunctionReturn(0);
 }
 
+/*
+   Allocates the diagonal and off-diagonal blocks for exactly the nonzeros collected in the hash table
+*/
+static PetscErrorCode MatHashFill_MPIAIJ(Mat A,const PetscInt rowptr[],const PetscInt cols[],const PetscScalar vals[])
+{
+  Mat_MPIAIJ     *aij = (Mat_MPIAIJ*)A->data;
+  Mat_SeqAIJ     *a   = (Mat_SeqAIJ*)aij->A->data,*b;
+  PetscInt       i,j,m = A->rmap->n,cstart = A->cmap->rstart,cend = A->cmap->rend,nonew = a->nonew,*dnz,*onz;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscCalloc2(m,&dnz,m,&onz);CHKERRQ(ierr);
+  for (i=0; i<m; i++) {
+    for (j=rowptr[i]; j<rowptr[i+1]; j++) {
+      if (cols[j] >= cstart && cols[j] < cend) dnz[i]++;
+      else onz[i]++;
+    }
+  }
+  ierr = MatMPIAIJSetPreallocation(A,0,dnz,0,onz);CHKERRQ(ierr);
+  ierr = PetscFree2(dnz,onz);CHKERRQ(ierr);
+  /* the off-diagonal block has been recreated, give it the options of the diagonal block */
+  b                     = (Mat_SeqAIJ*)aij->B->data;
+  a->nonew              = nonew;
+  b->nonew              = nonew;
+  b->nounused           = a->nounused;
+  b->roworiented        = a->roworiented;
+  b->keepnonzeropattern = a->keepnonzeropattern;
+  b->ignorezeroentries  = a->ignorezeroentries;
+  ierr = MatSetValues_MPIAIJ_CopyFromCSRFormat(A,cols,rowptr,vals);CHKERRQ(ierr);
+  aij->A->nonzerostate++;
+  aij->B->nonzerostate++;
+  PetscFunctionReturn(0);
+}
+
 PetscErrorCode MatSetUp_MPIAIJ(Mat A)
 {
+  Mat_MPIAIJ     *a = (Mat_MPIAIJ*)A->data;
   PetscErrorCode ierr;
 
   PetscFunctionBegin;
-  ierr = MatMPIAIJSetPreallocation(A,PETSC_DEFAULT,0,PETSC_DEFAULT,0);CHKERRQ(ierr);
+  if (a->usehash) {
+    /* empty blocks, the actual ones are allocated from the hash table in MatAssemblyEnd() */
+    ierr = MatMPIAIJSetPreallocation(A,0,NULL,0,NULL);CHKERRQ(ierr);
+    ((Mat_SeqAIJ*)a->A->data)->nonew = 0;
+    ((Mat_SeqAIJ*)a->B->data)->nonew = 0;
+    ierr = MatAIJSetUpHash_Private(A,a->roworiented,PETSC_FALSE,a->donotstash,MatHashFill_MPIAIJ);CHKERRQ(ierr);
+  } else {
+    ierr = MatMPIAIJSetPreallocation(A,PETSC_DEFAULT,0,PETSC_DEFAULT,0);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+/*
+   The entries in rows owned by other processes are grouped by owner; each owner learns with a two-sided rendezvous
+   how many entries it gets from whom and builds a star forest whose roots are the send buffer of the senders and
+   whose leaves are its receive buffer. The owner then sorts its local and received entries by row and column, the
+   distinct ones give the nonzero pattern and the position of each entry in the storage of the diagonal or
+   off-diagonal block. MatSetValuesCOO_MPIAIJ() only packs, broadcasts and adds values.
+*/
+PetscErrorCode MatSetPreallocationCOO_MPIAIJ(Mat mat,PetscInt ncoo,const PetscInt coo_i[],const PetscInt coo_j[])
+{
+  Mat_MPIAIJ     *aij = (Mat_MPIAIJ*)mat->data;
+  Mat_SeqAIJ     *a,*b;
+  MPI_Comm       comm;
+  PetscMPIInt    size,rank,owner,nto,nfrom,*toranks,*fromranks,*owners;
+  PetscInt       k,p,q,r,t,m = mat->rmap->n,rstart = mat->rmap->rstart,cstart = mat->cmap->rstart,cend = mat->cmap->rend;
+  PetscInt       nloc,nsend,nrecv,ntot,nz,nzA,da,ob,*tocounts,*todata,*fromdata,*sendi,*sendj,*recvi,*recvj;
+  PetscInt       *rowptr,*next,*cols,*src,*dest;
+  PetscScalar    *zeros;
+  PetscSFNode    *iremote;
+  PetscBool      nooffprocentries;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectGetComm((PetscObject)mat,&comm);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(comm,&size);CHKERRQ(ierr);
+  ierr = MPI_Comm_rank(comm,&rank);CHKERRQ(ierr);
+  ierr = MatResetCOO_MPIAIJ_Private(mat);CHKERRQ(ierr);
+
+  /* count the entries going to each process */
+  ierr = PetscMalloc1(ncoo,&owners);CHKERRQ(ierr);
+  ierr = PetscCalloc1(size+1,&tocounts);CHKERRQ(ierr);
+  for (k=0; k<ncoo; k++) {
+    owners[k] = -1;
+    if (coo_i[k] < 0 || coo_j[k] < 0) continue;
+    if (coo_i[k] >= mat->rmap->N) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Row too large: row %D max %D",coo_i[k],mat->rmap->N-1);
+    if (coo_j[k] >= mat->cmap->N) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Column too large: col %D max %D",coo_j[k],mat->cmap->N-1);
+    ierr = PetscLayoutFindOwner(mat->rmap,coo_i[k],&owner);CHKERRQ(ierr);
+    owners[k] = owner;
+    tocounts[owner+1]++;
+  }
+  nloc             = tocounts[rank+1];
+  tocounts[rank+1] = 0;
+  for (nto=0,r=0; r<size; r++) {
+    if (tocounts[r+1]) nto++;
+    tocounts[r+1] += tocounts[r];
+  }
+  nsend = tocounts[size];
+
+  /* split the list into the locally owned entries and the send buffer, which is ordered by destination */
+  ierr = PetscMalloc2(nloc,&aij->coo_locperm,nloc,&aij->coo_locdest);CHKERRQ(ierr);
+  ierr = PetscMalloc1(nsend,&aij->coo_sendperm);CHKERRQ(ierr);
+  ierr = PetscMalloc2(nsend,&sendi,nsend,&sendj);CHKERRQ(ierr);
+  ierr = PetscMalloc2(nto,&toranks,2*nto,&todata);CHKERRQ(ierr);
+  for (nto=0,r=0; r<size; r++) {
+    if (tocounts[r+1] == tocounts[r]) continue;
+    toranks[nto]    = r;
+    todata[2*nto]   = tocounts[r+1] - tocounts[r]; /* number of entries */
+    todata[2*nto+1] = tocounts[r];                 /* their offset in the send buffer */
+    nto++;
+  }
+  for (nloc=0,k=0; k<ncoo; k++) {
+    if (owners[k] < 0) continue;
+    if (owners[k] == rank) aij->coo_locperm[nloc++] = k;
+    else {
+      p                    = tocounts[owners[k]]++;
+      aij->coo_sendperm[p] = k;
+      sendi[p]             = coo_i[k];
+      sendj[p]             = coo_j[k];
+    }
+  }
+  ierr = PetscFree(owners);CHKERRQ(ierr);
+  ierr = PetscFree(tocounts);CHKERRQ(ierr);
+
+  /* tell the owners what to expect and build the star forest from their side */
+  ierr = PetscCommBuildTwoSided(comm,2,MPIU_INT,nto,toranks,todata,&nfrom,&fromranks,&fromdata);CHKERRQ(ierr);
+  ierr = PetscFree2(toranks,todata);CHKERRQ(ierr);
+  for (nrecv=0,r=0; r<nfrom; r++) nrecv += fromdata[2*r];
+  ierr = PetscMalloc1(nrecv,&iremote);CHKERRQ(ierr);
+  for (nrecv=0,r=0; r<nfrom; r++) {
+    for (t=0; t<fromdata[2*r]; t++) {
+      iremote[nrecv].rank    = fromranks[r];
+      iremote[nrecv++].index = fromdata[2*r+1]+t;
+    }
+  }
+  ierr = PetscFree(fromranks);CHKERRQ(ierr);
+  ierr = PetscFree(fromdata);CHKERRQ(ierr);
+  ierr = PetscSFCreate(comm,&aij->coo_sf);CHKERRQ(ierr);
+  ierr = PetscSFSetGraph(aij->coo_sf,nsend,nrecv,NULL,PETSC_OWN_POINTER,iremote,PETSC_OWN_POINTER);CHKERRQ(ierr);
+  ierr = PetscSFSetFromOptions(aij->coo_sf);CHKERRQ(ierr);
+  ierr = PetscSFSetUp(aij->coo_sf);CHKERRQ(ierr);
+
+  ierr = PetscMalloc2(nrecv,&recvi,nrecv,&recvj);CHKERRQ(ierr);
+  ierr = PetscSFBcastBegin(aij->coo_sf,MPIU_INT,sendi,recvi);CHKERRQ(ierr);
+  ierr = PetscSFBcastEnd(aij->coo_sf,MPIU_INT,sendi,recvi);CHKERRQ(ierr);
+  ierr = PetscSFBcastBegin(aij->coo_sf,MPIU_INT,sendj,recvj);CHKERRQ(ierr);
+  ierr = PetscSFBcastEnd(aij->coo_sf,MPIU_INT,sendj,recvj);CHKERRQ(ierr);
+  ierr = PetscFree2(sendi,sendj);CHKERRQ(ierr);
+
+  /* bucket sort the local entries followed by the received ones by row, then sort each row by column */
+  ntot = nloc + nrecv;
+  ierr = PetscCalloc2(m+1,&rowptr,m+1,&next);CHKERRQ(ierr);
+  for (k=0; k<nloc; k++)  rowptr[coo_i[aij->coo_locperm[k]]-rstart+1]++;
+  for (t=0; t<nrecv; t++) rowptr[recvi[t]-rstart+1]++;
+  for (r=0; r<m; r++) {
+    rowptr[r+1] += rowptr[r];
+    next[r]      = rowptr[r];
+  }
+  ierr = PetscMalloc3(ntot,&cols,ntot,&src,ntot,&dest);CHKERRQ(ierr);
+  for (k=0; k<nloc; k++) {
+    q       = aij->coo_locperm[k];
+    p       = next[coo_i[q]-rstart]++;
+    cols[p] = coo_j[q];
+    src[p]  = k;
+  }
+  for (t=0; t<nrecv; t++) {
+    p       = next[recvi[t]-rstart]++;
+    cols[p] = recvj[t];
+    src[p]  = nloc + t;
+  }
+  ierr = PetscFree2(recvi,recvj);CHKERRQ(ierr);
+  for (r=0; r<m; r++) {
+    ierr = PetscSortIntWithArray(rowptr[r+1]-rowptr[r],cols+rowptr[r],src+rowptr[r]);CHKERRQ(ierr);
+  }
+
+  /* merge repeated entries, dest[] temporarily holds the distinct nonzero of each sorted entry */
+  for (r=0,nz=0; r<m; r++) {
+    next[r] = nz;
+    for (p=rowptr[r]; p<rowptr[r+1]; p++) {
+      if (p == rowptr[r] || cols[p] != cols[p-1]) cols[nz++] = cols[p];
+      dest[p] = nz-1;
+    }
+  }
+  next[m] = nz;
+  ierr = PetscInfo4(mat,"%D COO entries, %D sent to and %D received from other processes, %D distinct nonzeros\n",ncoo,nsend,nrecv,nz);CHKERRQ(ierr);
+
+  /* allocate and assemble the exact nonzero pattern */
+  if (!aij->A) {
+    ierr = MatMPIAIJSetPreallocation(mat,0,NULL,0,NULL);CHKERRQ(ierr);
+  }
+  ierr = PetscCalloc1(nz,&zeros);CHKERRQ(ierr);
+  ierr = MatHashFill_MPIAIJ(mat,next,cols,zeros);CHKERRQ(ierr);
+  ierr = PetscFree(zeros);CHKERRQ(ierr);
+  nooffprocentries      = mat->nooffprocentries;
+  mat->nooffprocentries = PETSC_TRUE;
+  ierr = MatAssemblyBegin(mat,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(mat,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  mat->nooffprocentries = nooffprocentries;
+
+  /* the distinct nonzeros of a row are stored in the same order, split between the diagonal and off-diagonal block */
+  a   = (Mat_SeqAIJ*)aij->A->data;
+  b   = (Mat_SeqAIJ*)aij->B->data;
+  nzA = a->i[m];
+  for (r=0; r<m; r++) {
+    da = a->i[r];
+    ob = nzA + b->i[r];
+    for (q=next[r]; q<next[r+1]; q++) {
+      if (cols[q] >= cstart && cols[q] < cend) cols[q] = da++;
+      else cols[q] = ob++;
+    }
+    if (da != a->i[r+1] || ob != nzA + b->i[r+1]) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_PLIB,"Nonzero pattern of local row %D does not match the COO entries",r);
+  }
+  ierr = PetscMalloc1(nrecv,&aij->coo_recvdest);CHKERRQ(ierr);
+  for (p=0; p<ntot; p++) {
+    if (src[p] < nloc) aij->coo_locdest[src[p]] = cols[dest[p]];
+    else aij->coo_recvdest[src[p]-nloc] = cols[dest[p]];
+  }
+  ierr = PetscFree3(cols,src,dest);CHKERRQ(ierr);
+  ierr = PetscFree2(rowptr,next);CHKERRQ(ierr);
+
+  ierr = PetscMalloc2(nsend,&aij->coo_sendbuf,nrecv,&aij->coo_recvbuf);CHKERRQ(ierr);
+  aij->coo_nloc         = nloc;
+  aij->coo_nsend        = nsend;
+  aij->coo_nrecv        = nrecv;
+  aij->coo_nonzerostate = mat->nonzerostate;
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatSetValuesCOO_MPIAIJ(Mat mat,const PetscScalar v[],InsertMode imode)
+{
+  Mat_MPIAIJ     *aij = (Mat_MPIAIJ*)mat->data;
+  Mat_SeqAIJ     *a   = (Mat_SeqAIJ*)aij->A->data,*b = (Mat_SeqAIJ*)aij->B->data;
+  PetscInt       k,q,nzA = a->i[mat->rmap->n],nzB = b->i[mat->rmap->n];
+  PetscInt       nloc = aij->coo_nloc,nsend = aij->coo_nsend,nrecv = aij->coo_nrecv;
+  PetscInt       *locperm = aij->coo_locperm,*locdest = aij->coo_locdest,*sendperm = aij->coo_sendperm,*recvdest = aij->coo_recvdest;
+  PetscScalar    *sendbuf = aij->coo_sendbuf,*recvbuf = aij->coo_recvbuf;
+  MatScalar      *aa = a->a,*ba = b->a;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (!aij->coo_sf) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONGSTATE,"Must call MatSetPreallocationCOO() first");
+  if (aij->coo_nonzerostate != mat->nonzerostate) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONGSTATE,"The nonzero pattern has changed since MatSetPreallocationCOO()");
+  for (k=0; k<nsend; k++) sendbuf[k] = v[sendperm[k]];
+  ierr = PetscSFBcastBegin(aij->coo_sf,MPIU_SCALAR,sendbuf,recvbuf);CHKERRQ(ierr);
+  if (imode == INSERT_VALUES) {
+    ierr = PetscMemzero(aa,nzA*sizeof(MatScalar));CHKERRQ(ierr);
+    ierr = PetscMemzero(ba,nzB*sizeof(MatScalar));CHKERRQ(ierr);
+  }
+  for (k=0; k<nloc; k++) {
+    q = locdest[k];
+    if (q < nzA) aa[q] += v[locperm[k]];
+    else ba[q-nzA] += v[locperm[k]];
+  }
+  ierr = PetscSFBcastEnd(aij->coo_sf,MPIU_SCALAR,sendbuf,recvbuf);CHKERRQ(ierr);
+  for (k=0; k<nrecv; k++) {
+    q = recvdest[k];
+    if (q < nzA) aa[q] += recvbuf[k];
+    else ba[q-nzA] += recvbuf[k];
+  }
+  ierr = MatSeqAIJValuesChanged_Private(aij->A);CHKERRQ(ierr);
+  ierr = MatSeqAIJValuesChanged_Private(aij->B);CHKERRQ(ierr);
+  ierr = VecDestroy(&aij->diag);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
@@ -2517,6 +2797,7 @@ PetscErrorCode MatMPIAIJSetUseScalableIncreaseOverlap(Mat A,PetscBool sc)
 
 PetscErrorCode MatSetFromOptions_MPIAIJ(PetscOptionItems *PetscOptionsObject,Mat A)
 {
+  Mat_MPIAIJ           *a = (Mat_MPIAIJ*)A->data;
   PetscErrorCode       ierr;
   PetscBool            sc = PETSC_FALSE,flg;
 
@@ -2527,6 +2808,7 @@ PetscErrorCode MatSetFromOptions_MPIAIJ(PetscOptionItems *PetscOptionsObject,Mat
   if (flg) {
     ierr = MatMPIAIJSetUseScalableIncreaseOverlap(A,sc);CHKERRQ(ierr);
   }
+  ierr = PetscOptionsBool("-mat_use_hash_table","Assemble through a hash table when the matrix is not preallocated","MatSetOption",a->usehash,&a->usehash,NULL);CHKERRQ(ierr);
   ierr = PetscOptionsTail();CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
@@ -5519,6 +5801,7 @@ PetscErrorCode MatGetCommunicationStructs(Mat A, Vec *lvec, PetscInt *colmap[],
 PETSC_INTERN PetscErrorCode MatConvert_MPIAIJ_MPIAIJCRL(Mat,MatType,MatReuse,Mat*);
 PETSC_INTERN PetscErrorCode MatConvert_MPIAIJ_MPIAIJPERM(Mat,MatType,MatReuse,Mat*);
 PETSC_INTERN PetscErrorCode MatConvert_MPIAIJ_MPIAIJSELL(Mat,MatType,MatReuse,Mat*);
+PETSC_INTERN PetscErrorCode MatConvert_MPIAIJ_MPIAIJSingle(Mat,MatType,MatReuse,Mat*);
 #if defined(PETSC_HAVE_MKL_SPARSE)
 PETSC_INTERN PetscErrorCode MatConvert_MPIAIJ_MPIAIJMKL(Mat,MatType,MatReuse,Mat*);
 #endif
@@ -5657,6 +5940,7 @@ PETSC_EXTERN PetscErrorCode MatCreate_MPIAIJ(Mat B)
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatDiagonalScaleLocal_C",MatDiagonalScaleLocal_MPIAIJ);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_mpiaij_mpiaijperm_C",MatConvert_MPIAIJ_MPIAIJPERM);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_mpiaij_mpiaijsell_C",MatConvert_MPIAIJ_MPIAIJSELL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_mpiaij_mpiaijsingle_C",MatConvert_MPIAIJ_MPIAIJSingle);CHKERRQ(ierr);
 #if defined(PETSC_HAVE_MKL_SPARSE)
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_mpiaij_mpiaijmkl_C",MatConvert_MPIAIJ_MPIAIJMKL);CHKERRQ(ierr);
 #endif
@@ -5677,6 +5961,9 @@ PETSC_EXTERN PetscErrorCode MatCreate_MPIAIJ(Mat B)
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatMatMatMult_transpose_mpiaij_mpiaij_C",MatMatMatMult_Transpose_AIJ_AIJ);CHKERRQ(ierr);
 #endif
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatPtAP_is_mpiaij_C",MatPtAP_IS_XAIJ);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatPtAP_mpiaijsingle_mpiaij_C",MatPtAP_MPIAIJSingle_MPIAIJ);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatSetPreallocationCOO_C",MatSetPreallocationCOO_MPIAIJ);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatSetValuesCOO_C",MatSetValuesCOO_MPIAIJ);CHKERRQ(ierr);
   ierr = PetscObjectChangeTypeName((PetscObject)B,MATMPIAIJ);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
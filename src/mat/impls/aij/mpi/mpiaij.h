@@ -31,6 +31,7 @@ typedef struct { /* used by MatPtAP_MPIAIJ_MPIAIJ() and MatMatMult_MPIAIJ_MPIAIJ
   PetscInt                algType;                 /* implementation algorithm */
   PetscSF                 sf;                      /* use it to communicate remote part of C */
   PetscInt                *c_othi,*c_rmti;
+  PetscInt                *c_othj,*c_rmtj;          /* column indices of the received and the sent rows of C, sorted */
 
   Mat_Merge_SeqsToMPI *merge;
   PetscErrorCode (*destroy)(Mat);
@@ -64,6 +65,7 @@ typedef struct {
   VecScatter Mvctx,Mvctx_mpi1;     /* scatter context for vector */
   PetscBool  Mvctx_mpi1_flg;       /* if true, additional Mvctx_mpi1 is requested for mat-mat ops, default false */
   PetscBool  roworiented;          /* if true, row-oriented input, default true */
+  PetscBool  usehash;              /* assemble through a hash table if not preallocated, see MAT_USE_HASH_TABLE */
 
   /* The following variables are for MatGetRow() */
   PetscInt    *rowindices;         /* column indices for row */
@@ -79,6 +81,16 @@ typedef struct {
   /* used by MatMatMatMult() */
   Mat_MatMatMatMult *matmatmatmult;
 
+  /* Used by MatSetValuesCOO(); the nonzeros are numbered by their position in [A->a,B->a] */
+  PetscSF          coo_sf;              /* moves the values of entries in rows owned by other processes to the owner */
+  PetscInt         coo_nloc,coo_nsend,coo_nrecv;
+  PetscInt         *coo_locperm;        /* position in the COO list of the locally owned entries */
+  PetscInt         *coo_locdest;        /* the nonzero the locally owned entries are added to */
+  PetscInt         *coo_sendperm;       /* position in the COO list of the entries sent to other processes */
+  PetscInt         *coo_recvdest;       /* the nonzero the received entries are added to */
+  PetscScalar      *coo_sendbuf,*coo_recvbuf;
+  PetscObjectState coo_nonzerostate;    /* nonzero state for which the above were computed */
+
   /* Used by MPICUSP and MPICUSPARSE classes */
   void * spptr;
 
@@ -89,6 +101,8 @@ PETSC_EXTERN PetscErrorCode MatCreate_MPIAIJ(Mat);
 PETSC_INTERN PetscErrorCode MatAssemblyEnd_MPIAIJ(Mat,MatAssemblyType);
 
 PETSC_INTERN PetscErrorCode MatSetUpMultiply_MPIAIJ(Mat);
+PETSC_INTERN PetscErrorCode MatSetPreallocationCOO_MPIAIJ(Mat,PetscInt,const PetscInt[],const PetscInt[]);
+PETSC_INTERN PetscErrorCode MatSetValuesCOO_MPIAIJ(Mat,const PetscScalar[],InsertMode);
 PETSC_INTERN PetscErrorCode MatDisAssemble_MPIAIJ(Mat);
 PETSC_INTERN PetscErrorCode MatDuplicate_MPIAIJ(Mat,MatDuplicateOption,Mat*);
 PETSC_INTERN PetscErrorCode MatIncreaseOverlap_MPIAIJ(Mat,PetscInt,IS [],PetscInt);
@@ -122,6 +136,7 @@ PETSC_INTERN PetscErrorCode MatMatMatMultSymbolic_MPIAIJ_MPIAIJ_MPIAIJ(Mat,Mat,M
 PETSC_INTERN PetscErrorCode MatMatMatMultNumeric_MPIAIJ_MPIAIJ_MPIAIJ(Mat,Mat,Mat,Mat);
 
 PETSC_INTERN PetscErrorCode MatPtAP_MPIAIJ_MPIAIJ(Mat,Mat,MatReuse,PetscReal,Mat*);
+PETSC_INTERN PetscErrorCode MatPtAP_MPIAIJSingle_MPIAIJ(Mat,Mat,MatReuse,PetscReal,Mat*);
 PETSC_INTERN PetscErrorCode MatPtAPSymbolic_MPIAIJ_MPIAIJ(Mat,Mat,PetscReal,Mat*);
 PETSC_INTERN PetscErrorCode MatPtAPNumeric_MPIAIJ_MPIAIJ(Mat,Mat,Mat);
 
@@ -103,6 +103,8 @@ PetscErrorCode MatFreeIntermediateDataStructures_MPIAIJ_AP(Mat A)
   ierr = PetscSFDestroy(&ptap->sf);CHKERRQ(ierr);
   ierr = PetscFree(ptap->c_othi);CHKERRQ(ierr);
   ierr = PetscFree(ptap->c_rmti);CHKERRQ(ierr);
+  ierr = PetscFree(ptap->c_othj);CHKERRQ(ierr);
+  ierr = PetscFree(ptap->c_rmtj);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
@@ -822,7 +824,7 @@ PetscErrorCode MatPtAPNumeric_MPIAIJ_MPIAIJ_allatonce(Mat A,Mat P,Mat C)
   Mat_SeqAIJ        *cd,*co,*po,*pd;
   Mat_APMPI         *ptap = c->ap;
   PetscHMapIV       hmap;
-  PetscInt          i,j,jj,kk,nzi,*c_rmtj,voff,*c_othj,pn,pon,pcstart,pcend,ccstart,ccend,row,am,*poj,*pdj,*apindices,cmaxr,*c_rmtc,*c_rmtjj,*dcc,*occ,loc;
+  PetscInt          i,j,jj,nzi,voff,pn,pon,pcstart,pcend,ccstart,ccend,row,am,*poj,*pdj,*apindices,cmaxr,*c_rmtjj,rmtnz,*dcc,*occ,loc;
   PetscScalar       *c_rmta,*c_otha,*poa,*pda,*apvalues,*apvaluestmp,*c_rmtaa;
   MPI_Comm          comm;
 
@@ -844,13 +846,13 @@ PetscErrorCode MatPtAPNumeric_MPIAIJ_MPIAIJ_allatonce(Mat A,Mat P,Mat C)
 
   ierr = MatGetLocalSize(p->B,NULL,&pon);CHKERRQ(ierr);
 
-  ierr = PetscCalloc2(ptap->c_rmti[pon],&c_rmtj,ptap->c_rmti[pon],&c_rmta);CHKERRQ(ierr);
+  ierr = PetscCalloc1(ptap->c_rmti[pon],&c_rmta);CHKERRQ(ierr);
   ierr = MatGetLocalSize(A,&am,NULL);CHKERRQ(ierr);
   cmaxr = 0;
   for (i=0; i<pon; i++) {
     cmaxr = PetscMax(cmaxr,ptap->c_rmti[i+1]-ptap->c_rmti[i]);
   }
-  ierr = PetscCalloc4(cmaxr,&apindices,cmaxr,&apvalues,cmaxr,&apvaluestmp,pon,&c_rmtc);CHKERRQ(ierr);
+  ierr = PetscCalloc3(cmaxr,&apindices,cmaxr,&apvalues,cmaxr,&apvaluestmp);CHKERRQ(ierr);
   ierr = PetscHMapIVCreate(&hmap);CHKERRQ(ierr);
   ierr = PetscHMapIVResize(hmap,cmaxr);CHKERRQ(ierr);
   for (i=0; i<am && pon; i++) {
@@ -861,47 +863,30 @@ PetscErrorCode MatPtAPNumeric_MPIAIJ_MPIAIJ_allatonce(Mat A,Mat P,Mat C)
     voff = 0;
     ierr = PetscHMapIVGetPairs(hmap,&voff,apindices,apvalues);CHKERRQ(ierr);
     if (!voff) continue;
-    /*ierr = PetscMemzero(c_rmtc,sizeof(PetscInt)*pon);CHKERRQ(ierr);*/
 
     /* Form C(ii, :) */
     poj = po->j + po->i[i];
     poa = po->a + po->i[i];
     for (j=0; j<nzi; j++) {
-      c_rmtjj = c_rmtj + ptap->c_rmti[poj[j]];
+      /* the columns of the remote rows are known and sorted since the symbolic phase */
+      c_rmtjj = ptap->c_rmtj + ptap->c_rmti[poj[j]];
       c_rmtaa = c_rmta + ptap->c_rmti[poj[j]];
+      rmtnz   = ptap->c_rmti[poj[j]+1] - ptap->c_rmti[poj[j]];
       for (jj=0; jj<voff; jj++) {
-        apvaluestmp[jj] = apvalues[jj]*poa[j];
-        /*If the row is empty */
-        if (!c_rmtc[poj[j]]) {
-          c_rmtjj[jj] = apindices[jj];
-          c_rmtaa[jj] = apvaluestmp[jj];
-          c_rmtc[poj[j]]++;
-        } else {
-          ierr = PetscFindInt(apindices[jj],c_rmtc[poj[j]],c_rmtjj,&loc);CHKERRQ(ierr);
-          if (loc>=0){ /* hit */
-            c_rmtaa[loc] += apvaluestmp[jj];
-          } else { /* new element */
-            loc = -(loc+1);
-            /* Move data backward */
-            for (kk=c_rmtc[poj[j]]; kk>loc; kk--) {
-              c_rmtjj[kk] = c_rmtjj[kk-1];
-              c_rmtaa[kk] = c_rmtaa[kk-1];
-            }/* End kk */
-            c_rmtjj[loc] = apindices[jj];
-            c_rmtaa[loc] = apvaluestmp[jj];
-            c_rmtc[poj[j]]++;
-          }
-        }
+        ierr = PetscFindInt(apindices[jj],rmtnz,c_rmtjj,&loc);CHKERRQ(ierr);
+        if (loc < 0) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONGSTATE,"Column %D of C is not in the nonzero pattern computed by MatPtAPSymbolic()",apindices[jj]);
+        c_rmtaa[loc] += apvalues[jj]*poa[j];
       } /* End jj */
     } /* End j */
   } /* End i */
 
-  ierr = PetscFree4(apindices,apvalues,apvaluestmp,c_rmtc);CHKERRQ(ierr);
+  ierr = PetscFree3(apindices,apvalues,apvaluestmp);CHKERRQ(ierr);
+  ierr = PetscHMapIVDestroy(&hmap);CHKERRQ(ierr);
 
   ierr = MatGetLocalSize(P,NULL,&pn);CHKERRQ(ierr);
-  ierr = PetscCalloc2(ptap->c_othi[pn],&c_othj,ptap->c_othi[pn],&c_otha);CHKERRQ(ierr);
+  ierr = PetscCalloc1(ptap->c_othi[pn],&c_otha);CHKERRQ(ierr);
 
-  ierr = PetscSFReduceBegin(ptap->sf,MPIU_INT,c_rmtj,c_othj,MPIU_REPLACE);CHKERRQ(ierr);
+  /* only the values travel, the column indices of the received rows were kept by the symbolic phase */
   ierr = PetscSFReduceBegin(ptap->sf,MPIU_SCALAR,c_rmta,c_otha,MPIU_REPLACE);CHKERRQ(ierr);
   ierr = MatGetOwnershipRangeColumn(P,&pcstart,&pcend);CHKERRQ(ierr);
   cd = (Mat_SeqAIJ*)(c->A)->data;
@@ -937,16 +922,15 @@ PetscErrorCode MatPtAPNumeric_MPIAIJ_MPIAIJ_allatonce(Mat A,Mat P,Mat C)
   ierr = MatGetOwnershipRangeColumn(C,&ccstart,&ccend);CHKERRQ(ierr);
   ierr = PetscFree5(apindices,apvalues,apvaluestmp,dcc,occ);CHKERRQ(ierr);
   ierr = PetscHMapIVDestroy(&hmap);CHKERRQ(ierr);
-  ierr = PetscSFReduceEnd(ptap->sf,MPIU_INT,c_rmtj,c_othj,MPI_SUM);CHKERRQ(ierr);
   ierr = PetscSFReduceEnd(ptap->sf,MPIU_SCALAR,c_rmta,c_otha,MPIU_REPLACE);CHKERRQ(ierr);
-  ierr = PetscFree2(c_rmtj,c_rmta);CHKERRQ(ierr);
+  ierr = PetscFree(c_rmta);CHKERRQ(ierr);
 
   /* Add contributions from remote */
   for (i = 0; i < pn; i++) {
     row = i + pcstart;
-    ierr = MatSetValues(C,1,&row,ptap->c_othi[i+1]-ptap->c_othi[i],c_othj+ptap->c_othi[i],c_otha+ptap->c_othi[i],ADD_VALUES);CHKERRQ(ierr);
+    ierr = MatSetValues(C,1,&row,ptap->c_othi[i+1]-ptap->c_othi[i],ptap->c_othj+ptap->c_othi[i],c_otha+ptap->c_othi[i],ADD_VALUES);CHKERRQ(ierr);
   }
-  ierr = PetscFree2(c_othj,c_otha);CHKERRQ(ierr);
+  ierr = PetscFree(c_otha);CHKERRQ(ierr);
 
   ierr = MatAssemblyBegin(C,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
   ierr = MatAssemblyEnd(C,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
@@ -967,7 +951,7 @@ PetscErrorCode MatPtAPNumeric_MPIAIJ_MPIAIJ_allatonce_merged(Mat A,Mat P,Mat C)
   Mat_SeqAIJ        *cd,*co,*po,*pd;
   Mat_APMPI         *ptap = c->ap;
   PetscHMapIV       hmap;
-  PetscInt          i,j,jj,kk,nzi,dnzi,*c_rmtj,voff,*c_othj,pn,pon,pcstart,pcend,row,am,*poj,*pdj,*apindices,cmaxr,*c_rmtc,*c_rmtjj,loc;
+  PetscInt          i,j,jj,nzi,dnzi,voff,pn,pon,pcstart,pcend,row,am,*poj,*pdj,*apindices,cmaxr,*c_rmtjj,rmtnz,loc;
   PetscScalar       *c_rmta,*c_otha,*poa,*pda,*apvalues,*apvaluestmp,*c_rmtaa;
   MPI_Comm          comm;
 
@@ -990,7 +974,7 @@ PetscErrorCode MatPtAPNumeric_MPIAIJ_MPIAIJ_allatonce_merged(Mat A,Mat P,Mat C)
   ierr = MatGetLocalSize(p->B,NULL,&pon);CHKERRQ(ierr);
   ierr = MatGetLocalSize(P,NULL,&pn);CHKERRQ(ierr);
 
-  ierr = PetscCalloc2(ptap->c_rmti[pon],&c_rmtj,ptap->c_rmti[pon],&c_rmta);CHKERRQ(ierr);
+  ierr = PetscCalloc1(ptap->c_rmti[pon],&c_rmta);CHKERRQ(ierr);
   ierr = MatGetLocalSize(A,&am,NULL);CHKERRQ(ierr);
   ierr = MatGetOwnershipRangeColumn(P,&pcstart,&pcend);CHKERRQ(ierr);
   cmaxr = 0;
@@ -1002,7 +986,7 @@ PetscErrorCode MatPtAPNumeric_MPIAIJ_MPIAIJ_allatonce_merged(Mat A,Mat P,Mat C)
   for (i=0; i<pn; i++) {
     cmaxr = PetscMax(cmaxr,(cd->i[i+1]-cd->i[i])+(co->i[i+1]-co->i[i]));
   }
-  ierr = PetscCalloc4(cmaxr,&apindices,cmaxr,&apvalues,cmaxr,&apvaluestmp,pon,&c_rmtc);CHKERRQ(ierr);
+  ierr = PetscCalloc3(cmaxr,&apindices,cmaxr,&apvalues,cmaxr,&apvaluestmp);CHKERRQ(ierr);
   ierr = PetscHMapIVCreate(&hmap);CHKERRQ(ierr);
   ierr = PetscHMapIVResize(hmap,cmaxr);CHKERRQ(ierr);
   for (i=0; i<am && (pon || pn); i++) {
@@ -1019,31 +1003,14 @@ PetscErrorCode MatPtAPNumeric_MPIAIJ_MPIAIJ_allatonce_merged(Mat A,Mat P,Mat C)
     poj = po->j + po->i[i];
     poa = po->a + po->i[i];
     for (j=0; j<nzi; j++) {
-      c_rmtjj = c_rmtj + ptap->c_rmti[poj[j]];
+      /* the columns of the remote rows are known and sorted since the symbolic phase */
+      c_rmtjj = ptap->c_rmtj + ptap->c_rmti[poj[j]];
       c_rmtaa = c_rmta + ptap->c_rmti[poj[j]];
+      rmtnz   = ptap->c_rmti[poj[j]+1] - ptap->c_rmti[poj[j]];
       for (jj=0; jj<voff; jj++) {
-        apvaluestmp[jj] = apvalues[jj]*poa[j];
-        /*If the row is empty */
-        if (!c_rmtc[poj[j]]) {
-          c_rmtjj[jj] = apindices[jj];
-          c_rmtaa[jj] = apvaluestmp[jj];
-          c_rmtc[poj[j]]++;
-        } else {
-          ierr = PetscFindInt(apindices[jj],c_rmtc[poj[j]],c_rmtjj,&loc);CHKERRQ(ierr);
-          if (loc>=0){ /* hit */
-            c_rmtaa[loc] += apvaluestmp[jj];
-          } else { /* new element */
-            loc = -(loc+1);
-            /* Move data backward */
-            for (kk=c_rmtc[poj[j]]; kk>loc; kk--) {
-              c_rmtjj[kk] = c_rmtjj[kk-1];
-              c_rmtaa[kk] = c_rmtaa[kk-1];
-            }/* End kk */
-            c_rmtjj[loc] = apindices[jj];
-            c_rmtaa[loc] = apvaluestmp[jj];
-            c_rmtc[poj[j]]++;
-          }
-        }
+        ierr = PetscFindInt(apindices[jj],rmtnz,c_rmtjj,&loc);CHKERRQ(ierr);
+        if (loc < 0) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONGSTATE,"Column %D of C is not in the nonzero pattern computed by MatPtAPSymbolic()",apindices[jj]);
+        c_rmtaa[loc] += apvalues[jj]*poa[j];
       } /* End jj */
     } /* End j */
 
@@ -1059,22 +1026,21 @@ PetscErrorCode MatPtAPNumeric_MPIAIJ_MPIAIJ_allatonce_merged(Mat A,Mat P,Mat C)
     }/* End j */
   } /* End i */
 
-  ierr = PetscFree4(apindices,apvalues,apvaluestmp,c_rmtc);CHKERRQ(ierr);
+  ierr = PetscFree3(apindices,apvalues,apvaluestmp);CHKERRQ(ierr);
   ierr = PetscHMapIVDestroy(&hmap);CHKERRQ(ierr);
-  ierr = PetscCalloc2(ptap->c_othi[pn],&c_othj,ptap->c_othi[pn],&c_otha);CHKERRQ(ierr);
+  ierr = PetscCalloc1(ptap->c_othi[pn],&c_otha);CHKERRQ(ierr);
 
-  ierr = PetscSFReduceBegin(ptap->sf,MPIU_INT,c_rmtj,c_othj,MPIU_REPLACE);CHKERRQ(ierr);
+  /* only the values travel, the column indices of the received rows were kept by the symbolic phase */
   ierr = PetscSFReduceBegin(ptap->sf,MPIU_SCALAR,c_rmta,c_otha,MPIU_REPLACE);CHKERRQ(ierr);
-  ierr = PetscSFReduceEnd(ptap->sf,MPIU_INT,c_rmtj,c_othj,MPI_SUM);CHKERRQ(ierr);
   ierr = PetscSFReduceEnd(ptap->sf,MPIU_SCALAR,c_rmta,c_otha,MPIU_REPLACE);CHKERRQ(ierr);
-  ierr = PetscFree2(c_rmtj,c_rmta);CHKERRQ(ierr);
+  ierr = PetscFree(c_rmta);CHKERRQ(ierr);
 
   /* Add contributions from remote */
   for (i = 0; i < pn; i++) {
     row = i + pcstart;
-    ierr = MatSetValues(C,1,&row,ptap->c_othi[i+1]-ptap->c_othi[i],c_othj+ptap->c_othi[i],c_otha+ptap->c_othi[i],ADD_VALUES);CHKERRQ(ierr);
+    ierr = MatSetValues(C,1,&row,ptap->c_othi[i+1]-ptap->c_othi[i],ptap->c_othj+ptap->c_othi[i],c_otha+ptap->c_othi[i],ADD_VALUES);CHKERRQ(ierr);
   }
-  ierr = PetscFree2(c_othj,c_otha);CHKERRQ(ierr);
+  ierr = PetscFree(c_otha);CHKERRQ(ierr);
 
   ierr = MatAssemblyBegin(C,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
   ierr = MatAssemblyEnd(C,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
@@ -1174,6 +1140,7 @@ PetscErrorCode MatPtAPSymbolic_MPIAIJ_MPIAIJ_allatonce(Mat A,Mat P,PetscReal fil
   for (i=0; i<pon; i++) {
     off = 0;
     ierr = PetscHSetIGetElems(hta[i],&off,c_rmtj+ptap->c_rmti[i]);CHKERRQ(ierr);
+    ierr = PetscSortInt(off,c_rmtj+ptap->c_rmti[i]);CHKERRQ(ierr);
     ierr = PetscHSetIDestroy(&hta[i]);CHKERRQ(ierr);
   }
   ierr = PetscFree(hta);CHKERRQ(ierr);
@@ -1282,7 +1249,7 @@ PetscErrorCode MatPtAPSymbolic_MPIAIJ_MPIAIJ_allatonce(Mat A,Mat P,PetscReal fil
 
   /* Get remote data */
   ierr = PetscSFReduceEnd(ptap->sf,MPIU_INT,c_rmtj,c_othj,MPIU_REPLACE);CHKERRQ(ierr);
-  ierr = PetscFree(c_rmtj);CHKERRQ(ierr);
+  ptap->c_rmtj = c_rmtj;
 
   for (i = 0; i < pn; i++) {
     nzi = ptap->c_othi[i+1] - ptap->c_othi[i];
@@ -1305,7 +1272,7 @@ PetscErrorCode MatPtAPSymbolic_MPIAIJ_MPIAIJ_allatonce(Mat A,Mat P,PetscReal fil
   }
 
   ierr = PetscFree2(hta,hto);CHKERRQ(ierr);
-  ierr = PetscFree(c_othj);CHKERRQ(ierr);
+  ptap->c_othj = c_othj;
 
   /* local sizes and preallocation */
   ierr = MatSetSizes(Cmpi,pn,pn,PETSC_DETERMINE,PETSC_DETERMINE);CHKERRQ(ierr);
@@ -1450,6 +1417,7 @@ PetscErrorCode MatPtAPSymbolic_MPIAIJ_MPIAIJ_allatonce_merged(Mat A,Mat P,PetscR
   for (i=0; i<pon; i++) {
     off = 0;
     ierr = PetscHSetIGetElems(hta[i],&off,c_rmtj+ptap->c_rmti[i]);CHKERRQ(ierr);
+    ierr = PetscSortInt(off,c_rmtj+ptap->c_rmti[i]);CHKERRQ(ierr);
     ierr = PetscHSetIDestroy(&hta[i]);CHKERRQ(ierr);
   }
   ierr = PetscFree(hta);CHKERRQ(ierr);
@@ -1526,7 +1494,7 @@ PetscErrorCode MatPtAPSymbolic_MPIAIJ_MPIAIJ_allatonce_merged(Mat A,Mat P,PetscR
   ierr = PetscSFReduceBegin(ptap->sf,MPIU_INT,c_rmtj,c_othj,MPIU_REPLACE);CHKERRQ(ierr);
   /* Get remote data */
   ierr = PetscSFReduceEnd(ptap->sf,MPIU_INT,c_rmtj,c_othj,MPIU_REPLACE);CHKERRQ(ierr);
-  ierr = PetscFree(c_rmtj);CHKERRQ(ierr);
+  ptap->c_rmtj = c_rmtj;
   ierr = PetscCalloc2(pn,&dnz,pn,&onz);CHKERRQ(ierr);
   ierr = MatGetOwnershipRangeColumn(P,&pcstart,&pcend);CHKERRQ(ierr);
 
@@ -1551,7 +1519,7 @@ PetscErrorCode MatPtAPSymbolic_MPIAIJ_MPIAIJ_allatonce_merged(Mat A,Mat P,PetscR
   }
 
   ierr = PetscFree2(htd,hto);CHKERRQ(ierr);
-  ierr = PetscFree(c_othj);CHKERRQ(ierr);
+  ptap->c_othj = c_othj;
 
   /* local sizes and preallocation */
   ierr = MatSetSizes(Cmpi,pn,pn,PETSC_DETERMINE,PETSC_DETERMINE);CHKERRQ(ierr);
@@ -9,6 +9,9 @@
 #include <petscblaslapack.h>
 #include <petscbt.h>
 #include <petsc/private/kernels/blocktranspose.h>
+#if defined(PETSC_HAVE_OPENMP)
+#include <omp.h>
+#endif
 
 PetscErrorCode MatSeqAIJSetTypeFromOptions(Mat A)
 {
@@ -958,6 +961,194 @@ PetscErrorCode MatView_SeqAIJ_Draw(Mat A,PetscViewer viewer)
   PetscFunctionReturn(0);
 }
 
+#if defined(PETSC_HAVE_OPENMP)
+/*
+   Splits the rows, or the inodes when the inode routines are used, into contiguous chunks with about the
+   same number of nonzeros, one per thread, and then copies i, j and a into new arrays with the same
+   threads so that with a first-touch policy each chunk lives in the memory closest to the thread using it.
+*/
+PetscErrorCode MatSeqAIJSetUpOpenMP(Mat A)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscInt       m = A->rmap->n,nz = a->nz,nt = a->omp.nthreads,t,u,nu,row,maxnz = 0;
+  const PetscInt *ns = a->inode.size;
+  PetscInt       *rstart,*nstart,*ai,*aj;
+  MatScalar      *aa;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscFree3(a->omp.rstart,a->omp.nstart,a->omp.time);CHKERRQ(ierr);
+  ierr = PetscCalloc3(nt+1,&a->omp.rstart,nt+1,&a->omp.nstart,nt,&a->omp.time);CHKERRQ(ierr);
+  rstart = a->omp.rstart;
+  nstart = a->omp.nstart;
+  nu     = ns ? a->inode.node_count : m;
+  for (t=0,u=0,row=0; t<nt; t++) {
+    PetscInt target = (PetscInt)(((PetscInt64)nz*t)/nt);
+
+    while (u < nu && a->i[row] < target) {
+      row += ns ? ns[u] : 1;
+      u++;
+    }
+    nstart[t] = u;
+    rstart[t] = row;
+  }
+  nstart[nt] = nu;
+  rstart[nt] = m;
+  for (t=0; t<nt; t++) maxnz = PetscMax(maxnz,a->i[rstart[t+1]]-a->i[rstart[t]]);
+  a->omp.nzimbalance = nz ? (PetscReal)maxnz*nt/nz : 1.0;
+  ierr = PetscInfo4(A,"Using %D threads for MatMult() on %D %s, nonzero imbalance (max/mean) %g\n",nt,nu,ns ? "inodes" : "rows",(double)a->omp.nzimbalance);CHKERRQ(ierr);
+
+  if (nz && a->free_a && a->free_ij && !A->structure_only) {
+    ierr = PetscMalloc1(m+1,&ai);CHKERRQ(ierr);
+    ierr = PetscMalloc1(nz,&aj);CHKERRQ(ierr);
+    ierr = PetscMalloc1(nz,&aa);CHKERRQ(ierr);
+#pragma omp parallel for schedule(static,1) num_threads(nt)
+    for (t=0; t<nt; t++) {
+      PetscInt r,k;
+
+      for (r=rstart[t]; r<rstart[t+1]; r++) ai[r] = a->i[r];
+      for (k=a->i[rstart[t]]; k<a->i[rstart[t+1]]; k++) {
+        aj[k] = a->j[k];
+        aa[k] = a->a[k];
+      }
+    }
+    ai[m] = a->i[m];
+    ierr  = MatSeqXAIJFreeAIJ(A,&a->a,&a->j,&a->i);CHKERRQ(ierr);
+    a->i            = ai;
+    a->j            = aj;
+    a->a            = aa;
+    a->singlemalloc = PETSC_FALSE;
+    a->free_a       = PETSC_TRUE;
+    a->free_ij      = PETSC_TRUE;
+    a->maxnz        = nz;
+  }
+  A->ops->mult            = ns ? MatMult_SeqAIJ_Inode_OpenMP : MatMult_SeqAIJ_OpenMP;
+  A->ops->multadd         = ns ? MatMultAdd_SeqAIJ_Inode_OpenMP : MatMultAdd_SeqAIJ_OpenMP;
+  a->omp.mat_nonzerostate = A->nonzerostate;
+  PetscFunctionReturn(0);
+}
+
+/* z = A x + y with y = NULL meaning zero; thread t only touches the rows it first-touched in MatSeqAIJSetUpOpenMP() */
+static void MatMultAdd_SeqAIJ_OpenMP_Private(Mat A,const PetscScalar *x,const PetscScalar *y,PetscScalar *z)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  const PetscInt *ii = a->i,*rstart = a->omp.rstart;
+  PetscInt       t,nt = a->omp.nthreads;
+  PetscLogDouble *time = a->omp.time;
+
+#pragma omp parallel for schedule(static,1) num_threads(nt)
+  for (t=0; t<nt; t++) {
+    const PetscInt  *aj;
+    const MatScalar *aa;
+    PetscScalar     sum;
+    PetscInt        i,n;
+    double          t0 = omp_get_wtime();
+
+    for (i=rstart[t]; i<rstart[t+1]; i++) {
+      n   = ii[i+1] - ii[i];
+      aj  = a->j + ii[i];
+      aa  = a->a + ii[i];
+      sum = y ? y[i] : 0.0;
+      PetscSparseDensePlusDot(sum,x,aa,aj,n);
+      z[i] = sum;
+    }
+    time[t] += omp_get_wtime() - t0;
+  }
+}
+
+PetscErrorCode MatMult_SeqAIJ_OpenMP(Mat A,Vec xx,Vec yy)
+{
+  Mat_SeqAIJ        *a = (Mat_SeqAIJ*)A->data;
+  PetscScalar       *y;
+  const PetscScalar *x;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  if (a->omp.mat_nonzerostate != A->nonzerostate) {ierr = MatSeqAIJSetUpOpenMP(A);CHKERRQ(ierr);}
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArray(yy,&y);CHKERRQ(ierr);
+  MatMultAdd_SeqAIJ_OpenMP_Private(A,x,NULL,y);
+  ierr = PetscLogFlops(2.0*a->nz - a->nonzerorowcnt);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(yy,&y);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMultAdd_SeqAIJ_OpenMP(Mat A,Vec xx,Vec yy,Vec zz)
+{
+  Mat_SeqAIJ        *a = (Mat_SeqAIJ*)A->data;
+  PetscScalar       *y,*z;
+  const PetscScalar *x;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  if (a->omp.mat_nonzerostate != A->nonzerostate) {ierr = MatSeqAIJSetUpOpenMP(A);CHKERRQ(ierr);}
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArrayPair(yy,zz,&y,&z);CHKERRQ(ierr);
+  MatMultAdd_SeqAIJ_OpenMP_Private(A,x,y,z);
+  ierr = PetscLogFlops(2.0*a->nz);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArrayPair(yy,zz,&y,&z);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* the largest over the mean of the time spent in MatMult() by the threads */
+static PetscReal MatSeqAIJGetOpenMPTimeImbalance_Private(Mat A)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscInt       t,nt = a->omp.nthreads;
+  PetscLogDouble maxtime = 0.0,sumtime = 0.0;
+
+  for (t=0; t<nt; t++) {
+    maxtime  = PetscMax(maxtime,a->omp.time[t]);
+    sumtime += a->omp.time[t];
+  }
+  return sumtime > 0.0 ? (PetscReal)(maxtime*nt/sumtime) : 1.0;
+}
+
+static PetscErrorCode MatView_SeqAIJ_OpenMP(Mat A,PetscViewer viewer)
+{
+  Mat_SeqAIJ        *a = (Mat_SeqAIJ*)A->data;
+  PetscErrorCode    ierr;
+  PetscBool         iascii;
+  PetscViewerFormat format;
+  PetscInt          t;
+
+  PetscFunctionBegin;
+  if (!a->omp.rstart) PetscFunctionReturn(0);
+  ierr = PetscObjectTypeCompare((PetscObject)viewer,PETSCVIEWERASCII,&iascii);CHKERRQ(ierr);
+  if (!iascii) PetscFunctionReturn(0);
+  ierr = PetscViewerGetFormat(viewer,&format);CHKERRQ(ierr);
+  if (format == PETSC_VIEWER_ASCII_INFO_DETAIL || format == PETSC_VIEWER_ASCII_INFO) {
+    ierr = PetscViewerASCIIPrintf(viewer,"using OpenMP MatMult() with %D threads: nonzero imbalance %g, time imbalance %g (max/mean)\n",a->omp.nthreads,(double)a->omp.nzimbalance,(double)MatSeqAIJGetOpenMPTimeImbalance_Private(A));CHKERRQ(ierr);
+    if (format == PETSC_VIEWER_ASCII_INFO_DETAIL) {
+      for (t=0; t<a->omp.nthreads; t++) {
+        ierr = PetscViewerASCIIPrintf(viewer,"  thread %D: rows %D to %D, nz %D, time %g\n",t,a->omp.rstart[t],a->omp.rstart[t+1],a->i[a->omp.rstart[t+1]]-a->i[a->omp.rstart[t]],a->omp.time[t]);CHKERRQ(ierr);
+      }
+    }
+  }
+  PetscFunctionReturn(0);
+}
+
+/* reads the options for the threaded MatMult() at creation, like the inode options, so they also apply to the blocks of MATMPIAIJ */
+static PetscErrorCode MatCreate_SeqAIJ_OpenMP(Mat B)
+{
+  Mat_SeqAIJ     *b = (Mat_SeqAIJ*)B->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  b->omp.use              = PETSC_FALSE;
+  b->omp.nthreads         = omp_get_max_threads();
+  b->omp.mat_nonzerostate = -1;
+  ierr = PetscOptionsBegin(PetscObjectComm((PetscObject)B),((PetscObject)B)->prefix,"Options for SEQAIJ matrix","Mat");CHKERRQ(ierr);
+  ierr = PetscOptionsBool("-mat_aij_openmp","Use OpenMP threads in MatMult()",NULL,b->omp.use,&b->omp.use,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsInt("-mat_aij_openmp_threads","Number of threads used in MatMult()",NULL,b->omp.nthreads,&b->omp.nthreads,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsEnd();CHKERRQ(ierr);
+  if (b->omp.nthreads < 1) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Number of threads %D must be positive",b->omp.nthreads);
+  PetscFunctionReturn(0);
+}
+#endif
+
 PetscErrorCode MatView_SeqAIJ(Mat A,PetscViewer viewer)
 {
   PetscErrorCode ierr;
@@ -975,6 +1166,12 @@ PetscErrorCode MatView_SeqAIJ(Mat A,PetscViewer viewer)
     ierr = MatView_SeqAIJ_Draw(A,viewer);CHKERRQ(ierr);
   }
   ierr = MatView_SeqAIJ_Inode(A,viewer);CHKERRQ(ierr);
+  ierr = MatView_SeqAIJ_Idx16(A,viewer);CHKERRQ(ierr);
+  ierr = MatView_SeqAIJ_Levels(A,&((Mat_SeqAIJ*)A->data)->levels,viewer);CHKERRQ(ierr);
+  ierr = MatView_SeqAIJ_ChowPatel(A,viewer);CHKERRQ(ierr);
+#if defined(PETSC_HAVE_OPENMP)
+  ierr = MatView_SeqAIJ_OpenMP(A,viewer);CHKERRQ(ierr);
+#endif
   PetscFunctionReturn(0);
 }
 
@@ -1039,6 +1236,23 @@ PetscErrorCode MatAssemblyEnd_SeqAIJ(Mat A,MatAssemblyType mode)
   }
   ierr = MatAssemblyEnd_SeqAIJ_Inode(A,mode);CHKERRQ(ierr);
   ierr = MatSeqAIJInvalidateDiagonal(A);CHKERRQ(ierr);
+  if (a->idx16.use && !A->factortype && !A->structure_only && a->idx16.mat_nonzerostate != A->nonzerostate) {
+    PetscBool isseqaij;
+
+    /* subclasses may keep some of the kernels of MATSEQAIJ, which must then no longer read the old indices */
+    ierr = PetscObjectTypeCompare((PetscObject)A,MATSEQAIJ,&isseqaij);CHKERRQ(ierr);
+    if (isseqaij) {ierr = MatSeqAIJSetUpIdx16(A);CHKERRQ(ierr);}
+    else {ierr = MatSeqAIJResetIdx16(A);CHKERRQ(ierr);}
+  }
+#if defined(PETSC_HAVE_OPENMP)
+  if (a->omp.use && !A->factortype && !A->structure_only && a->omp.mat_nonzerostate != A->nonzerostate) {
+    PetscBool isseqaij;
+
+    /* subclasses of MATSEQAIJ provide their own MatMult() */
+    ierr = PetscObjectTypeCompare((PetscObject)A,MATSEQAIJ,&isseqaij);CHKERRQ(ierr);
+    if (isseqaij) {ierr = MatSeqAIJSetUpOpenMP(A);CHKERRQ(ierr);}
+  }
+#endif
   PetscFunctionReturn(0);
 }
 
@@ -1087,6 +1301,11 @@ PetscErrorCode MatDestroy_SeqAIJ(Mat A)
   PetscFunctionBegin;
 #if defined(PETSC_USE_LOG)
   PetscLogObjectState((PetscObject)A,"Rows=%D, Cols=%D, NZ=%D",A->rmap->n,A->cmap->n,a->nz);
+#endif
+#if defined(PETSC_HAVE_OPENMP)
+  if (a->omp.rstart) {
+    ierr = PetscInfo3(A,"OpenMP MatMult() with %D threads: nonzero imbalance %g, time imbalance %g (max/mean)\n",a->omp.nthreads,(double)a->omp.nzimbalance,(double)MatSeqAIJGetOpenMPTimeImbalance_Private(A));CHKERRQ(ierr);
+  }
 #endif
   ierr = MatSeqXAIJFreeAIJ(A,&a->a,&a->j,&a->i);CHKERRQ(ierr);
   ierr = ISDestroy(&a->row);CHKERRQ(ierr);
@@ -1102,6 +1321,12 @@ PetscErrorCode MatDestroy_SeqAIJ(Mat A)
   ierr = ISColoringDestroy(&a->coloring);CHKERRQ(ierr);
   ierr = PetscFree2(a->compressedrow.i,a->compressedrow.rindex);CHKERRQ(ierr);
   ierr = PetscFree(a->matmult_abdense);CHKERRQ(ierr);
+  ierr = PetscFree(a->coo_perm);CHKERRQ(ierr);
+  ierr = PetscFree(a->coo_jmap);CHKERRQ(ierr);
+  ierr = PetscFree3(a->omp.rstart,a->omp.nstart,a->omp.time);CHKERRQ(ierr);
+  ierr = PetscFree2(a->idx16.base,a->idx16.j);CHKERRQ(ierr);
+  ierr = MatSeqAIJResetSolveLevels(&a->levels);CHKERRQ(ierr);
+  ierr = PetscFree(a->chowpatel.work);CHKERRQ(ierr);
 
   ierr = MatDestroy_SeqAIJ_Inode(A);CHKERRQ(ierr);
   ierr = PetscFree(A->data);CHKERRQ(ierr);
@@ -1113,6 +1338,7 @@ PetscErrorCode MatDestroy_SeqAIJ(Mat A)
   ierr = PetscObjectComposeFunction((PetscObject)A,"MatConvert_seqaij_seqsbaij_C",NULL);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)A,"MatConvert_seqaij_seqbaij_C",NULL);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)A,"MatConvert_seqaij_seqaijperm_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)A,"MatConvert_seqaij_seqaijsingle_C",NULL);CHKERRQ(ierr);
 #if defined(PETSC_HAVE_ELEMENTAL)
   ierr = PetscObjectComposeFunction((PetscObject)A,"MatConvert_seqaij_elemental_C",NULL);CHKERRQ(ierr);
 #endif
@@ -1129,6 +1355,9 @@ PetscErrorCode MatDestroy_SeqAIJ(Mat A)
   ierr = PetscObjectComposeFunction((PetscObject)A,"MatSeqAIJSetPreallocationCSR_C",NULL);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)A,"MatReorderForNonzeroDiagonal_C",NULL);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)A,"MatPtAP_is_seqaij_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)A,"MatPtAP_seqaijsingle_seqaij_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)A,"MatSetPreallocationCOO_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)A,"MatSetValuesCOO_C",NULL);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
@@ -1168,9 +1397,11 @@ PetscErrorCode MatSetOption_SeqAIJ(Mat A,MatOption op,PetscBool flg)
   case MAT_STRUCTURE_ONLY:
     /* These options are handled directly by MatSetOption() */
     break;
+  case MAT_USE_HASH_TABLE:
+    a->usehash = flg;
+    break;
   case MAT_NEW_DIAGONALS:
   case MAT_IGNORE_OFF_PROC_ENTRIES:
-  case MAT_USE_HASH_TABLE:
     ierr = PetscInfo1(A,"Option %s ignored\n",MatOptions[op]);CHKERRQ(ierr);
     break;
   case MAT_USE_INODES:
@@ -1617,17 +1848,33 @@ PetscErrorCode MatMissingDiagonal_SeqAIJ(Mat A,PetscBool  *missing,PetscInt *d)
 #include <petscblaslapack.h>
 #include <petsc/private/kernels/blockinvert.h>
 
+/* copies the bs by bs diagonal block of A that starts at row and column start into v, in row major order */
+static PetscErrorCode MatGetBlockDiagonalValues_SeqAIJ_Private(Mat A,PetscInt start,PetscInt bs,MatScalar *v)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscErrorCode ierr;
+  PetscInt       i,k,col;
+
+  PetscFunctionBegin;
+  ierr = PetscMemzero(v,bs*bs*sizeof(MatScalar));CHKERRQ(ierr);
+  for (i=0; i<bs; i++) {
+    for (k=a->i[start+i]; k<a->i[start+i+1]; k++) {
+      col = a->j[k] - start;
+      if (col >= bs) break;
+      if (col >= 0) v[i*bs+col] = a->a[k];
+    }
+  }
+  PetscFunctionReturn(0);
+}
+
 /*
     Note that values is allocated externally by the PC and then passed into this routine
 */
 PetscErrorCode MatInvertVariableBlockDiagonal_SeqAIJ(Mat A,PetscInt nblocks,const PetscInt *bsizes,PetscScalar *diag)
 {
   PetscErrorCode  ierr;
-  PetscInt        n = A->rmap->n, i, ncnt = 0, *indx,j,bsizemax = 0,*v_pivots;
+  PetscInt        n = A->rmap->n,i,ncnt = 0,bs,bsizemax = 0,nb,*offsets,*boffsets;
   PetscBool       allowzeropivot,zeropivotdetected=PETSC_FALSE;
-  const PetscReal shift = 0.0;
-  PetscInt        ipvt[5];
-  PetscScalar     work[25],*v_work;
 
   PetscFunctionBegin;
   allowzeropivot = PetscNot(A->erroriffailure);
@@ -1636,60 +1883,25 @@ PetscErrorCode MatInvertVariableBlockDiagonal_SeqAIJ(Mat A,PetscInt nblocks,cons
   for (i=0; i<nblocks; i++) {
     bsizemax = PetscMax(bsizemax,bsizes[i]);
   }
-  ierr = PetscMalloc1(bsizemax,&indx);CHKERRQ(ierr);
-  if (bsizemax > 7) {
-    ierr = PetscMalloc2(bsizemax,&v_work,bsizemax,&v_pivots);CHKERRQ(ierr);
-  }
+  ierr = PetscMalloc2(nblocks,&offsets,nblocks,&boffsets);CHKERRQ(ierr);
   ncnt = 0;
+  nb   = 0;
   for (i=0; i<nblocks; i++) {
-    for (j=0; j<bsizes[i]; j++) indx[j] = ncnt+j;
-    ierr    = MatGetValues(A,bsizes[i],indx,bsizes[i],indx,diag);CHKERRQ(ierr);
-    switch (bsizes[i]) {
-    case 1:
-      *diag = 1.0/(*diag);
-      break;
-    case 2:
-      ierr  = PetscKernel_A_gets_inverse_A_2(diag,shift,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
-      if (zeropivotdetected) A->factorerrortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
-      ierr  = PetscKernel_A_gets_transpose_A_2(diag);CHKERRQ(ierr);
-      break;
-    case 3:
-      ierr  = PetscKernel_A_gets_inverse_A_3(diag,shift,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
-      if (zeropivotdetected) A->factorerrortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
-      ierr  = PetscKernel_A_gets_transpose_A_3(diag);CHKERRQ(ierr);
-      break;
-    case 4:
-      ierr  = PetscKernel_A_gets_inverse_A_4(diag,shift,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
-      if (zeropivotdetected) A->factorerrortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
-      ierr  = PetscKernel_A_gets_transpose_A_4(diag);CHKERRQ(ierr);
-      break;
-    case 5:
-      ierr  = PetscKernel_A_gets_inverse_A_5(diag,ipvt,work,shift,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
-      if (zeropivotdetected) A->factorerrortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
-      ierr  = PetscKernel_A_gets_transpose_A_5(diag);CHKERRQ(ierr);
-      break;
-    case 6:
-      ierr  = PetscKernel_A_gets_inverse_A_6(diag,shift,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
-      if (zeropivotdetected) A->factorerrortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
-      ierr  = PetscKernel_A_gets_transpose_A_6(diag);CHKERRQ(ierr);
-      break;
-    case 7:
-      ierr  = PetscKernel_A_gets_inverse_A_7(diag,shift,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
-      if (zeropivotdetected) A->factorerrortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
-      ierr  = PetscKernel_A_gets_transpose_A_7(diag);CHKERRQ(ierr);
-      break;
-    default:
-      ierr  = PetscKernel_A_gets_inverse_A(bsizes[i],diag,v_pivots,v_work,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
-      if (zeropivotdetected) A->factorerrortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
-      ierr  = PetscKernel_A_gets_transpose_A_N(diag,bsizes[i]);CHKERRQ(ierr);
-    }
-    ncnt   += bsizes[i];
-    diag += bsizes[i]*bsizes[i];
-  }
-  if (bsizemax > 7) {
-    ierr = PetscFree2(v_work,v_pivots);CHKERRQ(ierr);
-  }
-  ierr = PetscFree(indx);CHKERRQ(ierr);
+    offsets[i] = nb;
+    ierr       = MatGetBlockDiagonalValues_SeqAIJ_Private(A,ncnt,bsizes[i],diag+nb);CHKERRQ(ierr);
+    if (bsizes[i] == 1) diag[nb] = 1.0/diag[nb];
+    ncnt += bsizes[i];
+    nb   += bsizes[i]*bsizes[i];
+  }
+  /* the blocks of each size are inverted together */
+  for (bs=2; bs<=bsizemax; bs++) {
+    for (i=0,nb=0; i<nblocks; i++) {
+      if (bsizes[i] == bs) boffsets[nb++] = offsets[i];
+    }
+    ierr = PetscKernel_A_gets_inverse_A_Batch(bs,nb,boffsets,diag,PETSC_TRUE,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
+    if (zeropivotdetected) A->factorerrortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
+  }
+  ierr = PetscFree2(offsets,boffsets);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
@@ -2848,10 +3060,31 @@ PetscErrorCode MatCopy_SeqAIJ(Mat A,Mat B,MatStructure str)
 
 PetscErrorCode MatSetUp_SeqAIJ(Mat A)
 {
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscInt       nonew = a->nonew;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (a->usehash) {
+    /* empty storage, the actual one is allocated from the hash table in MatAssemblyEnd() */
+    ierr     = MatSeqAIJSetPreallocation_SeqAIJ(A,0,NULL);CHKERRQ(ierr);
+    a->nonew = nonew;
+    ierr     = MatAIJSetUpHash_Private(A,a->roworiented,a->ignorezeroentries,PETSC_TRUE,MatHashFill_SeqAIJ);CHKERRQ(ierr);
+  } else {
+    ierr = MatSeqAIJSetPreallocation_SeqAIJ(A,PETSC_DEFAULT,0);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatSetFromOptions_SeqAIJ(PetscOptionItems *PetscOptionsObject,Mat A)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
   PetscErrorCode ierr;
 
   PetscFunctionBegin;
-  ierr =  MatSeqAIJSetPreallocation_SeqAIJ(A,PETSC_DEFAULT,0);CHKERRQ(ierr);
+  ierr = PetscOptionsHead(PetscOptionsObject,"SeqAIJ options");CHKERRQ(ierr);
+  ierr = PetscOptionsBool("-mat_use_hash_table","Assemble through a hash table when the matrix is not preallocated","MatSetOption",a->usehash,&a->usehash,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsTail();CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
@@ -3126,8 +3359,8 @@ PetscErrorCode MatInvertBlockDiagonal_SeqAIJ(Mat A,const PetscScalar **values)
 {
   Mat_SeqAIJ      *a = (Mat_SeqAIJ*) A->data;
   PetscErrorCode  ierr;
-  PetscInt        i,bs = PetscAbs(A->rmap->bs),mbs = A->rmap->n/bs,ipvt[5],bs2 = bs*bs,*v_pivots,ij[7],*IJ,j;
-  MatScalar       *diag,work[25],*v_work;
+  PetscInt        i,bs = PetscAbs(A->rmap->bs),mbs = A->rmap->n/bs,bs2 = bs*bs;
+  MatScalar       *diag;
   const PetscReal shift = 0.0;
   PetscBool       allowzeropivot,zeropivotdetected=PETSC_FALSE;
 
@@ -3160,79 +3393,13 @@ PetscErrorCode MatInvertBlockDiagonal_SeqAIJ(Mat A,const PetscScalar **values)
       diag[i] = (PetscScalar)1.0 / (diag[i] + shift);
     }
     break;
-  case 2:
-    for (i=0; i<mbs; i++) {
-      ij[0] = 2*i; ij[1] = 2*i + 1;
-      ierr  = MatGetValues(A,2,ij,2,ij,diag);CHKERRQ(ierr);
-      ierr  = PetscKernel_A_gets_inverse_A_2(diag,shift,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
-      if (zeropivotdetected) A->factorerrortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
-      ierr  = PetscKernel_A_gets_transpose_A_2(diag);CHKERRQ(ierr);
-      diag += 4;
-    }
-    break;
-  case 3:
-    for (i=0; i<mbs; i++) {
-      ij[0] = 3*i; ij[1] = 3*i + 1; ij[2] = 3*i + 2;
-      ierr  = MatGetValues(A,3,ij,3,ij,diag);CHKERRQ(ierr);
-      ierr  = PetscKernel_A_gets_inverse_A_3(diag,shift,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
-      if (zeropivotdetected) A->factorerrortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
-      ierr  = PetscKernel_A_gets_transpose_A_3(diag);CHKERRQ(ierr);
-      diag += 9;
-    }
-    break;
-  case 4:
-    for (i=0; i<mbs; i++) {
-      ij[0] = 4*i; ij[1] = 4*i + 1; ij[2] = 4*i + 2; ij[3] = 4*i + 3;
-      ierr  = MatGetValues(A,4,ij,4,ij,diag);CHKERRQ(ierr);
-      ierr  = PetscKernel_A_gets_inverse_A_4(diag,shift,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
-      if (zeropivotdetected) A->factorerrortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
-      ierr  = PetscKernel_A_gets_transpose_A_4(diag);CHKERRQ(ierr);
-      diag += 16;
-    }
-    break;
-  case 5:
-    for (i=0; i<mbs; i++) {
-      ij[0] = 5*i; ij[1] = 5*i + 1; ij[2] = 5*i + 2; ij[3] = 5*i + 3; ij[4] = 5*i + 4;
-      ierr  = MatGetValues(A,5,ij,5,ij,diag);CHKERRQ(ierr);
-      ierr  = PetscKernel_A_gets_inverse_A_5(diag,ipvt,work,shift,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
-      if (zeropivotdetected) A->factorerrortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
-      ierr  = PetscKernel_A_gets_transpose_A_5(diag);CHKERRQ(ierr);
-      diag += 25;
-    }
-    break;
-  case 6:
-    for (i=0; i<mbs; i++) {
-      ij[0] = 6*i; ij[1] = 6*i + 1; ij[2] = 6*i + 2; ij[3] = 6*i + 3; ij[4] = 6*i + 4; ij[5] = 6*i + 5;
-      ierr  = MatGetValues(A,6,ij,6,ij,diag);CHKERRQ(ierr);
-      ierr  = PetscKernel_A_gets_inverse_A_6(diag,shift,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
-      if (zeropivotdetected) A->factorerrortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
-      ierr  = PetscKernel_A_gets_transpose_A_6(diag);CHKERRQ(ierr);
-      diag += 36;
-    }
-    break;
-  case 7:
-    for (i=0; i<mbs; i++) {
-      ij[0] = 7*i; ij[1] = 7*i + 1; ij[2] = 7*i + 2; ij[3] = 7*i + 3; ij[4] = 7*i + 4; ij[5] = 7*i + 5; ij[5] = 7*i + 6;
-      ierr  = MatGetValues(A,7,ij,7,ij,diag);CHKERRQ(ierr);
-      ierr  = PetscKernel_A_gets_inverse_A_7(diag,shift,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
-      if (zeropivotdetected) A->factorerrortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
-      ierr  = PetscKernel_A_gets_transpose_A_7(diag);CHKERRQ(ierr);
-      diag += 49;
-    }
-    break;
   default:
-    ierr = PetscMalloc3(bs,&v_work,bs,&v_pivots,bs,&IJ);CHKERRQ(ierr);
+    /* the blocks are inverted together */
     for (i=0; i<mbs; i++) {
-      for (j=0; j<bs; j++) {
-        IJ[j] = bs*i + j;
-      }
-      ierr  = MatGetValues(A,bs,IJ,bs,IJ,diag);CHKERRQ(ierr);
-      ierr  = PetscKernel_A_gets_inverse_A(bs,diag,v_pivots,v_work,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
-      if (zeropivotdetected) A->factorerrortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
-      ierr  = PetscKernel_A_gets_transpose_A_N(diag,bs);CHKERRQ(ierr);
-      diag += bs2;
+      ierr = MatGetBlockDiagonalValues_SeqAIJ_Private(A,bs*i,bs,diag+bs2*i);CHKERRQ(ierr);
     }
-    ierr = PetscFree3(v_work,v_pivots,IJ);CHKERRQ(ierr);
+    ierr = PetscKernel_A_gets_inverse_A_Batch(bs,mbs,NULL,diag,PETSC_TRUE,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
+    if (zeropivotdetected) A->factorerrortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
   }
   a->ibdiagvalid = PETSC_TRUE;
   PetscFunctionReturn(0);
@@ -3338,7 +3505,7 @@ static struct _MatOps MatOps_Values = { MatSetValues_SeqAIJ,
                                         0,
                                 /* 74*/ 0,
                                         MatFDColoringApply_AIJ,
-                                        0,
+                                        MatSetFromOptions_SeqAIJ,
                                         0,
                                         0,
                                 /* 79*/ MatFindZeroDiagonals_SeqAIJ,
@@ -4064,7 +4231,22 @@ PETSC_INTERN PetscErrorCode MatMatMult_SeqDense_SeqAIJ(Mat A,Mat B,MatReuse scal
    based on compressed sparse row format.
 
    Options Database Keys:
-. -mat_type seqaij - sets the matrix type to "seqaij" during a call to MatSetFromOptions()
++ -mat_type seqaij - sets the matrix type to "seqaij" during a call to MatSetFromOptions()
+. -mat_aij_compress_indices - store the column indices as 16 bit offsets from the first column of each row for MatMult(), MatMultTranspose() and MatSOR()
+. -mat_aij_openmp - use OpenMP threads in MatMult() and MatMultAdd(), only available if PETSc was configured with OpenMP
+- -mat_aij_openmp_threads <n> - number of threads to use, defaults to the OpenMP maximum
+
+  Notes:
+    With -mat_aij_openmp the rows are split into one chunk per thread with about the same number of nonzeros and the matrix
+    storage is recopied by the threads after each assembly that changes the nonzero structure, so that with a first-touch
+    page placement each thread works on local memory. Bind the threads to cores (for example with OMP_PROC_BIND=true) to keep
+    this placement. The nonzero and timing imbalance of the threads are shown by MatView() with PETSC_VIEWER_ASCII_INFO.
+
+    With -mat_aij_compress_indices a second copy of the column indices, using 2 bytes per nonzero instead of sizeof(PetscInt),
+    is built after each assembly that changes the nonzero structure and read by the products and the SOR sweeps, which are
+    limited by memory bandwidth. It is only used if no row spans more than 65536 columns, as with most banded or locally
+    numbered meshes; otherwise the usual kernels are kept. It replaces the inode MatMult() but not the inode MatSOR(), and
+    -mat_aij_openmp takes precedence for MatMult().
 
   Level: beginner
 
@@ -4081,10 +4263,12 @@ M*/
   the above preallocation routines for simplicity.
 
    Options Database Keys:
-. -mat_type aij - sets the matrix type to "aij" during a call to MatSetFromOptions()
++ -mat_type aij - sets the matrix type to "aij" during a call to MatSetFromOptions()
+. -mat_aij_compress_indices - use 16 bit column indices in the products of the sequential matrices or the local blocks, see MATSEQAIJ
+- -mat_aij_openmp - use OpenMP threads in the MatMult() of the sequential matrices or the local blocks, see MATSEQAIJ
 
   Developer Notes:
-    Subclasses include MATAIJCUSPARSE, MATAIJPERM, MATAIJSELL, MATAIJMKL, MATAIJCRL, and also automatically switches over to use inodes when
+    Subclasses include MATAIJCUSPARSE, MATAIJPERM, MATAIJSELL, MATAIJSINGLE, MATAIJMKL, MATAIJCRL, and also automatically switches over to use inodes when
    enough exist.
 
   Level: beginner
@@ -4249,6 +4433,7 @@ PETSC_EXTERN PetscErrorCode MatCreate_SeqAIJ(Mat B)
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqaij_seqbaij_C",MatConvert_SeqAIJ_SeqBAIJ);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqaij_seqaijperm_C",MatConvert_SeqAIJ_SeqAIJPERM);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqaij_seqaijsell_C",MatConvert_SeqAIJ_SeqAIJSELL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqaij_seqaijsingle_C",MatConvert_SeqAIJ_SeqAIJSingle);CHKERRQ(ierr);
 #if defined(PETSC_HAVE_MKL_SPARSE)
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqaij_seqaijmkl_C",MatConvert_SeqAIJ_SeqAIJMKL);CHKERRQ(ierr);
 #endif
@@ -4276,7 +4461,14 @@ PETSC_EXTERN PetscErrorCode MatCreate_SeqAIJ(Mat B)
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatMatMultSymbolic_seqdense_seqaij_C",MatMatMultSymbolic_SeqDense_SeqAIJ);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatMatMultNumeric_seqdense_seqaij_C",MatMatMultNumeric_SeqDense_SeqAIJ);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatPtAP_is_seqaij_C",MatPtAP_IS_XAIJ);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatPtAP_seqaijsingle_seqaij_C",MatPtAP_SeqAIJSingle_SeqAIJ);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatSetPreallocationCOO_C",MatSetPreallocationCOO_SeqAIJ);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatSetValuesCOO_C",MatSetValuesCOO_SeqAIJ);CHKERRQ(ierr);
   ierr = MatCreate_SeqAIJ_Inode(B);CHKERRQ(ierr);
+  ierr = MatCreate_SeqAIJ_Idx16(B);CHKERRQ(ierr);
+#if defined(PETSC_HAVE_OPENMP)
+  ierr = MatCreate_SeqAIJ_OpenMP(B);CHKERRQ(ierr);
+#endif
   ierr = PetscObjectChangeTypeName((PetscObject)B,MATSEQAIJ);CHKERRQ(ierr);
   ierr = MatSeqAIJSetTypeFromOptions(B);CHKERRQ(ierr);  /* this allows changing the matrix subtype to say MATSEQAIJPERM */
   PetscFunctionReturn(0);
@@ -4371,6 +4563,31 @@ PetscErrorCode MatDuplicateNoCreate_SeqAIJ(Mat C,Mat A,MatDuplicateOption cpvalu
 
   ierr = MatDuplicate_SeqAIJ_Inode(A,cpvalues,&C);CHKERRQ(ierr);
   ierr = PetscFunctionListDuplicate(((PetscObject)A)->qlist,&((PetscObject)C)->qlist);CHKERRQ(ierr);
+  c->idx16.use = a->idx16.use;
+  if (c->idx16.use && mallocmatspace && !C->factortype) {
+    PetscBool isseqaij;
+
+    ierr = PetscObjectTypeCompare((PetscObject)C,MATSEQAIJ,&isseqaij);CHKERRQ(ierr);
+    if (isseqaij) {ierr = MatSeqAIJSetUpIdx16(C);CHKERRQ(ierr);}
+  }
+  /* the duplicate of a factor computes its own level schedule at its first MatSolve() */
+  if (A->factortype) {
+    c->levels.use         = a->levels.use;
+    c->levels.nthreads    = a->levels.nthreads;
+    c->chowpatel.sweeps   = a->chowpatel.sweeps;
+    c->chowpatel.jacobi   = a->chowpatel.jacobi;
+    c->chowpatel.nthreads = a->chowpatel.nthreads;
+  }
+#if defined(PETSC_HAVE_OPENMP)
+  c->omp.use      = a->omp.use;
+  c->omp.nthreads = a->omp.nthreads;
+  if (c->omp.use && mallocmatspace && !C->factortype) {
+    PetscBool isseqaij;
+
+    ierr = PetscObjectTypeCompare((PetscObject)C,MATSEQAIJ,&isseqaij);CHKERRQ(ierr);
+    if (isseqaij) {ierr = MatSeqAIJSetUpOpenMP(C);CHKERRQ(ierr);}
+  }
+#endif
   PetscFunctionReturn(0);
 }
 
@@ -4695,6 +4912,113 @@ PetscErrorCode MatSeqAIJInvalidateDiagonal(Mat A)
   PetscFunctionReturn(0);
 }
 
+/*
+   Called after the values, but not the nonzero pattern, of a SeqAIJ matrix have been changed directly in a->a
+*/
+PetscErrorCode MatSeqAIJValuesChanged_Private(Mat A)
+{
+  PetscBool      isseqaij;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectTypeCompare((PetscObject)A,MATSEQAIJ,&isseqaij);CHKERRQ(ierr);
+  if (isseqaij) {
+    ierr = MatSeqAIJInvalidateDiagonal(A);CHKERRQ(ierr);
+  } else { /* derived types may keep their own copy of the values, let them update it */
+    ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+    ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  }
+  ierr = PetscObjectStateIncrease((PetscObject)A);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*
+   The entries are bucket sorted by row and then sorted by column within each row, carrying along their position
+   in the COO list; the nonzeros of the matrix are the distinct (i,j) pairs
+*/
+PetscErrorCode MatSetPreallocationCOO_SeqAIJ(Mat A,PetscInt ncoo,const PetscInt coo_i[],const PetscInt coo_j[])
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscInt       k,p,r,m = A->rmap->n,n = A->cmap->n,nz,nvalid,*rowptr,*next,*cols,*perm,*jmap;
+  PetscScalar    *zeros;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscFree(a->coo_perm);CHKERRQ(ierr);
+  ierr = PetscFree(a->coo_jmap);CHKERRQ(ierr);
+  ierr = PetscCalloc2(m+1,&rowptr,m+1,&next);CHKERRQ(ierr);
+  for (k=0; k<ncoo; k++) {
+    if (coo_i[k] < 0 || coo_j[k] < 0) continue;
+    if (coo_i[k] >= m) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Row too large: row %D max %D",coo_i[k],m-1);
+    if (coo_j[k] >= n) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Column too large: col %D max %D",coo_j[k],n-1);
+    rowptr[coo_i[k]+1]++;
+  }
+  for (r=0; r<m; r++) {
+    rowptr[r+1] += rowptr[r];
+    next[r]      = rowptr[r];
+  }
+  nvalid = rowptr[m];
+  ierr   = PetscMalloc1(nvalid,&cols);CHKERRQ(ierr);
+  ierr   = PetscMalloc1(nvalid,&perm);CHKERRQ(ierr);
+  ierr   = PetscMalloc1(nvalid+1,&jmap);CHKERRQ(ierr);
+  for (k=0; k<ncoo; k++) {
+    if (coo_i[k] < 0 || coo_j[k] < 0) continue;
+    p       = next[coo_i[k]]++;
+    cols[p] = coo_j[k];
+    perm[p] = k;
+  }
+  for (r=0; r<m; r++) {
+    ierr = PetscSortIntWithArray(rowptr[r+1]-rowptr[r],cols+rowptr[r],perm+rowptr[r]);CHKERRQ(ierr);
+  }
+
+  /* merge repeated entries, compressing cols[] in place; next[] becomes the row pointer of the distinct entries */
+  for (r=0,nz=0; r<m; r++) {
+    next[r] = nz;
+    for (p=rowptr[r]; p<rowptr[r+1]; p++) {
+      if (p > rowptr[r] && cols[p] == cols[p-1]) continue;
+      jmap[nz]   = p;
+      cols[nz++] = cols[p];
+    }
+  }
+  next[m]  = nz;
+  jmap[nz] = nvalid;
+  ierr = PetscInfo3(A,"%D COO entries, %D ignored, %D distinct nonzeros\n",ncoo,ncoo-nvalid,nz);CHKERRQ(ierr);
+
+  ierr = PetscCalloc1(nz,&zeros);CHKERRQ(ierr);
+  ierr = MatHashFill_SeqAIJ(A,next,cols,zeros);CHKERRQ(ierr);
+  ierr = PetscFree(zeros);CHKERRQ(ierr);
+  ierr = PetscFree(cols);CHKERRQ(ierr);
+  ierr = PetscFree2(rowptr,next);CHKERRQ(ierr);
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+
+  a->coo_perm         = perm;
+  a->coo_jmap         = jmap;
+  a->coo_nonzerostate = A->nonzerostate;
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatSetValuesCOO_SeqAIJ(Mat A,const PetscScalar v[],InsertMode imode)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscInt       k,q,nz = a->nz;
+  const PetscInt *perm = a->coo_perm,*jmap = a->coo_jmap;
+  MatScalar      *aa = a->a;
+  PetscScalar    sum;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (!jmap) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONGSTATE,"Must call MatSetPreallocationCOO() first");
+  if (a->coo_nonzerostate != A->nonzerostate) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONGSTATE,"The nonzero pattern has changed since MatSetPreallocationCOO()");
+  for (k=0; k<nz; k++) {
+    sum = 0.0;
+    for (q=jmap[k]; q<jmap[k+1]; q++) sum += v[perm[q]];
+    aa[k] = (imode == INSERT_VALUES) ? sum : aa[k] + sum;
+  }
+  ierr = MatSeqAIJValuesChanged_Private(A);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 PetscErrorCode MatCreateMPIMatConcatenateSeqMat_SeqAIJ(MPI_Comm comm,Mat inmat,PetscInt n,MatReuse scall,Mat *outmat)
 {
   PetscErrorCode ierr;
@@ -4889,6 +5213,7 @@ PetscErrorCode  MatSeqAIJRegisterAll(void)
   ierr = MatSeqAIJRegister(MATSEQAIJCRL,      MatConvert_SeqAIJ_SeqAIJCRL);CHKERRQ(ierr);
   ierr = MatSeqAIJRegister(MATSEQAIJPERM,     MatConvert_SeqAIJ_SeqAIJPERM);CHKERRQ(ierr);
   ierr = MatSeqAIJRegister(MATSEQAIJSELL,     MatConvert_SeqAIJ_SeqAIJSELL);CHKERRQ(ierr);
+  ierr = MatSeqAIJRegister(MATSEQAIJSINGLE,   MatConvert_SeqAIJ_SeqAIJSingle);CHKERRQ(ierr);
 #if defined(PETSC_HAVE_MKL_SPARSE)
   ierr = MatSeqAIJRegister(MATSEQAIJMKL,      MatConvert_SeqAIJ_SeqAIJMKL);CHKERRQ(ierr);
 #endif
@@ -107,9 +107,78 @@ PETSC_INTERN PetscErrorCode MatDuplicateNoCreate_SeqAIJ(Mat,Mat,MatDuplicateOpti
 PETSC_INTERN PetscErrorCode MatLUFactorNumeric_SeqAIJ_Inode_inplace(Mat,Mat,const MatFactorInfo*);
 PETSC_INTERN PetscErrorCode MatLUFactorNumeric_SeqAIJ_Inode(Mat,Mat,const MatFactorInfo*);
 
+/* Info about the threaded MatMult() for SeqAIJ, see -mat_aij_openmp */
+typedef struct {
+  PetscBool        use;                            /* use the OpenMP version of MatMult() and MatMultAdd() */
+  PetscInt         nthreads;                       /* number of threads to use */
+  PetscInt         *rstart;                        /* thread t multiplies the rows rstart[t] <= row < rstart[t+1] */
+  PetscInt         *nstart;                        /* and, with the inode routines, the inodes nstart[t] <= node < nstart[t+1] */
+  PetscLogDouble   *time;                          /* time spent by each thread in MatMult() and MatMultAdd() */
+  PetscReal        nzimbalance;                    /* largest over mean number of nonzeros of the threads */
+  PetscObjectState mat_nonzerostate;               /* non-zero state when the rows were partitioned */
+} Mat_SeqAIJ_OpenMP;
+
+PETSC_INTERN PetscErrorCode MatSeqAIJSetUpOpenMP(Mat);
+PETSC_INTERN PetscErrorCode MatMult_SeqAIJ_OpenMP(Mat,Vec,Vec);
+PETSC_INTERN PetscErrorCode MatMultAdd_SeqAIJ_OpenMP(Mat,Vec,Vec,Vec);
+PETSC_INTERN PetscErrorCode MatMult_SeqAIJ_Inode_OpenMP(Mat,Vec,Vec);
+PETSC_INTERN PetscErrorCode MatMultAdd_SeqAIJ_Inode_OpenMP(Mat,Vec,Vec,Vec);
+
+/* Info about the column indices stored as 16 bit offsets from the first column of each row, see -mat_aij_compress_indices */
+typedef struct {
+  PetscBool        use;                            /* compress the column indices at assembly if every row allows it */
+  PetscInt         *base;                          /* column of the first nonzero of each row */
+  unsigned short   *j;                             /* j[k] = a->j[k] - base[row], set only if the indices were compressed */
+  PetscObjectState mat_nonzerostate;               /* non-zero state when the indices were compressed */
+} Mat_SeqAIJ_Idx16;
+
+PETSC_INTERN PetscErrorCode MatCreate_SeqAIJ_Idx16(Mat);
+PETSC_INTERN PetscErrorCode MatSeqAIJSetUpIdx16(Mat);
+PETSC_INTERN PetscErrorCode MatSeqAIJResetIdx16(Mat);
+PETSC_INTERN PetscErrorCode MatView_SeqAIJ_Idx16(Mat,PetscViewer);
+PETSC_INTERN PetscErrorCode MatMult_SeqAIJ_Idx16(Mat,Vec,Vec);
+PETSC_INTERN PetscErrorCode MatMultAdd_SeqAIJ_Idx16(Mat,Vec,Vec,Vec);
+PETSC_INTERN PetscErrorCode MatMultTranspose_SeqAIJ_Idx16(Mat,Vec,Vec);
+PETSC_INTERN PetscErrorCode MatMultTransposeAdd_SeqAIJ_Idx16(Mat,Vec,Vec,Vec);
+PETSC_INTERN PetscErrorCode MatSOR_SeqAIJ_Idx16(Mat,Vec,PetscReal,MatSORType,PetscReal,PetscInt,PetscInt,Vec);
+
+/* Info about the level scheduled MatSolve() of a SeqAIJ LU or ICC factor, see -mat_aij_solve_levels */
+typedef struct {
+  PetscBool        use;                            /* compute a level schedule after the numeric factorization and solve level by level */
+  PetscInt         nthreads;                       /* number of threads that share the rows of each level */
+  PetscInt         nlevels[2];                     /* number of levels of the forward and the backward solve */
+  PetscInt         *start[2];                      /* the rows of level l of the forward (backward) solve are rows[0 (1)][start[0 (1)][l]] to rows[0 (1)][start[0 (1)][l+1]-1] */
+  PetscInt         *rows[2];
+  PetscInt         *ti,*tj,*ta;                    /* ICC factors only: the strict upper triangle by columns, column k has the values a[ta[ti[k]:ti[k+1]]] in the rows tj[ti[k]:ti[k+1]] */
+} Mat_SeqAIJ_Levels;
+
+PETSC_INTERN PetscErrorCode MatGetFactor_SeqAIJ_Levels(Mat,Mat_SeqAIJ_Levels*);
+PETSC_INTERN PetscErrorCode MatSeqAIJResetSolveLevels(Mat_SeqAIJ_Levels*);
+PETSC_INTERN PetscErrorCode MatSeqAIJSetUpSolveLevels(Mat);
+PETSC_INTERN PetscErrorCode MatView_SeqAIJ_Levels(Mat,Mat_SeqAIJ_Levels*,PetscViewer);
+PETSC_INTERN PetscErrorCode MatSolve_SeqAIJ_Levels(Mat,Vec,Vec);
+
+/* Info about the fine-grained iterative ILU of Chow and Patel and the Jacobi triangular solves, see -mat_aij_chowpatel_sweeps */
+typedef struct {
+  PetscInt         sweeps;                         /* number of fixed point sweeps that compute the values of an ILU factor, 0 for the usual elimination */
+  PetscInt         jacobi;                         /* number of Jacobi iterations that approximate each triangular solve, 0 for the exact solves */
+  PetscInt         nthreads;                       /* number of threads used by the sweeps and the Jacobi iterations */
+  PetscScalar      *work;                          /* work space of the Jacobi solves */
+} Mat_SeqAIJ_ChowPatel;
+
+PETSC_INTERN PetscErrorCode MatGetFactor_SeqAIJ_ChowPatel(Mat,Mat);
+PETSC_INTERN PetscErrorCode MatSeqAIJSetUpChowPatel(Mat);
+PETSC_INTERN PetscErrorCode MatView_SeqAIJ_ChowPatel(Mat,PetscViewer);
+PETSC_INTERN PetscErrorCode MatLUFactorNumeric_SeqAIJ_ChowPatel(Mat,Mat,const MatFactorInfo*);
+PETSC_INTERN PetscErrorCode MatSolve_SeqAIJ_Jacobi(Mat,Vec,Vec);
+
 typedef struct {
   SEQAIJHEADER(MatScalar);
   Mat_SeqAIJ_Inode inode;
+  Mat_SeqAIJ_OpenMP omp;
+  Mat_SeqAIJ_Idx16 idx16;
+  Mat_SeqAIJ_Levels levels;
+  Mat_SeqAIJ_ChowPatel chowpatel;
   MatScalar        *saved_values;             /* location for stashing nonzero values of matrix */
 
   PetscScalar *idiag,*mdiag,*ssor_work;       /* inverse of diagonal entries, diagonal values and workspace for Eisenstat trick */
@@ -127,6 +196,12 @@ typedef struct {
   Mat_RARt            *rart;               /* used by MatRARt() */
   Mat_MatMatTransMult *abt;                /* used by MatMatTransposeMult() */
   Mat_MatTransMatMult *atb;                /* used by MatTransposeMatMult() */
+
+  PetscBool           usehash;             /* assemble through a hash table if not preallocated, see MAT_USE_HASH_TABLE */
+
+  /* used by MatSetValuesCOO(): the values of nonzero k are coo_v[coo_perm[coo_jmap[k]:coo_jmap[k+1]]] */
+  PetscInt            *coo_perm,*coo_jmap;
+  PetscObjectState    coo_nonzerostate;    /* nonzero state for which the above were computed */
 } Mat_SeqAIJ;
 
 /*
@@ -214,6 +289,10 @@ PETSC_STATIC_INLINE PetscErrorCode MatSeqXAIJFreeAIJ(Mat AA,MatScalar **a,PetscI
   } \
 
 PETSC_INTERN PetscErrorCode MatSeqAIJSetPreallocation_SeqAIJ(Mat,PetscInt,const PetscInt*);
+PETSC_INTERN PetscErrorCode MatAIJSetUpHash_Private(Mat,PetscBool,PetscBool,PetscBool,PetscErrorCode (*)(Mat,const PetscInt[],const PetscInt[],const PetscScalar[]));
+PETSC_INTERN PetscErrorCode MatHashFill_SeqAIJ(Mat,const PetscInt[],const PetscInt[],const PetscScalar[]);
+PETSC_INTERN PetscErrorCode MatSetPreallocationCOO_SeqAIJ(Mat,PetscInt,const PetscInt[],const PetscInt[]);
+PETSC_INTERN PetscErrorCode MatSetValuesCOO_SeqAIJ(Mat,const PetscScalar[],InsertMode);
 PETSC_INTERN PetscErrorCode MatILUFactorSymbolic_SeqAIJ_inplace(Mat,Mat,IS,IS,const MatFactorInfo*);
 PETSC_INTERN PetscErrorCode MatILUFactorSymbolic_SeqAIJ(Mat,Mat,IS,IS,const MatFactorInfo*);
 PETSC_INTERN PetscErrorCode MatILUFactorSymbolic_SeqAIJ_ilu0(Mat,Mat,IS,IS,const MatFactorInfo*);
@@ -228,6 +307,7 @@ PETSC_INTERN PetscErrorCode MatDuplicate_SeqAIJ(Mat,MatDuplicateOption,Mat*);
 PETSC_INTERN PetscErrorCode MatCopy_SeqAIJ(Mat,Mat,MatStructure);
 PETSC_INTERN PetscErrorCode MatMissingDiagonal_SeqAIJ(Mat,PetscBool*,PetscInt*);
 PETSC_INTERN PetscErrorCode MatMarkDiagonal_SeqAIJ(Mat);
+PETSC_INTERN PetscErrorCode MatSeqAIJRestoreArray_SeqAIJ(Mat,PetscScalar*[]);
 PETSC_INTERN PetscErrorCode MatFindZeroDiagonals_SeqAIJ_Private(Mat,PetscInt*,PetscInt**);
 
 PETSC_INTERN PetscErrorCode MatMult_SeqAIJ(Mat A,Vec,Vec);
@@ -235,6 +315,7 @@ PETSC_INTERN PetscErrorCode MatMultAdd_SeqAIJ(Mat A,Vec,Vec,Vec);
 PETSC_INTERN PetscErrorCode MatMultTranspose_SeqAIJ(Mat A,Vec,Vec);
 PETSC_INTERN PetscErrorCode MatMultTransposeAdd_SeqAIJ(Mat A,Vec,Vec,Vec);
 PETSC_INTERN PetscErrorCode MatSOR_SeqAIJ(Mat,Vec,PetscReal,MatSORType,PetscReal,PetscInt,PetscInt,Vec);
+PETSC_INTERN PetscErrorCode MatInvertDiagonal_SeqAIJ(Mat,PetscScalar,PetscScalar);
 
 PETSC_INTERN PetscErrorCode MatSetOption_SeqAIJ(Mat,MatOption,PetscBool);
 
@@ -285,6 +366,7 @@ PETSC_INTERN PetscErrorCode MatMatMultSymbolic_SeqAIJ_SeqAIJ_Heap(Mat,Mat,PetscR
 PETSC_INTERN PetscErrorCode MatMatMultSymbolic_SeqAIJ_SeqAIJ_BTHeap(Mat,Mat,PetscReal,Mat*);
 PETSC_INTERN PetscErrorCode MatMatMultSymbolic_SeqAIJ_SeqAIJ_RowMerge(Mat,Mat,PetscReal,Mat*);
 PETSC_INTERN PetscErrorCode MatMatMultSymbolic_SeqAIJ_SeqAIJ_LLCondensed(Mat,Mat,PetscReal,Mat*);
+PETSC_INTERN PetscErrorCode MatMatMultSymbolic_SeqAIJ_SeqAIJ_Hash(Mat,Mat,PetscReal,Mat*);
 #if defined(PETSC_HAVE_HYPRE)
 PETSC_INTERN PetscErrorCode MatMatMultSymbolic_AIJ_AIJ_wHYPRE(Mat,Mat,PetscReal,Mat*);
 #endif
@@ -293,6 +375,7 @@ PETSC_INTERN PetscErrorCode MatMatMultNumeric_SeqAIJ_SeqAIJ(Mat,Mat,Mat);
 PETSC_INTERN PetscErrorCode MatMatMultNumeric_SeqAIJ_SeqAIJ_Sorted(Mat,Mat,Mat);
 PETSC_INTERN PetscErrorCode MatMatMultNumeric_SeqDense_SeqAIJ(Mat,Mat,Mat);
 PETSC_INTERN PetscErrorCode MatMatMultNumeric_SeqAIJ_SeqAIJ_Scalable(Mat,Mat,Mat);
+PETSC_INTERN PetscErrorCode MatMatMultNumeric_SeqAIJ_SeqAIJ_Hash(Mat,Mat,Mat);
 PETSC_INTERN PetscErrorCode MatMatMultNumeric_SeqAIJ_SeqAIJ_Combined(Mat,Mat,Mat);
 
 PETSC_INTERN PetscErrorCode MatPtAP_SeqAIJ_SeqAIJ(Mat,Mat,MatReuse,PetscReal,Mat*);
@@ -345,6 +428,7 @@ PETSC_INTERN PetscErrorCode MatSetUp_SeqAIJ(Mat);
 PETSC_INTERN PetscErrorCode MatView_SeqAIJ(Mat,PetscViewer);
 
 PETSC_INTERN PetscErrorCode MatSeqAIJInvalidateDiagonal(Mat);
+PETSC_INTERN PetscErrorCode MatSeqAIJValuesChanged_Private(Mat);
 PETSC_INTERN PetscErrorCode MatSeqAIJInvalidateDiagonal_Inode(Mat);
 PETSC_INTERN PetscErrorCode MatSeqAIJCheckInode(Mat);
 PETSC_INTERN PetscErrorCode MatSeqAIJCheckInode_FactorLU(Mat);
@@ -364,6 +448,8 @@ PETSC_INTERN PetscErrorCode MatConvert_SeqAIJ_Elemental(Mat,MatType,MatReuse,Mat
 PETSC_INTERN PetscErrorCode MatConvert_AIJ_HYPRE(Mat,MatType,MatReuse,Mat*);
 PETSC_INTERN PetscErrorCode MatConvert_SeqAIJ_SeqAIJPERM(Mat,MatType,MatReuse,Mat*);
 PETSC_INTERN PetscErrorCode MatConvert_SeqAIJ_SeqAIJSELL(Mat,MatType,MatReuse,Mat*);
+PETSC_INTERN PetscErrorCode MatConvert_SeqAIJ_SeqAIJSingle(Mat,MatType,MatReuse,Mat*);
+PETSC_INTERN PetscErrorCode MatPtAP_SeqAIJSingle_SeqAIJ(Mat,Mat,MatReuse,PetscReal,Mat*);
 PETSC_INTERN PetscErrorCode MatConvert_SeqAIJ_SeqAIJMKL(Mat,MatType,MatReuse,Mat*);
 PETSC_INTERN PetscErrorCode MatConvert_SeqAIJ_SeqAIJViennaCL(Mat,MatType,MatReuse,Mat*);
 PETSC_INTERN PetscErrorCode MatReorderForNonzeroDiagonal_SeqAIJ(Mat,PetscReal,IS,IS);
@@ -0,0 +1,307 @@
+/*
+    Fine-grained iterative ILU of Chow and Patel for MATSEQAIJ, see -mat_aij_chowpatel_sweeps. The values of the ILU(k)
+    factor on the pattern S computed by the symbolic factorization satisfy the nonlinear equations
+
+        l_ij = (a_ij - sum_{k<j} l_ik u_kj) / u_jj      (i,j) in S, i > j
+        u_ij =  a_ij - sum_{k<i} l_ik u_kj              (i,j) in S, i <= j
+
+    which are solved by fixed point (Jacobi) sweeps in which all entries are updated independently. The triangular solves
+    can be approximated the same way by a few Jacobi iterations, see -mat_aij_chowpatel_jacobi.
+*/
+#include <../src/mat/impls/aij/seq/aij.h>
+#if defined(PETSC_HAVE_OPENMP)
+#include <omp.h>
+#endif
+
+/* called at the end of the ILU symbolic factorizations, after the numeric factorization routine is set */
+PetscErrorCode MatSeqAIJSetUpChowPatel(Mat fact)
+{
+  Mat_SeqAIJ *b = (Mat_SeqAIJ*)fact->data;
+
+  PetscFunctionBegin;
+  if (b->chowpatel.sweeps || b->chowpatel.jacobi) fact->ops->lufactornumeric = MatLUFactorNumeric_SeqAIJ_ChowPatel;
+  PetscFunctionReturn(0);
+}
+
+/*
+   One sweep: anew = F(a), where the factor is stored in the usual format with the diagonal of U not inverted. Returns the
+   sum of the squares of the residuals of the equations at a and the number of flops.
+*/
+static void MatSeqAIJChowPatelSweep_Private(PetscInt n,const PetscInt *bi,const PetscInt *bj,const PetscInt *bdiag,const PetscInt *ci,const PetscInt *cr,const PetscInt *cp,const MatScalar *aval,const MatScalar *a,MatScalar *anew,PetscInt nt,PetscReal *res,PetscLogDouble *flops)
+{
+  PetscInt       i;
+  PetscReal      r = 0.0;
+  PetscLogDouble f = 0.0;
+
+#if defined(PETSC_HAVE_OPENMP)
+#pragma omp parallel for schedule(static) num_threads(nt) reduction(+:r,f)
+#endif
+  for (i=0; i<n; i++) {
+    PetscInt    p,q,t,j,kmax;
+    PetscScalar s,d;
+
+    /* L part, then U part of row i with the diagonal last */
+    for (p=bi[i]; p<bi[i+1]; p++) {
+      j    = bj[p];
+      s    = aval[p];
+      kmax = j;
+      for (q=bi[i],t=ci[j]; q<bi[i+1] && t<ci[j+1] && bj[q]<kmax && cr[t]<kmax; ) {
+        if (bj[q] == cr[t]) {s -= a[q]*a[cp[t]]; q++; t++; f += 2;}
+        else if (bj[q] < cr[t]) q++;
+        else t++;
+      }
+      d       = a[bdiag[j]];
+      r      += PetscRealPart((s - a[p]*d)*PetscConj(s - a[p]*d));
+      anew[p] = (d != 0.0) ? s/d : a[p];
+      f      += 1;
+    }
+    for (p=bdiag[i+1]+1; p<=bdiag[i]; p++) {
+      j    = bj[p];
+      s    = aval[p];
+      kmax = i;
+      for (q=bi[i],t=ci[j]; q<bi[i+1] && t<ci[j+1] && bj[q]<kmax && cr[t]<kmax; ) {
+        if (bj[q] == cr[t]) {s -= a[q]*a[cp[t]]; q++; t++; f += 2;}
+        else if (bj[q] < cr[t]) q++;
+        else t++;
+      }
+      r      += PetscRealPart((s - a[p])*PetscConj(s - a[p]));
+      anew[p] = s;
+    }
+  }
+  (void)nt;
+  *res   = r;
+  *flops = f;
+}
+
+PetscErrorCode MatLUFactorNumeric_SeqAIJ_ChowPatel(Mat B,Mat A,const MatFactorInfo *info)
+{
+  Mat_SeqAIJ      *a = (Mat_SeqAIJ*)A->data,*b = (Mat_SeqAIJ*)B->data;
+  PetscErrorCode  ierr;
+  const PetscInt  n = A->rmap->n,*ai = a->i,*aj = a->j,*bi = b->i,*bj = b->j,*bdiag = b->diag;
+  const PetscInt  *r,*ic;
+  PetscInt        i,k,p,sweep,nz,nzu,*ci,*cr,*cp;
+  MatScalar       *rtmp,*aval,*anew,*ba = b->a,d;
+  const MatScalar *aa = a->a;
+  PetscReal       res = 0.0,nrma = 0.0;
+  PetscLogDouble  flops;
+  PetscBool       row_identity,col_identity;
+  FactorShiftCtx  sctx;
+
+  PetscFunctionBegin;
+  if (!b->chowpatel.sweeps) {
+    ierr = MatLUFactorNumeric_SeqAIJ(B,A,info);CHKERRQ(ierr);
+    if (b->chowpatel.jacobi) B->ops->solve = MatSolve_SeqAIJ_Jacobi;
+    PetscFunctionReturn(0);
+  }
+
+  /* the columns of U with the diagonal, by increasing row */
+  nz   = bdiag[0] + 1;
+  nzu  = bdiag[0] - bdiag[n];
+  ierr = PetscCalloc3(n+1,&ci,nzu,&cr,nzu,&cp);CHKERRQ(ierr);
+  for (i=0; i<n; i++) {
+    for (p=bdiag[i+1]+1; p<=bdiag[i]; p++) ci[bj[p]+1]++;
+  }
+  for (i=0; i<n; i++) ci[i+1] += ci[i];
+  for (i=0; i<n; i++) {
+    for (p=bdiag[i+1]+1; p<=bdiag[i]; p++) {
+      cr[ci[bj[p]]]   = i;
+      cp[ci[bj[p]]++] = p;
+    }
+  }
+  for (i=n; i>0; i--) ci[i] = ci[i-1];
+  ci[0] = 0;
+
+  /* the values of the permuted matrix on the pattern of the factor, and the initial guess L = tril(A) diag(A)^{-1}, U = triu(A) */
+  ierr = ISGetIndices(b->row,&r);CHKERRQ(ierr);
+  ierr = ISGetIndices(b->icol,&ic);CHKERRQ(ierr);
+  ierr = PetscCalloc1(n,&rtmp);CHKERRQ(ierr);
+  ierr = PetscMalloc2(nz,&aval,nz,&anew);CHKERRQ(ierr);
+  for (i=0; i<n; i++) {
+    for (k=ai[r[i]]; k<ai[r[i]+1]; k++) {
+      rtmp[ic[aj[k]]] = aa[k];
+      nrma           += PetscRealPart(aa[k]*PetscConj(aa[k]));
+    }
+    for (p=bi[i]; p<bi[i+1]; p++) aval[p] = rtmp[bj[p]];
+    for (p=bdiag[i+1]+1; p<=bdiag[i]; p++) aval[p] = rtmp[bj[p]];
+    for (k=ai[r[i]]; k<ai[r[i]+1]; k++) rtmp[ic[aj[k]]] = 0.0;
+    /* like MatPivotCheck_nz() and MatPivotCheck_inblocks(), shift only the (numerically) zero diagonal entries */
+    if ((info->shifttype == (PetscReal)MAT_SHIFT_NONZERO || info->shifttype == (PetscReal)MAT_SHIFT_INBLOCKS) && PetscAbsScalar(aval[bdiag[i]]) <= info->zeropivot) {
+      aval[bdiag[i]] += info->shiftamount;
+    }
+  }
+  for (i=0; i<n; i++) {
+    for (p=bi[i]; p<bi[i+1]; p++) {
+      d     = aval[bdiag[bj[p]]];
+      ba[p] = (d != 0.0) ? aval[p]/d : 0.0;
+    }
+    for (p=bdiag[i+1]+1; p<=bdiag[i]; p++) ba[p] = aval[p];
+  }
+  ierr = ISRestoreIndices(b->row,&r);CHKERRQ(ierr);
+  ierr = ISRestoreIndices(b->icol,&ic);CHKERRQ(ierr);
+
+  for (sweep=0; sweep<b->chowpatel.sweeps; sweep++) {
+    MatSeqAIJChowPatelSweep_Private(n,bi,bj,bdiag,ci,cr,cp,aval,ba,anew,b->chowpatel.nthreads,&res,&flops);
+    ierr = PetscMemcpy(ba,anew,nz*sizeof(MatScalar));CHKERRQ(ierr);
+    ierr = PetscLogFlops(flops);CHKERRQ(ierr);
+    ierr = PetscInfo3(A,"Chow-Patel sweep %D: relative nonlinear residual %g before the sweep, %D threads\n",sweep,(double)(nrma > 0.0 ? PetscSqrtReal(res/nrma) : 0.0),b->chowpatel.nthreads);CHKERRQ(ierr);
+  }
+  ierr = PetscFree3(ci,cr,cp);CHKERRQ(ierr);
+  ierr = PetscFree(rtmp);CHKERRQ(ierr);
+  ierr = PetscFree2(aval,anew);CHKERRQ(ierr);
+
+  /* invert the diagonal for the triangular solves */
+  ierr = PetscMemzero(&sctx,sizeof(FactorShiftCtx));CHKERRQ(ierr);
+  for (i=0; i<n; i++) {
+    sctx.pv = ba[bdiag[i]];
+    ierr    = MatPivotCheck_none(B,A,info,&sctx,i);CHKERRQ(ierr);
+    ba[bdiag[i]] = (sctx.pv != 0.0) ? 1.0/sctx.pv : 0.0;
+  }
+
+  ierr = ISIdentity(b->row,&row_identity);CHKERRQ(ierr);
+  ierr = ISIdentity(b->col,&col_identity);CHKERRQ(ierr);
+  if (row_identity && col_identity) {
+    B->ops->solve = MatSolve_SeqAIJ_NaturalOrdering;
+  } else {
+    B->ops->solve = MatSolve_SeqAIJ;
+  }
+  ierr = MatSeqAIJSetUpSolveLevels(B);CHKERRQ(ierr);
+  if (b->chowpatel.jacobi) B->ops->solve = MatSolve_SeqAIJ_Jacobi;
+  B->ops->solveadd          = MatSolveAdd_SeqAIJ;
+  B->ops->solvetranspose    = MatSolveTranspose_SeqAIJ;
+  B->ops->solvetransposeadd = MatSolveTransposeAdd_SeqAIJ;
+  B->ops->matsolve          = MatMatSolve_SeqAIJ;
+  B->assembled              = PETSC_TRUE;
+  B->preallocated           = PETSC_TRUE;
+  PetscFunctionReturn(0);
+}
+
+/*
+   Approximates x = U^{-1} L^{-1} b with jacobi iterations for each factor, starting from y = b and x = D^{-1} y. With as
+   many iterations as the factor has levels (see -mat_aij_solve_levels) the solve is exact.
+*/
+PetscErrorCode MatSolve_SeqAIJ_Jacobi(Mat A,Vec bb,Vec xx)
+{
+  Mat_SeqAIJ        *a = (Mat_SeqAIJ*)A->data;
+  PetscErrorCode    ierr;
+  const PetscInt    n = A->rmap->n,*ai = a->i,*aj = a->j,*adiag = a->diag,*r,*c;
+  PetscInt          i,it,nit = a->chowpatel.jacobi;
+  PetscScalar       *x,*t = a->solve_work,*y,*ynew,*swap;
+  const PetscScalar *b;
+  const MatScalar   *aa = a->a;
+#if defined(PETSC_HAVE_OPENMP)
+  PetscInt          nt = a->chowpatel.nthreads;
+#endif
+
+  PetscFunctionBegin;
+  if (!n) PetscFunctionReturn(0);
+  if (!a->chowpatel.work) {
+    ierr = PetscMalloc1(2*n,&a->chowpatel.work);CHKERRQ(ierr);
+    ierr = PetscLogObjectMemory((PetscObject)A,2*n*sizeof(PetscScalar));CHKERRQ(ierr);
+  }
+  y    = a->chowpatel.work;
+  ynew = a->chowpatel.work + n;
+
+  ierr = VecGetArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecGetArray(xx,&x);CHKERRQ(ierr);
+  ierr = ISGetIndices(a->row,&r);CHKERRQ(ierr);
+  ierr = ISGetIndices(a->col,&c);CHKERRQ(ierr);
+
+  /* L y = perm(b), L has a unit diagonal */
+  for (i=0; i<n; i++) y[i] = t[i] = b[r[i]];
+  for (it=0; it<nit; it++) {
+#if defined(PETSC_HAVE_OPENMP)
+#pragma omp parallel for schedule(static) num_threads(nt)
+#endif
+    for (i=0; i<n; i++) {
+      PetscScalar     sum = t[i];
+      const MatScalar *v  = aa + ai[i];
+      const PetscInt  *vi = aj + ai[i];
+      PetscInt        nz  = ai[i+1] - ai[i];
+
+      PetscSparseDenseMinusDot(sum,y,v,vi,nz);
+      ynew[i] = sum;
+    }
+    swap = y; y = ynew; ynew = swap;
+  }
+
+  /* U x = y, the inverse of the diagonal of U is stored last in each row */
+  for (i=0; i<n; i++) {
+    t[i]    = y[i];
+    ynew[i] = y[i]*aa[adiag[i]];
+  }
+  swap = y; y = ynew; ynew = swap;
+  for (it=0; it<nit; it++) {
+#if defined(PETSC_HAVE_OPENMP)
+#pragma omp parallel for schedule(static) num_threads(nt)
+#endif
+    for (i=0; i<n; i++) {
+      PetscScalar     sum = t[i];
+      const MatScalar *v  = aa + adiag[i+1] + 1;
+      const PetscInt  *vi = aj + adiag[i+1] + 1;
+      PetscInt        nz  = adiag[i] - adiag[i+1] - 1;
+
+      PetscSparseDenseMinusDot(sum,y,v,vi,nz);
+      ynew[i] = sum*v[nz];
+    }
+    swap = y; y = ynew; ynew = swap;
+  }
+  for (i=0; i<n; i++) x[c[i]] = y[i];
+
+  ierr = ISRestoreIndices(a->row,&r);CHKERRQ(ierr);
+  ierr = ISRestoreIndices(a->col,&c);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecRestoreArray(xx,&x);CHKERRQ(ierr);
+  ierr = PetscLogFlops(nit*(2.0*a->nz - A->cmap->n) + A->cmap->n);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatView_SeqAIJ_ChowPatel(Mat A,PetscViewer viewer)
+{
+  Mat_SeqAIJ        *a = (Mat_SeqAIJ*)A->data;
+  PetscErrorCode    ierr;
+  PetscBool         iascii;
+  PetscViewerFormat format;
+
+  PetscFunctionBegin;
+  if (!A->factortype || !(a->chowpatel.sweeps || a->chowpatel.jacobi)) PetscFunctionReturn(0);
+  ierr = PetscObjectTypeCompare((PetscObject)viewer,PETSCVIEWERASCII,&iascii);CHKERRQ(ierr);
+  if (iascii) {
+    ierr = PetscViewerGetFormat(viewer,&format);CHKERRQ(ierr);
+    if (format == PETSC_VIEWER_ASCII_INFO_DETAIL || format == PETSC_VIEWER_ASCII_INFO) {
+      if (A->ops->lufactornumeric != MatLUFactorNumeric_SeqAIJ_ChowPatel) {
+        ierr = PetscViewerASCIIPrintf(viewer,"not using Chow-Patel sweeps or Jacobi solves, only available for ILU\n");CHKERRQ(ierr);
+      } else {
+        if (a->chowpatel.sweeps) {ierr = PetscViewerASCIIPrintf(viewer,"values computed by %D Chow-Patel sweeps\n",a->chowpatel.sweeps);CHKERRQ(ierr);}
+        if (a->chowpatel.jacobi) {ierr = PetscViewerASCIIPrintf(viewer,"triangular solves approximated by %D Jacobi iterations\n",a->chowpatel.jacobi);CHKERRQ(ierr);}
+      }
+    }
+  }
+  PetscFunctionReturn(0);
+}
+
+/* reads the options when the factor is obtained, see MatGetFactor_SeqAIJ_Levels() */
+PetscErrorCode MatGetFactor_SeqAIJ_ChowPatel(Mat A,Mat B)
+{
+  Mat_SeqAIJ     *b = (Mat_SeqAIJ*)B->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  b->chowpatel.sweeps   = 0;
+  b->chowpatel.jacobi   = 0;
+#if defined(PETSC_HAVE_OPENMP)
+  b->chowpatel.nthreads = omp_get_max_threads();
+#else
+  b->chowpatel.nthreads = 1;
+#endif
+  ierr = PetscOptionsBegin(PetscObjectComm((PetscObject)A),((PetscObject)A)->prefix,"Options for SEQAIJ factor","Mat");CHKERRQ(ierr);
+  ierr = PetscOptionsInt("-mat_aij_chowpatel_sweeps","Number of Chow-Patel fixed point sweeps that compute the ILU factor, 0 for the usual elimination",NULL,b->chowpatel.sweeps,&b->chowpatel.sweeps,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsInt("-mat_aij_chowpatel_jacobi","Number of Jacobi iterations that approximate each triangular solve with the ILU factor, 0 for exact solves",NULL,b->chowpatel.jacobi,&b->chowpatel.jacobi,NULL);CHKERRQ(ierr);
+#if defined(PETSC_HAVE_OPENMP)
+  ierr = PetscOptionsInt("-mat_aij_chowpatel_threads","Number of threads used by the sweeps and the Jacobi iterations",NULL,b->chowpatel.nthreads,&b->chowpatel.nthreads,NULL);CHKERRQ(ierr);
+#endif
+  ierr = PetscOptionsEnd();CHKERRQ(ierr);
+  if (b->chowpatel.sweeps < 0) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Number of sweeps %D cannot be negative",b->chowpatel.sweeps);
+  if (b->chowpatel.jacobi < 0) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Number of Jacobi iterations %D cannot be negative",b->chowpatel.jacobi);
+  if (b->chowpatel.nthreads < 1) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Number of threads %D must be positive",b->chowpatel.nthreads);
+  PetscFunctionReturn(0);
+}
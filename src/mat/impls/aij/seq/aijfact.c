@@ -102,6 +102,8 @@ PETSC_INTERN PetscErrorCode MatGetFactor_seqaij_petsc(Mat A,MatFactorType ftype,
   ierr = MatSetSizes(*B,n,n,n,n);CHKERRQ(ierr);
   if (ftype == MAT_FACTOR_LU || ftype == MAT_FACTOR_ILU || ftype == MAT_FACTOR_ILUDT) {
     ierr = MatSetType(*B,MATSEQAIJ);CHKERRQ(ierr);
+    ierr = MatGetFactor_SeqAIJ_Levels(A,&((Mat_SeqAIJ*)(*B)->data)->levels);CHKERRQ(ierr);
+    ierr = MatGetFactor_SeqAIJ_ChowPatel(A,*B);CHKERRQ(ierr);
 
     (*B)->ops->ilufactorsymbolic = MatILUFactorSymbolic_SeqAIJ;
     (*B)->ops->lufactorsymbolic  = MatLUFactorSymbolic_SeqAIJ;
@@ -110,6 +112,7 @@ PETSC_INTERN PetscErrorCode MatGetFactor_seqaij_petsc(Mat A,MatFactorType ftype,
   } else if (ftype == MAT_FACTOR_CHOLESKY || ftype == MAT_FACTOR_ICC) {
     ierr = MatSetType(*B,MATSEQSBAIJ);CHKERRQ(ierr);
     ierr = MatSeqSBAIJSetPreallocation(*B,1,MAT_SKIP_ALLOCATION,NULL);CHKERRQ(ierr);
+    ierr = MatGetFactor_SeqAIJ_Levels(A,&((Mat_SeqSBAIJ*)(*B)->data)->levels);CHKERRQ(ierr);
 
     (*B)->ops->iccfactorsymbolic      = MatICCFactorSymbolic_SeqAIJ;
     (*B)->ops->choleskyfactorsymbolic = MatCholeskyFactorSymbolic_SeqAIJ;
@@ -592,6 +595,7 @@ PetscErrorCode MatLUFactorNumeric_SeqAIJ(Mat B,Mat A,const MatFactorInfo *info)
   } else {
     C->ops->solve = MatSolve_SeqAIJ;
   }
+  ierr = MatSeqAIJSetUpSolveLevels(C);CHKERRQ(ierr);
   C->ops->solveadd          = MatSolveAdd_SeqAIJ;
   C->ops->solvetranspose    = MatSolveTranspose_SeqAIJ;
   C->ops->solvetransposeadd = MatSolveTransposeAdd_SeqAIJ;
@@ -1697,6 +1701,7 @@ PetscErrorCode MatILUFactorSymbolic_SeqAIJ(Mat fact,Mat A,IS isrow,IS iscol,cons
     if (a->inode.size) {
       fact->ops->lufactornumeric = MatLUFactorNumeric_SeqAIJ_Inode;
     }
+    ierr = MatSeqAIJSetUpChowPatel(fact);CHKERRQ(ierr);
     PetscFunctionReturn(0);
   }
 
@@ -1838,6 +1843,7 @@ PetscErrorCode MatILUFactorSymbolic_SeqAIJ(Mat fact,Mat A,IS isrow,IS iscol,cons
     (fact)->ops->lufactornumeric = MatLUFactorNumeric_SeqAIJ_Inode;
   }
   ierr = MatSeqAIJCheckInode_FactorLU(fact);CHKERRQ(ierr);
+  ierr = MatSeqAIJSetUpChowPatel(fact);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
@@ -2170,6 +2176,7 @@ PetscErrorCode MatCholeskyFactorNumeric_SeqAIJ(Mat B,Mat A,const MatFactorInfo *
     B->ops->forwardsolve   = MatForwardSolve_SeqSBAIJ_1;
     B->ops->backwardsolve  = MatBackwardSolve_SeqSBAIJ_1;
   }
+  ierr = MatSeqSBAIJSetUpSolveLevels(B);CHKERRQ(ierr);
 
   C->assembled    = PETSC_TRUE;
   C->preallocated = PETSC_TRUE;
@@ -3433,6 +3440,7 @@ PetscErrorCode MatILUDTFactor_SeqAIJ(Mat A,IS isrow,IS iscol,const MatFactorInfo
   } else {
     B->ops->solve = MatSolve_SeqAIJ;
   }
+  ierr = MatSeqAIJSetUpSolveLevels(B);CHKERRQ(ierr);
 
   B->ops->solveadd          = 0;
   B->ops->solvetranspose    = 0;
@@ -3563,6 +3571,7 @@ PetscErrorCode  MatILUDTFactorNumeric_SeqAIJ(Mat fact,Mat A,const MatFactorInfo
   } else {
     C->ops->solve = MatSolve_SeqAIJ;
   }
+  ierr = MatSeqAIJSetUpSolveLevels(C);CHKERRQ(ierr);
   C->ops->solveadd          = 0;
   C->ops->solvetranspose    = 0;
   C->ops->solvetransposeadd = 0;
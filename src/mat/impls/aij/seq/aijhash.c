@@ -0,0 +1,277 @@
+/*
+    Assembly of AIJ matrices that have not been preallocated.
+
+    The values set with MatSetValues() are accumulated in a hash table keyed by the
+  global (row,column) pair; at MatAssemblyEnd() the exact number of nonzeros per row
+  is known so the CSR storage is allocated once and filled, without the repeated
+  searches, shifts and reallocations of MatSetValues_SeqAIJ() into a matrix with
+  insufficient preallocation.
+*/
+
+#include <../src/mat/impls/aij/seq/aij.h>
+#include <petsc/private/hashmapijv.h>
+
+struct _n_Mat_Hash {
+  struct _MatOps ops;                 /* operations of the underlying matrix type, restored at MatAssemblyEnd() */
+  PetscHMapIJV   ht;                  /* values of the locally owned rows */
+  PetscBool      roworiented;
+  PetscBool      ignorezeroentries;
+  PetscBool      donotstash;          /* drop, rather than stash, entries in rows owned by other processes */
+  PetscErrorCode (*fill)(Mat,const PetscInt[],const PetscInt[],const PetscScalar[]);
+};
+
+static PetscErrorCode MatHashDestroy_Private(Mat A)
+{
+  Mat_Hash       h = A->hash;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscMemcpy(A->ops,&h->ops,sizeof(struct _MatOps));CHKERRQ(ierr);
+  ierr = PetscHMapIJVDestroy(&h->ht);CHKERRQ(ierr);
+  ierr = PetscFree(A->hash);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatSetValues_Hash(Mat A,PetscInt m,const PetscInt im[],PetscInt n,const PetscInt in[],const PetscScalar v[],InsertMode addv)
+{
+  Mat_Hash       h = A->hash;
+  PetscInt       i,j,rstart = A->rmap->rstart,rend = A->rmap->rend;
+  PetscHashIJKey key;
+  PetscScalar    value;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  for (i=0; i<m; i++) {
+    key.i = im[i];
+    if (key.i < 0) continue;
+    if (key.i >= A->rmap->N) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Row too large: row %D max %D",key.i,A->rmap->N-1);
+    if (key.i < rstart || key.i >= rend) {
+      if (A->nooffprocentries) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONG,"Setting off process row %D even though MatSetOption(,MAT_NO_OFF_PROC_ENTRIES,PETSC_TRUE) was set",key.i);
+      if (!h->donotstash) {
+        A->assembled = PETSC_FALSE;
+        if (h->roworiented) {
+          ierr = MatStashValuesRow_Private(&A->stash,key.i,n,in,v+i*n,(PetscBool)(h->ignorezeroentries && (addv == ADD_VALUES)));CHKERRQ(ierr);
+        } else {
+          ierr = MatStashValuesCol_Private(&A->stash,key.i,n,in,v+i,m,(PetscBool)(h->ignorezeroentries && (addv == ADD_VALUES)));CHKERRQ(ierr);
+        }
+      }
+      continue;
+    }
+    for (j=0; j<n; j++) {
+      key.j = in[j];
+      if (key.j < 0) continue;
+#if defined(PETSC_USE_DEBUG)
+      if (key.j >= A->cmap->N) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Column too large: col %D max %D",key.j,A->cmap->N-1);
+#endif
+      value = h->roworiented ? v[i*n+j] : v[i+j*m];
+      if (h->ignorezeroentries && value == 0.0 && (addv == ADD_VALUES) && key.i != key.j) continue;
+      if (addv == ADD_VALUES) {
+        ierr = PetscHMapIJVAddValue(h->ht,key,value);CHKERRQ(ierr);
+      } else {
+        ierr = PetscHMapIJVSet(h->ht,key,value);CHKERRQ(ierr);
+      }
+    }
+  }
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatAssemblyBegin_Hash(Mat A,MatAssemblyType type)
+{
+  Mat_Hash       h = A->hash;
+  PetscInt       nstash,reallocs;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (h->donotstash || A->nooffprocentries) PetscFunctionReturn(0);
+  ierr = MatStashScatterBegin_Private(A,&A->stash,A->rmap->range);CHKERRQ(ierr);
+  ierr = MatStashGetInfo_Private(&A->stash,&nstash,&reallocs);CHKERRQ(ierr);
+  ierr = PetscInfo2(A,"Stash has %D entries, uses %D mallocs.\n",nstash,reallocs);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatAssemblyEnd_Hash(Mat A,MatAssemblyType type)
+{
+  Mat_Hash       h = A->hash;
+  PetscErrorCode (*fill)(Mat,const PetscInt[],const PetscInt[],const PetscScalar[]);
+  PetscHashIJKey *keys;
+  PetscScalar    *vals,*rvals,*val;
+  PetscInt       i,j,k,m = A->rmap->n,rstart = A->rmap->rstart,nz,off,ncols,flg,srow;
+  PetscInt       *rowptr,*next,*rcols,*row,*col;
+  PetscMPIInt    n;
+  PetscBool      nooffprocentries;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (!h->donotstash && !A->nooffprocentries) {
+    while (1) {
+      ierr = MatStashScatterGetMesg_Private(&A->stash,&n,&row,&col,&val,&flg);CHKERRQ(ierr);
+      if (!flg) break;
+
+      for (i=0; i<n; ) {
+        /* Now identify the consecutive vals belonging to the same row */
+        for (j=i,srow=row[j]; j<n; j++) {
+          if (row[j] != srow) break;
+        }
+        if (j < n) ncols = j-i;
+        else       ncols = n-i;
+        /* Now assemble all these values with a single function call */
+        ierr = MatSetValues_Hash(A,1,row+i,ncols,col+i,val+i,A->insertmode);CHKERRQ(ierr);
+        i = j;
+      }
+    }
+    ierr = MatStashScatterEnd_Private(&A->stash);CHKERRQ(ierr);
+  }
+  if (type == MAT_FLUSH_ASSEMBLY) PetscFunctionReturn(0);
+
+  /* sort the entries of the hash table into CSR format with increasing column indices in each row */
+  ierr = PetscHMapIJVGetSize(h->ht,&nz);CHKERRQ(ierr);
+  ierr = PetscMalloc2(nz,&keys,nz,&vals);CHKERRQ(ierr);
+  off  = 0;
+  ierr = PetscHMapIJVGetPairs(h->ht,&off,keys,vals);CHKERRQ(ierr);
+  ierr = PetscCalloc2(m+1,&rowptr,m,&next);CHKERRQ(ierr);
+  ierr = PetscMalloc2(nz,&rcols,nz,&rvals);CHKERRQ(ierr);
+  for (k=0; k<nz; k++) rowptr[keys[k].i-rstart+1]++;
+  for (i=0; i<m; i++) {
+    rowptr[i+1] += rowptr[i];
+    next[i]      = rowptr[i];
+  }
+  for (k=0; k<nz; k++) {
+    j        = next[keys[k].i-rstart]++;
+    rcols[j] = keys[k].j;
+    rvals[j] = vals[k];
+  }
+  ierr = PetscFree2(keys,vals);CHKERRQ(ierr);
+  for (i=0; i<m; i++) {
+    ierr = PetscSortIntWithScalarArray(rowptr[i+1]-rowptr[i],rcols+rowptr[i],rvals+rowptr[i]);CHKERRQ(ierr);
+  }
+  ierr = PetscInfo2(A,"Building storage for %D nonzeros in %D rows from hash table\n",nz,m);CHKERRQ(ierr);
+
+  /* return to the regular operations of the matrix type and let it allocate and fill its storage */
+  fill = h->fill;
+  ierr = MatHashDestroy_Private(A);CHKERRQ(ierr);
+  ierr = (*fill)(A,rowptr,rcols,rvals);CHKERRQ(ierr);
+  ierr = PetscFree2(rowptr,next);CHKERRQ(ierr);
+  ierr = PetscFree2(rcols,rvals);CHKERRQ(ierr);
+
+  /* all off-process entries have already been communicated */
+  nooffprocentries    = A->nooffprocentries;
+  A->nooffprocentries = PETSC_TRUE;
+  if (A->ops->assemblybegin) {
+    ierr = (*A->ops->assemblybegin)(A,type);CHKERRQ(ierr);
+  }
+  ierr = (*A->ops->assemblyend)(A,type);CHKERRQ(ierr);
+  A->nooffprocentries = nooffprocentries;
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatZeroEntries_Hash(Mat A)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscHMapIJVClear(A->hash->ht);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatSetOption_Hash(Mat A,MatOption op,PetscBool flg)
+{
+  Mat_Hash       h = A->hash;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  switch (op) {
+  case MAT_ROW_ORIENTED:
+    h->roworiented = flg;
+    break;
+  case MAT_IGNORE_ZERO_ENTRIES:
+    h->ignorezeroentries = flg;
+    break;
+  case MAT_IGNORE_OFF_PROC_ENTRIES:
+    h->donotstash = flg;
+    break;
+  default:
+    break;
+  }
+  if (h->ops.setoption) {
+    ierr = (*h->ops.setoption)(A,op,flg);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatDestroy_Hash(Mat A)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatHashDestroy_Private(A);CHKERRQ(ierr);
+  if (A->ops->destroy) {
+    ierr = (*A->ops->destroy)(A);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+/*
+   MatAIJSetUpHash_Private - Switches a matrix without preallocation to assembly through a hash table
+
+   Input Parameters:
++  A                 - the matrix, its storage must exist (but may be empty) so that options can be set on it
+.  roworiented       - current value of MAT_ROW_ORIENTED
+.  ignorezeroentries - current value of MAT_IGNORE_ZERO_ENTRIES
+.  donotstash        - current value of MAT_IGNORE_OFF_PROC_ENTRIES, must be PETSC_TRUE if A has no stash
+-  fill              - routine of the matrix type that allocates the storage for the given local CSR structure
+                       (with global column indices) and copies in the values
+
+   Notes:
+   Until the next MAT_FINAL_ASSEMBLY only MatSetValues(), MatZeroEntries(), MatSetOption() and MatAssemblyBegin/End()
+   are available; afterwards the matrix has exactly the nonzero pattern set and all its regular operations.
+*/
+PetscErrorCode MatAIJSetUpHash_Private(Mat A,PetscBool roworiented,PetscBool ignorezeroentries,PetscBool donotstash,PetscErrorCode (*fill)(Mat,const PetscInt[],const PetscInt[],const PetscScalar[]))
+{
+  Mat_Hash       h;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (A->hash) PetscFunctionReturn(0);
+  ierr = PetscNew(&h);CHKERRQ(ierr);
+  ierr = PetscHMapIJVCreate(&h->ht);CHKERRQ(ierr);
+  h->roworiented       = roworiented;
+  h->ignorezeroentries = ignorezeroentries;
+  h->donotstash        = donotstash;
+  h->fill              = fill;
+  A->hash              = h;
+
+  ierr = PetscMemcpy(&h->ops,A->ops,sizeof(struct _MatOps));CHKERRQ(ierr);
+  ierr = PetscMemzero(A->ops,sizeof(struct _MatOps));CHKERRQ(ierr);
+  A->ops->setvalues     = MatSetValues_Hash;
+  A->ops->assemblybegin = MatAssemblyBegin_Hash;
+  A->ops->assemblyend   = MatAssemblyEnd_Hash;
+  A->ops->zeroentries   = MatZeroEntries_Hash;
+  A->ops->setoption     = MatSetOption_Hash;
+  A->ops->destroy       = MatDestroy_Hash;
+  ierr = PetscInfo(A,"Using hash table for matrix assembly\n");CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*
+   Allocates the storage of a SeqAIJ matrix for exactly the nonzeros collected in the hash table
+*/
+PetscErrorCode MatHashFill_SeqAIJ(Mat A,const PetscInt rowptr[],const PetscInt cols[],const PetscScalar vals[])
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscInt       i,m = A->rmap->n,nonew = a->nonew,*nnz;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscMalloc1(m,&nnz);CHKERRQ(ierr);
+  for (i=0; i<m; i++) nnz[i] = rowptr[i+1] - rowptr[i];
+  ierr = MatSeqAIJSetPreallocation_SeqAIJ(A,0,nnz);CHKERRQ(ierr);
+  a->nonew = nonew;
+  ierr = PetscMemcpy(a->ilen,nnz,m*sizeof(PetscInt));CHKERRQ(ierr);
+  ierr = PetscFree(nnz);CHKERRQ(ierr);
+  ierr = PetscMemcpy(a->j,cols,rowptr[m]*sizeof(PetscInt));CHKERRQ(ierr);
+  if (a->a) {
+    for (i=0; i<rowptr[m]; i++) a->a[i] = vals[i];
+  }
+  A->nonzerostate++;
+  PetscFunctionReturn(0);
+}
@@ -0,0 +1,332 @@
+/*
+    Kernels for MATSEQAIJ that read the column indices as 16 bit offsets from the first column of each row,
+    see -mat_aij_compress_indices. The full column indices in a->j are kept for all other operations.
+*/
+#include <../src/mat/impls/aij/seq/aij.h>
+
+#define MATSEQAIJ_IDX16_MAX 65535
+
+/* frees the compressed indices and restores the usual kernels, also used when a subclass changes the nonzero structure */
+PetscErrorCode MatSeqAIJResetIdx16(Mat A)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscFree2(a->idx16.base,a->idx16.j);CHKERRQ(ierr);
+  a->idx16.mat_nonzerostate = A->nonzerostate;
+  if (A->ops->mult == MatMult_SeqAIJ_Idx16)                         A->ops->mult             = MatMult_SeqAIJ;
+  if (A->ops->multadd == MatMultAdd_SeqAIJ_Idx16)                   A->ops->multadd          = MatMultAdd_SeqAIJ;
+  if (A->ops->multtranspose == MatMultTranspose_SeqAIJ_Idx16)       A->ops->multtranspose    = MatMultTranspose_SeqAIJ;
+  if (A->ops->multtransposeadd == MatMultTransposeAdd_SeqAIJ_Idx16) A->ops->multtransposeadd = MatMultTransposeAdd_SeqAIJ;
+  if (A->ops->sor == MatSOR_SeqAIJ_Idx16)                           A->ops->sor              = MatSOR_SeqAIJ;
+  PetscFunctionReturn(0);
+}
+
+/*
+   Compresses the column indices of an assembled matrix and switches the kernels; this is only possible when no row
+   spans more than 2^16 columns, otherwise the matrix keeps the usual kernels.
+*/
+PetscErrorCode MatSeqAIJSetUpIdx16(Mat A)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscErrorCode ierr;
+  PetscInt       i,k,m = A->rmap->n,nz = a->nz,span,maxspan = 0;
+  const PetscInt *ai = a->i,*aj = a->j;
+
+  PetscFunctionBegin;
+  ierr = MatSeqAIJResetIdx16(A);CHKERRQ(ierr);
+  for (i=0; i<m; i++) {
+    if (ai[i+1] == ai[i]) continue;
+    span = aj[ai[i+1]-1] - aj[ai[i]];
+    if (span > MATSEQAIJ_IDX16_MAX) {
+      ierr = PetscInfo3(A,"Row %D spans %D > %D columns, the column indices are not compressed\n",i,span+1,(PetscInt)MATSEQAIJ_IDX16_MAX+1);CHKERRQ(ierr);
+      PetscFunctionReturn(0);
+    }
+    maxspan = PetscMax(maxspan,span);
+  }
+
+  ierr = PetscMalloc2(m,&a->idx16.base,nz,&a->idx16.j);CHKERRQ(ierr);
+  ierr = PetscLogObjectMemory((PetscObject)A,m*sizeof(PetscInt)+nz*sizeof(unsigned short));CHKERRQ(ierr);
+  for (i=0; i<m; i++) {
+    a->idx16.base[i] = (ai[i+1] > ai[i]) ? aj[ai[i]] : 0;
+    for (k=ai[i]; k<ai[i+1]; k++) a->idx16.j[k] = (unsigned short)(aj[k] - a->idx16.base[i]);
+  }
+  ierr = PetscInfo3(A,"Compressed the column indices of %D nonzeros to 16 bits, largest row span %D, %D bytes less per MatMult()\n",nz,maxspan+1,(PetscInt)(nz*(sizeof(PetscInt)-sizeof(unsigned short))-m*sizeof(PetscInt)));CHKERRQ(ierr);
+
+  /* the inode routines keep their own MatSOR(), which relaxes whole inodes at once */
+  A->ops->mult             = MatMult_SeqAIJ_Idx16;
+  A->ops->multadd          = MatMultAdd_SeqAIJ_Idx16;
+  A->ops->multtranspose    = MatMultTranspose_SeqAIJ_Idx16;
+  A->ops->multtransposeadd = MatMultTransposeAdd_SeqAIJ_Idx16;
+  if (A->ops->sor == MatSOR_SeqAIJ) A->ops->sor = MatSOR_SeqAIJ_Idx16;
+  PetscFunctionReturn(0);
+}
+
+/* z = A x + y with y = NULL meaning zero; with the compressed row format only the nonzero rows of z are set */
+PETSC_STATIC_INLINE void MatMultAdd_SeqAIJ_Idx16_Private(Mat A,const PetscScalar *x,const PetscScalar *y,PetscScalar *z)
+{
+  Mat_SeqAIJ           *a = (Mat_SeqAIJ*)A->data;
+  const PetscInt       *ii = a->i,*ridx = NULL,*base = a->idx16.base;
+  const unsigned short *aj;
+  const MatScalar      *aa;
+  const PetscScalar    *xb;
+  PetscScalar          sum;
+  PetscInt             i,k,n,row,m = A->rmap->n;
+
+  if (a->compressedrow.use) {
+    m    = a->compressedrow.nrows;
+    ii   = a->compressedrow.i;
+    ridx = a->compressedrow.rindex;
+  }
+  for (i=0; i<m; i++) {
+    row = ridx ? ridx[i] : i;
+    n   = ii[i+1] - ii[i];
+    aj  = a->idx16.j + ii[i];
+    aa  = a->a + ii[i];
+    xb  = x + base[row];
+    sum = y ? y[row] : 0.0;
+    for (k=0; k<n; k++) sum += aa[k]*xb[aj[k]];
+    z[row] = sum;
+  }
+}
+
+PetscErrorCode MatMult_SeqAIJ_Idx16(Mat A,Vec xx,Vec yy)
+{
+  Mat_SeqAIJ        *a = (Mat_SeqAIJ*)A->data;
+  const PetscScalar *x;
+  PetscScalar       *y;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArray(yy,&y);CHKERRQ(ierr);
+  if (a->compressedrow.use) {ierr = PetscMemzero(y,A->rmap->n*sizeof(PetscScalar));CHKERRQ(ierr);}
+  MatMultAdd_SeqAIJ_Idx16_Private(A,x,NULL,y);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(yy,&y);CHKERRQ(ierr);
+  ierr = PetscLogFlops(2.0*a->nz - a->nonzerorowcnt);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMultAdd_SeqAIJ_Idx16(Mat A,Vec xx,Vec yy,Vec zz)
+{
+  Mat_SeqAIJ        *a = (Mat_SeqAIJ*)A->data;
+  const PetscScalar *x,*y;
+  PetscScalar       *z;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArrayPair(yy,zz,(PetscScalar**)&y,&z);CHKERRQ(ierr);
+  if (a->compressedrow.use && y != z) {ierr = PetscMemcpy(z,y,A->rmap->n*sizeof(PetscScalar));CHKERRQ(ierr);}
+  MatMultAdd_SeqAIJ_Idx16_Private(A,x,y,z);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArrayPair(yy,zz,(PetscScalar**)&y,&z);CHKERRQ(ierr);
+  ierr = PetscLogFlops(2.0*a->nz);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMultTransposeAdd_SeqAIJ_Idx16(Mat A,Vec xx,Vec zz,Vec yy)
+{
+  Mat_SeqAIJ           *a = (Mat_SeqAIJ*)A->data;
+  const PetscInt       *ii = a->i,*ridx = NULL;
+  const unsigned short *aj;
+  const MatScalar      *aa;
+  const PetscScalar    *x;
+  PetscScalar          *y,*yb,alpha;
+  PetscInt             i,k,n,row,m = A->rmap->n;
+  PetscErrorCode       ierr;
+
+  PetscFunctionBegin;
+  if (zz != yy) {ierr = VecCopy(zz,yy);CHKERRQ(ierr);}
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArray(yy,&y);CHKERRQ(ierr);
+  if (a->compressedrow.use) {
+    m    = a->compressedrow.nrows;
+    ii   = a->compressedrow.i;
+    ridx = a->compressedrow.rindex;
+  }
+  for (i=0; i<m; i++) {
+    row   = ridx ? ridx[i] : i;
+    n     = ii[i+1] - ii[i];
+    aj    = a->idx16.j + ii[i];
+    aa    = a->a + ii[i];
+    yb    = y + a->idx16.base[row];
+    alpha = x[row];
+    for (k=0; k<n; k++) yb[aj[k]] += alpha*aa[k];
+  }
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(yy,&y);CHKERRQ(ierr);
+  ierr = PetscLogFlops(2.0*a->nz);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMultTranspose_SeqAIJ_Idx16(Mat A,Vec xx,Vec yy)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = VecSet(yy,0.0);CHKERRQ(ierr);
+  ierr = MatMultTransposeAdd_SeqAIJ_Idx16(A,xx,yy,yy);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*
+   The sweeps of MatSOR_SeqAIJ() with the compressed indices; applying the triangular parts and the Eisenstat
+   trick are left to MatSOR_SeqAIJ()
+*/
+PetscErrorCode MatSOR_SeqAIJ_Idx16(Mat A,Vec bb,PetscReal omega,MatSORType flag,PetscReal fshift,PetscInt its,PetscInt lits,Vec xx)
+{
+  Mat_SeqAIJ           *a = (Mat_SeqAIJ*)A->data;
+  PetscScalar          *x,sum,*t;
+  const MatScalar      *v,*idiag,*mdiag;
+  const PetscScalar    *b,*xb,*xr;
+  const unsigned short *idx;
+  const PetscInt       *diag,*ai = a->i,*base = a->idx16.base;
+  PetscInt             n,m = A->rmap->n,i;
+  PetscErrorCode       ierr;
+
+  PetscFunctionBegin;
+  if (flag == SOR_APPLY_UPPER || flag == SOR_APPLY_LOWER || (flag & SOR_EISENSTAT)) {
+    ierr = MatSOR_SeqAIJ(A,bb,omega,flag,fshift,its,lits,xx);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  if (its <= 0 || lits <= 0) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONG,"Relaxation requires global its %D and local its %D both positive",its,lits);
+  its = its*lits;
+
+  if (fshift != a->fshift || omega != a->omega) a->idiagvalid = PETSC_FALSE; /* must recompute idiag[] */
+  if (!a->idiagvalid) {ierr = MatInvertDiagonal_SeqAIJ(A,omega,fshift);CHKERRQ(ierr);}
+  a->fshift = fshift;
+  a->omega  = omega;
+
+  diag  = a->diag;
+  t     = a->ssor_work;
+  idiag = a->idiag;
+  mdiag = a->mdiag;
+
+  ierr = VecGetArray(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(bb,&b);CHKERRQ(ierr);
+  /* We count flops by assuming the upper triangular and lower triangular parts have the same number of nonzeros */
+  if (flag & SOR_ZERO_INITIAL_GUESS) {
+    if (flag & SOR_FORWARD_SWEEP || flag & SOR_LOCAL_FORWARD_SWEEP) {
+      for (i=0; i<m; i++) {
+        n   = diag[i] - ai[i];
+        idx = a->idx16.j + ai[i];
+        v   = a->a + ai[i];
+        xr  = x + base[i];
+        sum = b[i];
+        PetscSparseDenseMinusDot(sum,xr,v,idx,n);
+        t[i] = sum;
+        x[i] = sum*idiag[i];
+      }
+      xb   = t;
+      ierr = PetscLogFlops(a->nz);CHKERRQ(ierr);
+    } else xb = b;
+    if (flag & SOR_BACKWARD_SWEEP || flag & SOR_LOCAL_BACKWARD_SWEEP) {
+      for (i=m-1; i>=0; i--) {
+        n   = ai[i+1] - diag[i] - 1;
+        idx = a->idx16.j + diag[i] + 1;
+        v   = a->a + diag[i] + 1;
+        xr  = x + base[i];
+        sum = xb[i];
+        PetscSparseDenseMinusDot(sum,xr,v,idx,n);
+        if (xb == b) {
+          x[i] = sum*idiag[i];
+        } else {
+          x[i] = (1-omega)*x[i] + sum*idiag[i];  /* omega in idiag */
+        }
+      }
+      ierr = PetscLogFlops(a->nz);CHKERRQ(ierr); /* assumes 1/2 in upper */
+    }
+    its--;
+  }
+  while (its--) {
+    if (flag & SOR_FORWARD_SWEEP || flag & SOR_LOCAL_FORWARD_SWEEP) {
+      for (i=0; i<m; i++) {
+        xr  = x + base[i];
+        /* lower */
+        n   = diag[i] - ai[i];
+        idx = a->idx16.j + ai[i];
+        v   = a->a + ai[i];
+        sum = b[i];
+        PetscSparseDenseMinusDot(sum,xr,v,idx,n);
+        t[i] = sum;             /* save application of the lower-triangular part */
+        /* upper */
+        n   = ai[i+1] - diag[i] - 1;
+        idx = a->idx16.j + diag[i] + 1;
+        v   = a->a + diag[i] + 1;
+        PetscSparseDenseMinusDot(sum,xr,v,idx,n);
+        x[i] = (1. - omega)*x[i] + sum*idiag[i]; /* omega in idiag */
+      }
+      xb   = t;
+      ierr = PetscLogFlops(2.0*a->nz);CHKERRQ(ierr);
+    } else xb = b;
+    if (flag & SOR_BACKWARD_SWEEP || flag & SOR_LOCAL_BACKWARD_SWEEP) {
+      for (i=m-1; i>=0; i--) {
+        xr  = x + base[i];
+        sum = xb[i];
+        if (xb == b) {
+          /* whole matrix (no checkpointing available) */
+          n   = ai[i+1] - ai[i];
+          idx = a->idx16.j + ai[i];
+          v   = a->a + ai[i];
+          PetscSparseDenseMinusDot(sum,xr,v,idx,n);
+          x[i] = (1. - omega)*x[i] + (sum + mdiag[i]*x[i])*idiag[i];
+        } else { /* lower-triangular part has been saved, so only apply upper-triangular */
+          n   = ai[i+1] - diag[i] - 1;
+          idx = a->idx16.j + diag[i] + 1;
+          v   = a->a + diag[i] + 1;
+          PetscSparseDenseMinusDot(sum,xr,v,idx,n);
+          x[i] = (1. - omega)*x[i] + sum*idiag[i];  /* omega in idiag */
+        }
+      }
+      if (xb == b) {
+        ierr = PetscLogFlops(2.0*a->nz);CHKERRQ(ierr);
+      } else {
+        ierr = PetscLogFlops(a->nz);CHKERRQ(ierr); /* assumes 1/2 in upper */
+      }
+    }
+  }
+  ierr = VecRestoreArray(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(bb,&b);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatView_SeqAIJ_Idx16(Mat A,PetscViewer viewer)
+{
+  Mat_SeqAIJ        *a = (Mat_SeqAIJ*)A->data;
+  PetscErrorCode    ierr;
+  PetscBool         iascii;
+  PetscViewerFormat format;
+
+  PetscFunctionBegin;
+  if (!a->idx16.use) PetscFunctionReturn(0);
+  ierr = PetscObjectTypeCompare((PetscObject)viewer,PETSCVIEWERASCII,&iascii);CHKERRQ(ierr);
+  if (iascii) {
+    ierr = PetscViewerGetFormat(viewer,&format);CHKERRQ(ierr);
+    if (format == PETSC_VIEWER_ASCII_INFO_DETAIL || format == PETSC_VIEWER_ASCII_INFO) {
+      if (A->ops->mult == MatMult_SeqAIJ_Idx16) {
+        ierr = PetscViewerASCIIPrintf(viewer,"using 16 bit column indices in MatMult()%s\n",A->ops->sor == MatSOR_SeqAIJ_Idx16 ? " and MatSOR()" : "");CHKERRQ(ierr);
+      } else {
+        ierr = PetscViewerASCIIPrintf(viewer,"not using 16 bit column indices, a row spans more than %D columns\n",(PetscInt)MATSEQAIJ_IDX16_MAX+1);CHKERRQ(ierr);
+      }
+    }
+  }
+  PetscFunctionReturn(0);
+}
+
+/* reads the option at creation, like the inode options, so it also applies to the blocks of MATMPIAIJ */
+PetscErrorCode MatCreate_SeqAIJ_Idx16(Mat B)
+{
+  Mat_SeqAIJ     *b = (Mat_SeqAIJ*)B->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  b->idx16.use              = PETSC_FALSE;
+  b->idx16.mat_nonzerostate = -1;
+  ierr = PetscOptionsBegin(PetscObjectComm((PetscObject)B),((PetscObject)B)->prefix,"Options for SEQAIJ matrix","Mat");CHKERRQ(ierr);
+  ierr = PetscOptionsBool("-mat_aij_compress_indices","Store the column indices as 16 bit offsets for MatMult() and MatSOR()",NULL,b->idx16.use,&b->idx16.use,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsEnd();CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
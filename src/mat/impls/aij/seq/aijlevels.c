@@ -0,0 +1,367 @@
+/*
+    Level scheduled (wavefront) triangular solves for the LU, ILU, Cholesky and ICC factors obtained from MATSEQAIJ,
+    see -mat_aij_solve_levels. Row i of L is in level 1 + max(level of the rows it depends on), so all rows of a level
+    only depend on rows of earlier levels and can be eliminated concurrently; U is scheduled the same way starting
+    from the last row.
+*/
+#include <../src/mat/impls/aij/seq/aij.h>
+#include <../src/mat/impls/sbaij/seq/sbaij.h>
+#if defined(PETSC_HAVE_OPENMP)
+#include <omp.h>
+#endif
+
+/* frees the schedule, it is recomputed by the first MatSolve() after a numeric factorization */
+PetscErrorCode MatSeqAIJResetSolveLevels(Mat_SeqAIJ_Levels *levels)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscFree4(levels->start[0],levels->rows[0],levels->start[1],levels->rows[1]);CHKERRQ(ierr);
+  ierr = PetscFree3(levels->ti,levels->tj,levels->ta);CHKERRQ(ierr);
+  levels->nlevels[0] = 0;
+  levels->nlevels[1] = 0;
+  PetscFunctionReturn(0);
+}
+
+/* sorts the rows by level, level[] holds the forward levels followed by the backward levels, the rows of each level stay in increasing order */
+static PetscErrorCode MatSeqAIJSortLevels_Private(Mat A,PetscInt n,const PetscInt *level,Mat_SeqAIJ_Levels *levels)
+{
+  PetscErrorCode ierr;
+  PetscInt       i,l,s,nlevels,*start,*rows;
+
+  PetscFunctionBegin;
+  levels->nlevels[0] = levels->nlevels[1] = 0;
+  for (i=0; i<n; i++) {
+    levels->nlevels[0] = PetscMax(levels->nlevels[0],level[i]+1);
+    levels->nlevels[1] = PetscMax(levels->nlevels[1],level[n+i]+1);
+  }
+  ierr = PetscMalloc4(levels->nlevels[0]+1,&levels->start[0],n,&levels->rows[0],levels->nlevels[1]+1,&levels->start[1],n,&levels->rows[1]);CHKERRQ(ierr);
+  ierr = PetscLogObjectMemory((PetscObject)A,(levels->nlevels[0]+levels->nlevels[1]+2+2*n)*sizeof(PetscInt));CHKERRQ(ierr);
+  for (s=0; s<2; s++) {
+    nlevels = levels->nlevels[s];
+    start   = levels->start[s];
+    rows    = levels->rows[s];
+    ierr    = PetscMemzero(start,(nlevels+1)*sizeof(PetscInt));CHKERRQ(ierr);
+    for (i=0; i<n; i++) start[level[s*n+i]+1]++;
+    for (l=0; l<nlevels; l++) start[l+1] += start[l];
+    for (i=0; i<n; i++) rows[start[level[s*n+i]]++] = i;
+    for (l=nlevels; l>0; l--) start[l] = start[l-1];
+    start[0] = 0;
+  }
+  ierr = PetscInfo5(A,"Level scheduled MatSolve() with %D threads on %D rows: %D forward levels, %D backward levels, %g rows per level\n",levels->nthreads,n,levels->nlevels[0],levels->nlevels[1],(double)(2.0*n/(levels->nlevels[0]+levels->nlevels[1])));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*
+   Computes the levels of L and U of an LU factor stored in the usual format: the strictly lower part of row i in
+   a->j[a->i[i]:a->i[i+1]] and the strictly upper part in a->j[a->diag[i+1]+1:a->diag[i]]
+*/
+static PetscErrorCode MatSeqAIJComputeSolveLevels_Private(Mat A)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscErrorCode ierr;
+  PetscInt       i,k,lev,n = A->rmap->n,*level;
+  const PetscInt *ai = a->i,*aj = a->j,*adiag = a->diag;
+
+  PetscFunctionBegin;
+  ierr = MatSeqAIJResetSolveLevels(&a->levels);CHKERRQ(ierr);
+  ierr = PetscMalloc1(2*n,&level);CHKERRQ(ierr);
+  for (i=0; i<n; i++) {
+    lev = 0;
+    for (k=ai[i]; k<ai[i+1]; k++) lev = PetscMax(lev,level[aj[k]]+1);
+    level[i] = lev;
+  }
+  for (i=n-1; i>=0; i--) {
+    lev = 0;
+    for (k=adiag[i+1]+1; k<adiag[i]; k++) lev = PetscMax(lev,level[n+aj[k]]+1);
+    level[n+i] = lev;
+  }
+  ierr = MatSeqAIJSortLevels_Private(A,n,level,&a->levels);CHKERRQ(ierr);
+  ierr = PetscFree(level);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*
+   Computes the levels of U^T and U of an ICC factor, row k of U is stored in a->j[a->i[k]:a->i[k+1]] with the
+   diagonal last. The solve with U^T is done by columns of U, which are stored as well.
+*/
+static PetscErrorCode MatSeqSBAIJComputeSolveLevels_Private(Mat A)
+{
+  Mat_SeqSBAIJ      *a = (Mat_SeqSBAIJ*)A->data;
+  Mat_SeqAIJ_Levels *levels = &a->levels;
+  PetscErrorCode    ierr;
+  PetscInt          i,k,lev,n = A->rmap->n,nz = a->i[n]-n,*level,*ti,*tj,*ta;
+  const PetscInt    *ai = a->i,*aj = a->j;
+
+  PetscFunctionBegin;
+  ierr = MatSeqAIJResetSolveLevels(levels);CHKERRQ(ierr);
+  ierr = PetscCalloc1(2*n,&level);CHKERRQ(ierr);
+  for (i=0; i<n; i++) {
+    for (k=ai[i]; k<ai[i+1]-1; k++) level[aj[k]] = PetscMax(level[aj[k]],level[i]+1);
+  }
+  for (i=n-1; i>=0; i--) {
+    lev = 0;
+    for (k=ai[i]; k<ai[i+1]-1; k++) lev = PetscMax(lev,level[n+aj[k]]+1);
+    level[n+i] = lev;
+  }
+  ierr = MatSeqAIJSortLevels_Private(A,n,level,levels);CHKERRQ(ierr);
+  ierr = PetscFree(level);CHKERRQ(ierr);
+
+  ierr = PetscCalloc3(n+1,&levels->ti,nz,&levels->tj,nz,&levels->ta);CHKERRQ(ierr);
+  ierr = PetscLogObjectMemory((PetscObject)A,(n+1+2*nz)*sizeof(PetscInt));CHKERRQ(ierr);
+  ti   = levels->ti;
+  tj   = levels->tj;
+  ta   = levels->ta;
+  for (i=0; i<n; i++) {
+    for (k=ai[i]; k<ai[i+1]-1; k++) ti[aj[k]+1]++;
+  }
+  for (i=0; i<n; i++) ti[i+1] += ti[i];
+  for (i=0; i<n; i++) {
+    for (k=ai[i]; k<ai[i+1]-1; k++) {
+      tj[ti[aj[k]]]   = i;
+      ta[ti[aj[k]]++] = k;
+    }
+  }
+  for (i=n; i>0; i--) ti[i] = ti[i-1];
+  ti[0] = 0;
+  PetscFunctionReturn(0);
+}
+
+/* called at the end of the numeric factorizations that produce the usual factor format, after the solve routines are set */
+PetscErrorCode MatSeqAIJSetUpSolveLevels(Mat A)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSeqAIJResetSolveLevels(&a->levels);CHKERRQ(ierr);
+  if (a->levels.use && A->ops->solve) A->ops->solve = MatSolve_SeqAIJ_Levels;
+  PetscFunctionReturn(0);
+}
+
+/* the same for the Cholesky and ICC factors with block size one */
+PetscErrorCode MatSeqSBAIJSetUpSolveLevels(Mat A)
+{
+  Mat_SeqSBAIJ   *a = (Mat_SeqSBAIJ*)A->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSeqAIJResetSolveLevels(&a->levels);CHKERRQ(ierr);
+  if (a->levels.use && A->ops->solve) {
+    A->ops->solve          = MatSolve_SeqSBAIJ_1_Levels;
+    A->ops->solvetranspose = MatSolve_SeqSBAIJ_1_Levels;
+  }
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatSolve_SeqAIJ_Levels(Mat A,Vec bb,Vec xx)
+{
+  Mat_SeqAIJ        *a = (Mat_SeqAIJ*)A->data;
+  PetscErrorCode    ierr;
+  PetscInt          n = A->rmap->n;
+  const PetscInt    *ai = a->i,*aj = a->j,*adiag = a->diag,*r,*c;
+  const PetscInt    *lstart,*lrows,*ustart,*urows;
+  PetscInt          nl,nu;
+  PetscScalar       *x,*tmp = a->solve_work;
+  const PetscScalar *b;
+  const MatScalar   *aa = a->a;
+#if defined(PETSC_HAVE_OPENMP)
+  PetscInt          nt = a->levels.nthreads;
+#endif
+
+  PetscFunctionBegin;
+  if (!n) PetscFunctionReturn(0);
+  if (!a->levels.start[0]) {ierr = MatSeqAIJComputeSolveLevels_Private(A);CHKERRQ(ierr);}
+  nl     = a->levels.nlevels[0];
+  nu     = a->levels.nlevels[1];
+  lstart = a->levels.start[0];
+  lrows  = a->levels.rows[0];
+  ustart = a->levels.start[1];
+  urows  = a->levels.rows[1];
+
+  ierr = VecGetArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecGetArray(xx,&x);CHKERRQ(ierr);
+  ierr = ISGetIndices(a->row,&r);CHKERRQ(ierr);
+  ierr = ISGetIndices(a->col,&c);CHKERRQ(ierr);
+
+#if defined(PETSC_HAVE_OPENMP)
+#pragma omp parallel num_threads(nt)
+#endif
+  {
+    PetscInt        l,k,i,nz;
+    const PetscInt  *vi;
+    const MatScalar *v;
+    PetscScalar     sum;
+
+    /* forward solve the lower triangular, the implicit barrier of each level orders the levels */
+    for (l=0; l<nl; l++) {
+#if defined(PETSC_HAVE_OPENMP)
+#pragma omp for schedule(static)
+#endif
+      for (k=lstart[l]; k<lstart[l+1]; k++) {
+        i   = lrows[k];
+        v   = aa + ai[i];
+        vi  = aj + ai[i];
+        nz  = ai[i+1] - ai[i];
+        sum = b[r[i]];
+        PetscSparseDenseMinusDot(sum,tmp,v,vi,nz);
+        tmp[i] = sum;
+      }
+    }
+
+    /* backward solve the upper triangular */
+    for (l=0; l<nu; l++) {
+#if defined(PETSC_HAVE_OPENMP)
+#pragma omp for schedule(static)
+#endif
+      for (k=ustart[l]; k<ustart[l+1]; k++) {
+        i   = urows[k];
+        v   = aa + adiag[i+1] + 1;
+        vi  = aj + adiag[i+1] + 1;
+        nz  = adiag[i] - adiag[i+1] - 1;
+        sum = tmp[i];
+        PetscSparseDenseMinusDot(sum,tmp,v,vi,nz);
+        x[c[i]] = tmp[i] = sum*v[nz]; /* v[nz] = aa[adiag[i]] */
+      }
+    }
+  }
+
+  ierr = ISRestoreIndices(a->row,&r);CHKERRQ(ierr);
+  ierr = ISRestoreIndices(a->col,&c);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecRestoreArray(xx,&x);CHKERRQ(ierr);
+  ierr = PetscLogFlops(2*a->nz - A->cmap->n);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*
+   Solves U^T D U perm(x) = perm(b). The rows of U^T are gathered from the columns of U; x holds the intermediate
+   solution of U^T y = perm(b) before the scaling by D^{-1}, the backward solve only reads t and overwrites x.
+*/
+PetscErrorCode MatSolve_SeqSBAIJ_1_Levels(Mat A,Vec bb,Vec xx)
+{
+  Mat_SeqSBAIJ      *a = (Mat_SeqSBAIJ*)A->data;
+  PetscErrorCode    ierr;
+  PetscInt          n = A->rmap->n;
+  const PetscInt    *ai = a->i,*aj = a->j,*rp,*ti,*tj,*ta;
+  const PetscInt    *fstart,*frows,*bstart,*brows;
+  PetscInt          nf,nbl;
+  PetscScalar       *x,*t = a->solve_work;
+  const PetscScalar *b;
+  const MatScalar   *aa = a->a;
+#if defined(PETSC_HAVE_OPENMP)
+  PetscInt          nt = a->levels.nthreads;
+#endif
+
+  PetscFunctionBegin;
+  if (!n) PetscFunctionReturn(0);
+  if (!a->levels.start[0]) {ierr = MatSeqSBAIJComputeSolveLevels_Private(A);CHKERRQ(ierr);}
+  nf     = a->levels.nlevels[0];
+  nbl    = a->levels.nlevels[1];
+  fstart = a->levels.start[0];
+  frows  = a->levels.rows[0];
+  bstart = a->levels.start[1];
+  brows  = a->levels.rows[1];
+  ti     = a->levels.ti;
+  tj     = a->levels.tj;
+  ta     = a->levels.ta;
+
+  ierr = VecGetArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecGetArray(xx,&x);CHKERRQ(ierr);
+  ierr = ISGetIndices(a->row,&rp);CHKERRQ(ierr);
+
+#if defined(PETSC_HAVE_OPENMP)
+#pragma omp parallel num_threads(nt)
+#endif
+  {
+    PetscInt        l,p,j,k,nz;
+    const PetscInt  *vj;
+    const MatScalar *v;
+    PetscScalar     sum;
+
+    /* solve U^T*D*y = perm(b) by forward substitution */
+    for (l=0; l<nf; l++) {
+#if defined(PETSC_HAVE_OPENMP)
+#pragma omp for schedule(static)
+#endif
+      for (p=fstart[l]; p<fstart[l+1]; p++) {
+        k   = frows[p];
+        sum = b[rp[k]];
+        for (j=ti[k]; j<ti[k+1]; j++) sum += aa[ta[j]]*x[tj[j]];
+        x[k] = sum;
+        t[k] = sum*aa[ai[k+1]-1]; /* aa[ai[k+1]-1] = 1/D(k) */
+      }
+    }
+
+    /* solve U*perm(x) = y by back substitution */
+    for (l=0; l<nbl; l++) {
+#if defined(PETSC_HAVE_OPENMP)
+#pragma omp for schedule(static)
+#endif
+      for (p=bstart[l]; p<bstart[l+1]; p++) {
+        k   = brows[p];
+        v   = aa + ai[k];
+        vj  = aj + ai[k];
+        nz  = ai[k+1] - ai[k] - 1;
+        sum = t[k];
+        for (j=0; j<nz; j++) sum += v[j]*t[vj[j]];
+        x[rp[k]] = t[k] = sum;
+      }
+    }
+  }
+
+  ierr = ISRestoreIndices(a->row,&rp);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecRestoreArray(xx,&x);CHKERRQ(ierr);
+  ierr = PetscLogFlops(4.0*a->nz - 3.0*n);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatView_SeqAIJ_Levels(Mat A,Mat_SeqAIJ_Levels *levels,PetscViewer viewer)
+{
+  PetscErrorCode    ierr;
+  PetscBool         iascii;
+  PetscViewerFormat format;
+
+  PetscFunctionBegin;
+  if (!levels->use || !A->factortype) PetscFunctionReturn(0);
+  ierr = PetscObjectTypeCompare((PetscObject)viewer,PETSCVIEWERASCII,&iascii);CHKERRQ(ierr);
+  if (iascii) {
+    ierr = PetscViewerGetFormat(viewer,&format);CHKERRQ(ierr);
+    if (format == PETSC_VIEWER_ASCII_INFO_DETAIL || format == PETSC_VIEWER_ASCII_INFO) {
+      if (A->ops->solve != MatSolve_SeqAIJ_Levels && A->ops->solve != MatSolve_SeqSBAIJ_1_Levels) {
+        ierr = PetscViewerASCIIPrintf(viewer,"not using level scheduled MatSolve()\n");CHKERRQ(ierr);
+      } else if (!levels->start[0]) {
+        ierr = PetscViewerASCIIPrintf(viewer,"using level scheduled MatSolve(), levels are computed at the first solve\n");CHKERRQ(ierr);
+      } else {
+        ierr = PetscViewerASCIIPrintf(viewer,"using level scheduled MatSolve(): %D forward levels, %D backward levels\n",levels->nlevels[0],levels->nlevels[1]);CHKERRQ(ierr);
+      }
+    }
+  }
+  PetscFunctionReturn(0);
+}
+
+/*
+   reads the options when the factor is obtained, with the prefix of the matrix being factored, like the options of
+   the external factorization packages, since the factor itself never gets a prefix
+*/
+PetscErrorCode MatGetFactor_SeqAIJ_Levels(Mat A,Mat_SeqAIJ_Levels *levels)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  levels->use      = PETSC_FALSE;
+#if defined(PETSC_HAVE_OPENMP)
+  levels->nthreads = omp_get_max_threads();
+#else
+  levels->nthreads = 1;
+#endif
+  ierr = PetscOptionsBegin(PetscObjectComm((PetscObject)A),((PetscObject)A)->prefix,"Options for SEQAIJ factor","Mat");CHKERRQ(ierr);
+  ierr = PetscOptionsBool("-mat_aij_solve_levels","Solve with the triangular factors level by level, in parallel within each level",NULL,levels->use,&levels->use,NULL);CHKERRQ(ierr);
+#if defined(PETSC_HAVE_OPENMP)
+  ierr = PetscOptionsInt("-mat_aij_solve_levels_threads","Number of threads used in the level scheduled MatSolve()",NULL,levels->nthreads,&levels->nthreads,NULL);CHKERRQ(ierr);
+#endif
+  ierr = PetscOptionsEnd();CHKERRQ(ierr);
+  if (levels->nthreads < 1) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Number of threads %D must be positive",levels->nthreads);
+  PetscFunctionReturn(0);
+}
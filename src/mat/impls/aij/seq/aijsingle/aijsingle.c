@@ -0,0 +1,407 @@
+/*
+  Defines basic operations for the MATSEQAIJSINGLE matrix class.
+  This class is derived from the MATSEQAIJ class, but maintains a "shadow"
+  copy of the nonzero values rounded to single precision.  The shadow copy is
+  used by the operations that stream through the matrix without modifying it
+  (the products and the SOR sweeps), while the vectors and all sums stay in the
+  precision of PetscScalar.  All other operations use the original values.
+*/
+
+#include <../src/mat/impls/aij/seq/aij.h>
+
+#if defined(PETSC_USE_REAL_DOUBLE) && !defined(PETSC_USE_COMPLEX)
+typedef float MatScalarSingle;
+#else
+/* there is no narrower type available for this configuration, so the values are only copied */
+typedef MatScalar MatScalarSingle;
+#endif
+
+typedef struct {
+  MatScalarSingle  *a;               /* the nonzero values of the matrix rounded to single precision */
+  PetscInt         nz;               /* allocated length of a */
+  PetscScalar      *idiag;           /* inverse of the (rounded) diagonal used by MatSOR() */
+  PetscBool        sor;              /* all diagonal entries are present and nonzero, so idiag is usable */
+  PetscObjectState state;            /* state of the matrix when the shadow copy was last built */
+  PetscErrorCode   (*destroy)(Mat);  /* destroy routine in place before the conversion, for example the one of a PtAP product */
+} Mat_SeqAIJSingle;
+
+PETSC_INTERN PetscErrorCode MatConvert_SeqAIJSingle_SeqAIJ(Mat A,MatType type,MatReuse reuse,Mat *newmat)
+{
+  /* This routine is only called to convert a MATSEQAIJSINGLE to its base PETSc type, */
+  /* so we will ignore 'MatType type'. */
+  PetscErrorCode   ierr;
+  Mat              B = *newmat;
+  Mat_SeqAIJSingle *s;
+
+  PetscFunctionBegin;
+  if (reuse == MAT_INITIAL_MATRIX) {
+    ierr = MatDuplicate(A,MAT_COPY_VALUES,&B);CHKERRQ(ierr);
+  }
+  s = (Mat_SeqAIJSingle*)B->spptr;
+
+  /* Reset the original function pointers. */
+  B->ops->assemblyend      = MatAssemblyEnd_SeqAIJ;
+  B->ops->destroy          = s->destroy;
+  B->ops->mult             = MatMult_SeqAIJ;
+  B->ops->multtranspose    = MatMultTranspose_SeqAIJ;
+  B->ops->multadd          = MatMultAdd_SeqAIJ;
+  B->ops->multtransposeadd = MatMultTransposeAdd_SeqAIJ;
+  B->ops->sor              = MatSOR_SeqAIJ;
+  B->ops->diagonalscale    = MatDiagonalScale_SeqAIJ;
+  B->ops->ptap             = MatPtAP_SeqAIJ_SeqAIJ;
+
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqaijsingle_seqaij_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatSeqAIJRestoreArray_C",MatSeqAIJRestoreArray_SeqAIJ);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatPtAP_seqaij_seqaijsingle_C",NULL);CHKERRQ(ierr);
+
+  ierr = PetscFree2(s->a,s->idiag);CHKERRQ(ierr);
+  ierr = PetscFree(B->spptr);CHKERRQ(ierr);
+
+  ierr    = PetscObjectChangeTypeName((PetscObject)B,MATSEQAIJ);CHKERRQ(ierr);
+  *newmat = B;
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatDestroy_SeqAIJSingle(Mat A)
+{
+  PetscErrorCode   ierr;
+  Mat_SeqAIJSingle *s = (Mat_SeqAIJSingle*)A->spptr;
+  PetscErrorCode   (*destroy)(Mat) = MatDestroy_SeqAIJ;
+
+  PetscFunctionBegin;
+  /* If MatHeaderMerge() was used, then this SeqAIJSingle matrix will not have an spptr pointer. */
+  if (s) {
+    destroy = s->destroy;
+    ierr    = PetscFree2(s->a,s->idiag);CHKERRQ(ierr);
+    ierr    = PetscFree(A->spptr);CHKERRQ(ierr);
+  }
+  ierr = PetscObjectChangeTypeName((PetscObject)A,MATSEQAIJ);CHKERRQ(ierr);
+  ierr = (*destroy)(A);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* Build or update the single precision values if and only if needed.
+ * We track the ObjectState to determine when this needs to be done. */
+static PetscErrorCode MatSeqAIJSingle_build_shadow(Mat A)
+{
+  PetscErrorCode   ierr;
+  Mat_SeqAIJ       *a = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJSingle *s = (Mat_SeqAIJSingle*)A->spptr;
+  PetscInt         i,d,m = A->rmap->n,nz = a->i[m];
+  PetscObjectState state;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectStateGet((PetscObject)A,&state);CHKERRQ(ierr);
+  if (s->state == state) PetscFunctionReturn(0);
+
+  ierr = PetscLogEventBegin(MAT_Convert,A,0,0,0);CHKERRQ(ierr);
+  if (!s->idiag || nz > s->nz) {
+    ierr  = PetscFree2(s->a,s->idiag);CHKERRQ(ierr);
+    ierr  = PetscMalloc2(nz,&s->a,m,&s->idiag);CHKERRQ(ierr);
+    ierr  = PetscLogObjectMemory((PetscObject)A,nz*sizeof(MatScalarSingle)+m*sizeof(PetscScalar));CHKERRQ(ierr);
+    ierr  = PetscInfo2(A,"Single precision copy of the values uses %D bytes in addition to the %D bytes of the values\n",(PetscInt)(nz*sizeof(MatScalarSingle)+m*sizeof(PetscScalar)),(PetscInt)(nz*sizeof(MatScalar)));CHKERRQ(ierr);
+    s->nz = nz;
+  }
+  for (i=0; i<nz; i++) s->a[i] = (MatScalarSingle)a->a[i];
+
+  /* MatSOR() divides by the rounded diagonal, so that an exact solution is a fixed point of the sweeps */
+  s->sor = (PetscBool)(A->rmap->n == A->cmap->n);
+  if (s->sor) {
+    if (!a->diag) {ierr = MatMarkDiagonal_SeqAIJ(A);CHKERRQ(ierr);}
+    for (i=0; i<m; i++) {
+      d = a->diag[i];
+      if (d >= a->i[i+1] || s->a[d] == (MatScalarSingle)0.0) {
+        s->sor = PETSC_FALSE;
+        break;
+      }
+      s->idiag[i] = 1.0/(PetscScalar)s->a[d];
+    }
+  }
+  ierr = PetscLogEventEnd(MAT_Convert,A,0,0,0);CHKERRQ(ierr);
+
+  /* Record the ObjectState so that we can tell when the shadow values need updating */
+  s->state = state;
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatAssemblyEnd_SeqAIJSingle(Mat A,MatAssemblyType mode)
+{
+  PetscErrorCode ierr;
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+
+  PetscFunctionBegin;
+  if (mode == MAT_FLUSH_ASSEMBLY) PetscFunctionReturn(0);
+
+  /* The inode routines would replace the products below, so they are disabled */
+  a->inode.use = PETSC_FALSE;
+  ierr = MatAssemblyEnd_SeqAIJ(A,mode);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* The values may be changed through the array, so the shadow values must be rebuilt afterwards */
+static PetscErrorCode MatSeqAIJRestoreArray_SeqAIJSingle(Mat A,PetscScalar *array[])
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectStateIncrease((PetscObject)A);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* MATMPIAIJ scales its diagonal blocks by calling this routine directly, bypassing MatDiagonalScale() */
+PetscErrorCode MatDiagonalScale_SeqAIJSingle(Mat A,Vec ll,Vec rr)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatDiagonalScale_SeqAIJ(A,ll,rr);CHKERRQ(ierr);
+  ierr = PetscObjectStateIncrease((PetscObject)A);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* z = A x + y with y = NULL meaning zero; sums are computed in PetscScalar */
+static void MatMultAdd_SeqAIJSingle_Private(Mat A,const PetscScalar *x,const PetscScalar *y,PetscScalar *z)
+{
+  Mat_SeqAIJ            *a = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJSingle      *s = (Mat_SeqAIJSingle*)A->spptr;
+  const PetscInt        *ai = a->i,*aj = a->j,m = A->rmap->n;
+  const MatScalarSingle *aa = s->a;
+  PetscScalar           sum;
+  PetscInt              i,k;
+
+  for (i=0; i<m; i++) {
+    sum = y ? y[i] : 0.0;
+    for (k=ai[i]; k<ai[i+1]; k++) sum += (PetscScalar)aa[k]*x[aj[k]];
+    z[i] = sum;
+  }
+}
+
+/* z = A^T x + y, z may be y */
+static void MatMultTransposeAdd_SeqAIJSingle_Private(Mat A,const PetscScalar *x,PetscScalar *z)
+{
+  Mat_SeqAIJ            *a = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJSingle      *s = (Mat_SeqAIJSingle*)A->spptr;
+  const PetscInt        *ai = a->i,*aj = a->j,m = A->rmap->n;
+  const MatScalarSingle *aa = s->a;
+  PetscScalar           alpha;
+  PetscInt              i,k;
+
+  for (i=0; i<m; i++) {
+    alpha = x[i];
+    for (k=ai[i]; k<ai[i+1]; k++) z[aj[k]] += (PetscScalar)aa[k]*alpha;
+  }
+}
+
+PetscErrorCode MatMult_SeqAIJSingle(Mat A,Vec xx,Vec yy)
+{
+  const PetscScalar *x;
+  PetscScalar       *y;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSeqAIJSingle_build_shadow(A);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArray(yy,&y);CHKERRQ(ierr);
+  MatMultAdd_SeqAIJSingle_Private(A,x,NULL,y);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(yy,&y);CHKERRQ(ierr);
+  ierr = PetscLogFlops(2.0*((Mat_SeqAIJ*)A->data)->nz - ((Mat_SeqAIJ*)A->data)->nonzerorowcnt);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMultAdd_SeqAIJSingle(Mat A,Vec xx,Vec yy,Vec zz)
+{
+  const PetscScalar *x,*y;
+  PetscScalar       *z;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSeqAIJSingle_build_shadow(A);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArrayPair(yy,zz,(PetscScalar**)&y,&z);CHKERRQ(ierr);
+  MatMultAdd_SeqAIJSingle_Private(A,x,y,z);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArrayPair(yy,zz,(PetscScalar**)&y,&z);CHKERRQ(ierr);
+  ierr = PetscLogFlops(2.0*((Mat_SeqAIJ*)A->data)->nz);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMultTransposeAdd_SeqAIJSingle(Mat A,Vec xx,Vec yy,Vec zz)
+{
+  const PetscScalar *x;
+  PetscScalar       *z;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSeqAIJSingle_build_shadow(A);CHKERRQ(ierr);
+  if (zz != yy) {ierr = VecCopy(yy,zz);CHKERRQ(ierr);}
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArray(zz,&z);CHKERRQ(ierr);
+  MatMultTransposeAdd_SeqAIJSingle_Private(A,x,z);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(zz,&z);CHKERRQ(ierr);
+  ierr = PetscLogFlops(2.0*((Mat_SeqAIJ*)A->data)->nz);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMultTranspose_SeqAIJSingle(Mat A,Vec xx,Vec yy)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = VecSet(yy,0.0);CHKERRQ(ierr);
+  ierr = MatMultTransposeAdd_SeqAIJSingle(A,xx,yy,yy);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*
+   Plain (local) forward, backward and symmetric sweeps use the single precision values; the Eisenstat trick,
+   the application of the triangular parts, a shift and missing or zero diagonal entries are left to MatSOR_SeqAIJ().
+*/
+PetscErrorCode MatSOR_SeqAIJSingle(Mat A,Vec bb,PetscReal omega,MatSORType flag,PetscReal fshift,PetscInt its,PetscInt lits,Vec xx)
+{
+  Mat_SeqAIJ            *a = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJSingle      *s = (Mat_SeqAIJSingle*)A->spptr;
+  const PetscInt        *ai = a->i,*aj = a->j,m = A->rmap->n;
+  const MatScalarSingle *aa;
+  const PetscScalar     *b,*idiag;
+  PetscScalar           *x,sum;
+  PetscInt              i,k;
+  PetscErrorCode        ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSeqAIJSingle_build_shadow(A);CHKERRQ(ierr);
+  if ((flag & (SOR_EISENSTAT | SOR_APPLY_UPPER | SOR_APPLY_LOWER)) || fshift != 0.0 || !s->sor) {
+    ierr = MatSOR_SeqAIJ(A,bb,omega,flag,fshift,its,lits,xx);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  if (its <= 0 || lits <= 0) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONG,"Relaxation requires global its %D and local its %D both positive",its,lits);
+  its *= lits;
+
+  if (flag & SOR_ZERO_INITIAL_GUESS) {ierr = VecSet(xx,0.0);CHKERRQ(ierr);}
+  ierr  = VecGetArray(xx,&x);CHKERRQ(ierr);
+  ierr  = VecGetArrayRead(bb,&b);CHKERRQ(ierr);
+  aa    = s->a;
+  idiag = s->idiag;
+  while (its--) {
+    if (flag & (SOR_FORWARD_SWEEP | SOR_LOCAL_FORWARD_SWEEP)) {
+      for (i=0; i<m; i++) {
+        sum = b[i];
+        for (k=ai[i]; k<ai[i+1]; k++) sum -= (PetscScalar)aa[k]*x[aj[k]];
+        x[i] += omega*sum*idiag[i];
+      }
+      ierr = PetscLogFlops(2.0*a->nz + 3.0*m);CHKERRQ(ierr);
+    }
+    if (flag & (SOR_BACKWARD_SWEEP | SOR_LOCAL_BACKWARD_SWEEP)) {
+      for (i=m-1; i>=0; i--) {
+        sum = b[i];
+        for (k=ai[i]; k<ai[i+1]; k++) sum -= (PetscScalar)aa[k]*x[aj[k]];
+        x[i] += omega*sum*idiag[i];
+      }
+      ierr = PetscLogFlops(2.0*a->nz + 3.0*m);CHKERRQ(ierr);
+    }
+  }
+  ierr = VecRestoreArray(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(bb,&b);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* Products computed with the AIJ routines are converted, so that the Galerkin coarse operators of PCGAMG and PCMG keep the class */
+PetscErrorCode MatPtAP_SeqAIJSingle_SeqAIJ(Mat A,Mat P,MatReuse scall,PetscReal fill,Mat *C)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatPtAP_SeqAIJ_SeqAIJ(A,P,scall,fill,C);CHKERRQ(ierr);
+  if (scall == MAT_INITIAL_MATRIX) {
+    ierr = MatConvert_SeqAIJ_SeqAIJSingle(*C,MATSEQAIJSINGLE,MAT_INPLACE_MATRIX,C);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+/* MatConvert_SeqAIJ_SeqAIJSingle converts a SeqAIJ matrix into a
+ * SeqAIJSingle matrix.  This routine is called by the MatCreate_SeqAIJSingle()
+ * routine, but can also be used to convert an assembled SeqAIJ matrix
+ * into a SeqAIJSingle one. */
+PETSC_INTERN PetscErrorCode MatConvert_SeqAIJ_SeqAIJSingle(Mat A,MatType type,MatReuse reuse,Mat *newmat)
+{
+  PetscErrorCode   ierr;
+  Mat              B = *newmat;
+  Mat_SeqAIJ       *b;
+  Mat_SeqAIJSingle *s;
+  PetscBool        sametype;
+
+  PetscFunctionBegin;
+  if (reuse == MAT_INITIAL_MATRIX) {
+    ierr = MatDuplicate(A,MAT_COPY_VALUES,&B);CHKERRQ(ierr);
+  }
+
+  ierr = PetscObjectTypeCompare((PetscObject)A,type,&sametype);CHKERRQ(ierr);
+  if (sametype) PetscFunctionReturn(0);
+
+  ierr     = PetscNewLog(B,&s);CHKERRQ(ierr);
+  b        = (Mat_SeqAIJ*)B->data;
+  B->spptr = (void*)s;
+  s->state = -1;
+
+  /* Disable use of the inode routines so that the AIJSINGLE ones will be used instead.
+   * This happens in MatAssemblyEnd_SeqAIJSingle as well, but the assembly end may not be called, so set it here, too. */
+  b->inode.use = PETSC_FALSE;
+
+  s->destroy               = B->ops->destroy;
+  B->ops->assemblyend      = MatAssemblyEnd_SeqAIJSingle;
+  B->ops->destroy          = MatDestroy_SeqAIJSingle;
+  B->ops->mult             = MatMult_SeqAIJSingle;
+  B->ops->multtranspose    = MatMultTranspose_SeqAIJSingle;
+  B->ops->multadd          = MatMultAdd_SeqAIJSingle;
+  B->ops->multtransposeadd = MatMultTransposeAdd_SeqAIJSingle;
+  B->ops->sor              = MatSOR_SeqAIJSingle;
+  B->ops->diagonalscale    = MatDiagonalScale_SeqAIJSingle;
+  B->ops->ptap             = MatPtAP_SeqAIJSingle_SeqAIJ;
+
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqaijsingle_seqaij_C",MatConvert_SeqAIJSingle_SeqAIJ);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatSeqAIJRestoreArray_C",MatSeqAIJRestoreArray_SeqAIJSingle);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatPtAP_seqaij_seqaijsingle_C",MatPtAP_SeqAIJ_SeqAIJ);CHKERRQ(ierr);
+
+  ierr    = PetscObjectChangeTypeName((PetscObject)B,MATSEQAIJSINGLE);CHKERRQ(ierr);
+  *newmat = B;
+  PetscFunctionReturn(0);
+}
+
+PETSC_EXTERN PetscErrorCode MatCreate_SeqAIJSingle(Mat A)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSetType(A,MATSEQAIJ);CHKERRQ(ierr);
+  ierr = MatConvert_SeqAIJ_SeqAIJSingle(A,MATSEQAIJSINGLE,MAT_INPLACE_MATRIX,&A);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*MC
+   MATSEQAIJSINGLE - MATSEQAIJSINGLE = "seqaijsingle" - A sequential AIJ matrix whose products and relaxation
+   sweeps use a copy of the nonzero values rounded to single precision.
+
+   The vectors, the sums and all other operations (factorizations, MatGetValues(), MatPtAP(), ...) keep the precision of
+   PetscScalar. Since sparse matrix-vector products are limited by memory bandwidth, reading 4 instead of 8 bytes per
+   value makes MatMult() and MatSOR() faster, at the price of a relative perturbation of the matrix of about 1e-7. This is
+   usually harmless when the matrix defines a preconditioner or a smoother (PCJACOBI, PCSOR, the levels of PCGAMG).
+
+   The single precision copy is kept in addition to the double precision values, which all the other operations need,
+   so the matrix uses more memory than MATSEQAIJ, not less. The copy takes 4 bytes per nonzero, half of what the double
+   precision values take, plus one PetscScalar per row for the inverse of the diagonal used by MatSOR(). With 32 bit
+   PetscInt, MATSEQAIJ stores 12 bytes per nonzero, so the matrix grows by about a third; with 64 bit indices by a
+   quarter. The copy is allocated at the first product or sweep, and its size is reported with -info. Use this type
+   only when this memory is available; it reduces the data read by each product, not the data stored.
+
+   Because SEQAIJSINGLE is a subtype of SEQAIJ, the option "-mat_seqaij_type seqaijsingle" can be used to make
+   sequential AIJ matrices default to being instances of MATSEQAIJSINGLE. The Galerkin products MatPtAP() computed for
+   PCGAMG and PCMG are again of this type.
+
+   Options Database Keys:
+. -mat_type seqaijsingle - sets the matrix type to "seqaijsingle" during a call to MatSetFromOptions()
+
+   Level: intermediate
+
+.seealso: MatCreate(), MATSEQAIJ, MATAIJSINGLE, MATMPIAIJSINGLE
+M*/
@@ -4,6 +4,9 @@
   by taking advantage of rows with identical nonzero structure (I-nodes).
 */
 #include <../src/mat/impls/aij/seq/aij.h>
+#if defined(PETSC_HAVE_OPENMP)
+#include <omp.h>
+#endif
 
 static PetscErrorCode MatCreateColInode_Private(Mat A,PetscInt *size,PetscInt **ns)
 {
@@ -373,32 +376,26 @@ static PetscErrorCode MatRestoreColumnIJ_SeqAIJ_Inode(Mat A,PetscInt oshift,Pets
 
 /* ----------------------------------------------------------- */
 
-static PetscErrorCode MatMult_SeqAIJ_Inode(Mat A,Vec xx,Vec yy)
+/*
+   Computes the rows of y of the inodes node0 <= i < node1, the first of which is row; shared by the sequential
+   and the threaded MatMult(). Returns the number of nonzero rows, or -1 if an inode size is not supported.
+*/
+static PetscInt MatMultKernel_SeqAIJ_Inode(const Mat_SeqAIJ *a,const PetscScalar *x,PetscScalar *y,PetscInt node0,PetscInt node1,PetscInt row)
 {
-  Mat_SeqAIJ        *a = (Mat_SeqAIJ*)A->data;
   PetscScalar       sum1,sum2,sum3,sum4,sum5,tmp0,tmp1;
-  PetscScalar       *y;
-  const PetscScalar *x;
   const MatScalar   *v1,*v2,*v3,*v4,*v5;
-  PetscErrorCode    ierr;
-  PetscInt          i1,i2,n,i,row,node_max,nsz,sz,nonzerorow=0;
-  const PetscInt    *idx,*ns,*ii;
+  PetscInt          i1,i2,n,i,nsz,sz,nonzerorow=0;
+  const PetscInt    *idx,*ns = a->inode.size,*ii;
 
 #if defined(PETSC_HAVE_PRAGMA_DISJOINT)
 #pragma disjoint(*x,*y,*v1,*v2,*v3,*v4,*v5)
 #endif
 
-  PetscFunctionBegin;
-  if (!a->inode.size) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_COR,"Missing Inode Structure");
-  node_max = a->inode.node_count;
-  ns       = a->inode.size;     /* Node Size array */
-  ierr     = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
-  ierr     = VecGetArray(yy,&y);CHKERRQ(ierr);
-  idx      = a->j;
-  v1       = a->a;
-  ii       = a->i;
+  idx = a->j + a->i[row];
+  v1  = a->a + a->i[row];
+  ii  = a->i + row;
 
-  for (i = 0,row = 0; i< node_max; ++i) {
+  for (i = node0; i< node1; ++i) {
     nsz         = ns[i];
     n           = ii[1] - ii[0];
     nonzerorow += (n>0)*nsz;
@@ -553,41 +550,47 @@ static PetscErrorCode MatMult_SeqAIJ_Inode(Mat A,Vec xx,Vec yy)
       idx    +=4*sz;
       break;
     default:
-      SETERRQ(PETSC_COMM_SELF,PETSC_ERR_COR,"Node size not yet supported");
+      return -1;
     }
   }
+  return nonzerorow;
+}
+
+static PetscErrorCode MatMult_SeqAIJ_Inode(Mat A,Vec xx,Vec yy)
+{
+  Mat_SeqAIJ        *a = (Mat_SeqAIJ*)A->data;
+  PetscScalar       *y;
+  const PetscScalar *x;
+  PetscErrorCode    ierr;
+  PetscInt          nonzerorow;
+
+  PetscFunctionBegin;
+  if (!a->inode.size) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_COR,"Missing Inode Structure");
+  ierr       = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr       = VecGetArray(yy,&y);CHKERRQ(ierr);
+  nonzerorow = MatMultKernel_SeqAIJ_Inode(a,x,y,0,a->inode.node_count,0);
+  if (nonzerorow < 0) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_COR,"Node size not yet supported");
   ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
   ierr = VecRestoreArray(yy,&y);CHKERRQ(ierr);
   ierr = PetscLogFlops(2.0*a->nz - nonzerorow);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 /* ----------------------------------------------------------- */
-/* Almost same code as the MatMult_SeqAIJ_Inode() */
-static PetscErrorCode MatMultAdd_SeqAIJ_Inode(Mat A,Vec xx,Vec zz,Vec yy)
+/* Almost same code as the MatMultKernel_SeqAIJ_Inode(), returns PETSC_TRUE if an inode size is not supported */
+static PetscBool MatMultAddKernel_SeqAIJ_Inode(const Mat_SeqAIJ *a,const PetscScalar *x,const PetscScalar *z,PetscScalar *y,PetscInt node0,PetscInt node1,PetscInt row)
 {
-  Mat_SeqAIJ        *a = (Mat_SeqAIJ*)A->data;
   PetscScalar       sum1,sum2,sum3,sum4,sum5,tmp0,tmp1;
   const MatScalar   *v1,*v2,*v3,*v4,*v5;
-  const PetscScalar *x;
-  PetscScalar       *y,*z,*zt;
-  PetscErrorCode    ierr;
-  PetscInt          i1,i2,n,i,row,node_max,nsz,sz;
-  const PetscInt    *idx,*ns,*ii;
-
-  PetscFunctionBegin;
-  if (!a->inode.size) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_COR,"Missing Inode Structure");
-  node_max = a->inode.node_count;
-  ns       = a->inode.size;     /* Node Size array */
-
-  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
-  ierr = VecGetArrayPair(zz,yy,&z,&y);CHKERRQ(ierr);
-  zt = z;
+  const PetscScalar *zt;
+  PetscInt          i1,i2,n,i,nsz,sz;
+  const PetscInt    *idx,*ns = a->inode.size,*ii;
 
-  idx = a->j;
-  v1  = a->a;
-  ii  = a->i;
+  zt  = z + row;
+  idx = a->j + a->i[row];
+  v1  = a->a + a->i[row];
+  ii  = a->i + row;
 
-  for (i = 0,row = 0; i< node_max; ++i) {
+  for (i = node0; i< node1; ++i) {
     nsz = ns[i];
     n   = ii[1] - ii[0];
     ii += nsz;
@@ -739,15 +742,100 @@ static PetscErrorCode MatMultAdd_SeqAIJ_Inode(Mat A,Vec xx,Vec zz,Vec yy)
       idx    +=4*sz;
       break;
     default:
-      SETERRQ(PETSC_COMM_SELF,PETSC_ERR_COR,"Node size not yet supported");
+      return PETSC_TRUE;
     }
   }
+  return PETSC_FALSE;
+}
+
+static PetscErrorCode MatMultAdd_SeqAIJ_Inode(Mat A,Vec xx,Vec zz,Vec yy)
+{
+  Mat_SeqAIJ        *a = (Mat_SeqAIJ*)A->data;
+  const PetscScalar *x;
+  PetscScalar       *y,*z;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  if (!a->inode.size) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_COR,"Missing Inode Structure");
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArrayPair(zz,yy,&z,&y);CHKERRQ(ierr);
+  if (MatMultAddKernel_SeqAIJ_Inode(a,x,z,y,0,a->inode.node_count,0)) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_COR,"Node size not yet supported");
   ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
   ierr = VecRestoreArrayPair(zz,yy,&z,&y);CHKERRQ(ierr);
   ierr = PetscLogFlops(2.0*a->nz);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
+#if defined(PETSC_HAVE_OPENMP)
+/* each thread multiplies the inodes assigned to it by MatSeqAIJSetUpOpenMP() */
+PetscErrorCode MatMult_SeqAIJ_Inode_OpenMP(Mat A,Vec xx,Vec yy)
+{
+  Mat_SeqAIJ        *a = (Mat_SeqAIJ*)A->data;
+  PetscScalar       *y;
+  const PetscScalar *x;
+  PetscErrorCode    ierr;
+  PetscInt          t,nt = a->omp.nthreads,nonzerorow = 0,bad = 0;
+  const PetscInt    *rstart,*nstart;
+  PetscLogDouble    *time;
+
+  PetscFunctionBegin;
+  if (!a->inode.size) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_COR,"Missing Inode Structure");
+  if (a->omp.mat_nonzerostate != A->nonzerostate) {ierr = MatSeqAIJSetUpOpenMP(A);CHKERRQ(ierr);}
+  rstart = a->omp.rstart;
+  nstart = a->omp.nstart;
+  time   = a->omp.time;
+  ierr   = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr   = VecGetArray(yy,&y);CHKERRQ(ierr);
+#pragma omp parallel for schedule(static,1) num_threads(nt) reduction(+:nonzerorow,bad)
+  for (t=0; t<nt; t++) {
+    double   t0 = omp_get_wtime();
+    PetscInt nzr;
+
+    nzr = MatMultKernel_SeqAIJ_Inode(a,x,y,nstart[t],nstart[t+1],rstart[t]);
+    if (nzr < 0) bad++;
+    else nonzerorow += nzr;
+    time[t] += omp_get_wtime() - t0;
+  }
+  if (bad) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_COR,"Node size not yet supported");
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(yy,&y);CHKERRQ(ierr);
+  ierr = PetscLogFlops(2.0*a->nz - nonzerorow);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMultAdd_SeqAIJ_Inode_OpenMP(Mat A,Vec xx,Vec zz,Vec yy)
+{
+  Mat_SeqAIJ        *a = (Mat_SeqAIJ*)A->data;
+  const PetscScalar *x;
+  PetscScalar       *y,*z;
+  PetscErrorCode    ierr;
+  PetscInt          t,nt = a->omp.nthreads,bad = 0;
+  const PetscInt    *rstart,*nstart;
+  PetscLogDouble    *time;
+
+  PetscFunctionBegin;
+  if (!a->inode.size) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_COR,"Missing Inode Structure");
+  if (a->omp.mat_nonzerostate != A->nonzerostate) {ierr = MatSeqAIJSetUpOpenMP(A);CHKERRQ(ierr);}
+  rstart = a->omp.rstart;
+  nstart = a->omp.nstart;
+  time   = a->omp.time;
+  ierr   = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr   = VecGetArrayPair(zz,yy,&z,&y);CHKERRQ(ierr);
+#pragma omp parallel for schedule(static,1) num_threads(nt) reduction(+:bad)
+  for (t=0; t<nt; t++) {
+    double t0 = omp_get_wtime();
+
+    if (MatMultAddKernel_SeqAIJ_Inode(a,x,z,y,nstart[t],nstart[t+1],rstart[t])) bad++;
+    time[t] += omp_get_wtime() - t0;
+  }
+  if (bad) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_COR,"Node size not yet supported");
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArrayPair(zz,yy,&z,&y);CHKERRQ(ierr);
+  ierr = PetscLogFlops(2.0*a->nz);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+#endif
+
 /* ----------------------------------------------------------- */
 PetscErrorCode MatSolve_SeqAIJ_Inode_inplace(Mat A,Vec bb,Vec xx)
 {
@@ -1845,6 +1933,7 @@ PetscErrorCode MatLUFactorNumeric_SeqAIJ_Inode(Mat B,Mat A,const MatFactorInfo *
   } else {
     C->ops->solve           = MatSolve_SeqAIJ;
   }
+  ierr = MatSeqAIJSetUpSolveLevels(C);CHKERRQ(ierr);
   C->ops->solveadd          = MatSolveAdd_SeqAIJ;
   C->ops->solvetranspose    = MatSolveTranspose_SeqAIJ;
   C->ops->solvetransposeadd = MatSolveTransposeAdd_SeqAIJ;
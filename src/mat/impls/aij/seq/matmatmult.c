@@ -9,6 +9,9 @@
  #include <petscbt.h>
  #include <petsc/private/isimpl.h>
  #include <../src/mat/impls/dense/seq/dense.h>
+ #if defined(PETSC_HAVE_OPENMP)
+ #include <omp.h>
+ #endif
 
 
  PETSC_INTERN PetscErrorCode MatMatMult_SeqAIJ_SeqAIJ(Mat A,Mat B,MatReuse scall,PetscReal fill,Mat *C)
@@ -45,11 +48,11 @@
  {
    PetscErrorCode ierr;
  #if !defined(PETSC_HAVE_HYPRE)
-   const char     *algTypes[8] = {"sorted","scalable","scalable_fast","heap","btheap","llcondensed","combined","rowmerge"};
-   PetscInt       nalg = 8;
- #else
-   const char     *algTypes[9] = {"sorted","scalable","scalable_fast","heap","btheap","llcondensed","combined","rowmerge","hypre"};
+   const char     *algTypes[9] = {"sorted","scalable","scalable_fast","heap","btheap","llcondensed","combined","rowmerge","hash"};
    PetscInt       nalg = 9;
+ #else
+   const char     *algTypes[10] = {"sorted","scalable","scalable_fast","heap","btheap","llcondensed","combined","rowmerge","hash","hypre"};
+   PetscInt       nalg = 10;
  #endif
    PetscInt       alg = 0; /* set default algorithm */
 
@@ -79,8 +82,11 @@
    case 7:
      ierr = MatMatMultSymbolic_SeqAIJ_SeqAIJ_RowMerge(A,B,fill,C);CHKERRQ(ierr);
      break;
- #if defined(PETSC_HAVE_HYPRE)
    case 8:
+     ierr = MatMatMultSymbolic_SeqAIJ_SeqAIJ_Hash(A,B,fill,C);CHKERRQ(ierr);
+     break;
+ #if defined(PETSC_HAVE_HYPRE)
+   case 9:
      ierr = MatMatMultSymbolic_AIJ_AIJ_wHYPRE(A,B,fill,C);CHKERRQ(ierr);
      break;
  #endif
@@ -1105,6 +1111,230 @@ PetscErrorCode MatMatMultSymbolic_SeqAIJ_SeqAIJ_Sorted(Mat A,Mat B,PetscReal fil
   PetscFunctionReturn(0);
 }
 
+/*
+   Hash based product: each row of C is accumulated in an open addressing table with linear probing whose size is a
+   power of 2 at least twice the number of entries it receives, so the work per row does not depend on the number
+   of columns of B. The rows are independent, so they are processed by OpenMP threads when PETSc is configured with
+   OpenMP (the number of threads is that of -mat_aij_openmp_threads of A). The symbolic phase counts the row lengths
+   of C in a first pass and fills in the sorted column indices in a second one, the numeric phase reuses them, so that
+   MatMatMult() with MAT_REUSE_MATRIX only recomputes the values.
+*/
+#define MatMatMultHash_Private(col,mask) ((PetscInt)(((size_t)(col)*2654435761u) & (size_t)(mask)))
+
+PETSC_STATIC_INLINE PetscInt MatMatMultHashSize_Private(PetscInt n)
+{
+  PetscInt size = 4;
+
+  while (size < 2*n) size *= 2;
+  return size;
+}
+
+/* sorts the column indices gathered from the table; PetscSortInt() cannot be called from the threads */
+static void MatMatMultHashSort_Private(PetscInt n,PetscInt *v)
+{
+  PetscInt i,j,pivot,tmp;
+
+  while (n > 16) {
+    tmp = v[0]; v[0] = v[n/2]; v[n/2] = tmp;
+    pivot = v[0];
+    for (i=0,j=1; j<n; j++) {
+      if (v[j] < pivot) {i++; tmp = v[i]; v[i] = v[j]; v[j] = tmp;}
+    }
+    tmp = v[0]; v[0] = v[i]; v[i] = tmp;
+    /* recurse on the smaller part */
+    if (i < n-i-1) {
+      MatMatMultHashSort_Private(i,v);
+      v += i+1; n -= i+1;
+    } else {
+      MatMatMultHashSort_Private(n-i-1,v+i+1);
+      n = i;
+    }
+  }
+  for (i=1; i<n; i++) {
+    tmp = v[i];
+    for (j=i; j>0 && v[j-1] > tmp; j--) v[j] = v[j-1];
+    v[j] = tmp;
+  }
+}
+
+PetscErrorCode MatMatMultSymbolic_SeqAIJ_SeqAIJ_Hash(Mat A,Mat B,PetscReal fill,Mat *C)
+{
+  PetscErrorCode ierr;
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data,*b = (Mat_SeqAIJ*)B->data,*c;
+  const PetscInt *ai = a->i,*aj = a->j,*bi = b->i,*bj = b->j;
+  PetscInt       am = A->rmap->N,bn = B->cmap->N,bm = B->rmap->N;
+  PetscInt       i,nt = 1,maxub = 0,tsize,*ci,*cj,*table;
+  PetscReal      afill;
+
+  PetscFunctionBegin;
+#if defined(PETSC_HAVE_OPENMP)
+  nt = a->omp.nthreads;
+#endif
+  ierr = PetscMalloc1(am+1,&ci);CHKERRQ(ierr);
+  ci[0] = 0;
+
+  /* upper bounds of the row lengths of C, kept in ci[] until the first pass replaces them with the lengths */
+  for (i=0; i<am; i++) {
+    PetscInt j,ub = 0;
+
+    for (j=ai[i]; j<ai[i+1]; j++) ub += bi[aj[j]+1] - bi[aj[j]];
+    ci[i+1] = PetscMin(ub,bn);
+    maxub   = PetscMax(maxub,ci[i+1]);
+  }
+  tsize = MatMatMultHashSize_Private(maxub);
+  ierr  = PetscMalloc1(nt*tsize,&table);CHKERRQ(ierr);
+
+  /* first pass: the number of nonzeros of each row of C */
+#if defined(PETSC_HAVE_OPENMP)
+#pragma omp parallel for schedule(dynamic,64) num_threads(nt)
+#endif
+  for (i=0; i<am; i++) {
+#if defined(PETSC_HAVE_OPENMP)
+    PetscInt *ht = table + tsize*omp_get_thread_num();
+#else
+    PetscInt *ht = table;
+#endif
+    PetscInt size = MatMatMultHashSize_Private(ci[i+1]),mask = size-1,n = 0,h,j,k,col;
+
+    for (h=0; h<size; h++) ht[h] = -1;
+    for (j=ai[i]; j<ai[i+1]; j++) {
+      for (k=bi[aj[j]]; k<bi[aj[j]+1]; k++) {
+        col = bj[k];
+        h   = MatMatMultHash_Private(col,mask);
+        while (ht[h] != -1 && ht[h] != col) h = (h+1) & mask;
+        if (ht[h] == -1) {ht[h] = col; n++;}
+      }
+    }
+    ci[i+1] = n;
+  }
+  for (i=0; i<am; i++) ci[i+1] += ci[i];
+  ierr = PetscMalloc1(ci[am]+1,&cj);CHKERRQ(ierr);
+
+  /* second pass: gather and sort the column indices of each row of C */
+#if defined(PETSC_HAVE_OPENMP)
+#pragma omp parallel for schedule(dynamic,64) num_threads(nt)
+#endif
+  for (i=0; i<am; i++) {
+#if defined(PETSC_HAVE_OPENMP)
+    PetscInt *ht = table + tsize*omp_get_thread_num();
+#else
+    PetscInt *ht = table;
+#endif
+    PetscInt size = MatMatMultHashSize_Private(ci[i+1]-ci[i]),mask = size-1,n = 0,h,j,k,col,*crow = cj + ci[i];
+
+    for (h=0; h<size; h++) ht[h] = -1;
+    for (j=ai[i]; j<ai[i+1]; j++) {
+      for (k=bi[aj[j]]; k<bi[aj[j]+1]; k++) {
+        col = bj[k];
+        h   = MatMatMultHash_Private(col,mask);
+        while (ht[h] != -1 && ht[h] != col) h = (h+1) & mask;
+        ht[h] = col;
+      }
+    }
+    for (h=0; h<size; h++) if (ht[h] != -1) crow[n++] = ht[h];
+    MatMatMultHashSort_Private(n,crow);
+  }
+  ierr = PetscFree(table);CHKERRQ(ierr);
+
+  /* put together the new symbolic matrix */
+  ierr = MatCreateSeqAIJWithArrays(PetscObjectComm((PetscObject)A),am,bn,ci,cj,NULL,C);CHKERRQ(ierr);
+  ierr = MatSetBlockSizesFromMats(*C,A,B);CHKERRQ(ierr);
+  ierr = MatSetType(*C,((PetscObject)A)->type_name);CHKERRQ(ierr);
+
+  /* MatCreateSeqAIJWithArrays flags matrix so PETSc doesn't free the user's arrays. */
+  /* These are PETSc arrays, so change flags so arrays can be deleted by PETSc */
+  c          = (Mat_SeqAIJ*)((*C)->data);
+  c->free_a  = PETSC_TRUE;
+  c->free_ij = PETSC_TRUE;
+  c->nonew   = 0;
+
+  (*C)->ops->matmultnumeric = MatMatMultNumeric_SeqAIJ_SeqAIJ_Hash;
+
+  /* set MatInfo */
+  afill = (PetscReal)ci[am]/(ai[am]+bi[bm]) + 1.e-5;
+  if (afill < 1.0) afill = 1.0;
+  c->maxnz                     = ci[am];
+  c->nz                        = ci[am];
+  (*C)->info.mallocs           = 0;
+  (*C)->info.fill_ratio_given  = fill;
+  (*C)->info.fill_ratio_needed = afill;
+
+#if defined(PETSC_USE_INFO)
+  if (ci[am]) {
+    ierr = PetscInfo4((*C),"Hash tables of at most %D entries on %D threads; Fill ratio: given %g needed %g.\n",tsize,nt,(double)fill,(double)afill);CHKERRQ(ierr);
+    ierr = PetscInfo1((*C),"Use MatMatMult(A,B,MatReuse,%g,&C) for best performance.;\n",(double)afill);CHKERRQ(ierr);
+  } else {
+    ierr = PetscInfo((*C),"Empty matrix product\n");CHKERRQ(ierr);
+  }
+#endif
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMatMultNumeric_SeqAIJ_SeqAIJ_Hash(Mat A,Mat B,Mat C)
+{
+  PetscErrorCode  ierr;
+  Mat_SeqAIJ      *a = (Mat_SeqAIJ*)A->data,*b = (Mat_SeqAIJ*)B->data,*c = (Mat_SeqAIJ*)C->data;
+  const PetscInt  *ai = a->i,*aj = a->j,*bi = b->i,*bj = b->j,*ci = c->i,*cj = c->j;
+  const MatScalar *aa = a->a,*ba = b->a;
+  MatScalar       *ca;
+  PetscInt        i,cm = C->rmap->n,nt = 1,tsize,nmissing = 0,*table;
+  PetscLogDouble  flops = 0.0;
+
+  PetscFunctionBegin;
+#if defined(PETSC_HAVE_OPENMP)
+  nt = a->omp.nthreads;
+#endif
+  if (!c->a) { /* first call of MatMatMultNumeric_SeqAIJ_SeqAIJ_Hash, allocate ca */
+    ierr      = PetscMalloc1(ci[cm]+1,&c->a);CHKERRQ(ierr);
+    c->free_a = PETSC_TRUE;
+  }
+  ca = c->a;
+
+  /* each table entry holds a column of the row of C and the position of that column in cj[] */
+  tsize = MatMatMultHashSize_Private(c->rmax);
+  ierr  = PetscMalloc1(2*nt*tsize,&table);CHKERRQ(ierr);
+#if defined(PETSC_HAVE_OPENMP)
+#pragma omp parallel for schedule(dynamic,64) num_threads(nt) reduction(+:flops,nmissing)
+#endif
+  for (i=0; i<cm; i++) {
+#if defined(PETSC_HAVE_OPENMP)
+    PetscInt *ht = table + 2*tsize*omp_get_thread_num();
+#else
+    PetscInt *ht = table;
+#endif
+    PetscInt       cnz = ci[i+1]-ci[i],size = MatMatMultHashSize_Private(cnz),mask = size-1,*pos = ht + size,h,j,k,col;
+    const PetscInt *crow = cj + ci[i];
+    MatScalar      *cval = ca + ci[i],aval;
+
+    for (h=0; h<size; h++) ht[h] = -1;
+    for (k=0; k<cnz; k++) {
+      h = MatMatMultHash_Private(crow[k],mask);
+      while (ht[h] != -1) h = (h+1) & mask;
+      ht[h]  = crow[k];
+      pos[h] = k;
+      cval[k] = 0.0;
+    }
+    for (j=ai[i]; j<ai[i+1]; j++) {
+      aval = aa[j];
+      for (k=bi[aj[j]]; k<bi[aj[j]+1]; k++) {
+        col = bj[k];
+        h   = MatMatMultHash_Private(col,mask);
+        while (ht[h] != -1 && ht[h] != col) h = (h+1) & mask;
+        if (ht[h] == col) cval[pos[h]] += aval*ba[k];
+        else nmissing++;
+      }
+      flops += 2*(bi[aj[j]+1]-bi[aj[j]]);
+    }
+  }
+  ierr = PetscFree(table);CHKERRQ(ierr);
+  if (nmissing) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONGSTATE,"%D products fall outside of the nonzero pattern of C, the nonzero pattern of A or B changed since the symbolic product",nmissing);
+
+  ierr = MatAssemblyBegin(C,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(C,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = PetscLogFlops(flops);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 /* This routine is not used. Should be removed! */
 PetscErrorCode MatMatTransposeMult_SeqAIJ_SeqAIJ(Mat A,Mat B,MatReuse scall,PetscReal fill,Mat *C)
 {
@@ -22,8 +22,8 @@ PetscErrorCode MatInvertBlockDiagonal_SeqBAIJ(Mat A,const PetscScalar **values)
 {
   Mat_SeqBAIJ    *a = (Mat_SeqBAIJ*) A->data;
   PetscErrorCode ierr;
-  PetscInt       *diag_offset,i,bs = A->rmap->bs,mbs = a->mbs,ipvt[5],bs2 = bs*bs,*v_pivots;
-  MatScalar      *v    = a->a,*odiag,*diag,work[25],*v_work;
+  PetscInt       *diag_offset,i,bs = A->rmap->bs,mbs = a->mbs,ipvt[5],bs2 = bs*bs;
+  MatScalar      *v    = a->a,*odiag,*diag,work[25];
   PetscReal      shift = 0.0;
   PetscBool      allowzeropivot,zeropivotdetected=PETSC_FALSE;
 
@@ -119,15 +119,13 @@ PetscErrorCode MatInvertBlockDiagonal_SeqBAIJ(Mat A,const PetscScalar **values)
     }
     break;
   default:
-    ierr = PetscMalloc2(bs,&v_work,bs,&v_pivots);CHKERRQ(ierr);
+    /* the larger blocks are inverted together */
     for (i=0; i<mbs; i++) {
       odiag  = v + bs2*diag_offset[i];
-      ierr   = PetscMemcpy(diag,odiag,bs2*sizeof(PetscScalar));CHKERRQ(ierr);
-      ierr   = PetscKernel_A_gets_inverse_A(bs,diag,v_pivots,v_work,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
-      if (zeropivotdetected) A->factorerrortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
-      diag  += bs2;
+      ierr   = PetscMemcpy(diag+bs2*i,odiag,bs2*sizeof(PetscScalar));CHKERRQ(ierr);
     }
-    ierr = PetscFree2(v_work,v_pivots);CHKERRQ(ierr);
+    ierr = PetscKernel_A_gets_inverse_A_Batch(bs,mbs,NULL,diag,PETSC_FALSE,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
+    if (zeropivotdetected) A->factorerrortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
   }
   a->idiagvalid = PETSC_TRUE;
   PetscFunctionReturn(0);
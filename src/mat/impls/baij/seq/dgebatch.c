@@ -0,0 +1,118 @@
+/*
+     Inverts many small dense matrices of the same size with Gauss-Jordan elimination with partial pivoting.
+
+       Used by MatInvertBlockDiagonal() and MatInvertVariableBlockDiagonal() for the point block
+     Jacobi preconditioners.
+
+       The blocks are interleaved PETSC_KERNEL_BATCH at a time (structure of arrays: entry (i,j) of all
+     the blocks of a batch is contiguous) so that the elimination, which does the same operations on all
+     the blocks of a batch, vectorizes across the blocks. Only the pivot searches and the row interchanges
+     are done one block at a time.
+*/
+#include <petscsys.h>
+#include <petsc/private/kernels/blockinvert.h>
+
+#define PETSC_KERNEL_BATCH 8
+
+/*
+    A_i = inv(A_i) for i = 0,...,nb-1     A_gets_inverse_A_Batch
+
+   bs        - size of the blocks
+   nb        - number of blocks
+   offsets   - block i starts at a + offsets[i], or at a + i*bs*bs if offsets is NULL
+   a         - the blocks, each stored in column major order (or row major, the inverse of the transpose is the transpose of the inverse)
+   transpose - store the transposes of the inverses, that is switch between column and row major order
+*/
+PETSC_INTERN PetscErrorCode PetscKernel_A_gets_inverse_A_Batch(PetscInt bs,PetscInt nb,const PetscInt *offsets,MatScalar *a,PetscBool transpose,PetscBool allowzeropivot,PetscBool *zeropivotdetected)
+{
+  const PetscInt W = PETSC_KERNEL_BATCH,bs2 = bs*bs;
+  PetscInt       b,nw,w,i,j,k,p,*piv;
+  MatScalar      *s,*blk[PETSC_KERNEL_BATCH],d[PETSC_KERNEL_BATCH],f[PETSC_KERNEL_BATCH],*sk,*si,tmp;
+  MatReal        max,amax;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (zeropivotdetected) *zeropivotdetected = PETSC_FALSE;
+  if (!nb) PetscFunctionReturn(0);
+  ierr = PetscMalloc2(bs2*W,&s,bs*W,&piv);CHKERRQ(ierr);
+  for (b=0; b<nb; b+=W) {
+    nw = PetscMin(W,nb-b);
+
+    /* interleave the blocks, the unused lanes of the last batch get the identity */
+    for (w=0; w<nw; w++) blk[w] = a + (offsets ? offsets[b+w] : (b+w)*bs2);
+    for (k=0; k<bs2; k++) {
+      for (w=0; w<nw; w++) s[k*W+w] = blk[w][k];
+      for (w=nw; w<W; w++) s[k*W+w] = (k % (bs+1)) ? 0.0 : 1.0;
+    }
+
+    for (k=0; k<bs; k++) {
+      /* find the pivots and interchange the rows, block by block */
+      for (w=0; w<nw; w++) {
+        p   = k;
+        max = PetscAbsScalar(s[(k+k*bs)*W+w]);
+        for (i=k+1; i<bs; i++) {
+          amax = PetscAbsScalar(s[(i+k*bs)*W+w]);
+          if (amax > max) {max = amax; p = i;}
+        }
+        piv[k*W+w] = p;
+        if (max == 0.0) {
+          if (allowzeropivot) {
+            ierr = PetscInfo1(NULL,"Zero pivot, row %D\n",k);CHKERRQ(ierr);
+            if (zeropivotdetected) *zeropivotdetected = PETSC_TRUE;
+          } else SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_MAT_LU_ZRPVT,"Zero pivot, row %D",k);
+        }
+        if (p != k) {
+          for (j=0; j<bs; j++) {
+            tmp = s[(k+j*bs)*W+w]; s[(k+j*bs)*W+w] = s[(p+j*bs)*W+w]; s[(p+j*bs)*W+w] = tmp;
+          }
+        }
+      }
+      for (w=nw; w<W; w++) piv[k*W+w] = k;
+
+      /* scale the pivot row and eliminate column k from the other rows, on all the blocks at once */
+      sk = s + (k+k*bs)*W;
+      for (w=0; w<W; w++) {d[w] = 1.0/sk[w]; sk[w] = 1.0;}
+      for (j=0; j<bs; j++) {
+        sk = s + (k+j*bs)*W;
+        for (w=0; w<W; w++) sk[w] *= d[w];
+      }
+      for (i=0; i<bs; i++) {
+        if (i == k) continue;
+        si = s + (i+k*bs)*W;
+        for (w=0; w<W; w++) {f[w] = si[w]; si[w] = 0.0;}
+        for (j=0; j<bs; j++) {
+          si = s + (i+j*bs)*W;
+          sk = s + (k+j*bs)*W;
+          for (w=0; w<W; w++) si[w] -= f[w]*sk[w];
+        }
+      }
+    }
+
+    /* undo the row interchanges by interchanging the columns of the inverses in reverse order */
+    for (k=bs-1; k>=0; k--) {
+      for (w=0; w<nw; w++) {
+        p = piv[k*W+w];
+        if (p != k) {
+          for (i=0; i<bs; i++) {
+            tmp = s[(i+k*bs)*W+w]; s[(i+k*bs)*W+w] = s[(i+p*bs)*W+w]; s[(i+p*bs)*W+w] = tmp;
+          }
+        }
+      }
+    }
+
+    if (transpose) {
+      for (i=0; i<bs; i++) {
+        for (j=0; j<bs; j++) {
+          for (w=0; w<nw; w++) blk[w][j+i*bs] = s[(i+j*bs)*W+w];
+        }
+      }
+    } else {
+      for (k=0; k<bs2; k++) {
+        for (w=0; w<nw; w++) blk[w][k] = s[k*W+w];
+      }
+    }
+  }
+  ierr = PetscFree2(s,piv);CHKERRQ(ierr);
+  ierr = PetscLogFlops(2.0*bs*bs2*nb);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
@@ -24,8 +24,12 @@ typedef struct {
   Mat_SeqAIJ_Inode inode;
   unsigned short   *jshort;
   PetscBool        free_jshort;
+  Mat_SeqAIJ_Levels levels;      /* level scheduled MatSolve() of the factors with block size one, see -mat_aij_solve_levels */
 } Mat_SeqSBAIJ;
 
+PETSC_INTERN PetscErrorCode MatSeqSBAIJSetUpSolveLevels(Mat);
+PETSC_INTERN PetscErrorCode MatSolve_SeqSBAIJ_1_Levels(Mat,Vec,Vec);
+
 PETSC_INTERN PetscErrorCode MatCholeskyFactorSymbolic_SeqSBAIJ(Mat,Mat,IS,const MatFactorInfo*);
 PETSC_INTERN PetscErrorCode MatCholeskyFactorSymbolic_SeqSBAIJ_inplace(Mat,Mat,IS,const MatFactorInfo*);
 PETSC_INTERN PetscErrorCode MatCholeskyFactor_SeqSBAIJ(Mat,IS,const MatFactorInfo*);
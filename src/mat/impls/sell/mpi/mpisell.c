@@ -15,7 +15,13 @@
   the above preallocation routines for simplicity.
 
    Options Database Keys:
-. -mat_type sell - sets the matrix type to "sell" during a call to MatSetFromOptions()
++ -mat_type sell - sets the matrix type to "sell" during a call to MatSetFromOptions()
+. -mat_sell_kernel <auto,default,avx2,avx512> - kernel used by MatMult() and its variants; auto selects the widest instruction set supported by the processor at runtime
+- -mat_sell_report_sigma <sigma> - with -info, MatConvert() from AIJ reports the padding that sorting the rows by length within windows of sigma rows would save; the rows are not reordered
+
+  Notes:
+    The rows are stored in slices of 8 rows, each padded with zeros to the length of its longest row. MatSeqSELLGetFillRatio()
+    and MatView() with PETSC_VIEWER_ASCII_INFO give the amount of padding.
 
   Developer Notes:
     Subclasses include MATSELLCUSP, MATSELLCUSPARSE, MATSELLPERM, MATSELLCRL, and also automatically switches over to use inodes when
@@ -1736,39 +1742,43 @@ PetscErrorCode MatConvert_MPISELL_MPIAIJ(Mat A,MatType newtype,MatReuse reuse,Ma
 
 PetscErrorCode MatConvert_MPIAIJ_MPISELL(Mat A,MatType newtype,MatReuse reuse,Mat *newmat)
 {
-  PetscErrorCode ierr;
-  Mat_MPIAIJ     *a=(Mat_MPIAIJ*)A->data;
-  Mat            B;
-  Mat_MPISELL    *b;
+  PetscErrorCode    ierr;
+  Mat_MPIAIJ        *a=(Mat_MPIAIJ*)A->data;
+  Mat               B;
+  Mat_MPISELL       *b;
+  Mat_SeqAIJ        *Aa=(Mat_SeqAIJ*)a->A->data,*Ba=(Mat_SeqAIJ*)a->B->data;
+  PetscInt          i,row,ncols,*d_nnz,*o_nnz;
+  const PetscInt    *cols;
+  const PetscScalar *vals;
 
   PetscFunctionBegin;
   if (!A->assembled) SETERRQ(PetscObjectComm((PetscObject)A),PETSC_ERR_SUP,"Matrix must be assembled");
 
   if (reuse == MAT_REUSE_MATRIX) {
     B = *newmat;
+    b = (Mat_MPISELL*) B->data;
+    ierr = MatConvert_SeqAIJ_SeqSELL(a->A, MATSEQSELL, MAT_REUSE_MATRIX, &b->A);CHKERRQ(ierr);
+    ierr = MatConvert_SeqAIJ_SeqSELL(a->B, MATSEQSELL, MAT_REUSE_MATRIX, &b->B);CHKERRQ(ierr);
   } else {
     ierr = MatCreate(PetscObjectComm((PetscObject)A),&B);CHKERRQ(ierr);
     ierr = MatSetType(B,MATMPISELL);CHKERRQ(ierr);
     ierr = MatSetSizes(B,A->rmap->n,A->cmap->n,A->rmap->N,A->cmap->N);CHKERRQ(ierr);
     ierr = MatSetBlockSizes(B,A->rmap->bs,A->cmap->bs);CHKERRQ(ierr);
-    ierr = MatSeqAIJSetPreallocation(B,0,NULL);CHKERRQ(ierr);
-    ierr = MatMPIAIJSetPreallocation(B,0,NULL,0,NULL);CHKERRQ(ierr);
-  }
-  b    = (Mat_MPISELL*) B->data;
-
-  if (reuse == MAT_REUSE_MATRIX) {
-    ierr = MatConvert_SeqAIJ_SeqSELL(a->A, MATSEQSELL, MAT_REUSE_MATRIX, &b->A);CHKERRQ(ierr);
-    ierr = MatConvert_SeqAIJ_SeqSELL(a->B, MATSEQSELL, MAT_REUSE_MATRIX, &b->B);CHKERRQ(ierr);
-  } else {
-    ierr = MatDestroy(&b->A);CHKERRQ(ierr);
-    ierr = MatDestroy(&b->B);CHKERRQ(ierr);
-    ierr = MatDisAssemble_MPIAIJ(A);CHKERRQ(ierr);
-    ierr = MatConvert_SeqAIJ_SeqSELL(a->A, MATSEQSELL, MAT_INITIAL_MATRIX, &b->A);CHKERRQ(ierr);
-    ierr = MatConvert_SeqAIJ_SeqSELL(a->B, MATSEQSELL, MAT_INITIAL_MATRIX, &b->B);CHKERRQ(ierr);
+    /* the rows are inserted with their global column indices, so that B builds its own off-diagonal part */
+    ierr = PetscMalloc2(A->rmap->n,&d_nnz,A->rmap->n,&o_nnz);CHKERRQ(ierr);
+    for (i=0; i<A->rmap->n; i++) {
+      d_nnz[i] = Aa->i[i+1]-Aa->i[i];
+      o_nnz[i] = Ba->i[i+1]-Ba->i[i];
+    }
+    ierr = MatMPISELLSetPreallocation(B,0,d_nnz,0,o_nnz);CHKERRQ(ierr);
+    ierr = PetscFree2(d_nnz,o_nnz);CHKERRQ(ierr);
+    for (row=A->rmap->rstart; row<A->rmap->rend; row++) {
+      ierr = MatGetRow(A,row,&ncols,&cols,&vals);CHKERRQ(ierr);
+      ierr = MatSetValues(B,1,&row,ncols,cols,vals,INSERT_VALUES);CHKERRQ(ierr);
+      ierr = MatRestoreRow(A,row,&ncols,&cols,&vals);CHKERRQ(ierr);
+    }
     ierr = MatAssemblyBegin(B,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
     ierr = MatAssemblyEnd(B,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
-    ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
-    ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
   }
 
   if (reuse == MAT_INPLACE_MATRIX) {
@@ -248,6 +248,32 @@ PetscErrorCode MatConvert_SeqSELL_SeqAIJ(Mat A, MatType newtype,MatReuse reuse,M
 
 #include <../src/mat/impls/aij/seq/aij.h>
 
+/*
+   Number of entries, nonzeros and padding, stored for rows of lengths rlen[] when the rows of each window of sigma rows
+   are sorted by length before being cut into slices of 8 rows; sigma <= 8 gives the storage of the natural ordering
+*/
+static PetscErrorCode MatSeqSELLGetPaddedSize_Private(PetscInt m,const PetscInt rlen[],PetscInt sigma,PetscInt *size)
+{
+  PetscInt       i,j,k,nw,rmax,*work;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  sigma = 8*PetscMax(1,(sigma+7)/8);
+  ierr  = PetscMalloc1(sigma,&work);CHKERRQ(ierr);
+  *size = 0;
+  for (i=0; i<m; i+=sigma) {
+    nw   = PetscMin(sigma,m-i);
+    ierr = PetscMemcpy(work,rlen+i,nw*sizeof(PetscInt));CHKERRQ(ierr);
+    if (sigma > 8) {ierr = PetscSortInt(nw,work);CHKERRQ(ierr);}
+    for (j=0; j<nw; j+=8) {
+      for (k=j,rmax=0; k<PetscMin(j+8,nw); k++) rmax = PetscMax(rmax,work[k]);
+      *size += 8*rmax;
+    }
+  }
+  ierr = PetscFree(work);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 PetscErrorCode MatConvert_SeqAIJ_SeqSELL(Mat A,MatType newtype,MatReuse reuse,Mat *newmat)
 {
   Mat               B;
@@ -267,6 +293,18 @@ PetscErrorCode MatConvert_SeqAIJ_SeqSELL(Mat A,MatType newtype,MatReuse reuse,Ma
     for (i=0; i<m; i++) {
       rowlengths[i] = ai[i+1] - ai[i];
     }
+    if (ai[m]) {
+      PetscInt sigma=0,padded;
+
+      ierr = MatSeqSELLGetPaddedSize_Private(m,rowlengths,0,&padded);CHKERRQ(ierr);
+      ierr = PetscInfo3(A,"SELL stores %D entries for %D nonzeros, fill ratio %g\n",padded,ai[m],(double)padded/ai[m]);CHKERRQ(ierr);
+      if ((double)padded/ai[m] > 1.5) {ierr = PetscInfo(A,"The fill ratio is large, the MatMult() of AIJ is likely to be faster than SELL\n");CHKERRQ(ierr);}
+      ierr = PetscOptionsGetInt(((PetscObject)A)->options,((PetscObject)A)->prefix,"-mat_sell_report_sigma",&sigma,NULL);CHKERRQ(ierr);
+      if (sigma > 8) {
+        ierr = MatSeqSELLGetPaddedSize_Private(m,rowlengths,sigma,&padded);CHKERRQ(ierr);
+        ierr = PetscInfo2(A,"Sorting the rows by length in windows of %D rows would give fill ratio %g\n",8*((sigma+7)/8),(double)padded/ai[m]);CHKERRQ(ierr);
+      }
+    }
 
     ierr = MatCreate(PetscObjectComm((PetscObject)A),&B);CHKERRQ(ierr);
     ierr = MatSetSizes(B,m,n,m,n);CHKERRQ(ierr);
@@ -688,7 +726,7 @@ PetscErrorCode MatMultTransposeAdd_SeqSELL(Mat A,Vec xx,Vec zz,Vec yy)
       for (r=0; r<(A->rmap->n & 0x07); ++r) {
         row        = 8*i + r;
         nnz_in_row = a->rlen[row];
-        for (j=0; j<nnz_in_row; ++j) y[acolidx[8*j+r]] += aval[8*j+r] * x[row];
+        for (j=0; j<nnz_in_row; ++j) y[acolidx[a->sliidx[i]+8*j+r]] += aval[a->sliidx[i]+8*j+r] * x[row];
       }
       break;
     }
@@ -715,14 +753,101 @@ PetscErrorCode MatMultTranspose_SeqSELL(Mat A,Vec xx,Vec yy)
 
   PetscFunctionBegin;
   if (A->symmetric) {
-    ierr = MatMult_SeqSELL(A,xx,yy);CHKERRQ(ierr);
+    ierr = (*A->ops->mult)(A,xx,yy);CHKERRQ(ierr);
   } else {
     ierr = VecSet(yy,0.0);CHKERRQ(ierr);
-    ierr = MatMultTransposeAdd_SeqSELL(A,xx,yy,yy);CHKERRQ(ierr);
+    ierr = (*A->ops->multtransposeadd)(A,xx,yy,yy);CHKERRQ(ierr);
   }
   PetscFunctionReturn(0);
 }
 
+const char *const MatSELLKernelTypes[] = {"auto","default","avx2","avx512","MatSELLKernelType","MATSELL_KERNEL_",0};
+
+/*
+   Installs the MatMult() kernels; MATSELL_KERNEL_AUTO picks the widest instruction set supported by the processor and a
+   kernel the processor does not support falls back to the default one, which is the kernel PETSc was compiled with
+*/
+static PetscErrorCode MatSeqSELLSetKernel_Private(Mat A,MatSELLKernelType kernel)
+{
+  Mat_SeqSELL    *a=(Mat_SeqSELL*)A->data;
+  PetscBool      avx2=PETSC_FALSE,avx512=PETSC_FALSE;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+#if defined(MATSELL_HAVE_RUNTIME_AVX)
+  __builtin_cpu_init();
+  avx2   = (PetscBool)(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"));
+  avx512 = (PetscBool)__builtin_cpu_supports("avx512f");
+#endif
+  if (kernel == MATSELL_KERNEL_AUTO) kernel = avx512 ? MATSELL_KERNEL_AVX512 : (avx2 ? MATSELL_KERNEL_AVX2 : MATSELL_KERNEL_DEFAULT);
+  if ((kernel == MATSELL_KERNEL_AVX512 && !avx512) || (kernel == MATSELL_KERNEL_AVX2 && !avx2)) {
+    ierr   = PetscInfo1(A,"The %s kernel is not supported by this processor or PETSc build, using the default kernel\n",MatSELLKernelTypes[kernel]);CHKERRQ(ierr);
+    kernel = MATSELL_KERNEL_DEFAULT;
+  }
+  a->kernel = kernel;
+  switch (kernel) {
+#if defined(MATSELL_HAVE_RUNTIME_AVX)
+  case MATSELL_KERNEL_AVX512:
+    A->ops->mult             = MatMult_SeqSELL_AVX512;
+    A->ops->multadd          = MatMultAdd_SeqSELL_AVX512;
+    A->ops->multtransposeadd = MatMultTransposeAdd_SeqSELL_AVX512;
+    break;
+  case MATSELL_KERNEL_AVX2:
+    A->ops->mult             = MatMult_SeqSELL_AVX2;
+    A->ops->multadd          = MatMultAdd_SeqSELL_AVX2;
+    A->ops->multtransposeadd = MatMultTransposeAdd_SeqSELL_AVX2;
+    break;
+#endif
+  default:
+    A->ops->mult             = MatMult_SeqSELL;
+    A->ops->multadd          = MatMultAdd_SeqSELL;
+    A->ops->multtransposeadd = MatMultTransposeAdd_SeqSELL;
+  }
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatSeqSELLGetFillRatio_SeqSELL(Mat A,PetscReal *ratio)
+{
+  Mat_SeqSELL *a=(Mat_SeqSELL*)A->data;
+
+  PetscFunctionBegin;
+  *ratio = a->nz ? (PetscReal)a->sliidx[a->totalslices]/(PetscReal)a->nz : 1.0;
+  PetscFunctionReturn(0);
+}
+
+/*@
+   MatSeqSELLGetFillRatio - Gets the ratio of the number of entries stored by a MATSEQSELL matrix, including the zeros
+   padding the rows of each slice to the same length, to its number of nonzeros
+
+   Not Collective
+
+   Input Parameter:
+.  A - the MATSEQSELL matrix
+
+   Output Parameter:
+.  ratio - the fill ratio, 1 means that no padding is stored
+
+   Notes:
+   MatMult() with SELL does work proportional to the number of stored entries, so SELL is unlikely to be faster than
+   AIJ for matrices with a large fill ratio. MatConvert() from MATSEQAIJ reports the fill ratio with -info before
+   converting; with -mat_sell_report_sigma <sigma> it also reports the ratio that sorting the rows by length within windows
+   of sigma rows would give. SELL does not reorder the rows itself.
+
+   Level: advanced
+
+.seealso: MatConvert(), MatGetInfo(), MATSEQSELL
+@*/
+PetscErrorCode MatSeqSELLGetFillRatio(Mat A,PetscReal *ratio)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(A,MAT_CLASSID,1);
+  PetscValidRealPointer(ratio,2);
+  ierr = PetscUseMethod(A,"MatSeqSELLGetFillRatio_C",(Mat,PetscReal*),(A,ratio));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 /*
      Checks for missing diagonals
 */
@@ -865,6 +990,7 @@ PetscErrorCode MatDestroy_SeqSELL(Mat A)
 #if defined(PETSC_HAVE_ELEMENTAL)
 #endif
   ierr = PetscObjectComposeFunction((PetscObject)A,"MatSeqSELLSetPreallocation_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)A,"MatSeqSELLGetFillRatio_C",NULL);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
@@ -1078,7 +1204,13 @@ PetscErrorCode MatView_SeqSELL_ASCII(Mat A,PetscViewer viewer)
     ierr = PetscObjectGetName((PetscObject)A,&name);CHKERRQ(ierr);
     ierr = PetscViewerASCIIPrintf(viewer,"];\n %s = spconvert(zzz);\n",name);CHKERRQ(ierr);
     ierr = PetscViewerASCIIUseTabs(viewer,PETSC_TRUE);CHKERRQ(ierr);
-  } else if (format == PETSC_VIEWER_ASCII_FACTOR_INFO || format == PETSC_VIEWER_ASCII_INFO) {
+  } else if (format == PETSC_VIEWER_ASCII_FACTOR_INFO) {
+    PetscFunctionReturn(0);
+  } else if (format == PETSC_VIEWER_ASCII_INFO) {
+    PetscReal ratio;
+
+    ierr = MatSeqSELLGetFillRatio_SeqSELL(A,&ratio);CHKERRQ(ierr);
+    ierr = PetscViewerASCIIPrintf(viewer,"slice height 8, fill ratio with padding %g, using the %s MatMult() kernel\n",(double)ratio,MatSELLKernelTypes[a->kernel]);CHKERRQ(ierr);
     PetscFunctionReturn(0);
   } else if (format == PETSC_VIEWER_ASCII_COMMON) {
     ierr = PetscViewerASCIIUseTabs(viewer,PETSC_FALSE);CHKERRQ(ierr);
@@ -1966,6 +2098,12 @@ PETSC_EXTERN PetscErrorCode MatCreate_SeqSELL(Mat B)
   b->fshift             = 0.0;
   b->idiagvalid         = PETSC_FALSE;
   b->keepnonzeropattern = PETSC_FALSE;
+  b->kernel             = MATSELL_KERNEL_AUTO;
+
+  ierr = PetscOptionsBegin(PetscObjectComm((PetscObject)B),((PetscObject)B)->prefix,"Options for SEQSELL matrix","Mat");CHKERRQ(ierr);
+  ierr = PetscOptionsEnum("-mat_sell_kernel","Kernel used by MatMult()",NULL,MatSELLKernelTypes,(PetscEnum)b->kernel,(PetscEnum*)&b->kernel,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsEnd();CHKERRQ(ierr);
+  ierr = MatSeqSELLSetKernel_Private(B,b->kernel);CHKERRQ(ierr);
 
   ierr = PetscObjectChangeTypeName((PetscObject)B,MATSEQSELL);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatSeqSELLGetArray_C",MatSeqSELLGetArray_SeqSELL);CHKERRQ(ierr);
@@ -1974,6 +2112,7 @@ PETSC_EXTERN PetscErrorCode MatCreate_SeqSELL(Mat B)
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatRetrieveValues_C",MatRetrieveValues_SeqSELL);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatSeqSELLSetPreallocation_C",MatSeqSELLSetPreallocation_SeqSELL);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqsell_seqaij_C",MatConvert_SeqSELL_SeqAIJ);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatSeqSELLGetFillRatio_C",MatSeqSELLGetFillRatio_SeqSELL);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
@@ -2054,6 +2193,8 @@ PetscErrorCode MatDuplicateNoCreate_SeqSELL(Mat C,Mat A,MatDuplicateOption cpval
   c->nonzerorowcnt = a->nonzerorowcnt;
   C->nonzerostate  = A->nonzerostate;
 
+  ierr = MatSeqSELLSetKernel_Private(C,a->kernel);CHKERRQ(ierr);
+
   ierr = PetscFunctionListDuplicate(((PetscObject)A)->qlist,&((PetscObject)C)->qlist);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
@@ -40,6 +40,17 @@ PetscInt    totalslices;       /* total number of slices */ \
 PetscInt    *getrowcols;       /* workarray for MatGetRow_SeqSELL */ \
 PetscScalar *getrowvals        /* workarray for MatGetRow_SeqSELL */ \
 
+/*
+ MatMult() kernels of SeqSELL that can be selected at runtime, see -mat_sell_kernel. The AVX2 and AVX-512 kernels are
+ compiled with function target attributes, so they are available even when PETSc is not built with -mavx2 or -mavx512f
+*/
+typedef enum {MATSELL_KERNEL_AUTO,MATSELL_KERNEL_DEFAULT,MATSELL_KERNEL_AVX2,MATSELL_KERNEL_AVX512} MatSELLKernelType;
+PETSC_INTERN const char *const MatSELLKernelTypes[];
+
+#if defined(PETSC_HAVE_IMMINTRIN_H) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(PETSC_USE_REAL_DOUBLE) && !defined(PETSC_USE_COMPLEX) && !defined(PETSC_USE_64BIT_INDICES)
+#define MATSELL_HAVE_RUNTIME_AVX
+#endif
+
 typedef struct {
   SEQSELLHEADER(MatScalar);
   MatScalar   *saved_values;             /* location for stashing nonzero values of matrix */
@@ -47,6 +58,7 @@ typedef struct {
   PetscBool   idiagvalid;                /* current idiag[] and mdiag[] are valid */
   PetscScalar fshift,omega;              /* last used omega and fshift */
   ISColoring  coloring;                  /* set with MatADSetColoring() used by MatADSetValues() */
+  MatSELLKernelType kernel;              /* kernel used by MatMult() and its variants, never MATSELL_KERNEL_AUTO */
 } Mat_SeqSELL;
 
 /*
@@ -171,6 +183,14 @@ PETSC_INTERN PetscErrorCode MatMult_SeqSELL(Mat,Vec,Vec);
 PETSC_INTERN PetscErrorCode MatMultAdd_SeqSELL(Mat,Vec,Vec,Vec);
 PETSC_INTERN PetscErrorCode MatMultTranspose_SeqSELL(Mat,Vec,Vec);
 PETSC_INTERN PetscErrorCode MatMultTransposeAdd_SeqSELL(Mat,Vec,Vec,Vec);
+#if defined(MATSELL_HAVE_RUNTIME_AVX)
+PETSC_INTERN PetscErrorCode MatMult_SeqSELL_AVX2(Mat,Vec,Vec);
+PETSC_INTERN PetscErrorCode MatMultAdd_SeqSELL_AVX2(Mat,Vec,Vec,Vec);
+PETSC_INTERN PetscErrorCode MatMultTransposeAdd_SeqSELL_AVX2(Mat,Vec,Vec,Vec);
+PETSC_INTERN PetscErrorCode MatMult_SeqSELL_AVX512(Mat,Vec,Vec);
+PETSC_INTERN PetscErrorCode MatMultAdd_SeqSELL_AVX512(Mat,Vec,Vec,Vec);
+PETSC_INTERN PetscErrorCode MatMultTransposeAdd_SeqSELL_AVX512(Mat,Vec,Vec,Vec);
+#endif
 PETSC_INTERN PetscErrorCode MatMissingDiagonal_SeqSELL(Mat,PetscBool*,PetscInt*);
 PETSC_INTERN PetscErrorCode MatMarkDiagonal_SeqSELL(Mat);
 PETSC_INTERN PetscErrorCode MatInvertDiagonal_SeqSELL(Mat,PetscScalar,PetscScalar);
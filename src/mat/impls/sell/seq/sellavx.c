@@ -0,0 +1,254 @@
+/*
+  AVX2 and AVX-512 kernels for the products with SELL matrices that are selected at runtime, see -mat_sell_kernel.
+
+  Each kernel is compiled with a function target attribute, so it can be used on any x86 processor that supports the
+  instruction set, independently of the flags PETSc was compiled with. All the rows of a slice are processed together;
+  this relies on MatAssemblyEnd_SeqSELL() setting the padding entries of each slice to a valid column index and a zero value.
+*/
+#include <../src/mat/impls/sell/seq/sell.h>  /*I   "petscmat.h"  I*/
+
+#if defined(MATSELL_HAVE_RUNTIME_AVX)
+#include <immintrin.h>
+
+/*
+   z = A x + y on the rows of the slices, y may be NULL; the last slice may be only partially used by the m rows
+*/
+static __attribute__((target("avx2,fma"))) void MatMultKernel_SeqSELL_AVX2(const Mat_SeqSELL *a,PetscInt m,const PetscScalar *x,const PetscScalar *y,PetscScalar *z)
+{
+  const MatScalar *aval=a->val;
+  const PetscInt  *acolidx=a->colidx;
+  PetscInt        i,j,r,nr;
+  PetscScalar     buf[8];
+  __m256d         vec_y,vec_y2,vec_x,vec_vals;
+  __m128i         vec_idx;
+
+  for (i=0; i<a->totalslices; i++) { /* loop over slices */
+    nr = PetscMin(8,m-8*i);
+    if (nr < 8) { /* the padding rows of the last slice are computed in a buffer */
+      for (r=0; r<8; r++) buf[r] = (y && r < nr) ? y[8*i+r] : 0.0;
+      vec_y  = _mm256_loadu_pd(buf);
+      vec_y2 = _mm256_loadu_pd(buf+4);
+    } else if (y) {
+      vec_y  = _mm256_loadu_pd(y+8*i);
+      vec_y2 = _mm256_loadu_pd(y+8*i+4);
+    } else {
+      vec_y  = _mm256_setzero_pd();
+      vec_y2 = _mm256_setzero_pd();
+    }
+    /* the slice of height 8 is processed as two subslices of height 4 */
+    for (j=a->sliidx[i]; j<a->sliidx[i+1]; j+=8) {
+      vec_idx  = _mm_loadu_si128((__m128i const*)(acolidx+j));
+      vec_vals = _mm256_loadu_pd(aval+j);
+      vec_x    = _mm256_i32gather_pd(x,vec_idx,8);
+      vec_y    = _mm256_fmadd_pd(vec_x,vec_vals,vec_y);
+      vec_idx  = _mm_loadu_si128((__m128i const*)(acolidx+j+4));
+      vec_vals = _mm256_loadu_pd(aval+j+4);
+      vec_x    = _mm256_i32gather_pd(x,vec_idx,8);
+      vec_y2   = _mm256_fmadd_pd(vec_x,vec_vals,vec_y2);
+    }
+    if (nr < 8) {
+      _mm256_storeu_pd(buf,vec_y);
+      _mm256_storeu_pd(buf+4,vec_y2);
+      for (r=0; r<nr; r++) z[8*i+r] = buf[r];
+    } else {
+      _mm256_storeu_pd(z+8*i,vec_y);
+      _mm256_storeu_pd(z+8*i+4,vec_y2);
+    }
+  }
+}
+
+/*
+   y = y + A^T x; the products of a slice column are vectorized, but the updates of y are scalar since the column
+   indices of a slice column may repeat
+*/
+static __attribute__((target("avx2,fma"))) void MatMultTransposeKernel_SeqSELL_AVX2(const Mat_SeqSELL *a,PetscInt m,const PetscScalar *x,PetscScalar *y)
+{
+  const MatScalar *aval=a->val;
+  const PetscInt  *acolidx=a->colidx;
+  PetscInt        i,j,r,nr;
+  PetscScalar     buf[8],prod[8];
+  __m256d         vec_x,vec_x2;
+
+  for (i=0; i<a->totalslices; i++) { /* loop over slices */
+    nr = PetscMin(8,m-8*i);
+    if (nr < 8) {
+      for (r=0; r<8; r++) buf[r] = r < nr ? x[8*i+r] : 0.0;
+      vec_x  = _mm256_loadu_pd(buf);
+      vec_x2 = _mm256_loadu_pd(buf+4);
+    } else {
+      vec_x  = _mm256_loadu_pd(x+8*i);
+      vec_x2 = _mm256_loadu_pd(x+8*i+4);
+    }
+    for (j=a->sliidx[i]; j<a->sliidx[i+1]; j+=8) {
+      _mm256_storeu_pd(prod,_mm256_mul_pd(_mm256_loadu_pd(aval+j),vec_x));
+      _mm256_storeu_pd(prod+4,_mm256_mul_pd(_mm256_loadu_pd(aval+j+4),vec_x2));
+      for (r=0; r<8; r++) y[acolidx[j+r]] += prod[r];
+    }
+  }
+}
+
+static __attribute__((target("avx512f"))) void MatMultKernel_SeqSELL_AVX512(const Mat_SeqSELL *a,PetscInt m,const PetscScalar *x,const PetscScalar *y,PetscScalar *z)
+{
+  const MatScalar *aval=a->val;
+  const PetscInt  *acolidx=a->colidx;
+  PetscInt        i,j;
+  __mmask8        mask=0xff;
+  __m512d         vec_y,vec_y2,vec_x,vec_x2,vec_vals,vec_vals2;
+  __m256i         vec_idx,vec_idx2;
+
+  for (i=0; i<a->totalslices; i++) { /* loop over slices */
+    if (m-8*i < 8) mask = (__mmask8)(0xff >> (8-(m-8*i))); /* the last slice has padding rows */
+    vec_y  = y ? _mm512_maskz_loadu_pd(mask,y+8*i) : _mm512_setzero_pd();
+    vec_y2 = _mm512_setzero_pd();
+    /* two slice columns at a time with independent accumulators */
+    for (j=a->sliidx[i]; j+8<a->sliidx[i+1]; j+=16) {
+      vec_idx   = _mm256_loadu_si256((__m256i const*)(acolidx+j));
+      vec_idx2  = _mm256_loadu_si256((__m256i const*)(acolidx+j+8));
+      vec_vals  = _mm512_loadu_pd(aval+j);
+      vec_vals2 = _mm512_loadu_pd(aval+j+8);
+      vec_x     = _mm512_i32gather_pd(vec_idx,x,8);
+      vec_x2    = _mm512_i32gather_pd(vec_idx2,x,8);
+      vec_y     = _mm512_fmadd_pd(vec_x,vec_vals,vec_y);
+      vec_y2    = _mm512_fmadd_pd(vec_x2,vec_vals2,vec_y2);
+    }
+    if (j < a->sliidx[i+1]) {
+      vec_idx  = _mm256_loadu_si256((__m256i const*)(acolidx+j));
+      vec_vals = _mm512_loadu_pd(aval+j);
+      vec_x    = _mm512_i32gather_pd(vec_idx,x,8);
+      vec_y    = _mm512_fmadd_pd(vec_x,vec_vals,vec_y);
+    }
+    _mm512_mask_storeu_pd(z+8*i,mask,_mm512_add_pd(vec_y,vec_y2));
+  }
+}
+
+static __attribute__((target("avx512f"))) void MatMultTransposeKernel_SeqSELL_AVX512(const Mat_SeqSELL *a,PetscInt m,const PetscScalar *x,PetscScalar *y)
+{
+  const MatScalar *aval=a->val;
+  const PetscInt  *acolidx=a->colidx;
+  PetscInt        i,j,r;
+  PetscScalar     prod[8];
+  __mmask8        mask=0xff;
+  __m512d         vec_x;
+
+  for (i=0; i<a->totalslices; i++) { /* loop over slices */
+    if (m-8*i < 8) mask = (__mmask8)(0xff >> (8-(m-8*i)));
+    vec_x = _mm512_maskz_loadu_pd(mask,x+8*i);
+    for (j=a->sliidx[i]; j<a->sliidx[i+1]; j+=8) {
+      _mm512_storeu_pd(prod,_mm512_mul_pd(_mm512_loadu_pd(aval+j),vec_x));
+      for (r=0; r<8; r++) y[acolidx[j+r]] += prod[r];
+    }
+  }
+}
+
+PetscErrorCode MatMult_SeqSELL_AVX2(Mat A,Vec xx,Vec yy)
+{
+  Mat_SeqSELL       *a=(Mat_SeqSELL*)A->data;
+  const PetscScalar *x;
+  PetscScalar       *y;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArray(yy,&y);CHKERRQ(ierr);
+  MatMultKernel_SeqSELL_AVX2(a,A->rmap->n,x,NULL,y);
+  ierr = PetscLogFlops(2.0*a->nz-a->nonzerorowcnt);CHKERRQ(ierr); /* theoretical minimal FLOPs */
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(yy,&y);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMultAdd_SeqSELL_AVX2(Mat A,Vec xx,Vec yy,Vec zz)
+{
+  Mat_SeqSELL       *a=(Mat_SeqSELL*)A->data;
+  const PetscScalar *x;
+  PetscScalar       *y,*z;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArrayPair(yy,zz,&y,&z);CHKERRQ(ierr);
+  MatMultKernel_SeqSELL_AVX2(a,A->rmap->n,x,y,z);
+  ierr = PetscLogFlops(2.0*a->nz);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArrayPair(yy,zz,&y,&z);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMultTransposeAdd_SeqSELL_AVX2(Mat A,Vec xx,Vec zz,Vec yy)
+{
+  Mat_SeqSELL       *a=(Mat_SeqSELL*)A->data;
+  const PetscScalar *x;
+  PetscScalar       *y;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  if (A->symmetric) {
+    ierr = MatMultAdd_SeqSELL_AVX2(A,xx,zz,yy);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  if (zz != yy) { ierr = VecCopy(zz,yy);CHKERRQ(ierr); }
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArray(yy,&y);CHKERRQ(ierr);
+  MatMultTransposeKernel_SeqSELL_AVX2(a,A->rmap->n,x,y);
+  ierr = PetscLogFlops(2.0*a->sliidx[a->totalslices]);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(yy,&y);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMult_SeqSELL_AVX512(Mat A,Vec xx,Vec yy)
+{
+  Mat_SeqSELL       *a=(Mat_SeqSELL*)A->data;
+  const PetscScalar *x;
+  PetscScalar       *y;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArray(yy,&y);CHKERRQ(ierr);
+  MatMultKernel_SeqSELL_AVX512(a,A->rmap->n,x,NULL,y);
+  ierr = PetscLogFlops(2.0*a->nz-a->nonzerorowcnt);CHKERRQ(ierr); /* theoretical minimal FLOPs */
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(yy,&y);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMultAdd_SeqSELL_AVX512(Mat A,Vec xx,Vec yy,Vec zz)
+{
+  Mat_SeqSELL       *a=(Mat_SeqSELL*)A->data;
+  const PetscScalar *x;
+  PetscScalar       *y,*z;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArrayPair(yy,zz,&y,&z);CHKERRQ(ierr);
+  MatMultKernel_SeqSELL_AVX512(a,A->rmap->n,x,y,z);
+  ierr = PetscLogFlops(2.0*a->nz);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArrayPair(yy,zz,&y,&z);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMultTransposeAdd_SeqSELL_AVX512(Mat A,Vec xx,Vec zz,Vec yy)
+{
+  Mat_SeqSELL       *a=(Mat_SeqSELL*)A->data;
+  const PetscScalar *x;
+  PetscScalar       *y;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  if (A->symmetric) {
+    ierr = MatMultAdd_SeqSELL_AVX512(A,xx,zz,yy);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  if (zz != yy) { ierr = VecCopy(zz,yy);CHKERRQ(ierr); }
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArray(yy,&y);CHKERRQ(ierr);
+  MatMultTransposeKernel_SeqSELL_AVX512(a,A->rmap->n,x,y);
+  ierr = PetscLogFlops(2.0*a->sliidx[a->totalslices]);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(yy,&y);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+#endif
@@ -32,7 +32,7 @@ PetscLogEvent MAT_Getsymtranspose, MAT_Getsymtransreduced, MAT_Transpose_SeqAIJ,
 PetscLogEvent MAT_GetBrowsOfAocols, MAT_Getlocalmat, MAT_Getlocalmatcondensed, MAT_Seqstompi, MAT_Seqstompinum, MAT_Seqstompisym;
 PetscLogEvent MAT_Applypapt, MAT_Applypapt_numeric, MAT_Applypapt_symbolic, MAT_GetSequentialNonzeroStructure;
 PetscLogEvent MAT_GetMultiProcBlock;
-PetscLogEvent MAT_CUSPARSECopyToGPU, MAT_SetValuesBatch;
+PetscLogEvent MAT_CUSPARSECopyToGPU, MAT_SetValuesBatch, MAT_PreallCOO, MAT_SetVCOO;
 PetscLogEvent MAT_ViennaCLCopyToGPU;
 PetscLogEvent MAT_Merge,MAT_Residual,MAT_SetRandom;
 PetscLogEvent MATCOLORING_Apply,MATCOLORING_Comm,MATCOLORING_Local,MATCOLORING_ISCreate,MATCOLORING_SetUp,MATCOLORING_Weights;
@@ -5567,8 +5567,12 @@ PetscErrorCode MatAssemblyEnd(Mat mat,MatAssemblyType type)
    is created during the first Matrix Assembly. This hash table is
    used the next time through, during MatSetVaules()/MatSetVaulesBlocked()
    to improve the searching of indices. MAT_NEW_NONZERO_LOCATIONS flag
-   should be used with MAT_USE_HASH_TABLE flag. This option is currently
-   supported by MATMPIBAIJ format only.
+   should be used with MAT_USE_HASH_TABLE flag. This is the behavior for
+   the MATMPIBAIJ format. For MATSEQAIJ and MATMPIAIJ matrices that are not
+   preallocated the flag, which must then be set before MatSetUp() or any other
+   option, makes MatSetValues() accumulate the entries in a hash table; the
+   storage is allocated with exactly the needed nonzeros in the first
+   MatAssemblyEnd() with MAT_FINAL_ASSEMBLY and no reallocations take place.
 
    MAT_KEEP_NONZERO_PATTERN indicates when MatZeroRows() is called the zeroed entries
    are kept in the nonzero structure
@@ -334,6 +334,171 @@ PetscErrorCode MatXAIJSetPreallocation(Mat A,PetscInt bs,const PetscInt dnnz[],c
   PetscFunctionReturn(0);
 }
 
+/*
+   Preallocation and assembly from coordinate (COO) format for matrix types that do not provide
+   their own implementation: the pattern is computed with a MATPREALLOCATOR and the indices are
+   kept on the matrix so that MatSetValuesCOO_Basic() can pass them on to MatSetValues().
+*/
+static PetscErrorCode MatSetPreallocationCOO_Basic(Mat A,PetscInt ncoo,const PetscInt coo_i[],const PetscInt coo_j[])
+{
+  Mat            preallocator;
+  IS             is_coo_i,is_coo_j;
+  PetscScalar    zero = 0.0;
+  PetscInt       n;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscLayoutSetUp(A->rmap);CHKERRQ(ierr);
+  ierr = PetscLayoutSetUp(A->cmap);CHKERRQ(ierr);
+  ierr = MatCreate(PetscObjectComm((PetscObject)A),&preallocator);CHKERRQ(ierr);
+  ierr = MatSetType(preallocator,MATPREALLOCATOR);CHKERRQ(ierr);
+  ierr = MatSetSizes(preallocator,A->rmap->n,A->cmap->n,A->rmap->N,A->cmap->N);CHKERRQ(ierr);
+  ierr = MatSetBlockSizesFromMats(preallocator,A,A);CHKERRQ(ierr);
+  ierr = MatSetUp(preallocator);CHKERRQ(ierr);
+  for (n=0; n<ncoo; n++) {
+    ierr = MatSetValue(preallocator,coo_i[n],coo_j[n],zero,INSERT_VALUES);CHKERRQ(ierr);
+  }
+  ierr = MatAssemblyBegin(preallocator,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(preallocator,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatPreallocatorPreallocate(preallocator,PETSC_TRUE,A);CHKERRQ(ierr);
+  ierr = MatDestroy(&preallocator);CHKERRQ(ierr);
+  /* insert the pattern so that the matrix is assembled and MatZeroEntries() keeps it */
+  for (n=0; n<ncoo; n++) {
+    ierr = MatSetValue(A,coo_i[n],coo_j[n],zero,ADD_VALUES);CHKERRQ(ierr);
+  }
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+
+  ierr = ISCreateGeneral(PETSC_COMM_SELF,ncoo,coo_i,PETSC_COPY_VALUES,&is_coo_i);CHKERRQ(ierr);
+  ierr = ISCreateGeneral(PETSC_COMM_SELF,ncoo,coo_j,PETSC_COPY_VALUES,&is_coo_j);CHKERRQ(ierr);
+  ierr = PetscObjectCompose((PetscObject)A,"__PETSc_coo_i",(PetscObject)is_coo_i);CHKERRQ(ierr);
+  ierr = PetscObjectCompose((PetscObject)A,"__PETSc_coo_j",(PetscObject)is_coo_j);CHKERRQ(ierr);
+  ierr = ISDestroy(&is_coo_i);CHKERRQ(ierr);
+  ierr = ISDestroy(&is_coo_j);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatSetValuesCOO_Basic(Mat A,const PetscScalar coo_v[],InsertMode imode)
+{
+  IS             is_coo_i,is_coo_j;
+  const PetscInt *coo_i,*coo_j;
+  PetscInt       n,ncoo;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectQuery((PetscObject)A,"__PETSc_coo_i",(PetscObject*)&is_coo_i);CHKERRQ(ierr);
+  ierr = PetscObjectQuery((PetscObject)A,"__PETSc_coo_j",(PetscObject*)&is_coo_j);CHKERRQ(ierr);
+  if (!is_coo_i || !is_coo_j) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONGSTATE,"Must call MatSetPreallocationCOO() first");
+  ierr = ISGetLocalSize(is_coo_i,&ncoo);CHKERRQ(ierr);
+  ierr = ISGetIndices(is_coo_i,&coo_i);CHKERRQ(ierr);
+  ierr = ISGetIndices(is_coo_j,&coo_j);CHKERRQ(ierr);
+  if (imode == INSERT_VALUES) {
+    ierr = MatZeroEntries(A);CHKERRQ(ierr);
+  }
+  for (n=0; n<ncoo; n++) {
+    ierr = MatSetValue(A,coo_i[n],coo_j[n],coo_v[n],ADD_VALUES);CHKERRQ(ierr);
+  }
+  ierr = ISRestoreIndices(is_coo_i,&coo_i);CHKERRQ(ierr);
+  ierr = ISRestoreIndices(is_coo_j,&coo_j);CHKERRQ(ierr);
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*@C
+   MatSetPreallocationCOO - set the nonzero pattern of a matrix from a list of entries given in coordinate (COO) format
+
+   Collective on Mat
+
+   Input Arguments:
++  A - matrix being preallocated
+.  ncoo - number of entries set by this process
+.  coo_i - global row index of each entry
+-  coo_j - global column index of each entry
+
+   Notes:
+   The entries may be in any order, may be repeated and may lie in rows owned by other processes; entries with a negative
+   row or column index are ignored. The matrix is allocated for exactly the resulting nonzero pattern and is assembled on return.
+
+   The values are then provided with MatSetValuesCOO(), in the same order as the indices given here. For AIJ matrices the
+   permutation from the COO list into the compressed row storage, and the communication pattern of the entries that belong
+   to other processes, are computed once here so that each call to MatSetValuesCOO() only moves values. Other matrix types
+   go through MatSetValues().
+
+   The indices are copied, the arrays may be freed by the caller after this call.
+
+   Level: beginner
+
+.seealso: MatSetValuesCOO(), MatSeqAIJSetPreallocation(), MatMPIAIJSetPreallocation(), MatXAIJSetPreallocation()
+@*/
+PetscErrorCode MatSetPreallocationCOO(Mat A,PetscInt ncoo,const PetscInt coo_i[],const PetscInt coo_j[])
+{
+  PetscErrorCode (*f)(Mat,PetscInt,const PetscInt[],const PetscInt[]) = NULL;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(A,MAT_CLASSID,1);
+  PetscValidType(A,1);
+  if (ncoo) PetscValidIntPointer(coo_i,3);
+  if (ncoo) PetscValidIntPointer(coo_j,4);
+  if (ncoo < 0) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Number of entries cannot be negative: %D",ncoo);
+  ierr = PetscLayoutSetUp(A->rmap);CHKERRQ(ierr);
+  ierr = PetscLayoutSetUp(A->cmap);CHKERRQ(ierr);
+  ierr = PetscObjectQueryFunction((PetscObject)A,"MatSetPreallocationCOO_C",&f);CHKERRQ(ierr);
+  ierr = PetscLogEventBegin(MAT_PreallCOO,A,0,0,0);CHKERRQ(ierr);
+  if (f) {
+    ierr = (*f)(A,ncoo,coo_i,coo_j);CHKERRQ(ierr);
+  } else {
+    ierr = MatSetPreallocationCOO_Basic(A,ncoo,coo_i,coo_j);CHKERRQ(ierr);
+  }
+  ierr = PetscLogEventEnd(MAT_PreallCOO,A,0,0,0);CHKERRQ(ierr);
+  ierr = MatSetOption(A,MAT_NEW_NONZERO_ALLOCATION_ERR,PETSC_TRUE);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*@C
+   MatSetValuesCOO - set the values of a matrix preallocated with MatSetPreallocationCOO()
+
+   Collective on Mat
+
+   Input Arguments:
++  A - matrix being assembled
+.  coo_v - the value of each entry, in the order of the indices given to MatSetPreallocationCOO()
+-  imode - INSERT_VALUES or ADD_VALUES
+
+   Notes:
+   Repeated entries are always summed; with INSERT_VALUES the sum replaces the current value of the entry, with
+   ADD_VALUES it is added to it. Values of entries whose indices were negative are ignored.
+
+   The matrix is assembled on return, there is no need to call MatAssemblyBegin() and MatAssemblyEnd().
+
+   Level: beginner
+
+.seealso: MatSetPreallocationCOO(), MatSetValues(), InsertMode
+@*/
+PetscErrorCode MatSetValuesCOO(Mat A,const PetscScalar coo_v[],InsertMode imode)
+{
+  PetscErrorCode (*f)(Mat,const PetscScalar[],InsertMode) = NULL;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(A,MAT_CLASSID,1);
+  PetscValidType(A,1);
+  MatCheckPreallocated(A,1);
+  PetscValidLogicalCollectiveEnum(A,imode,3);
+  if (imode != INSERT_VALUES && imode != ADD_VALUES) SETERRQ(PetscObjectComm((PetscObject)A),PETSC_ERR_ARG_OUTOFRANGE,"Only INSERT_VALUES and ADD_VALUES are supported");
+  ierr = PetscObjectQueryFunction((PetscObject)A,"MatSetValuesCOO_C",&f);CHKERRQ(ierr);
+  ierr = PetscLogEventBegin(MAT_SetVCOO,A,0,0,0);CHKERRQ(ierr);
+  if (f) {
+    ierr = (*f)(A,coo_v,imode);CHKERRQ(ierr);
+  } else {
+    ierr = MatSetValuesCOO_Basic(A,coo_v,imode);CHKERRQ(ierr);
+  }
+  ierr = PetscLogEventEnd(MAT_SetVCOO,A,0,0,0);CHKERRQ(ierr);
+  ierr = PetscObjectStateIncrease((PetscObject)A);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 /*
         Merges some information from Cs header to A; the C object is then destroyed
 
@@ -943,7 +943,6 @@ int main(int argc, char **argv)
   Mat            A,J;         /* Jacobian matrix */
   MatNullSpace   nullSpace;   /* May be necessary for Neumann conditions */
   AppCtx         user;        /* user-defined work context */
-  JacActionCtx   userJ;       /* context for Jacobian MF action */
   PetscReal      error = 0.0; /* L_2 error in the solution */
   PetscBool      isFAS;
   PetscErrorCode ierr;
@@ -963,26 +962,7 @@ int main(int argc, char **argv)
 
   ierr = DMCreateMatrix(dm, &J);CHKERRQ(ierr);
   if (user.jacobianMF) {
-    PetscInt M, m, N, n;
-
-    ierr = MatGetSize(J, &M, &N);CHKERRQ(ierr);
-    ierr = MatGetLocalSize(J, &m, &n);CHKERRQ(ierr);
-    ierr = MatCreate(PETSC_COMM_WORLD, &A);CHKERRQ(ierr);
-    ierr = MatSetSizes(A, m, n, M, N);CHKERRQ(ierr);
-    ierr = MatSetType(A, MATSHELL);CHKERRQ(ierr);
-    ierr = MatSetUp(A);CHKERRQ(ierr);
-#if 0
-    ierr = MatShellSetOperation(A, MATOP_MULT, (void (*)(void))FormJacobianAction);CHKERRQ(ierr);
-#endif
-
-    userJ.dm   = dm;
-    userJ.J    = J;
-    userJ.user = &user;
-
-    ierr = DMCreateLocalVector(dm, &userJ.u);CHKERRQ(ierr);
-    if (user.fieldBC) {ierr = DMProjectFieldLocal(dm, 0.0, userJ.u, user.exactFields, INSERT_BC_VALUES, userJ.u);CHKERRQ(ierr);}
-    else              {ierr = DMProjectFunctionLocal(dm, 0.0, user.exactFuncs, NULL, INSERT_BC_VALUES, userJ.u);CHKERRQ(ierr);}
-    ierr = MatShellSetContext(A, &userJ);CHKERRQ(ierr);
+    ierr = DMPlexSNESCreateJacobianMF(dm, &A);CHKERRQ(ierr);
   } else {
     A = J;
   }
@@ -1114,6 +1094,33 @@ int main(int argc, char **argv)
       ierr = VecNorm(r, NORM_2, &res);CHKERRQ(ierr);
       ierr = PetscPrintf(PETSC_COMM_WORLD, "Linear L_2 Residual: %g\n", res);CHKERRQ(ierr);
     }
+    /* Check the matrix-free Jacobian against the assembled Jacobian */
+    if (user.jacobianMF) {
+      Vec       b, d;
+      PetscReal nrm;
+
+      ierr = SNESComputeJacobian(snes, u, A, J);CHKERRQ(ierr);
+      ierr = VecDuplicate(u, &b);CHKERRQ(ierr);
+      ierr = VecDuplicate(u, &d);CHKERRQ(ierr);
+      ierr = VecSet(r, 1.0);CHKERRQ(ierr);
+      ierr = VecAXPY(r, 1.0, u);CHKERRQ(ierr);
+      ierr = MatMult(A, r, b);CHKERRQ(ierr);
+      ierr = MatMult(J, r, d);CHKERRQ(ierr);
+      ierr = VecAXPY(b, -1.0, d);CHKERRQ(ierr);
+      ierr = VecNorm(d, NORM_2, &nrm);CHKERRQ(ierr);
+      ierr = VecNorm(b, NORM_2, &res);CHKERRQ(ierr);
+      if (res < tol*nrm) {ierr = PetscPrintf(PETSC_COMM_WORLD, "Matrix-free Jacobian action: OK\n");CHKERRQ(ierr);}
+      else               {ierr = PetscPrintf(PETSC_COMM_WORLD, "Matrix-free Jacobian action error: %g\n", res/nrm);CHKERRQ(ierr);}
+      ierr = MatGetDiagonal(A, b);CHKERRQ(ierr);
+      ierr = MatGetDiagonal(J, d);CHKERRQ(ierr);
+      ierr = VecAXPY(b, -1.0, d);CHKERRQ(ierr);
+      ierr = VecNorm(d, NORM_2, &nrm);CHKERRQ(ierr);
+      ierr = VecNorm(b, NORM_2, &res);CHKERRQ(ierr);
+      if (res < tol*nrm) {ierr = PetscPrintf(PETSC_COMM_WORLD, "Matrix-free Jacobian diagonal: OK\n");CHKERRQ(ierr);}
+      else               {ierr = PetscPrintf(PETSC_COMM_WORLD, "Matrix-free Jacobian diagonal error: %g\n", res/nrm);CHKERRQ(ierr);}
+      ierr = VecDestroy(&b);CHKERRQ(ierr);
+      ierr = VecDestroy(&d);CHKERRQ(ierr);
+    }
   }
   ierr = VecViewFromOptions(u, NULL, "-vec_view");CHKERRQ(ierr);
 
@@ -1130,7 +1137,6 @@ int main(int argc, char **argv)
   }
 
   if (user.bcType == NEUMANN) {ierr = MatNullSpaceDestroy(&nullSpace);CHKERRQ(ierr);}
-  if (user.jacobianMF) {ierr = VecDestroy(&userJ.u);CHKERRQ(ierr);}
   if (A != J) {ierr = MatDestroy(&A);CHKERRQ(ierr);}
   ierr = MatDestroy(&J);CHKERRQ(ierr);
   ierr = VecDestroy(&u);CHKERRQ(ierr);
@@ -1798,6 +1804,25 @@ int main(int argc, char **argv)
     args: -quiet -run_type test -interpolate 1 -petscspace_degree 1 -simplex 0 -petscspace_poly_tensor -dm_plex_convert_type p4est -dm_forest_minimum_refinement 5 -dm_forest_initial_refinement 5 -dm_forest_maximum_refinement 7 -dm_p4est_refine_pattern hash
     timeoutfactor: 5
 
+  # Matrix-free Jacobian with sum factorization
+  test:
+    suffix: quad_q4_mf
+    requires: !single
+    args: -quiet -run_type test -interpolate 1 -bc_type dirichlet -simplex 0 -cells 2,2 -petscspace_degree 4 -variable_coefficient nonlinear -jacobian_mf
+  test:
+    suffix: quad_q3_mf_field
+    requires: !single
+    nsize: 2
+    args: -quiet -run_type test -interpolate 1 -bc_type dirichlet -simplex 0 -cells 3,3 -petscspace_degree 3 -variable_coefficient field -petscpartitioner_type simple -jacobian_mf -dm_plex_jacobian_mf_sum_factorization {{0 1}}
+  test:
+    suffix: hex_q3_mf
+    requires: !single
+    args: -quiet -run_type test -interpolate 1 -bc_type dirichlet -simplex 0 -dim 3 -cells 2,2,2 -petscspace_degree 3 -variable_coefficient nonlinear -jacobian_mf
+  test:
+    suffix: quad_q6_mf_cg
+    requires: !single
+    args: -run_type full -interpolate 1 -bc_type dirichlet -simplex 0 -cells 2,2 -petscspace_degree 6 -jacobian_mf -ksp_type cg -pc_type jacobi -ksp_rtol 1.0e-10 -snes_converged_reason
+
   # Serial tests with GLVis visualization
   test:
     suffix: glvis_2d_tet_p1
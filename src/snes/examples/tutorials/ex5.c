@@ -942,6 +942,20 @@ PetscErrorCode NonlinearGS(SNES snes,Vec X, Vec B, void *ctx)
      nsize: 4
      args: -snes_converged_reason -ksp_converged_reason -da_grid_x 129 -da_grid_y 129 -pc_type mg -pc_mg_levels 8 -mg_levels_ksp_type chebyshev -mg_levels_ksp_chebyshev_esteig 0,0.5,0,1.1 -mg_levels_ksp_max_it 2
 
+   test:
+     suffix: 6_reuse
+     args: -snes_converged_reason -ksp_converged_reason -da_grid_x 129 -da_grid_y 129 -pc_type mg -pc_mg_levels 8 -mg_levels_ksp_type chebyshev -mg_levels_ksp_chebyshev_esteig 0,0.5,0,1.1 -mg_levels_ksp_max_it 2 -mg_levels_ksp_chebyshev_esteig_reuse_steps 3 -snes_view
+     filter: grep -e "solve converged" -e "estimates reused"
+
+   test:
+     suffix: 6_reuse_rtol
+     args: -snes_converged_reason -ksp_converged_reason -da_grid_x 129 -da_grid_y 129 -pc_type mg -pc_mg_levels 8 -mg_levels_ksp_type chebyshev -mg_levels_ksp_chebyshev_esteig 0,0.5,0,1.1 -mg_levels_ksp_max_it 2 -mg_levels_ksp_chebyshev_esteig_reuse_steps 3 -mg_levels_ksp_chebyshev_esteig_reuse_rtol 1.e-3 -snes_view
+     filter: grep -e "solve converged" -e "estimates reused"
+
+   test:
+     suffix: 6_poly
+     args: -snes_converged_reason -ksp_converged_reason -da_grid_x 129 -da_grid_y 129 -pc_type mg -pc_mg_levels 8 -mg_levels_ksp_type richardson -mg_levels_ksp_max_it 1 -mg_levels_pc_type poly -mg_levels_pc_poly_degree 2
+
    test:
      requires: complex !single
      suffix: complex
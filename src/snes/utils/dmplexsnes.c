@@ -2011,6 +2011,7 @@ PetscErrorCode DMPlexComputeBdJacobian_Internal(DM dm, Vec locX, Vec locX_t, Pet
   PetscFunctionReturn(0);
 }
 
+/* Jac may be NULL when only JacP is wanted, for instance when the Jacobian is matrix-free */
 PetscErrorCode DMPlexComputeJacobian_Internal(DM dm, IS cellIS, PetscReal t, PetscReal X_tShift, Vec X, Vec X_t, Mat Jac, Mat JacP,void *user)
 {
   DM_Plex        *mesh  = (DM_Plex *) dm->data;
@@ -2040,6 +2041,7 @@ PetscErrorCode DMPlexComputeJacobian_Internal(DM dm, IS cellIS, PetscReal t, Pet
   ierr = PetscDSGetTotalDimension(prob, &totDim);CHKERRQ(ierr);
   ierr = PetscDSHasJacobian(prob, &hasJac);CHKERRQ(ierr);
   ierr = PetscDSHasJacobianPreconditioner(prob, &hasPrec);CHKERRQ(ierr);
+  if (!Jac && hasPrec) hasJac = PETSC_FALSE; /* only JacP is wanted; without a separate preconditioner it gets the Jacobian terms */
   ierr = PetscDSHasDynamicJacobian(prob, &hasDyn);CHKERRQ(ierr);
   hasDyn = hasDyn && (X_tShift != 0.0) ? PETSC_TRUE : PETSC_FALSE;
   ierr = PetscSectionGetNumFields(section, &Nf);CHKERRQ(ierr);
@@ -2180,7 +2182,7 @@ PetscErrorCode DMPlexComputeJacobian_Internal(DM dm, IS cellIS, PetscReal t, Pet
     const PetscInt cind = c - cStart;
 
     /* Transform to global basis before insertion in Jacobian */
-    if (transform) {ierr = DMPlexBasisTransformPointTensor_Internal(dm, tdm, tv, cell, PETSC_TRUE, totDim, &elemMat[cind*totDim*totDim]);CHKERRQ(ierr);}
+    if (transform && hasJac) {ierr = DMPlexBasisTransformPointTensor_Internal(dm, tdm, tv, cell, PETSC_TRUE, totDim, &elemMat[cind*totDim*totDim]);CHKERRQ(ierr);}
     if (hasPrec) {
       if (hasJac) {
         if (mesh->printFEM > 1) {ierr = DMPrintCellMatrix(cell, name, totDim, totDim, &elemMat[cind*totDim*totDim]);CHKERRQ(ierr);}
@@ -2426,9 +2428,11 @@ PetscErrorCode DMPlexComputeJacobianAction(DM dm, IS cellIS, PetscReal t, PetscR
   We form the residual one batch of elements at a time. This allows us to offload work onto an accelerator,
   like a GPU, or vectorize on a multicore machine.
 
+  If Jac or JacP was created with DMPlexSNESCreateJacobianMF(), only its linearization point is set.
+
   Level: developer
 
-.seealso: FormFunctionLocal()
+.seealso: FormFunctionLocal(), DMPlexSNESCreateJacobianMF()
 @*/
 PetscErrorCode DMPlexSNESComputeJacobianFEM(DM dm, Vec X, Mat Jac, Mat JacP,void *user)
 {
@@ -2437,9 +2441,16 @@ PetscErrorCode DMPlexSNESComputeJacobianFEM(DM dm, Vec X, Mat Jac, Mat JacP,void
   IS             cellIS;
   PetscBool      hasJac, hasPrec;
   PetscInt       depth;
+  PetscErrorCode (*setStateJ)(Mat, Vec) = NULL, (*setStateP)(Mat, Vec) = NULL;
   PetscErrorCode ierr;
 
   PetscFunctionBegin;
+  /* Matrix-free operators from DMPlexSNESCreateJacobianMF() only need the linearization point */
+  ierr = PetscObjectQueryFunction((PetscObject) Jac, "DMPlexSNESJacobianMFSetState_C", &setStateJ);CHKERRQ(ierr);
+  ierr = PetscObjectQueryFunction((PetscObject) JacP, "DMPlexSNESJacobianMFSetState_C", &setStateP);CHKERRQ(ierr);
+  if (setStateJ) {ierr = (*setStateJ)(Jac, X);CHKERRQ(ierr);}
+  if (setStateP && JacP != Jac) {ierr = (*setStateP)(JacP, X);CHKERRQ(ierr);}
+  if (setStateP) PetscFunctionReturn(0);
   ierr = DMSNESConvertPlex(dm,&plex,PETSC_TRUE);CHKERRQ(ierr);
   ierr = DMPlexGetDepth(plex, &depth);CHKERRQ(ierr);
   ierr = DMGetStratumIS(plex, "dim", depth, &cellIS);CHKERRQ(ierr);
@@ -2447,9 +2458,15 @@ PetscErrorCode DMPlexSNESComputeJacobianFEM(DM dm, Vec X, Mat Jac, Mat JacP,void
   ierr = DMGetDS(dm, &prob);CHKERRQ(ierr);
   ierr = PetscDSHasJacobian(prob, &hasJac);CHKERRQ(ierr);
   ierr = PetscDSHasJacobianPreconditioner(prob, &hasPrec);CHKERRQ(ierr);
-  if (hasJac && hasPrec) {ierr = MatZeroEntries(Jac);CHKERRQ(ierr);}
-  ierr = MatZeroEntries(JacP);CHKERRQ(ierr);
-  ierr = DMPlexComputeJacobian_Internal(plex, cellIS, 0.0, 0.0, X, NULL, Jac, JacP, user);CHKERRQ(ierr);
+  if (setStateJ) {
+    /* Only the preconditioning matrix is assembled, the Jacobian terms are not integrated if it has its own */
+    ierr = MatZeroEntries(JacP);CHKERRQ(ierr);
+    ierr = DMPlexComputeJacobian_Internal(plex, cellIS, 0.0, 0.0, X, NULL, NULL, JacP, user);CHKERRQ(ierr);
+  } else {
+    if (hasJac && hasPrec) {ierr = MatZeroEntries(Jac);CHKERRQ(ierr);}
+    ierr = MatZeroEntries(JacP);CHKERRQ(ierr);
+    ierr = DMPlexComputeJacobian_Internal(plex, cellIS, 0.0, 0.0, X, NULL, Jac, JacP, user);CHKERRQ(ierr);
+  }
   ierr = ISDestroy(&cellIS);CHKERRQ(ierr);
   ierr = DMDestroy(&plex);CHKERRQ(ierr);
   PetscFunctionReturn(0);
@@ -0,0 +1,827 @@
+#include <petsc/private/dmpleximpl.h>   /*I "petscdmplex.h" I*/
+#include <petsc/private/snesimpl.h>     /*I "petscsnes.h"   I*/
+#include <petscds.h>
+#include <petsc/private/petscfeimpl.h>
+
+/*
+  Matrix-free application of the finite element Jacobian of a DMPlex
+
+  The pointwise Jacobian functions g0-g3 are evaluated once for each linearization point and stored at the
+  quadrature points, weighted and pulled back to the reference cell exactly as PetscFEIntegrateJacobian_Basic()
+  does before it forms an element matrix. MatMult() then only interpolates the input to the quadrature points,
+  contracts it with the stored data, and integrates against the test functions. For tensor product Lagrange
+  elements the interpolation and integration are done by sum factorization, applying one 1D operator per
+  direction, which costs O(p^{d+1}) per cell rather than the O(p^{2d}) of an element matrix.
+*/
+typedef struct {
+  DM           dm;
+  IS           cellIS;
+  PetscInt     numCells;
+  PetscInt     dim, Nb, Nc, Nq;  /* Spatial dimension, basis functions, components, and quadrature points */
+  PetscInt    *cidx;             /* Local vector offsets of the closure of each cell, numCells*Nb */
+  PetscBool    hasG[4];          /* Which of g0-g3 are present */
+  PetscInt     gOff[4], qStride; /* Offsets of g0-g3 in the data of a quadrature point, and its total size */
+  PetscScalar *qdata;            /* The weighted pointwise Jacobian at each quadrature point, numCells*Nq*qStride */
+  PetscBool    hasState;         /* The linearization point has been set */
+  PetscBool    sumfact;          /* Use sum factorization */
+  PetscInt     nb, nq;           /* Number of 1D nodes and 1D quadrature points */
+  PetscInt    *bperm;            /* Lexicographic (component, node) to basis function */
+  PetscInt    *qperm;            /* Lexicographic quadrature point to quadrature point */
+  PetscReal   *B1, *D1;          /* 1D basis and derivative tabulation, nq x nb */
+  PetscReal   *BB, *BD, *DD;     /* Pointwise products of the 1D tabulations, used for the diagonal */
+  PetscScalar *ue, *ye, *u, *u_x, *f0, *f1, *t0, *t1, *t2;
+} DMPlexJacobianMF;
+
+/* out[i][j][k] = sum_l M[j][l] in[i][l][k], where in is pre x n x post, out is pre x m x post, and M is m x n, or n x m when transposed */
+static void DMPlexJacobianMFContract_Private(PetscInt pre, PetscInt m, PetscInt n, PetscInt post, const PetscReal M[], PetscBool transpose, PetscBool add, const PetscScalar in[], PetscScalar out[])
+{
+  PetscInt i, j, k, l;
+
+  for (i = 0; i < pre; ++i) {
+    for (j = 0; j < m; ++j) {
+      PetscScalar *o = &out[(i*m+j)*post];
+
+      if (!add) for (k = 0; k < post; ++k) o[k] = 0.0;
+      for (l = 0; l < n; ++l) {
+        const PetscReal    a = transpose ? M[l*m+j] : M[j*n+l];
+        const PetscScalar *x = &in[(i*n+l)*post];
+
+        for (k = 0; k < post; ++k) o[k] += a*x[k];
+      }
+    }
+  }
+}
+
+/* Apply the 1D matrix M[d] (nq x nb) in each direction d, taking nodal values to quadrature point values */
+static void DMPlexJacobianMFInterpolate_Private(DMPlexJacobianMF *mf, const PetscReal *M[], const PetscScalar in[], PetscScalar out[])
+{
+  const PetscInt     dim = mf->dim, nb = mf->nb, nq = mf->nq;
+  const PetscScalar *src = in;
+  PetscScalar       *dst;
+  PetscInt           pre = 1, post = 1, d;
+
+  for (d = 1; d < dim; ++d) post *= nb;
+  for (d = 0; d < dim; ++d) {
+    dst = d == dim-1 ? out : (d%2 ? mf->t2 : mf->t1);
+    DMPlexJacobianMFContract_Private(pre, nq, nb, post, M[d], PETSC_FALSE, PETSC_FALSE, src, dst);
+    src   = dst;
+    pre  *= nq;
+    post /= nb;
+  }
+}
+
+/* Apply the transpose of the 1D matrix M[d] (nq x nb) in each direction d, adding quadrature point values into nodal values */
+static void DMPlexJacobianMFIntegrate_Private(DMPlexJacobianMF *mf, const PetscReal *M[], const PetscScalar in[], PetscScalar out[])
+{
+  const PetscInt     dim = mf->dim, nb = mf->nb, nq = mf->nq;
+  const PetscScalar *src = in;
+  PetscScalar       *dst;
+  PetscInt           pre = 1, post = 1, d;
+
+  for (d = 1; d < dim; ++d) post *= nq;
+  for (d = 0; d < dim; ++d) {
+    dst = d == dim-1 ? out : (d%2 ? mf->t2 : mf->t1);
+    DMPlexJacobianMFContract_Private(pre, nb, nq, post, M[d], PETSC_TRUE, d == dim-1 ? PETSC_TRUE : PETSC_FALSE, src, dst);
+    src   = dst;
+    pre  *= nb;
+    post /= nq;
+  }
+}
+
+/* Contract the trial function jets u, u_x at each quadrature point with the stored Jacobian, giving the test function coefficients f0, f1 */
+static void DMPlexJacobianMFPointwise_Private(DMPlexJacobianMF *mf, const PetscScalar qdata[], const PetscInt qmap[])
+{
+  const PetscInt     dim = mf->dim, Nc = mf->Nc, Nq = mf->Nq;
+  const PetscBool    needF0 = mf->hasG[0] || mf->hasG[1] ? PETSC_TRUE : PETSC_FALSE;
+  const PetscBool    needF1 = mf->hasG[2] || mf->hasG[3] ? PETSC_TRUE : PETSC_FALSE;
+  const PetscScalar *u = mf->u, *u_x = mf->u_x;
+  PetscScalar       *f0 = mf->f0, *f1 = mf->f1;
+  PetscInt           s, fc, gc, d, d2;
+
+  for (s = 0; s < Nq; ++s) {
+    const PetscScalar *g  = &qdata[(qmap ? qmap[s] : s)*mf->qStride];
+    const PetscScalar *g0 = &g[mf->gOff[0]], *g1 = &g[mf->gOff[1]], *g2 = &g[mf->gOff[2]], *g3 = &g[mf->gOff[3]];
+
+    for (fc = 0; fc < Nc; ++fc) {
+      if (needF0) {
+        PetscScalar v = 0.0;
+
+        for (gc = 0; gc < Nc; ++gc) {
+          if (mf->hasG[0]) v += g0[fc*Nc+gc]*u[gc*Nq+s];
+          if (mf->hasG[1]) for (d = 0; d < dim; ++d) v += g1[(fc*Nc+gc)*dim+d]*u_x[(gc*dim+d)*Nq+s];
+        }
+        f0[fc*Nq+s] = v;
+      }
+      if (needF1) {
+        for (d = 0; d < dim; ++d) {
+          PetscScalar v = 0.0;
+
+          for (gc = 0; gc < Nc; ++gc) {
+            if (mf->hasG[2]) v += g2[(fc*Nc+gc)*dim+d]*u[gc*Nq+s];
+            if (mf->hasG[3]) for (d2 = 0; d2 < dim; ++d2) v += g3[((fc*Nc+gc)*dim+d)*dim+d2]*u_x[(gc*dim+d2)*Nq+s];
+          }
+          f1[(fc*dim+d)*Nq+s] = v;
+        }
+      }
+    }
+  }
+}
+
+/* Apply the Jacobian of one cell to the closure ue, giving ye */
+static void DMPlexJacobianMFApplyCell_Private(DMPlexJacobianMF *mf, PetscReal *B, PetscReal *D, const PetscScalar qdata[])
+{
+  const PetscInt  dim = mf->dim, Nb = mf->Nb, Nc = mf->Nc, Nq = mf->Nq;
+  const PetscBool needU  = mf->hasG[0] || mf->hasG[2] ? PETSC_TRUE : PETSC_FALSE;
+  const PetscBool needUx = mf->hasG[1] || mf->hasG[3] ? PETSC_TRUE : PETSC_FALSE;
+  const PetscBool needF0 = mf->hasG[0] || mf->hasG[1] ? PETSC_TRUE : PETSC_FALSE;
+  const PetscBool needF1 = mf->hasG[2] || mf->hasG[3] ? PETSC_TRUE : PETSC_FALSE;
+  PetscInt        b, c, d, e, q;
+
+  if (mf->sumfact) {
+    const PetscReal *M[3];
+    PetscInt         nbd = Nb/Nc, L;
+
+    for (c = 0; c < Nc; ++c) {
+      for (L = 0; L < nbd; ++L) mf->t0[L] = mf->ue[mf->bperm[c*nbd+L]];
+      if (needU) {
+        for (e = 0; e < dim; ++e) M[e] = mf->B1;
+        DMPlexJacobianMFInterpolate_Private(mf, M, mf->t0, &mf->u[c*Nq]);
+      }
+      if (needUx) {
+        for (d = 0; d < dim; ++d) {
+          for (e = 0; e < dim; ++e) M[e] = e == d ? mf->D1 : mf->B1;
+          DMPlexJacobianMFInterpolate_Private(mf, M, mf->t0, &mf->u_x[(c*dim+d)*Nq]);
+        }
+      }
+    }
+    DMPlexJacobianMFPointwise_Private(mf, qdata, mf->qperm);
+    for (c = 0; c < Nc; ++c) {
+      for (L = 0; L < nbd; ++L) mf->t0[L] = 0.0;
+      if (needF0) {
+        for (e = 0; e < dim; ++e) M[e] = mf->B1;
+        DMPlexJacobianMFIntegrate_Private(mf, M, &mf->f0[c*Nq], mf->t0);
+      }
+      if (needF1) {
+        for (d = 0; d < dim; ++d) {
+          for (e = 0; e < dim; ++e) M[e] = e == d ? mf->D1 : mf->B1;
+          DMPlexJacobianMFIntegrate_Private(mf, M, &mf->f1[(c*dim+d)*Nq], mf->t0);
+        }
+      }
+      for (L = 0; L < nbd; ++L) mf->ye[mf->bperm[c*nbd+L]] = mf->t0[L];
+    }
+  } else {
+    for (q = 0; q < Nq; ++q) {
+      for (c = 0; c < Nc; ++c) {
+        PetscScalar v = 0.0;
+
+        for (b = 0; b < Nb; ++b) v += B[(q*Nb+b)*Nc+c]*mf->ue[b];
+        mf->u[c*Nq+q] = v;
+        for (d = 0; d < dim; ++d) {
+          for (b = 0, v = 0.0; b < Nb; ++b) v += D[((q*Nb+b)*Nc+c)*dim+d]*mf->ue[b];
+          mf->u_x[(c*dim+d)*Nq+q] = v;
+        }
+      }
+    }
+    DMPlexJacobianMFPointwise_Private(mf, qdata, NULL);
+    for (b = 0; b < Nb; ++b) {
+      PetscScalar v = 0.0;
+
+      for (q = 0; q < Nq; ++q) {
+        for (c = 0; c < Nc; ++c) {
+          if (needF0) v += B[(q*Nb+b)*Nc+c]*mf->f0[c*Nq+q];
+          if (needF1) for (d = 0; d < dim; ++d) v += D[((q*Nb+b)*Nc+c)*dim+d]*mf->f1[(c*dim+d)*Nq+q];
+        }
+      }
+      mf->ye[b] = v;
+    }
+  }
+}
+
+/* The diagonal of the element matrix of one cell, in ye */
+static void DMPlexJacobianMFDiagonalCell_Private(DMPlexJacobianMF *mf, PetscReal *B, PetscReal *D, const PetscScalar qdata[])
+{
+  const PetscInt dim = mf->dim, Nb = mf->Nb, Nc = mf->Nc, Nq = mf->Nq;
+  PetscInt       b, c, d, d2, e, q;
+
+  if (mf->sumfact) {
+    const PetscReal *M[3];
+    const PetscReal *P[3];
+    PetscInt         nbd = Nb/Nc, L, s, t;
+
+    P[0] = mf->BB; P[1] = mf->BD; P[2] = mf->DD;
+    for (c = 0; c < Nc; ++c) {
+      for (L = 0; L < nbd; ++L) mf->t0[L] = 0.0;
+      /* Term (s, t) pairs the test function derivative s with the trial function derivative t, where -1 means the value */
+      for (s = -1; s < dim; ++s) {
+        for (t = -1; t < dim; ++t) {
+          PetscInt k, off;
+
+          if (s < 0 && t < 0)      {k = 0; off = c*Nc+c;}
+          else if (s < 0)          {k = 1; off = (c*Nc+c)*dim+t;}
+          else if (t < 0)          {k = 2; off = (c*Nc+c)*dim+s;}
+          else                     {k = 3; off = ((c*Nc+c)*dim+s)*dim+t;}
+          if (!mf->hasG[k]) continue;
+          for (L = 0; L < Nq; ++L) mf->f0[L] = qdata[mf->qperm[L]*mf->qStride+mf->gOff[k]+off];
+          for (e = 0; e < dim; ++e) M[e] = P[(e == s ? 1 : 0) + (e == t ? 1 : 0)];
+          DMPlexJacobianMFIntegrate_Private(mf, M, mf->f0, mf->t0);
+        }
+      }
+      for (L = 0; L < nbd; ++L) mf->ye[mf->bperm[c*nbd+L]] = mf->t0[L];
+    }
+  } else {
+    for (b = 0; b < Nb; ++b) {
+      PetscScalar v = 0.0;
+
+      for (q = 0; q < Nq; ++q) {
+        const PetscScalar *g  = &qdata[q*mf->qStride];
+        const PetscScalar *g0 = &g[mf->gOff[0]], *g1 = &g[mf->gOff[1]], *g2 = &g[mf->gOff[2]], *g3 = &g[mf->gOff[3]];
+        const PetscReal   *Bq = &B[q*Nb*Nc], *Dq = &D[q*Nb*Nc*dim];
+        PetscInt           fc, gc;
+
+        for (fc = 0; fc < Nc; ++fc) {
+          for (gc = 0; gc < Nc; ++gc) {
+            const PetscInt fidx = b*Nc+fc, gidx = b*Nc+gc;
+
+            if (mf->hasG[0]) v += Bq[fidx]*g0[fc*Nc+gc]*Bq[gidx];
+            for (d = 0; d < dim; ++d) {
+              if (mf->hasG[1]) v += Bq[fidx]*g1[(fc*Nc+gc)*dim+d]*Dq[gidx*dim+d];
+              if (mf->hasG[2]) v += Dq[fidx*dim+d]*g2[(fc*Nc+gc)*dim+d]*Bq[gidx];
+              if (mf->hasG[3]) for (d2 = 0; d2 < dim; ++d2) v += Dq[fidx*dim+d]*g3[((fc*Nc+gc)*dim+d)*dim+d2]*Dq[gidx*dim+d2];
+            }
+          }
+        }
+      }
+      mf->ye[b] = v;
+    }
+  }
+}
+
+/* The number of flops for one application of the 1D matrices in every direction */
+static PetscLogDouble DMPlexJacobianMFContractFlops_Private(DMPlexJacobianMF *mf)
+{
+  PetscLogDouble flops = 0.0, pre = 1.0, post = 1.0;
+  PetscInt       d;
+
+  if (!mf->sumfact) return 2.0*mf->Nq*mf->Nb*mf->Nc;
+  for (d = 1; d < mf->dim; ++d) post *= mf->nb;
+  for (d = 0; d < mf->dim; ++d) {
+    flops += 2.0*pre*mf->nq*mf->nb*post;
+    pre   *= mf->nq;
+    post  /= mf->nb;
+  }
+  return flops*mf->Nc;
+}
+
+static PetscErrorCode MatMult_DMPlexJacobianMF(Mat A, Vec X, Vec Y)
+{
+  DMPlexJacobianMF  *mf;
+  PetscDS            ds;
+  PetscReal        **B, **D;
+  Vec                locX, locY;
+  const PetscScalar *x;
+  PetscScalar       *y;
+  PetscLogDouble     flops;
+  PetscInt           Nb, c, b;
+  PetscErrorCode     ierr;
+
+  PetscFunctionBegin;
+  ierr = MatShellGetContext(A, (void **) &mf);CHKERRQ(ierr);
+  if (!mf->hasState) SETERRQ(PetscObjectComm((PetscObject) A), PETSC_ERR_ARG_WRONGSTATE, "The linearization point has not been set, call SNESComputeJacobian() first");
+  ierr = DMGetDS(mf->dm, &ds);CHKERRQ(ierr);
+  ierr = PetscDSGetTabulation(ds, &B, &D);CHKERRQ(ierr);
+  ierr = DMGetLocalVector(mf->dm, &locX);CHKERRQ(ierr);
+  ierr = DMGetLocalVector(mf->dm, &locY);CHKERRQ(ierr);
+  ierr = VecSet(locX, 0.0);CHKERRQ(ierr);
+  ierr = VecSet(locY, 0.0);CHKERRQ(ierr);
+  ierr = DMGlobalToLocalBegin(mf->dm, X, INSERT_VALUES, locX);CHKERRQ(ierr);
+  ierr = DMGlobalToLocalEnd(mf->dm, X, INSERT_VALUES, locX);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(locX, &x);CHKERRQ(ierr);
+  ierr = VecGetArray(locY, &y);CHKERRQ(ierr);
+  Nb   = mf->Nb;
+  for (c = 0; c < mf->numCells; ++c) {
+    const PetscInt *cidx = &mf->cidx[c*Nb];
+
+    for (b = 0; b < Nb; ++b) mf->ue[b] = x[cidx[b]];
+    DMPlexJacobianMFApplyCell_Private(mf, B[0], D[0], &mf->qdata[c*mf->Nq*mf->qStride]);
+    for (b = 0; b < Nb; ++b) y[cidx[b]] += mf->ye[b];
+  }
+  ierr = VecRestoreArray(locY, &y);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(locX, &x);CHKERRQ(ierr);
+  ierr = VecSet(Y, 0.0);CHKERRQ(ierr);
+  ierr = DMLocalToGlobalBegin(mf->dm, locY, ADD_VALUES, Y);CHKERRQ(ierr);
+  ierr = DMLocalToGlobalEnd(mf->dm, locY, ADD_VALUES, Y);CHKERRQ(ierr);
+  ierr = DMRestoreLocalVector(mf->dm, &locX);CHKERRQ(ierr);
+  ierr = DMRestoreLocalVector(mf->dm, &locY);CHKERRQ(ierr);
+  flops = 2.0*mf->Nq*mf->qStride;
+  if (mf->hasG[0] || mf->hasG[2]) flops += 2.0*DMPlexJacobianMFContractFlops_Private(mf);
+  if (mf->hasG[1] || mf->hasG[3]) flops += 2.0*mf->dim*DMPlexJacobianMFContractFlops_Private(mf);
+  ierr = PetscLogFlops(mf->numCells*flops);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatGetDiagonal_DMPlexJacobianMF(Mat A, Vec Y)
+{
+  DMPlexJacobianMF  *mf;
+  PetscDS            ds;
+  PetscReal        **B, **D;
+  Vec                locY;
+  PetscScalar       *y;
+  PetscInt           Nb, c, b;
+  PetscErrorCode     ierr;
+
+  PetscFunctionBegin;
+  ierr = MatShellGetContext(A, (void **) &mf);CHKERRQ(ierr);
+  if (!mf->hasState) SETERRQ(PetscObjectComm((PetscObject) A), PETSC_ERR_ARG_WRONGSTATE, "The linearization point has not been set, call SNESComputeJacobian() first");
+  ierr = DMGetDS(mf->dm, &ds);CHKERRQ(ierr);
+  ierr = PetscDSGetTabulation(ds, &B, &D);CHKERRQ(ierr);
+  ierr = DMGetLocalVector(mf->dm, &locY);CHKERRQ(ierr);
+  ierr = VecSet(locY, 0.0);CHKERRQ(ierr);
+  ierr = VecGetArray(locY, &y);CHKERRQ(ierr);
+  Nb   = mf->Nb;
+  for (c = 0; c < mf->numCells; ++c) {
+    const PetscInt *cidx = &mf->cidx[c*Nb];
+
+    DMPlexJacobianMFDiagonalCell_Private(mf, B[0], D[0], &mf->qdata[c*mf->Nq*mf->qStride]);
+    for (b = 0; b < Nb; ++b) y[cidx[b]] += mf->ye[b];
+  }
+  ierr = VecRestoreArray(locY, &y);CHKERRQ(ierr);
+  ierr = VecSet(Y, 0.0);CHKERRQ(ierr);
+  ierr = DMLocalToGlobalBegin(mf->dm, locY, ADD_VALUES, Y);CHKERRQ(ierr);
+  ierr = DMLocalToGlobalEnd(mf->dm, locY, ADD_VALUES, Y);CHKERRQ(ierr);
+  ierr = DMRestoreLocalVector(mf->dm, &locY);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatDestroy_DMPlexJacobianMF(Mat A)
+{
+  DMPlexJacobianMF *mf;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = MatShellGetContext(A, (void **) &mf);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject) A, "DMPlexSNESJacobianMFSetState_C", NULL);CHKERRQ(ierr);
+  ierr = PetscFree(mf->cidx);CHKERRQ(ierr);
+  ierr = PetscFree(mf->qdata);CHKERRQ(ierr);
+  ierr = PetscFree2(mf->bperm, mf->qperm);CHKERRQ(ierr);
+  ierr = PetscFree5(mf->B1, mf->D1, mf->BB, mf->BD, mf->DD);CHKERRQ(ierr);
+  ierr = PetscFree5(mf->ue, mf->ye, mf->u, mf->u_x, mf->f0);CHKERRQ(ierr);
+  ierr = PetscFree4(mf->f1, mf->t0, mf->t1, mf->t2);CHKERRQ(ierr);
+  ierr = ISDestroy(&mf->cellIS);CHKERRQ(ierr);
+  ierr = DMDestroy(&mf->dm);CHKERRQ(ierr);
+  ierr = PetscFree(mf);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* Evaluate and store the pointwise Jacobian at every quadrature point for the linearization point locX */
+static PetscErrorCode DMPlexSNESJacobianMFSetState_Private(Mat A, Vec locX)
+{
+  DMPlexJacobianMF  *mf;
+  DM                 dm, dmAux, plexAux = NULL;
+  Vec                locA;
+  DMField            coordField;
+  PetscDS            ds, dsAux = NULL;
+  PetscFE            fe;
+  PetscQuadrature    quad;
+  PetscFEGeom       *geom;
+  PetscPointJac      gfunc[4];
+  PetscScalar       *u, *u_x, *a = NULL, *a_x = NULL, *refSpaceDer, *refSpaceDerAux = NULL;
+  PetscScalar       *coefAux = NULL;
+  const PetscScalar *constants;
+  const PetscReal   *quadPoints, *quadWeights;
+  const PetscInt    *cells;
+  PetscReal         *x, **B, **D, **BAux = NULL, **DAux = NULL;
+  PetscInt          *Nb, *Nc, *uOff, *uOff_x, *aOff = NULL, *aOff_x = NULL, *NbAux = NULL, *NcAux = NULL;
+  PetscInt           dim, Nc0, dE, Np, NfAux = 0, numConstants, cStart, cEnd, c, q, k, qStride;
+  PetscErrorCode     ierr;
+
+  PetscFunctionBegin;
+  ierr = MatShellGetContext(A, (void **) &mf);CHKERRQ(ierr);
+  dm   = mf->dm;
+  dim  = mf->dim;
+  Nc0  = mf->Nc;
+  ierr = DMGetDS(dm, &ds);CHKERRQ(ierr);
+  ierr = PetscDSGetDiscretization(ds, 0, (PetscObject *) &fe);CHKERRQ(ierr);
+  ierr = PetscFEGetQuadrature(fe, &quad);CHKERRQ(ierr);
+  ierr = PetscQuadratureGetData(quad, NULL, NULL, NULL, &quadPoints, &quadWeights);CHKERRQ(ierr);
+  ierr = PetscDSGetJacobian(ds, 0, 0, &gfunc[0], &gfunc[1], &gfunc[2], &gfunc[3]);CHKERRQ(ierr);
+  for (k = 0, qStride = 0; k < 4; ++k) {
+    const PetscInt size = Nc0*Nc0*(k == 0 ? 1 : (k == 3 ? dim*dim : dim));
+
+    mf->hasG[k] = gfunc[k] ? PETSC_TRUE : PETSC_FALSE;
+    mf->gOff[k] = qStride;
+    if (gfunc[k]) qStride += size;
+  }
+  if (!mf->hasState || qStride != mf->qStride) {
+    ierr = PetscFree(mf->qdata);CHKERRQ(ierr);
+    ierr = PetscMalloc1(mf->numCells*mf->Nq*qStride, &mf->qdata);CHKERRQ(ierr);
+    mf->qStride = qStride;
+  }
+  mf->hasState = PETSC_TRUE;
+  if (!qStride) PetscFunctionReturn(0);
+  ierr = PetscDSGetDimensions(ds, &Nb);CHKERRQ(ierr);
+  ierr = PetscDSGetComponents(ds, &Nc);CHKERRQ(ierr);
+  ierr = PetscDSGetComponentOffsets(ds, &uOff);CHKERRQ(ierr);
+  ierr = PetscDSGetComponentDerivativeOffsets(ds, &uOff_x);CHKERRQ(ierr);
+  ierr = PetscDSGetEvaluationArrays(ds, &u, NULL, &u_x);CHKERRQ(ierr);
+  ierr = PetscDSGetRefCoordArrays(ds, &x, &refSpaceDer);CHKERRQ(ierr);
+  ierr = PetscDSGetTabulation(ds, &B, &D);CHKERRQ(ierr);
+  ierr = PetscDSGetConstants(ds, &numConstants, &constants);CHKERRQ(ierr);
+  ierr = PetscObjectQuery((PetscObject) dm, "dmAux", (PetscObject *) &dmAux);CHKERRQ(ierr);
+  ierr = PetscObjectQuery((PetscObject) dm, "A", (PetscObject *) &locA);CHKERRQ(ierr);
+  if (dmAux) {
+    ierr = DMConvert(dmAux, DMPLEX, &plexAux);CHKERRQ(ierr);
+    ierr = DMGetDS(dmAux, &dsAux);CHKERRQ(ierr);
+    ierr = PetscDSGetNumFields(dsAux, &NfAux);CHKERRQ(ierr);
+    ierr = PetscDSGetDimensions(dsAux, &NbAux);CHKERRQ(ierr);
+    ierr = PetscDSGetComponents(dsAux, &NcAux);CHKERRQ(ierr);
+    ierr = PetscDSGetComponentOffsets(dsAux, &aOff);CHKERRQ(ierr);
+    ierr = PetscDSGetComponentDerivativeOffsets(dsAux, &aOff_x);CHKERRQ(ierr);
+    ierr = PetscDSGetEvaluationArrays(dsAux, &a, NULL, &a_x);CHKERRQ(ierr);
+    ierr = PetscDSGetRefCoordArrays(dsAux, NULL, &refSpaceDerAux);CHKERRQ(ierr);
+    ierr = PetscDSGetTabulation(dsAux, &BAux, &DAux);CHKERRQ(ierr);
+  }
+  ierr = DMGetCoordinateField(dm, &coordField);CHKERRQ(ierr);
+  ierr = DMSNESGetFEGeom(coordField, mf->cellIS, quad, PETSC_FALSE, &geom);CHKERRQ(ierr);
+  Np   = geom->numPoints;
+  dE   = geom->dimEmbed;
+  if (dE != dim) SETERRQ2(PetscObjectComm((PetscObject) A), PETSC_ERR_SUP, "Matrix-free Jacobian does not support embedding dimension %D for a dimension %D mesh", dE, dim);
+  ierr = ISGetPointRange(mf->cellIS, &cStart, &cEnd, &cells);CHKERRQ(ierr);
+  for (c = cStart; c < cEnd; ++c) {
+    const PetscInt   cell = cells ? cells[c] : c;
+    const PetscInt   e    = c - cStart;
+    const PetscReal *v0   = &geom->v[e*Np*dE];
+    const PetscReal *J    = &geom->J[e*Np*dE*dE];
+    PetscScalar     *coef = NULL;
+
+    ierr = DMPlexVecGetClosure(dm, NULL, locX, cell, NULL, &coef);CHKERRQ(ierr);
+    if (dmAux) {
+      PetscInt subcell;
+
+      ierr = DMPlexGetAuxiliaryPoint(dm, dmAux, cell, &subcell);CHKERRQ(ierr);
+      ierr = DMPlexVecGetClosure(plexAux, NULL, locA, subcell, NULL, &coefAux);CHKERRQ(ierr);
+    }
+    for (q = 0; q < mf->Nq; ++q) {
+      PetscScalar     *g = &mf->qdata[(e*mf->Nq+q)*qStride];
+      const PetscReal *v, *invJ;
+      PetscReal        detJ, w;
+      PetscInt         fc, gc, d, d2, dp, d3;
+
+      if (geom->isAffine) {
+        CoordinatesRefToReal(dE, dim, geom->xi, v0, J, &quadPoints[q*dim], x);
+        v    = x;
+        invJ = &geom->invJ[e*dE*dE];
+        detJ = geom->detJ[e];
+      } else {
+        v    = &v0[q*dE];
+        invJ = &geom->invJ[(e*Np+q)*dE*dE];
+        detJ = geom->detJ[e*Np + q];
+      }
+      w = detJ*quadWeights[q];
+      EvaluateFieldJets(dim, 1, Nb, Nc, q, B, D, refSpaceDer, invJ, coef, NULL, u, u_x, NULL);
+      if (dmAux) EvaluateFieldJets(dim, NfAux, NbAux, NcAux, q, BAux, DAux, refSpaceDerAux, invJ, coefAux, NULL, a, a_x, NULL);
+      if (gfunc[0]) {
+        PetscScalar *g0 = &g[mf->gOff[0]];
+
+        ierr = PetscMemzero(g0, Nc0*Nc0 * sizeof(PetscScalar));CHKERRQ(ierr);
+        gfunc[0](dim, 1, NfAux, uOff, uOff_x, u, NULL, u_x, aOff, aOff_x, a, NULL, a_x, 0.0, 0.0, v, numConstants, constants, g0);
+        for (fc = 0; fc < Nc0*Nc0; ++fc) g0[fc] *= w;
+      }
+      for (k = 1; k < 3; ++k) {
+        PetscScalar *gk = &g[mf->gOff[k]];
+
+        if (!gfunc[k]) continue;
+        ierr = PetscMemzero(refSpaceDer, Nc0*Nc0*dim * sizeof(PetscScalar));CHKERRQ(ierr);
+        gfunc[k](dim, 1, NfAux, uOff, uOff_x, u, NULL, u_x, aOff, aOff_x, a, NULL, a_x, 0.0, 0.0, v, numConstants, constants, refSpaceDer);
+        for (fc = 0; fc < Nc0; ++fc) {
+          for (gc = 0; gc < Nc0; ++gc) {
+            for (d = 0; d < dim; ++d) {
+              gk[(fc*Nc0+gc)*dim+d] = 0.0;
+              for (d2 = 0; d2 < dim; ++d2) gk[(fc*Nc0+gc)*dim+d] += invJ[d*dim+d2]*refSpaceDer[(fc*Nc0+gc)*dim+d2];
+              gk[(fc*Nc0+gc)*dim+d] *= w;
+            }
+          }
+        }
+      }
+      if (gfunc[3]) {
+        PetscScalar *g3 = &g[mf->gOff[3]];
+
+        ierr = PetscMemzero(refSpaceDer, Nc0*Nc0*dim*dim * sizeof(PetscScalar));CHKERRQ(ierr);
+        gfunc[3](dim, 1, NfAux, uOff, uOff_x, u, NULL, u_x, aOff, aOff_x, a, NULL, a_x, 0.0, 0.0, v, numConstants, constants, refSpaceDer);
+        for (fc = 0; fc < Nc0; ++fc) {
+          for (gc = 0; gc < Nc0; ++gc) {
+            for (d = 0; d < dim; ++d) {
+              for (dp = 0; dp < dim; ++dp) {
+                g3[((fc*Nc0+gc)*dim+d)*dim+dp] = 0.0;
+                for (d2 = 0; d2 < dim; ++d2) {
+                  for (d3 = 0; d3 < dim; ++d3) {
+                    g3[((fc*Nc0+gc)*dim+d)*dim+dp] += invJ[d*dim+d2]*refSpaceDer[((fc*Nc0+gc)*dim+d2)*dim+d3]*invJ[dp*dim+d3];
+                  }
+                }
+                g3[((fc*Nc0+gc)*dim+d)*dim+dp] *= w;
+              }
+            }
+          }
+        }
+      }
+    }
+    ierr = DMPlexVecRestoreClosure(dm, NULL, locX, cell, NULL, &coef);CHKERRQ(ierr);
+    if (dmAux) {
+      PetscInt subcell;
+
+      ierr = DMPlexGetAuxiliaryPoint(dm, dmAux, cell, &subcell);CHKERRQ(ierr);
+      ierr = DMPlexVecRestoreClosure(plexAux, NULL, locA, subcell, NULL, &coefAux);CHKERRQ(ierr);
+    }
+  }
+  ierr = ISRestorePointRange(mf->cellIS, &cStart, &cEnd, &cells);CHKERRQ(ierr);
+  ierr = DMSNESRestoreFEGeom(coordField, mf->cellIS, quad, PETSC_FALSE, &geom);CHKERRQ(ierr);
+  ierr = DMDestroy(&plexAux);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* Find x in the sorted unique values xs[n] */
+static PetscInt DMPlexJacobianMFFind_Private(PetscReal x, PetscInt n, const PetscReal xs[])
+{
+  PetscInt i;
+
+  for (i = 0; i < n; ++i) if (PetscAbsReal(x - xs[i]) < PETSC_SQRT_MACHINE_EPSILON) return i;
+  return -1;
+}
+
+/* Sort the values xs[n] and remove duplicates */
+static PetscErrorCode DMPlexJacobianMFUnique_Private(PetscInt *n, PetscReal xs[])
+{
+  PetscInt       i, m = 0;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscSortReal(*n, xs);CHKERRQ(ierr);
+  for (i = 0; i < *n; ++i) if (!m || PetscAbsReal(xs[i] - xs[m-1]) >= PETSC_SQRT_MACHINE_EPSILON) xs[m++] = xs[i];
+  *n = m;
+  PetscFunctionReturn(0);
+}
+
+/*
+  Recognize a tensor product Lagrange element with tensor Gauss quadrature. We recover the 1D quadrature points and the 1D
+  nodes from the quadrature and the dual space, build the 1D Lagrange tabulation, and accept the element only if the products
+  of the 1D tabulation reproduce the tabulation of the PetscFE.
+*/
+static PetscErrorCode DMPlexJacobianMFSetUpTensor_Private(DMPlexJacobianMF *mf, PetscFE fe, PetscReal *B, PetscReal *D, PetscBool *isTensor)
+{
+  PetscDualSpace   sp;
+  PetscQuadrature  quad;
+  const PetscReal *points;
+  PetscReal       *xq, *xb, *nodes;
+  PetscInt        *comp, *qidx, *bidx;
+  const PetscInt   dim = mf->dim, Nb = mf->Nb, Nc = mf->Nc, Nq = mf->Nq;
+  PetscInt         nq, nb, nqd, nbd, spdim, q, b, c, d, i, j, k;
+  PetscErrorCode   ierr;
+
+  PetscFunctionBegin;
+  *isTensor = PETSC_FALSE;
+  if (dim < 1 || dim > 3) PetscFunctionReturn(0);
+  ierr = PetscFEGetQuadrature(fe, &quad);CHKERRQ(ierr);
+  ierr = PetscFEGetDualSpace(fe, &sp);CHKERRQ(ierr);
+  ierr = PetscDualSpaceGetDimension(sp, &spdim);CHKERRQ(ierr);
+  if (spdim != Nb) PetscFunctionReturn(0);
+  ierr = PetscQuadratureGetData(quad, NULL, NULL, NULL, &points, NULL);CHKERRQ(ierr);
+  ierr = PetscMalloc6(Nq, &xq, Nb, &xb, Nb*dim, &nodes, Nb, &comp, Nq*dim, &qidx, Nb*dim, &bidx);CHKERRQ(ierr);
+  /* Quadrature points */
+  for (q = 0; q < Nq; ++q) xq[q] = points[q*dim];
+  nq   = Nq;
+  ierr = DMPlexJacobianMFUnique_Private(&nq, xq);CHKERRQ(ierr);
+  for (d = 0, nqd = 1; d < dim; ++d) nqd *= nq;
+  if (nqd != Nq) goto cleanup;
+  for (q = 0; q < Nq; ++q) for (d = 0; d < dim; ++d) if ((qidx[q*dim+d] = DMPlexJacobianMFFind_Private(points[q*dim+d], nq, xq)) < 0) goto cleanup;
+  /* Nodes of the dual space */
+  for (b = 0; b < Nb; ++b) {
+    PetscQuadrature  f;
+    const PetscReal *fpoints, *fweights;
+    PetscInt         fNc, fNp;
+
+    ierr = PetscDualSpaceGetFunctional(sp, b, &f);CHKERRQ(ierr);
+    ierr = PetscQuadratureGetData(f, NULL, &fNc, &fNp, &fpoints, &fweights);CHKERRQ(ierr);
+    if (fNp != 1 || fNc != Nc) goto cleanup;
+    for (c = 0, comp[b] = -1; c < Nc; ++c) {
+      if (fweights[c] == 0.0) continue;
+      if (comp[b] >= 0) goto cleanup;
+      comp[b] = c;
+    }
+    if (comp[b] < 0) goto cleanup;
+    for (d = 0; d < dim; ++d) nodes[b*dim+d] = fpoints[d];
+    xb[b] = fpoints[0];
+  }
+  nb   = Nb;
+  ierr = DMPlexJacobianMFUnique_Private(&nb, xb);CHKERRQ(ierr);
+  for (d = 0, nbd = 1; d < dim; ++d) nbd *= nb;
+  if (nbd*Nc != Nb) goto cleanup;
+  for (b = 0; b < Nb; ++b) for (d = 0; d < dim; ++d) if ((bidx[b*dim+d] = DMPlexJacobianMFFind_Private(nodes[b*dim+d], nb, xb)) < 0) goto cleanup;
+  mf->nq = nq;
+  mf->nb = nb;
+  ierr = PetscMalloc2(Nb, &mf->bperm, Nq, &mf->qperm);CHKERRQ(ierr);
+  ierr = PetscMalloc5(nq*nb, &mf->B1, nq*nb, &mf->D1, nq*nb, &mf->BB, nq*nb, &mf->BD, nq*nb, &mf->DD);CHKERRQ(ierr);
+  for (b = 0; b < Nb; ++b) mf->bperm[b] = -1;
+  for (q = 0; q < Nq; ++q) mf->qperm[q] = -1;
+  for (q = 0; q < Nq; ++q) {
+    PetscInt L = 0;
+
+    for (d = 0; d < dim; ++d) L = L*nq + qidx[q*dim+d];
+    if (mf->qperm[L] >= 0) goto cleanup;
+    mf->qperm[L] = q;
+  }
+  for (b = 0; b < Nb; ++b) {
+    PetscInt L = 0;
+
+    for (d = 0; d < dim; ++d) L = L*nb + bidx[b*dim+d];
+    if (mf->bperm[comp[b]*nbd+L] >= 0) goto cleanup;
+    mf->bperm[comp[b]*nbd+L] = b;
+  }
+  /* 1D Lagrange basis on the nodes xb, and its derivative, at the quadrature points xq */
+  for (k = 0; k < nq; ++k) {
+    for (i = 0; i < nb; ++i) {
+      PetscReal l = 1.0, dl = 0.0;
+
+      for (j = 0; j < nb; ++j) {
+        PetscReal p = 1.0;
+        PetscInt  m;
+
+        if (j == i) continue;
+        l *= (xq[k] - xb[j])/(xb[i] - xb[j]);
+        for (m = 0; m < nb; ++m) if (m != i) p *= m == j ? 1.0/(xb[i] - xb[j]) : (xq[k] - xb[m])/(xb[i] - xb[m]);
+        dl += p;
+      }
+      mf->B1[k*nb+i] = l;
+      mf->D1[k*nb+i] = dl;
+      mf->BB[k*nb+i] = l*l;
+      mf->BD[k*nb+i] = l*dl;
+      mf->DD[k*nb+i] = dl*dl;
+    }
+  }
+  /* Check the tensor product against the tabulation of the element */
+  for (q = 0; q < Nq; ++q) {
+    for (b = 0; b < Nb; ++b) {
+      for (c = 0; c < Nc; ++c) {
+        PetscReal val = 0.0, der[3] = {0.0, 0.0, 0.0};
+
+        if (c == comp[b]) {
+          val = 1.0;
+          for (d = 0; d < dim; ++d) {
+            val *= mf->B1[qidx[q*dim+d]*nb+bidx[b*dim+d]];
+            for (i = 0, der[d] = 1.0; i < dim; ++i) der[d] *= (i == d ? mf->D1 : mf->B1)[qidx[q*dim+i]*nb+bidx[b*dim+i]];
+          }
+        }
+        if (PetscAbsReal(val - B[(q*Nb+b)*Nc+c]) > PETSC_SQRT_MACHINE_EPSILON*(1.0 + PetscAbsReal(val))) goto cleanup;
+        for (d = 0; d < dim; ++d) if (PetscAbsReal(der[d] - D[((q*Nb+b)*Nc+c)*dim+d]) > PETSC_SQRT_MACHINE_EPSILON*(1.0 + PetscAbsReal(der[d]))) goto cleanup;
+      }
+    }
+  }
+  *isTensor = PETSC_TRUE;
+  cleanup:
+  if (!*isTensor) {
+    ierr = PetscFree2(mf->bperm, mf->qperm);CHKERRQ(ierr);
+    ierr = PetscFree5(mf->B1, mf->D1, mf->BB, mf->BD, mf->DD);CHKERRQ(ierr);
+  }
+  ierr = PetscFree6(xq, xb, nodes, comp, qidx, bidx);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*@
+  DMPlexSNESCreateJacobianMF - Create a matrix that applies the finite element Jacobian of a DMPlex without assembling it
+
+  Collective on DM
+
+  Input Parameter:
+. dm - The DM, with a single PetscFE field
+
+  Output Parameter:
+. J - The MATSHELL, supporting MatMult() and MatGetDiagonal()
+
+  Options Database Key:
+. -dm_plex_jacobian_mf_sum_factorization <bool> - Use sum factorization for tensor product elements (default true)
+
+  Notes:
+  The linearization point is set by DMPlexSNESComputeJacobianFEM(), so J can be given as the Jacobian or preconditioning matrix
+  to SNESSetJacobian() for a DM using DMPlexSetSNESLocalFEM(). When J is the Jacobian and the preconditioning matrix is a
+  different, assembled, matrix, only the latter is assembled.
+
+  The pointwise Jacobian functions are evaluated at each quadrature point once for every linearization point, and each MatMult()
+  then costs O(p^{2d}) for a general element of degree p in dimension d. For tensor product Lagrange elements on quadrilaterals
+  and hexahedra, for example those given by -petscspace_poly_tensor, the interpolation to and from the quadrature points is done
+  by sum factorization and the cost drops to O(p^{d+1}), so high order is cheap to apply even though it is expensive to assemble.
+
+  Boundary integral Jacobian terms, time derivatives, and basis transformations are not supported.
+
+  Level: intermediate
+
+.seealso: DMPlexSNESComputeJacobianFEM(), DMPlexSetSNESLocalFEM(), MatCreateShell()
+@*/
+PetscErrorCode DMPlexSNESCreateJacobianMF(DM dm, Mat *J)
+{
+  DMPlexJacobianMF *mf;
+  DM                plex;
+  PetscDS           ds;
+  PetscFE           fe;
+  PetscObject       obj;
+  PetscClassId      id;
+  PetscQuadrature   quad;
+  PetscFEGeom      *geom;
+  PetscReal       **B, **D;
+  Vec               X, locIdx;
+  PetscScalar      *idx;
+  PetscInt          Nf, m, M, n, depth, c, cStart, cEnd, b, nw;
+  const PetscInt   *cells;
+  PetscBool         isPlex, transform, useSumFact = PETSC_TRUE, isTensor;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(dm, DM_CLASSID, 1);
+  PetscValidPointer(J, 2);
+  ierr = PetscObjectTypeCompare((PetscObject) dm, DMPLEX, &isPlex);CHKERRQ(ierr);
+  if (isPlex) {
+    plex = dm;
+    ierr = PetscObjectReference((PetscObject) plex);CHKERRQ(ierr);
+  } else {
+    ierr = DMConvert(dm, DMPLEX, &plex);CHKERRQ(ierr);
+  }
+  ierr = DMHasBasisTransform(plex, &transform);CHKERRQ(ierr);
+  if (transform) SETERRQ(PetscObjectComm((PetscObject) dm), PETSC_ERR_SUP, "Matrix-free Jacobian does not support basis transformations");
+  ierr = DMGetDS(plex, &ds);CHKERRQ(ierr);
+  ierr = PetscDSGetNumFields(ds, &Nf);CHKERRQ(ierr);
+  if (Nf != 1) SETERRQ1(PetscObjectComm((PetscObject) dm), PETSC_ERR_SUP, "Matrix-free Jacobian only supports a single field, not %D", Nf);
+  ierr = PetscDSGetDiscretization(ds, 0, &obj);CHKERRQ(ierr);
+  ierr = PetscObjectGetClassId(obj, &id);CHKERRQ(ierr);
+  if (id != PETSCFE_CLASSID) SETERRQ(PetscObjectComm((PetscObject) dm), PETSC_ERR_SUP, "Matrix-free Jacobian requires a PetscFE discretization");
+  {
+    PetscBdPointJac g0, g1, g2, g3;
+
+    ierr = PetscDSGetBdJacobian(ds, 0, 0, &g0, &g1, &g2, &g3);CHKERRQ(ierr);
+    if (g0 || g1 || g2 || g3) SETERRQ(PetscObjectComm((PetscObject) dm), PETSC_ERR_SUP, "Matrix-free Jacobian does not support boundary Jacobian terms");
+  }
+  fe   = (PetscFE) obj;
+  ierr = PetscOptionsGetBool(((PetscObject) dm)->options, ((PetscObject) dm)->prefix, "-dm_plex_jacobian_mf_sum_factorization", &useSumFact, NULL);CHKERRQ(ierr);
+
+  ierr = PetscNew(&mf);CHKERRQ(ierr);
+  mf->dm = plex;
+  ierr = DMGetDimension(plex, &mf->dim);CHKERRQ(ierr);
+  ierr = PetscDSGetTotalDimension(ds, &mf->Nb);CHKERRQ(ierr);
+  ierr = PetscDSGetTotalComponents(ds, &mf->Nc);CHKERRQ(ierr);
+  ierr = PetscFEGetQuadrature(fe, &quad);CHKERRQ(ierr);
+  ierr = PetscQuadratureGetData(quad, NULL, NULL, &mf->Nq, NULL, NULL);CHKERRQ(ierr);
+  ierr = PetscDSGetTabulation(ds, &B, &D);CHKERRQ(ierr);
+  ierr = DMPlexGetDepth(plex, &depth);CHKERRQ(ierr);
+  ierr = DMGetStratumIS(plex, "dim", depth, &mf->cellIS);CHKERRQ(ierr);
+  if (!mf->cellIS) {ierr = DMGetStratumIS(plex, "depth", depth, &mf->cellIS);CHKERRQ(ierr);}
+  ierr = ISGetLocalSize(mf->cellIS, &mf->numCells);CHKERRQ(ierr);
+  /* Check that the geometry is supported before anything is computed */
+  {
+    DMField coordField;
+
+    ierr = DMGetCoordinateField(plex, &coordField);CHKERRQ(ierr);
+    ierr = DMSNESGetFEGeom(coordField, mf->cellIS, quad, PETSC_FALSE, &geom);CHKERRQ(ierr);
+    if (geom->dimEmbed != mf->dim) SETERRQ2(PetscObjectComm((PetscObject) dm), PETSC_ERR_SUP, "Matrix-free Jacobian does not support embedding dimension %D for a dimension %D mesh", geom->dimEmbed, mf->dim);
+    ierr = DMSNESRestoreFEGeom(coordField, mf->cellIS, quad, PETSC_FALSE, &geom);CHKERRQ(ierr);
+  }
+  /* The local offsets of the closure of each cell are the closure of a local vector holding its own offsets */
+  ierr = PetscMalloc1(mf->numCells*mf->Nb, &mf->cidx);CHKERRQ(ierr);
+  ierr = DMGetLocalVector(plex, &locIdx);CHKERRQ(ierr);
+  ierr = VecGetLocalSize(locIdx, &n);CHKERRQ(ierr);
+  ierr = VecGetArray(locIdx, &idx);CHKERRQ(ierr);
+  for (b = 0; b < n; ++b) idx[b] = b;
+  ierr = VecRestoreArray(locIdx, &idx);CHKERRQ(ierr);
+  ierr = ISGetPointRange(mf->cellIS, &cStart, &cEnd, &cells);CHKERRQ(ierr);
+  for (c = cStart; c < cEnd; ++c) {
+    const PetscInt cell = cells ? cells[c] : c;
+    PetscScalar   *cidx = NULL;
+    PetscInt       csize;
+
+    ierr = DMPlexVecGetClosure(plex, NULL, locIdx, cell, &csize, &cidx);CHKERRQ(ierr);
+    if (csize != mf->Nb) SETERRQ3(PETSC_COMM_SELF, PETSC_ERR_ARG_SIZ, "Closure size %D of cell %D does not match the element dimension %D", csize, cell, mf->Nb);
+    for (b = 0; b < mf->Nb; ++b) mf->cidx[(c-cStart)*mf->Nb+b] = (PetscInt) PetscRealPart(cidx[b]);
+    ierr = DMPlexVecRestoreClosure(plex, NULL, locIdx, cell, &csize, &cidx);CHKERRQ(ierr);
+  }
+  ierr = ISRestorePointRange(mf->cellIS, &cStart, &cEnd, &cells);CHKERRQ(ierr);
+  ierr = DMRestoreLocalVector(plex, &locIdx);CHKERRQ(ierr);
+  /* Tensor product structure */
+  isTensor = PETSC_FALSE;
+  if (useSumFact) {ierr = DMPlexJacobianMFSetUpTensor_Private(mf, fe, B[0], D[0], &isTensor);CHKERRQ(ierr);}
+  mf->sumfact = isTensor;
+  if (mf->sumfact) {
+    ierr = PetscInfo4(dm, "Sum factorized Jacobian with %D 1D nodes and %D 1D quadrature points in dimension %D, %D components\n", mf->nb, mf->nq, mf->dim, mf->Nc);CHKERRQ(ierr);
+  } else {
+    ierr = PetscInfo2(dm, "Matrix-free Jacobian with %D basis functions and %D quadrature points per cell\n", mf->Nb, mf->Nq);CHKERRQ(ierr);
+  }
+  nw   = mf->sumfact ? PetscMax(mf->nb, mf->nq) : 1;
+  nw   = mf->dim == 3 ? nw*nw*nw : (mf->dim == 2 ? nw*nw : nw);
+  ierr = PetscMalloc5(mf->Nb, &mf->ue, mf->Nb, &mf->ye, mf->Nc*mf->Nq, &mf->u, mf->Nc*mf->dim*mf->Nq, &mf->u_x, mf->Nc*mf->Nq, &mf->f0);CHKERRQ(ierr);
+  ierr = PetscMalloc4(mf->Nc*mf->dim*mf->Nq, &mf->f1, nw, &mf->t0, nw, &mf->t1, nw, &mf->t2);CHKERRQ(ierr);
+
+  ierr = DMGetGlobalVector(plex, &X);CHKERRQ(ierr);
+  ierr = VecGetLocalSize(X, &m);CHKERRQ(ierr);
+  ierr = VecGetSize(X, &M);CHKERRQ(ierr);
+  ierr = DMRestoreGlobalVector(plex, &X);CHKERRQ(ierr);
+  ierr = MatCreateShell(PetscObjectComm((PetscObject) dm), m, m, M, M, mf, J);CHKERRQ(ierr);
+  ierr = MatShellSetOperation(*J, MATOP_MULT, (void (*)(void)) MatMult_DMPlexJacobianMF);CHKERRQ(ierr);
+  ierr = MatShellSetOperation(*J, MATOP_GET_DIAGONAL, (void (*)(void)) MatGetDiagonal_DMPlexJacobianMF);CHKERRQ(ierr);
+  ierr = MatShellSetOperation(*J, MATOP_DESTROY, (void (*)(void)) MatDestroy_DMPlexJacobianMF);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject) *J, "DMPlexSNESJacobianMFSetState_C", DMPlexSNESJacobianMFSetState_Private);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
@@ -0,0 +1,220 @@
+static const char help[] = "Tests PetscSF communication with contiguous, strided, 3D sub-block and irregular root and leaf locations.\n\n";
+
+/*T
+    Description: Each process references the roots of the next process in a different pattern and checks the
+    results of PetscSFBcast(), PetscSFBcastManyBegin(), PetscSFReduce() and PetscSFFetchAndOp() for units of one and of
+    several PetscInt. It also broadcasts PetscInt and PetscScalar data together over an odd number of edges per rank.
+T*/
+
+#include <petscsf.h>
+#include <petscviewer.h>
+
+#define NROOTS  24 /* the roots are a 4 x 3 x 2 array */
+#define NLEAVES 18 /* the leaves are a 3 x 3 x 2 array */
+#define NEDGES  8
+
+static PetscErrorCode CheckPattern(const char *name,const PetscInt *ilocal,const PetscInt *iroot,MPI_Datatype unit,PetscInt bs)
+{
+  PetscSF        sf;
+  PetscSFNode    iremote[NEDGES];
+  PetscMPIInt    rank,size,next;
+  PetscInt       i,k,*rootdata,*leafdata,*leafupdate,*expect,nerr = 0;
+  PetscReal      rootreal[NROOTS],leafreal[NLEAVES];
+  MPI_Datatype   units[2];
+  const void     *manyroot[2];
+  void           *manyleaf[2];
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MPI_Comm_rank(PETSC_COMM_WORLD,&rank);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(PETSC_COMM_WORLD,&size);CHKERRQ(ierr);
+  next = (rank+1)%size;
+  for (i=0; i<NEDGES; i++) {
+    iremote[i].rank  = next;
+    iremote[i].index = iroot[i];
+  }
+  ierr = PetscSFCreate(PETSC_COMM_WORLD,&sf);CHKERRQ(ierr);
+  ierr = PetscSFSetFromOptions(sf);CHKERRQ(ierr);
+  ierr = PetscSFSetGraph(sf,NROOTS,NEDGES,ilocal,PETSC_COPY_VALUES,iremote,PETSC_COPY_VALUES);CHKERRQ(ierr);
+  ierr = PetscSFSetUp(sf);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"%s, block size %D\n",name,bs);CHKERRQ(ierr);
+  ierr = PetscViewerPushFormat(PETSC_VIEWER_STDOUT_WORLD,PETSC_VIEWER_ASCII_INFO);CHKERRQ(ierr);
+  ierr = PetscSFView(sf,PETSC_VIEWER_STDOUT_WORLD);CHKERRQ(ierr);
+  ierr = PetscViewerPopFormat(PETSC_VIEWER_STDOUT_WORLD);CHKERRQ(ierr);
+
+  ierr = PetscMalloc4(NROOTS*bs,&rootdata,NLEAVES*bs,&leafdata,NLEAVES*bs,&leafupdate,NROOTS*bs,&expect);CHKERRQ(ierr);
+
+  /* bcast: leaf i gets the value of its root, the other leaves are untouched */
+  for (i=0; i<NROOTS*bs; i++) rootdata[i] = 1000*rank + i;
+  for (i=0; i<NLEAVES*bs; i++) leafdata[i] = -1;
+  ierr = PetscSFBcastBegin(sf,unit,rootdata,leafdata);CHKERRQ(ierr);
+  ierr = PetscSFBcastEnd(sf,unit,rootdata,leafdata);CHKERRQ(ierr);
+  for (i=0; i<NEDGES; i++) {
+    for (k=0; k<bs; k++) {
+      if (leafdata[ilocal[i]*bs+k] != 1000*next + iroot[i]*bs+k) nerr++;
+      leafdata[ilocal[i]*bs+k] = -1;
+    }
+  }
+  for (i=0; i<NLEAVES*bs; i++) if (leafdata[i] != -1) nerr++;
+
+  /* bcast of the same data and of PetscReal data in one operation */
+  for (i=0; i<NROOTS; i++) rootreal[i] = 0.5*rank + i;
+  for (i=0; i<NLEAVES; i++) leafreal[i] = -1.0;
+  units[0]    = unit;     units[1]    = MPIU_REAL;
+  manyroot[0] = rootdata; manyroot[1] = rootreal;
+  manyleaf[0] = leafdata; manyleaf[1] = leafreal;
+  ierr = PetscSFBcastManyBegin(sf,2,units,manyroot,manyleaf);CHKERRQ(ierr);
+  ierr = PetscSFBcastManyEnd(sf,2,units,manyroot,manyleaf);CHKERRQ(ierr);
+  for (i=0; i<NEDGES; i++) {
+    for (k=0; k<bs; k++) {
+      if (leafdata[ilocal[i]*bs+k] != 1000*next + iroot[i]*bs+k) nerr++;
+      leafdata[ilocal[i]*bs+k] = -1;
+    }
+    if (leafreal[ilocal[i]] != 0.5*next + iroot[i]) nerr++;
+    leafreal[ilocal[i]] = -1.0;
+  }
+  for (i=0; i<NLEAVES*bs; i++) if (leafdata[i] != -1) nerr++;
+  for (i=0; i<NLEAVES; i++) if (leafreal[i] != -1.0) nerr++;
+
+  /* reduce with MPIU_REPLACE and MPI_SUM: the roots of the previous process get the values of their leaves */
+  for (i=0; i<NLEAVES*bs; i++) leafdata[i] = 1000*rank + i;
+  for (i=0; i<NROOTS*bs; i++) expect[i] = rootdata[i] = 7;
+  for (i=0; i<NEDGES; i++) for (k=0; k<bs; k++) expect[iroot[i]*bs+k] = 1000*((rank+size-1)%size) + ilocal[i]*bs+k;
+  ierr = PetscSFReduceBegin(sf,unit,leafdata,rootdata,MPIU_REPLACE);CHKERRQ(ierr);
+  ierr = PetscSFReduceEnd(sf,unit,leafdata,rootdata,MPIU_REPLACE);CHKERRQ(ierr);
+  for (i=0; i<NROOTS*bs; i++) if (rootdata[i] != expect[i]) nerr++;
+  for (i=0; i<NEDGES; i++) for (k=0; k<bs; k++) expect[iroot[i]*bs+k] *= 2;
+  ierr = PetscSFReduceBegin(sf,unit,leafdata,rootdata,MPI_SUM);CHKERRQ(ierr);
+  ierr = PetscSFReduceEnd(sf,unit,leafdata,rootdata,MPI_SUM);CHKERRQ(ierr);
+  for (i=0; i<NROOTS*bs; i++) if (rootdata[i] != expect[i]) nerr++;
+
+  /* fetch and add of one unit: the leaf updates are the root values of the next process before the addition */
+  if (bs == 1) {
+    ierr = PetscSFFetchAndOpBegin(sf,unit,rootdata,leafdata,leafupdate,MPI_SUM);CHKERRQ(ierr);
+    ierr = PetscSFFetchAndOpEnd(sf,unit,rootdata,leafdata,leafupdate,MPI_SUM);CHKERRQ(ierr);
+    for (i=0; i<NEDGES; i++) {
+      if (leafupdate[ilocal[i]] != 2*leafdata[ilocal[i]]) nerr++;
+      if (rootdata[iroot[i]] != 3*(expect[iroot[i]]/2)) nerr++;
+    }
+  }
+
+  if (nerr) {ierr = PetscPrintf(PETSC_COMM_SELF,"[%d] %s, block size %D: %D wrong values\n",rank,name,bs,nerr);CHKERRQ(ierr);}
+  ierr = PetscFree4(rootdata,leafdata,leafupdate,expect);CHKERRQ(ierr);
+  ierr = PetscSFDestroy(&sf);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* PetscSFBcastMany() of PetscInt, PetscScalar and PetscInt data, each process referencing NODD roots of the next one.
+   The odd number of values per message puts the part following a PetscInt part at an offset that is not a multiple of
+   sizeof(PetscScalar) unless the composite pack aligns it. */
+#define NODD 5
+static PetscErrorCode CheckComposite(void)
+{
+  PetscSF        sf;
+  PetscSFNode    iremote[NODD];
+  PetscMPIInt    rank,size,next;
+  PetscInt       i,rootint[2*NODD],leafint[NODD],rootint2[2*NODD],leafint2[NODD],nerr = 0;
+  PetscScalar    rootscalar[2*NODD],leafscalar[NODD];
+  MPI_Datatype   units[3];
+  const void     *manyroot[3];
+  void           *manyleaf[3];
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MPI_Comm_rank(PETSC_COMM_WORLD,&rank);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(PETSC_COMM_WORLD,&size);CHKERRQ(ierr);
+  next = (rank+1)%size;
+  for (i=0; i<NODD; i++) {
+    iremote[i].rank  = next;
+    iremote[i].index = 2*i+1;
+  }
+  ierr = PetscSFCreate(PETSC_COMM_WORLD,&sf);CHKERRQ(ierr);
+  ierr = PetscSFSetFromOptions(sf);CHKERRQ(ierr);
+  ierr = PetscSFSetGraph(sf,2*NODD,NODD,NULL,PETSC_COPY_VALUES,iremote,PETSC_COPY_VALUES);CHKERRQ(ierr);
+  ierr = PetscSFSetUp(sf);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"PetscInt, PetscScalar and PetscInt units over %d edges per rank\n",NODD);CHKERRQ(ierr);
+
+  for (i=0; i<2*NODD; i++) {
+    rootint[i]    = 1000*rank + i;
+    rootscalar[i] = 0.5*rank + i;
+    rootint2[i]   = -1000*rank - i;
+  }
+  for (i=0; i<NODD; i++) {
+    leafint[i]    = -1;
+    leafscalar[i] = -1.0;
+    leafint2[i]   = -1;
+  }
+  units[0]    = MPIU_INT;    units[1]    = MPIU_SCALAR; units[2]    = MPIU_INT;
+  manyroot[0] = rootint;     manyroot[1] = rootscalar;  manyroot[2] = rootint2;
+  manyleaf[0] = leafint;     manyleaf[1] = leafscalar;  manyleaf[2] = leafint2;
+  ierr = PetscSFBcastManyBegin(sf,3,units,manyroot,manyleaf);CHKERRQ(ierr);
+  ierr = PetscSFBcastManyEnd(sf,3,units,manyroot,manyleaf);CHKERRQ(ierr);
+  for (i=0; i<NODD; i++) {
+    if (leafint[i] != 1000*next + 2*i+1) nerr++;
+    if (leafscalar[i] != (PetscScalar)(0.5*next + 2*i+1)) nerr++;
+    if (leafint2[i] != -1000*next - 2*i-1) nerr++;
+  }
+
+  if (nerr) {ierr = PetscPrintf(PETSC_COMM_SELF,"[%d] PetscInt, PetscScalar and PetscInt units: %D wrong values\n",rank,nerr);CHKERRQ(ierr);}
+  ierr = PetscSFDestroy(&sf);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+int main(int argc,char **argv)
+{
+  const PetscInt contig_leaf[NEDGES]    = {4,5,6,7,8,9,10,11};
+  const PetscInt contig_root[NEDGES]    = {3,4,5,6,7,8,9,10};
+  const PetscInt stride_leaf[NEDGES]    = {1,3,5,7,9,11,13,15};
+  const PetscInt stride_root[NEDGES]    = {0,3,6,9,12,15,18,21};
+  /* the leaves (0:2,0:2,0:2) of the 3 x 3 x 2 leaves and the roots (1:3,1:3,0:2) of the 4 x 3 x 2 roots */
+  const PetscInt block_leaf[NEDGES]     = {0,1,3,4,9,10,12,13};
+  const PetscInt block_root[NEDGES]     = {5,6,9,10,17,18,21,22};
+  const PetscInt irregular_leaf[NEDGES] = {7,1,3,0,6,5,2,4};
+  const PetscInt irregular_root[NEDGES] = {5,0,17,2,9,11,23,8};
+  MPI_Datatype   unit3;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&argv,NULL,help);if (ierr) return ierr;
+  ierr = MPI_Type_contiguous(3,MPIU_INT,&unit3);CHKERRQ(ierr);
+  ierr = MPI_Type_commit(&unit3);CHKERRQ(ierr);
+
+  ierr = CheckPattern("contiguous roots and leaves",contig_leaf,contig_root,MPIU_INT,1);CHKERRQ(ierr);
+  ierr = CheckPattern("strided roots and leaves",stride_leaf,stride_root,MPIU_INT,1);CHKERRQ(ierr);
+  ierr = CheckPattern("3D sub-block roots and leaves",block_leaf,block_root,MPIU_INT,1);CHKERRQ(ierr);
+  ierr = CheckPattern("3D sub-block roots and leaves",block_leaf,block_root,unit3,3);CHKERRQ(ierr);
+  ierr = CheckPattern("irregular leaves, contiguous roots",irregular_leaf,contig_root,MPIU_INT,1);CHKERRQ(ierr);
+  ierr = CheckPattern("irregular roots and leaves",irregular_leaf,irregular_root,unit3,3);CHKERRQ(ierr);
+  ierr = CheckComposite();CHKERRQ(ierr);
+
+  ierr = MPI_Type_free(&unit3);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
+
+/*TEST
+
+   test:
+      suffix: 1
+
+   test:
+      suffix: 3
+      nsize: 3
+
+   test:
+      suffix: nopackopt
+      nsize: 3
+      args: -sf_basic_pack_opt 0
+
+   test:
+      suffix: shm
+      nsize: 3
+      args: -sf_type shm
+      requires: define(PETSC_HAVE_MPI_WIN_CREATE_FEATURE)
+
+   test:
+      suffix: neighbor
+      nsize: 3
+      args: -sf_type neighbor
+      requires: define(PETSC_HAVE_MPI_NEIGHBORHOOD_COLLECTIVES)
+
+TEST*/
@@ -0,0 +1,137 @@
+static const char help[] = "Tests and benchmarks PetscSFBcast() and PetscSFReduce() of several PetscSF types on a ring of processes.\n\
+  -sf_types <t1,t2,...> : the PetscSF types to compare\n\
+  -nneighbors <k>       : each process references the roots of the k next processes\n\
+  -sizes <m1,m2,...>    : number of PetscScalar in each message\n\
+  -nits <n>             : number of operations timed by -benchmark\n\
+  -benchmark            : print the latency and bandwidth of each type for each message size\n\n";
+
+#include <petscsf.h>
+#include <petsctime.h>
+
+/* Each process has k*m roots and references the m roots of its rank in each of the k next processes */
+static PetscErrorCode CreateRingSF(MPI_Comm comm,const char *type,PetscInt k,PetscInt m,PetscSF *sf)
+{
+  PetscSFNode    *iremote;
+  PetscMPIInt    rank,size;
+  PetscInt       i,j,kk;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MPI_Comm_rank(comm,&rank);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(comm,&size);CHKERRQ(ierr);
+  kk   = PetscMin(k,size-1);
+  ierr = PetscMalloc1(kk*m,&iremote);CHKERRQ(ierr);
+  for (i=0; i<kk; i++) {
+    for (j=0; j<m; j++) {
+      iremote[i*m+j].rank  = (rank+1+i)%size;
+      iremote[i*m+j].index = i*m+j;
+    }
+  }
+  ierr = PetscSFCreate(comm,sf);CHKERRQ(ierr);
+  ierr = PetscSFSetType(*sf,type);CHKERRQ(ierr);
+  ierr = PetscSFSetGraph(*sf,kk*m,kk*m,NULL,PETSC_OWN_POINTER,iremote,PETSC_OWN_POINTER);CHKERRQ(ierr);
+  ierr = PetscSFSetUp(*sf);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* Check one PetscSFBcast() and one PetscSFReduce() with MPI_SUM, then time nits of each when nits > 0 */
+static PetscErrorCode RunSF(PetscSF sf,PetscInt n,PetscInt nits,PetscInt *nerr,PetscLogDouble *tbcast,PetscLogDouble *treduce)
+{
+  PetscScalar    *rootdata,*leafdata;
+  PetscInt       i,it;
+  PetscLogDouble t0,t1,t2;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscMalloc2(n,&rootdata,n,&leafdata);CHKERRQ(ierr);
+  *nerr = 0;
+  for (i=0; i<n; i++) {rootdata[i] = i; leafdata[i] = -1;}
+  ierr = PetscSFBcastBegin(sf,MPIU_SCALAR,rootdata,leafdata);CHKERRQ(ierr);
+  ierr = PetscSFBcastEnd(sf,MPIU_SCALAR,rootdata,leafdata);CHKERRQ(ierr);
+  for (i=0; i<n; i++) if (leafdata[i] != (PetscScalar)i) (*nerr)++;
+  ierr = PetscSFReduceBegin(sf,MPIU_SCALAR,leafdata,rootdata,MPI_SUM);CHKERRQ(ierr);
+  ierr = PetscSFReduceEnd(sf,MPIU_SCALAR,leafdata,rootdata,MPI_SUM);CHKERRQ(ierr);
+  for (i=0; i<n; i++) if (rootdata[i] != (PetscScalar)(2*i)) (*nerr)++;
+
+  ierr = MPI_Barrier(PetscObjectComm((PetscObject)sf));CHKERRQ(ierr);
+  ierr = PetscTime(&t0);CHKERRQ(ierr);
+  for (it=0; it<nits; it++) {
+    ierr = PetscSFBcastBegin(sf,MPIU_SCALAR,rootdata,leafdata);CHKERRQ(ierr);
+    ierr = PetscSFBcastEnd(sf,MPIU_SCALAR,rootdata,leafdata);CHKERRQ(ierr);
+  }
+  ierr = PetscTime(&t1);CHKERRQ(ierr);
+  for (it=0; it<nits; it++) {
+    ierr = PetscSFReduceBegin(sf,MPIU_SCALAR,leafdata,rootdata,MPIU_REPLACE);CHKERRQ(ierr);
+    ierr = PetscSFReduceEnd(sf,MPIU_SCALAR,leafdata,rootdata,MPIU_REPLACE);CHKERRQ(ierr);
+  }
+  ierr = PetscTime(&t2);CHKERRQ(ierr);
+  *tbcast  = nits ? (t1-t0)/nits : 0.0;
+  *treduce = nits ? (t2-t1)/nits : 0.0;
+  ierr = PetscFree2(rootdata,leafdata);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+int main(int argc,char **argv)
+{
+  MPI_Comm       comm;
+  PetscSF        sf;
+  PetscMPIInt    size;
+  char           *types[16];
+  PetscInt       ntypes = 16,sizes[16] = {1,64,4096},nsizes = 16,k = 2,nits = 100,t,s,nerr,gerr;
+  PetscBool      flg,benchmark = PETSC_FALSE;
+  PetscLogDouble ltime[2],gtime[2];
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&argv,NULL,help);if (ierr) return ierr;
+  comm = PETSC_COMM_WORLD;
+  ierr = MPI_Comm_size(comm,&size);CHKERRQ(ierr);
+  ierr = PetscOptionsGetStringArray(NULL,NULL,"-sf_types",types,&ntypes,&flg);CHKERRQ(ierr);
+  if (!flg) {
+    ntypes = 0;
+    ierr   = PetscStrallocpy(PETSCSFBASIC,&types[ntypes++]);CHKERRQ(ierr);
+#if defined(PETSC_HAVE_MPI_NEIGHBORHOOD_COLLECTIVES)
+    ierr   = PetscStrallocpy(PETSCSFNEIGHBOR,&types[ntypes++]);CHKERRQ(ierr);
+#endif
+  }
+  ierr = PetscOptionsGetIntArray(NULL,NULL,"-sizes",sizes,&nsizes,&flg);CHKERRQ(ierr);
+  if (!flg) nsizes = 3;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-nneighbors",&k,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-nits",&nits,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(NULL,NULL,"-benchmark",&benchmark,NULL);CHKERRQ(ierr);
+  k    = PetscMin(k,size-1);
+
+  for (t=0; t<ntypes; t++) {
+    for (s=0; s<nsizes; s++) {
+      ierr = CreateRingSF(comm,types[t],k,sizes[s],&sf);CHKERRQ(ierr);
+      ierr = RunSF(sf,k*sizes[s],benchmark ? nits : 0,&nerr,&ltime[0],&ltime[1]);CHKERRQ(ierr);
+      ierr = MPIU_Allreduce(&nerr,&gerr,1,MPIU_INT,MPI_SUM,comm);CHKERRQ(ierr);
+      ierr = MPIU_Allreduce(ltime,gtime,2,MPI_DOUBLE,MPI_MAX,comm);CHKERRQ(ierr);
+      ierr = PetscPrintf(comm,"%s: %D messages of %D scalars per process: %D wrong values\n",types[t],k,sizes[s],gerr);CHKERRQ(ierr);
+      if (benchmark) {
+        /* bandwidth of the data sent by each process */
+        ierr = PetscPrintf(comm,"  bcast  %g s, %g MB/s\n",gtime[0],gtime[0] > 0.0 ? 1.e-6*k*sizes[s]*sizeof(PetscScalar)/gtime[0] : 0.0);CHKERRQ(ierr);
+        ierr = PetscPrintf(comm,"  reduce %g s, %g MB/s\n",gtime[1],gtime[1] > 0.0 ? 1.e-6*k*sizes[s]*sizeof(PetscScalar)/gtime[1] : 0.0);CHKERRQ(ierr);
+      }
+      ierr = PetscSFDestroy(&sf);CHKERRQ(ierr);
+    }
+  }
+  for (t=0; t<ntypes; t++) {ierr = PetscFree(types[t]);CHKERRQ(ierr);}
+  ierr = PetscFinalize();
+  return ierr;
+}
+
+/*TEST
+
+   test:
+      nsize: 4
+      args: -nneighbors 3
+      requires: define(PETSC_HAVE_MPI_NEIGHBORHOOD_COLLECTIVES)
+
+   test:
+      suffix: 2
+      nsize: 3
+      args: -sf_types basic,neighbor -sizes 5,1000 -benchmark -nits 2
+      filter: grep -v "s, "
+      requires: define(PETSC_HAVE_MPI_NEIGHBORHOOD_COLLECTIVES)
+
+TEST*/
@@ -568,4 +568,16 @@ int main(int argc,char **argv)
       suffix: 9_char
       nsize: 4
       args: -sf_type basic -test_bcast -test_reduce -test_op max -test_char
+
+   test:
+      suffix: shm
+      nsize: 4
+      args: -sf_type shm -test_bcast -test_reduce -test_fetchandop
+      requires: define(PETSC_HAVE_MPI_WIN_CREATE_FEATURE)
+
+   test:
+      suffix: neighbor
+      nsize: 4
+      args: -sf_type neighbor -test_bcast -test_reduce -test_fetchandop
+      requires: define(PETSC_HAVE_MPI_NEIGHBORHOOD_COLLECTIVES)
 TEST*/
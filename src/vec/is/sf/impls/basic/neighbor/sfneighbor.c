@@ -0,0 +1,288 @@
+#include <../src/vec/is/sf/impls/basic/sfbasic.h> /*I "petscsf.h" I*/
+
+/*
+   PETSCSFNEIGHBOR is PETSCSFBASIC in which the messages of an operation are exchanged with one MPI_Ineighbor_alltoallv()
+   on a distributed graph communicator, instead of one persistent send or receive per rank. The communicators, one for
+   each direction, are created at PetscSFSetUp(), when the ranks are known; the MPI implementation may then use the
+   topology to schedule the messages.
+
+   The packed data of the ranks is contiguous, in rank order, in the root and leaf buffers of the packs, so it is sent
+   and received in place. The distinguished rank, this process, keeps using the root buffer shared with its leaves.
+*/
+
+typedef struct {
+  SFBASICHEADER;
+  MPI_Comm    comms[2];    /* Distributed graph communicators, indexed by PetscSFDirection */
+  PetscMPIInt *rootcounts; /* Number of units, and their offset in the root buffer, of each non-distinguished rank referencing my roots */
+  PetscMPIInt *rootdispls;
+  PetscMPIInt *leafcounts; /* Number of units, and their offset in the leaf buffer, of each non-distinguished rank owning roots of my leaves */
+  PetscMPIInt *leafdispls;
+} PetscSF_Neighbor;
+
+static PetscErrorCode PetscSFSetUp_Neighbor(PetscSF sf)
+{
+  PetscSF_Neighbor  *dat = (PetscSF_Neighbor*)sf->data;
+  PetscErrorCode    ierr;
+  PetscInt          i,nrootranks,ndrootranks,nleafranks,ndleafranks;
+  const PetscInt    *rootoffset,*leafoffset;
+  const PetscMPIInt *rootranks,*leafranks;
+  PetscMPIInt       nroot,nleaf;
+  MPI_Comm          comm;
+
+  PetscFunctionBegin;
+  ierr = PetscSFSetUp_Basic(sf);CHKERRQ(ierr);
+  ierr = PetscObjectGetComm((PetscObject)sf,&comm);CHKERRQ(ierr);
+  ierr = PetscSFBasicGetRootInfo(sf,&nrootranks,&ndrootranks,&rootranks,&rootoffset,NULL);CHKERRQ(ierr);
+  ierr = PetscSFBasicGetLeafInfo(sf,&nleafranks,&ndleafranks,&leafranks,&leafoffset,NULL);CHKERRQ(ierr);
+  ierr = PetscMPIIntCast(nrootranks-ndrootranks,&nroot);CHKERRQ(ierr);
+  ierr = PetscMPIIntCast(nleafranks-ndleafranks,&nleaf);CHKERRQ(ierr);
+  ierr = PetscMalloc4(nroot,&dat->rootcounts,nroot,&dat->rootdispls,nleaf,&dat->leafcounts,nleaf,&dat->leafdispls);CHKERRQ(ierr);
+  for (i=ndrootranks; i<nrootranks; i++) {
+    ierr = PetscMPIIntCast(rootoffset[i+1]-rootoffset[i],&dat->rootcounts[i-ndrootranks]);CHKERRQ(ierr);
+    ierr = PetscMPIIntCast(rootoffset[i]-rootoffset[ndrootranks],&dat->rootdispls[i-ndrootranks]);CHKERRQ(ierr);
+  }
+  for (i=ndleafranks; i<nleafranks; i++) {
+    ierr = PetscMPIIntCast(leafoffset[i+1]-leafoffset[i],&dat->leafcounts[i-ndleafranks]);CHKERRQ(ierr);
+    ierr = PetscMPIIntCast(leafoffset[i]-leafoffset[ndleafranks],&dat->leafdispls[i-ndleafranks]);CHKERRQ(ierr);
+  }
+  /* Bcast receives from the owners of the roots of my leaves and sends to the ranks referencing my roots, Reduce the reverse */
+  ierr = MPI_Dist_graph_create_adjacent(comm,nleaf,leafranks+ndleafranks,MPI_UNWEIGHTED,nroot,rootranks+ndrootranks,MPI_UNWEIGHTED,MPI_INFO_NULL,0,&dat->comms[PETSC_SF_ROOT2LEAF_BCAST]);CHKERRQ(ierr);
+  ierr = MPI_Dist_graph_create_adjacent(comm,nroot,rootranks+ndrootranks,MPI_UNWEIGHTED,nleaf,leafranks+ndleafranks,MPI_UNWEIGHTED,MPI_INFO_NULL,0,&dat->comms[PETSC_SF_LEAF2ROOT_REDUCE]);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* Start the exchange of the packed data of the non-distinguished ranks of link in the given direction */
+static PetscErrorCode PetscSFNeighborStart(PetscSF sf,PetscSFBasicPack link,MPI_Datatype unit,PetscSFDirection direction)
+{
+  PetscSF_Neighbor *dat = (PetscSF_Neighbor*)sf->data;
+  PetscErrorCode   ierr;
+  char             *rootbuf = link->rootbuf + dat->ioffset[dat->ndiranks]*link->unitbytes; /* skip the distinguished rank */
+
+  PetscFunctionBegin;
+  if (direction == PETSC_SF_ROOT2LEAF_BCAST) {
+    ierr = MPI_Ineighbor_alltoallv(rootbuf,dat->rootcounts,dat->rootdispls,unit,link->leafbuf,dat->leafcounts,dat->leafdispls,unit,dat->comms[direction],&link->requests[direction]);CHKERRQ(ierr);
+  } else {
+    ierr = MPI_Ineighbor_alltoallv(link->leafbuf,dat->leafcounts,dat->leafdispls,unit,rootbuf,dat->rootcounts,dat->rootdispls,unit,dat->comms[direction],&link->requests[direction]);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PetscSFBcastAndOpBegin_Neighbor(PetscSF sf,MPI_Datatype unit,const void *rootdata,void *leafdata,MPI_Op op)
+{
+  PetscSF_Neighbor *dat = (PetscSF_Neighbor*)sf->data;
+  PetscErrorCode   ierr;
+  PetscSFBasicPack link;
+  PetscInt         i,nrootranks;
+  const PetscInt   *rootoffset,*rootloc;
+
+  PetscFunctionBegin;
+  ierr = PetscSFBasicGetRootInfo(sf,&nrootranks,NULL,NULL,&rootoffset,&rootloc);CHKERRQ(ierr);
+  ierr = PetscSFBasicGetPack(sf,unit,rootdata,&link);CHKERRQ(ierr);
+  for (i=0; i<nrootranks; i++) {
+    ierr = PetscSFBasicPackData(link,dat->rootpackopt,i,rootoffset[i+1]-rootoffset[i],rootloc+rootoffset[i],rootdata,link->root[i]);CHKERRQ(ierr);
+  }
+  ierr = PetscSFNeighborStart(sf,link,unit,PETSC_SF_ROOT2LEAF_BCAST);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PetscSFBcastAndOpEnd_Neighbor(PetscSF sf,MPI_Datatype unit,const void *rootdata,void *leafdata,MPI_Op op)
+{
+  PetscSF_Neighbor *dat = (PetscSF_Neighbor*)sf->data;
+  PetscErrorCode   ierr;
+  PetscSFBasicPack link;
+  PetscInt         i,nleafranks;
+  const PetscInt   *leafoffset,*leafloc;
+  void             (*UnpackOp)(PetscInt,PetscInt,const PetscInt*,void*,const void*);
+  PetscMPIInt      typesize = -1;
+
+  PetscFunctionBegin;
+  ierr = PetscSFBasicGetPackInUse(sf,unit,rootdata,PETSC_OWN_POINTER,&link);CHKERRQ(ierr);
+  ierr = MPI_Wait(&link->requests[PETSC_SF_ROOT2LEAF_BCAST],MPI_STATUS_IGNORE);CHKERRQ(ierr);
+  ierr = PetscSFBasicGetLeafInfo(sf,&nleafranks,NULL,NULL,&leafoffset,&leafloc);CHKERRQ(ierr);
+  ierr = PetscSFBasicPackGetUnpackOp(sf,link,op,&UnpackOp);CHKERRQ(ierr);
+  if (UnpackOp) typesize = link->unitbytes;
+  else {ierr = MPI_Type_size(unit,&typesize);CHKERRQ(ierr);}
+  for (i=0; i<nleafranks; i++) {
+    ierr = PetscSFBasicUnpackDataOp(link,dat->leafpackopt,i,UnpackOp,unit,op,typesize,leafoffset[i+1]-leafoffset[i],leafloc+leafoffset[i],leafdata,link->leaf[i]);CHKERRQ(ierr);
+  }
+  ierr = PetscSFBasicReclaimPack(sf,&link);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PetscSFBcastBegin_Neighbor(PetscSF sf,MPI_Datatype unit,const void *rootdata,void *leafdata)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscSFBcastAndOpBegin_Neighbor(sf,unit,rootdata,leafdata,MPIU_REPLACE);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PetscSFBcastEnd_Neighbor(PetscSF sf,MPI_Datatype unit,const void *rootdata,void *leafdata)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscSFBcastAndOpEnd_Neighbor(sf,unit,rootdata,leafdata,MPIU_REPLACE);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PetscSFBcastManyBegin_Neighbor(PetscSF sf,PetscInt nunits,const MPI_Datatype *units,const void **rootdata,void **leafdata)
+{
+  PetscErrorCode   ierr;
+  PetscSFBasicPack link;
+
+  PetscFunctionBegin;
+  ierr = PetscSFBasicGetCompositePack(sf,nunits,units,rootdata[0],&link);CHKERRQ(ierr);
+  ierr = PetscSFBasicPackCompositeRoots(sf,link,rootdata);CHKERRQ(ierr);
+  ierr = PetscSFNeighborStart(sf,link,link->unit,PETSC_SF_ROOT2LEAF_BCAST);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PetscSFBcastManyEnd_Neighbor(PetscSF sf,PetscInt nunits,const MPI_Datatype *units,const void **rootdata,void **leafdata)
+{
+  PetscErrorCode   ierr;
+  PetscSFBasicPack link;
+
+  PetscFunctionBegin;
+  ierr = PetscSFBasicGetCompositePackInUse(sf,nunits,units,rootdata[0],&link);CHKERRQ(ierr);
+  ierr = MPI_Wait(&link->requests[PETSC_SF_ROOT2LEAF_BCAST],MPI_STATUS_IGNORE);CHKERRQ(ierr);
+  ierr = PetscSFBasicUnpackCompositeLeaves(sf,link,leafdata);CHKERRQ(ierr);
+  ierr = PetscSFBasicReclaimPack(sf,&link);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PetscSFReduceBegin_Neighbor(PetscSF sf,MPI_Datatype unit,const void *leafdata,void *rootdata,MPI_Op op)
+{
+  PetscSF_Neighbor *dat = (PetscSF_Neighbor*)sf->data;
+  PetscErrorCode   ierr;
+  PetscSFBasicPack link;
+  PetscInt         i,nleafranks;
+  const PetscInt   *leafoffset,*leafloc;
+
+  PetscFunctionBegin;
+  ierr = PetscSFBasicGetLeafInfo(sf,&nleafranks,NULL,NULL,&leafoffset,&leafloc);CHKERRQ(ierr);
+  ierr = PetscSFBasicGetPack(sf,unit,leafdata,&link);CHKERRQ(ierr);
+  for (i=0; i<nleafranks; i++) {
+    ierr = PetscSFBasicPackData(link,dat->leafpackopt,i,leafoffset[i+1]-leafoffset[i],leafloc+leafoffset[i],leafdata,link->leaf[i]);CHKERRQ(ierr);
+  }
+  ierr = PetscSFNeighborStart(sf,link,unit,PETSC_SF_LEAF2ROOT_REDUCE);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PetscSFReduceEnd_Neighbor(PetscSF sf,MPI_Datatype unit,const void *leafdata,void *rootdata,MPI_Op op)
+{
+  PetscSF_Neighbor *dat = (PetscSF_Neighbor*)sf->data;
+  PetscErrorCode   ierr;
+  PetscSFBasicPack link;
+  PetscInt         i,nrootranks;
+  const PetscInt   *rootoffset,*rootloc;
+  void             (*UnpackOp)(PetscInt,PetscInt,const PetscInt*,void*,const void*);
+  PetscMPIInt      typesize = -1;
+
+  PetscFunctionBegin;
+  ierr = PetscSFBasicGetPackInUse(sf,unit,leafdata,PETSC_OWN_POINTER,&link);CHKERRQ(ierr);
+  ierr = MPI_Wait(&link->requests[PETSC_SF_LEAF2ROOT_REDUCE],MPI_STATUS_IGNORE);CHKERRQ(ierr);
+  ierr = PetscSFBasicGetRootInfo(sf,&nrootranks,NULL,NULL,&rootoffset,&rootloc);CHKERRQ(ierr);
+  ierr = PetscSFBasicPackGetUnpackOp(sf,link,op,&UnpackOp);CHKERRQ(ierr);
+  if (UnpackOp) typesize = link->unitbytes;
+  else {ierr = MPI_Type_size(unit,&typesize);CHKERRQ(ierr);}
+  for (i=0; i<nrootranks; i++) {
+    ierr = PetscSFBasicUnpackDataOp(link,dat->rootpackopt,i,UnpackOp,unit,op,typesize,rootoffset[i+1]-rootoffset[i],rootloc+rootoffset[i],rootdata,link->root[i]);CHKERRQ(ierr);
+  }
+  ierr = PetscSFBasicReclaimPack(sf,&link);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PetscSFFetchAndOpBegin_Neighbor(PetscSF sf,MPI_Datatype unit,void *rootdata,const void *leafdata,void *leafupdate,MPI_Op op)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscSFReduceBegin_Neighbor(sf,unit,leafdata,rootdata,op);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PetscSFFetchAndOpEnd_Neighbor(PetscSF sf,MPI_Datatype unit,void *rootdata,const void *leafdata,void *leafupdate,MPI_Op op)
+{
+  PetscSF_Neighbor *dat = (PetscSF_Neighbor*)sf->data;
+  PetscErrorCode   ierr;
+  PetscSFBasicPack link;
+  PetscInt         i,nrootranks,nleafranks;
+  const PetscInt   *rootoffset,*leafoffset,*rootloc,*leafloc;
+  void             (*FetchAndOp)(PetscInt,PetscInt,const PetscInt*,void*,void*);
+
+  PetscFunctionBegin;
+  ierr = PetscSFBasicGetPackInUse(sf,unit,leafdata,PETSC_OWN_POINTER,&link);CHKERRQ(ierr);
+  ierr = MPI_Wait(&link->requests[PETSC_SF_LEAF2ROOT_REDUCE],MPI_STATUS_IGNORE);CHKERRQ(ierr);
+  ierr = PetscSFBasicGetRootInfo(sf,&nrootranks,NULL,NULL,&rootoffset,&rootloc);CHKERRQ(ierr);
+  ierr = PetscSFBasicGetLeafInfo(sf,&nleafranks,NULL,NULL,&leafoffset,&leafloc);CHKERRQ(ierr);
+
+  /* Fetch and op in place in the root buffers and send the fetched values back to the leaves */
+  ierr = PetscSFBasicPackGetFetchAndOp(sf,link,op,&FetchAndOp);CHKERRQ(ierr);
+  for (i=0; i<nrootranks; i++) (*FetchAndOp)(rootoffset[i+1]-rootoffset[i],link->bs,rootloc+rootoffset[i],rootdata,link->root[i]);
+  ierr = PetscSFNeighborStart(sf,link,unit,PETSC_SF_ROOT2LEAF_BCAST);CHKERRQ(ierr);
+  ierr = MPI_Wait(&link->requests[PETSC_SF_ROOT2LEAF_BCAST],MPI_STATUS_IGNORE);CHKERRQ(ierr);
+  for (i=0; i<nleafranks; i++) {
+    ierr = PetscSFBasicUnpackData(link,dat->leafpackopt,i,link->UnpackInsert,leafoffset[i+1]-leafoffset[i],leafloc+leafoffset[i],leafupdate,link->leaf[i]);CHKERRQ(ierr);
+  }
+  ierr = PetscSFBasicReclaimPack(sf,&link);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PetscSFReset_Neighbor(PetscSF sf)
+{
+  PetscSF_Neighbor *dat = (PetscSF_Neighbor*)sf->data;
+  PetscErrorCode   ierr;
+  PetscInt         i;
+
+  PetscFunctionBegin;
+  for (i=0; i<2; i++) {
+    if (dat->comms[i] != MPI_COMM_NULL) {ierr = MPI_Comm_free(&dat->comms[i]);CHKERRQ(ierr);}
+  }
+  ierr = PetscFree4(dat->rootcounts,dat->rootdispls,dat->leafcounts,dat->leafdispls);CHKERRQ(ierr);
+  ierr = PetscSFReset_Basic(sf);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PetscSFDestroy_Neighbor(PetscSF sf)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscSFReset_Neighbor(sf);CHKERRQ(ierr);
+  ierr = PetscFree(sf->data);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PETSC_EXTERN PetscErrorCode PetscSFCreate_Neighbor(PetscSF sf)
+{
+  PetscSF_Neighbor *dat;
+  PetscErrorCode   ierr;
+
+  PetscFunctionBegin;
+  sf->ops->SetUp           = PetscSFSetUp_Neighbor;
+  sf->ops->SetFromOptions  = PetscSFSetFromOptions_Basic;
+  sf->ops->Reset           = PetscSFReset_Neighbor;
+  sf->ops->Destroy         = PetscSFDestroy_Neighbor;
+  sf->ops->View            = PetscSFView_Basic;
+  sf->ops->BcastBegin      = PetscSFBcastBegin_Neighbor;
+  sf->ops->BcastEnd        = PetscSFBcastEnd_Neighbor;
+  sf->ops->BcastManyBegin  = PetscSFBcastManyBegin_Neighbor;
+  sf->ops->BcastManyEnd    = PetscSFBcastManyEnd_Neighbor;
+  sf->ops->BcastAndOpBegin = PetscSFBcastAndOpBegin_Neighbor;
+  sf->ops->BcastAndOpEnd   = PetscSFBcastAndOpEnd_Neighbor;
+  sf->ops->ReduceBegin     = PetscSFReduceBegin_Neighbor;
+  sf->ops->ReduceEnd       = PetscSFReduceEnd_Neighbor;
+  sf->ops->FetchAndOpBegin = PetscSFFetchAndOpBegin_Neighbor;
+  sf->ops->FetchAndOpEnd   = PetscSFFetchAndOpEnd_Neighbor;
+  sf->ops->GetLeafRanks    = PetscSFGetLeafRanks_Basic;
+
+  ierr = PetscNewLog(sf,&dat);CHKERRQ(ierr);
+  dat->comms[0]   = MPI_COMM_NULL;
+  dat->comms[1]   = MPI_COMM_NULL;
+  dat->persistent = PETSC_FALSE;
+  dat->usepackopt = PETSC_TRUE;
+  sf->data = (void*)dat;
+  PetscFunctionReturn(0);
+}
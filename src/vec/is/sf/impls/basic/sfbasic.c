@@ -1,58 +1,4 @@
-
-#include <petsc/private/sfimpl.h> /*I "petscsf.h" I*/
-
-typedef struct _n_PetscSFBasicPack *PetscSFBasicPack;
-struct _n_PetscSFBasicPack {
-  void (*Pack)(PetscInt,PetscInt,const PetscInt*,const void*,void*);
-  void (*UnpackInsert)(PetscInt,PetscInt,const PetscInt*,void*,const void*);
-  void (*UnpackAdd)(PetscInt,PetscInt,const PetscInt*,void*,const void*);
-  void (*UnpackMin)(PetscInt,PetscInt,const PetscInt*,void*,const void*);
-  void (*UnpackMax)(PetscInt,PetscInt,const PetscInt*,void*,const void*);
-  void (*UnpackMinloc)(PetscInt,PetscInt,const PetscInt*,void*,const void*);
-  void (*UnpackMaxloc)(PetscInt,PetscInt,const PetscInt*,void*,const void*);
-  void (*UnpackMult)(PetscInt,PetscInt,const PetscInt*,void*,const void *);
-  void (*UnpackLAND)(PetscInt,PetscInt,const PetscInt*,void*,const void *);
-  void (*UnpackBAND)(PetscInt,PetscInt,const PetscInt*,void*,const void *);
-  void (*UnpackLOR)(PetscInt,PetscInt,const PetscInt*,void*,const void *);
-  void (*UnpackBOR)(PetscInt,PetscInt,const PetscInt*,void*,const void *);
-  void (*UnpackLXOR)(PetscInt,PetscInt,const PetscInt*,void*,const void *);
-  void (*UnpackBXOR)(PetscInt,PetscInt,const PetscInt*,void*,const void *);
-  void (*FetchAndInsert)(PetscInt,PetscInt,const PetscInt*,void*,void*);
-  void (*FetchAndAdd)(PetscInt,PetscInt,const PetscInt*,void*,void*);
-  void (*FetchAndMin)(PetscInt,PetscInt,const PetscInt*,void*,void*);
-  void (*FetchAndMax)(PetscInt,PetscInt,const PetscInt*,void*,void*);
-  void (*FetchAndMinloc)(PetscInt,PetscInt,const PetscInt*,void*,void*);
-  void (*FetchAndMaxloc)(PetscInt,PetscInt,const PetscInt*,void*,void*);
-  void (*FetchAndMult)(PetscInt,PetscInt,const PetscInt*,void*,void*);
-  void (*FetchAndLAND)(PetscInt,PetscInt,const PetscInt*,void*,void*);
-  void (*FetchAndBAND)(PetscInt,PetscInt,const PetscInt*,void*,void*);
-  void (*FetchAndLOR)(PetscInt,PetscInt,const PetscInt*,void*,void*);
-  void (*FetchAndBOR)(PetscInt,PetscInt,const PetscInt*,void*,void*);
-  void (*FetchAndLXOR)(PetscInt,PetscInt,const PetscInt*,void*,void*);
-  void (*FetchAndBXOR)(PetscInt,PetscInt,const PetscInt*,void*,void*);
-
-  MPI_Datatype     unit;
-  PetscBool        isbuiltin;   /* Is unit an MPI builtin datatype? */
-  size_t           unitbytes;   /* Number of bytes in a unit */
-  PetscInt         bs;          /* Number of basic units in a unit */
-  const void       *key;        /* Array used as key for operation */
-  char             **root;      /* Packed root data, indexed by leaf rank */
-  char             **leaf;      /* Packed leaf data, indexed by root rank */
-  MPI_Request      *requests;   /* Array of root requests followed by leaf requests */
-  PetscSFBasicPack next;
-};
-
-typedef struct {
-  PetscMPIInt      tag;
-  PetscMPIInt      niranks;     /* Number of incoming ranks (ranks accessing my roots) */
-  PetscMPIInt      ndiranks;    /* Number of incoming ranks (ranks accessing my roots) in distinguished set */
-  PetscMPIInt      *iranks;     /* Array of ranks that reference my roots */
-  PetscInt         itotal;      /* Total number of graph edges referencing my roots */
-  PetscInt         *ioffset;    /* Array of length niranks+1 holding offset in irootloc[] for each rank */
-  PetscInt         *irootloc;   /* Incoming roots referenced by ranks starting at ioffset[rank] */
-  PetscSFBasicPack avail;       /* One or more entries per MPI Datatype, lazily constructed */
-  PetscSFBasicPack inuse;       /* Buffers being used for transactions that have not yet completed */
-} PetscSF_Basic;
+#include <../src/vec/is/sf/impls/basic/sfbasic.h> /*I "petscsf.h" I*/
 
 #if !defined(PETSC_HAVE_MPI_TYPE_DUP)
 PETSC_STATIC_INLINE int MPI_Type_dup(MPI_Datatype datatype,MPI_Datatype *newtype)
@@ -551,7 +497,65 @@ DEF_Block(char,6)
 DEF_Block(char,7)
 #endif
 
-static PetscErrorCode PetscSFSetUp_Basic(PetscSF sf)
+/* Finds whether idx[] is start + x + y*X + z*Y for x < dx, y < dy, z < dz with non overlapping rows and planes */
+static void PetscSFPackOptAnalyze_Private(PetscInt n,const PetscInt *idx,PetscSFPackPattern *pattern,PetscInt *start,PetscInt *dx,PetscInt *dy,PetscInt *dz,PetscInt *X,PetscInt *Y)
+{
+  PetscInt i,j,k,m;
+
+  *pattern = PETSCSF_PACK_IRREGULAR;
+  *start   = n ? idx[0] : 0;
+  *dx      = n; *dy = *dz = 1;
+  *X       = n; *Y  = n;
+  for (m=1; m<n && idx[m] == idx[0]+m; m++) ;
+  if (m >= n) {*pattern = PETSCSF_PACK_CONTIGUOUS; return;}
+  *dx = m;
+  *X  = idx[m] - idx[0];
+  if (*X < m || n%m) return;
+  for (j=1; j<n/m && idx[j*m] == idx[0]+j*(*X); j++) ;
+  if (n%(m*j)) return;
+  *dy = j;
+  *dz = n/(m*j);
+  *Y  = (*dz > 1) ? idx[m*j] - idx[0] : j*(*X);
+  if (*Y < (j-1)*(*X)+m) return;
+  for (k=0; k<*dz; k++) {
+    for (j=0; j<*dy; j++) {
+      for (i=0; i<m; i++) {
+        if (idx[(k*(*dy)+j)*m+i] != idx[0]+i+j*(*X)+k*(*Y)) return;
+      }
+    }
+  }
+  *pattern = (m == 1 && *dz == 1) ? PETSCSF_PACK_STRIDED : PETSCSF_PACK_BLOCK3D;
+}
+
+static PetscErrorCode PetscSFPackOptCreate_Private(PetscInt n,const PetscInt *offset,const PetscInt *idx,PetscSFPackOpt *out)
+{
+  PetscErrorCode ierr;
+  PetscSFPackOpt opt;
+  PetscInt       r;
+
+  PetscFunctionBegin;
+  ierr   = PetscNew(&opt);CHKERRQ(ierr);
+  opt->n = n;
+  ierr   = PetscMalloc7(n,&opt->pattern,n,&opt->start,n,&opt->dx,n,&opt->dy,n,&opt->dz,n,&opt->X,n,&opt->Y);CHKERRQ(ierr);
+  for (r=0; r<n; r++) {
+    PetscSFPackOptAnalyze_Private(offset[r+1]-offset[r],idx+offset[r],&opt->pattern[r],&opt->start[r],&opt->dx[r],&opt->dy[r],&opt->dz[r],&opt->X[r],&opt->Y[r]);
+  }
+  *out = opt;
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PetscSFPackOptDestroy_Private(PetscSFPackOpt *opt)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (!*opt) PetscFunctionReturn(0);
+  ierr = PetscFree7((*opt)->pattern,(*opt)->start,(*opt)->dx,(*opt)->dy,(*opt)->dz,(*opt)->X,(*opt)->Y);CHKERRQ(ierr);
+  ierr = PetscFree(*opt);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PETSC_INTERN PetscErrorCode PetscSFSetUp_Basic(PetscSF sf)
 {
   PetscSF_Basic *bas = (PetscSF_Basic*)sf->data;
   PetscErrorCode ierr;
@@ -628,6 +632,11 @@ static PetscErrorCode PetscSFSetUp_Basic(PetscSF sf)
   }
   ierr = MPI_Waitall(nreqs,reqs,MPI_STATUSES_IGNORE);CHKERRQ(ierr);
   ierr = PetscFree(reqs);CHKERRQ(ierr);
+
+  if (bas->usepackopt) {
+    ierr = PetscSFPackOptCreate_Private(bas->niranks,bas->ioffset,bas->irootloc,&bas->rootpackopt);CHKERRQ(ierr);
+    ierr = PetscSFPackOptCreate_Private(sf->nranks,sf->roffset,sf->rmine,&bas->leafpackopt);CHKERRQ(ierr);
+  }
   PetscFunctionReturn(0);
 }
 
@@ -734,7 +743,7 @@ static PetscErrorCode PetscSFBasicPackTypeSetup(PetscSFBasicPack link,MPI_Dataty
   PetscFunctionReturn(0);
 }
 
-static PetscErrorCode PetscSFBasicPackGetUnpackOp(PetscSF sf,PetscSFBasicPack link,MPI_Op op,void (**UnpackOp)(PetscInt,PetscInt,const PetscInt*,void*,const void*))
+PETSC_INTERN PetscErrorCode PetscSFBasicPackGetUnpackOp(PetscSF sf,PetscSFBasicPack link,MPI_Op op,void (**UnpackOp)(PetscInt,PetscInt,const PetscInt*,void*,const void*))
 {
   PetscFunctionBegin;
   *UnpackOp = NULL;
@@ -754,7 +763,7 @@ static PetscErrorCode PetscSFBasicPackGetUnpackOp(PetscSF sf,PetscSFBasicPack li
   else *UnpackOp = NULL;
   PetscFunctionReturn(0);
 }
-static PetscErrorCode PetscSFBasicPackGetFetchAndOp(PetscSF sf,PetscSFBasicPack link,MPI_Op op,void (**FetchAndOp)(PetscInt,PetscInt,const PetscInt*,void*,void*))
+PETSC_INTERN PetscErrorCode PetscSFBasicPackGetFetchAndOp(PetscSF sf,PetscSFBasicPack link,MPI_Op op,void (**FetchAndOp)(PetscInt,PetscInt,const PetscInt*,void*,void*))
 {
   PetscFunctionBegin;
   *FetchAndOp = NULL;
@@ -775,9 +784,7 @@ static PetscErrorCode PetscSFBasicPackGetFetchAndOp(PetscSF sf,PetscSFBasicPack
   PetscFunctionReturn(0);
 }
 
-typedef enum {PETSC_SF_LEAF2ROOT_REDUCE, PETSC_SF_ROOT2LEAF_BCAST} PetscSFDirection;
-
-static PetscErrorCode PetscSFBasicPackGetReqs(PetscSF sf,PetscSFBasicPack link,PetscSFDirection direction,MPI_Request **rootreqs,MPI_Request **leafreqs)
+PETSC_INTERN PetscErrorCode PetscSFBasicPackGetReqs(PetscSF sf,PetscSFBasicPack link,PetscSFDirection direction,MPI_Request **rootreqs,MPI_Request **leafreqs)
 {
   PetscSF_Basic *bas   = (PetscSF_Basic*)sf->data;
   PetscInt       shift = (direction == PETSC_SF_LEAF2ROOT_REDUCE)? 0 : (sf->nranks + bas->niranks); /* reduce reqs are in the front, bcast reqs are at the end */
@@ -788,7 +795,7 @@ static PetscErrorCode PetscSFBasicPackGetReqs(PetscSF sf,PetscSFBasicPack link,P
   PetscFunctionReturn(0);
 }
 
-static PetscErrorCode PetscSFBasicPackWaitall(PetscSF sf,PetscSFBasicPack link,PetscSFDirection direction)
+PETSC_INTERN PetscErrorCode PetscSFBasicPackWaitall(PetscSF sf,PetscSFBasicPack link,PetscSFDirection direction)
 {
   PetscSF_Basic  *bas  = (PetscSF_Basic*)sf->data;
   PetscInt       shift = (direction == PETSC_SF_LEAF2ROOT_REDUCE)? 0 : (sf->nranks + bas->niranks);
@@ -799,7 +806,7 @@ static PetscErrorCode PetscSFBasicPackWaitall(PetscSF sf,PetscSFBasicPack link,P
   PetscFunctionReturn(0);
 }
 
-static PetscErrorCode PetscSFBasicGetRootInfo(PetscSF sf,PetscInt *nrootranks,PetscInt *ndrootranks,const PetscMPIInt **rootranks,const PetscInt **rootoffset,const PetscInt **rootloc)
+PETSC_INTERN PetscErrorCode PetscSFBasicGetRootInfo(PetscSF sf,PetscInt *nrootranks,PetscInt *ndrootranks,const PetscMPIInt **rootranks,const PetscInt **rootoffset,const PetscInt **rootloc)
 {
   PetscSF_Basic *bas = (PetscSF_Basic*)sf->data;
 
@@ -812,7 +819,7 @@ static PetscErrorCode PetscSFBasicGetRootInfo(PetscSF sf,PetscInt *nrootranks,Pe
   PetscFunctionReturn(0);
 }
 
-static PetscErrorCode PetscSFBasicGetLeafInfo(PetscSF sf,PetscInt *nleafranks,PetscInt *ndleafranks,const PetscMPIInt **leafranks,const PetscInt **leafoffset,const PetscInt **leafloc)
+PETSC_INTERN PetscErrorCode PetscSFBasicGetLeafInfo(PetscSF sf,PetscInt *nleafranks,PetscInt *ndleafranks,const PetscMPIInt **leafranks,const PetscInt **leafoffset,const PetscInt **leafloc)
 {
   PetscFunctionBegin;
   if (nleafranks)  *nleafranks  = sf->nranks;
@@ -823,48 +830,38 @@ static PetscErrorCode PetscSFBasicGetLeafInfo(PetscSF sf,PetscInt *nleafranks,Pe
   PetscFunctionReturn(0);
 }
 
-static PetscErrorCode PetscSFBasicGetPack(PetscSF sf,MPI_Datatype unit,const void *key,PetscSFBasicPack *mylink)
+/* Allocate the buffers of a pack whose unit is set and init its persistent communication */
+static PetscErrorCode PetscSFBasicPackSetUpBuffers(PetscSF sf,PetscSFBasicPack link)
 {
   PetscSF_Basic    *bas = (PetscSF_Basic*)sf->data;
   PetscErrorCode   ierr;
-  PetscSFBasicPack link,*p;
   PetscInt         nrootranks,ndrootranks,nleafranks,ndleafranks,i,half;
   const PetscInt   *rootoffset,*leafoffset;
   MPI_Comm         comm;
   PetscMPIInt      n;
-  MPI_Request      *rootreqs,*leafreqs;
+  MPI_Request      *rootreqs = NULL,*leafreqs = NULL;
 
   PetscFunctionBegin;
-  /* Look for types in cache */
-  for (p=&bas->avail; (link=*p); p=&link->next) {
-    PetscBool match;
-    ierr = MPIPetsc_Type_compare(unit,link->unit,&match);CHKERRQ(ierr);
-    if (match) {
-      *p = link->next;          /* Remove from available list */
-      goto found;
-    }
-  }
-
-  /* Create new composite types for each send rank */
   ierr = PetscSFBasicGetRootInfo(sf,&nrootranks,&ndrootranks,NULL,&rootoffset,NULL);CHKERRQ(ierr);
   ierr = PetscSFBasicGetLeafInfo(sf,&nleafranks,&ndleafranks,NULL,&leafoffset,NULL);CHKERRQ(ierr);
-  ierr = PetscNew(&link);CHKERRQ(ierr);
-  ierr = PetscSFBasicPackTypeSetup(link,unit);CHKERRQ(ierr);
   ierr = PetscMalloc2(nrootranks,&link->root,nleafranks,&link->leaf);CHKERRQ(ierr);
+  ierr = PetscMalloc2(rootoffset[nrootranks]*link->unitbytes,&link->rootbuf,(leafoffset[nleafranks]-leafoffset[ndleafranks])*link->unitbytes,&link->leafbuf);CHKERRQ(ierr);
   /* Double the requests. First half are used for reduce (leaf to root) communication, second half for bcast (root to leaf) communication */
-  half     = nrootranks + nleafranks;
+  half     = bas->persistent ? nrootranks + nleafranks : 1;
   ierr     = PetscCalloc1(half*2,&link->requests);CHKERRQ(ierr);
-  rootreqs = link->requests;
-  leafreqs = link->requests + bas->niranks - bas->ndiranks;
+  if (bas->persistent) { /* without persistent requests link->requests only has two entries, one per direction */
+    rootreqs = link->requests;
+    leafreqs = link->requests + bas->niranks - bas->ndiranks;
+  }
   comm     = PetscObjectComm((PetscObject)sf);
 
-  /* Allocate buffer and then init the persistent communcation */
+  /* Carve the buffers of the ranks out of the contiguous ones and then init the persistent communcation */
   for (i=0; i<nrootranks; i++) {
-    ierr = PetscMalloc((rootoffset[i+1]-rootoffset[i])*link->unitbytes,&link->root[i]);CHKERRQ(ierr);
-    if (i >= ndrootranks) {
+    link->root[i] = link->rootbuf + rootoffset[i]*link->unitbytes;
+    if (i >= ndrootranks && bas->persistent) {
       ierr = PetscMPIIntCast(rootoffset[i+1]-rootoffset[i],&n);CHKERRQ(ierr);
-      ierr = MPI_Recv_init(link->root[i],n,unit,bas->iranks[i],bas->tag,comm,&rootreqs[i-ndrootranks]);CHKERRQ(ierr);      /* reduce */
-      ierr = MPI_Send_init(link->root[i],n,unit,bas->iranks[i],bas->tag,comm,&rootreqs[i-ndrootranks+half]);CHKERRQ(ierr); /* bcast  */
+      ierr = MPI_Recv_init(link->root[i],n,link->unit,bas->iranks[i],bas->tag,comm,&rootreqs[i-ndrootranks]);CHKERRQ(ierr);      /* reduce */
+      ierr = MPI_Send_init(link->root[i],n,link->unit,bas->iranks[i],bas->tag,comm,&rootreqs[i-ndrootranks+half]);CHKERRQ(ierr); /* bcast  */
     }
   }
   for (i=0; i<nleafranks; i++) {
@@ -873,11 +870,37 @@ static PetscErrorCode PetscSFBasicGetPack(PetscSF sf,MPI_Datatype unit,const voi
       link->leaf[i] = link->root[0];
       continue;
     }
-    ierr = PetscMalloc((leafoffset[i+1]-leafoffset[i])*link->unitbytes,&link->leaf[i]);CHKERRQ(ierr);
+    link->leaf[i] = link->leafbuf + (leafoffset[i]-leafoffset[ndleafranks])*link->unitbytes;
+    if (!bas->persistent) continue;
     ierr = PetscMPIIntCast(leafoffset[i+1]-leafoffset[i],&n);CHKERRQ(ierr);
-    ierr = MPI_Send_init(link->leaf[i],n,unit,sf->ranks[i],bas->tag,comm,&leafreqs[i-ndleafranks]);CHKERRQ(ierr);      /* reduce */
-    ierr = MPI_Recv_init(link->leaf[i],n,unit,sf->ranks[i],bas->tag,comm,&leafreqs[i-ndleafranks+half]);CHKERRQ(ierr); /* bcast  */
+    ierr = MPI_Send_init(link->leaf[i],n,link->unit,sf->ranks[i],bas->tag,comm,&leafreqs[i-ndleafranks]);CHKERRQ(ierr);      /* reduce */
+    ierr = MPI_Recv_init(link->leaf[i],n,link->unit,sf->ranks[i],bas->tag,comm,&leafreqs[i-ndleafranks+half]);CHKERRQ(ierr); /* bcast  */
   }
+  PetscFunctionReturn(0);
+}
+
+PETSC_INTERN PetscErrorCode PetscSFBasicGetPack(PetscSF sf,MPI_Datatype unit,const void *key,PetscSFBasicPack *mylink)
+{
+  PetscSF_Basic    *bas = (PetscSF_Basic*)sf->data;
+  PetscErrorCode   ierr;
+  PetscSFBasicPack link,*p;
+
+  PetscFunctionBegin;
+  /* Look for types in cache */
+  for (p=&bas->avail; (link=*p); p=&link->next) {
+    PetscBool match;
+    if (link->nparts) continue;
+    ierr = MPIPetsc_Type_compare(unit,link->unit,&match);CHKERRQ(ierr);
+    if (match) {
+      *p = link->next;          /* Remove from available list */
+      goto found;
+    }
+  }
+
+  /* Create new composite types for each send rank */
+  ierr = PetscNew(&link);CHKERRQ(ierr);
+  ierr = PetscSFBasicPackTypeSetup(link,unit);CHKERRQ(ierr);
+  ierr = PetscSFBasicPackSetUpBuffers(sf,link);CHKERRQ(ierr);
 
 found:
   link->key  = key;
@@ -888,7 +911,7 @@ found:
   PetscFunctionReturn(0);
 }
 
-static PetscErrorCode PetscSFBasicGetPackInUse(PetscSF sf,MPI_Datatype unit,const void *key,PetscCopyMode cmode,PetscSFBasicPack *mylink)
+PETSC_INTERN PetscErrorCode PetscSFBasicGetPackInUse(PetscSF sf,MPI_Datatype unit,const void *key,PetscCopyMode cmode,PetscSFBasicPack *mylink)
 {
   PetscSF_Basic    *bas = (PetscSF_Basic*)sf->data;
   PetscErrorCode   ierr;
@@ -898,6 +921,7 @@ static PetscErrorCode PetscSFBasicGetPackInUse(PetscSF sf,MPI_Datatype unit,cons
   /* Look for types in cache */
   for (p=&bas->inuse; (link=*p); p=&link->next) {
     PetscBool match;
+    if (link->nparts) continue;
     ierr = MPIPetsc_Type_compare(unit,link->unit,&match);CHKERRQ(ierr);
     if (match && (key == link->key)) {
       switch (cmode) {
@@ -913,7 +937,133 @@ static PetscErrorCode PetscSFBasicGetPackInUse(PetscSF sf,MPI_Datatype unit,cons
   PetscFunctionReturn(0);
 }
 
-static PetscErrorCode PetscSFBasicReclaimPack(PetscSF sf,PetscSFBasicPack *link)
+/*
+   A composite pack communicates the data of n units in one message per rank. The message of a rank with m roots (or
+   leaves) holds the m packed values of the first unit, followed by the m packed values of the second unit, and so on,
+   so each part is packed and unpacked with the routines (and the patterns of the locations) of its own unit. The unit of
+   the composite pack is a contiguous type of the bytes of one value of each of the n units, each rounded up to
+   PETSCSF_COMPOSITE_ALIGN bytes. The parts of a message start at multiples of PETSCSF_COMPOSITE_ALIGN bytes, so the
+   typed pack and unpack routines never access a PetscInt, PetscReal or PetscScalar through a misaligned pointer.
+*/
+#define PETSCSF_COMPOSITE_ALIGN PetscMax(sizeof(PetscScalar),sizeof(PetscInt))
+#define PetscSFBasicCompositeAlign(bytes) ((((bytes)+PETSCSF_COMPOSITE_ALIGN-1)/PETSCSF_COMPOSITE_ALIGN)*PETSCSF_COMPOSITE_ALIGN)
+
+static PetscErrorCode PetscSFBasicPackMatchComposite(PetscSFBasicPack link,PetscInt n,const MPI_Datatype *units,PetscBool *match)
+{
+  PetscErrorCode ierr;
+  PetscInt       k;
+
+  PetscFunctionBegin;
+  *match = (link->nparts == n) ? PETSC_TRUE : PETSC_FALSE;
+  for (k=0; k<n && *match; k++) {ierr = MPIPetsc_Type_compare(units[k],link->parts[k]->unit,match);CHKERRQ(ierr);}
+  PetscFunctionReturn(0);
+}
+
+PETSC_INTERN PetscErrorCode PetscSFBasicGetCompositePack(PetscSF sf,PetscInt n,const MPI_Datatype *units,const void *key,PetscSFBasicPack *mylink)
+{
+  PetscSF_Basic    *bas = (PetscSF_Basic*)sf->data;
+  PetscErrorCode   ierr;
+  PetscSFBasicPack link,*p;
+  PetscInt         k;
+  PetscMPIInt      bytes;
+
+  PetscFunctionBegin;
+  for (p=&bas->avail; (link=*p); p=&link->next) {
+    PetscBool match;
+    ierr = PetscSFBasicPackMatchComposite(link,n,units,&match);CHKERRQ(ierr);
+    if (match) {
+      *p = link->next;
+      goto found;
+    }
+  }
+
+  ierr = PetscNew(&link);CHKERRQ(ierr);
+  ierr = PetscMalloc1(n,&link->parts);CHKERRQ(ierr);
+  link->nparts = n;
+  for (k=0; k<n; k++) {
+    ierr = PetscNew(&link->parts[k]);CHKERRQ(ierr);
+    ierr = PetscSFBasicPackTypeSetup(link->parts[k],units[k]);CHKERRQ(ierr);
+    link->unitbytes += PetscSFBasicCompositeAlign(link->parts[k]->unitbytes);
+  }
+  ierr = PetscMPIIntCast(link->unitbytes,&bytes);CHKERRQ(ierr);
+  ierr = MPI_Type_contiguous(bytes,MPI_BYTE,&link->unit);CHKERRQ(ierr);
+  ierr = MPI_Type_commit(&link->unit);CHKERRQ(ierr);
+  link->isbuiltin = PETSC_FALSE;
+  link->bs        = 1;
+  ierr = PetscSFBasicPackSetUpBuffers(sf,link);CHKERRQ(ierr);
+
+found:
+  link->key  = key;
+  link->next = bas->inuse;
+  bas->inuse = link;
+
+  *mylink = link;
+  PetscFunctionReturn(0);
+}
+
+PETSC_INTERN PetscErrorCode PetscSFBasicGetCompositePackInUse(PetscSF sf,PetscInt n,const MPI_Datatype *units,const void *key,PetscSFBasicPack *mylink)
+{
+  PetscSF_Basic    *bas = (PetscSF_Basic*)sf->data;
+  PetscErrorCode   ierr;
+  PetscSFBasicPack link,*p;
+
+  PetscFunctionBegin;
+  for (p=&bas->inuse; (link=*p); p=&link->next) {
+    PetscBool match;
+    ierr = PetscSFBasicPackMatchComposite(link,n,units,&match);CHKERRQ(ierr);
+    if (match && (key == link->key)) {
+      *p      = link->next;
+      *mylink = link;
+      PetscFunctionReturn(0);
+    }
+  }
+  SETERRQ(PetscObjectComm((PetscObject)sf),PETSC_ERR_ARG_WRONGSTATE,"Could not find pack");
+  PetscFunctionReturn(0);
+}
+
+/* Pack rootdata[k], for each unit k of the composite pack link, into the root buffers of all the ranks */
+PETSC_INTERN PetscErrorCode PetscSFBasicPackCompositeRoots(PetscSF sf,PetscSFBasicPack link,const void **rootdata)
+{
+  PetscSF_Basic  *bas = (PetscSF_Basic*)sf->data;
+  PetscErrorCode ierr;
+  PetscInt       i,k,nrootranks,n;
+  const PetscInt *rootoffset,*rootloc;
+  char           *packstart;
+
+  PetscFunctionBegin;
+  ierr = PetscSFBasicGetRootInfo(sf,&nrootranks,NULL,NULL,&rootoffset,&rootloc);CHKERRQ(ierr);
+  for (i=0; i<nrootranks; i++) {
+    n         = rootoffset[i+1]-rootoffset[i];
+    packstart = link->root[i];
+    for (k=0; k<link->nparts; packstart+=PetscSFBasicCompositeAlign(n*link->parts[k]->unitbytes), k++) {
+      ierr = PetscSFBasicPackData(link->parts[k],bas->rootpackopt,i,n,rootloc+rootoffset[i],rootdata[k],packstart);CHKERRQ(ierr);
+    }
+  }
+  PetscFunctionReturn(0);
+}
+
+/* Unpack (insert) the leaf buffers of all the ranks into leafdata[k], for each unit k of the composite pack link */
+PETSC_INTERN PetscErrorCode PetscSFBasicUnpackCompositeLeaves(PetscSF sf,PetscSFBasicPack link,void **leafdata)
+{
+  PetscSF_Basic  *bas = (PetscSF_Basic*)sf->data;
+  PetscErrorCode ierr;
+  PetscInt       i,k,nleafranks,n;
+  const PetscInt *leafoffset,*leafloc;
+  const char     *packstart;
+
+  PetscFunctionBegin;
+  ierr = PetscSFBasicGetLeafInfo(sf,&nleafranks,NULL,NULL,&leafoffset,&leafloc);CHKERRQ(ierr);
+  for (i=0; i<nleafranks; i++) {
+    n         = leafoffset[i+1]-leafoffset[i];
+    packstart = link->leaf[i];
+    for (k=0; k<link->nparts; packstart+=PetscSFBasicCompositeAlign(n*link->parts[k]->unitbytes), k++) {
+      ierr = PetscSFBasicUnpackData(link->parts[k],bas->leafpackopt,i,link->parts[k]->UnpackInsert,n,leafloc+leafoffset[i],leafdata[k],packstart);CHKERRQ(ierr);
+    }
+  }
+  PetscFunctionReturn(0);
+}
+
+PETSC_INTERN PetscErrorCode PetscSFBasicReclaimPack(PetscSF sf,PetscSFBasicPack *link)
 {
   PetscSF_Basic *bas = (PetscSF_Basic*)sf->data;
 
@@ -925,17 +1075,19 @@ static PetscErrorCode PetscSFBasicReclaimPack(PetscSF sf,PetscSFBasicPack *link)
   PetscFunctionReturn(0);
 }
 
-static PetscErrorCode PetscSFSetFromOptions_Basic(PetscOptionItems *PetscOptionsObject,PetscSF sf)
+PETSC_INTERN PetscErrorCode PetscSFSetFromOptions_Basic(PetscOptionItems *PetscOptionsObject,PetscSF sf)
 {
+  PetscSF_Basic  *bas = (PetscSF_Basic*)sf->data;
   PetscErrorCode ierr;
 
   PetscFunctionBegin;
   ierr = PetscOptionsHead(PetscOptionsObject,"PetscSF Basic options");CHKERRQ(ierr);
+  ierr = PetscOptionsBool("-sf_basic_pack_opt","Pack contiguous, strided and 3D sub-block root and leaf locations with memcpy()","PetscSFSetUp",bas->usepackopt,&bas->usepackopt,NULL);CHKERRQ(ierr);
   ierr = PetscOptionsTail();CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
-static PetscErrorCode PetscSFReset_Basic(PetscSF sf)
+PETSC_INTERN PetscErrorCode PetscSFReset_Basic(PetscSF sf)
 {
   PetscSF_Basic    *bas = (PetscSF_Basic*)sf->data;
   PetscErrorCode   ierr;
@@ -945,15 +1097,21 @@ static PetscErrorCode PetscSFReset_Basic(PetscSF sf)
   if (bas->inuse) SETERRQ(PetscObjectComm((PetscObject)sf),PETSC_ERR_ARG_WRONGSTATE,"Outstanding operation has not been completed");
   ierr = PetscFree2(bas->iranks,bas->ioffset);CHKERRQ(ierr);
   ierr = PetscFree(bas->irootloc);CHKERRQ(ierr);
+  ierr = PetscSFPackOptDestroy_Private(&bas->rootpackopt);CHKERRQ(ierr);
+  ierr = PetscSFPackOptDestroy_Private(&bas->leafpackopt);CHKERRQ(ierr);
   for (link=bas->avail; link; link=next) {
     PetscInt i;
     next = link->next;
     if (!link->isbuiltin) {ierr = MPI_Type_free(&link->unit);CHKERRQ(ierr);}
-    for (i=0; i<bas->niranks; i++) {ierr = PetscFree(link->root[i]);CHKERRQ(ierr);}
-    for (i=sf->ndranks; i<sf->nranks; i++) {ierr = PetscFree(link->leaf[i]);CHKERRQ(ierr);} /* Free only non-distinguished leaf buffers */
+    for (i=0; i<link->nparts; i++) {
+      if (!link->parts[i]->isbuiltin) {ierr = MPI_Type_free(&link->parts[i]->unit);CHKERRQ(ierr);}
+      ierr = PetscFree(link->parts[i]);CHKERRQ(ierr);
+    }
+    ierr = PetscFree(link->parts);CHKERRQ(ierr);
+    ierr = PetscFree2(link->rootbuf,link->leafbuf);CHKERRQ(ierr);
     ierr = PetscFree2(link->root,link->leaf);CHKERRQ(ierr);
     /* Free persistent requests using MPI_Request_free */
-    for (i=0; i<sf->nranks+bas->niranks-(sf->ndranks+bas->ndiranks); i++) {
+    for (i=0; bas->persistent && i<sf->nranks+bas->niranks-(sf->ndranks+bas->ndiranks); i++) {
       ierr = MPI_Request_free(&link->requests[i]);CHKERRQ(ierr); /* used in reduce */
       ierr = MPI_Request_free(&link->requests[sf->nranks+bas->niranks+i]);CHKERRQ(ierr); /* used in bcast */
     }
@@ -974,22 +1132,36 @@ static PetscErrorCode PetscSFDestroy_Basic(PetscSF sf)
   PetscFunctionReturn(0);
 }
 
-static PetscErrorCode PetscSFView_Basic(PetscSF sf,PetscViewer viewer)
+PETSC_INTERN PetscErrorCode PetscSFView_Basic(PetscSF sf,PetscViewer viewer)
 {
-  /* PetscSF_Basic *bas = (PetscSF_Basic*)sf->data; */
-  PetscErrorCode ierr;
-  PetscBool      iascii;
+  PetscSF_Basic     *bas = (PetscSF_Basic*)sf->data;
+  PetscErrorCode    ierr;
+  PetscBool         iascii;
+  PetscViewerFormat format;
 
   PetscFunctionBegin;
   ierr = PetscObjectTypeCompare((PetscObject)viewer,PETSCVIEWERASCII,&iascii);CHKERRQ(ierr);
   if (iascii) {
     ierr = PetscViewerASCIIPrintf(viewer,"  sort=%s\n",sf->rankorder ? "rank-order" : "unordered");CHKERRQ(ierr);
+    ierr = PetscViewerGetFormat(viewer,&format);CHKERRQ(ierr);
+    if (format == PETSC_VIEWER_ASCII_INFO && sf->setupcalled && bas->usepackopt) {
+      PetscInt lcount[2*PETSCSF_PACK_NPATTERNS],gcount[2*PETSCSF_PACK_NPATTERNS],r;
+
+      /* number of (rank,rank) messages, over all the processes, whose root and leaf locations have each pattern */
+      ierr = PetscMemzero(lcount,sizeof(lcount));CHKERRQ(ierr);
+      for (r=0; r<bas->rootpackopt->n; r++) lcount[bas->rootpackopt->pattern[r]]++;
+      for (r=0; r<bas->leafpackopt->n; r++) lcount[PETSCSF_PACK_NPATTERNS+bas->leafpackopt->pattern[r]]++;
+      ierr = MPIU_Allreduce(lcount,gcount,2*PETSCSF_PACK_NPATTERNS,MPIU_INT,MPI_SUM,PetscObjectComm((PetscObject)sf));CHKERRQ(ierr);
+      ierr = PetscViewerASCIIPrintf(viewer,"  root locations: %D contiguous, %D strided, %D 3D sub-block, %D irregular\n",gcount[PETSCSF_PACK_CONTIGUOUS],gcount[PETSCSF_PACK_STRIDED],gcount[PETSCSF_PACK_BLOCK3D],gcount[PETSCSF_PACK_IRREGULAR]);CHKERRQ(ierr);
+      ierr = PetscViewerASCIIPrintf(viewer,"  leaf locations: %D contiguous, %D strided, %D 3D sub-block, %D irregular\n",gcount[PETSCSF_PACK_NPATTERNS+PETSCSF_PACK_CONTIGUOUS],gcount[PETSCSF_PACK_NPATTERNS+PETSCSF_PACK_STRIDED],gcount[PETSCSF_PACK_NPATTERNS+PETSCSF_PACK_BLOCK3D],gcount[PETSCSF_PACK_NPATTERNS+PETSCSF_PACK_IRREGULAR]);CHKERRQ(ierr);
+    }
   }
   PetscFunctionReturn(0);
 }
 
 static PetscErrorCode PetscSFBcastAndOpBegin_Basic(PetscSF sf,MPI_Datatype unit,const void *rootdata,void *leafdata,MPI_Op op)
 {
+  PetscSF_Basic     *bas = (PetscSF_Basic*)sf->data;
   PetscErrorCode    ierr;
   PetscSFBasicPack  link;
   PetscInt          i,nrootranks,ndrootranks,nleafranks,ndleafranks;
@@ -1012,7 +1184,7 @@ static PetscErrorCode PetscSFBcastAndOpBegin_Basic(PetscSF sf,MPI_Datatype unit,
   for (i=0; i<nrootranks; i++) {
     void *packstart = link->root[i];
     ierr = PetscMPIIntCast(rootoffset[i+1]-rootoffset[i],&n);CHKERRQ(ierr);
-    (*link->Pack)(n,link->bs,rootloc+rootoffset[i],rootdata,packstart);
+    ierr = PetscSFBasicPackData(link,bas->rootpackopt,i,n,rootloc+rootoffset[i],rootdata,packstart);CHKERRQ(ierr);
     if (i < ndrootranks) continue; /* shared memory */
     ierr = MPI_Start_isend(n,unit,&rootreqs[i-ndrootranks]);CHKERRQ(ierr);
   }
@@ -1021,6 +1193,7 @@ static PetscErrorCode PetscSFBcastAndOpBegin_Basic(PetscSF sf,MPI_Datatype unit,
 
 PetscErrorCode PetscSFBcastAndOpEnd_Basic(PetscSF sf,MPI_Datatype unit,const void *rootdata,void *leafdata,MPI_Op op)
 {
+  PetscSF_Basic    *bas = (PetscSF_Basic*)sf->data;
   PetscErrorCode   ierr;
   PetscSFBasicPack link;
   PetscInt         i,nleafranks,ndleafranks;
@@ -1040,7 +1213,7 @@ PetscErrorCode PetscSFBcastAndOpEnd_Basic(PetscSF sf,MPI_Datatype unit,const voi
   for (i=0; i<nleafranks; i++) {
     PetscMPIInt n   = leafoffset[i+1] - leafoffset[i];
     char *packstart = (char *) link->leaf[i];
-    if (UnpackOp) { (*UnpackOp)(n,link->bs,leafloc+leafoffset[i],leafdata,(const void *)packstart); }
+    if (UnpackOp) { ierr = PetscSFBasicUnpackData(link,bas->leafpackopt,i,UnpackOp,n,leafloc+leafoffset[i],leafdata,(const void *)packstart);CHKERRQ(ierr); }
 #if defined(PETSC_HAVE_MPI_REDUCE_LOCAL)
     else if (n) { /* the op should be defined to operate on the whole datatype, so we ignore link->bs */
       PetscInt j;
@@ -1074,9 +1247,49 @@ PetscErrorCode PetscSFBcastEnd_Basic(PetscSF sf,MPI_Datatype unit,const void *ro
   PetscFunctionReturn(0);
 }
 
+/* Send from roots to leaves the data of several units in one message per rank */
+static PetscErrorCode PetscSFBcastManyBegin_Basic(PetscSF sf,PetscInt nunits,const MPI_Datatype *units,const void **rootdata,void **leafdata)
+{
+  PetscErrorCode    ierr;
+  PetscSFBasicPack  link;
+  PetscInt          i,nrootranks,ndrootranks,nleafranks,ndleafranks;
+  const PetscInt    *rootoffset,*leafoffset;
+  MPI_Request       *rootreqs,*leafreqs;
+  PetscMPIInt       n;
+
+  PetscFunctionBegin;
+  ierr = PetscSFBasicGetRootInfo(sf,&nrootranks,&ndrootranks,NULL,&rootoffset,NULL);CHKERRQ(ierr);
+  ierr = PetscSFBasicGetLeafInfo(sf,&nleafranks,&ndleafranks,NULL,&leafoffset,NULL);CHKERRQ(ierr);
+  ierr = PetscSFBasicGetCompositePack(sf,nunits,units,rootdata[0],&link);CHKERRQ(ierr);
+
+  ierr = PetscSFBasicPackGetReqs(sf,link,PETSC_SF_ROOT2LEAF_BCAST,&rootreqs,&leafreqs);CHKERRQ(ierr);
+  ierr = PetscMPIIntCast(leafoffset[nleafranks]-leafoffset[ndleafranks],&n);CHKERRQ(ierr);
+  ierr = MPI_Startall_irecv(n,link->unit,nleafranks-ndleafranks,leafreqs);CHKERRQ(ierr);
+  ierr = PetscSFBasicPackCompositeRoots(sf,link,rootdata);CHKERRQ(ierr);
+  for (i=ndrootranks; i<nrootranks; i++) {
+    ierr = PetscMPIIntCast(rootoffset[i+1]-rootoffset[i],&n);CHKERRQ(ierr);
+    ierr = MPI_Start_isend(n,link->unit,&rootreqs[i-ndrootranks]);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PetscSFBcastManyEnd_Basic(PetscSF sf,PetscInt nunits,const MPI_Datatype *units,const void **rootdata,void **leafdata)
+{
+  PetscErrorCode   ierr;
+  PetscSFBasicPack link;
+
+  PetscFunctionBegin;
+  ierr = PetscSFBasicGetCompositePackInUse(sf,nunits,units,rootdata[0],&link);CHKERRQ(ierr);
+  ierr = PetscSFBasicPackWaitall(sf,link,PETSC_SF_ROOT2LEAF_BCAST);CHKERRQ(ierr);
+  ierr = PetscSFBasicUnpackCompositeLeaves(sf,link,leafdata);CHKERRQ(ierr);
+  ierr = PetscSFBasicReclaimPack(sf,&link);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 /* leaf -> root with reduction */
 PetscErrorCode PetscSFReduceBegin_Basic(PetscSF sf,MPI_Datatype unit,const void *leafdata,void *rootdata,MPI_Op op)
 {
+  PetscSF_Basic     *bas = (PetscSF_Basic*)sf->data;
   PetscSFBasicPack  link;
   PetscErrorCode    ierr;
   PetscInt          i,nrootranks,ndrootranks,nleafranks,ndleafranks;
@@ -1099,7 +1312,7 @@ PetscErrorCode PetscSFReduceBegin_Basic(PetscSF sf,MPI_Datatype unit,const void
   for (i=0; i<nleafranks; i++) {
     void *packstart = link->leaf[i];
     ierr = PetscMPIIntCast(leafoffset[i+1]-leafoffset[i],&n);CHKERRQ(ierr);
-    (*link->Pack)(n,link->bs,leafloc+leafoffset[i],leafdata,packstart);
+    ierr = PetscSFBasicPackData(link,bas->leafpackopt,i,n,leafloc+leafoffset[i],leafdata,packstart);CHKERRQ(ierr);
     if (i < ndleafranks) continue; /* shared memory */
     ierr = MPI_Start_isend(n,unit,&leafreqs[i-ndleafranks]);CHKERRQ(ierr);
   }
@@ -1108,6 +1321,7 @@ PetscErrorCode PetscSFReduceBegin_Basic(PetscSF sf,MPI_Datatype unit,const void
 
 static PetscErrorCode PetscSFReduceEnd_Basic(PetscSF sf,MPI_Datatype unit,const void *leafdata,void *rootdata,MPI_Op op)
 {
+  PetscSF_Basic    *bas = (PetscSF_Basic*)sf->data;
   void             (*UnpackOp)(PetscInt,PetscInt,const PetscInt*,void*,const void*);
   PetscErrorCode   ierr;
   PetscSFBasicPack link;
@@ -1132,7 +1346,7 @@ static PetscErrorCode PetscSFReduceEnd_Basic(PetscSF sf,MPI_Datatype unit,const
     char *packstart = (char *) link->root[i];
 
     if (UnpackOp) {
-      (*UnpackOp)(n,link->bs,rootloc+rootoffset[i],rootdata,(const void *)packstart);
+      ierr = PetscSFBasicUnpackData(link,bas->rootpackopt,i,UnpackOp,n,rootloc+rootoffset[i],rootdata,(const void *)packstart);CHKERRQ(ierr);
     }
 #if defined(PETSC_HAVE_MPI_REDUCE_LOCAL)
     else if (n) { /* the op should be defined to operate on the whole datatype, so we ignore link->bs */
@@ -1161,6 +1375,7 @@ static PetscErrorCode PetscSFFetchAndOpBegin_Basic(PetscSF sf,MPI_Datatype unit,
 
 static PetscErrorCode PetscSFFetchAndOpEnd_Basic(PetscSF sf,MPI_Datatype unit,void *rootdata,const void *leafdata,void *leafupdate,MPI_Op op)
 {
+  PetscSF_Basic     *bas = (PetscSF_Basic*)sf->data;
   void              (*FetchAndOp)(PetscInt,PetscInt,const PetscInt*,void*,void*);
   PetscErrorCode    ierr;
   PetscSFBasicPack  link;
@@ -1194,13 +1409,13 @@ static PetscErrorCode PetscSFFetchAndOpEnd_Basic(PetscSF sf,MPI_Datatype unit,vo
   for (i=0; i<nleafranks; i++) {
     const void  *packstart = link->leaf[i];
     ierr = PetscMPIIntCast(leafoffset[i+1]-leafoffset[i],&n);CHKERRQ(ierr);
-    (*link->UnpackInsert)(n,link->bs,leafloc+leafoffset[i],leafupdate,packstart);
+    ierr = PetscSFBasicUnpackData(link,bas->leafpackopt,i,link->UnpackInsert,n,leafloc+leafoffset[i],leafupdate,packstart);CHKERRQ(ierr);
   }
   ierr = PetscSFBasicReclaimPack(sf,&link);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
-static PetscErrorCode PetscSFGetLeafRanks_Basic(PetscSF sf,PetscInt *niranks,const PetscMPIInt **iranks,const PetscInt **ioffset,const PetscInt **irootloc)
+PETSC_INTERN PetscErrorCode PetscSFGetLeafRanks_Basic(PetscSF sf,PetscInt *niranks,const PetscMPIInt **iranks,const PetscInt **ioffset,const PetscInt **irootloc)
 {
   PetscSF_Basic *bas = (PetscSF_Basic*)sf->data;
 
@@ -1225,6 +1440,8 @@ PETSC_EXTERN PetscErrorCode PetscSFCreate_Basic(PetscSF sf)
   sf->ops->View            = PetscSFView_Basic;
   sf->ops->BcastBegin      = PetscSFBcastBegin_Basic;
   sf->ops->BcastEnd        = PetscSFBcastEnd_Basic;
+  sf->ops->BcastManyBegin  = PetscSFBcastManyBegin_Basic;
+  sf->ops->BcastManyEnd    = PetscSFBcastManyEnd_Basic;
   sf->ops->BcastAndOpBegin = PetscSFBcastAndOpBegin_Basic;
   sf->ops->BcastAndOpEnd   = PetscSFBcastAndOpEnd_Basic;
   sf->ops->ReduceBegin     = PetscSFReduceBegin_Basic;
@@ -1234,6 +1451,8 @@ PETSC_EXTERN PetscErrorCode PetscSFCreate_Basic(PetscSF sf)
   sf->ops->GetLeafRanks    = PetscSFGetLeafRanks_Basic;
 
   ierr = PetscNewLog(sf,&bas);CHKERRQ(ierr);
+  bas->persistent = PETSC_TRUE;
+  bas->usepackopt = PETSC_TRUE;
   sf->data = (void*)bas;
   PetscFunctionReturn(0);
 }
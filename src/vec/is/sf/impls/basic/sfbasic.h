@@ -0,0 +1,166 @@
+#if !defined(__SFBASIC_H)
+#define __SFBASIC_H
+
+#include <petsc/private/sfimpl.h>
+
+typedef struct _n_PetscSFBasicPack *PetscSFBasicPack;
+struct _n_PetscSFBasicPack {
+  void (*Pack)(PetscInt,PetscInt,const PetscInt*,const void*,void*);
+  void (*UnpackInsert)(PetscInt,PetscInt,const PetscInt*,void*,const void*);
+  void (*UnpackAdd)(PetscInt,PetscInt,const PetscInt*,void*,const void*);
+  void (*UnpackMin)(PetscInt,PetscInt,const PetscInt*,void*,const void*);
+  void (*UnpackMax)(PetscInt,PetscInt,const PetscInt*,void*,const void*);
+  void (*UnpackMinloc)(PetscInt,PetscInt,const PetscInt*,void*,const void*);
+  void (*UnpackMaxloc)(PetscInt,PetscInt,const PetscInt*,void*,const void*);
+  void (*UnpackMult)(PetscInt,PetscInt,const PetscInt*,void*,const void *);
+  void (*UnpackLAND)(PetscInt,PetscInt,const PetscInt*,void*,const void *);
+  void (*UnpackBAND)(PetscInt,PetscInt,const PetscInt*,void*,const void *);
+  void (*UnpackLOR)(PetscInt,PetscInt,const PetscInt*,void*,const void *);
+  void (*UnpackBOR)(PetscInt,PetscInt,const PetscInt*,void*,const void *);
+  void (*UnpackLXOR)(PetscInt,PetscInt,const PetscInt*,void*,const void *);
+  void (*UnpackBXOR)(PetscInt,PetscInt,const PetscInt*,void*,const void *);
+  void (*FetchAndInsert)(PetscInt,PetscInt,const PetscInt*,void*,void*);
+  void (*FetchAndAdd)(PetscInt,PetscInt,const PetscInt*,void*,void*);
+  void (*FetchAndMin)(PetscInt,PetscInt,const PetscInt*,void*,void*);
+  void (*FetchAndMax)(PetscInt,PetscInt,const PetscInt*,void*,void*);
+  void (*FetchAndMinloc)(PetscInt,PetscInt,const PetscInt*,void*,void*);
+  void (*FetchAndMaxloc)(PetscInt,PetscInt,const PetscInt*,void*,void*);
+  void (*FetchAndMult)(PetscInt,PetscInt,const PetscInt*,void*,void*);
+  void (*FetchAndLAND)(PetscInt,PetscInt,const PetscInt*,void*,void*);
+  void (*FetchAndBAND)(PetscInt,PetscInt,const PetscInt*,void*,void*);
+  void (*FetchAndLOR)(PetscInt,PetscInt,const PetscInt*,void*,void*);
+  void (*FetchAndBOR)(PetscInt,PetscInt,const PetscInt*,void*,void*);
+  void (*FetchAndLXOR)(PetscInt,PetscInt,const PetscInt*,void*,void*);
+  void (*FetchAndBXOR)(PetscInt,PetscInt,const PetscInt*,void*,void*);
+
+  MPI_Datatype     unit;
+  PetscBool        isbuiltin;   /* Is unit an MPI builtin datatype? */
+  size_t           unitbytes;   /* Number of bytes in a unit */
+  PetscInt         bs;          /* Number of basic units in a unit */
+  const void       *key;        /* Array used as key for operation */
+  char             **root;      /* Packed root data, indexed by leaf rank */
+  char             **leaf;      /* Packed leaf data, indexed by root rank */
+  char             *rootbuf;    /* Contiguous storage of root[] */
+  char             *leafbuf;    /* Contiguous storage of leaf[] of the non-distinguished ranks */
+  MPI_Request      *requests;   /* Array of root requests followed by leaf requests, or one request per direction without persistent requests */
+  PetscInt         nparts;      /* Number of units of a composite pack, 0 for the pack of a single unit */
+  PetscSFBasicPack *parts;      /* Packs, without buffers, providing the pack and unpack routines of the units of a composite pack */
+  PetscSFBasicPack next;
+};
+
+/*
+ * The root (or leaf) locations communicated with one rank are often a contiguous range, a constant stride or a 3D
+ * sub-block of a larger array (DMDA ghost updates, VecScatter of block vectors). Such locations are packed and
+ * unpacked with memcpy() of whole rows instead of one unit at a time through the index array.
+ */
+typedef enum {PETSCSF_PACK_IRREGULAR,PETSCSF_PACK_CONTIGUOUS,PETSCSF_PACK_STRIDED,PETSCSF_PACK_BLOCK3D,PETSCSF_PACK_NPATTERNS} PetscSFPackPattern;
+
+typedef struct _n_PetscSFPackOpt *PetscSFPackOpt;
+struct _n_PetscSFPackOpt {
+  PetscInt           n;           /* Number of ranks */
+  PetscSFPackPattern *pattern;    /* Pattern of the locations of each rank */
+  PetscInt           *start;      /* The locations of rank r are start[r] + x + y*X[r] + z*Y[r] for x < dx[r], y < dy[r], z < dz[r] */
+  PetscInt           *dx,*dy,*dz;
+  PetscInt           *X,*Y;
+};
+
+/* The fields of PetscSF_Basic, placed first in the data of the types derived from PETSCSFBASIC */
+#define SFBASICHEADER \
+  PetscMPIInt      tag;                                                                                         \
+  PetscMPIInt      niranks;     /* Number of incoming ranks (ranks accessing my roots) */                       \
+  PetscMPIInt      ndiranks;    /* Number of incoming ranks (ranks accessing my roots) in distinguished set */  \
+  PetscMPIInt      *iranks;     /* Array of ranks that reference my roots */                                    \
+  PetscInt         itotal;      /* Total number of graph edges referencing my roots */                          \
+  PetscInt         *ioffset;    /* Array of length niranks+1 holding offset in irootloc[] for each rank */      \
+  PetscInt         *irootloc;   /* Incoming roots referenced by ranks starting at ioffset[rank] */              \
+  PetscSFBasicPack avail;       /* One or more entries per MPI Datatype, lazily constructed */                  \
+  PetscSFBasicPack inuse;       /* Buffers being used for transactions that have not yet completed */           \
+  PetscBool        persistent;  /* Create persistent requests for each rank in the packs */                   \
+  PetscBool        usepackopt;  /* Analyze the root and leaf locations and use the optimized pack and unpack */ \
+  PetscSFPackOpt   rootpackopt; /* Patterns of the root locations, indexed like ioffset[] */                    \
+  PetscSFPackOpt   leafpackopt  /* Patterns of the leaf locations, indexed like sf->roffset[], computed from     \
+                                   sf->rmine in PetscSFSetUp(), so change leaves with PetscSFSetGraph() only */
+
+typedef struct {
+  SFBASICHEADER;
+} PetscSF_Basic;
+
+typedef enum {PETSC_SF_LEAF2ROOT_REDUCE, PETSC_SF_ROOT2LEAF_BCAST} PetscSFDirection;
+
+/* Pack the units of rank r, using the pattern of its locations when there is one */
+PETSC_STATIC_INLINE PetscErrorCode PetscSFBasicPackData(PetscSFBasicPack link,PetscSFPackOpt opt,PetscInt r,PetscInt n,const PetscInt *idx,const void *unpacked,void *packed)
+{
+  PetscErrorCode ierr;
+  PetscInt       j,k;
+
+  PetscFunctionBegin;
+  if (opt && opt->pattern[r] != PETSCSF_PACK_IRREGULAR) {
+    const size_t len = opt->dx[r]*link->unitbytes;
+    const char   *u  = (const char*)unpacked + opt->start[r]*link->unitbytes;
+    char         *p  = (char*)packed;
+    for (k=0; k<opt->dz[r]; k++) {
+      for (j=0; j<opt->dy[r]; j++, p+=len) {
+        ierr = PetscMemcpy(p,u+(j*opt->X[r]+k*opt->Y[r])*link->unitbytes,len);CHKERRQ(ierr);
+      }
+    }
+  } else (*link->Pack)(n,link->bs,idx,unpacked,packed);
+  PetscFunctionReturn(0);
+}
+
+/* Unpack the units of rank r; an insertion uses the pattern of the locations when there is one */
+PETSC_STATIC_INLINE PetscErrorCode PetscSFBasicUnpackData(PetscSFBasicPack link,PetscSFPackOpt opt,PetscInt r,void (*UnpackOp)(PetscInt,PetscInt,const PetscInt*,void*,const void*),PetscInt n,const PetscInt *idx,void *unpacked,const void *packed)
+{
+  PetscErrorCode ierr;
+  PetscInt       j,k;
+
+  PetscFunctionBegin;
+  if (UnpackOp == link->UnpackInsert && opt && opt->pattern[r] != PETSCSF_PACK_IRREGULAR) {
+    const size_t len = opt->dx[r]*link->unitbytes;
+    char         *u  = (char*)unpacked + opt->start[r]*link->unitbytes;
+    const char   *p  = (const char*)packed;
+    for (k=0; k<opt->dz[r]; k++) {
+      for (j=0; j<opt->dy[r]; j++, p+=len) {
+        ierr = PetscMemcpy(u+(j*opt->X[r]+k*opt->Y[r])*link->unitbytes,p,len);CHKERRQ(ierr);
+      }
+    }
+  } else (*UnpackOp)(n,link->bs,idx,unpacked,packed);
+  PetscFunctionReturn(0);
+}
+
+/* Unpack the n units of rank r with op, with MPI_Reduce_local() when there is no unpacking routine for it */
+PETSC_STATIC_INLINE PetscErrorCode PetscSFBasicUnpackDataOp(PetscSFBasicPack link,PetscSFPackOpt opt,PetscInt r,void (*UnpackOp)(PetscInt,PetscInt,const PetscInt*,void*,const void*),MPI_Datatype unit,MPI_Op op,PetscMPIInt typesize,PetscInt n,const PetscInt *idx,void *unpacked,const char *packed)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (UnpackOp) {ierr = PetscSFBasicUnpackData(link,opt,r,UnpackOp,n,idx,unpacked,(const void*)packed);CHKERRQ(ierr);}
+#if defined(PETSC_HAVE_MPI_REDUCE_LOCAL)
+  else if (n) { /* the op should be defined to operate on the whole datatype, so we ignore link->bs */
+    PetscInt j;
+    for (j=0; j<n; j++) {ierr = MPI_Reduce_local(packed+j*typesize,((char*)unpacked)+idx[j]*typesize,1,unit,op);CHKERRQ(ierr);}
+  }
+#else
+  else SETERRQ(PETSC_COMM_SELF,PETSC_ERR_SUP,"No unpacking reduction operation for this MPI_Op");
+#endif
+  PetscFunctionReturn(0);
+}
+
+PETSC_INTERN PetscErrorCode PetscSFSetUp_Basic(PetscSF);
+PETSC_INTERN PetscErrorCode PetscSFSetFromOptions_Basic(PetscOptionItems*,PetscSF);
+PETSC_INTERN PetscErrorCode PetscSFReset_Basic(PetscSF);
+PETSC_INTERN PetscErrorCode PetscSFView_Basic(PetscSF,PetscViewer);
+PETSC_INTERN PetscErrorCode PetscSFGetLeafRanks_Basic(PetscSF,PetscInt*,const PetscMPIInt**,const PetscInt**,const PetscInt**);
+PETSC_INTERN PetscErrorCode PetscSFBasicGetRootInfo(PetscSF,PetscInt*,PetscInt*,const PetscMPIInt**,const PetscInt**,const PetscInt**);
+PETSC_INTERN PetscErrorCode PetscSFBasicGetLeafInfo(PetscSF,PetscInt*,PetscInt*,const PetscMPIInt**,const PetscInt**,const PetscInt**);
+PETSC_INTERN PetscErrorCode PetscSFBasicGetPack(PetscSF,MPI_Datatype,const void*,PetscSFBasicPack*);
+PETSC_INTERN PetscErrorCode PetscSFBasicGetPackInUse(PetscSF,MPI_Datatype,const void*,PetscCopyMode,PetscSFBasicPack*);
+PETSC_INTERN PetscErrorCode PetscSFBasicGetCompositePack(PetscSF,PetscInt,const MPI_Datatype*,const void*,PetscSFBasicPack*);
+PETSC_INTERN PetscErrorCode PetscSFBasicGetCompositePackInUse(PetscSF,PetscInt,const MPI_Datatype*,const void*,PetscSFBasicPack*);
+PETSC_INTERN PetscErrorCode PetscSFBasicPackCompositeRoots(PetscSF,PetscSFBasicPack,const void**);
+PETSC_INTERN PetscErrorCode PetscSFBasicUnpackCompositeLeaves(PetscSF,PetscSFBasicPack,void**);
+PETSC_INTERN PetscErrorCode PetscSFBasicReclaimPack(PetscSF,PetscSFBasicPack*);
+PETSC_INTERN PetscErrorCode PetscSFBasicPackGetUnpackOp(PetscSF,PetscSFBasicPack,MPI_Op,void (**)(PetscInt,PetscInt,const PetscInt*,void*,const void*));
+PETSC_INTERN PetscErrorCode PetscSFBasicPackGetFetchAndOp(PetscSF,PetscSFBasicPack,MPI_Op,void (**)(PetscInt,PetscInt,const PetscInt*,void*,void*));
+PETSC_INTERN PetscErrorCode PetscSFBasicPackGetReqs(PetscSF,PetscSFBasicPack,PetscSFDirection,MPI_Request**,MPI_Request**);
+PETSC_INTERN PetscErrorCode PetscSFBasicPackWaitall(PetscSF,PetscSFBasicPack,PetscSFDirection);
+#endif
@@ -0,0 +1,488 @@
+#include <../src/vec/is/sf/impls/basic/sfbasic.h> /*I "petscsf.h" I*/
+
+/*
+   PETSCSFSHM is PETSCSFBASIC in which the ranks that share memory with this process (the ranks of its node) do not
+   exchange messages. Each process packs the data it sends to node-local ranks into its own segment of an
+   MPI_Win_allocate_shared() window and the receivers unpack it directly from there, as the mpi3node VecScatter does.
+   Only the ranks on other nodes use the persistent sends and receives of PETSCSFBASIC.
+
+   The segment of a process holds its root region (root data packed for the node-local ranks whose leaves reference its
+   roots, used by Bcast) followed by its leaf region (leaf data packed for the node-local owners of the roots its leaves
+   reference, used by Reduce). The offsets of the data of each pair of node-local ranks are exchanged at setup.
+
+   Since the windows are allocated, synchronized and freed collectively on the node, all the processes of the node must
+   call the communication routines (which are collective on the PetscSF) in the same order.
+*/
+
+typedef struct _n_PetscSFShmSeg *PetscSFShmSeg;
+struct _n_PetscSFShmSeg {
+  size_t           unitbytes;  /* Size of the unit the segment was allocated for */
+  MPI_Win          win;
+  char             *base;      /* My segment */
+  char             **peer;     /* Segment of each rank of the node, indexed by node rank */
+  PetscSFBasicPack link;       /* Operation using the segment, NULL if it is available */
+  PetscSFShmSeg    next;
+};
+
+typedef struct {
+  SFBASICHEADER;
+  MPI_Comm      shmcomm;       /* Ranks sharing memory with this process */
+  PetscBool     useshm;        /* Does any rank of the node communicate through shared memory? */
+  PetscMPIInt   *rootshm;      /* Node rank of each rank referencing my roots, or MPI_PROC_NULL if it is not on my node */
+  PetscMPIInt   *leafshm;      /* Node rank of each rank owning roots referenced by my leaves, or MPI_PROC_NULL */
+  PetscInt      *rootsegoff;   /* Offset, in units, in my segment of the root data packed for each node-local rank */
+  PetscInt      *leafsegoff;   /* Offset, in units, in my segment of the leaf data packed for each node-local rank */
+  PetscInt      *rootpeeroff;  /* Offset, in units, of the leaf data packed for me in the segment of each node-local rank */
+  PetscInt      *leafpeeroff;  /* Offset, in units, of the root data packed for me in the segment of each node-local rank */
+  PetscInt      nsegunits;     /* Size of my segment, in units */
+  PetscSFShmSeg segs;          /* Windows, at least one per unit size, lazily constructed */
+} PetscSF_Shm;
+
+static PetscErrorCode PetscSFSetUp_Shm(PetscSF sf)
+{
+  PetscSF_Shm       *shm = (PetscSF_Shm*)sf->data;
+  PetscErrorCode    ierr;
+  PetscShmComm      pshmcomm;
+  PetscInt          i,nrootranks,ndrootranks,nleafranks,ndleafranks,nrootunits = 0,nleafunits = 0;
+  const PetscInt    *rootoffset,*leafoffset;
+  const PetscMPIInt *rootranks,*leafranks;
+  PetscMPIInt       roottag,leaftag,nreqs = 0,luseshm = 0,guseshm;
+  MPI_Request       *reqs;
+  MPI_Comm          comm;
+
+  PetscFunctionBegin;
+  ierr = PetscSFSetUp_Basic(sf);CHKERRQ(ierr);
+  ierr = PetscObjectGetComm((PetscObject)sf,&comm);CHKERRQ(ierr);
+  ierr = PetscShmCommGet(comm,&pshmcomm);CHKERRQ(ierr);
+  ierr = PetscShmCommGetMpiShmComm(pshmcomm,&shm->shmcomm);CHKERRQ(ierr);
+  ierr = PetscSFBasicGetRootInfo(sf,&nrootranks,&ndrootranks,&rootranks,&rootoffset,NULL);CHKERRQ(ierr);
+  ierr = PetscSFBasicGetLeafInfo(sf,&nleafranks,&ndleafranks,&leafranks,&leafoffset,NULL);CHKERRQ(ierr);
+  ierr = PetscMalloc6(nrootranks,&shm->rootshm,nrootranks,&shm->rootsegoff,nrootranks,&shm->rootpeeroff,nleafranks,&shm->leafshm,nleafranks,&shm->leafsegoff,nleafranks,&shm->leafpeeroff);CHKERRQ(ierr);
+
+  /* Find the node-local ranks (the distinguished rank, this process, keeps using the basic shared buffers) and lay out my segment */
+  for (i=0; i<nrootranks; i++) {
+    shm->rootshm[i] = MPI_PROC_NULL;
+    if (i >= ndrootranks) {ierr = PetscShmCommGlobalToLocal(pshmcomm,rootranks[i],&shm->rootshm[i]);CHKERRQ(ierr);}
+    if (shm->rootshm[i] != MPI_PROC_NULL) {
+      shm->rootsegoff[i] = nrootunits;
+      nrootunits        += rootoffset[i+1]-rootoffset[i];
+      luseshm++;
+    }
+  }
+  for (i=0; i<nleafranks; i++) {
+    shm->leafshm[i] = MPI_PROC_NULL;
+    if (i >= ndleafranks) {ierr = PetscShmCommGlobalToLocal(pshmcomm,leafranks[i],&shm->leafshm[i]);CHKERRQ(ierr);}
+    if (shm->leafshm[i] != MPI_PROC_NULL) {
+      shm->leafsegoff[i] = nrootunits + nleafunits;
+      nleafunits        += leafoffset[i+1]-leafoffset[i];
+      luseshm++;
+    }
+  }
+  shm->nsegunits = nrootunits + nleafunits;
+
+  /* Tell each node-local rank where its data is in my segment; a pair of ranks may exchange both root and leaf offsets */
+  ierr = PetscObjectGetNewTag((PetscObject)sf,&roottag);CHKERRQ(ierr);
+  ierr = PetscObjectGetNewTag((PetscObject)sf,&leaftag);CHKERRQ(ierr);
+  ierr = PetscMalloc1(2*luseshm,&reqs);CHKERRQ(ierr);
+  for (i=0; i<nrootranks; i++) {
+    if (shm->rootshm[i] == MPI_PROC_NULL) continue;
+    ierr = MPI_Irecv(&shm->rootpeeroff[i],1,MPIU_INT,rootranks[i],leaftag,comm,&reqs[nreqs++]);CHKERRQ(ierr);
+    ierr = MPI_Isend(&shm->rootsegoff[i],1,MPIU_INT,rootranks[i],roottag,comm,&reqs[nreqs++]);CHKERRQ(ierr);
+  }
+  for (i=0; i<nleafranks; i++) {
+    if (shm->leafshm[i] == MPI_PROC_NULL) continue;
+    ierr = MPI_Irecv(&shm->leafpeeroff[i],1,MPIU_INT,leafranks[i],roottag,comm,&reqs[nreqs++]);CHKERRQ(ierr);
+    ierr = MPI_Isend(&shm->leafsegoff[i],1,MPIU_INT,leafranks[i],leaftag,comm,&reqs[nreqs++]);CHKERRQ(ierr);
+  }
+  ierr = MPI_Waitall(nreqs,reqs,MPI_STATUSES_IGNORE);CHKERRQ(ierr);
+  ierr = PetscFree(reqs);CHKERRQ(ierr);
+
+  /* The synchronizations are collective on the node, so they are done by all its ranks or by none */
+  luseshm = luseshm ? 1 : 0;
+  ierr = MPIU_Allreduce(&luseshm,&guseshm,1,MPI_INT,MPI_MAX,shm->shmcomm);CHKERRQ(ierr);
+  shm->useshm = guseshm ? PETSC_TRUE : PETSC_FALSE;
+  PetscFunctionReturn(0);
+}
+
+/* Get an available segment for the units of link, allocating a new window (collectively on the node) if there is none */
+static PetscErrorCode PetscSFShmGetSeg(PetscSF sf,PetscSFBasicPack link,PetscSFShmSeg *myseg)
+{
+  PetscSF_Shm    *shm = (PetscSF_Shm*)sf->data;
+  PetscErrorCode ierr;
+  PetscSFShmSeg  seg;
+  PetscMPIInt    size,i,dispunit;
+  MPI_Aint       bytes;
+  MPI_Info       info;
+
+  PetscFunctionBegin;
+  for (seg=shm->segs; seg; seg=seg->next) {
+    if (!seg->link && seg->unitbytes == link->unitbytes) goto found;
+  }
+  ierr = PetscNew(&seg);CHKERRQ(ierr);
+  seg->unitbytes = link->unitbytes;
+  ierr = MPI_Comm_size(shm->shmcomm,&size);CHKERRQ(ierr);
+  ierr = PetscMalloc1(size,&seg->peer);CHKERRQ(ierr);
+  ierr = MPI_Info_create(&info);CHKERRQ(ierr);
+  ierr = MPI_Info_set(info,"alloc_shared_noncontig","true");CHKERRQ(ierr);
+  ierr = MPIU_Win_allocate_shared((MPI_Aint)(shm->nsegunits*link->unitbytes),16,info,shm->shmcomm,&seg->base,&seg->win);CHKERRQ(ierr);
+  ierr = MPI_Info_free(&info);CHKERRQ(ierr);
+  for (i=0; i<size; i++) {ierr = MPIU_Win_shared_query(seg->win,i,&bytes,&dispunit,&seg->peer[i]);CHKERRQ(ierr);}
+  /* A passive target epoch for the whole life of the window, so that MPI_Win_sync() can order the loads and stores */
+  ierr = MPI_Win_lock_all(MPI_MODE_NOCHECK,seg->win);CHKERRQ(ierr);
+  seg->next = shm->segs;
+  shm->segs = seg;
+
+found:
+  seg->link = link;
+  *myseg    = seg;
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PetscSFShmGetSegInUse(PetscSF sf,PetscSFBasicPack link,PetscSFShmSeg *myseg)
+{
+  PetscSF_Shm   *shm = (PetscSF_Shm*)sf->data;
+  PetscSFShmSeg seg;
+
+  PetscFunctionBegin;
+  for (seg=shm->segs; seg; seg=seg->next) {
+    if (seg->link == link) {
+      *myseg = seg;
+      PetscFunctionReturn(0);
+    }
+  }
+  SETERRQ(PetscObjectComm((PetscObject)sf),PETSC_ERR_ARG_WRONGSTATE,"Could not find shared memory segment");
+  PetscFunctionReturn(0);
+}
+
+/* Wait until the node-local ranks have written their segments and make the writes visible */
+static PetscErrorCode PetscSFShmSync(PetscSF sf,PetscSFShmSeg seg)
+{
+  PetscSF_Shm    *shm = (PetscSF_Shm*)sf->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MPI_Win_sync(seg->win);CHKERRQ(ierr);
+  ierr = MPI_Barrier(shm->shmcomm);CHKERRQ(ierr);
+  ierr = MPI_Win_sync(seg->win);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* Wait until the node-local ranks are done reading my segment and make it available to the next operation */
+static PetscErrorCode PetscSFShmReclaimSeg(PetscSF sf,PetscSFShmSeg *seg)
+{
+  PetscSF_Shm    *shm = (PetscSF_Shm*)sf->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MPI_Barrier(shm->shmcomm);CHKERRQ(ierr);
+  (*seg)->link = NULL;
+  *seg         = NULL;
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PetscSFBcastAndOpBegin_Shm(PetscSF sf,MPI_Datatype unit,const void *rootdata,void *leafdata,MPI_Op op)
+{
+  PetscSF_Shm       *shm = (PetscSF_Shm*)sf->data;
+  PetscErrorCode    ierr;
+  PetscSFBasicPack  link;
+  PetscSFShmSeg     seg = NULL;
+  PetscInt          i,nrootranks,ndrootranks,nleafranks,ndleafranks;
+  const PetscInt    *rootoffset,*leafoffset,*rootloc;
+  MPI_Request       *rootreqs,*leafreqs;
+  PetscMPIInt       n;
+
+  PetscFunctionBegin;
+  ierr = PetscSFBasicGetRootInfo(sf,&nrootranks,&ndrootranks,NULL,&rootoffset,&rootloc);CHKERRQ(ierr);
+  ierr = PetscSFBasicGetLeafInfo(sf,&nleafranks,&ndleafranks,NULL,&leafoffset,NULL);CHKERRQ(ierr);
+  ierr = PetscSFBasicGetPack(sf,unit,rootdata,&link);CHKERRQ(ierr);
+  if (shm->useshm) {ierr = PetscSFShmGetSeg(sf,link,&seg);CHKERRQ(ierr);}
+
+  ierr = PetscSFBasicPackGetReqs(sf,link,PETSC_SF_ROOT2LEAF_BCAST,&rootreqs,&leafreqs);CHKERRQ(ierr);
+  /* Post leaf receives from the ranks on other nodes only */
+  for (i=ndleafranks; i<nleafranks; i++) {
+    if (shm->leafshm[i] != MPI_PROC_NULL) continue;
+    ierr = PetscMPIIntCast(leafoffset[i+1]-leafoffset[i],&n);CHKERRQ(ierr);
+    ierr = MPI_Startall_irecv(n,unit,1,&leafreqs[i-ndleafranks]);CHKERRQ(ierr);
+  }
+
+  /* Pack root data, into my segment for the node-local ranks, and send it to the other ranks */
+  for (i=0; i<nrootranks; i++) {
+    ierr = PetscMPIIntCast(rootoffset[i+1]-rootoffset[i],&n);CHKERRQ(ierr);
+    if (shm->rootshm[i] != MPI_PROC_NULL) {
+      ierr = PetscSFBasicPackData(link,shm->rootpackopt,i,n,rootloc+rootoffset[i],rootdata,seg->base+shm->rootsegoff[i]*link->unitbytes);CHKERRQ(ierr);
+      continue;
+    }
+    ierr = PetscSFBasicPackData(link,shm->rootpackopt,i,n,rootloc+rootoffset[i],rootdata,link->root[i]);CHKERRQ(ierr);
+    if (i < ndrootranks) continue; /* shared memory */
+    ierr = MPI_Start_isend(n,unit,&rootreqs[i-ndrootranks]);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PetscSFBcastAndOpEnd_Shm(PetscSF sf,MPI_Datatype unit,const void *rootdata,void *leafdata,MPI_Op op)
+{
+  PetscSF_Shm      *shm = (PetscSF_Shm*)sf->data;
+  PetscErrorCode   ierr;
+  PetscSFBasicPack link;
+  PetscSFShmSeg    seg = NULL;
+  PetscInt         i,nleafranks;
+  const PetscInt   *leafoffset,*leafloc;
+  void             (*UnpackOp)(PetscInt,PetscInt,const PetscInt*,void*,const void*);
+  PetscMPIInt      typesize = -1;
+
+  PetscFunctionBegin;
+  ierr = PetscSFBasicGetPackInUse(sf,unit,rootdata,PETSC_OWN_POINTER,&link);CHKERRQ(ierr);
+  /* The persistent requests of the node-local ranks were not started, waiting on them returns immediately */
+  ierr = PetscSFBasicPackWaitall(sf,link,PETSC_SF_ROOT2LEAF_BCAST);CHKERRQ(ierr);
+  if (shm->useshm) {
+    ierr = PetscSFShmGetSegInUse(sf,link,&seg);CHKERRQ(ierr);
+    ierr = PetscSFShmSync(sf,seg);CHKERRQ(ierr);
+  }
+  ierr = PetscSFBasicGetLeafInfo(sf,&nleafranks,NULL,NULL,&leafoffset,&leafloc);CHKERRQ(ierr);
+  ierr = PetscSFBasicPackGetUnpackOp(sf,link,op,&UnpackOp);CHKERRQ(ierr);
+  if (UnpackOp) typesize = link->unitbytes;
+  else {ierr = MPI_Type_size(unit,&typesize);CHKERRQ(ierr);}
+
+  for (i=0; i<nleafranks; i++) {
+    const char *packstart = shm->leafshm[i] != MPI_PROC_NULL ? seg->peer[shm->leafshm[i]]+shm->leafpeeroff[i]*link->unitbytes : link->leaf[i];
+    ierr = PetscSFBasicUnpackDataOp(link,shm->leafpackopt,i,UnpackOp,unit,op,typesize,leafoffset[i+1]-leafoffset[i],leafloc+leafoffset[i],leafdata,packstart);CHKERRQ(ierr);
+  }
+  if (seg) {ierr = PetscSFShmReclaimSeg(sf,&seg);CHKERRQ(ierr);}
+  ierr = PetscSFBasicReclaimPack(sf,&link);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PetscSFBcastBegin_Shm(PetscSF sf,MPI_Datatype unit,const void *rootdata,void *leafdata)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscSFBcastAndOpBegin_Shm(sf,unit,rootdata,leafdata,MPIU_REPLACE);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PetscSFBcastEnd_Shm(PetscSF sf,MPI_Datatype unit,const void *rootdata,void *leafdata)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscSFBcastAndOpEnd_Shm(sf,unit,rootdata,leafdata,MPIU_REPLACE);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PetscSFReduceBegin_Shm(PetscSF sf,MPI_Datatype unit,const void *leafdata,void *rootdata,MPI_Op op)
+{
+  PetscSF_Shm       *shm = (PetscSF_Shm*)sf->data;
+  PetscErrorCode    ierr;
+  PetscSFBasicPack  link;
+  PetscSFShmSeg     seg = NULL;
+  PetscInt          i,nrootranks,ndrootranks,nleafranks,ndleafranks;
+  const PetscInt    *rootoffset,*leafoffset,*leafloc;
+  MPI_Request       *rootreqs,*leafreqs;
+  PetscMPIInt       n;
+
+  PetscFunctionBegin;
+  ierr = PetscSFBasicGetRootInfo(sf,&nrootranks,&ndrootranks,NULL,&rootoffset,NULL);CHKERRQ(ierr);
+  ierr = PetscSFBasicGetLeafInfo(sf,&nleafranks,&ndleafranks,NULL,&leafoffset,&leafloc);CHKERRQ(ierr);
+  ierr = PetscSFBasicGetPack(sf,unit,leafdata,&link);CHKERRQ(ierr);
+  if (shm->useshm) {ierr = PetscSFShmGetSeg(sf,link,&seg);CHKERRQ(ierr);}
+
+  ierr = PetscSFBasicPackGetReqs(sf,link,PETSC_SF_LEAF2ROOT_REDUCE,&rootreqs,&leafreqs);CHKERRQ(ierr);
+  /* Post root receives from the ranks on other nodes only */
+  for (i=ndrootranks; i<nrootranks; i++) {
+    if (shm->rootshm[i] != MPI_PROC_NULL) continue;
+    ierr = PetscMPIIntCast(rootoffset[i+1]-rootoffset[i],&n);CHKERRQ(ierr);
+    ierr = MPI_Startall_irecv(n,unit,1,&rootreqs[i-ndrootranks]);CHKERRQ(ierr);
+  }
+
+  /* Pack leaf data, into my segment for the node-local ranks, and send it to the other ranks */
+  for (i=0; i<nleafranks; i++) {
+    ierr = PetscMPIIntCast(leafoffset[i+1]-leafoffset[i],&n);CHKERRQ(ierr);
+    if (shm->leafshm[i] != MPI_PROC_NULL) {
+      ierr = PetscSFBasicPackData(link,shm->leafpackopt,i,n,leafloc+leafoffset[i],leafdata,seg->base+shm->leafsegoff[i]*link->unitbytes);CHKERRQ(ierr);
+      continue;
+    }
+    ierr = PetscSFBasicPackData(link,shm->leafpackopt,i,n,leafloc+leafoffset[i],leafdata,link->leaf[i]);CHKERRQ(ierr);
+    if (i < ndleafranks) continue; /* shared memory */
+    ierr = MPI_Start_isend(n,unit,&leafreqs[i-ndleafranks]);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PetscSFReduceEnd_Shm(PetscSF sf,MPI_Datatype unit,const void *leafdata,void *rootdata,MPI_Op op)
+{
+  PetscSF_Shm      *shm = (PetscSF_Shm*)sf->data;
+  PetscErrorCode   ierr;
+  PetscSFBasicPack link;
+  PetscSFShmSeg    seg = NULL;
+  PetscInt         i,nrootranks;
+  const PetscInt   *rootoffset,*rootloc;
+  void             (*UnpackOp)(PetscInt,PetscInt,const PetscInt*,void*,const void*);
+  PetscMPIInt      typesize = -1;
+
+  PetscFunctionBegin;
+  ierr = PetscSFBasicGetPackInUse(sf,unit,leafdata,PETSC_OWN_POINTER,&link);CHKERRQ(ierr);
+  ierr = PetscSFBasicPackWaitall(sf,link,PETSC_SF_LEAF2ROOT_REDUCE);CHKERRQ(ierr);
+  if (shm->useshm) {
+    ierr = PetscSFShmGetSegInUse(sf,link,&seg);CHKERRQ(ierr);
+    ierr = PetscSFShmSync(sf,seg);CHKERRQ(ierr);
+  }
+  ierr = PetscSFBasicGetRootInfo(sf,&nrootranks,NULL,NULL,&rootoffset,&rootloc);CHKERRQ(ierr);
+  ierr = PetscSFBasicPackGetUnpackOp(sf,link,op,&UnpackOp);CHKERRQ(ierr);
+  if (UnpackOp) typesize = link->unitbytes;
+  else {ierr = MPI_Type_size(unit,&typesize);CHKERRQ(ierr);}
+
+  for (i=0; i<nrootranks; i++) {
+    const char *packstart = shm->rootshm[i] != MPI_PROC_NULL ? seg->peer[shm->rootshm[i]]+shm->rootpeeroff[i]*link->unitbytes : link->root[i];
+    ierr = PetscSFBasicUnpackDataOp(link,shm->rootpackopt,i,UnpackOp,unit,op,typesize,rootoffset[i+1]-rootoffset[i],rootloc+rootoffset[i],rootdata,packstart);CHKERRQ(ierr);
+  }
+  if (seg) {ierr = PetscSFShmReclaimSeg(sf,&seg);CHKERRQ(ierr);}
+  ierr = PetscSFBasicReclaimPack(sf,&link);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PetscSFFetchAndOpBegin_Shm(PetscSF sf,MPI_Datatype unit,void *rootdata,const void *leafdata,void *leafupdate,MPI_Op op)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscSFReduceBegin_Shm(sf,unit,leafdata,rootdata,op);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PetscSFFetchAndOpEnd_Shm(PetscSF sf,MPI_Datatype unit,void *rootdata,const void *leafdata,void *leafupdate,MPI_Op op)
+{
+  PetscSF_Shm      *shm = (PetscSF_Shm*)sf->data;
+  PetscErrorCode   ierr;
+  PetscSFBasicPack link;
+  PetscSFShmSeg    seg = NULL;
+  PetscInt         i,nrootranks,ndrootranks,nleafranks,ndleafranks;
+  const PetscInt   *rootoffset,*leafoffset,*rootloc,*leafloc;
+  MPI_Request      *rootreqs,*leafreqs;
+  PetscMPIInt      n;
+  void             (*FetchAndOp)(PetscInt,PetscInt,const PetscInt*,void*,void*);
+
+  PetscFunctionBegin;
+  ierr = PetscSFBasicGetPackInUse(sf,unit,leafdata,PETSC_OWN_POINTER,&link);CHKERRQ(ierr);
+  ierr = PetscSFBasicPackWaitall(sf,link,PETSC_SF_LEAF2ROOT_REDUCE);CHKERRQ(ierr);
+  if (shm->useshm) {
+    ierr = PetscSFShmGetSegInUse(sf,link,&seg);CHKERRQ(ierr);
+    ierr = PetscSFShmSync(sf,seg);CHKERRQ(ierr);
+  }
+  ierr = PetscSFBasicGetRootInfo(sf,&nrootranks,&ndrootranks,NULL,&rootoffset,&rootloc);CHKERRQ(ierr);
+  ierr = PetscSFBasicGetLeafInfo(sf,&nleafranks,&ndleafranks,NULL,&leafoffset,&leafloc);CHKERRQ(ierr);
+  ierr = PetscSFBasicPackGetReqs(sf,link,PETSC_SF_ROOT2LEAF_BCAST,&rootreqs,&leafreqs);CHKERRQ(ierr);
+  for (i=ndleafranks; i<nleafranks; i++) {
+    if (shm->leafshm[i] != MPI_PROC_NULL) continue;
+    ierr = PetscMPIIntCast(leafoffset[i+1]-leafoffset[i],&n);CHKERRQ(ierr);
+    ierr = MPI_Startall_irecv(n,unit,1,&leafreqs[i-ndleafranks]);CHKERRQ(ierr);
+  }
+
+  /* Fetch and op, in place in the segments of the node-local ranks, and send the fetched values to the other ranks */
+  ierr = PetscSFBasicPackGetFetchAndOp(sf,link,op,&FetchAndOp);CHKERRQ(ierr);
+  for (i=0; i<nrootranks; i++) {
+    ierr = PetscMPIIntCast(rootoffset[i+1]-rootoffset[i],&n);CHKERRQ(ierr);
+    if (shm->rootshm[i] != MPI_PROC_NULL) {
+      (*FetchAndOp)(n,link->bs,rootloc+rootoffset[i],rootdata,seg->peer[shm->rootshm[i]]+shm->rootpeeroff[i]*link->unitbytes);
+      continue;
+    }
+    (*FetchAndOp)(n,link->bs,rootloc+rootoffset[i],rootdata,link->root[i]);
+    if (i < ndrootranks) continue; /* shared memory */
+    ierr = MPI_Start_isend(n,unit,&rootreqs[i-ndrootranks]);CHKERRQ(ierr);
+  }
+  if (seg) {ierr = PetscSFShmSync(sf,seg);CHKERRQ(ierr);}
+  ierr = PetscSFBasicPackWaitall(sf,link,PETSC_SF_ROOT2LEAF_BCAST);CHKERRQ(ierr);
+  for (i=0; i<nleafranks; i++) {
+    const char *packstart = shm->leafshm[i] != MPI_PROC_NULL ? seg->base+shm->leafsegoff[i]*link->unitbytes : link->leaf[i];
+    ierr = PetscMPIIntCast(leafoffset[i+1]-leafoffset[i],&n);CHKERRQ(ierr);
+    ierr = PetscSFBasicUnpackData(link,shm->leafpackopt,i,link->UnpackInsert,n,leafloc+leafoffset[i],leafupdate,(const void*)packstart);CHKERRQ(ierr);
+  }
+  if (seg) {ierr = PetscSFShmReclaimSeg(sf,&seg);CHKERRQ(ierr);}
+  ierr = PetscSFBasicReclaimPack(sf,&link);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PetscSFReset_Shm(PetscSF sf)
+{
+  PetscSF_Shm    *shm = (PetscSF_Shm*)sf->data;
+  PetscErrorCode ierr;
+  PetscSFShmSeg  seg,next;
+
+  PetscFunctionBegin;
+  for (seg=shm->segs; seg; seg=next) {
+    next = seg->next;
+    if (seg->link) SETERRQ(PetscObjectComm((PetscObject)sf),PETSC_ERR_ARG_WRONGSTATE,"Outstanding operation has not been completed");
+    ierr = MPI_Win_unlock_all(seg->win);CHKERRQ(ierr);
+    ierr = MPI_Win_free(&seg->win);CHKERRQ(ierr);
+    ierr = PetscFree(seg->peer);CHKERRQ(ierr);
+    ierr = PetscFree(seg);CHKERRQ(ierr);
+  }
+  shm->segs = NULL;
+  ierr = PetscFree6(shm->rootshm,shm->rootsegoff,shm->rootpeeroff,shm->leafshm,shm->leafsegoff,shm->leafpeeroff);CHKERRQ(ierr);
+  ierr = PetscSFReset_Basic(sf);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PetscSFDestroy_Shm(PetscSF sf)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscSFReset_Shm(sf);CHKERRQ(ierr);
+  ierr = PetscFree(sf->data);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PetscSFView_Shm(PetscSF sf,PetscViewer viewer)
+{
+  PetscSF_Shm       *shm = (PetscSF_Shm*)sf->data;
+  PetscErrorCode    ierr;
+  PetscBool         iascii;
+  PetscViewerFormat format;
+  PetscInt          i,lcount[2] = {0,0},gcount[2];
+
+  PetscFunctionBegin;
+  ierr = PetscSFView_Basic(sf,viewer);CHKERRQ(ierr);
+  ierr = PetscObjectTypeCompare((PetscObject)viewer,PETSCVIEWERASCII,&iascii);CHKERRQ(ierr);
+  if (iascii) {
+    ierr = PetscViewerGetFormat(viewer,&format);CHKERRQ(ierr);
+    if (format == PETSC_VIEWER_ASCII_INFO && sf->setupcalled) {
+      /* number of (rank,rank) messages, over all the processes, between distinct ranks and between distinct ranks of the same node */
+      for (i=shm->ndiranks; i<shm->niranks; i++) {
+        lcount[0]++;
+        if (shm->rootshm[i] != MPI_PROC_NULL) lcount[1]++;
+      }
+      ierr = MPIU_Allreduce(lcount,gcount,2,MPIU_INT,MPI_SUM,PetscObjectComm((PetscObject)sf));CHKERRQ(ierr);
+      ierr = PetscViewerASCIIPrintf(viewer,"  %D of %D messages through shared memory\n",gcount[1],gcount[0]);CHKERRQ(ierr);
+    }
+  }
+  PetscFunctionReturn(0);
+}
+
+PETSC_EXTERN PetscErrorCode PetscSFCreate_Shm(PetscSF sf)
+{
+  PetscSF_Shm    *shm;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  sf->ops->SetUp           = PetscSFSetUp_Shm;
+  sf->ops->SetFromOptions  = PetscSFSetFromOptions_Basic;
+  sf->ops->Reset           = PetscSFReset_Shm;
+  sf->ops->Destroy         = PetscSFDestroy_Shm;
+  sf->ops->View            = PetscSFView_Shm;
+  sf->ops->BcastBegin      = PetscSFBcastBegin_Shm;
+  sf->ops->BcastEnd        = PetscSFBcastEnd_Shm;
+  sf->ops->BcastAndOpBegin = PetscSFBcastAndOpBegin_Shm;
+  sf->ops->BcastAndOpEnd   = PetscSFBcastAndOpEnd_Shm;
+  sf->ops->ReduceBegin     = PetscSFReduceBegin_Shm;
+  sf->ops->ReduceEnd       = PetscSFReduceEnd_Shm;
+  sf->ops->FetchAndOpBegin = PetscSFFetchAndOpBegin_Shm;
+  sf->ops->FetchAndOpEnd   = PetscSFFetchAndOpEnd_Shm;
+  sf->ops->GetLeafRanks    = PetscSFGetLeafRanks_Basic;
+
+  ierr = PetscNewLog(sf,&shm);CHKERRQ(ierr);
+  shm->persistent = PETSC_TRUE;
+  shm->usepackopt = PETSC_TRUE;
+  sf->data = (void*)shm;
+  PetscFunctionReturn(0);
+}
@@ -131,6 +131,12 @@ PetscErrorCode PetscSFSetType(PetscSF sf,PetscSFType type)
   if (!r) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_UNKNOWN_TYPE,"Unable to find requested PetscSF type %s",type);
   /* Destroy the previous PetscSF implementation context */
   if (sf->ops->Destroy) {ierr = (*(sf)->ops->Destroy)(sf);CHKERRQ(ierr);}
+  /* The new implementation sets up its own ranks */
+  if (sf->setupcalled) {
+    sf->nranks = -1;
+    ierr = PetscFree4(sf->ranks,sf->roffset,sf->rmine,sf->rremote);CHKERRQ(ierr);
+    sf->setupcalled = PETSC_FALSE;
+  }
   ierr = PetscMemzero(sf->ops,sizeof(*sf->ops));CHKERRQ(ierr);
   ierr = PetscObjectChangeTypeName((PetscObject)sf,type);CHKERRQ(ierr);
   ierr = (*r)(sf);CHKERRQ(ierr);
@@ -196,9 +202,12 @@ PetscErrorCode PetscSFDestroy(PetscSF *sf)
    Input Arguments:
 .  sf - star forest communication object
 
+   Options Database Keys:
+.  -sf_view - view the star forest once it is set up, -sf_view ::ascii_info also prints how the messages are packed
+
    Level: beginner
 
-.seealso: PetscSFSetFromOptions(), PetscSFSetType()
+.seealso: PetscSFSetFromOptions(), PetscSFSetType(), PetscSFView()
 @*/
 PetscErrorCode PetscSFSetUp(PetscSF sf)
 {
@@ -213,6 +222,7 @@ PetscErrorCode PetscSFSetUp(PetscSF sf)
   if (sf->ops->SetUp) {ierr = (*sf->ops->SetUp)(sf);CHKERRQ(ierr);}
   ierr = PetscLogEventEnd(PETSCSF_SetUp,sf,0,0,0);CHKERRQ(ierr);
   sf->setupcalled = PETSC_TRUE;
+  ierr = PetscSFViewFromOptions(sf,NULL,"-sf_view");CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
@@ -562,6 +572,10 @@ PetscErrorCode PetscSFGetLeafRange(PetscSF sf,PetscInt *minleaf,PetscInt *maxlea
 +  sf - star forest
 -  viewer - viewer to display graph, for example PETSC_VIEWER_STDOUT_WORLD
 
+   Notes:
+   With the PETSC_VIEWER_ASCII_INFO format PETSCSFBASIC also prints how many of the messages have contiguous, strided,
+   3D sub-block or irregular root and leaf locations; all but the irregular ones are packed and unpacked with memcpy().
+
    Level: beginner
 
 .seealso: PetscSFCreate(), PetscSFSetGraph()
@@ -586,6 +600,7 @@ PetscErrorCode PetscSFView(PetscSF sf,PetscViewer viewer)
     ierr = PetscObjectPrintClassNamePrefixType((PetscObject)sf,viewer);CHKERRQ(ierr);
     ierr = PetscViewerASCIIPushTab(viewer);CHKERRQ(ierr);
     if (sf->ops->View) {ierr = (*sf->ops->View)(sf,viewer);CHKERRQ(ierr);}
+    ierr = PetscViewerGetFormat(viewer,&format);CHKERRQ(ierr);
     if (!sf->graphset) {
       ierr = PetscViewerASCIIPrintf(viewer,"PetscSFSetGraph() has not been called yet\n");CHKERRQ(ierr);
       ierr = PetscViewerASCIIPopTab(viewer);CHKERRQ(ierr);
@@ -598,7 +613,6 @@ PetscErrorCode PetscSFView(PetscSF sf,PetscViewer viewer)
       ierr = PetscViewerASCIISynchronizedPrintf(viewer,"[%d] %D <- (%D,%D)\n",rank,sf->mine ? sf->mine[i] : i,sf->remote[i].rank,sf->remote[i].index);CHKERRQ(ierr);
     }
     ierr = PetscViewerFlush(viewer);CHKERRQ(ierr);
-    ierr = PetscViewerGetFormat(viewer,&format);CHKERRQ(ierr);
     if (format == PETSC_VIEWER_ASCII_INFO_DETAIL) {
       PetscMPIInt *tmpranks,*perm;
       ierr = PetscMalloc2(sf->nranks,&tmpranks,sf->nranks,&perm);CHKERRQ(ierr);
@@ -1117,6 +1131,89 @@ PetscErrorCode PetscSFBcastEnd(PetscSF sf,MPI_Datatype unit,const void *rootdata
   PetscFunctionReturn(0);
 }
 
+/*@C
+   PetscSFBcastManyBegin - begin the pointwise broadcast of several arrays, to be concluded with call to PetscSFBcastManyEnd()
+
+   Collective on PetscSF
+
+   Input Arguments:
++  sf - star forest on which to communicate
+.  n - number of arrays
+.  units - data type associated with each node, for each array
+-  rootdata - buffers to broadcast
+
+   Output Arguments:
+.  leafdata - buffers to update with values from each leaf's respective root
+
+   Notes:
+   This is equivalent to n calls of PetscSFBcastBegin(sf,units[k],rootdata[k],leafdata[k]), followed later by the n
+   calls of PetscSFBcastEnd(), but the implementation may send the data of all the arrays in one message per rank.
+   PETSCSFBASIC and PETSCSFNEIGHBOR do.
+
+   The same n, units and rootdata must be passed to PetscSFBcastManyEnd().
+
+   Level: intermediate
+
+.seealso: PetscSFBcastBegin(), PetscSFBcastManyEnd()
+@*/
+PetscErrorCode PetscSFBcastManyBegin(PetscSF sf,PetscInt n,const MPI_Datatype units[],const void *rootdata[],void *leafdata[])
+{
+  PetscInt       k;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(sf,PETSCSF_CLASSID,1);
+  if (n < 0) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Number of arrays %D cannot be negative",n);
+  if (!n) PetscFunctionReturn(0);
+  PetscValidPointer(units,3);
+  PetscValidPointer(rootdata,4);
+  PetscValidPointer(leafdata,5);
+  ierr = PetscSFSetUp(sf);CHKERRQ(ierr);
+  ierr = PetscLogEventBegin(PETSCSF_BcastBegin,sf,0,0,0);CHKERRQ(ierr);
+  if (sf->ops->BcastManyBegin) {ierr = (*sf->ops->BcastManyBegin)(sf,n,units,rootdata,leafdata);CHKERRQ(ierr);}
+  else {
+    for (k=0; k<n; k++) {ierr = (*sf->ops->BcastBegin)(sf,units[k],rootdata[k],leafdata[k]);CHKERRQ(ierr);}
+  }
+  ierr = PetscLogEventEnd(PETSCSF_BcastBegin,sf,0,0,0);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*@C
+   PetscSFBcastManyEnd - end a broadcast of several arrays started with PetscSFBcastManyBegin()
+
+   Collective
+
+   Input Arguments:
++  sf - star forest
+.  n - number of arrays
+.  units - data type associated with each node, for each array
+-  rootdata - buffers to broadcast
+
+   Output Arguments:
+.  leafdata - buffers to update with values from each leaf's respective root
+
+   Level: intermediate
+
+.seealso: PetscSFBcastManyBegin(), PetscSFBcastEnd()
+@*/
+PetscErrorCode PetscSFBcastManyEnd(PetscSF sf,PetscInt n,const MPI_Datatype units[],const void *rootdata[],void *leafdata[])
+{
+  PetscInt       k;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(sf,PETSCSF_CLASSID,1);
+  if (!n) PetscFunctionReturn(0);
+  ierr = PetscSFSetUp(sf);CHKERRQ(ierr);
+  ierr = PetscLogEventBegin(PETSCSF_BcastEnd,sf,0,0,0);CHKERRQ(ierr);
+  if (sf->ops->BcastManyEnd) {ierr = (*sf->ops->BcastManyEnd)(sf,n,units,rootdata,leafdata);CHKERRQ(ierr);}
+  else {
+    for (k=0; k<n; k++) {ierr = (*sf->ops->BcastEnd)(sf,units[k],rootdata[k],leafdata[k]);CHKERRQ(ierr);}
+  }
+  ierr = PetscLogEventEnd(PETSCSF_BcastEnd,sf,0,0,0);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 /*@C
    PetscSFBcastAndOpBegin - begin pointwise broadcast with root value being reduced to leaf value, to be concluded with call to PetscSFBcastAndOpEnd()
 
@@ -4,6 +4,12 @@ PETSC_EXTERN PetscErrorCode PetscSFCreate_Basic(PetscSF);
 #if defined(PETSC_HAVE_MPI_WIN_CREATE) && defined(PETSC_HAVE_MPI_TYPE_DUP)
 PETSC_EXTERN PetscErrorCode PetscSFCreate_Window(PetscSF);
 #endif
+#if defined(PETSC_HAVE_MPI_WIN_CREATE_FEATURE)
+PETSC_EXTERN PetscErrorCode PetscSFCreate_Shm(PetscSF);
+#endif
+#if defined(PETSC_HAVE_MPI_NEIGHBORHOOD_COLLECTIVES)
+PETSC_EXTERN PetscErrorCode PetscSFCreate_Neighbor(PetscSF);
+#endif
 
 PetscFunctionList PetscSFList;
 PetscBool         PetscSFRegisterAllCalled;
@@ -29,6 +35,12 @@ PetscErrorCode  PetscSFRegisterAll(void)
   ierr = PetscSFRegister(PETSCSFBASIC,  PetscSFCreate_Basic);CHKERRQ(ierr);
 #if defined(PETSC_HAVE_MPI_WIN_CREATE) && defined(PETSC_HAVE_MPI_TYPE_DUP)
   ierr = PetscSFRegister(PETSCSFWINDOW, PetscSFCreate_Window);CHKERRQ(ierr);
+#endif
+#if defined(PETSC_HAVE_MPI_WIN_CREATE_FEATURE)
+  ierr = PetscSFRegister(PETSCSFSHM,    PetscSFCreate_Shm);CHKERRQ(ierr);
+#endif
+#if defined(PETSC_HAVE_MPI_NEIGHBORHOOD_COLLECTIVES)
+  ierr = PetscSFRegister(PETSCSFNEIGHBOR,PetscSFCreate_Neighbor);CHKERRQ(ierr);
 #endif
   PetscFunctionReturn(0);
 }
@@ -175,6 +175,12 @@ int main(int argc,char **argv)
       nsize: 2
       output_file: output/ex1_1.out
 
+   test:
+      suffix: 2_nogemv
+      nsize: 2
+      args: -vec_mdot_use_gemv 0 -vec_maxpy_use_gemv 0
+      output_file: output/ex1_1.out
+
    test:
       suffix: 2_cuda
       nsize: 2
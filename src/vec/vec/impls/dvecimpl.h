@@ -20,6 +20,8 @@ PETSC_INTERN PetscErrorCode VecMTDot_Seq(Vec,PetscInt,const Vec[],PetscScalar*);
 PETSC_INTERN PetscErrorCode VecMin_Seq(Vec,PetscInt*,PetscReal*);
 PETSC_INTERN PetscErrorCode VecSet_Seq(Vec,PetscScalar);
 PETSC_INTERN PetscErrorCode VecMAXPY_Seq(Vec,PetscInt,const PetscScalar*,Vec*);
+PETSC_INTERN PetscErrorCode VecMDot_Seq_GEMV(Vec,PetscInt,const Vec[],PetscScalar*);
+PETSC_INTERN PetscErrorCode VecMAXPY_Seq_GEMV(Vec,PetscInt,const PetscScalar*,Vec*);
 PETSC_INTERN PetscErrorCode VecAYPX_Seq(Vec,PetscScalar,Vec);
 PETSC_INTERN PetscErrorCode VecWAXPY_Seq(Vec,PetscScalar,Vec,Vec);
 PETSC_INTERN PetscErrorCode VecAXPBYPCZ_Seq(Vec,PetscScalar,PetscScalar,PetscScalar,Vec,Vec);
@@ -36,6 +38,7 @@ PETSC_INTERN PetscErrorCode VecMax_Seq(Vec,PetscInt*,PetscReal*);
 PETSC_INTERN PetscErrorCode VecNorm_Seq(Vec,NormType,PetscReal*);
 PETSC_INTERN PetscErrorCode VecDestroy_Seq(Vec);
 PETSC_INTERN PetscErrorCode VecDuplicate_Seq(Vec,Vec*);
+PETSC_INTERN PetscErrorCode VecDuplicateVecs_Seq_GEMV(Vec,PetscInt,Vec*[]);
 PETSC_INTERN PetscErrorCode VecSetOption_Seq(Vec,VecOption,PetscBool);
 PETSC_INTERN PetscErrorCode VecGetValues_Seq(Vec,PetscInt,const PetscInt*,PetscScalar*);
 PETSC_INTERN PetscErrorCode VecSetValues_Seq(Vec,PetscInt,const PetscInt*,const PetscScalar*,InsertMode);
@@ -51,6 +54,16 @@ PETSC_INTERN PetscErrorCode VecPointwiseMaxAbs_Seq(Vec,Vec,Vec);
 PETSC_INTERN PetscErrorCode VecPointwiseMin_Seq(Vec,Vec,Vec);
 PETSC_INTERN PetscErrorCode VecPointwiseDivide_Seq(Vec,Vec,Vec);
 
+/*
+   Leading dimension of the single array holding the vectors created by VecDuplicateVecs_Seq_GEMV() and
+   VecDuplicateVecs_MPI_GEMV(), the local length rounded up so that every column is PETSC_MEMALIGN aligned
+*/
+PETSC_STATIC_INLINE PetscInt VecGEMVLeadingDimension_Private(PetscInt n)
+{
+  const PetscInt align = PetscMax(1,PETSC_MEMALIGN/(PetscInt)sizeof(PetscScalar));
+  return PetscMax(1,((n+align-1)/align)*align);
+}
+
 PETSC_EXTERN PetscErrorCode VecCreate_Seq(Vec);
 PETSC_INTERN PetscErrorCode VecCreate_Seq_Private(Vec,const PetscScalar[]);
 
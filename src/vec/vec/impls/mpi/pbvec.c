@@ -80,12 +80,59 @@ static PetscErrorCode VecDuplicate_MPI(Vec win,Vec *v)
 
   ierr = PetscObjectListDuplicate(((PetscObject)win)->olist,&((PetscObject)(*v))->olist);CHKERRQ(ierr);
   ierr = PetscFunctionListDuplicate(((PetscObject)win)->qlist,&((PetscObject)(*v))->qlist);CHKERRQ(ierr);
+  /* a single vector does not share the array of a block created with VecDuplicateVecs() */
+  ierr = PetscObjectCompose((PetscObject)*v,"VecDuplicateVecs_GEMV",NULL);CHKERRQ(ierr);
 
   (*v)->map->bs   = PetscAbs(win->map->bs);
   (*v)->bstash.bs = win->bstash.bs;
   PetscFunctionReturn(0);
 }
 
+/*
+   Creates the m vectors with their local parts as consecutive columns of a single array, see VecDuplicateVecs_Seq_GEMV()
+*/
+static PetscErrorCode VecDuplicateVecs_MPI_GEMV(Vec win,PetscInt m,Vec *V[])
+{
+  PetscErrorCode ierr;
+  Vec_MPI        *w = (Vec_MPI*)win->data;
+  PetscInt       lda = VecGEMVLeadingDimension_Private(win->map->n),i;
+  PetscScalar    *array;
+  PetscContainer container;
+
+  PetscFunctionBegin;
+  /* ghosted vectors and subtypes that provide their own VecDuplicate() need their own storage */
+  if (win->ops->duplicate != VecDuplicate_MPI || w->nghost || w->localrep) {
+    ierr = VecDuplicateVecs_Default(win,m,V);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  if (m <= 0) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"m must be > 0: m = %D",m);
+  ierr = PetscMalloc1(m,V);CHKERRQ(ierr);
+  ierr = PetscCalloc1(m*lda,&array);CHKERRQ(ierr);
+  ierr = PetscContainerCreate(PETSC_COMM_SELF,&container);CHKERRQ(ierr);
+  ierr = PetscContainerSetPointer(container,array);CHKERRQ(ierr);
+  ierr = PetscContainerSetUserDestroy(container,PetscContainerUserDestroyDefault);CHKERRQ(ierr);
+  for (i=0; i<m; i++) {
+    Vec v;
+
+    ierr = VecCreate(PetscObjectComm((PetscObject)win),&v);CHKERRQ(ierr);
+    ierr = PetscLayoutReference(win->map,&v->map);CHKERRQ(ierr);
+    ierr = VecCreate_MPI_Private(v,PETSC_FALSE,0,array+i*lda);CHKERRQ(ierr);
+    ierr = PetscMemcpy(v->ops,win->ops,sizeof(struct _VecOps));CHKERRQ(ierr);
+    ierr = PetscObjectListDuplicate(((PetscObject)win)->olist,&((PetscObject)v)->olist);CHKERRQ(ierr);
+    ierr = PetscFunctionListDuplicate(((PetscObject)win)->qlist,&((PetscObject)v)->qlist);CHKERRQ(ierr);
+    ierr = PetscObjectCompose((PetscObject)v,"VecDuplicateVecs_GEMV",(PetscObject)container);CHKERRQ(ierr);
+
+    v->stash.donotstash   = win->stash.donotstash;
+    v->stash.ignorenegidx = win->stash.ignorenegidx;
+    v->map->bs            = PetscAbs(win->map->bs);
+    v->bstash.bs          = win->bstash.bs;
+    (*V)[i]               = v;
+  }
+  ierr = PetscLogObjectMemory((PetscObject)(*V)[0],m*lda*sizeof(PetscScalar));CHKERRQ(ierr);
+  ierr = PetscContainerDestroy(&container);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 
 static PetscErrorCode VecSetOption_MPI(Vec V,VecOption op,PetscBool flag)
 {
@@ -503,6 +550,12 @@ PetscErrorCode VecCreate_MPI_Private(Vec v,PetscBool alloc,PetscInt nghost,const
   ierr           = PetscNewLog(v,&s);CHKERRQ(ierr);
   v->data        = (void*)s;
   ierr           = PetscMemcpy(v->ops,&DvOps,sizeof(DvOps));CHKERRQ(ierr);
+  if (VecMDotUseGEMV) {
+    v->ops->mdot       = VecMDot_MPI_GEMV;
+    v->ops->mdot_local = VecMDot_Seq_GEMV;
+  }
+  if (VecMAXPYUseGEMV) v->ops->maxpy = VecMAXPY_Seq_GEMV;
+  if (VecMDotUseGEMV || VecMAXPYUseGEMV) v->ops->duplicatevecs = VecDuplicateVecs_MPI_GEMV;
   s->nghost      = nghost;
   v->petscnative = PETSC_TRUE;
 
@@ -816,12 +816,56 @@ PetscErrorCode VecDuplicate_Seq(Vec win,Vec *V)
   ierr = PetscLayoutReference(win->map,&(*V)->map);CHKERRQ(ierr);
   ierr = PetscObjectListDuplicate(((PetscObject)win)->olist,&((PetscObject)(*V))->olist);CHKERRQ(ierr);
   ierr = PetscFunctionListDuplicate(((PetscObject)win)->qlist,&((PetscObject)(*V))->qlist);CHKERRQ(ierr);
+  /* a single vector does not share the array of a block created with VecDuplicateVecs() */
+  ierr = PetscObjectCompose((PetscObject)*V,"VecDuplicateVecs_GEMV",NULL);CHKERRQ(ierr);
 
   (*V)->ops->view          = win->ops->view;
   (*V)->stash.ignorenegidx = win->stash.ignorenegidx;
   PetscFunctionReturn(0);
 }
 
+/*
+   Creates the m vectors as consecutive columns of a single array, so that VecMDot_Seq_GEMV() and VecMAXPY_Seq_GEMV()
+   can treat them as a dense matrix. Each vector holds a reference to the array, which is freed with the last of them.
+*/
+PetscErrorCode VecDuplicateVecs_Seq_GEMV(Vec win,PetscInt m,Vec *V[])
+{
+  PetscErrorCode ierr;
+  PetscInt       lda = VecGEMVLeadingDimension_Private(win->map->n),i;
+  PetscScalar    *array;
+  PetscContainer container;
+
+  PetscFunctionBegin;
+  /* subtypes that provide their own VecDuplicate() need their own storage */
+  if (win->ops->duplicate != VecDuplicate_Seq) {
+    ierr = VecDuplicateVecs_Default(win,m,V);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  if (m <= 0) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"m must be > 0: m = %D",m);
+  ierr = PetscMalloc1(m,V);CHKERRQ(ierr);
+  ierr = PetscCalloc1(m*lda,&array);CHKERRQ(ierr);
+  ierr = PetscContainerCreate(PETSC_COMM_SELF,&container);CHKERRQ(ierr);
+  ierr = PetscContainerSetPointer(container,array);CHKERRQ(ierr);
+  ierr = PetscContainerSetUserDestroy(container,PetscContainerUserDestroyDefault);CHKERRQ(ierr);
+  for (i=0; i<m; i++) {
+    Vec v;
+
+    ierr = VecCreate(PetscObjectComm((PetscObject)win),&v);CHKERRQ(ierr);
+    ierr = PetscLayoutReference(win->map,&v->map);CHKERRQ(ierr);
+    ierr = VecCreate_Seq_Private(v,array+i*lda);CHKERRQ(ierr);
+    ierr = PetscObjectListDuplicate(((PetscObject)win)->olist,&((PetscObject)v)->olist);CHKERRQ(ierr);
+    ierr = PetscFunctionListDuplicate(((PetscObject)win)->qlist,&((PetscObject)v)->qlist);CHKERRQ(ierr);
+    ierr = PetscObjectCompose((PetscObject)v,"VecDuplicateVecs_GEMV",(PetscObject)container);CHKERRQ(ierr);
+
+    v->ops->view          = win->ops->view;
+    v->stash.ignorenegidx = win->stash.ignorenegidx;
+    (*V)[i]               = v;
+  }
+  ierr = PetscLogObjectMemory((PetscObject)(*V)[0],m*lda*sizeof(PetscScalar));CHKERRQ(ierr);
+  ierr = PetscContainerDestroy(&container);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 static struct _VecOps DvOps = {VecDuplicate_Seq, /* 1 */
                                VecDuplicateVecs_Default,
                                VecDestroyVecs_Default,
@@ -905,6 +949,9 @@ PetscErrorCode VecCreate_Seq_Private(Vec v,const PetscScalar array[])
   PetscFunctionBegin;
   ierr = PetscNewLog(v,&s);CHKERRQ(ierr);
   ierr = PetscMemcpy(v->ops,&DvOps,sizeof(DvOps));CHKERRQ(ierr);
+  if (VecMDotUseGEMV) v->ops->mdot = v->ops->mdot_local = VecMDot_Seq_GEMV;
+  if (VecMAXPYUseGEMV) v->ops->maxpy = VecMAXPY_Seq_GEMV;
+  if (VecMDotUseGEMV || VecMAXPYUseGEMV) v->ops->duplicatevecs = VecDuplicateVecs_Seq_GEMV;
 
   v->data            = (void*)s;
   v->petscnative     = PETSC_TRUE;
@@ -5,6 +5,7 @@
 */
 #include <../src/vec/vec/impls/dvecimpl.h>
 #include <petsc/private/kernels/petscaxpy.h>
+#include <petscblaslapack.h>
 
 
 
@@ -756,3 +757,101 @@ PetscErrorCode VecReplaceArray_Seq(Vec vin,const PetscScalar *a)
   v->array_allocated = v->array = (PetscScalar*)a;
   PetscFunctionReturn(0);
 }
+
+/*
+   Gets the arrays of the nv vectors y[], in work space of length nv if it is larger than the static buffer
+*/
+static PetscErrorCode VecGEMVGetArrays_Private(PetscInt nv,const Vec y[],const PetscScalar *abuf[],const PetscScalar ***ya)
+{
+  PetscErrorCode ierr;
+  PetscInt       i;
+
+  PetscFunctionBegin;
+  *ya = abuf;
+  if (nv > 128) {ierr = PetscMalloc1(nv,ya);CHKERRQ(ierr);}
+  for (i=0; i<nv; i++) {
+    const PetscScalar *yy;
+
+    ierr     = VecGetArrayRead(y[i],&yy);CHKERRQ(ierr);
+    (*ya)[i] = yy;
+    ierr     = VecRestoreArrayRead(y[i],&yy);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+/*
+   Splits y[i:nv-1] into y[i:j-1], vectors that are not followed by their neighbor in memory, and y[j:m-1], a run of
+   at least two vectors that are consecutive columns of one array with leading dimension lda
+*/
+PETSC_STATIC_INLINE void VecGEMVFindRun_Private(PetscInt nv,const PetscScalar **ya,PetscInt lda,PetscInt i,PetscInt *j,PetscInt *m)
+{
+  for (*j=i; *j<nv && !(*j+1 < nv && ya[*j+1] == ya[*j]+lda); (*j)++) ;
+  for (*m=PetscMin(*j+1,nv); *m<nv && ya[*m] == ya[*m-1]+lda; (*m)++) ;
+}
+
+/*
+   VecMDot_Seq_GEMV - VecMDot_Seq() computing the inner products with each run of vectors that share one array, as
+   created by VecDuplicateVecs(), with a single matrix-vector product so x is read once per run instead of once per
+   four vectors
+*/
+PetscErrorCode VecMDot_Seq_GEMV(Vec xin,PetscInt nv,const Vec yin[],PetscScalar *z)
+{
+  PetscErrorCode    ierr;
+  PetscInt          n = xin->map->n,lda = VecGEMVLeadingDimension_Private(n),i,j,m;
+  const PetscScalar *abuf[128],**ya,*xa;
+  PetscScalar       one = 1.0,zero = 0.0;
+  PetscBLASInt      bn,bm,blda,ione = 1;
+
+  PetscFunctionBegin;
+  if (!n) {
+    ierr = PetscMemzero(z,nv*sizeof(PetscScalar));CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  ierr = PetscBLASIntCast(n,&bn);CHKERRQ(ierr);
+  ierr = PetscBLASIntCast(lda,&blda);CHKERRQ(ierr);
+  ierr = VecGEMVGetArrays_Private(nv,yin,abuf,&ya);CHKERRQ(ierr);
+  for (i=0; i<nv; i=m) {
+    VecGEMVFindRun_Private(nv,ya,lda,i,&j,&m);
+    if (j > i) {ierr = VecMDot_Seq(xin,j-i,yin+i,z+i);CHKERRQ(ierr);}
+    if (m > j) {
+      ierr = PetscBLASIntCast(m-j,&bm);CHKERRQ(ierr);
+      ierr = VecGetArrayRead(xin,&xa);CHKERRQ(ierr);
+      PetscStackCallBLAS("BLASgemv",BLASgemv_("C",&bn,&bm,&one,ya[j],&blda,xa,&ione,&zero,z+j,&ione));
+      ierr = VecRestoreArrayRead(xin,&xa);CHKERRQ(ierr);
+      ierr = PetscLogFlops(PetscMax((m-j)*(2.0*n-1),0.0));CHKERRQ(ierr);
+    }
+  }
+  if (ya != abuf) {ierr = PetscFree(ya);CHKERRQ(ierr);}
+  PetscFunctionReturn(0);
+}
+
+/*
+   VecMAXPY_Seq_GEMV - VecMAXPY_Seq() adding each run of vectors that share one array with a single matrix-vector product
+*/
+PetscErrorCode VecMAXPY_Seq_GEMV(Vec xin,PetscInt nv,const PetscScalar *alpha,Vec *y)
+{
+  PetscErrorCode    ierr;
+  PetscInt          n = xin->map->n,lda = VecGEMVLeadingDimension_Private(n),i,j,m;
+  const PetscScalar *abuf[128],**ya;
+  PetscScalar       *xa,one = 1.0;
+  PetscBLASInt      bn,bm,blda,ione = 1;
+
+  PetscFunctionBegin;
+  if (!n) PetscFunctionReturn(0);
+  ierr = PetscBLASIntCast(n,&bn);CHKERRQ(ierr);
+  ierr = PetscBLASIntCast(lda,&blda);CHKERRQ(ierr);
+  ierr = VecGEMVGetArrays_Private(nv,(const Vec*)y,abuf,&ya);CHKERRQ(ierr);
+  for (i=0; i<nv; i=m) {
+    VecGEMVFindRun_Private(nv,ya,lda,i,&j,&m);
+    if (j > i) {ierr = VecMAXPY_Seq(xin,j-i,alpha+i,y+i);CHKERRQ(ierr);}
+    if (m > j) {
+      ierr = PetscBLASIntCast(m-j,&bm);CHKERRQ(ierr);
+      ierr = VecGetArray(xin,&xa);CHKERRQ(ierr);
+      PetscStackCallBLAS("BLASgemv",BLASgemv_("N",&bn,&bm,&one,ya[j],&blda,alpha+j,&ione,&one,xa,&ione));
+      ierr = VecRestoreArray(xin,&xa);CHKERRQ(ierr);
+      ierr = PetscLogFlops((m-j)*2.0*n);CHKERRQ(ierr);
+    }
+  }
+  if (ya != abuf) {ierr = PetscFree(ya);CHKERRQ(ierr);}
+  PetscFunctionReturn(0);
+}
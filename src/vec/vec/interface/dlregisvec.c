@@ -135,6 +135,8 @@ const char *const NormTypes[] = {"1","2","FROBENIUS","INFINITY","1_AND_2","NormT
 PetscInt          NormIds[7];  /* map from NormType to IDs used to cache Normvalues */
 
 static PetscBool  VecPackageInitialized = PETSC_FALSE;
+/* -vec_mdot_use_gemv and -vec_maxpy_use_gemv, read once here so that VecCreate() does not query the options database */
+PetscBool         VecMDotUseGEMV = PETSC_TRUE,VecMAXPYUseGEMV = PETSC_TRUE;
 
 /*@C
   VecInitializePackage - This function initializes everything in the Vec package. It is called
@@ -219,6 +221,10 @@ PetscErrorCode  VecInitializePackage(void)
   /* Turn off high traffic events by default */
   ierr = PetscLogEventSetActiveAll(VEC_SetValues, PETSC_FALSE);CHKERRQ(ierr);
 
+  /* Select the VecMDot() and VecMAXPY() kernels of VECSEQ and VECMPI */
+  ierr = PetscOptionsGetBool(NULL,NULL,"-vec_mdot_use_gemv",&VecMDotUseGEMV,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(NULL,NULL,"-vec_maxpy_use_gemv",&VecMAXPYUseGEMV,NULL);CHKERRQ(ierr);
+
   /* Process info exclusions */
   ierr = PetscOptionsGetString(NULL,NULL,"-info_exclude",logList,sizeof(logList),&opt);CHKERRQ(ierr);
   if (opt) {
@@ -276,6 +282,8 @@ PetscErrorCode  VecFinalizePackage(void)
   }
   VecPackageInitialized = PETSC_FALSE;
   VecRegisterAllCalled  = PETSC_FALSE;
+  VecMDotUseGEMV        = PETSC_TRUE;
+  VecMAXPYUseGEMV       = PETSC_TRUE;
   PetscFunctionReturn(0);
 }
 
@@ -429,6 +429,10 @@ PetscErrorCode  VecDestroy(Vec *v)
    Use VecDestroyVecs() to free the space. Use VecDuplicate() to form a single
    vector.
 
+   For VECSEQ and VECMPI the vectors are stored as the columns of a single array, so that VecMDot() and VecMAXPY()
+   can process them with one dense matrix-vector product. Use the options -vec_mdot_use_gemv 0 and
+   -vec_maxpy_use_gemv 0 to allocate them separately and use the unrolled kernels.
+
    Fortran Note:
    The Fortran interface is slightly different from that given below, it
    requires one to pass in V a Vec (integer) array of size at least m.
@@ -214,5 +214,12 @@ int main(int argc,char **argv)
       nsize: 2
       args:
       requires: double
+
+   test:
+      suffix: sf
+      nsize: 2
+      args: -vecscatter_type sf
+      requires: double
+      output_file: output/ex5_1.out
 TEST*/
 
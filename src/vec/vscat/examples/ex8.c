@@ -0,0 +1,176 @@
+static const char help[] = "Tests and benchmarks VecScatter of several types on a ring of processes.\n\
+  -vecscatter_types <t1,t2,...> : the VecScatter types to compare\n\
+  -nneighbors <k>               : each process receives a message from each of the k next processes\n\
+  -sizes <m1,m2,...>            : number of PetscScalar in each message\n\
+  -bs <bs>                      : block size of the vectors, the index sets are general but made of blocks\n\
+  -nits <n>                     : number of scatters timed by -benchmark\n\
+  -benchmark                    : print the latency and bandwidth of each type for each message size\n\n";
+
+#include <petscvec.h>
+#include <petsctime.h>
+
+/* Each process has (k+1)*m entries of x. Entries [i*m,(i+1)*m) of y get entries [i*m,(i+1)*m) of x on the i-th next process,
+   and the last m entries of y the last m entries of x on the process itself, which is the local part of the scatter */
+static PetscErrorCode CreateRingScatter(MPI_Comm comm,const char *type,PetscInt k,PetscInt m,PetscInt bs,Vec *x,Vec *y,VecScatter *vscat)
+{
+  PetscMPIInt    rank,size;
+  PetscInt       i,j,n,*idx;
+  const PetscInt *ranges;
+  IS             ix;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MPI_Comm_rank(comm,&rank);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(comm,&size);CHKERRQ(ierr);
+  n    = (k+1)*m;
+  ierr = VecCreateMPI(comm,n,PETSC_DETERMINE,x);CHKERRQ(ierr);
+  ierr = VecSetBlockSize(*x,bs);CHKERRQ(ierr);
+  ierr = VecDuplicate(*x,y);CHKERRQ(ierr);
+  ierr = VecGetOwnershipRanges(*x,&ranges);CHKERRQ(ierr);
+  ierr = PetscMalloc1(n,&idx);CHKERRQ(ierr);
+  for (i=0; i<k; i++) {
+    for (j=0; j<m; j++) idx[i*m+j] = ranges[(rank+1+i)%size] + i*m+j;
+  }
+  for (j=0; j<m; j++) idx[k*m+j] = ranges[rank] + k*m+j;
+  ierr = ISCreateGeneral(PETSC_COMM_SELF,n,idx,PETSC_OWN_POINTER,&ix);CHKERRQ(ierr);
+
+  /* the type is taken from the options database when the scatter is created */
+  ierr = PetscOptionsSetValue(NULL,"-vecscatter_type",type);CHKERRQ(ierr);
+  ierr = VecScatterCreate(*x,ix,*y,NULL,vscat);CHKERRQ(ierr);
+  ierr = PetscOptionsClearValue(NULL,"-vecscatter_type");CHKERRQ(ierr);
+  ierr = ISDestroy(&ix);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* Check one forward scatter with INSERT_VALUES and one reverse scatter with ADD_VALUES, then time nits of each when nits > 0 */
+static PetscErrorCode RunScatter(VecScatter vscat,Vec x,Vec y,PetscInt k,PetscInt m,PetscInt nits,PetscInt *nerr,PetscLogDouble *tforward,PetscLogDouble *treverse)
+{
+  PetscMPIInt       rank,size;
+  PetscInt          i,it,n,rstart,next;
+  const PetscInt    *ranges;
+  PetscScalar       *xv;
+  const PetscScalar *yv;
+  PetscLogDouble    t0,t1,t2;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = MPI_Comm_rank(PetscObjectComm((PetscObject)x),&rank);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(PetscObjectComm((PetscObject)x),&size);CHKERRQ(ierr);
+  ierr = VecGetOwnershipRange(x,&rstart,NULL);CHKERRQ(ierr);
+  ierr = VecGetOwnershipRanges(x,&ranges);CHKERRQ(ierr);
+  ierr = VecGetLocalSize(x,&n);CHKERRQ(ierr);
+  *nerr = 0;
+
+  ierr = VecGetArray(x,&xv);CHKERRQ(ierr);
+  for (i=0; i<n; i++) xv[i] = rstart+i;
+  ierr = VecRestoreArray(x,&xv);CHKERRQ(ierr);
+  ierr = VecSet(y,-1.0);CHKERRQ(ierr);
+  ierr = VecScatterBegin(vscat,x,y,INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+  ierr = VecScatterEnd(vscat,x,y,INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+
+  /* y has k messages of m entries from the next processes, then m entries from x on this process */
+  ierr = VecGetArrayRead(y,&yv);CHKERRQ(ierr);
+  for (i=0; i<n; i++) {
+    next = (i < k*m) ? (rank+1+i/m)%size : rank;
+    if (yv[i] != (PetscScalar)(ranges[next]+i)) (*nerr)++;
+  }
+  ierr = VecRestoreArrayRead(y,&yv);CHKERRQ(ierr);
+
+  /* each entry of x is sent once, so the reverse scatter with ADD_VALUES doubles x */
+  ierr = VecScatterBegin(vscat,y,x,ADD_VALUES,SCATTER_REVERSE);CHKERRQ(ierr);
+  ierr = VecScatterEnd(vscat,y,x,ADD_VALUES,SCATTER_REVERSE);CHKERRQ(ierr);
+  ierr = VecGetArray(x,&xv);CHKERRQ(ierr);
+  for (i=0; i<n; i++) if (xv[i] != (PetscScalar)(2*(rstart+i))) (*nerr)++;
+  ierr = VecRestoreArray(x,&xv);CHKERRQ(ierr);
+
+  ierr = MPI_Barrier(PetscObjectComm((PetscObject)x));CHKERRQ(ierr);
+  ierr = PetscTime(&t0);CHKERRQ(ierr);
+  for (it=0; it<nits; it++) {
+    ierr = VecScatterBegin(vscat,x,y,INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+    ierr = VecScatterEnd(vscat,x,y,INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+  }
+  ierr = PetscTime(&t1);CHKERRQ(ierr);
+  for (it=0; it<nits; it++) {
+    ierr = VecScatterBegin(vscat,y,x,ADD_VALUES,SCATTER_REVERSE);CHKERRQ(ierr);
+    ierr = VecScatterEnd(vscat,y,x,ADD_VALUES,SCATTER_REVERSE);CHKERRQ(ierr);
+  }
+  ierr = PetscTime(&t2);CHKERRQ(ierr);
+  *tforward = nits ? (t1-t0)/nits : 0.0;
+  *treverse = nits ? (t2-t1)/nits : 0.0;
+  PetscFunctionReturn(0);
+}
+
+int main(int argc,char **argv)
+{
+  MPI_Comm       comm;
+  Vec            x,y;
+  VecScatter     vscat;
+  PetscMPIInt    size;
+  char           *types[16];
+  PetscInt       ntypes = 16,sizes[16] = {1,64,4096},nsizes = 16,k = 2,bs = 1,nits = 100,t,s,m,nerr,gerr;
+  PetscBool      flg,benchmark = PETSC_FALSE;
+  PetscLogDouble ltime[2],gtime[2];
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&argv,NULL,help);if (ierr) return ierr;
+  comm = PETSC_COMM_WORLD;
+  ierr = MPI_Comm_size(comm,&size);CHKERRQ(ierr);
+  ierr = PetscOptionsGetStringArray(NULL,NULL,"-vecscatter_types",types,&ntypes,&flg);CHKERRQ(ierr);
+  if (!flg) {
+    ntypes = 0;
+    ierr   = PetscStrallocpy(VECSCATTERMPI1,&types[ntypes++]);CHKERRQ(ierr);
+#if defined(PETSC_HAVE_MPI_WIN_CREATE_FEATURE)
+    ierr   = PetscStrallocpy(VECSCATTERMPI3,&types[ntypes++]);CHKERRQ(ierr);
+#endif
+    ierr   = PetscStrallocpy(VECSCATTERSF,&types[ntypes++]);CHKERRQ(ierr);
+  }
+  ierr = PetscOptionsGetIntArray(NULL,NULL,"-sizes",sizes,&nsizes,&flg);CHKERRQ(ierr);
+  if (!flg) nsizes = 3;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-nneighbors",&k,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-bs",&bs,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-nits",&nits,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(NULL,NULL,"-benchmark",&benchmark,NULL);CHKERRQ(ierr);
+  k    = PetscMin(k,size-1);
+
+  for (t=0; t<ntypes; t++) {
+    for (s=0; s<nsizes; s++) {
+      m    = ((sizes[s]+bs-1)/bs)*bs; /* whole blocks */
+      ierr = CreateRingScatter(comm,types[t],k,m,bs,&x,&y,&vscat);CHKERRQ(ierr);
+      ierr = RunScatter(vscat,x,y,k,m,benchmark ? nits : 0,&nerr,&ltime[0],&ltime[1]);CHKERRQ(ierr);
+      ierr = MPIU_Allreduce(&nerr,&gerr,1,MPIU_INT,MPI_SUM,comm);CHKERRQ(ierr);
+      ierr = MPIU_Allreduce(ltime,gtime,2,MPI_DOUBLE,MPI_MAX,comm);CHKERRQ(ierr);
+      ierr = PetscPrintf(comm,"%s: %D messages of %D scalars per process: %D wrong values\n",types[t],k,m,gerr);CHKERRQ(ierr);
+      if (benchmark) {
+        /* bandwidth of the data received by each process from the other processes */
+        ierr = PetscPrintf(comm,"  forward %g s, %g MB/s\n",gtime[0],gtime[0] > 0.0 ? 1.e-6*k*m*sizeof(PetscScalar)/gtime[0] : 0.0);CHKERRQ(ierr);
+        ierr = PetscPrintf(comm,"  reverse %g s, %g MB/s\n",gtime[1],gtime[1] > 0.0 ? 1.e-6*k*m*sizeof(PetscScalar)/gtime[1] : 0.0);CHKERRQ(ierr);
+      }
+      ierr = VecScatterDestroy(&vscat);CHKERRQ(ierr);
+      ierr = VecDestroy(&x);CHKERRQ(ierr);
+      ierr = VecDestroy(&y);CHKERRQ(ierr);
+    }
+  }
+  for (t=0; t<ntypes; t++) {ierr = PetscFree(types[t]);CHKERRQ(ierr);}
+  ierr = PetscFinalize();
+  return ierr;
+}
+
+/*TEST
+
+   test:
+      nsize: 4
+      args: -nneighbors 3 -vecscatter_types mpi1,sf
+
+   test:
+      suffix: 2
+      nsize: 3
+      args: -vecscatter_types mpi1,sf -bs 3 -sizes 5,1000 -benchmark -nits 2
+      filter: grep -v "s, "
+
+   test:
+      suffix: mpi3
+      nsize: 4
+      args: -nneighbors 3 -vecscatter_types mpi1,mpi3,sf -bs 2
+      requires: define(PETSC_HAVE_MPI_WIN_CREATE_FEATURE)
+
+TEST*/
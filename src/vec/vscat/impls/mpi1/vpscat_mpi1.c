@@ -40,6 +40,9 @@ PetscErrorCode VecScatterView_MPI_MPI1(VecScatter ctx,PetscViewer viewer)
       ierr = PetscViewerASCIIPrintf(viewer,"  Maximum data sent %D\n",(int)(lensend_max*to->bs*sizeof(PetscScalar)));CHKERRQ(ierr);
       ierr = PetscViewerASCIIPrintf(viewer,"  Maximum data received %D\n",(int)(lenrecv_max*to->bs*sizeof(PetscScalar)));CHKERRQ(ierr);
       ierr = PetscViewerASCIIPrintf(viewer,"  Total data sent %D\n",(int)(alldata*to->bs*sizeof(PetscScalar)));CHKERRQ(ierr);
+#if defined(PETSC_HAVE_MPI_NEIGHBORHOOD_COLLECTIVES)
+      if (to->use_neighbor) {ierr = PetscViewerASCIIPrintf(viewer,"  Using MPI neighborhood collectives\n");CHKERRQ(ierr);}
+#endif
 
     } else {
       ierr = PetscViewerASCIIPushSynchronized(viewer);CHKERRQ(ierr);
@@ -116,6 +119,15 @@ PetscErrorCode VecScatterDestroy_PtoP_MPI1(VecScatter ctx)
     }
   }
 
+#if defined(PETSC_HAVE_MPI_NEIGHBORHOOD_COLLECTIVES)
+  if (to->use_neighbor) {
+    ierr = MPI_Comm_free(&to->ncomm);CHKERRQ(ierr);
+    ierr = MPI_Comm_free(&from->ncomm);CHKERRQ(ierr);
+    ierr = PetscFree2(to->ncounts,to->ndispls);CHKERRQ(ierr);
+    ierr = PetscFree2(from->ncounts,from->ndispls);CHKERRQ(ierr);
+  }
+#endif
+
   ierr = PetscFree(to->local.vslots);CHKERRQ(ierr);
   ierr = PetscFree(from->local.vslots);CHKERRQ(ierr);
   ierr = PetscFree(to->local.slots_nonmatching);CHKERRQ(ierr);
@@ -135,6 +147,35 @@ PetscErrorCode VecScatterDestroy_PtoP_MPI1(VecScatter ctx)
 
 /* --------------------------------------------------------------------------------------*/
 
+#if defined(PETSC_HAVE_MPI_NEIGHBORHOOD_COLLECTIVES)
+/*
+   Creates the two distributed graph communicators used by MPI_Ineighbor_alltoallv(), one for the forward scatter,
+   whose destinations are to->procs, and one for the reverse scatter, whose destinations are from->procs.
+   Collective on comm, since MPI_Dist_graph_create_adjacent() is.
+*/
+static PetscErrorCode VecScatterCreateNeighbor_PtoP_MPI1(VecScatter_MPI_General *to,VecScatter_MPI_General *from,MPI_Comm comm)
+{
+  PetscErrorCode ierr;
+  PetscInt       i,bs = to->bs;
+
+  PetscFunctionBegin;
+  to->use_neighbor = from->use_neighbor = PETSC_TRUE;
+  ierr = PetscMalloc2(to->n,&to->ncounts,to->n,&to->ndispls);CHKERRQ(ierr);
+  ierr = PetscMalloc2(from->n,&from->ncounts,from->n,&from->ndispls);CHKERRQ(ierr);
+  for (i=0; i<to->n; i++) {
+    ierr = PetscMPIIntCast(bs*(to->starts[i+1]-to->starts[i]),&to->ncounts[i]);CHKERRQ(ierr);
+    ierr = PetscMPIIntCast(bs*to->starts[i],&to->ndispls[i]);CHKERRQ(ierr);
+  }
+  for (i=0; i<from->n; i++) {
+    ierr = PetscMPIIntCast(bs*(from->starts[i+1]-from->starts[i]),&from->ncounts[i]);CHKERRQ(ierr);
+    ierr = PetscMPIIntCast(bs*from->starts[i],&from->ndispls[i]);CHKERRQ(ierr);
+  }
+  ierr = MPI_Dist_graph_create_adjacent(comm,(PetscMPIInt)from->n,from->procs,MPI_UNWEIGHTED,(PetscMPIInt)to->n,to->procs,MPI_UNWEIGHTED,MPI_INFO_NULL,0,&to->ncomm);CHKERRQ(ierr);
+  ierr = MPI_Dist_graph_create_adjacent(comm,(PetscMPIInt)to->n,to->procs,MPI_UNWEIGHTED,(PetscMPIInt)from->n,from->procs,MPI_UNWEIGHTED,MPI_INFO_NULL,0,&from->ncomm);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+#endif
+
 PetscErrorCode VecScatterCopy_PtoP_X_MPI1(VecScatter in,VecScatter out)
 {
   VecScatter_MPI_General *in_to   = (VecScatter_MPI_General*)in->todata;
@@ -231,6 +272,9 @@ PetscErrorCode VecScatterCopy_PtoP_X_MPI1(VecScatter in,VecScatter out)
     }
   }
 
+#if defined(PETSC_HAVE_MPI_NEIGHBORHOOD_COLLECTIVES)
+  if (in_to->use_neighbor) {ierr = VecScatterCreateNeighbor_PtoP_MPI1(out_to,out_from,PetscObjectComm((PetscObject)out));CHKERRQ(ierr);}
+#endif
   ierr = VecScatterMemcpyPlanCopy_PtoP(in_to,in_from,out_to,out_from);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
@@ -2263,6 +2307,18 @@ PetscErrorCode VecScatterCreateCommon_PtoS_MPI1(VecScatter_MPI_General *from,Vec
   }
   ierr = PetscInfo1(ctx,"Using blocksize %D scatter\n",bs);CHKERRQ(ierr);
 
+#if defined(PETSC_HAVE_MPI_NEIGHBORHOOD_COLLECTIVES)
+  {
+    PetscBool neighbor = PETSC_FALSE;
+
+    ierr = PetscOptionsGetBool(((PetscObject)ctx)->options,((PetscObject)ctx)->prefix,"-vecscatter_neighbor",&neighbor,NULL);CHKERRQ(ierr);
+    if (neighbor) {
+      ierr = VecScatterCreateNeighbor_PtoP_MPI1(to,from,comm);CHKERRQ(ierr);
+      ierr = PetscInfo(ctx,"Using MPI neighborhood collectives\n");CHKERRQ(ierr);
+    }
+  }
+#endif
+
 #if defined(PETSC_USE_DEBUG)
   ierr = MPIU_Allreduce(&bs,&i,1,MPIU_INT,MPI_MIN,PetscObjectComm((PetscObject)ctx));CHKERRQ(ierr);
   ierr = MPIU_Allreduce(&bs,&n,1,MPIU_INT,MPI_MAX,PetscObjectComm((PetscObject)ctx));CHKERRQ(ierr);
@@ -68,17 +68,32 @@ PetscErrorCode PETSCMAP1(VecScatterBeginMPI1)(VecScatter ctx,Vec xin,Vec yin,Ins
   ctx->ydata = yv;
 
   if (!(mode & SCATTER_LOCAL)) {
-    /* post receives since they were not previously posted    */
-    ierr = MPI_Startall_irecv(from->starts[nrecvs]*bs,MPIU_SCALAR,nrecvs,rwaits);CHKERRQ(ierr);
-
-    /* this version packs and sends one at a time */
-    for (i=0; i<nsends; i++) {
-      if (to->memcpy_plan.optimized[i]) { /* use memcpy instead of indivisual load/store */
-        ierr = VecScatterMemcpyPlanExecute_Pack(i,xv,&to->memcpy_plan,svalues+bs*sstarts[i],INSERT_VALUES,bs);CHKERRQ(ierr);
-      } else {
-        PETSCMAP1(Pack_MPI1)(sstarts[i+1]-sstarts[i],indices + sstarts[i],xv,svalues + bs*sstarts[i],bs);
+#if defined(PETSC_HAVE_MPI_NEIGHBORHOOD_COLLECTIVES)
+    if (to->use_neighbor) {
+      /* pack all messages, then exchange them with one neighborhood collective */
+      for (i=0; i<nsends; i++) {
+        if (to->memcpy_plan.optimized[i]) {
+          ierr = VecScatterMemcpyPlanExecute_Pack(i,xv,&to->memcpy_plan,svalues+bs*sstarts[i],INSERT_VALUES,bs);CHKERRQ(ierr);
+        } else {
+          PETSCMAP1(Pack_MPI1)(sstarts[i+1]-sstarts[i],indices + sstarts[i],xv,svalues + bs*sstarts[i],bs);
+        }
+      }
+      ierr = MPI_Ineighbor_alltoallv(svalues,to->ncounts,to->ndispls,MPIU_SCALAR,from->values,from->ncounts,from->ndispls,MPIU_SCALAR,to->ncomm,&to->nrequest);CHKERRQ(ierr);
+    } else
+#endif
+    {
+      /* post receives since they were not previously posted    */
+      ierr = MPI_Startall_irecv(from->starts[nrecvs]*bs,MPIU_SCALAR,nrecvs,rwaits);CHKERRQ(ierr);
+
+      /* this version packs and sends one at a time */
+      for (i=0; i<nsends; i++) {
+        if (to->memcpy_plan.optimized[i]) { /* use memcpy instead of indivisual load/store */
+          ierr = VecScatterMemcpyPlanExecute_Pack(i,xv,&to->memcpy_plan,svalues+bs*sstarts[i],INSERT_VALUES,bs);CHKERRQ(ierr);
+        } else {
+          PETSCMAP1(Pack_MPI1)(sstarts[i+1]-sstarts[i],indices + sstarts[i],xv,svalues + bs*sstarts[i],bs);
+        }
+        ierr = MPI_Start_isend((sstarts[i+1]-sstarts[i])*bs,MPIU_SCALAR,swaits+i);CHKERRQ(ierr);
       }
-      ierr = MPI_Start_isend((sstarts[i+1]-sstarts[i])*bs,MPIU_SCALAR,swaits+i);CHKERRQ(ierr);
     }
   }
 
@@ -134,6 +149,20 @@ PetscErrorCode PETSCMAP1(VecScatterEndMPI1)(VecScatter ctx,Vec xin,Vec yin,Inser
   indices = from->indices;
   rstarts = from->starts;
 
+#if defined(PETSC_HAVE_MPI_NEIGHBORHOOD_COLLECTIVES)
+  if (to->use_neighbor) {
+    ierr = MPI_Wait(&to->nrequest,MPI_STATUS_IGNORE);CHKERRQ(ierr);
+    for (imdex=0; imdex<nrecvs; imdex++) {
+      if (from->memcpy_plan.optimized[imdex]) {
+        ierr = VecScatterMemcpyPlanExecute_Unpack(imdex,rvalues+bs*rstarts[imdex],yv,&from->memcpy_plan,addv,bs);CHKERRQ(ierr);
+      } else {
+        ierr = PETSCMAP1(UnPack_MPI1)(rstarts[imdex+1] - rstarts[imdex],rvalues + bs*rstarts[imdex],indices + rstarts[imdex],yv,addv,bs);CHKERRQ(ierr);
+      }
+    }
+    goto functionend;
+  }
+#endif
+
   /* unpack one at a time */
   count = nrecvs;
   while (count) {
@@ -2,16 +2,88 @@
 #include <petsc/private/sfimpl.h> /*I "petscsf.h" I*/
 
 typedef struct {
-  PetscSF           sf;     /* the whole scatter, including local and remote */
-  PetscSF           lsf;    /* the local part of the scatter, used for SCATTER_LOCAL */
-  PetscInt          bs;     /* block size */
-  MPI_Datatype      unit;   /* one unit = bs PetscScalars */
+  PetscSF                sf;     /* the remote part of the scatter, i.e., the edges between different processes */
+  VecScatter_Seq_General xlocal; /* the local part of the scatter, which copies x[xlocal.vslots[i]] to y[ylocal.vslots[i]] */
+  VecScatter_Seq_General ylocal; /*   without going through the SF. The slots are in PetscScalars, not in units */
+  PetscInt               bs;     /* block size */
+  MPI_Datatype           unit;   /* one unit = bs PetscScalars */
 } VecScatter_SF;
 
+/* Scatter the local part, from x to y in the forward mode and from y to x in the reverse mode.
+   Note that x and y are swapped in input of the reverse scatter */
+static PetscErrorCode VecScatterLocal_SF(VecScatter_SF *data,const PetscScalar *x,PetscScalar *y,InsertMode addv,ScatterMode mode)
+{
+  VecScatter_Seq_General *from,*to;
+  const PetscInt         *fslots,*tslots;
+  PetscInt               i,k,n,bs = data->bs;
+  PetscErrorCode         ierr;
+
+  PetscFunctionBegin;
+  if (mode & SCATTER_REVERSE) {from = &data->ylocal; to = &data->xlocal;}
+  else                        {from = &data->xlocal; to = &data->ylocal;}
+  if (!from->n) PetscFunctionReturn(0);
+
+  if (from->memcpy_plan.optimized[0]) {
+    /* skip a self-to-self copy */
+    if (!(addv == INSERT_VALUES && x == y && from->memcpy_plan.same_copy_starts)) {ierr = VecScatterMemcpyPlanExecute_Scatter(0,x,&from->memcpy_plan,y,&to->memcpy_plan,addv);CHKERRQ(ierr);}
+    PetscFunctionReturn(0);
+  }
+
+  if (addv == INSERT_VALUES && x == y && data->xlocal.nonmatching_computed) {
+    /* only copy entries that do not share identical memory locations */
+    n      = from->n_nonmatching;
+    fslots = from->slots_nonmatching;
+    tslots = to->slots_nonmatching;
+  } else {
+    n      = from->n;
+    fslots = from->vslots;
+    tslots = to->vslots;
+  }
+
+  if (addv == INSERT_VALUES) {
+    for (i=0; i<n; i++) for (k=0; k<bs; k++) y[tslots[i]+k] = x[fslots[i]+k];
+  } else if (addv == ADD_VALUES) {
+    for (i=0; i<n; i++) for (k=0; k<bs; k++) y[tslots[i]+k] += x[fslots[i]+k];
+  }
+#if !defined(PETSC_USE_COMPLEX)
+  else if (addv == MAX_VALUES) {
+    for (i=0; i<n; i++) for (k=0; k<bs; k++) y[tslots[i]+k] = PetscMax(y[tslots[i]+k],x[fslots[i]+k]);
+  }
+#endif
+  else SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_SUP,"Unsupported InsertMode %D in VecScatterBegin/End",addv);
+  PetscFunctionReturn(0);
+}
+
+/* Build the memcpy plan of the local part and find its entries that are not copied onto themselves when x = y */
+static PetscErrorCode VecScatterLocalSetUp_SF(VecScatter vscat)
+{
+  VecScatter_SF  *data = (VecScatter_SF*)vscat->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = VecScatterMemcpyPlanCreate_SGToSG(data->bs,&data->xlocal,&data->ylocal);CHKERRQ(ierr);
+  if (data->xlocal.n) {ierr = VecScatterLocalOptimize_Private(vscat,&data->xlocal,&data->ylocal);CHKERRQ(ierr);}
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode VecScatterLocalReset_SF(VecScatter vscat)
+{
+  VecScatter_SF  *data = (VecScatter_SF*)vscat->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = VecScatterMemcpyPlanDestroy(&data->xlocal.memcpy_plan);CHKERRQ(ierr);
+  ierr = VecScatterMemcpyPlanDestroy(&data->ylocal.memcpy_plan);CHKERRQ(ierr);
+  ierr = PetscFree(data->xlocal.slots_nonmatching);CHKERRQ(ierr);
+  ierr = PetscFree(data->ylocal.slots_nonmatching);CHKERRQ(ierr);
+  data->xlocal.nonmatching_computed = PETSC_FALSE;
+  data->xlocal.n_nonmatching        = data->ylocal.n_nonmatching = 0;
+  PetscFunctionReturn(0);
+}
+
 static PetscErrorCode VecScatterBegin_SF(VecScatter vscat,Vec x,Vec y,InsertMode addv,ScatterMode mode)
 {
   VecScatter_SF  *data=(VecScatter_SF*)vscat->data;
-  PetscSF        sf;
   MPI_Op         mop=MPI_OP_NULL;
   PetscErrorCode ierr;
 
@@ -40,42 +112,44 @@ static PetscErrorCode VecScatterBegin_SF(VecScatter vscat,Vec x,Vec y,InsertMode
   else vscat->ydata = (PetscScalar *)vscat->xdata;
   ierr = VecLockWriteSet_Private(y,PETSC_TRUE);CHKERRQ(ierr);
 
-  /* SCATTER_LOCAL indicates ignoring inter-process communication */
-  sf = (mode & SCATTER_LOCAL) ? data->lsf : data->sf;
-
   if (addv == INSERT_VALUES)   mop = MPI_REPLACE;
   else if (addv == ADD_VALUES) mop = MPI_SUM;
   else if (addv == MAX_VALUES) mop = MPI_MAX;
-  else SETERRQ1(PetscObjectComm((PetscObject)sf),PETSC_ERR_SUP,"Unsupported InsertMode %D in VecScatterBegin/End",addv);
+  else SETERRQ1(PetscObjectComm((PetscObject)vscat),PETSC_ERR_SUP,"Unsupported InsertMode %D in VecScatterBegin/End",addv);
 
-  if (mode & SCATTER_REVERSE) { /* reverse scatter sends root to leaf. Note that x and y are swapped in input */
-    ierr = PetscSFBcastAndOpBegin(sf,data->unit,vscat->xdata,vscat->ydata,mop);CHKERRQ(ierr);
-  } else { /* forward scatter sends leaf to root, i.e., x to y */
-    ierr = PetscSFReduceBegin(sf,data->unit,vscat->xdata,vscat->ydata,mop);CHKERRQ(ierr);
+  /* SCATTER_LOCAL indicates ignoring inter-process communication */
+  if (!(mode & SCATTER_LOCAL)) {
+    if (mode & SCATTER_REVERSE) { /* reverse scatter sends root to leaf. Note that x and y are swapped in input */
+      ierr = PetscSFBcastAndOpBegin(data->sf,data->unit,vscat->xdata,vscat->ydata,mop);CHKERRQ(ierr);
+    } else { /* forward scatter sends leaf to root, i.e., x to y */
+      ierr = PetscSFReduceBegin(data->sf,data->unit,vscat->xdata,vscat->ydata,mop);CHKERRQ(ierr);
+    }
   }
+
+  /* the SF has packed the data it sends, so the local part can be done while the messages are in flight */
+  ierr = VecScatterLocal_SF(data,vscat->xdata,vscat->ydata,addv,mode);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
 static PetscErrorCode VecScatterEnd_SF(VecScatter vscat,Vec x,Vec y,InsertMode addv,ScatterMode mode)
 {
   VecScatter_SF  *data=(VecScatter_SF*)vscat->data;
-  PetscSF        sf;
   MPI_Op         mop=MPI_OP_NULL;
   PetscErrorCode ierr;
 
   PetscFunctionBegin;
-  /* SCATTER_LOCAL indicates ignoring inter-process communication */
-  sf = (mode & SCATTER_LOCAL) ? data->lsf : data->sf;
-
   if (addv == INSERT_VALUES)   mop = MPI_REPLACE;
   else if (addv == ADD_VALUES) mop = MPI_SUM;
   else if (addv == MAX_VALUES) mop = MPI_MAX;
-  else SETERRQ1(PetscObjectComm((PetscObject)sf),PETSC_ERR_SUP,"Unsupported InsertMode %D in VecScatterBegin/End",addv);
+  else SETERRQ1(PetscObjectComm((PetscObject)vscat),PETSC_ERR_SUP,"Unsupported InsertMode %D in VecScatterBegin/End",addv);
 
-  if (mode & SCATTER_REVERSE) {/* reverse scatter sends root to leaf. Note that x and y are swapped in input */
-    ierr = PetscSFBcastAndOpEnd(sf,data->unit,vscat->xdata,vscat->ydata,mop);CHKERRQ(ierr);
-  } else { /* forward scatter sends leaf to root, i.e., x to y */
-    ierr = PetscSFReduceEnd(sf,data->unit,vscat->xdata,vscat->ydata,mop);CHKERRQ(ierr);
+  /* SCATTER_LOCAL indicates ignoring inter-process communication */
+  if (!(mode & SCATTER_LOCAL)) {
+    if (mode & SCATTER_REVERSE) {/* reverse scatter sends root to leaf. Note that x and y are swapped in input */
+      ierr = PetscSFBcastAndOpEnd(data->sf,data->unit,vscat->xdata,vscat->ydata,mop);CHKERRQ(ierr);
+    } else { /* forward scatter sends leaf to root, i.e., x to y */
+      ierr = PetscSFReduceEnd(data->sf,data->unit,vscat->xdata,vscat->ydata,mop);CHKERRQ(ierr);
+    }
   }
 
   if (x != y) {
@@ -90,15 +164,14 @@ static PetscErrorCode VecScatterEnd_SF(VecScatter vscat,Vec x,Vec y,InsertMode a
 static PetscErrorCode VecScatterCopy_SF(VecScatter vscat,VecScatter ctx)
 {
   VecScatter_SF  *data=(VecScatter_SF*)vscat->data,*out;
+  PetscInt       n = data->xlocal.n;
   PetscErrorCode ierr;
 
   PetscFunctionBegin;
   ierr = PetscMemcpy(ctx->ops,vscat->ops,sizeof(vscat->ops));CHKERRQ(ierr);
   ierr = PetscNewLog(ctx,&out);CHKERRQ(ierr);
   ierr = PetscSFDuplicate(data->sf,PETSCSF_DUPLICATE_GRAPH,&out->sf);CHKERRQ(ierr);
-  ierr = PetscSFDuplicate(data->lsf,PETSCSF_DUPLICATE_GRAPH,&out->lsf);CHKERRQ(ierr);
   ierr = PetscSFSetUp(out->sf);CHKERRQ(ierr);
-  ierr = PetscSFSetUp(out->lsf);CHKERRQ(ierr);
 
   out->bs = data->bs;
   if (out->bs > 1) {
@@ -107,6 +180,13 @@ static PetscErrorCode VecScatterCopy_SF(VecScatter vscat,VecScatter ctx)
     out->unit = MPIU_SCALAR;
   }
   ctx->data = (void*)out;
+
+  out->xlocal.n = out->ylocal.n = n;
+  ierr = PetscMalloc1(n,&out->xlocal.vslots);CHKERRQ(ierr);
+  ierr = PetscMalloc1(n,&out->ylocal.vslots);CHKERRQ(ierr);
+  ierr = PetscMemcpy(out->xlocal.vslots,data->xlocal.vslots,n*sizeof(PetscInt));CHKERRQ(ierr);
+  ierr = PetscMemcpy(out->ylocal.vslots,data->ylocal.vslots,n*sizeof(PetscInt));CHKERRQ(ierr);
+  ierr = VecScatterLocalSetUp_SF(ctx);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
@@ -117,7 +197,9 @@ static PetscErrorCode VecScatterDestroy_SF(VecScatter vscat)
 
   PetscFunctionBegin;
   ierr = PetscSFDestroy(&data->sf);CHKERRQ(ierr);
-  ierr = PetscSFDestroy(&data->lsf);CHKERRQ(ierr);
+  ierr = VecScatterLocalReset_SF(vscat);CHKERRQ(ierr);
+  ierr = PetscFree(data->xlocal.vslots);CHKERRQ(ierr);
+  ierr = PetscFree(data->ylocal.vslots);CHKERRQ(ierr);
   if (data->bs > 1) {ierr = MPI_Type_free(&data->unit);CHKERRQ(ierr);}
   ierr = PetscFree(vscat->data);CHKERRQ(ierr);
   PetscFunctionReturn(0);
@@ -125,10 +207,24 @@ static PetscErrorCode VecScatterDestroy_SF(VecScatter vscat)
 
 static PetscErrorCode VecScatterView_SF(VecScatter vscat,PetscViewer viewer)
 {
-  VecScatter_SF *data = (VecScatter_SF *)vscat->data;
+  VecScatter_SF  *data = (VecScatter_SF *)vscat->data;
+  PetscMPIInt    rank;
+  PetscBool      iascii;
   PetscErrorCode ierr;
 
   PetscFunctionBegin;
+  ierr = PetscObjectTypeCompare((PetscObject)viewer,PETSCVIEWERASCII,&iascii);CHKERRQ(ierr);
+  if (iascii) {
+    ierr = MPI_Comm_rank(PetscObjectComm((PetscObject)vscat),&rank);CHKERRQ(ierr);
+    ierr = PetscViewerASCIIPrintf(viewer,"Block size %D\n",data->bs);CHKERRQ(ierr);
+    ierr = PetscViewerASCIIPushSynchronized(viewer);CHKERRQ(ierr);
+    ierr = PetscViewerASCIISynchronizedPrintf(viewer,"[%d] Number to self = %D\n",rank,data->xlocal.n);CHKERRQ(ierr);
+    if (data->xlocal.n && data->xlocal.memcpy_plan.optimized[0]) {
+      ierr = PetscViewerASCIISynchronizedPrintf(viewer,"[%d] Local part of the scatter is made of %D copies\n",rank,data->xlocal.memcpy_plan.copy_offsets[1]);CHKERRQ(ierr);
+    }
+    ierr = PetscViewerFlush(viewer);CHKERRQ(ierr);
+    ierr = PetscViewerASCIIPopSynchronized(viewer);CHKERRQ(ierr);
+  }
   ierr = PetscSFView(data->sf,viewer);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
@@ -138,34 +234,38 @@ static PetscErrorCode VecScatterView_SF(VecScatter vscat,PetscViewer viewer)
  */
 static PetscErrorCode VecScatterRemap_SF(VecScatter vscat,const PetscInt *tomap,const PetscInt *frommap)
 {
-  VecScatter_SF  *data = (VecScatter_SF *)vscat->data;
-  PetscSF        sfs[2],sf;
-  PetscInt       i,j;
-  PetscBool      ident;
-  PetscErrorCode ierr;
+  VecScatter_SF     *data = (VecScatter_SF *)vscat->data;
+  PetscSF           sf = data->sf;
+  PetscInt          i,nroots,nleaves,bs = data->bs,*ilocal;
+  const PetscInt    *mine;
+  const PetscSFNode *remote;
+  PetscSFNode       *iremote;
+  PetscMPIInt       ident;
+  PetscErrorCode    ierr;
 
   PetscFunctionBegin;
-  sfs[0] = data->sf;
-  sfs[1] = data->lsf;
-
   if (tomap) {
-    /* check if it is an identity map. If it is, do nothing */
-    ident = PETSC_TRUE;
-    for (i=0; i<data->sf->nleaves; i++) {if (i != tomap[i]) {ident = PETSC_FALSE; break; } }
+    ierr = PetscSFGetGraph(sf,&nroots,&nleaves,&mine,&remote);CHKERRQ(ierr);
+
+    /* check if it is an identity map on all processes. If it is, do nothing */
+    ident = 1;
+    for (i=0; i<nleaves; i++) {if (tomap[mine ? mine[i] : i] != (mine ? mine[i] : i)) {ident = 0; break;}}
+    for (i=0; ident && i<data->xlocal.n; i++) {if (tomap[data->xlocal.vslots[i]/bs] != data->xlocal.vslots[i]/bs) {ident = 0; break;}}
+    ierr = MPIU_Allreduce(MPI_IN_PLACE,&ident,1,MPI_INT,MPI_LAND,PetscObjectComm((PetscObject)sf));CHKERRQ(ierr);
     if (ident) PetscFunctionReturn(0);
 
-    for (j=0; j<2; j++) {
-      sf   = sfs[j];
-      ierr = PetscSFSetUp(sf);CHKERRQ(ierr); /* to bulid sf->rmine if SetUp is not yet called */
-      if (!sf->mine) { /* the old SF uses contiguous ilocal. After the remapping, it may not be true */
-        ierr = PetscMalloc1(sf->nleaves,&sf->mine);CHKERRQ(ierr);
-        ierr = PetscMemcpy(sf->mine,tomap,sizeof(PetscInt)*sf->nleaves);CHKERRQ(ierr);
-        sf->mine_alloc = sf->mine;
-      } else {
-        for (i=0; i<sf->nleaves; i++)             sf->mine[i]   = tomap[sf->mine[i]];
-      }
-      for (i=0; i<sf->roffset[sf->nranks]; i++)   sf->rmine[i]  = tomap[sf->rmine[i]];
-    }
+    /* Set the graph of the SF again, instead of changing its leaves in place, so that what the SF derived from the
+       leaves at setup (e.g., the patterns it packs with memcpy) stays consistent */
+    ierr = PetscMalloc1(nleaves,&ilocal);CHKERRQ(ierr);
+    ierr = PetscMalloc1(nleaves,&iremote);CHKERRQ(ierr);
+    for (i=0; i<nleaves; i++) ilocal[i] = tomap[mine ? mine[i] : i];
+    ierr = PetscMemcpy(iremote,remote,nleaves*sizeof(PetscSFNode));CHKERRQ(ierr);
+    ierr = PetscSFSetGraph(sf,nroots,nleaves,ilocal,PETSC_OWN_POINTER,iremote,PETSC_OWN_POINTER);CHKERRQ(ierr);
+    ierr = PetscSFSetUp(sf);CHKERRQ(ierr);
+
+    for (i=0; i<data->xlocal.n; i++) data->xlocal.vslots[i] = tomap[data->xlocal.vslots[i]/bs]*bs;
+    ierr = VecScatterLocalReset_SF(vscat);CHKERRQ(ierr);
+    ierr = VecScatterLocalSetUp_SF(vscat);CHKERRQ(ierr);
   }
 
   if (frommap) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_SUP,"Unable to remap the FROM in scatters yet");
@@ -176,26 +276,18 @@ static PetscErrorCode VecScatterGetRemoteCount_SF(VecScatter vscat,PetscBool sen
 {
   VecScatter_SF     *data = (VecScatter_SF *)vscat->data;
   PetscSF           sf = data->sf;
-  PetscInt          nranks,remote_start;
-  PetscMPIInt       myrank;
+  PetscInt          nranks;
   const PetscInt    *offset;
   const PetscMPIInt *ranks;
   PetscErrorCode    ierr;
 
   PetscFunctionBegin;
-  ierr = MPI_Comm_rank(PetscObjectComm((PetscObject)sf),&myrank);CHKERRQ(ierr);
-
+  /* sf has no edges to self, they are in the local part */
   if (send) { ierr = PetscSFGetRanks(sf,&nranks,&ranks,&offset,NULL,NULL);CHKERRQ(ierr); }
   else { ierr = PetscSFGetLeafRanks(sf,&nranks,&ranks,&offset,NULL);CHKERRQ(ierr); }
 
-  if (nranks) {
-    remote_start = (myrank == ranks[0])? 1 : 0;
-    if (num_procs)   *num_procs   = nranks - remote_start;
-    if (num_entries) *num_entries = offset[nranks] - offset[remote_start];
-  } else {
-    if (num_procs)   *num_procs   = 0;
-    if (num_entries) *num_entries = 0;
-  }
+  if (num_procs)   *num_procs   = nranks;
+  if (num_entries) *num_entries = nranks ? offset[nranks] - offset[0] : 0;
   PetscFunctionReturn(0);
 }
 
@@ -203,24 +295,20 @@ static PetscErrorCode VecScatterGetRemote_SF(VecScatter vscat,PetscBool send,Pet
 {
   VecScatter_SF     *data = (VecScatter_SF *)vscat->data;
   PetscSF           sf = data->sf;
-  PetscInt          nranks,remote_start;
-  PetscMPIInt       myrank;
+  PetscInt          nranks;
   const PetscInt    *offset,*location;
   const PetscMPIInt *ranks;
   PetscErrorCode    ierr;
 
   PetscFunctionBegin;
-  ierr = MPI_Comm_rank(PetscObjectComm((PetscObject)sf),&myrank);CHKERRQ(ierr);
-
   if (send) { ierr = PetscSFGetRanks(sf,&nranks,&ranks,&offset,&location,NULL);CHKERRQ(ierr); }
   else { ierr = PetscSFGetLeafRanks(sf,&nranks,&ranks,&offset,&location);CHKERRQ(ierr); }
 
   if (nranks) {
-    remote_start = (myrank == ranks[0])? 1 : 0;
-    if (n)       *n       = nranks - remote_start;
-    if (starts)  *starts  = &offset[remote_start];
-    if (indices) *indices = location; /* not &location[offset[remote_start]]. Starts[0] may point to the middle of indices[] */
-    if (procs)   *procs   = &ranks[remote_start];
+    if (n)       *n       = nranks;
+    if (starts)  *starts  = offset;
+    if (indices) *indices = location;
+    if (procs)   *procs   = ranks;
   } else {
     if (n)       *n       = 0;
     if (starts)  *starts  = NULL;
@@ -277,21 +365,78 @@ functionend:
   PetscFunctionReturn(0);
 }
 
+/* Check if the indices of is come in runs of bs consecutive indices starting at multiples of bs, so that is can be shrunk by bs */
+static PetscErrorCode ISCanShrink_Private(IS is,ISTypeID id,PetscInt bs,PetscBool *can)
+{
+  PetscInt       i,k,n,ibs,first,step;
+  const PetscInt *indices;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  *can = PETSC_FALSE;
+  ierr = ISGetLocalSize(is,&n);CHKERRQ(ierr);
+  if (n%bs) PetscFunctionReturn(0);
+  if (id == IS_BLOCK) {
+    ierr = ISGetBlockSize(is,&ibs);CHKERRQ(ierr);
+    if (ibs%bs == 0) *can = PETSC_TRUE;
+  } else if (id == IS_STRIDE) {
+    ierr = ISStrideGetInfo(is,&first,&step);CHKERRQ(ierr);
+    if (!n || (step == 1 && first%bs == 0)) *can = PETSC_TRUE;
+  } else if (id == IS_GENERAL) {
+    ierr = ISGetIndices(is,&indices);CHKERRQ(ierr);
+    for (i=0; i<n; i+=bs) {
+      if (indices[i]%bs) break;
+      for (k=1; k<bs; k++) if (indices[i+k] != indices[i]+k) break;
+      if (k < bs) break;
+    }
+    if (i == n) *can = PETSC_TRUE;
+    ierr = ISRestoreIndices(is,&indices);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+/* Shrink is by bs, e.g., {0,1,2,6,7,8} with bs=3 gives {0,2}. is must pass ISCanShrink_Private() */
+static PetscErrorCode ISShrink_Private(IS is,ISTypeID id,PetscInt bs,IS *isbs)
+{
+  PetscInt       i,n,ibs,first,step,*bindices;
+  const PetscInt *indices;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = ISGetLocalSize(is,&n);CHKERRQ(ierr);
+  if (id == IS_BLOCK) {ierr = ISGetBlockSize(is,&ibs);CHKERRQ(ierr);}
+  if (id == IS_STRIDE) {
+    ierr = ISStrideGetInfo(is,&first,&step);CHKERRQ(ierr);
+    ierr = ISCreateStride(PETSC_COMM_SELF,n/bs,first/bs,1,isbs);CHKERRQ(ierr);
+  } else if (id == IS_BLOCK && ibs == bs) {
+    ierr = ISBlockGetIndices(is,&indices);CHKERRQ(ierr);
+    ierr = ISCreateGeneral(PETSC_COMM_SELF,n/bs,indices,PETSC_COPY_VALUES,isbs);CHKERRQ(ierr);
+    ierr = ISBlockRestoreIndices(is,&indices);CHKERRQ(ierr);
+  } else {
+    ierr = ISGetIndices(is,&indices);CHKERRQ(ierr);
+    ierr = PetscMalloc1(n/bs,&bindices);CHKERRQ(ierr);
+    for (i=0; i<n/bs; i++) bindices[i] = indices[i*bs]/bs;
+    ierr = ISRestoreIndices(is,&indices);CHKERRQ(ierr);
+    ierr = ISCreateGeneral(PETSC_COMM_SELF,n/bs,bindices,PETSC_OWN_POINTER,isbs);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
 static PetscErrorCode VecScatterSetUp_SF(VecScatter vscat)
 {
   VecScatter_SF  *data;
-  MPI_Comm       comm,xcomm,ycomm,bigcomm;
+  MPI_Comm       xcomm,ycomm,bigcomm;
   Vec            x=vscat->from_v,y=vscat->to_v,xx,yy;
   IS             ix=vscat->from_is,iy=vscat->to_is,ixx,iyy;
-  PetscMPIInt    size,xcommsize,ycommsize,myrank;
-  PetscInt       i,j,n,N,nroots,nleaves,inedges=0,*leafdata,*rootdata,*ilocal,*lilocal,xstart,ystart,lnleaves,ixsize,iysize,xlen,ylen;
+  PetscMPIInt    xcommsize,ycommsize,myrank;
+  PetscInt       i,j,k,n,N,nroots,nleaves,inedges=0,*leafdata,*rootdata,*ilocal,xstart,ystart,ixsize,iysize,xlen,ylen;
   const PetscInt *xindices,*yindices,*degree;
-  PetscSFNode    *iremote,*liremote;
+  PetscSFNode    *iremote;
   PetscLayout    xlayout,ylayout;
   PetscSF        tmpsf;
   ISTypeID       ixid,iyid;
-  PetscInt       bs,bsx,bsy,min=PETSC_MIN_INT,max=PETSC_MAX_INT,ixfirst,ixstep,iyfirst,iystep;
-  PetscBool      can_do_block_opt=PETSC_FALSE;
+  PetscInt       bs,bsx,bsy,min=PETSC_MIN_INT,max=PETSC_MAX_INT;
+  PetscBool      can_do_block_opt=PETSC_FALSE,canx,cany;
   PetscErrorCode ierr;
 
   PetscFunctionBegin;
@@ -345,10 +490,12 @@ static PetscErrorCode VecScatterSetUp_SF(VecScatter vscat)
 
   /* Do block optimization by taking advantage of high level info available in ix, iy.
      The block optimization is valid when all of the following conditions are met:
-     1) ix, iy are blocked or can be blocked (i.e., strided with step=1);
+     1) ix, iy are blocked or can be blocked (i.e., strided with step=1, or general with aligned runs of bs indices);
      2) ix, iy have the same block size;
      3) all processors agree on one block size;
      4) no blocks span more than one process;
+     The block size is the one of the block index sets, or else the block size of x, which is how general index sets
+     built by hand on vectors of several components get blocked.
    */
   data->bs   = 1; /* default, no blocking */
   data->unit = MPIU_SCALAR;
@@ -356,20 +503,28 @@ static PetscErrorCode VecScatterSetUp_SF(VecScatter vscat)
   ierr       = ISGetTypeID_Private(iy,&iyid);CHKERRQ(ierr);
   bigcomm    = (ycommsize == 1) ? xcomm : ycomm;
 
-  if (ixid == IS_BLOCK)       {ierr = ISGetBlockSize(ix,&bsx);CHKERRQ(ierr);}
-  else if (ixid == IS_STRIDE) {ierr = ISStrideGetInfo(ix,&ixfirst,&ixstep);CHKERRQ(ierr);}
-
-  if ( iyid == IS_BLOCK)      {ierr = ISGetBlockSize(iy,&bsy);CHKERRQ(ierr);}
-  else if (iyid == IS_STRIDE) {ierr = ISStrideGetInfo(iy,&iyfirst,&iystep);CHKERRQ(ierr);}
-
-  /* Processors could go through different path in this if-else test */
-  if (ixid == IS_BLOCK && iyid == IS_BLOCK) {
-    min = PetscMin(bsx,bsy);
-    max = PetscMax(bsx,bsy);
-  } else if (ixid == IS_BLOCK  && iyid == IS_STRIDE && iystep==1 && iyfirst%bsx==0) {
-    min = max = bsx;
-  } else if (ixid == IS_STRIDE && iyid == IS_BLOCK  && ixstep==1 && ixfirst%bsy==0) {
-    min = max = bsy;
+  /* Processors could go through different path in this if-else test. Processors with nothing to scatter agree on any block size */
+  if (ixsize) {
+    if (ixid == IS_BLOCK && iyid == IS_BLOCK) {
+      ierr = ISGetBlockSize(ix,&bsx);CHKERRQ(ierr);
+      ierr = ISGetBlockSize(iy,&bsy);CHKERRQ(ierr);
+      bs   = PetscMin(bsx,bsy);
+    } else if (ixid == IS_BLOCK) {
+      ierr = ISGetBlockSize(ix,&bs);CHKERRQ(ierr);
+    } else if (iyid == IS_BLOCK) {
+      ierr = ISGetBlockSize(iy,&bs);CHKERRQ(ierr);
+    } else {
+      ierr = VecGetBlockSize(x,&bs);CHKERRQ(ierr);
+    }
+    canx = cany = PETSC_FALSE;
+    if (bs > 1) {
+      ierr = ISCanShrink_Private(ix,ixid,bs,&canx);CHKERRQ(ierr);
+      ierr = ISCanShrink_Private(iy,iyid,bs,&cany);CHKERRQ(ierr);
+    }
+    min = max = (canx && cany) ? bs : 1;
+  } else {
+    min = PETSC_MAX_INT;
+    max = PETSC_MIN_INT;
   }
   ierr = MPIU_Allreduce(MPI_IN_PLACE,&min,1,MPIU_INT,MPI_MIN,bigcomm);CHKERRQ(ierr);
   ierr = MPIU_Allreduce(MPI_IN_PLACE,&max,1,MPIU_INT,MPI_MAX,bigcomm);CHKERRQ(ierr);
@@ -396,36 +551,19 @@ static PetscErrorCode VecScatterSetUp_SF(VecScatter vscat)
      we can treat PtoP and PtoS uniformly as PtoP.
    */
   if (can_do_block_opt) {
-    const PetscInt *indices;
-
     data->bs = bs = min;
     ierr     = MPI_Type_contiguous(bs,MPIU_SCALAR,&data->unit);CHKERRQ(ierr);
     ierr     = MPI_Type_commit(&data->unit);CHKERRQ(ierr);
 
     /* Shrink x and ix */
     ierr = VecCreateMPIWithArray(xcomm,1,xlen/bs,PETSC_DECIDE,NULL,&xx);CHKERRQ(ierr); /* We only care xx's layout */
-    if (ixid == IS_BLOCK) {
-      ierr = ISBlockGetIndices(ix,&indices);CHKERRQ(ierr);
-      ierr = ISBlockGetLocalSize(ix,&ixsize);CHKERRQ(ierr);
-      ierr = ISCreateGeneral(PETSC_COMM_SELF,ixsize,indices,PETSC_COPY_VALUES,&ixx);CHKERRQ(ierr);
-      ierr = ISBlockRestoreIndices(ix,&indices);CHKERRQ(ierr);
-    } else if (ixid == IS_STRIDE) {
-      ierr = ISGetLocalSize(ix,&ixsize);CHKERRQ(ierr);
-      ierr = ISCreateStride(PETSC_COMM_SELF,ixsize/bs,ixfirst/bs,1,&ixx);CHKERRQ(ierr);
-    }
+    ierr = ISShrink_Private(ix,ixid,bs,&ixx);CHKERRQ(ierr);
 
     /* Shrink y and iy */
     ierr = VecCreateMPIWithArray(bigcomm,1,ylen/bs,PETSC_DECIDE,NULL,&yy);CHKERRQ(ierr);
-    if (iyid == IS_BLOCK) {
-      ierr = ISBlockGetIndices(iy,&indices);CHKERRQ(ierr);
-      ierr = ISBlockGetLocalSize(iy,&iysize);CHKERRQ(ierr);
-      ierr = ISCreateGeneral(PETSC_COMM_SELF,iysize,indices,PETSC_COPY_VALUES,&iyy);CHKERRQ(ierr);
-      ierr = ISBlockRestoreIndices(iy,&indices);CHKERRQ(ierr);
-    } else if (iyid == IS_STRIDE) {
-      ierr = ISGetLocalSize(iy,&iysize);CHKERRQ(ierr);
-      ierr = ISCreateStride(PETSC_COMM_SELF,iysize/bs,iyfirst/bs,1,&iyy);CHKERRQ(ierr);
-    }
+    ierr = ISShrink_Private(iy,iyid,bs,&iyy);CHKERRQ(ierr);
   } else {
+    bs  = 1;
     ixx = ix;
     iyy = iy;
     xx  = x;
@@ -480,12 +618,6 @@ static PetscErrorCode VecScatterSetUp_SF(VecScatter vscat)
       ilocal[i] = rootdata[2*i] - xstart; /* covert x's global index to local index */
       ierr      = PetscLayoutFindOwnerIndex(ylayout,rootdata[2*i+1],&iremote[i].rank,&iremote[i].index);CHKERRQ(ierr); /* convert y's global index to (rank, index) */
     }
-
-    /* MUST build SF on yy's comm, which is not necessarily identical to xx's comm.
-       In SF's view, yy contains the roots (i.e., the remote) and iremote[].rank are ranks in yy's comm.
-       xx contains leaves, which are local and can be thought as part of PETSC_COMM_SELF. */
-    ierr = PetscSFCreate(PetscObjectComm((PetscObject)yy),&data->sf);CHKERRQ(ierr);
-    ierr = PetscSFSetGraph(data->sf,nroots,nleaves,ilocal,PETSC_OWN_POINTER,iremote,PETSC_OWN_POINTER);CHKERRQ(ierr);
     ierr = PetscFree(rootdata);CHKERRQ(ierr);
   } else {
     /* StoP or StoS */
@@ -496,10 +628,33 @@ static PetscErrorCode VecScatterSetUp_SF(VecScatter vscat)
     ierr = PetscMalloc1(nleaves,&iremote);CHKERRQ(ierr);
     ierr = PetscMemcpy(ilocal,xindices,nleaves*sizeof(PetscInt));CHKERRQ(ierr);
     for (i=0; i<nleaves; i++) {ierr = PetscLayoutFindOwnerIndex(ylayout,yindices[i],&iremote[i].rank,&iremote[i].index);CHKERRQ(ierr);}
-    ierr = PetscSFCreate(PetscObjectComm((PetscObject)yy),&data->sf);CHKERRQ(ierr);
-    ierr = PetscSFSetGraph(data->sf,nroots,nleaves,ilocal,PETSC_OWN_POINTER,iremote,PETSC_OWN_POINTER);CHKERRQ(ierr);
   }
 
+  /* Take the edges to self out of the graph: they form the local part of the scatter, which is done with
+     direct copies (with memcpy when they are contiguous) instead of being packed and unpacked by the SF.
+     The remaining edges build the SF. It MUST be built on yy's comm, which is not necessarily identical to xx's comm.
+     In SF's view, yy contains the roots (i.e., the remote) and iremote[].rank are ranks in yy's comm.
+     xx contains leaves, which are local and can be thought as part of PETSC_COMM_SELF. */
+  ierr = MPI_Comm_rank(bigcomm,&myrank);CHKERRQ(ierr);
+  for (i=n=0; i<nleaves; i++) {if (iremote[i].rank == (PetscInt)myrank) n++;}
+  data->xlocal.n = data->ylocal.n = n;
+  ierr = PetscMalloc1(n,&data->xlocal.vslots);CHKERRQ(ierr);
+  ierr = PetscMalloc1(n,&data->ylocal.vslots);CHKERRQ(ierr);
+  for (i=j=k=0; i<nleaves; i++) {
+    if (iremote[i].rank == (PetscInt)myrank) {
+      data->xlocal.vslots[j] = ilocal[i]*bs;
+      data->ylocal.vslots[j] = iremote[i].index*bs;
+      j++;
+    } else {
+      ilocal[k]  = ilocal[i];
+      iremote[k] = iremote[i];
+      k++;
+    }
+  }
+  ierr = PetscSFCreate(bigcomm,&data->sf);CHKERRQ(ierr);
+  ierr = PetscSFSetFromOptions(data->sf);CHKERRQ(ierr);
+  ierr = PetscSFSetGraph(data->sf,nroots,k,ilocal,PETSC_OWN_POINTER,iremote,PETSC_OWN_POINTER);CHKERRQ(ierr);
+
   /* Free memory no longer needed */
   ierr = ISRestoreIndices(ixx,&xindices);CHKERRQ(ierr);
   ierr = ISRestoreIndices(iyy,&yindices);CHKERRQ(ierr);
@@ -514,37 +669,11 @@ static PetscErrorCode VecScatterSetUp_SF(VecScatter vscat)
   if (!vscat->from_is) {ierr = ISDestroy(&ix);CHKERRQ(ierr);}
   if (!vscat->to_is  ) {ierr = ISDestroy(&iy);CHKERRQ(ierr);}
 
-  /* Create lsf, the local scatter. Could use PetscSFCreateEmbeddedLeafSF, but since we know the comm is PETSC_COMM_SELF, we can make it fast */
-  ierr = PetscObjectGetComm((PetscObject)data->sf,&comm);CHKERRQ(ierr);
-  ierr = MPI_Comm_size(comm,&size);CHKERRQ(ierr);
-  ierr = MPI_Comm_rank(comm,&myrank);CHKERRQ(ierr);
-
-  /* Find out local edges and build a local SF */
-  {
-    const PetscInt    *ilocal;
-    const PetscSFNode *iremote;
-    ierr = PetscSFGetGraph(data->sf,&nroots,&nleaves,&ilocal,&iremote);CHKERRQ(ierr);
-    for (i=lnleaves=0; i<nleaves; i++) {if (iremote[i].rank == (PetscInt)myrank) lnleaves++;}
-    ierr = PetscMalloc1(lnleaves,&lilocal);CHKERRQ(ierr);
-    ierr = PetscMalloc1(lnleaves,&liremote);CHKERRQ(ierr);
-
-    for (i=j=0; i<nleaves; i++) {
-      if (iremote[i].rank == (PetscInt)myrank) {
-        lilocal[j]        = ilocal? ilocal[i] : i; /* ilocal=NULL for contiguous storage */
-        liremote[j].rank  = 0; /* rank in PETSC_COMM_SELF */
-        liremote[j].index = iremote[i].index;
-        j++;
-      }
-    }
-    ierr = PetscSFCreate(PETSC_COMM_SELF,&data->lsf);CHKERRQ(ierr);
-    ierr = PetscSFSetGraph(data->lsf,nroots,lnleaves,lilocal,PETSC_OWN_POINTER,liremote,PETSC_OWN_POINTER);CHKERRQ(ierr);
-  }
-
   /* vecscatter uses eager setup */
+  vscat->data = (void*)data;
   ierr = PetscSFSetUp(data->sf);CHKERRQ(ierr);
-  ierr = PetscSFSetUp(data->lsf);CHKERRQ(ierr);
+  ierr = VecScatterLocalSetUp_SF(vscat);CHKERRQ(ierr);
 
-  vscat->data                      = (void*)data;
   vscat->ops->begin                = VecScatterBegin_SF;
   vscat->ops->end                  = VecScatterEnd_SF;
   vscat->ops->remap                = VecScatterRemap_SF;
@@ -211,6 +211,9 @@ PetscErrorCode VecScatterRegister(const char sname[], PetscErrorCode (*function)
                               eliminates the chance for overlap of computation and communication
 .  -vecscatter_packtogether - Pack all messages before sending, receive all messages before unpacking
                               will make the results of scatters deterministic when otherwise they are not (it may be slower also).
+.  -vecscatter_neighbor     - With the default VECSCATTERMPI1, exchange all messages with one MPI_Ineighbor_alltoallv() on a
+                              distributed graph communicator built once at creation, instead of the persistent sends and receives
+                              (requires MPI-3 neighborhood collectives).
 
     Level: intermediate
 
@@ -225,7 +228,9 @@ PetscErrorCode VecScatterRegister(const char sname[], PetscErrorCode (*function)
    context until the VecScatterEnd() has been called on the first VecScatterBegin().
    In this case a separate VecScatter is needed for each concurrent scatter.
 
-   Currently the MPI_Send() use PERSISTENT versions.
+   Currently the MPI_Send() use PERSISTENT versions, so repeated scatters, such as the one in MatMult() for MATMPIAIJ,
+   pay no setup of the communication; with -vecscatter_neighbor the MPI implementation sees the whole communication
+   pattern at once, which may lower the latency of each scatter when many processes are involved.
    (this unfortunately requires that the same in and out arrays be used for each use, this
     is why  we always need to pack the input into the work array before sending
     and unpack upon receiving instead of using MPI datatypes to avoid the packing/unpacking).